@@ -0,0 +1,236 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// Standalone benchmark for the HLE audio pipeline. It maps a block of emulated memory, fills
+// it with sample data, drives the full 24-voice Source/Mixers path as fast as possible and
+// reports frames per second, then times each stage (codec, resampler, filters, final mix) in
+// isolation. This lets codec/mixer/resampler changes be measured without booting a title.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "audio_core/audio_core.h"
+#include "audio_core/codec.h"
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/dsp.h"
+#include "audio_core/hle/filter.h"
+#include "audio_core/hle/mixers.h"
+#include "audio_core/hle/source.h"
+#include "audio_core/interpolate.h"
+
+#include "common/common_types.h"
+
+#include "core/memory.h"
+#include "core/memory_setup.h"
+
+using Configuration = DSP::HLE::SourceConfiguration::Configuration;
+
+constexpr size_t pipeline_frames = 20000;   ///< Frames of the full pipeline to run (~100s of audio)
+constexpr u32 buffer_length = 0x10000;      ///< Length of each source's buffer, in samples
+constexpr float bench_rate_multiplier = 0.9375f; // 30720 Hz -> 32768 Hz, a typical title rate
+
+/// Runs fn() `iterations` times and returns the average wall-clock cost of one call in seconds.
+template <typename Function>
+static double TimePerCall(size_t iterations, Function fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+static void FillPcm16Sine(u8* dst, size_t num_samples, unsigned num_channels) {
+    for (size_t i = 0; i < num_samples; i++) {
+        const s16 value = static_cast<s16>(10000.0 * std::sin(i * 0.05));
+        for (unsigned c = 0; c < num_channels; c++) {
+            std::memcpy(dst + (i * num_channels + c) * sizeof(s16), &value, sizeof(s16));
+        }
+    }
+}
+
+static void FillAdpcmFrames(u8* dst, size_t num_samples) {
+    // Frames are 8 bytes long containing 14 samples each; the decoder accepts any bit pattern.
+    const size_t num_frames = (num_samples + 13) / 14;
+    for (size_t i = 0; i < num_frames; i++) {
+        dst[i * 8] = 0x04; // scale = 4, predictor = 0
+        for (size_t j = 1; j < 8; j++) {
+            dst[i * 8 + j] = static_cast<u8>(i * 7 + j * 0x1D);
+        }
+    }
+}
+
+/// Reconfigures a source from scratch and enqueues its embedded buffer.
+static void ArmSourceConfig(Configuration& config, u32 physical_address, bool adpcm, bool stereo,
+                            bool filtered, u16 buffer_id) {
+    config.enable = 1;
+    config.enable_dirty.Assign(1);
+
+    config.rate_multiplier = bench_rate_multiplier;
+    config.rate_multiplier_dirty.Assign(1);
+
+    config.interpolation_mode = adpcm ? Configuration::InterpolationMode::Polyphase
+                                      : Configuration::InterpolationMode::Linear;
+    config.interpolation_dirty.Assign(1);
+
+    for (size_t mix = 0; mix < 3; mix++) {
+        for (size_t channel = 0; channel < 4; channel++) {
+            config.gain[mix][channel] = mix == 0 ? 0.7f : 0.0f;
+        }
+    }
+    config.gain_0_dirty.Assign(1);
+    config.gain_1_dirty.Assign(1);
+    config.gain_2_dirty.Assign(1);
+
+    config.simple_filter_enabled.Assign(filtered ? 1 : 0);
+    config.biquad_filter_enabled.Assign(filtered ? 1 : 0);
+    config.filters_enabled_dirty.Assign(1);
+    if (filtered) {
+        config.simple_filter.b0 = 0x6000;
+        config.simple_filter.a1 = 0x2000;
+        config.simple_filter_dirty.Assign(1);
+        config.biquad_filter.b0 = 0x3000;
+        config.biquad_filter.b1 = 0x0800;
+        config.biquad_filter.b2 = 0x0100;
+        config.biquad_filter.a1 = 0x0400;
+        config.biquad_filter.a2 = 0x0080;
+        config.biquad_filter_dirty.Assign(1);
+    }
+
+    config.adpcm_coefficients_dirty.Assign(adpcm ? 1 : 0);
+
+    config.mono_or_stereo.Assign(stereo ? Configuration::MonoOrStereo::Stereo
+                                        : Configuration::MonoOrStereo::Mono);
+    config.mono_or_stereo_dirty.Assign(1);
+    config.format.Assign(adpcm ? Configuration::Format::ADPCM : Configuration::Format::PCM16);
+    config.format_dirty.Assign(1);
+
+    config.physical_address = physical_address;
+    config.length = buffer_length;
+    config.adpcm_ps = 0;
+    config.adpcm_yn[0] = 0;
+    config.adpcm_yn[1] = 0;
+    config.adpcm_dirty.Assign(adpcm ? 1 : 0);
+    config.is_looping.Assign(0);
+    config.buffer_id = buffer_id;
+    config.embedded_buffer_dirty.Assign(1);
+}
+
+int main() {
+    // Map the emulated VRAM region as the backing store for sample data. VRAM's
+    // physical-to-virtual translation is static, so no kernel state is required.
+    Memory::InitMemoryMap();
+    std::vector<u8> vram_backing(Memory::VRAM_SIZE);
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram_backing.data());
+
+    const u32 pcm16_addr = Memory::VRAM_PADDR;
+    const u32 adpcm_addr = Memory::VRAM_PADDR + 0x200000;
+    FillPcm16Sine(vram_backing.data(), buffer_length, 2);
+    FillAdpcmFrames(vram_backing.data() + 0x200000, buffer_length);
+
+    s16_le adpcm_coeffs[16];
+    const s16 coeff_values[16] = { 0x0400, 0, 0x0800, -0x0200, 0x0C00, -0x0400, 0x0600, 0x0100,
+                                   0x0400, 0, 0x0800, -0x0200, 0x0C00, -0x0400, 0x0600, 0x0100 };
+    for (size_t i = 0; i < 16; i++) {
+        adpcm_coeffs[i] = coeff_values[i];
+    }
+
+    // Full pipeline: 24 sources (half ADPCM+polyphase, half stereo PCM16+linear, a third of
+    // them filtered) mixed down each frame exactly as DSP::HLE::Tick does it.
+    std::vector<DSP::HLE::Source> sources;
+    std::vector<Configuration> configs(DSP::HLE::num_sources);
+    std::memset(configs.data(), 0, sizeof(Configuration) * configs.size());
+    std::vector<u16> buffer_ids(DSP::HLE::num_sources, 1);
+    for (size_t i = 0; i < DSP::HLE::num_sources; i++) {
+        sources.emplace_back(i);
+        const bool adpcm = (i % 2) == 0;
+        ArmSourceConfig(configs[i], adpcm ? adpcm_addr : pcm16_addr, adpcm, !adpcm, (i % 3) == 0,
+                        buffer_ids[i]);
+    }
+
+    DSP::HLE::Mixers mixers;
+    DSP::HLE::DspConfiguration dsp_config;
+    std::memset(&dsp_config, 0, sizeof(dsp_config));
+    dsp_config.volume[0] = 1.0f;
+    dsp_config.volume_0_dirty.Assign(1);
+    DSP::HLE::IntermediateMixSamples read_samples;
+    DSP::HLE::IntermediateMixSamples write_samples;
+    std::memset(&read_samples, 0, sizeof(read_samples));
+
+    const double pipeline_seconds = TimePerCall(pipeline_frames, [&] {
+        std::array<DSP::HLE::QuadFrame32, 3> intermediate_mixes = {};
+        for (size_t i = 0; i < DSP::HLE::num_sources; i++) {
+            const auto status = sources[i].Tick(configs[i], adpcm_coeffs);
+            for (size_t mix = 0; mix < 3; mix++) {
+                sources[i].MixInto(intermediate_mixes[mix], mix);
+            }
+            if (!status.is_enabled || status.current_buffer_id_dirty) {
+                // The buffer ran out; re-arm the source with a fresh embedded buffer.
+                const bool adpcm = (i % 2) == 0;
+                ArmSourceConfig(configs[i], adpcm ? adpcm_addr : pcm16_addr, adpcm, !adpcm,
+                                (i % 3) == 0, ++buffer_ids[i]);
+            }
+        }
+        mixers.Tick(dsp_config, read_samples, write_samples, intermediate_mixes);
+    });
+
+    const double audio_frame_seconds = static_cast<double>(DSP::HLE::samples_per_frame) / AudioCore::native_sample_rate;
+    std::printf("full pipeline (24 voices): %8.1f frames/s  %7.1f us/frame  %6.1fx realtime\n",
+                1.0 / pipeline_seconds, pipeline_seconds * 1e6, audio_frame_seconds / pipeline_seconds);
+
+    // Per-stage timings, each over one frame's worth of work.
+    constexpr size_t stage_iterations = 100000;
+    const u8* const adpcm_data = vram_backing.data() + 0x200000;
+    const u8* const pcm16_data = vram_backing.data();
+
+    Codec::ADPCMState adpcm_state = {};
+    std::array<s16, 16> stage_coeffs;
+    for (size_t i = 0; i < 16; i++)
+        stage_coeffs[i] = coeff_values[i];
+    const double adpcm_seconds = TimePerCall(stage_iterations, [&] {
+        Codec::DecodeADPCM(adpcm_data, DSP::HLE::samples_per_frame, stage_coeffs, adpcm_state);
+    });
+    std::printf("codec ADPCM mono:          %7.0f ns/frame\n", adpcm_seconds * 1e9);
+
+    const double pcm16_seconds = TimePerCall(stage_iterations, [&] {
+        Codec::DecodePCM16(2, pcm16_data, DSP::HLE::samples_per_frame);
+    });
+    std::printf("codec PCM16 stereo:        %7.0f ns/frame\n", pcm16_seconds * 1e9);
+
+    Codec::StereoBuffer16 interp_input(DSP::HLE::samples_per_frame);
+    for (size_t i = 0; i < interp_input.size(); i++) {
+        interp_input[i].fill(static_cast<s16>(10000.0 * std::sin(i * 0.05)));
+    }
+    AudioInterp::State interp_state = {};
+    const double linear_seconds = TimePerCall(stage_iterations, [&] {
+        AudioInterp::Linear(interp_state, interp_input, bench_rate_multiplier);
+    });
+    std::printf("resampler linear:          %7.0f ns/frame\n", linear_seconds * 1e9);
+
+    interp_state = {};
+    const double polyphase_seconds = TimePerCall(stage_iterations, [&] {
+        AudioInterp::Polyphase(interp_state, interp_input, bench_rate_multiplier);
+    });
+    std::printf("resampler polyphase:       %7.0f ns/frame\n", polyphase_seconds * 1e9);
+
+    DSP::HLE::SourceFilters filters;
+    filters.Enable(true, true);
+    DSP::HLE::StereoFrame16 filter_frame = {};
+    const double filter_seconds = TimePerCall(stage_iterations, [&] {
+        filters.ProcessFrame(filter_frame);
+    });
+    std::printf("filters simple+biquad:     %7.0f ns/frame\n", filter_seconds * 1e9);
+
+    const double mixer_seconds = TimePerCall(stage_iterations, [&] {
+        std::array<DSP::HLE::QuadFrame32, 3> intermediate_mixes = {};
+        mixers.Tick(dsp_config, read_samples, write_samples, intermediate_mixes);
+    });
+    std::printf("mixers final downmix:      %7.0f ns/frame\n", mixer_seconds * 1e9);
+
+    return 0;
+}
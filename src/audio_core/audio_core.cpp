@@ -12,6 +12,8 @@
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 
+#include "common/telemetry.h"
+
 #include "core/core_timing.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/hle/service/dsp_dsp.h"
@@ -23,6 +25,8 @@ static int tick_event;                               ///< CoreTiming event
 static constexpr u64 audio_frame_ticks = 1310252ull; ///< Units: ARM11 cycles
 
 static void AudioTickCallback(u64 /*userdata*/, int cycles_late) {
+    Common::Telemetry::ScopedSample audio_sample(Common::Telemetry::Stage::Audio);
+
     if (DSP::HLE::Tick()) {
         // TODO(merry): Signal all the other interrupts as appropriate.
         DSP_DSP::SignalPipeInterrupt(DSP::HLE::DspPipe::Audio);
@@ -2,11 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstring>
 #include <vector>
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 #include "audio_core/codec.h"
 
 #include "common/assert.h"
@@ -30,6 +35,10 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count, cons
     int yn1 = state.yn1,
         yn2 = state.yn2;
 
+    // The second order digital filter is a serial recurrence (each sample feeds the next), so
+    // the decode itself can't be vectorized. Instead each frame is processed as a block: all
+    // nibbles are unpacked and pre-scaled up front, leaving the inner filter loop free of
+    // table lookups and per-sample bounds checks.
     const size_t NUM_FRAMES = (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
     for (size_t framei = 0; framei < NUM_FRAMES; framei++) {
         const int frame_header = data[framei * FRAME_LEN];
@@ -40,33 +49,32 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count, cons
         const int coef1 = adpcm_coeff[idx * 2 + 0];
         const int coef2 = adpcm_coeff[idx * 2 + 1];
 
-        // Decodes an audio sample. One nibble produces one sample.
-        const auto decode_sample = [&](const int nibble) -> s16 {
-            const int xn = nibble * scale;
+        const size_t outputi = framei * SAMPLES_PER_FRAME;
+        // Nibbles are decoded in pairs, so an odd sample_count still consumes (and filters) the
+        // padding sample at the end of the buffer.
+        const size_t samples_this_frame = std::min(SAMPLES_PER_FRAME, ret_size - outputi);
+
+        // Unpack and scale the frame's nibbles. One nibble produces one sample.
+        int xn[SAMPLES_PER_FRAME];
+        for (size_t i = 0; i < samples_this_frame; i += 2) {
+            const u8 byte = data[framei * FRAME_LEN + 1 + i / 2];
+            xn[i + 0] = SIGNED_NIBBLES[byte & 0xF] * scale;
+            if (i + 1 < SAMPLES_PER_FRAME)
+                xn[i + 1] = SIGNED_NIBBLES[byte >> 4] * scale;
+        }
+
+        for (size_t i = 0; i < samples_this_frame; i++) {
             // We first transform everything into 11 bit fixed point, perform the second order digital filter, then transform back.
             // 0x400 == 0.5 in 11 bit fixed point.
             // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
-            int val = ((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
+            int val = ((xn[i] << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
             // Clamp to output range.
             val = MathUtil::Clamp(val, -32768, 32767);
             // Advance output feedback.
             yn2 = yn1;
             yn1 = val;
-            return (s16)val;
-        };
-
-        size_t outputi = framei * SAMPLES_PER_FRAME;
-        size_t datai = framei * FRAME_LEN + 1;
-        for (size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample2);
-            outputi++;
 
-            datai++;
+            ret[outputi + i].fill((s16)val);
         }
     }
 
@@ -87,12 +95,42 @@ StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data, con
 
     StereoBuffer16 ret(sample_count);
 
+    size_t i = 0;
+
     if (num_channels == 1) {
-        for (size_t i = 0; i < sample_count; i++) {
+#ifdef ARCHITECTURE_x86_64
+        // Sixteen input bytes produce sixteen samples, each duplicated into both channels.
+        for (; i + 16 <= sample_count; i += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // Unpacking a register with itself places each byte in the high half of a word;
+            // the arithmetic shift then sign extends to PCM16.
+            const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+            const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+
+            s16* out = &ret[i][0];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), _mm_unpacklo_epi16(lo, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi16(lo, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpacklo_epi16(hi, hi));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 24), _mm_unpackhi_epi16(hi, hi));
+        }
+#endif
+        for (; i < sample_count; i++) {
             ret[i].fill(SignExtendS8(data[i]));
         }
     } else {
-        for (size_t i = 0; i < sample_count; i++) {
+#ifdef ARCHITECTURE_x86_64
+        // Interleaved stereo: sixteen input bytes produce eight stereo sample pairs.
+        for (; i + 8 <= sample_count; i += 8) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+            const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+            const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+
+            s16* out = &ret[i][0];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), hi);
+        }
+#endif
+        for (; i < sample_count; i++) {
             ret[i][0] = SignExtendS8(data[i * 2 + 0]);
             ret[i][1] = SignExtendS8(data[i * 2 + 1]);
         }
@@ -107,7 +145,18 @@ StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data, co
     StereoBuffer16 ret(sample_count);
 
     if (num_channels == 1) {
-        for (size_t i = 0; i < sample_count; i++) {
+        size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+        // Eight input samples at a time, each duplicated into both channels.
+        for (; i + 8 <= sample_count; i += 8) {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * sizeof(s16)));
+
+            s16* out = &ret[i][0];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), _mm_unpacklo_epi16(samples, samples));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi16(samples, samples));
+        }
+#endif
+        for (; i < sample_count; i++) {
             s16 sample;
             std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
             ret[i].fill(sample);
@@ -3,7 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <condition_variable>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <thread>
+
+#include "common/thread.h"
+#include "common/thread_topology.h"
 
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/mixers.h"
@@ -54,35 +61,94 @@ static std::array<Source, num_sources> sources = {
 };
 static Mixers mixers;
 
-static StereoFrame16 GenerateCurrentFrame() {
-    SharedMemory& read = ReadRegion();
-    SharedMemory& write = WriteRegion();
+// Frame generation runs on a dedicated audio thread so the mixing work doesn't eat into the
+// emu thread's frame budget. The shared memory regions are only ever touched on the emu
+// thread: each tick snapshots the inputs of the current frame and publishes the outputs of
+// the previous one, double-buffering the handoff through the structures below.
+
+/// Inputs of one audio frame, copied out of the read region on the emu thread
+struct FrameInputs {
+    SourceConfiguration source_configurations;
+    AdpcmCoefficients adpcm_coefficients;
+    DspConfiguration dsp_configuration;
+    IntermediateMixSamples intermediate_mix_samples;
+};
+
+/// Outputs of one audio frame, copied into the write region on the emu thread
+struct FrameOutputs {
+    SourceStatus source_statuses;
+    DspStatus dsp_status;
+    IntermediateMixSamples intermediate_mix_samples;
+    FinalMixSamples final_samples;
+};
 
+static std::thread audio_thread;
+static std::mutex audio_mutex;
+static std::condition_variable audio_cv;
+static bool audio_thread_exit = false;
+static bool frame_pending = false;   ///< frame_inputs holds a frame the worker hasn't taken yet
+static bool worker_idle = true;      ///< The worker is between frames; the emu thread may touch the buffers
+static bool outputs_valid = false;   ///< frame_outputs holds a finished frame awaiting publication
+static FrameInputs frame_inputs;
+static FrameOutputs frame_outputs;
+
+/// Generates one frame of every source and the final mix from snapshotted inputs.
+/// `inputs` is mutated the same way the DSP mutates shared memory (dirty flags cleared).
+static StereoFrame16 GenerateFrame(FrameInputs& inputs, FrameOutputs& outputs) {
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
     // Generate intermediate mixes
     for (size_t i = 0; i < num_sources; i++) {
-        write.source_statuses.status[i] = sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+        outputs.source_statuses.status[i] = sources[i].Tick(inputs.source_configurations.config[i], inputs.adpcm_coefficients.coeff[i]);
         for (size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
     }
 
     // Generate final mix
-    write.dsp_status = mixers.Tick(read.dsp_configuration, read.intermediate_mix_samples, write.intermediate_mix_samples, intermediate_mixes);
+    outputs.dsp_status = mixers.Tick(inputs.dsp_configuration, inputs.intermediate_mix_samples, outputs.intermediate_mix_samples, intermediate_mixes);
 
     StereoFrame16 output_frame = mixers.GetOutput();
 
-    // Write current output frame to the shared memory region
+    // Write current output frame to the outputs structure
     for (size_t samplei = 0; samplei < output_frame.size(); samplei++) {
         for (size_t channeli = 0; channeli < output_frame[0].size(); channeli++) {
-            write.final_samples.pcm16[samplei][channeli] = s16_le(output_frame[samplei][channeli]);
+            outputs.final_samples.pcm16[samplei][channeli] = s16_le(output_frame[samplei][channeli]);
         }
     }
 
     return output_frame;
 }
 
+/// Copies the current frame's inputs out of the read region. Runs on the emu thread, so it
+/// can consume the dirty flags in place: the synchronous path would also have left them
+/// cleared by the end of the tick, and the app may safely set new ones while the frame is
+/// being generated.
+static void SnapshotFrameInputs() {
+    SharedMemory& read = ReadRegion();
+
+    // BitField intentionally has no copy assignment, so these structs are copied bytewise.
+    std::memcpy(&frame_inputs.source_configurations, &read.source_configurations, sizeof(SourceConfiguration));
+    std::memcpy(&frame_inputs.adpcm_coefficients, &read.adpcm_coefficients, sizeof(AdpcmCoefficients));
+    std::memcpy(&frame_inputs.dsp_configuration, &read.dsp_configuration, sizeof(DspConfiguration));
+    std::memcpy(&frame_inputs.intermediate_mix_samples, &read.intermediate_mix_samples, sizeof(IntermediateMixSamples));
+
+    for (size_t i = 0; i < num_sources; i++) {
+        read.source_configurations.config[i].dirty_raw = 0;
+    }
+    read.dsp_configuration.dirty_raw = 0;
+}
+
+/// Copies the previous frame's outputs into the write region. Runs on the emu thread.
+static void PublishFrameOutputs() {
+    SharedMemory& write = WriteRegion();
+
+    std::memcpy(&write.source_statuses, &frame_outputs.source_statuses, sizeof(SourceStatus));
+    std::memcpy(&write.dsp_status, &frame_outputs.dsp_status, sizeof(DspStatus));
+    std::memcpy(&write.intermediate_mix_samples, &frame_outputs.intermediate_mix_samples, sizeof(IntermediateMixSamples));
+    std::memcpy(&write.final_samples, &frame_outputs.final_samples, sizeof(FinalMixSamples));
+}
+
 // Audio output
 
 static std::unique_ptr<AudioCore::Sink> sink;
@@ -93,6 +159,37 @@ static void OutputCurrentFrame(const StereoFrame16& frame) {
     sink->EnqueueSamples(time_stretcher.Process(sink->SamplesInQueue()));
 }
 
+// Audio thread
+
+/// Generates and outputs one frame per request from the emu thread. Time stretching and sink
+/// submission also happen here, off the emu thread.
+static void AudioThread() {
+    Common::RegisterCurrentThread(Common::ThreadRole::Audio, "DSP audio");
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(audio_mutex);
+            audio_cv.wait(lock, [] { return frame_pending || audio_thread_exit; });
+            if (audio_thread_exit) {
+                Common::UnregisterCurrentThread();
+                return;
+            }
+            frame_pending = false;
+            worker_idle = false;
+        }
+
+        StereoFrame16 current_frame = GenerateFrame(frame_inputs, frame_outputs);
+        OutputCurrentFrame(current_frame);
+
+        {
+            std::lock_guard<std::mutex> lock(audio_mutex);
+            worker_idle = true;
+            outputs_valid = true;
+        }
+        audio_cv.notify_one();
+    }
+}
+
 // Public Interface
 
 void Init() {
@@ -108,9 +205,24 @@ void Init() {
     if (sink) {
         time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
     }
+
+    audio_thread_exit = false;
+    frame_pending = false;
+    worker_idle = true;
+    outputs_valid = false;
+    audio_thread = std::thread(AudioThread);
 }
 
 void Shutdown() {
+    if (audio_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(audio_mutex);
+            audio_thread_exit = true;
+        }
+        audio_cv.notify_one();
+        audio_thread.join();
+    }
+
     time_stretcher.Flush();
     while (true) {
         std::vector<s16> residual_audio = time_stretcher.Process(sink->SamplesInQueue());
@@ -121,11 +233,30 @@ void Shutdown() {
 }
 
 bool Tick() {
-    StereoFrame16 current_frame = {};
-
     // TODO: Check dsp::DSP semaphore (which indicates emulated application has finished writing to shared memory region)
-    current_frame = GenerateCurrentFrame();
 
+    if (audio_thread.joinable()) {
+        std::unique_lock<std::mutex> lock(audio_mutex);
+        // The worker had the whole previous ~5ms audio frame interval to finish, so this wait
+        // is normally a no-op.
+        audio_cv.wait(lock, [] { return worker_idle && !frame_pending; });
+
+        if (outputs_valid) {
+            PublishFrameOutputs();
+            outputs_valid = false;
+        }
+        SnapshotFrameInputs();
+
+        frame_pending = true;
+        lock.unlock();
+        audio_cv.notify_one();
+        return true;
+    }
+
+    // Fallback: generate and output the frame synchronously on this thread.
+    SnapshotFrameInputs();
+    StereoFrame16 current_frame = GenerateFrame(frame_inputs, frame_outputs);
+    PublishFrameOutputs();
     OutputCurrentFrame(current_frame);
 
     return true;
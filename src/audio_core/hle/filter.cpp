@@ -4,6 +4,11 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/dsp.h"
@@ -42,14 +47,102 @@ void SourceFilters::ProcessFrame(StereoFrame16& frame) {
         return;
 
     if (simple_filter_enabled) {
-        FilterFrame(frame, simple_filter);
+        simple_filter.ProcessFrame(frame);
     }
 
     if (biquad_filter_enabled) {
-        FilterFrame(frame, biquad_filter);
+        biquad_filter.ProcessFrame(frame);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+// Both channels of the filter state ride in the low two s32 lanes of one register, so each
+// recurrence step is a handful of vector ops instead of two scalar channel loops.
+
+/// Loads a stereo PCM16 sample pair into the low two lanes, sign extended to 32 bits.
+static __m128i LoadSamplePair(const std::array<s16, 2>& sample) {
+    u32 bits;
+    std::memcpy(&bits, sample.data(), sizeof(bits));
+    const __m128i pair = _mm_cvtsi32_si128(bits);
+    return _mm_srai_epi32(_mm_unpacklo_epi16(pair, pair), 16);
+}
+
+/// Multiplies each lane by a coefficient in s16 range. The lanes themselves hold values in
+/// s16 range, so their low halves are the values and their high halves the sign extension;
+/// pairing with (coefficient, 0) makes pmaddwd compute value * coefficient per lane.
+static __m128i MultiplyCoefficient(__m128i samples, s32 coefficient) {
+    return _mm_madd_epi16(samples, _mm_set1_epi32(static_cast<u16>(coefficient)));
+}
+
+/// Clamps the low two s32 lanes to s16 and stores them as a stereo sample pair.
+static __m128i ClampAndStore(__m128i value, std::array<s16, 2>& out) {
+    const __m128i packed = _mm_packs_epi32(value, value);
+    const u32 bits = static_cast<u32>(_mm_cvtsi128_si32(packed));
+    std::memcpy(out.data(), &bits, sizeof(bits));
+    // Return the clamped pair sign extended again, ready for the feedback path.
+    return _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+}
+
+void SourceFilters::SimpleFilter::ProcessFrame(StereoFrame16& frame) {
+    __m128i y1v = LoadSamplePair(y1);
+
+    for (auto& sample : frame) {
+        const __m128i x0v = LoadSamplePair(sample);
+        // y0 = (b0 * x0 + a1 * y1) >> 15
+        const __m128i acc = _mm_add_epi32(MultiplyCoefficient(x0v, b0), MultiplyCoefficient(y1v, a1));
+        y1v = ClampAndStore(_mm_srai_epi32(acc, 15), sample);
+    }
+
+    const __m128i packed = _mm_packs_epi32(y1v, y1v);
+    const u32 bits = static_cast<u32>(_mm_cvtsi128_si32(packed));
+    std::memcpy(y1.data(), &bits, sizeof(bits));
+}
+
+void SourceFilters::BiquadFilter::ProcessFrame(StereoFrame16& frame) {
+    __m128i x1v = LoadSamplePair(x1);
+    __m128i x2v = LoadSamplePair(x2);
+    __m128i y1v = LoadSamplePair(y1);
+    __m128i y2v = LoadSamplePair(y2);
+
+    for (auto& sample : frame) {
+        const __m128i x0v = LoadSamplePair(sample);
+        // y0 = (b0 * x0 + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2) >> 14
+        __m128i acc = MultiplyCoefficient(x0v, b0);
+        acc = _mm_add_epi32(acc, MultiplyCoefficient(x1v, b1));
+        acc = _mm_add_epi32(acc, MultiplyCoefficient(x2v, b2));
+        acc = _mm_add_epi32(acc, MultiplyCoefficient(y1v, a1));
+        acc = _mm_add_epi32(acc, MultiplyCoefficient(y2v, a2));
+
+        x2v = x1v;
+        x1v = x0v;
+        y2v = y1v;
+        y1v = ClampAndStore(_mm_srai_epi32(acc, 14), sample);
     }
+
+    const auto store_pair = [](__m128i value, std::array<s16, 2>& out) {
+        const __m128i packed = _mm_packs_epi32(value, value);
+        const u32 bits = static_cast<u32>(_mm_cvtsi128_si32(packed));
+        std::memcpy(out.data(), &bits, sizeof(bits));
+    };
+    store_pair(x1v, x1);
+    store_pair(x2v, x2);
+    store_pair(y1v, y1);
+    store_pair(y2v, y2);
 }
 
+#else
+
+void SourceFilters::SimpleFilter::ProcessFrame(StereoFrame16& frame) {
+    FilterFrame(frame, *this);
+}
+
+void SourceFilters::BiquadFilter::ProcessFrame(StereoFrame16& frame) {
+    FilterFrame(frame, *this);
+}
+
+#endif // ARCHITECTURE_x86_64
+
 // SimpleFilter
 
 void SourceFilters::SimpleFilter::Reset() {
@@ -72,6 +72,12 @@ private:
          */
         std::array<s16, 2> ProcessSample(const std::array<s16, 2>& x0);
 
+        /**
+         * Processes a whole frame in-place, keeping filter state in registers across samples.
+         * @param frame Audio samples to process. Modified in-place.
+         */
+        void ProcessFrame(StereoFrame16& frame);
+
     private:
         // Configuration
         s32 a1, b0;
@@ -98,6 +104,12 @@ private:
          */
         std::array<s16, 2> ProcessSample(const std::array<s16, 2>& x0);
 
+        /**
+         * Processes a whole frame in-place, keeping filter state in registers across samples.
+         * @param frame Audio samples to process. Modified in-place.
+         */
+        void ProcessFrame(StereoFrame16& frame);
+
     private:
         // Configuration
         s32 a1, a2, b0, b1, b2;
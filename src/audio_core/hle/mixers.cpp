@@ -4,6 +4,10 @@
 
 #include <cstddef>
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/mixers.h"
@@ -90,6 +94,7 @@ void Mixers::ParseConfig(DspConfiguration& config) {
     config.dirty_raw = 0;
 }
 
+#ifndef ARCHITECTURE_x86_64
 static s16 ClampToS16(s32 value) {
     return static_cast<s16>(MathUtil::Clamp(value, -32768, 32767));
 }
@@ -100,10 +105,61 @@ static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a, const st
         ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))
     };
 }
+#endif
 
 void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& samples) {
     // TODO(merry): Limiter. (Currently we're performing final mixing assuming a disabled limiter.)
 
+#ifdef ARCHITECTURE_x86_64
+    // Four samples per iteration: each quad is gained and folded down in float, truncated back
+    // to integer, then packed and accumulated with 16 bit saturation — the packing and the
+    // saturating add perform the two ClampToS16 passes of the scalar code.
+    const __m128 gain_vec = _mm_set1_ps(gain);
+    static_assert(samples_per_frame % 4 == 0, "Vectorized downmix assumes a multiple of four samples");
+
+    const auto downmix_stereo_pair = [gain_vec](const s32* quads) -> __m128 {
+        // (L0, R0, L1, R1) = gain * (a0, a1, b0, b1) + gain * (a2, a3, b2, b3), kept in float
+        // so that the truncation to integer happens exactly once, as in the scalar code.
+        const __m128 a = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(quads)));
+        const __m128 b = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(quads + 4)));
+        const __m128 front = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m128 back = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 2, 3, 2));
+        return _mm_add_ps(_mm_mul_ps(gain_vec, front), _mm_mul_ps(gain_vec, back));
+    };
+
+    switch (state.output_format) {
+    case OutputFormat::Mono:
+        for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+            // Sum all four channels of each sample, halve, and replicate into both output channels.
+            const __m128 half = _mm_set1_ps(0.5f);
+            __m128i mono[2];
+            for (size_t i = 0; i < 2; i++) {
+                const __m128 stereo = downmix_stereo_pair(&samples[samplei + i * 2][0]);
+                const __m128 sum = _mm_add_ps(stereo, _mm_shuffle_ps(stereo, stereo, _MM_SHUFFLE(2, 3, 0, 1)));
+                // Lanes 0 and 2 hold the mono samples; replicate each into an (M, M) pair.
+                mono[i] = _mm_shuffle_epi32(_mm_cvttps_epi32(_mm_mul_ps(sum, half)), _MM_SHUFFLE(2, 2, 0, 0));
+            }
+
+            __m128i* const out = reinterpret_cast<__m128i*>(&current_frame[samplei][0]);
+            _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), _mm_packs_epi32(mono[0], mono[1])));
+        }
+        return;
+
+    case OutputFormat::Surround:
+        // TODO(merry): Implement surround sound.
+        // fallthrough
+
+    case OutputFormat::Stereo:
+        for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+            const __m128i stereo0 = _mm_cvttps_epi32(downmix_stereo_pair(&samples[samplei + 0][0]));
+            const __m128i stereo1 = _mm_cvttps_epi32(downmix_stereo_pair(&samples[samplei + 2][0]));
+
+            __m128i* const out = reinterpret_cast<__m128i*>(&current_frame[samplei][0]);
+            _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), _mm_packs_epi32(stereo0, stereo1)));
+        }
+        return;
+    }
+#else
     switch (state.output_format) {
     case OutputFormat::Mono:
         std::transform(current_frame.begin(), current_frame.end(), samples.begin(), current_frame.begin(),
@@ -130,6 +186,7 @@ void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& sample
             });
         return;
     }
+#endif
 
     UNREACHABLE_MSG("Invalid output_format %zu", static_cast<size_t>(state.output_format));
 }
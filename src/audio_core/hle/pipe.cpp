@@ -19,41 +19,53 @@ namespace HLE {
 
 static DspState dsp_state = DspState::Off;
 
-static std::array<std::vector<u8>, NUM_DSP_PIPE> pipe_data;
+// Each pipe keeps its bytes in an append-only vector with a read cursor, so reads hand out
+// views into the backing store instead of copying and front-erasing. Views stay valid until
+// the next write to that pipe or a reset, which is when the consumed prefix is reclaimed.
+struct PipeBuffer {
+    std::vector<u8> data;
+    size_t read_offset = 0;
+};
+
+static std::array<PipeBuffer, NUM_DSP_PIPE> pipe_data;
 
 void ResetPipes() {
-    for (auto& data : pipe_data) {
-        data.clear();
+    for (auto& pipe : pipe_data) {
+        pipe.data.clear();
+        pipe.read_offset = 0;
     }
     dsp_state = DspState::Off;
 }
 
-std::vector<u8> PipeRead(DspPipe pipe_number, u32 length) {
+const u8* PipeRead(DspPipe pipe_number, u32& length) {
     const size_t pipe_index = static_cast<size_t>(pipe_number);
 
     if (pipe_index >= NUM_DSP_PIPE) {
         LOG_ERROR(Audio_DSP, "pipe_number = %zu invalid", pipe_index);
-        return {};
+        length = 0;
+        return nullptr;
     }
 
     if (length > UINT16_MAX) { // Can only read at most UINT16_MAX from the pipe
         LOG_ERROR(Audio_DSP, "length of %u greater than max of %u", length, UINT16_MAX);
-        return {};
+        length = 0;
+        return nullptr;
     }
 
-    std::vector<u8>& data = pipe_data[pipe_index];
+    PipeBuffer& pipe = pipe_data[pipe_index];
+    const size_t readable = pipe.data.size() - pipe.read_offset;
 
-    if (length > data.size()) {
+    if (length > readable) {
         LOG_WARNING(Audio_DSP, "pipe_number = %zu is out of data, application requested read of %u but %zu remain",
-                    pipe_index, length, data.size());
-        length = static_cast<u32>(data.size());
+                    pipe_index, length, readable);
+        length = static_cast<u32>(readable);
     }
 
     if (length == 0)
-        return {};
+        return nullptr;
 
-    std::vector<u8> ret(data.begin(), data.begin() + length);
-    data.erase(data.begin(), data.begin() + length);
+    const u8* ret = pipe.data.data() + pipe.read_offset;
+    pipe.read_offset += length;
     return ret;
 }
 
@@ -65,16 +77,21 @@ size_t GetPipeReadableSize(DspPipe pipe_number) {
         return 0;
     }
 
-    return pipe_data[pipe_index].size();
+    return pipe_data[pipe_index].data.size() - pipe_data[pipe_index].read_offset;
 }
 
 static void WriteU16(DspPipe pipe_number, u16 value) {
     const size_t pipe_index = static_cast<size_t>(pipe_number);
 
-    std::vector<u8>& data = pipe_data.at(pipe_index);
+    PipeBuffer& pipe = pipe_data.at(pipe_index);
+    // Reclaim the consumed prefix; this is the point at which outstanding views lapse.
+    if (pipe.read_offset > 0) {
+        pipe.data.erase(pipe.data.begin(), pipe.data.begin() + pipe.read_offset);
+        pipe.read_offset = 0;
+    }
     // Little endian
-    data.emplace_back(value & 0xFF);
-    data.emplace_back(value >> 8);
+    pipe.data.emplace_back(value & 0xFF);
+    pipe.data.emplace_back(value >> 8);
 }
 
 static void AudioPipeWriteStructAddresses() {
@@ -108,11 +125,11 @@ static void AudioPipeWriteStructAddresses() {
     DSP_DSP::SignalPipeInterrupt(DspPipe::Audio);
 }
 
-void PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) {
+void PipeWrite(DspPipe pipe_number, const u8* buffer, u32 length) {
     switch (pipe_number) {
     case DspPipe::Audio: {
-        if (buffer.size() != 4) {
-            LOG_ERROR(Audio_DSP, "DspPipe::Audio: Unexpected buffer length %zu was written", buffer.size());
+        if (length != 4) {
+            LOG_ERROR(Audio_DSP, "DspPipe::Audio: Unexpected buffer length %u was written", length);
             return;
         }
 
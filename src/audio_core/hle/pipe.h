@@ -26,14 +26,14 @@ constexpr size_t NUM_DSP_PIPE = 8;
 /**
  * Reads `length` bytes from the DSP pipe identified with `pipe_number`.
  * @note Can read up to the maximum value of a u16 in bytes (65,535).
- * @note IF an error is encoutered with either an invalid `pipe_number` or `length` value, an empty vector will be returned.
- * @note IF `length` is set to 0, an empty vector will be returned.
+ * @note IF an error is encoutered with either an invalid `pipe_number` or `length` value, `length` is set to 0 and nullptr is returned.
+ * @note IF `length` is set to 0, nullptr will be returned.
  * @note IF `length` is greater than the amount of data available, this function will only read the available amount.
  * @param pipe_number a `DspPipe`
- * @param length the number of bytes to read. The max is 65,535 (max of u16).
- * @returns a vector of bytes from the specified pipe. On error, will be empty.
+ * @param length In: the number of bytes to read, max 65,535 (max of u16). Out: the number of bytes actually read.
+ * @returns a view into the pipe's backing store, valid until the next pipe write or reset. On error, nullptr.
  */
-std::vector<u8> PipeRead(DspPipe pipe_number, u32 length);
+const u8* PipeRead(DspPipe pipe_number, u32& length);
 
 /**
  * How much data is left in pipe
@@ -45,9 +45,10 @@ size_t GetPipeReadableSize(DspPipe pipe_number);
 /**
  * Write to a DSP pipe.
  * @param pipe_number The Pipe ID
- * @param buffer The data to write to the pipe.
+ * @param buffer The data to write to the pipe. May point directly into guest memory.
+ * @param length Length of the data in bytes.
  */
-void PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer);
+void PipeWrite(DspPipe pipe_number, const u8* buffer, u32 length);
 
 enum class DspState {
     Off,
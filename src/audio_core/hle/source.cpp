@@ -5,6 +5,10 @@
 #include <algorithm>
 #include <array>
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/source.h"
@@ -33,6 +37,27 @@ void Source::MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const {
         return;
 
     const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
+#ifdef ARCHITECTURE_x86_64
+    // Two samples per iteration: each stereo pair is replicated into (L, R, L, R), gained,
+    // truncated back to integer (matching the scalar static_cast) and accumulated.
+    const __m128 gain_vec = _mm_loadu_ps(gains.data());
+    static_assert(samples_per_frame % 2 == 0, "Vectorized mix assumes an even frame length");
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 2) {
+        // Sign extend (L0, R0, L1, R1) to 32 bits.
+        const __m128i pairs16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&current_frame[samplei][0]));
+        const __m128i pairs32 = _mm_srai_epi32(_mm_unpacklo_epi16(pairs16, pairs16), 16);
+
+        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+        const __m128 quad0 = _mm_cvtepi32_ps(_mm_shuffle_epi32(pairs32, _MM_SHUFFLE(1, 0, 1, 0)));
+        const __m128 quad1 = _mm_cvtepi32_ps(_mm_shuffle_epi32(pairs32, _MM_SHUFFLE(3, 2, 3, 2)));
+
+        s32* out = &dest[samplei][0];
+        __m128i* const out0 = reinterpret_cast<__m128i*>(out);
+        __m128i* const out1 = reinterpret_cast<__m128i*>(out + 4);
+        _mm_storeu_si128(out0, _mm_add_epi32(_mm_loadu_si128(out0), _mm_cvttps_epi32(_mm_mul_ps(gain_vec, quad0))));
+        _mm_storeu_si128(out1, _mm_add_epi32(_mm_loadu_si128(out1), _mm_cvttps_epi32(_mm_mul_ps(gain_vec, quad1))));
+    }
+#else
     for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
         // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
         dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
@@ -40,6 +65,7 @@ void Source::MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const {
         dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
         dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
     }
+#endif
 }
 
 void Source::Reset() {
@@ -282,8 +308,7 @@ bool Source::DequeueBuffer() {
         state.current_buffer = AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier);
         break;
     case InterpolationMode::Polyphase:
-        // TODO(merry): Implement polyphase interpolation
-        state.current_buffer = AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier);
+        state.current_buffer = AudioInterp::Polyphase(state.interp_state, state.current_buffer, state.rate_multiplier);
         break;
     default:
         UNIMPLEMENTED();
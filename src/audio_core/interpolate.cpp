@@ -2,6 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cmath>
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 #include "audio_core/interpolate.h"
 
 #include "common/assert.h"
@@ -82,4 +89,111 @@ StereoBuffer16 Linear(State& state, const StereoBuffer16& input, float rate_mult
     });
 }
 
+// Polyphase resampler: an eight-tap Hann-windowed sinc filter whose fractional offset is
+// quantized to one of 64 precomputed phases. Each phase's coefficients are stored duplicated
+// (c0, c0, c1, c1, ...) so one coefficient vector covers both channels of the interleaved
+// stereo window.
+
+constexpr size_t polyphase_taps = 8;
+constexpr size_t polyphase_phases = 64;
+
+using PolyphaseTable = std::array<std::array<float, polyphase_taps * 2>, polyphase_phases>;
+
+static PolyphaseTable BuildPolyphaseTable() {
+    PolyphaseTable table;
+
+    for (size_t phase = 0; phase < polyphase_phases; phase++) {
+        const double f = static_cast<double>(phase) / polyphase_phases;
+
+        double sum = 0.0;
+        double coeffs[polyphase_taps];
+        for (size_t k = 0; k < polyphase_taps; k++) {
+            // Offset from the reconstruction point; spans (-taps/2, taps/2] so the window
+            // tapers to zero at both edges.
+            const double x = (static_cast<double>(k) - (polyphase_taps / 2 - 1)) - f;
+            const double sinc = (x == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+            const double window = 0.5 + 0.5 * std::cos(M_PI * x / (polyphase_taps / 2));
+            coeffs[k] = sinc * window;
+            sum += coeffs[k];
+        }
+
+        // Normalize for unity DC gain, so constant input passes through unscaled.
+        for (size_t k = 0; k < polyphase_taps; k++) {
+            const float c = static_cast<float>(coeffs[k] / sum);
+            table[phase][k * 2 + 0] = c;
+            table[phase][k * 2 + 1] = c;
+        }
+    }
+
+    return table;
+}
+
+StereoBuffer16 Polyphase(State& state, const StereoBuffer16& input, float rate_multiplier) {
+    static const PolyphaseTable table = BuildPolyphaseTable();
+
+    ASSERT(rate_multiplier > 0);
+
+    if (input.size() < 2)
+        return {};
+
+    // Prepend the retained history so every window of taps samples is fully populated;
+    // padded[i + polyphase_taps - 1] is the newest sample of window i.
+    StereoBuffer16 padded;
+    padded.reserve(state.history.size() + input.size());
+    padded.insert(padded.end(), state.history.begin(), state.history.end());
+    padded.insert(padded.end(), input.begin(), input.end());
+
+    StereoBuffer16 output;
+    output.reserve(static_cast<size_t>(input.size() / rate_multiplier));
+
+    const u64 step_size = static_cast<u64>(rate_multiplier * scale_factor);
+    const u64 max_fposition = input.size() * scale_factor;
+
+    for (u64 fposition = 0; fposition < max_fposition; fposition += step_size) {
+        const size_t index = static_cast<size_t>(fposition / scale_factor);
+        const size_t phase = static_cast<size_t>((fposition & scale_mask) >> (24 - 6));
+
+        const float* const coeff = table[phase].data();
+        const s16* const window = &padded[index][0];
+
+#ifdef ARCHITECTURE_x86_64
+        // Two interleaved stereo pairs per vector; sign extend to 32 bits, convert to float
+        // and multiply-accumulate against the duplicated coefficients.
+        const __m128i w01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(window));
+        const __m128i w23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(window + 8));
+
+        __m128 acc = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(w01, w01), 16)), _mm_loadu_ps(coeff + 0));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(w01, w01), 16)), _mm_loadu_ps(coeff + 4)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(w23, w23), 16)), _mm_loadu_ps(coeff + 8)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(w23, w23), 16)), _mm_loadu_ps(coeff + 12)));
+
+        // Fold the four partial (L, R) lanes down to one pair; packing saturates to s16.
+        const __m128 folded = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        const __m128i rounded = _mm_packs_epi32(_mm_cvtps_epi32(folded), _mm_cvtps_epi32(folded));
+
+        output.push_back({
+            static_cast<s16>(_mm_extract_epi16(rounded, 0)),
+            static_cast<s16>(_mm_extract_epi16(rounded, 1))
+        });
+#else
+        float left = 0.0f, right = 0.0f;
+        for (size_t k = 0; k < polyphase_taps; k++) {
+            left += coeff[k * 2] * window[k * 2 + 0];
+            right += coeff[k * 2] * window[k * 2 + 1];
+        }
+
+        output.push_back({
+            static_cast<s16>(MathUtil::Clamp(std::lrint(left), long(-32768), long(32767))),
+            static_cast<s16>(MathUtil::Clamp(std::lrint(right), long(-32768), long(32767)))
+        });
+#endif
+    }
+
+    std::copy(padded.end() - state.history.size(), padded.end(), state.history.begin());
+    state.xn2 = input[input.size() - 2];
+    state.xn1 = input[input.size() - 1];
+
+    return output;
+}
+
 } // namespace AudioInterp
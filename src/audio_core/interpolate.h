@@ -18,6 +18,8 @@ struct State {
     // Two historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    // Deeper history for the polyphase filter, oldest first.
+    std::array<std::array<s16, 2>, 7> history = {};
 };
 
 /**
@@ -38,4 +40,15 @@ StereoBuffer16 None(State& state, const StereoBuffer16& input, float rate_multip
  */
 StereoBuffer16 Linear(State& state, const StereoBuffer16& input, float rate_multiplier);
 
+/**
+ * Polyphase resampling with an eight-tap Hann-windowed sinc filter selected from 64 precomputed
+ * phase tables. Considerably better stopband behaviour than linear interpolation at large rate
+ * ratios. There is a four-sample predelay.
+ * @param input Input buffer.
+ * @param rate_multiplier Stretch factor. Must be a positive non-zero value.
+ *                        rate_multiplier > 1.0 performs decimation and rate_multipler < 1.0 performs upsampling.
+ * @return The resampled audio buffer.
+ */
+StereoBuffer16 Polyphase(State& state, const StereoBuffer16& input, float rate_multiplier);
+
 } // namespace AudioInterp
@@ -2,7 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <list>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <vector>
 
 #include <SDL.h>
@@ -12,7 +15,6 @@
 
 #include "common/assert.h"
 #include "common/logging/log.h"
-#include <numeric>
 
 namespace AudioCore {
 
@@ -21,7 +23,18 @@ struct SDL2Sink::Impl {
 
     SDL_AudioDeviceID audio_device_id = 0;
 
-    std::list<std::vector<s16>> queue;
+    // Single-producer single-consumer lock-free ring of interleaved stereo PCM16. The emu
+    // thread produces in EnqueueSamples and the SDL audio callback consumes, so the realtime
+    // callback never blocks on a lock held by the emulator. Positions are monotonic counters
+    // in s16 units; ring_size is a power of two so masking performs the wraparound.
+    static constexpr size_t ring_size = 0x8000;
+    static_assert((ring_size & (ring_size - 1)) == 0, "ring_size must be a power of two");
+    std::array<s16, ring_size> ring;
+    std::atomic<size_t> read_pos{0};
+    std::atomic<size_t> write_pos{0};
+
+    std::atomic<size_t> underrun_samples{0};
+    std::atomic<size_t> overrun_samples{0};
 
     static void Callback(void* impl_, u8* buffer, int buffer_size_in_bytes);
 };
@@ -77,49 +90,65 @@ void SDL2Sink::EnqueueSamples(const std::vector<s16>& samples) {
 
     ASSERT_MSG(samples.size() % 2 == 0, "Samples must be in interleaved stereo PCM16 format (size must be a multiple of two)");
 
-    SDL_LockAudioDevice(impl->audio_device_id);
-    impl->queue.emplace_back(samples);
-    SDL_UnlockAudioDevice(impl->audio_device_id);
+    const size_t write = impl->write_pos.load(std::memory_order_relaxed);
+    const size_t read = impl->read_pos.load(std::memory_order_acquire);
+    const size_t free_space = Impl::ring_size - (write - read);
+
+    size_t to_write = samples.size();
+    if (to_write > free_space) {
+        // Keep whole stereo pairs so the channels can't swap.
+        to_write = free_space & ~size_t(1);
+        impl->overrun_samples.fetch_add((samples.size() - to_write) / 2, std::memory_order_relaxed);
+    }
+
+    const size_t offset = write & (Impl::ring_size - 1);
+    const size_t first = std::min(to_write, Impl::ring_size - offset);
+    std::memcpy(&impl->ring[offset], samples.data(), first * sizeof(s16));
+    std::memcpy(&impl->ring[0], samples.data() + first, (to_write - first) * sizeof(s16));
+
+    impl->write_pos.store(write + to_write, std::memory_order_release);
 }
 
 size_t SDL2Sink::SamplesInQueue() const {
     if (impl->audio_device_id <= 0)
         return 0;
 
-    SDL_LockAudioDevice(impl->audio_device_id);
+    const size_t write = impl->write_pos.load(std::memory_order_acquire);
+    const size_t read = impl->read_pos.load(std::memory_order_acquire);
 
-    size_t total_size = std::accumulate(impl->queue.begin(), impl->queue.end(), static_cast<size_t>(0),
-        [](size_t sum, const auto& buffer) {
-            // Division by two because each stereo sample is made of two s16.
-            return sum + buffer.size() / 2;
-        });
+    // Division by two because each stereo sample is made of two s16.
+    return (write - read) / 2;
+}
 
-    SDL_UnlockAudioDevice(impl->audio_device_id);
+size_t SDL2Sink::GetUnderrunCount() const {
+    return impl->underrun_samples.load(std::memory_order_relaxed);
+}
 
-    return total_size;
+size_t SDL2Sink::GetOverrunCount() const {
+    return impl->overrun_samples.load(std::memory_order_relaxed);
 }
 
 void SDL2Sink::Impl::Callback(void* impl_, u8* buffer, int buffer_size_in_bytes) {
     Impl* impl = reinterpret_cast<Impl*>(impl_);
 
-    size_t remaining_size = static_cast<size_t>(buffer_size_in_bytes) / sizeof(s16); // Keep track of size in 16-bit increments.
-
-    while (remaining_size > 0 && !impl->queue.empty()) {
-        if (impl->queue.front().size() <= remaining_size) {
-            memcpy(buffer, impl->queue.front().data(), impl->queue.front().size() * sizeof(s16));
-            buffer += impl->queue.front().size() * sizeof(s16);
-            remaining_size -= impl->queue.front().size();
-            impl->queue.pop_front();
-        } else {
-            memcpy(buffer, impl->queue.front().data(), remaining_size * sizeof(s16));
-            buffer += remaining_size * sizeof(s16);
-            impl->queue.front().erase(impl->queue.front().begin(), impl->queue.front().begin() + remaining_size);
-            remaining_size = 0;
-        }
-    }
+    const size_t requested = static_cast<size_t>(buffer_size_in_bytes) / sizeof(s16); // Keep track of size in 16-bit increments.
+
+    const size_t read = impl->read_pos.load(std::memory_order_relaxed);
+    const size_t write = impl->write_pos.load(std::memory_order_acquire);
+    const size_t available = write - read;
+
+    const size_t to_read = std::min(requested, available);
+
+    const size_t offset = read & (ring_size - 1);
+    const size_t first = std::min(to_read, ring_size - offset);
+    std::memcpy(buffer, &impl->ring[offset], first * sizeof(s16));
+    std::memcpy(buffer + first * sizeof(s16), &impl->ring[0], (to_read - first) * sizeof(s16));
+
+    impl->read_pos.store(read + to_read, std::memory_order_release);
 
-    if (remaining_size > 0) {
-        memset(buffer, 0, remaining_size * sizeof(s16));
+    if (to_read < requested) {
+        std::memset(buffer + to_read * sizeof(s16), 0, (requested - to_read) * sizeof(s16));
+        impl->underrun_samples.fetch_add((requested - to_read) / 2, std::memory_order_relaxed);
     }
 }
 
@@ -22,6 +22,11 @@ public:
 
     size_t SamplesInQueue() const override;
 
+    /// Number of stereo samples the callback had to zero-fill because the ring ran dry.
+    size_t GetUnderrunCount() const;
+    /// Number of stereo samples dropped because the ring was full.
+    size_t GetOverrunCount() const;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl;
@@ -32,6 +32,12 @@ constexpr size_t DROP_FRAMES_SAMPLE_DELAY = 16000; // Units: samples
 
 constexpr double SMOOTHING_FACTOR = 0.007;
 
+// When emulation runs at effectively full speed and the sink latency is healthy, SoundTouch
+// is bypassed entirely and samples pass straight through. Engaging is stricter than
+// disengaging so the mode doesn't flap on measurement noise.
+constexpr double BYPASS_ENGAGE_THRESHOLD = 0.02;    // |ratio - 1| below this may bypass
+constexpr double BYPASS_DISENGAGE_THRESHOLD = 0.05; // |ratio - 1| above this must stretch
+
 struct TimeStretcher::Impl {
     soundtouch::SoundTouch soundtouch;
 
@@ -41,6 +47,9 @@ struct TimeStretcher::Impl {
     double smoothed_ratio = 1.0;
 
     double sample_rate = static_cast<double>(native_sample_rate);
+
+    bool bypass_active = false;
+    std::vector<s16> bypass_queue; ///< Samples accumulated while bypassing, interleaved stereo
 };
 
 std::vector<s16> TimeStretcher::Process(size_t samples_in_queue) {
@@ -51,10 +60,24 @@ std::vector<s16> TimeStretcher::Process(size_t samples_in_queue) {
     impl->smoothed_ratio = (1.0 - SMOOTHING_FACTOR) * impl->smoothed_ratio + SMOOTHING_FACTOR * ratio;
     impl->smoothed_ratio = ClampRatio(impl->smoothed_ratio);
 
-    // SoundTouch's tempo definition the inverse of our ratio definition.
-    impl->soundtouch.setTempo(1.0 / impl->smoothed_ratio);
+    UpdateBypassState(samples_in_queue);
+
+    std::vector<s16> samples;
+    if (impl->soundtouch.numSamples() > 0) {
+        // Steady-state bypass leaves nothing in SoundTouch; this also drains the remainder
+        // just after a transition into bypass.
+        samples = GetSamples();
+    }
+
+    if (!impl->bypass_queue.empty()) {
+        if (samples.empty()) {
+            samples.swap(impl->bypass_queue);
+        } else {
+            samples.insert(samples.end(), impl->bypass_queue.begin(), impl->bypass_queue.end());
+            impl->bypass_queue.clear();
+        }
+    }
 
-    std::vector<s16> samples = GetSamples();
     if (samples_in_queue >= DROP_FRAMES_SAMPLE_DELAY) {
         samples.clear();
         LOG_DEBUG(Audio, "Dropping frames!");
@@ -62,6 +85,39 @@ std::vector<s16> TimeStretcher::Process(size_t samples_in_queue) {
     return samples;
 }
 
+void TimeStretcher::UpdateBypassState(size_t sample_delay) {
+    const size_t min_sample_delay = static_cast<size_t>(MIN_DELAY_TIME * impl->sample_rate);
+    const size_t max_sample_delay = static_cast<size_t>(MAX_DELAY_TIME * impl->sample_rate);
+    const bool delay_healthy = sample_delay >= min_sample_delay && sample_delay <= max_sample_delay;
+    const double drift = std::abs(impl->smoothed_ratio - 1.0);
+
+    // Only bypass when the output rate matches the native rate, otherwise SoundTouch is also
+    // doing the rate conversion and can't be skipped.
+    const bool rate_matches = impl->sample_rate == static_cast<double>(native_sample_rate);
+
+    if (!impl->bypass_active) {
+        if (rate_matches && delay_healthy && drift < BYPASS_ENGAGE_THRESHOLD) {
+            // Push the remaining buffered input through; it is drained by the next GetSamples.
+            impl->soundtouch.flush();
+            impl->soundtouch.setTempo(1.0);
+            impl->bypass_active = true;
+            LOG_DEBUG(Audio, "Bypassing time stretcher (running at full speed)");
+        } else {
+            // SoundTouch's tempo definition the inverse of our ratio definition.
+            impl->soundtouch.setTempo(1.0 / impl->smoothed_ratio);
+        }
+    } else if (!rate_matches || !delay_healthy || drift > BYPASS_DISENGAGE_THRESHOLD) {
+        // Re-engage stretching, starting from the samples accumulated while bypassing.
+        if (!impl->bypass_queue.empty()) {
+            impl->soundtouch.putSamples(impl->bypass_queue.data(), static_cast<uint>(impl->bypass_queue.size() / 2));
+            impl->bypass_queue.clear();
+        }
+        impl->soundtouch.setTempo(1.0 / impl->smoothed_ratio);
+        impl->bypass_active = false;
+        LOG_DEBUG(Audio, "Re-engaging time stretcher");
+    }
+}
+
 TimeStretcher::TimeStretcher() : impl(std::make_unique<Impl>()) {
     impl->soundtouch.setPitch(1.0);
     impl->soundtouch.setChannels(2);
@@ -79,7 +135,11 @@ void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
 }
 
 void TimeStretcher::AddSamples(const s16* buffer, size_t num_samples) {
-    impl->soundtouch.putSamples(buffer, static_cast<uint>(num_samples));
+    if (impl->bypass_active) {
+        impl->bypass_queue.insert(impl->bypass_queue.end(), buffer, buffer + num_samples * 2);
+    } else {
+        impl->soundtouch.putSamples(buffer, static_cast<uint>(num_samples));
+    }
     impl->samples_queued += num_samples;
 }
 
@@ -93,6 +153,8 @@ void TimeStretcher::Reset() {
     impl->smoothed_ratio = 1.0;
     impl->frame_timer = steady_clock::now();
     impl->samples_queued = 0;
+    impl->bypass_active = false;
+    impl->bypass_queue.clear();
     SetOutputSampleRate(native_sample_rate);
 }
 
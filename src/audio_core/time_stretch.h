@@ -50,6 +50,8 @@ private:
     double CalculateCurrentRatio();
     /// INTERNAL: If we have too many or too few samples downstream, nudge ratio in the appropriate direction.
     double CorrectForUnderAndOverflow(double ratio, size_t sample_delay) const;
+    /// INTERNAL: Engages or disengages the SoundTouch bypass based on the current ratio and sink latency.
+    void UpdateBypassState(size_t sample_delay);
     /// INTERNAL: Gets the time-stretched samples from SoundTouch.
     std::vector<s16> GetSamples();
 };
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <cstdio>
 #include <string>
 #include <thread>
 #include <iostream>
@@ -22,16 +24,23 @@
 #include "common/logging/filter.h"
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
+#include "common/telemetry.h"
+#include "common/thread_topology.h"
 
 #include "core/settings.h"
 #include "core/system.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/loader/loader.h"
+#include "core/movie.h"
+#include "core/tracer/playback.h"
 
 #include "citra/config.h"
 #include "citra/emu_window/emu_window_sdl2.h"
 
+#include "video_core/pipeline_stats.h"
+#include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 
@@ -39,6 +48,12 @@ static void PrintHelp(const char *argv0)
 {
     std::cout << "Usage: " << argv0 << " [options] <filename>\n"
                  "-g, --gdbport=NUMBER  Enable gdb stub on port NUMBER\n"
+                 "-p, --play-trace=FILE Replay a CiTrace (.ctf) GPU trace as a benchmark\n"
+                 "-b, --bench=FRAMES    Emulate FRAMES frames headless, print timing stats and exit\n"
+                 "-r, --record-movie=FILE Record the HID input stream to FILE\n"
+                 "-m, --play-movie=FILE Replay a recorded HID input stream from FILE\n"
+                 "-d, --deterministic   Remove host-dependent influences on emulation so two\n"
+                 "                      runs of the same build execute identically\n"
                  "-h, --help            Display this help and exit\n"
                  "-v, --version         Output version information and exit\n";
 }
@@ -56,16 +71,26 @@ int main(int argc, char **argv) {
     u32 gdb_port = static_cast<u32>(Settings::values.gdbstub_port);
     char *endarg;
     std::string boot_filename;
+    std::string play_trace_filename;
+    std::string record_movie_filename;
+    std::string play_movie_filename;
+    u64 bench_frames = 0;
+    bool deterministic_mode = Settings::values.deterministic_mode;
 
     static struct option long_options[] = {
         { "gdbport", required_argument, 0, 'g' },
+        { "play-trace", required_argument, 0, 'p' },
+        { "bench", required_argument, 0, 'b' },
+        { "record-movie", required_argument, 0, 'r' },
+        { "play-movie", required_argument, 0, 'm' },
+        { "deterministic", no_argument, 0, 'd' },
         { "help", no_argument, 0, 'h' },
         { "version", no_argument, 0, 'v' },
         { 0, 0, 0, 0 }
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "g:hv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "g:p:b:r:m:dhv", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
             case 'g':
@@ -78,6 +103,27 @@ int main(int argc, char **argv) {
                     exit(1);
                 }
                 break;
+            case 'p':
+                play_trace_filename = optarg;
+                break;
+            case 'b':
+                errno = 0;
+                bench_frames = strtoull(optarg, &endarg, 0);
+                if (endarg == optarg) errno = EINVAL;
+                if (errno != 0) {
+                    perror("--bench");
+                    exit(1);
+                }
+                break;
+            case 'r':
+                record_movie_filename = optarg;
+                break;
+            case 'm':
+                play_movie_filename = optarg;
+                break;
+            case 'd':
+                deterministic_mode = true;
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -93,11 +139,13 @@ int main(int argc, char **argv) {
 
     Log::Filter log_filter(Log::Level::Debug);
     Log::SetFilter(&log_filter);
+    Log::StartAsyncBackend();
+    SCOPE_EXIT({ Log::StopAsyncBackend(); });
 
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
 
-    if (boot_filename.empty()) {
+    if (boot_filename.empty() && play_trace_filename.empty()) {
         LOG_CRITICAL(Frontend, "Failed to load ROM: No ROM specified");
         return -1;
     }
@@ -107,13 +155,71 @@ int main(int argc, char **argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    Settings::values.deterministic_mode = deterministic_mode;
+    if (bench_frames != 0) {
+        // Benchmark runs are headless: audio goes to the null sink so the host audio device
+        // can't throttle emulation, and no input events are delivered, so the pad stays in its
+        // neutral state on every HID poll. That makes the run reproducible for a given title.
+        Settings::values.sink_id = "null";
+    }
     Settings::Apply();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window = std::make_unique<EmuWindow_SDL2>();
+    // The SDL frontend runs emulation on the main thread
+    Common::RegisterCurrentThread(Common::ThreadRole::Emu, "Emu");
+
+    std::unique_ptr<EmuWindow_SDL2> emu_window =
+        std::make_unique<EmuWindow_SDL2>(bench_frames != 0);
 
     System::Init(emu_window.get());
     SCOPE_EXIT({ System::Shutdown(); });
 
+    if (!record_movie_filename.empty() && !play_movie_filename.empty()) {
+        LOG_CRITICAL(Frontend, "Cannot record and play a movie at the same time");
+        return -1;
+    }
+    if (!record_movie_filename.empty() && !Movie::StartRecording(record_movie_filename)) {
+        return -1;
+    }
+    // Replaying a movie alongside --bench makes the whole run deterministic: the recorded
+    // input stream plus a fixed frame count reproduces a session exactly across builds
+    if (!play_movie_filename.empty() && !Movie::StartPlayback(play_movie_filename)) {
+        return -1;
+    }
+
+    if (!play_trace_filename.empty()) {
+        CiTrace::Playback playback(play_trace_filename);
+        if (!playback.IsValid()) {
+            LOG_CRITICAL(Frontend, "Failed to load CiTrace %s!", play_trace_filename.c_str());
+            return -1;
+        }
+
+        playback.LoadInitialState();
+
+        // Replay the trace in a loop, feeding it straight into video_core without the CPU
+        // core running, and report the time spent per pass. This makes a recorded scene a
+        // deterministic GPU-only benchmark.
+        u32 frames_played = 0;
+        auto pass_start = std::chrono::steady_clock::now();
+        while (emu_window->IsOpen()) {
+            if (!playback.AdvanceFrame()) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - pass_start);
+                LOG_INFO(Frontend, "Replayed %u frames in %.2f ms (%.3f ms/frame)",
+                         frames_played, elapsed.count() / 1000.0,
+                         frames_played == 0 ? 0.0 : elapsed.count() / 1000.0 / frames_played);
+                playback.Rewind();
+                frames_played = 0;
+                pass_start = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            VideoCore::g_renderer->SwapBuffers();
+            frames_played++;
+        }
+
+        return 0;
+    }
+
     std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(boot_filename);
     if (!loader) {
         LOG_CRITICAL(Frontend, "Failed to obtain loader for %s!", boot_filename.c_str());
@@ -126,6 +232,56 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    if (bench_frames != 0) {
+        using Common::Telemetry::Stage;
+
+        const auto start = std::chrono::steady_clock::now();
+        const u64 start_ticks = CoreTiming::GetTicks();
+
+        // Frames are counted where the profiler delimits them, in the renderer's SwapBuffers
+        while (emu_window->IsOpen() &&
+               Common::Telemetry::GetSampleCount(Stage::Frame) < bench_frames) {
+            Core::RunLoop();
+        }
+
+        const double wall_seconds = std::chrono::duration_cast<std::chrono::microseconds>(
+                                        std::chrono::steady_clock::now() - start).count() / 1e6;
+        const u64 frames = Common::Telemetry::GetSampleCount(Stage::Frame);
+        const u64 ticks = CoreTiming::GetTicks() - start_ticks;
+
+        // The dyncom core adds one tick per retired instruction, so ticks are guest instructions
+        printf("bench: %llu frames in %.3f s (%.2f fps, %.2f MIPS)\n",
+               static_cast<unsigned long long>(frames), wall_seconds,
+               frames / wall_seconds, ticks / wall_seconds / 1e6);
+        for (size_t stage = 0; stage < static_cast<size_t>(Stage::Count); ++stage) {
+            auto p = Common::Telemetry::GetPercentiles(static_cast<Stage>(stage));
+            if (p.count == 0)
+                continue;
+            printf("bench: %-7s p50 %7.2f ms  p95 %7.2f ms  p99 %7.2f ms  max %7.2f ms\n",
+                   Common::Telemetry::GetStageName(static_cast<Stage>(stage)),
+                   p.p50, p.p95, p.p99, p.max);
+        }
+
+        VideoCore::PipelineStats pipeline = VideoCore::GetPipelineStatsTotals();
+        printf("bench: pica    %llu verts shaded, %llu cache hits\n",
+               (unsigned long long)pipeline.vertices_shaded,
+               (unsigned long long)pipeline.vertex_cache_hits);
+        printf("bench: pica    tris %llu in / %llu clipped / %llu rasterized\n",
+               (unsigned long long)pipeline.triangles_submitted,
+               (unsigned long long)pipeline.triangles_clipped,
+               (unsigned long long)pipeline.triangles_rasterized);
+        printf("bench: pica    pixels %llu shaded / %llu early-rejected\n",
+               (unsigned long long)pipeline.pixels_shaded,
+               (unsigned long long)pipeline.pixels_early_rejected);
+        for (size_t fmt = 0; fmt < VideoCore::NUM_TEXTURE_FORMATS; ++fmt) {
+            if (pipeline.texture_samples[fmt] != 0)
+                printf("bench: pica    texture format %2zu: %llu samples\n", fmt,
+                       (unsigned long long)pipeline.texture_samples[fmt]);
+        }
+
+        return 0;
+    }
+
     while (emu_window->IsOpen()) {
         Core::RunLoop();
     }
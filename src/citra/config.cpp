@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstdio>
 #include <memory>
 
 #include <inih/cpp/INIReader.h>
@@ -23,6 +24,14 @@ Config::Config() {
     sdl2_config = std::make_unique<INIReader>(sdl2_config_loc);
 
     Reload();
+
+    // Per-title profiles: once the loader knows the booting title's program ID, overlay
+    // the matching [Title-<program ID>] section (if any) on the global settings
+    Settings::SetTitleProfileDelegate([this](u64 program_id) { ApplyTitleProfile(program_id); });
+}
+
+Config::~Config() {
+    Settings::SetTitleProfileDelegate(nullptr);
 }
 
 bool Config::LoadINI(const std::string& default_contents, bool retry) {
@@ -63,14 +72,24 @@ void Config::ReadValues() {
             sdl2_config->GetInteger("Controls", Settings::NativeInput::Mapping[i], defaults[i]);
     }
     Settings::values.pad_circle_modifier_scale = (float)sdl2_config->GetReal("Controls", "pad_circle_modifier_scale", 0.5);
+    Settings::values.hid_update_rate = (int)sdl2_config->GetInteger("Controls", "hid_update_rate", 60);
 
     // Core
+    Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.use_fast_vfp = sdl2_config->GetBoolean("Core", "use_fast_vfp", false);
     Settings::values.frame_skip = sdl2_config->GetInteger("Core", "frame_skip", 0);
+    Settings::values.auto_frame_skip = sdl2_config->GetBoolean("Core", "auto_frame_skip", false);
+    Settings::values.use_frame_limit = sdl2_config->GetBoolean("Core", "use_frame_limit", true);
+    Settings::values.enable_rewind = sdl2_config->GetBoolean("Core", "enable_rewind", false);
+    Settings::values.accurate_cpu_timing = sdl2_config->GetBoolean("Core", "accurate_cpu_timing", false);
 
     // Renderer
     Settings::values.use_hw_renderer = sdl2_config->GetBoolean("Renderer", "use_hw_renderer", false);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.use_hw_vertex_shaders = sdl2_config->GetBoolean("Renderer", "use_hw_vertex_shaders", false);
+    Settings::values.sw_rasterizer_threads = sdl2_config->GetInteger("Renderer", "sw_rasterizer_threads", 1);
     Settings::values.use_scaled_resolution = sdl2_config->GetBoolean("Renderer", "use_scaled_resolution", false);
+    Settings::values.use_dynamic_resolution = sdl2_config->GetBoolean("Renderer", "use_dynamic_resolution", false);
 
     Settings::values.bg_red   = (float)sdl2_config->GetReal("Renderer", "bg_red",   1.0);
     Settings::values.bg_green = (float)sdl2_config->GetReal("Renderer", "bg_green", 1.0);
@@ -79,8 +98,18 @@ void Config::ReadValues() {
     // Audio
     Settings::values.sink_id = sdl2_config->Get("Audio", "output_engine", "auto");
 
+    // Threading
+    for (unsigned i = 0; i < Common::NUM_THREAD_ROLES; ++i) {
+        std::string prefix = Settings::ThreadRoleNames::Mapping[i];
+        Settings::values.thread_affinity_masks[i] =
+            (int)sdl2_config->GetInteger("Threading", prefix + "_thread_affinity", 0);
+        Settings::values.thread_priorities[i] =
+            (int)sdl2_config->GetInteger("Threading", prefix + "_thread_priority", 0);
+    }
+
     // Data Storage
     Settings::values.use_virtual_sd = sdl2_config->GetBoolean("Data Storage", "use_virtual_sd", true);
+    Settings::values.check_romfs_integrity = sdl2_config->GetBoolean("Data Storage", "check_romfs_integrity", false);
 
     // System
     Settings::values.is_new_3ds = sdl2_config->GetBoolean("System", "is_new_3ds", false);
@@ -88,10 +117,48 @@ void Config::ReadValues() {
 
     // Miscellaneous
     Settings::values.log_filter = sdl2_config->Get("Miscellaneous", "log_filter", "*:Info");
+    Settings::values.cache_budget_mb = static_cast<int>(sdl2_config->GetInteger("Miscellaneous", "cache_budget_mb", 0));
 
     // Debugging
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
     Settings::values.gdbstub_port = static_cast<u16>(sdl2_config->GetInteger("Debugging", "gdbstub_port", 24689));
+    Settings::values.profile_hot_blocks = sdl2_config->GetBoolean("Debugging", "profile_hot_blocks", false);
+    Settings::values.deterministic_mode = sdl2_config->GetBoolean("Debugging", "deterministic_mode", false);
+}
+
+void Config::ApplyTitleProfile(u64 program_id) {
+    char section[32];
+    snprintf(section, sizeof(section), "Title-%016llX",
+             static_cast<unsigned long long>(program_id));
+
+    // Every key defaults to its current (global) value, so a missing section or a sparse
+    // profile leaves the remaining settings untouched
+    auto& values = Settings::values;
+
+    // Core
+    values.use_cpu_jit = sdl2_config->GetBoolean(section, "use_cpu_jit", values.use_cpu_jit);
+    values.use_fast_vfp = sdl2_config->GetBoolean(section, "use_fast_vfp", values.use_fast_vfp);
+    values.accurate_cpu_timing =
+        sdl2_config->GetBoolean(section, "accurate_cpu_timing", values.accurate_cpu_timing);
+    values.frame_skip = (int)sdl2_config->GetInteger(section, "frame_skip", values.frame_skip);
+
+    // Renderer
+    values.use_hw_renderer = sdl2_config->GetBoolean(section, "use_hw_renderer", values.use_hw_renderer);
+    values.use_shader_jit = sdl2_config->GetBoolean(section, "use_shader_jit", values.use_shader_jit);
+    values.use_hw_vertex_shaders =
+        sdl2_config->GetBoolean(section, "use_hw_vertex_shaders", values.use_hw_vertex_shaders);
+    values.sw_rasterizer_threads =
+        (int)sdl2_config->GetInteger(section, "sw_rasterizer_threads", values.sw_rasterizer_threads);
+    values.use_scaled_resolution =
+        sdl2_config->GetBoolean(section, "use_scaled_resolution", values.use_scaled_resolution);
+    values.use_dynamic_resolution =
+        sdl2_config->GetBoolean(section, "use_dynamic_resolution", values.use_dynamic_resolution);
+
+    // Audio
+    values.sink_id = sdl2_config->Get(section, "output_engine", values.sink_id);
+
+    LOG_INFO(Config, "Applied settings profile %s", section);
+    Settings::Apply();
 }
 
 void Config::Reload() {
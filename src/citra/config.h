@@ -9,14 +9,18 @@
 
 #include <inih/cpp/INIReader.h>
 
+#include "common/common_types.h"
+
 class Config {
     std::unique_ptr<INIReader> sdl2_config;
     std::string sdl2_config_loc;
 
     bool LoadINI(const std::string& default_contents="", bool retry=true);
     void ReadValues();
+    void ApplyTitleProfile(u64 program_id);
 public:
     Config();
+    ~Config();
 
     void Reload();
 };
@@ -37,11 +37,43 @@ pad_circle_modifier =
 # Must be in range of 0.0-1.0. Defaults to 0.5
 pad_circle_modifier_scale =
 
+# Pad/touch sampling rate in updates per second, 1-60. Defaults to 60 (every VBlank).
+hid_update_rate =
+
 [Core]
+# Whether to use the Just-In-Time (JIT) compiler for CPU emulation
+# 0: Interpreter, 1 (default): JIT
+use_cpu_jit =
+
+# Whether to execute common VFP operations with host floating point instructions.
+# Slightly less accurate (cumulative FPSCR exception bits are not tracked), but much faster.
+# 0 (default): Bit-exact soft-float, 1: Host floating point
+use_fast_vfp =
+
 # The applied frameskip amount. Must be a power of two.
 # 0 (default): No frameskip, 1: x2 frameskip, 2: x4 frameskip, 3: x8 frameskip, etc.
 frame_skip =
 
+# Only apply the frameskip pattern while emulation runs behind its wall-clock schedule.
+# 0 (default): Skip unconditionally, 1: Skip only when behind
+auto_frame_skip =
+
+# Pace emulated frames at 60Hz against the wall clock (sleep plus short spin), independently
+# of driver vsync. 0: Unthrottled, 1 (default): On
+use_frame_limit =
+
+# Whether to record periodic snapshots of the emulated state for rewinding.
+# 0 (default): Off, 1: On
+enable_rewind =
+
+# CPU cycle accounting model. The fast tier charges one cycle per instruction; the accurate
+# tier charges rough per-class costs (multiply, load/store, VFP), accumulated per translated
+# block so the dispatch loop pays one addition per block. Stabilizes frame pacing in titles
+# that are timing-sensitive, at the cost of some speed (the CPU JIT is bypassed so every
+# block is costed the same way).
+# 0 (default): Fast, 1: Accurate
+accurate_cpu_timing =
+
 [Renderer]
 # Whether to use software or hardware rendering.
 # 0 (default): Software, 1: Hardware
@@ -51,10 +83,24 @@ use_hw_renderer =
 # 0 : Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to run supported vertex shaders on the GPU instead of the CPU shader engines.
+# Only used by the hardware renderer; unsupported shaders fall back automatically.
+# 0 (default): Off, 1: On
+use_hw_vertex_shaders =
+
+# Number of threads the software rasterizer shades triangles with.
+# 1 (default): Single-threaded, N: Shade on N threads (emu thread plus N-1 workers)
+sw_rasterizer_threads =
+
 # Whether to use native 3DS screen resolution or to scale rendering resolution to the displayed screen size.
 # 0 (default): Native, 1: Scaled
 use_scaled_resolution =
 
+# Whether to lower the rendering resolution automatically when GPU frame time exceeds the
+# frame budget, raising it back once there is sustained headroom. Only affects scaled resolution.
+# 0 (default): Off, 1: On
+use_dynamic_resolution =
+
 # The clear color for the renderer. What shows up on the sides of the bottom screen.
 # Must be in range of 0.0-1.0. Defaults to 1.0 for all.
 bg_red =
@@ -66,11 +112,32 @@ bg_green =
 # auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available)
 output_engine =
 
+[Threading]
+# CPU affinity mask and relative priority for each emulator thread role:
+# emu (main emulation), render (presentation), audio, worker (pooled compute), io (pollers,
+# logging, captures). Affinity is a bitmask of host cores; 0 (default) leaves placement to the
+# OS. Priority is in -2 to 2; positive raises it (may need elevated privileges), 0 is default.
+emu_thread_affinity =
+emu_thread_priority =
+render_thread_affinity =
+render_thread_priority =
+audio_thread_affinity =
+audio_thread_priority =
+worker_thread_affinity =
+worker_thread_priority =
+io_thread_affinity =
+io_thread_priority =
+
 [Data Storage]
 # Whether to create a virtual SD card.
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# Whether to hash RomFS contents block by block on background threads when an archive is
+# opened, with reads waiting on the blocks they touch.
+# 0 (default): Off, 1: On
+check_romfs_integrity =
+
 [System]
 # The system model that Citra will try to emulate
 # 0: Old 3DS (default), 1: New 3DS
@@ -85,10 +152,34 @@ region_value =
 # Examples: *:Debug Kernel.SVC:Trace Service.*:Critical
 log_filter = *:Info
 
+# Total budget in megabytes for the host-side caches (surface cache, decoded textures).
+# When exceeded, each cache is pressured to evict down to its proportional share.
+# 0 (default): Unbounded
+cache_budget_mb =
+
 [Debugging]
 # Port for listening to GDB connections.
 use_gdbstub=false
 gdbstub_port=24689
+
+# Whether to count executions of translated CPU blocks and log the hottest ones
+# with their disassembly on shutdown.
+# 0 (default): Off, 1: On
+profile_hot_blocks=false
+
+# Whether to remove all host-dependent influences on emulation (neutral or movie input,
+# null audio sink, fixed random seeds) so two runs of the same build execute identically.
+# 0 (default): Off, 1: On
+deterministic_mode=false
+
+# Per-title profiles: a section named [Title-<16-digit hex program ID>] overrides settings
+# for that title only, applied at boot once the loader knows the program ID. Keys left out
+# keep their global value. Supported keys: use_cpu_jit, use_fast_vfp, accurate_cpu_timing,
+# frame_skip, use_hw_renderer, use_shader_jit, use_hw_vertex_shaders,
+# sw_rasterizer_threads, use_scaled_resolution, use_dynamic_resolution, output_engine.
+# Example:
+# [Title-0004000000030800]
+# use_hw_vertex_shaders=true
 )";
 
 }
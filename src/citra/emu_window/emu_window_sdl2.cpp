@@ -15,6 +15,7 @@
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
 #include "common/string_util.h"
+#include "common/telemetry.h"
 
 #include "core/settings.h"
 #include "core/hle/service/hid/hid.h"
@@ -58,7 +59,7 @@ void EmuWindow_SDL2::OnResize() {
     NotifyFramebufferLayoutChanged(EmuWindow::FramebufferLayout::DefaultScreenLayout(width, height));
 }
 
-EmuWindow_SDL2::EmuWindow_SDL2() {
+EmuWindow_SDL2::EmuWindow_SDL2(bool hidden) {
     keyboard_id = KeyMap::NewDeviceId();
 
     ReloadSetKeymaps();
@@ -80,13 +81,14 @@ EmuWindow_SDL2::EmuWindow_SDL2() {
     SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
     SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 0);
 
-    std::string window_title = Common::StringFromFormat("Citra | %s-%s", Common::g_scm_branch, Common::g_scm_desc);
-    render_window = SDL_CreateWindow(window_title.c_str(),
+    base_window_title = Common::StringFromFormat("Citra | %s-%s", Common::g_scm_branch, Common::g_scm_desc);
+    render_window = SDL_CreateWindow(base_window_title.c_str(),
         SDL_WINDOWPOS_UNDEFINED, // x position
         SDL_WINDOWPOS_UNDEFINED, // y position
         VideoCore::kScreenTopWidth,
         VideoCore::kScreenTopHeight + VideoCore::kScreenBottomHeight,
-        SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+        SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI |
+            (hidden ? SDL_WINDOW_HIDDEN : 0));
 
     if (render_window == nullptr) {
         LOG_CRITICAL(Frontend, "Failed to create SDL2 window! Exiting...");
@@ -105,6 +107,16 @@ EmuWindow_SDL2::EmuWindow_SDL2() {
         exit(1);
     }
 
+    // Create a second context sharing objects with the main one, used by the renderer for
+    // background shader compilation. Creating it makes it current, so restore the main context
+    // afterwards. Failure is not fatal; the renderer falls back to synchronous compilation.
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    shared_gl_context = SDL_GL_CreateContext(render_window);
+    if (shared_gl_context == nullptr) {
+        LOG_WARNING(Frontend, "Failed to create shared GL context, shaders will compile synchronously");
+    }
+    SDL_GL_MakeCurrent(render_window, gl_context);
+
     OnResize();
     OnMinimalClientAreaChangeRequest(GetActiveConfig().min_client_area_size);
     SDL_PumpEvents();
@@ -113,6 +125,8 @@ EmuWindow_SDL2::EmuWindow_SDL2() {
 }
 
 EmuWindow_SDL2::~EmuWindow_SDL2() {
+    if (shared_gl_context != nullptr)
+        SDL_GL_DeleteContext(shared_gl_context);
     SDL_GL_DeleteContext(gl_context);
     SDL_Quit();
 }
@@ -157,6 +171,24 @@ void EmuWindow_SDL2::PollEvents() {
             break;
         }
     }
+
+    UpdateTitleTelemetry();
+}
+
+void EmuWindow_SDL2::UpdateTitleTelemetry() {
+    const u32 TITLE_REFRESH_MS = 2000;
+
+    u32 now = SDL_GetTicks();
+    if (now - last_title_update < TITLE_REFRESH_MS)
+        return;
+    last_title_update = now;
+
+    std::string summary = Common::Telemetry::GetSummaryString();
+    if (summary.empty())
+        return;
+
+    std::string title = base_window_title + " | " + summary;
+    SDL_SetWindowTitle(render_window, title.c_str());
 }
 
 void EmuWindow_SDL2::MakeCurrent() {
@@ -167,6 +199,16 @@ void EmuWindow_SDL2::DoneCurrent() {
     SDL_GL_MakeCurrent(render_window, nullptr);
 }
 
+bool EmuWindow_SDL2::MakeSharedContextCurrent() {
+    if (shared_gl_context == nullptr)
+        return false;
+    return SDL_GL_MakeCurrent(render_window, shared_gl_context) == 0;
+}
+
+void EmuWindow_SDL2::DoneSharedContextCurrent() {
+    SDL_GL_MakeCurrent(render_window, nullptr);
+}
+
 void EmuWindow_SDL2::ReloadSetKeymaps() {
     KeyMap::ClearKeyMapping(keyboard_id);
     for (int i = 0; i < Settings::NativeInput::NUM_INPUTS; ++i) {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <string>
 #include <utility>
 
 #include "common/emu_window.h"
@@ -12,7 +13,9 @@ struct SDL_Window;
 
 class EmuWindow_SDL2 : public EmuWindow {
 public:
-    EmuWindow_SDL2();
+    /// `hidden` creates the window invisible, for headless benchmark runs. The GL context is
+    /// still real; SDL cannot create one without a window.
+    explicit EmuWindow_SDL2(bool hidden = false);
     ~EmuWindow_SDL2();
 
     /// Swap buffers to display the next frame
@@ -27,6 +30,12 @@ public:
     /// Releases the GL context from the caller thread
     void DoneCurrent() override;
 
+    /// Makes the shared secondary context current for the caller thread
+    bool MakeSharedContextCurrent() override;
+
+    /// Releases the shared secondary context from the caller thread
+    void DoneSharedContextCurrent() override;
+
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
@@ -49,9 +58,18 @@ private:
     /// Called when a configuration change affects the minimal size of the window
     void OnMinimalClientAreaChangeRequest(const std::pair<unsigned, unsigned>& minimal_size) override;
 
+    /// Updates the window title with the frame time summary at a throttled rate
+    void UpdateTitleTelemetry();
+
     /// Is the window still open?
     bool is_open = true;
 
+    /// Window title without the telemetry summary appended
+    std::string base_window_title;
+
+    /// SDL_GetTicks() value of the last title telemetry refresh
+    u32 last_title_update = 0;
+
     /// Internal SDL2 render window
     SDL_Window* render_window;
 
@@ -59,6 +77,9 @@ private:
     /// The OpenGL context associated with the window
     SDL_GLContext gl_context;
 
+    /// Secondary context sharing objects with `gl_context`, for background shader compilation
+    SDL_GLContext shared_gl_context = nullptr;
+
     /// Device id of keyboard for use with KeyMap
     int keyboard_id;
 };
@@ -11,9 +11,11 @@
 #include "citra_qt/bootmanager.h"
 
 #include "common/key_map.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
 #include "common/string_util.h"
+#include "common/thread_topology.h"
 
 #include "core/core.h"
 #include "core/settings.h"
@@ -32,6 +34,8 @@ EmuThread::EmuThread(GRenderWindow* render_window) :
 }
 
 void EmuThread::run() {
+    Common::RegisterCurrentThread(Common::ThreadRole::Emu, "Emu");
+
     render_window->MakeCurrent();
 
     MicroProfileOnThreadCreate("EmuThread");
@@ -76,6 +80,8 @@ void EmuThread::run() {
 #endif
 
     render_window->moveContext();
+
+    Common::UnregisterCurrentThread();
 }
 
 // This class overrides paintEvent and resizeEvent to prevent the GUI thread from stealing GL context.
@@ -115,6 +121,9 @@ GRenderWindow::GRenderWindow(QWidget* parent, EmuThread* emu_thread) :
     keyboard_id = KeyMap::NewDeviceId();
     ReloadSetKeymaps();
 
+    // Needed to pass the presentation thread's handle through the queued MoveSharedContext call
+    qRegisterMetaType<QThread*>("QThread*");
+
     // TODO: One of these flags might be interesting: WA_OpaquePaintEvent, WA_NoBackground, WA_DontShowOnScreen, WA_DeleteOnClose
     QGLFormat fmt;
     fmt.setVersion(3,3);
@@ -172,6 +181,62 @@ void GRenderWindow::DoneCurrent()
     child->doneCurrent();
 }
 
+void GRenderWindow::MoveSharedContext(QThread* thread)
+{
+#if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+    shared_child->context()->moveToThread(thread);
+#endif
+}
+
+bool GRenderWindow::MakeSharedContextCurrent()
+{
+    if (shared_child == nullptr) {
+        // Widgets can only be created on the GUI thread; the renderer probes for shared context
+        // support from there (during System::Init), so the first call creates the widget
+        if (QThread::currentThread() != qApp->thread())
+            return false;
+
+        QGLFormat fmt;
+        fmt.setVersion(3,3);
+        fmt.setProfile(QGLFormat::CoreProfile);
+        fmt.setOption(QGL::NoDeprecatedFunctions);
+
+        QGLWidget* widget = new QGLWidget(fmt, this, child);
+        if (!widget->isSharing()) {
+            LOG_WARNING(Frontend, "Driver refused to share GL contexts, presenting synchronously");
+            delete widget;
+            return false;
+        }
+        widget->hide();
+        shared_child = widget;
+    }
+
+#if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+    // Qt5 enforces context thread affinity. When the renderer's presentation thread picks the
+    // context up, ask the owning (GUI) thread to hand it over before making it current.
+    if (QThread::currentThread() != qApp->thread()) {
+        QMetaObject::invokeMethod(this, "MoveSharedContext", Qt::BlockingQueuedConnection,
+                                  Q_ARG(QThread*, QThread::currentThread()));
+    }
+#endif
+
+    shared_child->makeCurrent();
+    return true;
+}
+
+void GRenderWindow::DoneSharedContextCurrent()
+{
+    if (shared_child == nullptr)
+        return;
+
+    shared_child->doneCurrent();
+#if QT_VERSION > QT_VERSION_CHECK(5, 0, 0)
+    // Hand the context back to the GUI thread so it can be torn down with the widget
+    if (QThread::currentThread() != qApp->thread())
+        shared_child->context()->moveToThread(qApp->thread());
+#endif
+}
+
 void GRenderWindow::PollEvents() {
 }
 
@@ -104,6 +104,8 @@ public:
     void SwapBuffers() override;
     void MakeCurrent() override;
     void DoneCurrent() override;
+    bool MakeSharedContextCurrent() override;
+    void DoneSharedContextCurrent() override;
     void PollEvents() override;
 
     void BackupGeometry();
@@ -129,6 +131,9 @@ public:
 public slots:
     void moveContext();  // overridden
 
+    /// Moves the shared context's thread affinity; must run on the thread currently owning it
+    void MoveSharedContext(QThread* thread);
+
     void OnEmulationStarting(EmuThread* emu_thread);
     void OnEmulationStopping();
     void OnFramebufferSizeChanged();
@@ -142,6 +147,13 @@ private:
 
     GGLWidgetInternal* child;
 
+    /**
+     * Hidden widget whose GL context shares objects with `child`'s. The renderer's presentation
+     * thread runs against it, so emulation keeps compositing into the frame queue while a slow
+     * present is still in flight. Created on first use; remains null if sharing is unavailable.
+     */
+    QGLWidget* shared_child = nullptr;
+
     QByteArray geometry;
 
     /// Device id of keyboard for use with KeyMap
@@ -19,6 +19,10 @@ Config::Config() {
     qt_config = new QSettings(QString::fromStdString(qt_config_loc), QSettings::IniFormat);
 
     Reload();
+
+    // Per-title profiles: once the loader knows the booting title's program ID, overlay
+    // the matching TitleProfiles group (if any) on the global settings
+    Settings::SetTitleProfileDelegate([this](u64 program_id) { ApplyTitleProfile(program_id); });
 }
 
 static const std::array<QVariant, Settings::NativeInput::NUM_INPUTS> defaults = {
@@ -41,28 +45,49 @@ void Config::ReadValues() {
             qt_config->value(QString::fromStdString(Settings::NativeInput::Mapping[i]), defaults[i]).toInt();
     }
     Settings::values.pad_circle_modifier_scale = qt_config->value("pad_circle_modifier_scale", 0.5).toFloat();
+    Settings::values.hid_update_rate = qt_config->value("hid_update_rate", 60).toInt();
     qt_config->endGroup();
 
     qt_config->beginGroup("Core");
+    Settings::values.use_cpu_jit = qt_config->value("use_cpu_jit", true).toBool();
+    Settings::values.use_fast_vfp = qt_config->value("use_fast_vfp", false).toBool();
     Settings::values.frame_skip = qt_config->value("frame_skip", 0).toInt();
+    Settings::values.auto_frame_skip = qt_config->value("auto_frame_skip", false).toBool();
+    Settings::values.use_frame_limit = qt_config->value("use_frame_limit", true).toBool();
+    Settings::values.enable_rewind = qt_config->value("enable_rewind", false).toBool();
+    Settings::values.accurate_cpu_timing = qt_config->value("accurate_cpu_timing", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
     Settings::values.use_hw_renderer = qt_config->value("use_hw_renderer", false).toBool();
     Settings::values.use_shader_jit = qt_config->value("use_shader_jit", true).toBool();
+    Settings::values.use_hw_vertex_shaders = qt_config->value("use_hw_vertex_shaders", false).toBool();
+    Settings::values.sw_rasterizer_threads = qt_config->value("sw_rasterizer_threads", 1).toInt();
     Settings::values.use_scaled_resolution = qt_config->value("use_scaled_resolution", false).toBool();
+    Settings::values.use_dynamic_resolution = qt_config->value("use_dynamic_resolution", false).toBool();
 
     Settings::values.bg_red   = qt_config->value("bg_red",   1.0).toFloat();
     Settings::values.bg_green = qt_config->value("bg_green", 1.0).toFloat();
     Settings::values.bg_blue  = qt_config->value("bg_blue",  1.0).toFloat();
     qt_config->endGroup();
 
+    qt_config->beginGroup("Threading");
+    for (unsigned i = 0; i < Common::NUM_THREAD_ROLES; ++i) {
+        QString prefix = QString::fromLatin1(Settings::ThreadRoleNames::Mapping[i]);
+        Settings::values.thread_affinity_masks[i] =
+            qt_config->value(prefix + "_thread_affinity", 0).toInt();
+        Settings::values.thread_priorities[i] =
+            qt_config->value(prefix + "_thread_priority", 0).toInt();
+    }
+    qt_config->endGroup();
+
     qt_config->beginGroup("Audio");
     Settings::values.sink_id = qt_config->value("output_engine", "auto").toString().toStdString();
     qt_config->endGroup();
 
     qt_config->beginGroup("Data Storage");
     Settings::values.use_virtual_sd = qt_config->value("use_virtual_sd", true).toBool();
+    Settings::values.check_romfs_integrity = qt_config->value("check_romfs_integrity", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("System");
@@ -72,11 +97,14 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Miscellaneous");
     Settings::values.log_filter = qt_config->value("log_filter", "*:Info").toString().toStdString();
+    Settings::values.cache_budget_mb = qt_config->value("cache_budget_mb", 0).toInt();
     qt_config->endGroup();
 
     qt_config->beginGroup("Debugging");
     Settings::values.use_gdbstub = qt_config->value("use_gdbstub", false).toBool();
     Settings::values.gdbstub_port = qt_config->value("gdbstub_port", 24689).toInt();
+    Settings::values.profile_hot_blocks = qt_config->value("profile_hot_blocks", false).toBool();
+    Settings::values.deterministic_mode = qt_config->value("deterministic_mode", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("UI");
@@ -132,16 +160,26 @@ void Config::SaveValues() {
             Settings::values.input_mappings[Settings::NativeInput::All[i]]);
     }
     qt_config->setValue("pad_circle_modifier_scale", (double)Settings::values.pad_circle_modifier_scale);
+    qt_config->setValue("hid_update_rate", Settings::values.hid_update_rate);
     qt_config->endGroup();
 
     qt_config->beginGroup("Core");
+    qt_config->setValue("use_cpu_jit", Settings::values.use_cpu_jit);
+    qt_config->setValue("use_fast_vfp", Settings::values.use_fast_vfp);
     qt_config->setValue("frame_skip", Settings::values.frame_skip);
+    qt_config->setValue("auto_frame_skip", Settings::values.auto_frame_skip);
+    qt_config->setValue("use_frame_limit", Settings::values.use_frame_limit);
+    qt_config->setValue("enable_rewind", Settings::values.enable_rewind);
+    qt_config->setValue("accurate_cpu_timing", Settings::values.accurate_cpu_timing);
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
     qt_config->setValue("use_hw_renderer", Settings::values.use_hw_renderer);
     qt_config->setValue("use_shader_jit", Settings::values.use_shader_jit);
+    qt_config->setValue("use_hw_vertex_shaders", Settings::values.use_hw_vertex_shaders);
+    qt_config->setValue("sw_rasterizer_threads", Settings::values.sw_rasterizer_threads);
     qt_config->setValue("use_scaled_resolution", Settings::values.use_scaled_resolution);
+    qt_config->setValue("use_dynamic_resolution", Settings::values.use_dynamic_resolution);
 
     // Cast to double because Qt's written float values are not human-readable
     qt_config->setValue("bg_red",   (double)Settings::values.bg_red);
@@ -149,12 +187,21 @@ void Config::SaveValues() {
     qt_config->setValue("bg_blue",  (double)Settings::values.bg_blue);
     qt_config->endGroup();
 
+    qt_config->beginGroup("Threading");
+    for (unsigned i = 0; i < Common::NUM_THREAD_ROLES; ++i) {
+        QString prefix = QString::fromLatin1(Settings::ThreadRoleNames::Mapping[i]);
+        qt_config->setValue(prefix + "_thread_affinity", Settings::values.thread_affinity_masks[i]);
+        qt_config->setValue(prefix + "_thread_priority", Settings::values.thread_priorities[i]);
+    }
+    qt_config->endGroup();
+
     qt_config->beginGroup("Audio");
     qt_config->setValue("output_engine", QString::fromStdString(Settings::values.sink_id));
     qt_config->endGroup();
 
     qt_config->beginGroup("Data Storage");
     qt_config->setValue("use_virtual_sd", Settings::values.use_virtual_sd);
+    qt_config->setValue("check_romfs_integrity", Settings::values.check_romfs_integrity);
     qt_config->endGroup();
 
     qt_config->beginGroup("System");
@@ -164,11 +211,14 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Miscellaneous");
     qt_config->setValue("log_filter", QString::fromStdString(Settings::values.log_filter));
+    qt_config->setValue("cache_budget_mb", Settings::values.cache_budget_mb);
     qt_config->endGroup();
 
     qt_config->beginGroup("Debugging");
     qt_config->setValue("use_gdbstub", Settings::values.use_gdbstub);
     qt_config->setValue("gdbstub_port", Settings::values.gdbstub_port);
+    qt_config->setValue("profile_hot_blocks", Settings::values.profile_hot_blocks);
+    qt_config->setValue("deterministic_mode", Settings::values.deterministic_mode);
     qt_config->endGroup();
 
     qt_config->beginGroup("UI");
@@ -205,6 +255,36 @@ void Config::SaveValues() {
     qt_config->endGroup();
 }
 
+void Config::ApplyTitleProfile(u64 program_id) {
+    const QString title_key =
+        QString("%1").arg(program_id, 16, 16, QLatin1Char('0')).toUpper();
+
+    // Every key defaults to its current (global) value, so a missing group or a sparse
+    // profile leaves the remaining settings untouched
+    auto& values = Settings::values;
+    qt_config->beginGroup("TitleProfiles/" + title_key);
+    values.use_cpu_jit = qt_config->value("use_cpu_jit", values.use_cpu_jit).toBool();
+    values.use_fast_vfp = qt_config->value("use_fast_vfp", values.use_fast_vfp).toBool();
+    values.accurate_cpu_timing =
+        qt_config->value("accurate_cpu_timing", values.accurate_cpu_timing).toBool();
+    values.frame_skip = qt_config->value("frame_skip", values.frame_skip).toInt();
+    values.use_hw_renderer = qt_config->value("use_hw_renderer", values.use_hw_renderer).toBool();
+    values.use_shader_jit = qt_config->value("use_shader_jit", values.use_shader_jit).toBool();
+    values.use_hw_vertex_shaders =
+        qt_config->value("use_hw_vertex_shaders", values.use_hw_vertex_shaders).toBool();
+    values.sw_rasterizer_threads =
+        qt_config->value("sw_rasterizer_threads", values.sw_rasterizer_threads).toInt();
+    values.use_scaled_resolution =
+        qt_config->value("use_scaled_resolution", values.use_scaled_resolution).toBool();
+    values.use_dynamic_resolution =
+        qt_config->value("use_dynamic_resolution", values.use_dynamic_resolution).toBool();
+    values.sink_id = qt_config->value("output_engine",
+        QString::fromStdString(values.sink_id)).toString().toStdString();
+    qt_config->endGroup();
+
+    Settings::Apply();
+}
+
 void Config::Reload() {
     ReadValues();
     Settings::Apply();
@@ -215,6 +295,7 @@ void Config::Save() {
 }
 
 Config::~Config() {
+    Settings::SetTitleProfileDelegate(nullptr);
     Save();
 
     delete qt_config;
@@ -6,6 +6,8 @@
 
 #include <string>
 
+#include "common/common_types.h"
+
 class QSettings;
 
 class Config {
@@ -14,6 +16,7 @@ class Config {
 
     void ReadValues();
     void SaveValues();
+    void ApplyTitleProfile(u64 program_id);
 public:
     Config();
     ~Config();
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include <QBoxLayout>
 #include <QComboBox>
 #include <QDebug>
@@ -10,6 +12,7 @@
 #include <QMouseEvent>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QScrollBar>
 #include <QSpinBox>
 
 #include "citra_qt/debugger/graphics_surface.h"
@@ -115,7 +118,7 @@ GraphicsSurfaceWidget::GraphicsSurfaceWidget(std::shared_ptr<Pica::DebugContext>
     surface_picture_label->setAlignment(Qt::AlignLeft | Qt::AlignTop);
     surface_picture_label->setScaledContents(false);
 
-    auto scroll_area = new QScrollArea();
+    scroll_area = new QScrollArea();
     scroll_area->setBackgroundRole(QPalette::Dark);
     scroll_area->setWidgetResizable(false);
     scroll_area->setWidget(surface_picture_label);
@@ -132,6 +135,8 @@ GraphicsSurfaceWidget::GraphicsSurfaceWidget(std::shared_ptr<Pica::DebugContext>
     connect(surface_picker_x_control, SIGNAL(valueChanged(int)), this, SLOT(OnSurfacePickerXChanged(int)));
     connect(surface_picker_y_control, SIGNAL(valueChanged(int)), this, SLOT(OnSurfacePickerYChanged(int)));
     connect(save_surface, SIGNAL(clicked()), this, SLOT(SaveSurface()));
+    connect(scroll_area->horizontalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(OnSurfaceScrolled()));
+    connect(scroll_area->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(OnSurfaceScrolled()));
 
     auto main_widget = new QWidget;
     auto main_layout = new QVBoxLayout;
@@ -205,6 +210,9 @@ GraphicsSurfaceWidget::GraphicsSurfaceWidget(std::shared_ptr<Pica::DebugContext>
 
 void GraphicsSurfaceWidget::OnBreakPointHit(Pica::DebugContext::Event event, void* data)
 {
+    // The emulated GPU may have modified surface memory since the last stop, so cached decoded
+    // tiles are stale now
+    surface_version++;
     emit Update();
     widget()->setEnabled(true);
 }
@@ -426,10 +434,160 @@ void GraphicsSurfaceWidget::Pick(int x, int y)
     surface_info_label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
 }
 
-void GraphicsSurfaceWidget::OnUpdate()
+void GraphicsSurfaceWidget::OnSurfaceScrolled()
 {
-    QPixmap pixmap;
+    // Nothing to decode before the first surface has been displayed
+    if (tile_decoded.empty() || !surface_picture_label->isVisible())
+        return;
 
+    UpdateVisibleTiles();
+}
+
+void GraphicsSurfaceWidget::InvalidateDecodeCache()
+{
+    decoded_image = QImage(surface_width, surface_height, QImage::Format_ARGB32);
+    decoded_image.fill(qRgba(0, 0, 0, 255));
+
+    tiles_wide = (surface_width + 7) / 8;
+    unsigned tiles_high = (surface_height + 7) / 8;
+    tile_decoded.assign(tiles_wide * tiles_high, false);
+    pixmap_dirty = true;
+
+    decoded_version = surface_version;
+    decoded_address = surface_address;
+    decoded_width = surface_width;
+    decoded_height = surface_height;
+    decoded_format = surface_format;
+}
+
+bool GraphicsSurfaceWidget::EnsureTilesDecoded(const QRect& pixel_rect)
+{
+    u8* buffer = Memory::GetPhysicalPointer(surface_address);
+    if (buffer == nullptr)
+        return false;
+
+    QRect rect = pixel_rect.intersected(QRect(0, 0, surface_width, surface_height));
+    if (rect.isEmpty())
+        return false;
+
+    unsigned nibbles_per_pixel = GraphicsSurfaceWidget::NibblesPerPixel(surface_format);
+    unsigned stride = nibbles_per_pixel * surface_width / 2;
+
+    // We handle depth formats here because DebugUtils only supports TextureFormats
+    const bool is_texture_format = (surface_format <= Format::MaxTextureFormat);
+
+    // Generate a virtual texture
+    Pica::DebugUtils::TextureInfo info;
+    info.physical_address = surface_address;
+    info.width = surface_width;
+    info.height = surface_height;
+    info.format = static_cast<Pica::Regs::TextureFormat>(surface_format);
+    info.stride = stride;
+
+    // Depth formats are not valid TextureFormats; a null source keeps the decoder inert
+    const Pica::DebugUtils::TextureDecoder decoder(is_texture_format ? buffer : nullptr, info, true);
+
+    bool decoded_any = false;
+
+    const unsigned tile_x_begin = rect.left() / 8;
+    const unsigned tile_x_end = rect.right() / 8;
+    const unsigned tile_y_begin = rect.top() / 8;
+    const unsigned tile_y_end = rect.bottom() / 8;
+
+    for (unsigned tile_y = tile_y_begin; tile_y <= tile_y_end; ++tile_y) {
+        for (unsigned tile_x = tile_x_begin; tile_x <= tile_x_end; ++tile_x) {
+            std::vector<bool>::reference decoded = tile_decoded[tile_y * tiles_wide + tile_x];
+            if (decoded)
+                continue;
+
+            const unsigned y_end = std::min((tile_y + 1) * 8, surface_height);
+            const unsigned x_end = std::min((tile_x + 1) * 8, surface_width);
+
+            for (unsigned y = tile_y * 8; y < y_end; ++y) {
+                for (unsigned x = tile_x * 8; x < x_end; ++x) {
+                    if (is_texture_format) {
+                        Math::Vec4<u8> color = decoder.Get(x, y);
+                        decoded_image.setPixel(x, y, qRgba(color.r(), color.g(), color.b(), color.a()));
+                        continue;
+                    }
+
+                    ASSERT_MSG(nibbles_per_pixel >= 2, "Depth decoder only supports formats with at least one byte per pixel");
+                    unsigned bytes_per_pixel = nibbles_per_pixel / 2;
+
+                    const u32 coarse_y = y & ~7;
+                    u32 offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
+                    const u8* pixel = buffer + offset;
+                    Math::Vec4<u8> color = { 0, 0, 0, 0 };
+
+                    switch (surface_format) {
+                    case Format::D16:
+                    {
+                        u32 data = Color::DecodeD16(pixel);
+                        color.r() = data & 0xFF;
+                        color.g() = (data >> 8) & 0xFF;
+                        break;
+                    }
+                    case Format::D24:
+                    {
+                        u32 data = Color::DecodeD24(pixel);
+                        color.r() = data & 0xFF;
+                        color.g() = (data >> 8) & 0xFF;
+                        color.b() = (data >> 16) & 0xFF;
+                        break;
+                    }
+                    case Format::D24X8:
+                    {
+                        Math::Vec2<u32> data = Color::DecodeD24S8(pixel);
+                        color.r() = data.x & 0xFF;
+                        color.g() = (data.x >> 8) & 0xFF;
+                        color.b() = (data.x >> 16) & 0xFF;
+                        break;
+                    }
+                    case Format::X24S8:
+                    {
+                        Math::Vec2<u32> data = Color::DecodeD24S8(pixel);
+                        color.r() = color.g() = color.b() = data.y;
+                        break;
+                    }
+                    default:
+                        qDebug() << "Unknown surface format " << static_cast<int>(surface_format);
+                        break;
+                    }
+
+                    decoded_image.setPixel(x, y, qRgba(color.r(), color.g(), color.b(), 255));
+                }
+            }
+
+            decoded = true;
+            decoded_any = true;
+        }
+    }
+
+    return decoded_any;
+}
+
+void GraphicsSurfaceWidget::UpdateVisibleTiles()
+{
+    // The picture is displayed unscaled, so the visible pixel region is simply the viewport
+    // rectangle translated by the scroll offsets
+    QRect visible(scroll_area->horizontalScrollBar()->value(),
+                  scroll_area->verticalScrollBar()->value(),
+                  scroll_area->viewport()->width(),
+                  scroll_area->viewport()->height());
+
+    if (EnsureTilesDecoded(visible))
+        pixmap_dirty = true;
+
+    if (pixmap_dirty) {
+        QPixmap pixmap = QPixmap::fromImage(decoded_image);
+        surface_picture_label->setPixmap(pixmap);
+        surface_picture_label->resize(pixmap.size());
+        pixmap_dirty = false;
+    }
+}
+
+void GraphicsSurfaceWidget::OnUpdate()
+{
     switch (surface_source) {
     case Source::ColorBuffer:
     {
@@ -565,7 +723,6 @@ void GraphicsSurfaceWidget::OnUpdate()
 
     // TODO: Implement a good way to visualize alpha components!
 
-    QImage decoded_image(surface_width, surface_height, QImage::Format_ARGB32);
     u8* buffer = Memory::GetPhysicalPointer(surface_address);
 
     if (buffer == nullptr) {
@@ -590,83 +747,13 @@ void GraphicsSurfaceWidget::OnUpdate()
 
     surface_picture_label->show();
 
-    unsigned nibbles_per_pixel = GraphicsSurfaceWidget::NibblesPerPixel(surface_format);
-    unsigned stride = nibbles_per_pixel * surface_width / 2;
-
-    // We handle depth formats here because DebugUtils only supports TextureFormats
-    if (surface_format <= Format::MaxTextureFormat) {
-
-        // Generate a virtual texture
-        Pica::DebugUtils::TextureInfo info;
-        info.physical_address = surface_address;
-        info.width = surface_width;
-        info.height = surface_height;
-        info.format = static_cast<Pica::Regs::TextureFormat>(surface_format);
-        info.stride = stride;
-
-        for (unsigned int y = 0; y < surface_height; ++y) {
-            for (unsigned int x = 0; x < surface_width; ++x) {
-                Math::Vec4<u8> color = Pica::DebugUtils::LookupTexture(buffer, x, y, info, true);
-                decoded_image.setPixel(x, y, qRgba(color.r(), color.g(), color.b(), color.a()));
-            }
-        }
-
-    } else {
-
-        ASSERT_MSG(nibbles_per_pixel >= 2, "Depth decoder only supports formats with at least one byte per pixel");
-        unsigned bytes_per_pixel = nibbles_per_pixel / 2;
-
-        for (unsigned int y = 0; y < surface_height; ++y) {
-            for (unsigned int x = 0; x < surface_width; ++x) {
-                const u32 coarse_y = y & ~7;
-                u32 offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-                const u8* pixel = buffer + offset;
-                Math::Vec4<u8> color = { 0, 0, 0, 0 };
-
-                switch(surface_format) {
-                case Format::D16:
-                {
-                    u32 data = Color::DecodeD16(pixel);
-                    color.r() = data & 0xFF;
-                    color.g() = (data >> 8) & 0xFF;
-                    break;
-                }
-                case Format::D24:
-                {
-                    u32 data = Color::DecodeD24(pixel);
-                    color.r() = data & 0xFF;
-                    color.g() = (data >> 8) & 0xFF;
-                    color.b() = (data >> 16) & 0xFF;
-                    break;
-                }
-                case Format::D24X8:
-                {
-                    Math::Vec2<u32> data = Color::DecodeD24S8(pixel);
-                    color.r() = data.x & 0xFF;
-                    color.g() = (data.x >> 8) & 0xFF;
-                    color.b() = (data.x >> 16) & 0xFF;
-                    break;
-                }
-                case Format::X24S8:
-                {
-                    Math::Vec2<u32> data = Color::DecodeD24S8(pixel);
-                    color.r() = color.g() = color.b() = data.y;
-                    break;
-                }
-                default:
-                    qDebug() << "Unknown surface format " << static_cast<int>(surface_format);
-                    break;
-                }
-
-                decoded_image.setPixel(x, y, qRgba(color.r(), color.g(), color.b(), 255));
-            }
-        }
-
+    if (decoded_version != surface_version || decoded_address != surface_address ||
+        decoded_width != surface_width || decoded_height != surface_height ||
+        decoded_format != surface_format) {
+        InvalidateDecodeCache();
     }
 
-    pixmap = QPixmap::fromImage(decoded_image);
-    surface_picture_label->setPixmap(pixmap);
-    surface_picture_label->resize(pixmap.size());
+    UpdateVisibleTiles();
 
     // Update the info with pixel data
     surface_picker_x_control->setEnabled(true);
@@ -691,13 +778,14 @@ void GraphicsSurfaceWidget::SaveSurface() {
     }
 
     if (selectedFilter == png_filter) {
-        const QPixmap* pixmap = surface_picture_label->pixmap();
-        ASSERT_MSG(pixmap != nullptr, "No pixmap set");
+        ASSERT_MSG(!decoded_image.isNull(), "No surface decoded");
+
+        // Only the tiles scrolled into view have been decoded so far; fill in the rest
+        EnsureTilesDecoded(QRect(0, 0, surface_width, surface_height));
 
         QFile file(filename);
         file.open(QIODevice::WriteOnly);
-        if (pixmap)
-            pixmap->save(&file, "PNG");
+        decoded_image.save(&file, "PNG");
     } else if (selectedFilter == bin_filter) {
         const u8* buffer = Memory::GetPhysicalPointer(surface_address);
         ASSERT_MSG(buffer != nullptr, "Memory not accessible");
@@ -4,12 +4,16 @@
 
 #pragma once
 
+#include <vector>
+
 #include "citra_qt/debugger/graphics_breakpoint_observer.h"
 
+#include <QImage>
 #include <QLabel>
 #include <QPushButton>
 
 class QComboBox;
+class QScrollArea;
 class QSpinBox;
 class CSpinBox;
 
@@ -91,12 +95,26 @@ private slots:
     void OnBreakPointHit(Pica::DebugContext::Event event, void* data) override;
     void OnResumed() override;
 
+    void OnSurfaceScrolled();
+
     void SaveSurface();
 
 signals:
     void Update();
 
 private:
+    /// Discards all cached decoded tiles and resizes the decode cache to the current surface
+    void InvalidateDecodeCache();
+
+    /**
+     * Decodes any not-yet-decoded 8x8 swizzle tiles overlapping the given pixel rect into
+     * decoded_image.
+     * @return true if at least one new tile was decoded
+     */
+    bool EnsureTilesDecoded(const QRect& pixel_rect);
+
+    /// Decodes the tiles currently scrolled into view and refreshes the displayed pixmap
+    void UpdateVisibleTiles();
 
     QComboBox* surface_source_list;
     CSpinBox* surface_address_control;
@@ -105,6 +123,7 @@ private:
     QComboBox* surface_format_control;
 
     SurfacePicture* surface_picture_label;
+    QScrollArea* scroll_area;
     QSpinBox* surface_picker_x_control;
     QSpinBox* surface_picker_y_control;
     QLabel* surface_info_label;
@@ -117,4 +136,19 @@ private:
     Format surface_format;
     int surface_picker_x = 0;
     int surface_picker_y = 0;
+
+    // Lazily decoded surface image. Converting a whole surface through the per-pixel swizzle
+    // lookup freezes the UI for seconds on large surfaces, so only the 8x8 tiles scrolled into
+    // view are decoded; the result is cached until the surface parameters change or the
+    // emulated GPU makes progress (tracked by surface_version).
+    QImage decoded_image;
+    std::vector<bool> tile_decoded;
+    unsigned tiles_wide = 0;
+    bool pixmap_dirty = true;
+    u64 surface_version = 0;
+    u64 decoded_version = 0;
+    unsigned decoded_address = 0;
+    unsigned decoded_width = 0;
+    unsigned decoded_height = 0;
+    Format decoded_format = Format::Unknown;
 };
@@ -2,6 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
 #include <QHeaderView>
 #include <QThreadPool>
 #include <QVBoxLayout>
@@ -13,6 +22,7 @@
 #include "core/loader/loader.h"
 
 #include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 
@@ -118,31 +128,70 @@ void GameList::LoadInterfaceLayout()
     item_model->sort(header->sortIndicatorSection(), header->sortIndicatorOrder());
 }
 
-void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion)
+static const char game_list_cache_filename[] = "game_list.cache";
+static const quint32 game_list_cache_version = 1;
+
+void GameListWorker::LoadCache()
 {
-    const auto callback = [this, recursion](unsigned* num_entries_out,
-                                            const std::string& directory,
-                                            const std::string& virtual_name) -> bool {
+    QFile file(QString::fromStdString(FileUtil::GetUserPath(D_CACHE_IDX)) + game_list_cache_filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    quint32 version;
+    stream >> version;
+    if (version != game_list_cache_version)
+        return;
+
+    stream >> cache;
+    if (stream.status() != QDataStream::Ok)
+        cache.clear();
+}
+
+void GameListWorker::SaveCache()
+{
+    // Drop entries for files that are no longer there, unless the scan was cancelled
+    // before every path was visited.
+    if (!stop_processing) {
+        for (auto iter = cache.begin(); iter != cache.end();) {
+            if (!scanned_paths.contains(iter.key())) {
+                iter = cache.erase(iter);
+                cache_dirty = true;
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    if (!cache_dirty)
+        return;
+
+    std::string cache_dir = FileUtil::GetUserPath(D_CACHE_IDX);
+    FileUtil::CreateFullPath(cache_dir);
+
+    QFile file(QString::fromStdString(cache_dir) + game_list_cache_filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+
+    QDataStream stream(&file);
+    stream << game_list_cache_version << cache;
+}
+
+void GameListWorker::ScanDirectory(const std::string& dir_path, unsigned int recursion,
+                                   std::vector<std::string>& files_out)
+{
+    const auto callback = [&](unsigned* num_entries_out,
+                              const std::string& directory,
+                              const std::string& virtual_name) -> bool {
         std::string physical_name = directory + DIR_SEP + virtual_name;
 
         if (stop_processing)
             return false; // Breaks the callback loop.
 
         if (!FileUtil::IsDirectory(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader)
-                return true;
-
-            std::vector<u8> smdh;
-            loader->ReadIcon(smdh);
-
-            emit EntryReady({
-                new GameListItemPath(QString::fromStdString(physical_name), smdh),
-                new GameListItem(QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                new GameListItemSize(FileUtil::GetSize(physical_name)),
-            });
+            files_out.push_back(physical_name);
         } else if (recursion > 0) {
-            AddFstEntriesToGameList(physical_name, recursion - 1);
+            ScanDirectory(physical_name, recursion - 1, files_out);
         }
 
         return true;
@@ -151,10 +200,86 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::MakeGameListEntry(const std::string& path)
+{
+    QString qt_path = QString::fromStdString(path);
+    qint64 mtime = QFileInfo(qt_path).lastModified().toMSecsSinceEpoch();
+
+    GameListCacheEntry entry;
+    bool cached = false;
+    {
+        QMutexLocker lock(&cache_mutex);
+        scanned_paths.insert(qt_path);
+
+        const auto iter = cache.constFind(qt_path);
+        if (iter != cache.constEnd() && iter->mtime == mtime) {
+            entry = *iter;
+            cached = true;
+        }
+    }
+
+    if (!cached) {
+        entry.mtime = mtime;
+        entry.file_type = static_cast<qint32>(Loader::FileType::Unknown);
+        entry.size = FileUtil::GetSize(path);
+
+        std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(path);
+        if (loader) {
+            std::vector<u8> smdh;
+            loader->ReadIcon(smdh);
+
+            entry.file_type = static_cast<qint32>(loader->GetFileType());
+            entry.smdh = QByteArray(reinterpret_cast<const char*>(smdh.data()),
+                                    static_cast<int>(smdh.size()));
+        }
+
+        QMutexLocker lock(&cache_mutex);
+        cache.insert(qt_path, entry);
+        cache_dirty = true;
+    }
+
+    // Files that are not titles stay cached so they are not re-probed on the next launch,
+    // but do not get a list entry.
+    if (entry.file_type == static_cast<qint32>(Loader::FileType::Unknown))
+        return;
+
+    std::vector<u8> smdh(entry.smdh.begin(), entry.smdh.end());
+    emit EntryReady({
+        new GameListItemPath(qt_path, smdh),
+        new GameListItem(QString::fromStdString(
+            Loader::GetFileTypeString(static_cast<Loader::FileType>(entry.file_type)))),
+        new GameListItemSize(entry.size),
+    });
+}
+
 void GameListWorker::run()
 {
     stop_processing = false;
-    AddFstEntriesToGameList(dir_path.toStdString(), deep_scan ? 256 : 0);
+    LoadCache();
+
+    std::vector<std::string> files;
+    ScanDirectory(dir_path.toStdString(), deep_scan ? 256 : 0, files);
+
+    // Fan the per-title work (probing, SMDH extraction) out across a worker pool. Entries
+    // arrive through the queued EntryReady connection, so emission order does not matter
+    // to the view.
+    unsigned int num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    num_threads = static_cast<unsigned int>(
+        std::min<size_t>(num_threads, std::max<size_t>(files.size(), 1)));
+
+    std::atomic<size_t> next_file{0};
+    std::vector<std::thread> pool;
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        pool.emplace_back([&] {
+            size_t index;
+            while ((index = next_file++) < files.size() && !stop_processing)
+                MakeGameListEntry(files[index]);
+        });
+    }
+    for (auto& thread : pool)
+        thread.join();
+
+    SaveCache();
     emit Finished();
 }
 
@@ -4,10 +4,18 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <string>
+#include <vector>
 
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
 #include <QImage>
+#include <QMutex>
 #include <QRunnable>
+#include <QSet>
 #include <QStandardItem>
 #include <QString>
 
@@ -82,16 +90,16 @@ public:
         setData(game_path, FullPathRole);
 
         if (!Loader::IsValidSMDH(smdh_data)) {
-            // SMDH is not valid, set a default icon
-            setData(GetDefaultIcon(true), Qt::DecorationRole);
+            // SMDH is not valid; the icon request will fall back to the default icon
             return;
         }
 
         Loader::SMDH smdh;
         memcpy(&smdh, smdh_data.data(), sizeof(Loader::SMDH));
 
-        // Get icon from SMDH
-        setData(GetQPixmapFromSMDH(smdh, true), Qt::DecorationRole);
+        // Keep only the (tiled) icon pixels; decoding is deferred until the row is shown
+        memcpy(icon_data.data(), smdh.large_icon.data(), icon_data.size());
+        has_icon = true;
 
         // Get title form SMDH
         setData(GetQStringShortTitleFromSMDH(smdh, Loader::SMDH::TitleLanguage::English), TitleRole);
@@ -103,10 +111,32 @@ public:
             Common::SplitPath(data(FullPathRole).toString().toStdString(), nullptr, &filename, nullptr);
             QString title = data(TitleRole).toString();
             return QString::fromStdString(filename) + (title.isEmpty() ? "" : "\n    " + title);
+        } else if (role == Qt::DecorationRole) {
+            // The view only requests the decoration for rows that are on screen, so icons
+            // are decoded as they scroll into view instead of while populating the list
+            if (!icon_decoded) {
+                if (has_icon) {
+                    std::vector<u16> pixels = Loader::DecodeSMDHIcon(icon_data.data(), 48);
+                    QImage image(reinterpret_cast<const uchar*>(pixels.data()), 48, 48,
+                                 QImage::Format::Format_RGB16);
+                    // QImage aliases `pixels`; the pixmap conversion makes the deep copy
+                    icon = QPixmap::fromImage(image);
+                } else {
+                    icon = GetDefaultIcon(true);
+                }
+                icon_decoded = true;
+            }
+            return icon;
         } else {
             return GameListItem::data(role);
         }
     }
+
+private:
+    std::array<u8, 0x1200> icon_data; ///< Large icon pixels, still in their tiled layout
+    bool has_icon = false;
+    mutable bool icon_decoded = false;
+    mutable QPixmap icon;
 };
 
 
@@ -150,6 +180,26 @@ public:
 };
 
 
+/**
+ * Per-title scan results cached on disk between launches, keyed by file path and
+ * validated against the file's modification time. `file_type` holds FileType::Unknown
+ * for files that turned out not to be titles, so they are not re-probed either.
+ */
+struct GameListCacheEntry {
+    qint64 mtime;
+    qint32 file_type;
+    qulonglong size;
+    QByteArray smdh;
+};
+
+inline QDataStream& operator<<(QDataStream& stream, const GameListCacheEntry& entry) {
+    return stream << entry.mtime << entry.file_type << entry.size << entry.smdh;
+}
+
+inline QDataStream& operator>>(QDataStream& stream, GameListCacheEntry& entry) {
+    return stream >> entry.mtime >> entry.file_type >> entry.size >> entry.smdh;
+}
+
 /**
  * Asynchronous worker object for populating the game list.
  * Communicates with other threads through Qt's signal/slot system.
@@ -181,5 +231,19 @@ private:
     bool deep_scan;
     std::atomic_bool stop_processing;
 
-    void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion = 0);
+    QHash<QString, GameListCacheEntry> cache;
+    QSet<QString> scanned_paths;
+    QMutex cache_mutex;
+    bool cache_dirty = false;
+
+    /// Loads the on-disk scan cache, if present and of the current version.
+    void LoadCache();
+    /// Prunes entries for files that disappeared and writes the cache back if it changed.
+    void SaveCache();
+
+    /// Collects the paths of all candidate files below dir_path.
+    void ScanDirectory(const std::string& dir_path, unsigned int recursion,
+                       std::vector<std::string>& files_out);
+    /// Probes (or serves from cache) a single file and emits its game list entry.
+    void MakeGameListEntry(const std::string& path);
 };
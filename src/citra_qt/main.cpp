@@ -36,6 +36,7 @@
 #include "citra_qt/debugger/ramview.h"
 #include "citra_qt/debugger/registers.h"
 
+#include "common/assert.h"
 #include "common/microprofile.h"
 #include "common/platform.h"
 #include "common/scm_rev.h"
@@ -68,65 +69,32 @@ GMainWindow::GMainWindow() : config(new Config()), emu_thread(nullptr)
     game_list = new GameList();
     ui.horizontalLayout->addWidget(game_list);
 
-    profilerWidget = new ProfilerWidget(this);
-    addDockWidget(Qt::BottomDockWidgetArea, profilerWidget);
-    profilerWidget->hide();
-
 #if MICROPROFILE_ENABLED
     microProfileDialog = new MicroProfileDialog(this);
     microProfileDialog->hide();
 #endif
 
-    disasmWidget = new DisassemblerWidget(this, emu_thread.get());
-    addDockWidget(Qt::BottomDockWidgetArea, disasmWidget);
-    disasmWidget->hide();
-
-    registersWidget = new RegistersWidget(this);
-    addDockWidget(Qt::RightDockWidgetArea, registersWidget);
-    registersWidget->hide();
-
-    callstackWidget = new CallstackWidget(this);
-    addDockWidget(Qt::RightDockWidgetArea, callstackWidget);
-    callstackWidget->hide();
-
-    graphicsWidget = new GPUCommandStreamWidget(this);
-    addDockWidget(Qt::RightDockWidgetArea, graphicsWidget);
-    graphicsWidget ->hide();
-
-    graphicsCommandsWidget = new GPUCommandListWidget(this);
-    addDockWidget(Qt::RightDockWidgetArea, graphicsCommandsWidget);
-    graphicsCommandsWidget->hide();
-
-    auto graphicsBreakpointsWidget = new GraphicsBreakPointsWidget(Pica::g_debug_context, this);
-    addDockWidget(Qt::RightDockWidgetArea, graphicsBreakpointsWidget);
-    graphicsBreakpointsWidget->hide();
-
-    auto graphicsVertexShaderWidget = new GraphicsVertexShaderWidget(Pica::g_debug_context, this);
-    addDockWidget(Qt::RightDockWidgetArea, graphicsVertexShaderWidget);
-    graphicsVertexShaderWidget->hide();
-
-    auto graphicsTracingWidget = new GraphicsTracingWidget(Pica::g_debug_context, this);
-    addDockWidget(Qt::RightDockWidgetArea, graphicsTracingWidget);
-    graphicsTracingWidget->hide();
-
     auto graphicsSurfaceViewerAction = new QAction(tr("Create Pica surface viewer"), this);
     connect(graphicsSurfaceViewerAction, SIGNAL(triggered()), this, SLOT(OnCreateGraphicsSurfaceViewer()));
 
+    // The debugger docks themselves are only constructed when their menu entry is first
+    // activated; constructing all of them up front slows startup and attaches GPU debugger
+    // observers that production users never look at.
     QMenu* debug_menu = ui.menu_View->addMenu(tr("Debugging"));
     debug_menu->addAction(graphicsSurfaceViewerAction);
     debug_menu->addSeparator();
-    debug_menu->addAction(profilerWidget->toggleViewAction());
+    debug_menu->addAction(CreateDebugWidgetAction(tr("Profiler"), DebugWidget_Profiler));
 #if MICROPROFILE_ENABLED
     debug_menu->addAction(microProfileDialog->toggleViewAction());
 #endif
-    debug_menu->addAction(disasmWidget->toggleViewAction());
-    debug_menu->addAction(registersWidget->toggleViewAction());
-    debug_menu->addAction(callstackWidget->toggleViewAction());
-    debug_menu->addAction(graphicsWidget->toggleViewAction());
-    debug_menu->addAction(graphicsCommandsWidget->toggleViewAction());
-    debug_menu->addAction(graphicsBreakpointsWidget->toggleViewAction());
-    debug_menu->addAction(graphicsVertexShaderWidget->toggleViewAction());
-    debug_menu->addAction(graphicsTracingWidget->toggleViewAction());
+    debug_menu->addAction(CreateDebugWidgetAction(tr("Disassembly"), DebugWidget_Disassembler));
+    debug_menu->addAction(CreateDebugWidgetAction(tr("ARM Registers"), DebugWidget_Registers));
+    debug_menu->addAction(CreateDebugWidgetAction(tr("Call Stack"), DebugWidget_Callstack));
+    debug_menu->addAction(CreateDebugWidgetAction(tr("Graphics Debugger"), DebugWidget_GraphicsStream));
+    debug_menu->addAction(CreateDebugWidgetAction(tr("Pica Command List"), DebugWidget_GraphicsCommands));
+    debug_menu->addAction(CreateDebugWidgetAction(tr("Pica Breakpoints"), DebugWidget_GraphicsBreakpoints));
+    debug_menu->addAction(CreateDebugWidgetAction(tr("Pica Vertex Shader"), DebugWidget_GraphicsVertexShader));
+    debug_menu->addAction(CreateDebugWidgetAction(tr("CiTrace Recorder"), DebugWidget_GraphicsTracing));
 
     // Set default UI state
     // geometry: 55% of the window contents are in the upper screen half, 45% in the lower half
@@ -177,14 +145,8 @@ GMainWindow::GMainWindow() : config(new Config()), emu_thread(nullptr)
     connect(ui.action_Stop, SIGNAL(triggered()), this, SLOT(OnStopGame()));
     connect(ui.action_Single_Window_Mode, SIGNAL(triggered(bool)), this, SLOT(ToggleWindowMode()));
 
-    connect(this, SIGNAL(EmulationStarting(EmuThread*)), disasmWidget, SLOT(OnEmulationStarting(EmuThread*)));
-    connect(this, SIGNAL(EmulationStopping()), disasmWidget, SLOT(OnEmulationStopping()));
-    connect(this, SIGNAL(EmulationStarting(EmuThread*)), registersWidget, SLOT(OnEmulationStarting(EmuThread*)));
-    connect(this, SIGNAL(EmulationStopping()), registersWidget, SLOT(OnEmulationStopping()));
     connect(this, SIGNAL(EmulationStarting(EmuThread*)), render_window, SLOT(OnEmulationStarting(EmuThread*)));
     connect(this, SIGNAL(EmulationStopping()), render_window, SLOT(OnEmulationStopping()));
-    connect(this, SIGNAL(EmulationStarting(EmuThread*)), graphicsTracingWidget, SLOT(OnEmulationStarting(EmuThread*)));
-    connect(this, SIGNAL(EmulationStopping()), graphicsTracingWidget, SLOT(OnEmulationStopping()));
 
 
     // Setup hotkeys
@@ -238,6 +200,115 @@ void GMainWindow::OnDisplayTitleBars(bool show)
     }
 }
 
+QAction* GMainWindow::CreateDebugWidgetAction(const QString& title, DebugWidgetId id)
+{
+    QAction* action = new QAction(title, this);
+    action->setCheckable(true);
+    action->setData(static_cast<int>(id));
+    connect(action, SIGNAL(triggered()), this, SLOT(OnToggleDebugWidget()));
+
+    debug_widget_actions[id] = action;
+    return action;
+}
+
+QDockWidget* GMainWindow::GetOrCreateDebugWidget(DebugWidgetId id)
+{
+    QDockWidget*& dock = debug_widgets[id];
+    if (dock != nullptr)
+        return dock;
+
+    Qt::DockWidgetArea area = Qt::RightDockWidgetArea;
+    switch (id) {
+    case DebugWidget_Profiler:
+        dock = new ProfilerWidget(this);
+        area = Qt::BottomDockWidgetArea;
+        break;
+    case DebugWidget_Disassembler:
+        disasmWidget = new DisassemblerWidget(this, emu_thread.get());
+        dock = disasmWidget;
+        area = Qt::BottomDockWidgetArea;
+        break;
+    case DebugWidget_Registers:
+        registersWidget = new RegistersWidget(this);
+        dock = registersWidget;
+        break;
+    case DebugWidget_Callstack:
+        callstackWidget = new CallstackWidget(this);
+        dock = callstackWidget;
+        break;
+    case DebugWidget_GraphicsStream:
+        dock = new GPUCommandStreamWidget(this);
+        break;
+    case DebugWidget_GraphicsCommands:
+        dock = new GPUCommandListWidget(this);
+        break;
+    case DebugWidget_GraphicsBreakpoints:
+        dock = new GraphicsBreakPointsWidget(Pica::g_debug_context, this);
+        break;
+    case DebugWidget_GraphicsVertexShader:
+        dock = new GraphicsVertexShaderWidget(Pica::g_debug_context, this);
+        break;
+    case DebugWidget_GraphicsTracing:
+        dock = new GraphicsTracingWidget(Pica::g_debug_context, this);
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    addDockWidget(area, dock);
+    dock->hide();
+    if (!ui.actionDisplay_widget_title_bars->isChecked())
+        dock->setTitleBarWidget(new QWidget());
+    // Apply any layout state saved for this dock before lazy construction existed, or from a
+    // previous session where it was shown
+    restoreDockWidget(dock);
+
+    // Closing the dock directly (rather than through the menu) must clear the checkmark
+    connect(dock, SIGNAL(visibilityChanged(bool)), debug_widget_actions[id], SLOT(setChecked(bool)));
+
+    // Widgets tracking the emulation session subscribe here; BootGame wires already-constructed
+    // ones, so a dock created mid-session has to catch up on its own
+    switch (id) {
+    case DebugWidget_Disassembler:
+    case DebugWidget_Registers:
+    case DebugWidget_GraphicsTracing:
+        connect(this, SIGNAL(EmulationStarting(EmuThread*)), dock, SLOT(OnEmulationStarting(EmuThread*)));
+        connect(this, SIGNAL(EmulationStopping()), dock, SLOT(OnEmulationStopping()));
+        if (emu_thread != nullptr)
+            QMetaObject::invokeMethod(dock, "OnEmulationStarting", Q_ARG(EmuThread*, emu_thread.get()));
+        break;
+    default:
+        break;
+    }
+
+    switch (id) {
+    case DebugWidget_Disassembler:
+    case DebugWidget_Registers:
+    case DebugWidget_Callstack:
+        if (emu_thread != nullptr) {
+            connect(emu_thread.get(), SIGNAL(DebugModeEntered()), dock, SLOT(OnDebugModeEntered()), Qt::BlockingQueuedConnection);
+            connect(emu_thread.get(), SIGNAL(DebugModeLeft()), dock, SLOT(OnDebugModeLeft()), Qt::BlockingQueuedConnection);
+            if (!emu_thread->IsRunning())
+                QMetaObject::invokeMethod(dock, "OnDebugModeEntered");
+        }
+        break;
+    default:
+        break;
+    }
+
+    return dock;
+}
+
+void GMainWindow::OnToggleDebugWidget()
+{
+    QAction* action = qobject_cast<QAction*>(sender());
+    if (action == nullptr)
+        return;
+
+    QDockWidget* dock = GetOrCreateDebugWidget(static_cast<DebugWidgetId>(action->data().toInt()));
+    dock->setVisible(action->isChecked());
+}
+
 bool GMainWindow::InitializeSystem() {
     // Shutdown previous session if the emu thread is still active...
     if (emu_thread != nullptr)
@@ -330,17 +401,23 @@ void GMainWindow::BootGame(const std::string& filename) {
     emu_thread->start();
 
     connect(render_window, SIGNAL(Closed()), this, SLOT(OnStopGame()));
+    // The CPU state widgets may not have been constructed yet; GetOrCreateDebugWidget() makes
+    // these connections itself for widgets created mid-session.
     // BlockingQueuedConnection is important here, it makes sure we've finished refreshing our views before the CPU continues
-    connect(emu_thread.get(), SIGNAL(DebugModeEntered()), disasmWidget, SLOT(OnDebugModeEntered()), Qt::BlockingQueuedConnection);
-    connect(emu_thread.get(), SIGNAL(DebugModeEntered()), registersWidget, SLOT(OnDebugModeEntered()), Qt::BlockingQueuedConnection);
-    connect(emu_thread.get(), SIGNAL(DebugModeEntered()), callstackWidget, SLOT(OnDebugModeEntered()), Qt::BlockingQueuedConnection);
-    connect(emu_thread.get(), SIGNAL(DebugModeLeft()), disasmWidget, SLOT(OnDebugModeLeft()), Qt::BlockingQueuedConnection);
-    connect(emu_thread.get(), SIGNAL(DebugModeLeft()), registersWidget, SLOT(OnDebugModeLeft()), Qt::BlockingQueuedConnection);
-    connect(emu_thread.get(), SIGNAL(DebugModeLeft()), callstackWidget, SLOT(OnDebugModeLeft()), Qt::BlockingQueuedConnection);
+    for (QDockWidget* dock : { static_cast<QDockWidget*>(disasmWidget),
+                               static_cast<QDockWidget*>(registersWidget),
+                               static_cast<QDockWidget*>(callstackWidget) }) {
+        if (dock == nullptr)
+            continue;
+        connect(emu_thread.get(), SIGNAL(DebugModeEntered()), dock, SLOT(OnDebugModeEntered()), Qt::BlockingQueuedConnection);
+        connect(emu_thread.get(), SIGNAL(DebugModeLeft()), dock, SLOT(OnDebugModeLeft()), Qt::BlockingQueuedConnection);
+    }
 
     // Update the GUI
-    registersWidget->OnDebugModeEntered();
-    callstackWidget->OnDebugModeEntered();
+    if (registersWidget != nullptr)
+        registersWidget->OnDebugModeEntered();
+    if (callstackWidget != nullptr)
+        callstackWidget->OnDebugModeEntered();
     if (ui.action_Single_Window_Mode->isChecked()) {
         game_list->hide();
     }
@@ -570,6 +647,8 @@ void GMainWindow::closeEvent(QCloseEvent* event) {
 int main(int argc, char* argv[]) {
     Log::Filter log_filter(Log::Level::Info);
     Log::SetFilter(&log_filter);
+    Log::StartAsyncBackend();
+    SCOPE_EXIT({ Log::StopAsyncBackend(); });
 
     MicroProfileOnThreadCreate("Frontend");
     SCOPE_EXIT({
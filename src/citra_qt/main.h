@@ -5,6 +5,7 @@
 #ifndef _CITRA_QT_MAIN_HXX_
 #define _CITRA_QT_MAIN_HXX_
 
+#include <array>
 #include <memory>
 #include <QMainWindow>
 
@@ -22,6 +23,7 @@ class RegistersWidget;
 class CallstackWidget;
 class GPUCommandStreamWidget;
 class GPUCommandListWidget;
+class QDockWidget;
 
 class GMainWindow : public QMainWindow
 {
@@ -109,8 +111,31 @@ private slots:
     void OnDisplayTitleBars(bool);
     void ToggleWindowMode();
     void OnCreateGraphicsSurfaceViewer();
+    void OnToggleDebugWidget();
 
 private:
+    /**
+     * Identifies a debugger dock widget. The widgets are expensive to construct and some attach
+     * observers to the GPU debug context, so they are only created when first shown.
+     */
+    enum DebugWidgetId {
+        DebugWidget_Profiler,
+        DebugWidget_Disassembler,
+        DebugWidget_Registers,
+        DebugWidget_Callstack,
+        DebugWidget_GraphicsStream,
+        DebugWidget_GraphicsCommands,
+        DebugWidget_GraphicsBreakpoints,
+        DebugWidget_GraphicsVertexShader,
+        DebugWidget_GraphicsTracing,
+        DebugWidget_Count
+    };
+
+    /// Creates a checkable menu action that lazily constructs the given debugger dock widget
+    QAction* CreateDebugWidgetAction(const QString& title, DebugWidgetId id);
+
+    /// Returns the given debugger dock widget, constructing and wiring it up on first use
+    QDockWidget* GetOrCreateDebugWidget(DebugWidgetId id);
     Ui::MainWindow ui;
 
     GRenderWindow* render_window;
@@ -122,13 +147,15 @@ private:
     bool emulation_running = false;
     std::unique_ptr<EmuThread> emu_thread;
 
-    ProfilerWidget* profilerWidget;
     MicroProfileDialog* microProfileDialog;
-    DisassemblerWidget* disasmWidget;
-    RegistersWidget* registersWidget;
-    CallstackWidget* callstackWidget;
-    GPUCommandStreamWidget* graphicsWidget;
-    GPUCommandListWidget* graphicsCommandsWidget;
+
+    // Lazily constructed debugger dock widgets; null until first shown. The typed pointers
+    // below alias entries of debug_widgets for the widgets other code needs to talk to.
+    std::array<QDockWidget*, DebugWidget_Count> debug_widgets{};
+    std::array<QAction*, DebugWidget_Count> debug_widget_actions{};
+    DisassemblerWidget* disasmWidget = nullptr;
+    RegistersWidget* registersWidget = nullptr;
+    CallstackWidget* callstackWidget = nullptr;
 
     QAction* actions_recent_files[max_recent_files_item];
 };
@@ -23,18 +23,54 @@ private:
 
 protected:
     u8 *region;
+    // Read-write view of the region; equal to region unless the space is dual-mapped
+    u8 *writable_region;
     size_t region_size;
+    // False if the region was handed to us via SetCodeSpace; the owner unmaps it
+    bool owns_region;
 
 public:
-    CodeBlock() : region(nullptr), region_size(0) {}
-    virtual ~CodeBlock() { if (region) FreeCodeSpace(); }
+    CodeBlock() : region(nullptr), writable_region(nullptr), region_size(0), owns_region(true) {}
+    virtual ~CodeBlock() { if (region && owns_region) FreeCodeSpace(); }
 
     // Call this before you generate any code.
+    // Regions of 2MB and up are backed by huge pages where the host supports it (see
+    // AllocateExecutableMemory), so emitters with large code caches should allocate
+    // them in one block rather than many small ones.
     void AllocCodeSpace(int size)
     {
         region_size = size;
-        region = (u8*)AllocateExecutableMemory(region_size);
+        // Prefer a dual mapping: one writable view for the emitter's stores, one
+        // executable view for everything else. Hardened hosts can forbid RWX pages
+        // outright, and emitting never has to toggle page protections. All pointers
+        // handed out (and all branch arithmetic) refer to the executable view; only
+        // the byte stores are redirected. Falls back to a single RWX mapping where
+        // the host has no dual-mapping primitive.
+        void* writable;
+        void* executable;
+        if (AllocateDualMappedCodeSpace(region_size, &writable, &executable)) {
+            region = (u8*)executable;
+            writable_region = (u8*)writable;
+        } else {
+            region = (u8*)AllocateExecutableMemory(region_size);
+            writable_region = region;
+        }
         T::SetCodePtr(region);
+        T::SetWritableDiff(writable_region - region);
+    }
+
+    // Points this block at code space owned by someone else, e.g. a slot carved out of a
+    // shared arena. The caller remains responsible for unmapping it; FreeCodeSpace() and
+    // the destructor merely detach. `writable` is the read-write view of `executable` and
+    // equals it for a plain RWX mapping.
+    void SetCodeSpace(u8* executable, u8* writable, size_t size)
+    {
+        region = executable;
+        writable_region = writable;
+        region_size = size;
+        owns_region = false;
+        T::SetCodePtr(region);
+        T::SetWritableDiff(writable_region - region);
     }
 
     // Always clear code space with breakpoints, so that if someone accidentally executes
@@ -51,10 +87,17 @@ public:
 #ifdef __SYMBIAN32__
         ResetExecutableMemory(region);
 #else
-        FreeMemoryPages(region, region_size);
+        if (owns_region) {
+            if (writable_region != region)
+                FreeDualMappedCodeSpace(writable_region, region, region_size);
+            else
+                FreeMemoryPages(region, region_size);
+        }
 #endif
         region = nullptr;
+        writable_region = nullptr;
         region_size = 0;
+        owns_region = true;
     }
 
     bool IsInSpace(const u8 *ptr)
@@ -66,7 +109,12 @@ public:
     // Start over if you need to change the code (call FreeCodeSpace(), AllocCodeSpace()).
     void WriteProtect()
     {
-        WriteProtectMemory(region, region_size, true);
+        // With a dual mapping the executable view was never writable; lock the
+        // writable view instead.
+        if (writable_region != region)
+            WriteProtectMemory(writable_region, region_size, false);
+        else
+            WriteProtectMemory(region, region_size, true);
     }
 
     void ResetCodePtr()
@@ -3,20 +3,65 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
 #include "common/assert.h"
 #include "common/key_map.h"
+#include "common/logging/log.h"
 
 #include "emu_window.h"
 #include "video_core/video_core.h"
 
+static u64 GetTimestampUs() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void EmuWindow::PushInputEvent(u32 pad_hex, bool pressed) {
+    const size_t tail = input_queue_tail.load(std::memory_order_relaxed);
+    const size_t next = (tail + 1) & (INPUT_QUEUE_SIZE - 1);
+    if (next == input_queue_head.load(std::memory_order_acquire)) {
+        // The emu thread hasn't drained for hundreds of events; losing one is the least bad option
+        LOG_WARNING(Frontend, "input queue full, dropping button event");
+        return;
+    }
+    input_queue[tail] = { GetTimestampUs(), pad_hex, pressed };
+    input_queue_tail.store(next, std::memory_order_release);
+}
+
+void EmuWindow::DrainInputEvents() {
+    size_t head = input_queue_head.load(std::memory_order_relaxed);
+    u64 earliest = 0;
+
+    while (head != input_queue_tail.load(std::memory_order_acquire)) {
+        const InputEvent& ev = input_queue[head];
+        if (ev.pressed) {
+            pad_state.hex |= ev.pad_hex;
+        } else {
+            pad_state.hex &= ~ev.pad_hex;
+        }
+        if (earliest == 0)
+            earliest = ev.timestamp_us;
+        head = (head + 1) & (INPUT_QUEUE_SIZE - 1);
+    }
+    input_queue_head.store(head, std::memory_order_release);
+
+    // Keep the oldest timestamp that hasn't been presented yet; a newer event must not shorten
+    // the measured latency of an older one still in flight
+    if (earliest != 0) {
+        u64 expected = 0;
+        pending_input_timestamp.compare_exchange_strong(expected, earliest,
+                                                        std::memory_order_relaxed);
+    }
+}
+
 void EmuWindow::ButtonPressed(Service::HID::PadState pad) {
-    pad_state.hex |= pad.hex;
+    PushInputEvent(pad.hex, true);
 }
 
 void EmuWindow::ButtonReleased(Service::HID::PadState pad) {
-    pad_state.hex &= ~pad.hex;
+    PushInputEvent(pad.hex, false);
 }
 
 void EmuWindow::CirclePadUpdated(float x, float y) {
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <tuple>
 #include <utility>
 
@@ -70,6 +72,16 @@ public:
     /// Releases (dunno if this is the "right" word) the GLFW context from the caller thread
     virtual void DoneCurrent() = 0;
 
+    /**
+     * Makes a secondary graphics context that shares objects with the main context current for
+     * the caller thread, for background work such as shader compilation. Frontends that don't
+     * provide one return false, in which case the caller must do its work on the main context.
+     */
+    virtual bool MakeSharedContextCurrent() { return false; }
+
+    /// Releases the shared secondary context from the caller thread
+    virtual void DoneSharedContextCurrent() {}
+
     virtual void ReloadSetKeymaps() = 0;
 
     /**
@@ -111,11 +123,28 @@ public:
      */
     void TouchMoved(unsigned framebuffer_x, unsigned framebuffer_y);
 
+    /**
+     * Applies all button events queued by the window thread to the pad state, in receipt order.
+     * Must be called from the emu thread (HID does this at the start of its periodic update)
+     * before reading GetPadState(). The timestamp of the oldest event applied is retained until
+     * the next present, for input-to-present latency measurement.
+     */
+    void DrainInputEvents();
+
+    /**
+     * Returns the receipt timestamp (in microseconds on the steady clock) of the oldest input
+     * event that has been delivered to HID but not yet followed by a present, and clears it.
+     * Returns 0 if there is no such event. Called by the renderer after presenting a frame.
+     */
+    u64 ConsumeDeliveredInputTimestamp() {
+        return pending_input_timestamp.exchange(0, std::memory_order_relaxed);
+    }
+
     /**
      * Gets the current pad state (which buttons are pressed).
      * @note This should be called by the core emu thread to get a state set by the window thread.
      * @note This doesn't include analog input like circle pad direction
-     * @todo Fix this function to be thread-safe.
+     * @note Only DrainInputEvents() changes this state; call it first to pick up new events.
      * @return PadState object indicating the current pad state
      */
     Service::HID::PadState GetPadState() const {
@@ -293,5 +322,30 @@ private:
     */
     std::tuple<unsigned,unsigned> ClipToTouchScreen(unsigned new_x, unsigned new_y);
 
+    /// A button press or release, timestamped at receipt on the window thread
+    struct InputEvent {
+        u64 timestamp_us; ///< Steady-clock receipt time in microseconds
+        u32 pad_hex;      ///< PadState bits affected by this event
+        bool pressed;     ///< True for press, false for release
+    };
+
+    /// Must be a power of two; well beyond what a window thread can queue between two HID updates
+    static const size_t INPUT_QUEUE_SIZE = 256;
+
+    /**
+     * Single-producer single-consumer ring of button events: the window thread pushes at the
+     * tail, DrainInputEvents() (emu thread) pops from the head. Lock-free, so a key event never
+     * waits on the emu thread and is never sampled half-applied.
+     */
+    std::array<InputEvent, INPUT_QUEUE_SIZE> input_queue;
+    std::atomic<size_t> input_queue_head{0};
+    std::atomic<size_t> input_queue_tail{0};
+
+    /// Receipt time of the oldest event delivered to HID and not yet presented (0 if none)
+    std::atomic<u64> pending_input_timestamp{0};
+
+    /// Pushes one button event onto the input queue; drops it (with a warning) if full
+    void PushInputEvent(u32 pad_hex, bool pressed);
+
     Service::HID::PadState pad_state;
 };
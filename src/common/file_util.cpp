@@ -387,6 +387,20 @@ u64 GetSize(const std::string &filename)
     return 0;
 }
 
+// Returns the last modification timestamp of filename, or 0 on failure
+u64 GetModificationTime(const std::string &filename)
+{
+    struct stat64 buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#else
+    if (stat64(filename.c_str(), &buf) == 0)
+#endif
+        return static_cast<u64>(buf.st_mtime);
+
+    return 0;
+}
+
 // Overloaded GetSize, accepts file descriptor
 u64 GetSize(const int fd)
 {
@@ -919,6 +933,8 @@ void IOFile::Swap(IOFile& other)
 {
     std::swap(m_file, other.m_file);
     std::swap(m_good, other.m_good);
+    std::swap(m_io_mutex, other.m_io_mutex);
+    std::swap(m_buffer, other.m_buffer);
 }
 
 bool IOFile::Open(const std::string& filename, const char openmode[])
@@ -940,6 +956,7 @@ bool IOFile::Close()
         m_good = false;
 
     m_file = nullptr;
+    m_buffer.reset();
     return m_good;
 }
 
@@ -969,12 +986,33 @@ u64 IOFile::Tell() const
 
 bool IOFile::Flush()
 {
+    // Taken so the journal's periodic flush cannot interleave with a positioned access
+    std::lock_guard<std::mutex> lock(*m_io_mutex);
+
     if (!IsOpen() || 0 != std::fflush(m_file))
         m_good = false;
 
     return m_good;
 }
 
+bool IOFile::SetBufferSize(size_t size)
+{
+    if (!IsOpen()) {
+        m_good = false;
+        return false;
+    }
+
+    auto new_buffer = std::make_unique<char[]>(size);
+    if (0 != setvbuf(m_file, new_buffer.get(), _IOFBF, size)) {
+        m_good = false;
+        return false;
+    }
+
+    // The stream references the buffer until it is closed, so keep it alive alongside m_file
+    m_buffer = std::move(new_buffer);
+    return true;
+}
+
 bool IOFile::Resize(u64 size)
 {
     if (!IsOpen() || 0 !=
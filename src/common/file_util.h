@@ -8,6 +8,8 @@
 #include <fstream>
 #include <functional>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -73,6 +75,9 @@ bool IsDirectory(const std::string &filename);
 // Returns the size of filename (64bit)
 u64 GetSize(const std::string &filename);
 
+// Returns the last modification timestamp of filename, or 0 on failure
+u64 GetModificationTime(const std::string &filename);
+
 // Overloaded GetSize, accepts file descriptor
 u64 GetSize(const int fd);
 
@@ -239,6 +244,42 @@ public:
         return WriteArray(reinterpret_cast<const char*>(data), length);
     }
 
+    /**
+     * Reads `length` bytes starting at the given absolute offset. The seek is skipped when the
+     * stream is already positioned there, which keeps stdio's readahead buffer intact across
+     * small sequential reads (an explicit fseek discards it).
+     */
+    size_t ReadAt(void* data, size_t length, u64 offset)
+    {
+        std::lock_guard<std::mutex> lock(*m_io_mutex);
+
+        if (!IsOpen()) {
+            m_good = false;
+            return -1;
+        }
+
+        if (Tell() != offset && !Seek(offset, SEEK_SET))
+            return -1;
+
+        return ReadBytes(data, length);
+    }
+
+    /// Writes `length` bytes at the given absolute offset, skipping no-op seeks like ReadAt.
+    size_t WriteAt(const void* data, size_t length, u64 offset)
+    {
+        std::lock_guard<std::mutex> lock(*m_io_mutex);
+
+        if (!IsOpen()) {
+            m_good = false;
+            return -1;
+        }
+
+        if (Tell() != offset && !Seek(offset, SEEK_SET))
+            return -1;
+
+        return WriteBytes(data, length);
+    }
+
     template<typename T>
     size_t WriteObject(const T& object) {
         static_assert(!std::is_pointer<T>::value, "Given object is a pointer");
@@ -251,18 +292,38 @@ public:
     bool IsGood() const { return m_good; }
     explicit operator bool() const { return IsGood(); }
 
+    // Exposes the underlying stream for interop with platform APIs (e.g. memory mapping).
+    std::FILE* GetHandle() const { return m_file; }
+
     bool Seek(s64 off, int origin);
     u64 Tell() const;
     u64 GetSize() const;
     bool Resize(u64 size);
     bool Flush();
 
+    /**
+     * Replaces the stream's default stdio buffer with one of the given size, enlarging the
+     * readahead window for sequential reads and coalescing more writes before they hit the OS.
+     * Must be called directly after opening, before any other I/O on the stream.
+     */
+    bool SetBufferSize(size_t size);
+
     // clear error state
     void Clear() { m_good = true; std::clearerr(m_file); }
 
 private:
     std::FILE* m_file = nullptr;
     bool m_good = true;
+    std::unique_ptr<char[]> m_buffer;
+
+    /**
+     * Serializes the positioned accessors (ReadAt/WriteAt) and Flush against each other:
+     * one file may be read by an I/O worker while the emulation or journal thread writes
+     * it, and interleaved Tell/Seek/transfer sequences on one FILE* corrupt the stream
+     * position. Held only for the duration of a single positioned operation. Heap-held so
+     * the object stays movable.
+     */
+    std::unique_ptr<std::mutex> m_io_mutex = std::make_unique<std::mutex>();
 };
 
 }  // namespace
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+
 #if defined(_MSC_VER)
 #include <stdlib.h>
 #endif
@@ -12,99 +14,99 @@
 
 namespace Common {
 
-// MurmurHash3 was written by Austin Appleby, and is placed in the public
-// domain. The author hereby disclaims copyright to this source code.
-
-// Block read - if your platform needs to do endian-swapping or can only handle aligned reads, do
-// the conversion here
-static FORCE_INLINE u64 getblock64(const u64* p, int i) {
-    return p[i];
+// This is an implementation of the xxHash64 algorithm designed by Yann Collet
+// (https://github.com/Cyan4973/xxHash, BSD 2-clause). It replaces MurmurHash3 because it
+// reaches roughly twice the throughput on the block sizes we hash every draw: the four
+// independent accumulator lanes keep the multiplier ports busy without needing vector
+// instructions (SSE2 has no 64-bit multiply, so a scalar bulk loop is the fast path here).
+
+static const u64 PRIME64_1 = 11400714785074694791ULL;
+static const u64 PRIME64_2 = 14029467366897019727ULL;
+static const u64 PRIME64_3 =  1609587929392839161ULL;
+static const u64 PRIME64_4 =  9650029242287828579ULL;
+static const u64 PRIME64_5 =  2870177450012600261ULL;
+
+// Unaligned block reads - the hashed state blocks have no alignment guarantees
+static FORCE_INLINE u64 getblock64(const u8* p) {
+    u64 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
 }
 
-// Finalization mix - force all bits of a hash block to avalanche
-static FORCE_INLINE u64 fmix64(u64 k) {
-    k ^= k >> 33;
-    k *= 0xff51afd7ed558ccdllu;
-    k ^= k >> 33;
-    k *= 0xc4ceb9fe1a85ec53llu;
-    k ^= k >> 33;
-
-    return k;
+static FORCE_INLINE u32 getblock32(const u8* p) {
+    u32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
 }
 
-// This is the 128-bit variant of the MurmurHash3 hash function that is targetted for 64-bit
-// platforms (MurmurHash3_x64_128). It was taken from:
-// https://code.google.com/p/smhasher/source/browse/trunk/MurmurHash3.cpp
-void MurmurHash3_128(const void* key, int len, u32 seed, void* out) {
-    const u8 * data = (const u8*)key;
-    const int nblocks = len / 16;
-
-    u64 h1 = seed;
-    u64 h2 = seed;
-
-    const u64 c1 = 0x87c37b91114253d5llu;
-    const u64 c2 = 0x4cf5ad432745937fllu;
-
-    // Body
-
-    const u64 * blocks = (const u64 *)(data);
-
-    for (int i = 0; i < nblocks; i++) {
-        u64 k1 = getblock64(blocks,i*2+0);
-        u64 k2 = getblock64(blocks,i*2+1);
-
-        k1 *= c1; k1  = _rotl64(k1,31); k1 *= c2; h1 ^= k1;
-
-        h1 = _rotl64(h1,27); h1 += h2; h1 = h1*5+0x52dce729;
+static FORCE_INLINE u64 round64(u64 acc, u64 input) {
+    acc += input * PRIME64_2;
+    acc = _rotl64(acc, 31);
+    acc *= PRIME64_1;
+    return acc;
+}
 
-        k2 *= c2; k2  = _rotl64(k2,33); k2 *= c1; h2 ^= k2;
+static FORCE_INLINE u64 merge_round64(u64 acc, u64 val) {
+    acc ^= round64(0, val);
+    acc = acc * PRIME64_1 + PRIME64_4;
+    return acc;
+}
 
-        h2 = _rotl64(h2,31); h2 += h1; h2 = h2*5+0x38495ab5;
+u64 XXHash64(const void* key, size_t len, u64 seed) {
+    const u8* p = static_cast<const u8*>(key);
+    const u8* const end = p + len;
+    u64 h;
+
+    if (len >= 32) {
+        const u8* const limit = end - 32;
+        u64 v1 = seed + PRIME64_1 + PRIME64_2;
+        u64 v2 = seed + PRIME64_2;
+        u64 v3 = seed;
+        u64 v4 = seed - PRIME64_1;
+
+        do {
+            v1 = round64(v1, getblock64(p)); p += 8;
+            v2 = round64(v2, getblock64(p)); p += 8;
+            v3 = round64(v3, getblock64(p)); p += 8;
+            v4 = round64(v4, getblock64(p)); p += 8;
+        } while (p <= limit);
+
+        h = _rotl64(v1, 1) + _rotl64(v2, 7) + _rotl64(v3, 12) + _rotl64(v4, 18);
+        h = merge_round64(h, v1);
+        h = merge_round64(h, v2);
+        h = merge_round64(h, v3);
+        h = merge_round64(h, v4);
+    } else {
+        h = seed + PRIME64_5;
     }
 
-    // Tail
-
-    const u8 * tail = (const u8*)(data + nblocks*16);
-
-    u64 k1 = 0;
-    u64 k2 = 0;
-
-    switch (len & 15) {
-    case 15: k2 ^= ((u64)tail[14]) << 48;
-    case 14: k2 ^= ((u64)tail[13]) << 40;
-    case 13: k2 ^= ((u64)tail[12]) << 32;
-    case 12: k2 ^= ((u64)tail[11]) << 24;
-    case 11: k2 ^= ((u64)tail[10]) << 16;
-    case 10: k2 ^= ((u64)tail[ 9]) << 8;
-    case  9: k2 ^= ((u64)tail[ 8]) << 0;
-        k2 *= c2; k2  = _rotl64(k2,33); k2 *= c1; h2 ^= k2;
+    h += len;
 
-    case  8: k1 ^= ((u64)tail[ 7]) << 56;
-    case  7: k1 ^= ((u64)tail[ 6]) << 48;
-    case  6: k1 ^= ((u64)tail[ 5]) << 40;
-    case  5: k1 ^= ((u64)tail[ 4]) << 32;
-    case  4: k1 ^= ((u64)tail[ 3]) << 24;
-    case  3: k1 ^= ((u64)tail[ 2]) << 16;
-    case  2: k1 ^= ((u64)tail[ 1]) << 8;
-    case  1: k1 ^= ((u64)tail[ 0]) << 0;
-        k1 *= c1; k1  = _rotl64(k1,31); k1 *= c2; h1 ^= k1;
-    };
-
-    // Finalization
-
-    h1 ^= len; h2 ^= len;
+    while (p + 8 <= end) {
+        h ^= round64(0, getblock64(p));
+        h = _rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
 
-    h1 += h2;
-    h2 += h1;
+    if (p + 4 <= end) {
+        h ^= static_cast<u64>(getblock32(p)) * PRIME64_1;
+        h = _rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
 
-    h1 = fmix64(h1);
-    h2 = fmix64(h2);
+    while (p < end) {
+        h ^= (*p) * PRIME64_5;
+        h = _rotl64(h, 11) * PRIME64_1;
+        p++;
+    }
 
-    h1 += h2;
-    h2 += h1;
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
 
-    ((u64*)out)[0] = h1;
-    ((u64*)out)[1] = h2;
+    return h;
 }
 
 } // namespace Common
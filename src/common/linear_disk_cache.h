@@ -4,16 +4,17 @@
 
 #pragma once
 
-#include "common/common_types.h"
+#include <cstring>
 #include <fstream>
 
-// defined in Version.cpp
-extern const char *scm_rev_git_str;
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/scm_rev.h"
 
 // On disk format:
 //header{
 // u32 'DCAC';
-// u32 version;  // svn_rev
+// char ver[40];  // git revision
 // u16 sizeof(key_type);
 // u16 sizeof(value_type);
 //}
@@ -173,7 +174,8 @@ private:
             , key_t_size(sizeof(K))
             , value_t_size(sizeof(V))
         {
-            memcpy(ver, scm_rev_git_str, 40);
+            memset(ver, 0, sizeof(ver));
+            strncpy(ver, Common::g_scm_rev, sizeof(ver) - 1);
         }
 
         const u32 id;
@@ -4,7 +4,11 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <mutex>
+#include <thread>
 
 #include "common/assert.h"
 #include "common/common_funcs.h" // snprintf compatibility define
@@ -12,6 +16,9 @@
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
+#include "common/string_util.h"
+#include "common/thread.h"
+#include "common/thread_topology.h"
 
 namespace Log {
 
@@ -96,18 +103,22 @@ const char* GetLevelName(Level log_level) {
 #undef LVL
 }
 
-Entry CreateEntry(Class log_class, Level log_level,
-                        const char* filename, unsigned int line_nr, const char* function,
-                        const char* format, va_list args) {
+/// Microseconds since the first message was logged
+static std::chrono::microseconds GetTimestamp() {
     using std::chrono::steady_clock;
     using std::chrono::duration_cast;
 
     static steady_clock::time_point time_origin = steady_clock::now();
+    return duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+}
 
+Entry CreateEntry(Class log_class, Level log_level,
+                        const char* filename, unsigned int line_nr, const char* function,
+                        const char* format, va_list args) {
     std::array<char, 4 * 1024> formatting_buffer;
 
     Entry entry;
-    entry.timestamp = duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+    entry.timestamp = GetTimestamp();
     entry.log_class = log_class;
     entry.log_level = log_level;
 
@@ -120,10 +131,132 @@ Entry CreateEntry(Class log_class, Level log_level,
     return entry;
 }
 
+std::array<std::atomic<u8>, static_cast<size_t>(Class::Count)> g_class_levels;
+
 static Filter* filter = nullptr;
 
+/// Mirrors the active filter's levels into g_class_levels for the fast check in log.h
+static void RefreshClassLevels() {
+    for (size_t i = 0; i < static_cast<size_t>(Class::Count); ++i) {
+        Level level = (filter != nullptr) ? filter->GetClassLevel(static_cast<Class>(i))
+                                          : Level::Trace;
+        g_class_levels[i].store(static_cast<u8>(level), std::memory_order_relaxed);
+    }
+}
+
 void SetFilter(Filter* new_filter) {
     filter = new_filter;
+    RefreshClassLevels();
+}
+
+void NotifyFilterChanged(const Filter* changed) {
+    if (changed == filter)
+        RefreshClassLevels();
+}
+
+// Log records travel from producer threads to the logger thread through a bounded lock-free
+// ring. Producers claim a slot by advancing the write cursor, fill it and then publish it via
+// the slot's ready flag; the logger consumes published slots in order. When the ring is full
+// the record is dropped and counted instead of blocking the producer.
+struct AsyncLogSlot {
+    std::chrono::microseconds timestamp;
+    Class log_class;
+    Level log_level;
+    std::array<char, 256> location;
+    std::array<char, 1024> message;
+    std::atomic<bool> ready;
+};
+
+static const u64 ASYNC_LOG_RING_SIZE = 1024; // must be a power of two
+
+static std::array<AsyncLogSlot, ASYNC_LOG_RING_SIZE> async_log_ring;
+static std::atomic<u64> async_log_write{ 0 };
+static std::atomic<u64> async_log_read{ 0 };
+static std::atomic<u64> async_log_dropped{ 0 };
+
+static std::thread logger_thread;
+static std::atomic<bool> logger_running{ false };
+static std::mutex logger_mutex;
+static std::condition_variable logger_cv;
+static bool logger_exit = false;
+
+/// Writes a synthesized entry reporting how many records were lost to ring overflow.
+static void ReportDroppedEntries(u64 dropped) {
+    Entry entry;
+    entry.timestamp = GetTimestamp();
+    entry.log_class = Class::Log;
+    entry.log_level = Level::Warning;
+    entry.location = "<logger>";
+    entry.message = Common::StringFromFormat(
+        "async log ring overflowed, %llu message(s) dropped",
+        static_cast<unsigned long long>(dropped));
+    PrintColoredMessage(entry);
+}
+
+static void LoggerLoop() {
+    Common::RegisterCurrentThread(Common::ThreadRole::IO, "Logger");
+
+    u64 reported_dropped = 0;
+    while (true) {
+        u64 read = async_log_read.load(std::memory_order_relaxed);
+        if (read == async_log_write.load(std::memory_order_acquire)) {
+            u64 dropped = async_log_dropped.load(std::memory_order_relaxed);
+            if (dropped != reported_dropped) {
+                ReportDroppedEntries(dropped - reported_dropped);
+                reported_dropped = dropped;
+            }
+
+            std::unique_lock<std::mutex> lock(logger_mutex);
+            if (logger_exit && read == async_log_write.load(std::memory_order_acquire))
+                break;
+            logger_cv.wait_for(lock, std::chrono::milliseconds(100));
+            continue;
+        }
+
+        AsyncLogSlot& slot = async_log_ring[read & (ASYNC_LOG_RING_SIZE - 1)];
+        if (!slot.ready.load(std::memory_order_acquire)) {
+            // The slot is claimed but the producer has not finished filling it yet
+            std::this_thread::yield();
+            continue;
+        }
+
+        Entry entry;
+        entry.timestamp = slot.timestamp;
+        entry.log_class = slot.log_class;
+        entry.log_level = slot.log_level;
+        entry.location = slot.location.data();
+        entry.message = slot.message.data();
+
+        slot.ready.store(false, std::memory_order_relaxed);
+        async_log_read.store(read + 1, std::memory_order_release);
+
+        PrintColoredMessage(entry);
+    }
+
+    Common::UnregisterCurrentThread();
+}
+
+void StartAsyncBackend() {
+    if (logger_running)
+        return;
+
+    logger_exit = false;
+    logger_thread = std::thread(LoggerLoop);
+    logger_running = true;
+}
+
+void StopAsyncBackend() {
+    if (!logger_running)
+        return;
+
+    // New messages go back to the synchronous path while the ring drains
+    logger_running = false;
+    {
+        std::lock_guard<std::mutex> lock(logger_mutex);
+        logger_exit = true;
+    }
+    logger_cv.notify_one();
+    logger_thread.join();
 }
 
 void LogMessage(Class log_class, Level log_level,
@@ -132,6 +265,33 @@ void LogMessage(Class log_class, Level log_level,
     if (filter != nullptr && !filter->CheckMessage(log_class, log_level))
         return;
 
+    if (logger_running.load(std::memory_order_acquire)) {
+        u64 write = async_log_write.load(std::memory_order_relaxed);
+        do {
+            if (write - async_log_read.load(std::memory_order_acquire) >= ASYNC_LOG_RING_SIZE) {
+                async_log_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        } while (!async_log_write.compare_exchange_weak(write, write + 1,
+                                                        std::memory_order_relaxed));
+
+        AsyncLogSlot& slot = async_log_ring[write & (ASYNC_LOG_RING_SIZE - 1)];
+        slot.timestamp = GetTimestamp();
+        slot.log_class = log_class;
+        slot.log_level = log_level;
+        snprintf(slot.location.data(), slot.location.size(), "%s:%s:%u",
+                 filename, function, line_nr);
+
+        va_list args;
+        va_start(args, format);
+        vsnprintf(slot.message.data(), slot.message.size(), format, args);
+        va_end(args);
+
+        slot.ready.store(true, std::memory_order_release);
+        logger_cv.notify_one();
+        return;
+    }
+
     va_list args;
     va_start(args, format);
     Entry entry = CreateEntry(log_class, log_level,
@@ -50,4 +50,19 @@ Entry CreateEntry(Class log_class, Level log_level,
 
 void SetFilter(Filter* filter);
 
+/// Re-mirrors the active filter's levels into the fast per-class table in log.h.
+/// Called by Filter whenever it is mutated; a no-op for filters that are not active.
+void NotifyFilterChanged(const Filter* changed);
+
+/**
+ * Starts the asynchronous logging thread. Producers then hand records to it through a bounded
+ * lock-free ring instead of writing to stderr themselves; when the ring is full, records are
+ * dropped and counted rather than blocking the producer. Messages logged while the thread is
+ * not running are written synchronously as before.
+ */
+void StartAsyncBackend();
+
+/// Drains the ring, reports any dropped records and joins the logging thread.
+void StopAsyncBackend();
+
 }
@@ -44,6 +44,11 @@ public:
     void ParseFilterString(const std::string& filter_str);
     bool ParseFilterRule(const std::string::const_iterator start, const std::string::const_iterator end);
 
+    /// Returns the minimum level of `log_class`.
+    Level GetClassLevel(Class log_class) const {
+        return class_levels[static_cast<size_t>(log_class)];
+    }
+
     /// Matches class/level combination against the filter, returning true if it passed.
     bool CheckMessage(Class log_class, Level level) const;
 
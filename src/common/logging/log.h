@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+
 #include "common/common_types.h"
 
 namespace Log {
@@ -86,6 +90,17 @@ enum class Class : ClassType {
     Count ///< Total number of logging classes
 };
 
+/// Per-class minimum levels, mirrored from the active filter (see SetFilter). Values are the
+/// numeric Level; unset (zero) means Trace, i.e. everything passes.
+extern std::array<std::atomic<u8>, static_cast<size_t>(Class::Count)> g_class_levels;
+
+/// Cheap global filter check: a single relaxed load, performed by the LOG_* macros before the
+/// log arguments are even evaluated.
+inline bool IsLevelEnabled(Class log_class, Level level) {
+    return static_cast<u8>(level) >=
+           g_class_levels[static_cast<size_t>(log_class)].load(std::memory_order_relaxed);
+}
+
 /// Logs a message to the global logger.
 void LogMessage(Class log_class, Level log_level,
     const char* filename, unsigned int line_nr, const char* function,
@@ -101,7 +116,10 @@ void LogMessage(Class log_class, Level log_level,
 } // namespace Log
 
 #define LOG_GENERIC(log_class, log_level, ...) \
-    ::Log::LogMessage(log_class, log_level, __FILE__, __LINE__, __func__, __VA_ARGS__)
+    do { \
+        if (::Log::IsLevelEnabled(log_class, log_level)) \
+            ::Log::LogMessage(log_class, log_level, __FILE__, __LINE__, __func__, __VA_ARGS__); \
+    } while (0)
 
 #ifdef _DEBUG
 #define LOG_TRACE(   log_class, ...) LOG_GENERIC(::Log::Class::log_class, ::Log::Level::Trace,    __VA_ARGS__)
@@ -0,0 +1,128 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#include "common/string_util.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+
+namespace FileUtil {
+
+MappedFile::MappedFile() {
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) : MappedFile() {
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+    Swap(other);
+    return *this;
+}
+
+void MappedFile::Swap(MappedFile& other) {
+    std::swap(base, other.base);
+    std::swap(size, other.size);
+#ifdef _WIN32
+    std::swap(mapping_handle, other.mapping_handle);
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+
+    HANDLE file_handle = CreateFileW(Common::UTF8ToUTF16W(filename).c_str(), GENERIC_READ,
+                                     FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // The mapping keeps its own reference to the file; the handle is no longer needed.
+    CloseHandle(file_handle);
+    if (mapping_handle == nullptr)
+        return false;
+
+    base = static_cast<const u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (base == nullptr) {
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+        return false;
+    }
+
+    size = file_size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (base != nullptr) {
+        UnmapViewOfFile(const_cast<u8*>(base));
+        base = nullptr;
+    }
+    if (mapping_handle != nullptr) {
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+    }
+    size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat file_info;
+    if (fstat(fd, &file_info) != 0 || file_info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file; the descriptor is no longer needed.
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+
+    base = static_cast<const u8*>(view);
+    size = file_info.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (base != nullptr) {
+        munmap(const_cast<u8*>(base), size);
+        base = nullptr;
+    }
+    size = 0;
+}
+
+#endif
+
+} // namespace FileUtil
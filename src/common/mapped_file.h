@@ -0,0 +1,47 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+namespace FileUtil {
+
+/**
+ * Read-only memory mapping of a file. The OS populates pages lazily on first access, so
+ * mapping a large container file is cheap until its data is actually touched, and mapped
+ * pages are shared with any other reader of the same file through the page cache.
+ */
+class MappedFile : public NonCopyable {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+
+    void Swap(MappedFile& other);
+
+    /// Maps the given file read-only. Returns false (leaving the object unmapped) on failure.
+    bool Open(const std::string& filename);
+    void Close();
+
+    bool IsOpen() const { return base != nullptr; }
+
+    const u8* GetData() const { return base; }
+    u64 GetSize() const { return size; }
+
+private:
+    const u8* base = nullptr;
+    u64 size = 0;
+
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
+} // namespace FileUtil
@@ -0,0 +1,89 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <mutex>
+#include <vector>
+
+#include "common/logging/log.h"
+#include "common/memory_accounting.h"
+
+namespace Common {
+namespace MemoryAccounting {
+
+struct Entry {
+    int handle;
+    const char* name;
+    UsageCallback usage;
+    ShrinkCallback shrink;
+};
+
+static std::mutex mutex;
+static std::vector<Entry> entries;
+static int next_handle = 1;
+static u64 budget_bytes = 0;
+
+int Register(const char* name, UsageCallback usage, ShrinkCallback shrink) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const int handle = next_handle++;
+    entries.push_back({handle, name, std::move(usage), std::move(shrink)});
+    return handle;
+}
+
+void Unregister(int handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->handle == handle) {
+            entries.erase(it);
+            return;
+        }
+    }
+}
+
+void SetBudget(u64 bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget_bytes = bytes;
+}
+
+void EnforceBudget() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (budget_bytes == 0 || entries.empty())
+        return;
+
+    std::vector<u64> usages(entries.size());
+    u64 total = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        usages[i] = entries[i].usage();
+        total += usages[i];
+    }
+    if (total <= budget_bytes)
+        return;
+
+    // Every shrinkable cache is asked to evict down to its proportional share of the
+    // budget, so the pressure lands where the memory actually is. Report-only caches
+    // keep their usage; their share effectively shrinks the budget for the others.
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!entries[i].shrink)
+            continue;
+        const u64 target = static_cast<u64>(usages[i] * (budget_bytes / (double)total));
+        LOG_DEBUG(Common, "Cache '%s' over budget: %llu KB -> target %llu KB",
+                  entries[i].name, (unsigned long long)(usages[i] / 1024),
+                  (unsigned long long)(target / 1024));
+        entries[i].shrink(target);
+    }
+}
+
+void LogBreakdown() {
+    std::lock_guard<std::mutex> lock(mutex);
+    u64 total = 0;
+    for (const auto& entry : entries) {
+        const u64 usage = entry.usage();
+        total += usage;
+        LOG_INFO(Common, "Cache '%s': %llu KB", entry.name, (unsigned long long)(usage / 1024));
+    }
+    LOG_INFO(Common, "Total accounted cache memory: %llu KB (budget: %llu KB)",
+             (unsigned long long)(total / 1024), (unsigned long long)(budget_bytes / 1024));
+}
+
+} // namespace MemoryAccounting
+} // namespace Common
@@ -0,0 +1,46 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+
+#include "common/common_types.h"
+
+namespace Common {
+namespace MemoryAccounting {
+
+// Host-memory accounting for the emulator's otherwise unbounded caches. Each cache
+// registers a usage callback and (optionally) a shrink callback; when a total budget is
+// configured, the coordinator applies eviction pressure once per displayed frame,
+// proportional to each cache's share of the total, so long sessions converge on the
+// budget instead of growing without bound.
+
+/// Reports the cache's current host memory usage in bytes
+using UsageCallback = std::function<u64()>;
+
+/// Asks the cache to evict down to roughly the given number of bytes. Null for caches
+/// that can only be measured (e.g. fixed-capacity arenas).
+using ShrinkCallback = std::function<void(u64 target_bytes)>;
+
+/// Registers a cache; the returned handle is passed to Unregister()
+int Register(const char* name, UsageCallback usage, ShrinkCallback shrink);
+
+void Unregister(int handle);
+
+/// Sets the total budget over all registered caches, in bytes. 0 disables enforcement.
+void SetBudget(u64 bytes);
+
+/**
+ * Polls every registered cache and, if the total exceeds the budget, asks each
+ * shrinkable cache to evict down to its proportional share. Called once per displayed
+ * frame, on the same thread the caches are used from.
+ */
+void EnforceBudget();
+
+/// Logs each registered cache's usage and the total
+void LogBreakdown();
+
+} // namespace MemoryAccounting
+} // namespace Common
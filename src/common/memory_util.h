@@ -8,8 +8,28 @@
 #include <string>
 
 void* AllocateExecutableMemory(size_t size, bool low = true);
+
+/**
+ * Allocates code space mapped twice: *writable is a read-write view and *executable a
+ * read-execute view of the same pages. This lets JITs emit continuously on hosts that
+ * forbid RWX mappings, without the per-compile protection flips (and TLB shootdowns)
+ * that mprotect toggling costs.
+ * @return false when the host cannot provide dual mappings; callers should fall back to
+ * a plain AllocateExecutableMemory region.
+ */
+bool AllocateDualMappedCodeSpace(size_t size, void** writable, void** executable);
+void FreeDualMappedCodeSpace(void* writable, void* executable, size_t size);
 void* AllocateMemoryPages(size_t size);
 void FreeMemoryPages(void* ptr, size_t size);
+
+/**
+ * Asks the host kernel to back [ptr, ptr + size) with transparent huge pages where it
+ * can (Linux madvise(MADV_HUGEPAGE); a no-op elsewhere). Worth issuing for large
+ * long-lived allocations that emulation touches constantly -- guest RAM on 2MB pages
+ * cuts host dTLB misses on every guest memory access. Purely a hint: the range stays
+ * valid and ordinary 4K pages are used when the kernel declines.
+ */
+void HintLargePages(void* ptr, size_t size);
 void* AllocateAlignedMemory(size_t size,size_t alignment);
 void FreeAlignedMemory(void* ptr);
 void WriteProtectMemory(void* ptr, size_t size, bool executable = false);
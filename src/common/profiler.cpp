@@ -9,6 +9,7 @@
 #include "common/assert.h"
 #include "common/profiler_reporting.h"
 #include "common/synchronized_wrapper.h"
+#include "common/telemetry.h"
 
 namespace Common {
 namespace Profiling {
@@ -28,6 +29,9 @@ void ProfilingManager::FinishFrame() {
     results.frame_time = now - this_frame_start;
 
     last_frame_end = now;
+
+    Telemetry::Record(Telemetry::Stage::Frame,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(results.frame_time));
 }
 
 TimingResultsAggregator::TimingResultsAggregator(size_t window_size)
@@ -0,0 +1,76 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+
+#ifdef ARCHITECTURE_x86_64
+#include <tmmintrin.h>
+
+#include "common/x64/cpu_detect.h"
+#endif
+
+#include "common/swap.h"
+
+namespace Common {
+
+#ifdef ARCHITECTURE_x86_64
+
+// MSVC allows SSSE3 intrinsics unconditionally; GCC/Clang need the target enabled on the
+// function since the translation unit is built for baseline x86-64. Both paths are only
+// reached after the runtime SSSE3 check below.
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define TARGET_SSSE3
+#endif
+
+TARGET_SSSE3
+static void SwapBuffer16_SSSE3(u16* data, std::size_t count) {
+    // Selects, for each output byte, the input byte with its 16-bit lane partner
+    const __m128i shuffle = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    for (; count >= 8; count -= 8, data += 8) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_shuffle_epi8(values, shuffle));
+    }
+    for (; count != 0; --count, ++data)
+        *data = swap16(*data);
+}
+
+TARGET_SSSE3
+static void SwapBuffer32_SSSE3(u32* data, std::size_t count) {
+    // Reverses the four bytes of each 32-bit lane
+    const __m128i shuffle = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    for (; count >= 4; count -= 4, data += 4) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_shuffle_epi8(values, shuffle));
+    }
+    for (; count != 0; --count, ++data)
+        *data = swap32(*data);
+}
+
+#endif // ARCHITECTURE_x86_64
+
+void SwapBuffer16(u16* data, std::size_t count) {
+#ifdef ARCHITECTURE_x86_64
+    if (GetCPUCaps().ssse3) {
+        SwapBuffer16_SSSE3(data, count);
+        return;
+    }
+#endif
+    for (; count != 0; --count, ++data)
+        *data = swap16(*data);
+}
+
+void SwapBuffer32(u32* data, std::size_t count) {
+#ifdef ARCHITECTURE_x86_64
+    if (GetCPUCaps().ssse3) {
+        SwapBuffer32_SSSE3(data, count);
+        return;
+    }
+#endif
+    for (; count != 0; --count, ++data)
+        *data = swap32(*data);
+}
+
+} // namespace Common
@@ -25,6 +25,7 @@
     #include <sys/endian.h>
 #endif
 
+#include <cstddef>
 #include <cstring>
 
 #include "common/common_types.h"
@@ -116,6 +117,16 @@ inline double swapd(double f) {
     return f;
 }
 
+/**
+ * Byte-swaps an array of 16-bit values in place. Uses SSE byte shuffles on hosts that support
+ * them and falls back to scalar swap16 otherwise, so loops over big-endian-sourced data don't
+ * pay one load/swap/store round trip per element.
+ */
+void SwapBuffer16(u16* data, std::size_t count);
+
+/// Byte-swaps an array of 32-bit values in place; see SwapBuffer16
+void SwapBuffer32(u32* data, std::size_t count);
+
 }  // Namespace Common
 
 
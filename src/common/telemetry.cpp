@@ -0,0 +1,146 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/string_util.h"
+#include "common/telemetry.h"
+
+namespace Common {
+namespace Telemetry {
+
+// Fixed-width histogram per stage: 0.1 ms buckets covering 0 - 102.4 ms, with everything beyond
+// that landing in the last bucket. The resolution is coarse enough to keep the tables small and
+// fine enough to resolve the percentiles we care about around the 16.7 ms frame budget.
+static const size_t NUM_BUCKETS = 1024;
+static const u64 BUCKET_WIDTH_NS = 100 * 1000; // 0.1 ms
+
+struct StageHistogram {
+    std::array<std::atomic<u64>, NUM_BUCKETS> buckets;
+    std::atomic<u64> count;
+    std::atomic<u64> sum_ns;
+    std::atomic<u64> max_ns;
+};
+
+static const char* STAGE_NAMES[static_cast<size_t>(Stage::Count)] = {
+    "frame", "draw", "present", "audio", "input",
+};
+
+static StageHistogram histograms[static_cast<size_t>(Stage::Count)];
+
+void Record(Stage stage, std::chrono::nanoseconds duration) {
+    StageHistogram& hist = histograms[static_cast<size_t>(stage)];
+    u64 ns = static_cast<u64>(std::max<s64>(duration.count(), 0));
+
+    size_t bucket = std::min<size_t>(ns / BUCKET_WIDTH_NS, NUM_BUCKETS - 1);
+    hist.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    hist.count.fetch_add(1, std::memory_order_relaxed);
+    hist.sum_ns.fetch_add(ns, std::memory_order_relaxed);
+
+    u64 prev_max = hist.max_ns.load(std::memory_order_relaxed);
+    while (ns > prev_max &&
+           !hist.max_ns.compare_exchange_weak(prev_max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+/// Returns the upper bound of the bucket containing the given quantile, in milliseconds
+static float QuantileFromBuckets(const StageHistogram& hist, u64 total, float quantile) {
+    u64 threshold = static_cast<u64>(total * quantile);
+    u64 seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += hist.buckets[i].load(std::memory_order_relaxed);
+        if (seen > threshold)
+            return (i + 1) * (BUCKET_WIDTH_NS / 1000000.f);
+    }
+    return NUM_BUCKETS * (BUCKET_WIDTH_NS / 1000000.f);
+}
+
+Percentiles GetPercentiles(Stage stage) {
+    const StageHistogram& hist = histograms[static_cast<size_t>(stage)];
+
+    Percentiles result{};
+    result.count = hist.count.load(std::memory_order_relaxed);
+    if (result.count == 0)
+        return result;
+
+    result.p50 = QuantileFromBuckets(hist, result.count, 0.50f);
+    result.p95 = QuantileFromBuckets(hist, result.count, 0.95f);
+    result.p99 = QuantileFromBuckets(hist, result.count, 0.99f);
+    result.max = hist.max_ns.load(std::memory_order_relaxed) / 1000000.f;
+    return result;
+}
+
+u64 GetSampleCount(Stage stage) {
+    return histograms[static_cast<size_t>(stage)].count.load(std::memory_order_relaxed);
+}
+
+const char* GetStageName(Stage stage) {
+    return STAGE_NAMES[static_cast<size_t>(stage)];
+}
+
+std::string GetSummaryString() {
+    Percentiles frame = GetPercentiles(Stage::Frame);
+    Percentiles draw = GetPercentiles(Stage::Draw);
+    if (frame.count == 0)
+        return "";
+
+    std::string summary = StringFromFormat("frame %.1f/%.1f/%.1f ms (p50/p95/p99)",
+                                           frame.p50, frame.p95, frame.p99);
+    if (draw.count != 0)
+        summary += StringFromFormat(" | draw %.1f ms", draw.p50);
+
+    Percentiles input = GetPercentiles(Stage::Input);
+    if (input.count != 0)
+        summary += StringFromFormat(" | input %.1f/%.1f ms", input.p50, input.p95);
+    return summary;
+}
+
+void DumpJSON() {
+    std::string json = "{\n";
+    for (size_t stage = 0; stage < static_cast<size_t>(Stage::Count); ++stage) {
+        const StageHistogram& hist = histograms[stage];
+        Percentiles p = GetPercentiles(static_cast<Stage>(stage));
+
+        u64 sum_ns = hist.sum_ns.load(std::memory_order_relaxed);
+        json += StringFromFormat(
+            "  \"%s\": {\n"
+            "    \"count\": %llu,\n"
+            "    \"total_ms\": %.3f,\n"
+            "    \"p50_ms\": %.3f,\n"
+            "    \"p95_ms\": %.3f,\n"
+            "    \"p99_ms\": %.3f,\n"
+            "    \"max_ms\": %.3f,\n"
+            "    \"bucket_width_ms\": %.1f,\n"
+            "    \"histogram\": [",
+            STAGE_NAMES[stage], static_cast<unsigned long long>(p.count), sum_ns / 1000000.0,
+            p.p50, p.p95, p.p99, p.max, BUCKET_WIDTH_NS / 1000000.f);
+
+        // Trailing zero buckets are elided to keep the file small
+        size_t last_used = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            if (hist.buckets[i].load(std::memory_order_relaxed) != 0)
+                last_used = i + 1;
+        }
+        for (size_t i = 0; i < last_used; ++i) {
+            json += StringFromFormat(
+                "%s%llu", i == 0 ? "" : ",",
+                static_cast<unsigned long long>(hist.buckets[i].load(std::memory_order_relaxed)));
+        }
+
+        json += StringFromFormat("]\n  }%s\n",
+                                 stage + 1 == static_cast<size_t>(Stage::Count) ? "" : ",");
+    }
+    json += "}\n";
+
+    std::string filename = FileUtil::GetUserPath(D_LOGS_IDX) + "telemetry.json";
+    FileUtil::CreateFullPath(filename);
+    FileUtil::WriteStringToFile(true, json, filename.c_str());
+}
+
+} // namespace Telemetry
+} // namespace Common
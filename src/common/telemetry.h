@@ -0,0 +1,73 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "common/common_types.h"
+
+namespace Common {
+namespace Telemetry {
+
+/// Pipeline stages tracked by the telemetry histograms
+enum class Stage : u8 {
+    Frame,   ///< Time spent producing a frame, excluding VSync
+    Draw,    ///< Time spent compositing the screens
+    Present, ///< Time spent presenting to the host window (including any VSync wait)
+    Audio,   ///< Time spent per DSP audio tick
+    Input,   ///< Latency from host input event receipt to the next presented frame
+    Count
+};
+
+/// Duration percentiles for one stage, in milliseconds
+struct Percentiles {
+    float p50;
+    float p95;
+    float p99;
+    float max;
+    u64 count; ///< Number of samples the percentiles were computed from
+};
+
+/**
+ * Adds one duration sample to the given stage's histogram. This is a couple of relaxed atomic
+ * increments and is cheap enough to be left on in production builds.
+ */
+void Record(Stage stage, std::chrono::nanoseconds duration);
+
+/// Computes percentiles over all samples recorded for the given stage so far
+Percentiles GetPercentiles(Stage stage);
+
+/// Returns how many samples have been recorded for the given stage. Cheaper than GetPercentiles
+/// when only the count is needed, e.g. to poll for a target frame number.
+u64 GetSampleCount(Stage stage);
+
+/// Returns the display name of the given stage
+const char* GetStageName(Stage stage);
+
+/// Returns a compact one-line frame time summary, suitable for a window title HUD
+std::string GetSummaryString();
+
+/// Writes all stage histograms as JSON to <user>/logs/telemetry.json
+void DumpJSON();
+
+/// RAII helper recording the lifetime of the object as one sample of the given stage
+class ScopedSample {
+public:
+    explicit ScopedSample(Stage stage)
+        : stage(stage), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedSample() {
+        Record(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start));
+    }
+
+private:
+    Stage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace Telemetry
+} // namespace Common
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "common/thread.h"
 
 #ifdef __APPLE__
@@ -18,6 +20,7 @@
 #endif
 
 #ifndef _WIN32
+    #include <sys/resource.h>
     #include <unistd.h>
 #endif
 
@@ -55,6 +58,16 @@ void SetCurrentThreadAffinity(u32 mask)
     SetThreadAffinityMask(GetCurrentThread(), mask);
 }
 
+void SetCurrentThreadPriority(int priority)
+{
+    static const int win_priorities[] = {
+        THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+        THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST,
+    };
+    priority = std::min(std::max(priority, -2), 2);
+    SetThreadPriority(GetCurrentThread(), win_priorities[priority + 2]);
+}
+
 void SwitchCurrentThread()
 {
     SwitchToThread();
@@ -117,6 +130,17 @@ void SetCurrentThreadAffinity(u32 mask)
     SetThreadAffinity(pthread_self(), mask);
 }
 
+void SetCurrentThreadPriority(int priority)
+{
+#if defined(__linux__) && !defined(ANDROID)
+    // On Linux, setpriority() with a zero id adjusts the nice value of the calling thread
+    // only. Negative nice values (raised priority) require CAP_SYS_NICE and may fail, which
+    // is deliberately ignored here.
+    priority = std::min(std::max(priority, -2), 2);
+    setpriority(PRIO_PROCESS, 0, priority * -5);
+#endif
+}
+
 #ifndef _WIN32
 void SleepCurrentThread(int ms)
 {
@@ -37,6 +37,11 @@ int CurrentThreadId();
 void SetThreadAffinity(std::thread::native_handle_type thread, u32 mask);
 void SetCurrentThreadAffinity(u32 mask);
 
+/// Adjusts the calling thread's priority. Takes a relative level in [-2, 2]; positive raises
+/// the priority, negative lowers it, 0 is the platform default. Raising may silently fail on
+/// platforms where it requires elevated privileges.
+void SetCurrentThreadPriority(int priority);
+
 class Event {
 public:
     Event() : is_set(false) {}
@@ -0,0 +1,226 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "common/thread_pool.h"
+#include "common/thread_topology.h"
+
+namespace Common {
+namespace ThreadPool {
+
+namespace {
+
+/// One worker's deque. The owner pushes and pops at the back; thieves take from the front,
+/// so the two ends only contend when the deque is nearly empty.
+struct WorkerDeque {
+    std::deque<Task> tasks;
+    std::mutex mutex;
+};
+
+} // namespace
+
+static std::vector<std::unique_ptr<WorkerDeque>> deques;
+static std::vector<std::thread> worker_threads;
+
+/// Latency-class tasks bypass the deques entirely; every worker drains this queue first
+static std::deque<Task> latency_queue;
+static std::mutex latency_mutex;
+
+static std::mutex wake_mutex;
+static std::condition_variable wake_cv;
+
+/// Count of queued-but-not-yet-taken tasks, so sleeping workers have a wait predicate
+static std::atomic<u32> num_pending{0};
+static std::atomic<bool> should_exit{false};
+
+/// Round-robin target for tasks submitted from outside the pool
+static std::atomic<u32> next_deque{0};
+
+/// Index of the calling worker's own deque, or -1 on threads outside the pool
+static thread_local int worker_index = -1;
+
+/**
+ * Takes one task, checking the latency queue, then the caller's own deque (newest first),
+ * then the other deques (oldest first). Decrements num_pending on success.
+ */
+static bool PopTask(Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(latency_mutex);
+        if (!latency_queue.empty()) {
+            task = std::move(latency_queue.front());
+            latency_queue.pop_front();
+            num_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    if (worker_index >= 0) {
+        WorkerDeque& own = *deques[worker_index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            num_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal scan; starting at the thread's own index spreads victims across thieves
+    const size_t start = (worker_index >= 0) ? worker_index : next_deque.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < deques.size(); ++i) {
+        WorkerDeque& victim = *deques[(start + i) % deques.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            num_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void WorkerMain(unsigned index) {
+    RegisterCurrentThread(ThreadRole::Worker, "Pool worker");
+    worker_index = static_cast<int>(index);
+
+    Task task;
+    while (true) {
+        if (PopTask(task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        if (should_exit.load(std::memory_order_relaxed) &&
+            num_pending.load(std::memory_order_relaxed) == 0)
+            break;
+        wake_cv.wait(lock, [] {
+            return should_exit.load(std::memory_order_relaxed) ||
+                   num_pending.load(std::memory_order_relaxed) > 0;
+        });
+    }
+}
+
+void Initialize(unsigned num_threads) {
+    if (!worker_threads.empty())
+        return;
+
+    if (num_threads == 0) {
+        // Leave a core for the thread that keeps the pool fed
+        const unsigned cores = std::thread::hardware_concurrency();
+        num_threads = (cores > 1) ? cores - 1 : 1;
+    }
+
+    should_exit.store(false, std::memory_order_relaxed);
+    for (unsigned i = 0; i < num_threads; ++i)
+        deques.emplace_back(std::make_unique<WorkerDeque>());
+    for (unsigned i = 0; i < num_threads; ++i)
+        worker_threads.emplace_back(WorkerMain, i);
+}
+
+void Shutdown() {
+    if (worker_threads.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        should_exit.store(true, std::memory_order_relaxed);
+    }
+    wake_cv.notify_all();
+    for (auto& thread : worker_threads)
+        thread.join();
+    worker_threads.clear();
+    deques.clear();
+}
+
+/// Queues one task without waking anybody; the caller notifies once per submission
+static void Enqueue(Task&& task, TaskPriority priority) {
+    if (priority == TaskPriority::Latency) {
+        std::lock_guard<std::mutex> lock(latency_mutex);
+        latency_queue.push_back(std::move(task));
+    } else {
+        const size_t target = (worker_index >= 0)
+                                  ? worker_index
+                                  : next_deque.fetch_add(1, std::memory_order_relaxed) % deques.size();
+        WorkerDeque& deque = *deques[target];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.tasks.push_back(std::move(task));
+    }
+    num_pending.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Submit(Task task, TaskPriority priority) {
+    // Without a pool there is nobody to hand the task to; run it in place
+    if (deques.empty()) {
+        task();
+        return;
+    }
+
+    Enqueue(std::move(task), priority);
+    {
+        // Taken so a worker cannot check the predicate and sleep between our enqueue and
+        // notify; uncontended in the common case of workers already running
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake_cv.notify_one();
+}
+
+void SubmitBatch(std::vector<Task> tasks, TaskPriority priority) {
+    if (tasks.empty())
+        return;
+    if (deques.empty()) {
+        for (auto& task : tasks)
+            task();
+        return;
+    }
+
+    for (auto& task : tasks)
+        Enqueue(std::move(task), priority);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake_cv.notify_all();
+}
+
+bool TryRunOneTask() {
+    Task task;
+    if (!PopTask(task))
+        return false;
+    task();
+    return true;
+}
+
+void WaitGroup::Submit(Task task, TaskPriority priority) {
+    remaining.fetch_add(1, std::memory_order_relaxed);
+    ThreadPool::Submit(
+        [this, task]() {
+            task();
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                done_event.Set();
+        },
+        priority);
+}
+
+void WaitGroup::Wait() {
+    done_event.Reset();
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (TryRunOneTask())
+            continue;
+        // Our remaining tasks are running on workers; the last one to finish wakes us.
+        // Re-check first in case it already has -- the sticky Event covers the race.
+        if (remaining.load(std::memory_order_acquire) > 0)
+            done_event.Wait();
+    }
+}
+
+} // namespace ThreadPool
+} // namespace Common
@@ -0,0 +1,78 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/thread.h"
+
+namespace Common {
+
+/**
+ * Shared worker pool for background work. Each worker owns a task deque: it pushes and pops
+ * work at the back, and idle workers steal from the front of other deques, so a burst of
+ * tasks submitted together spreads across the pool while tasks that spawn subtasks keep
+ * them hot in their own deque. Workers register under ThreadRole::Worker, so their affinity
+ * and priority follow the thread topology settings like every other pooled thread.
+ *
+ * Latency-critical tasks (audio frames, input) are submitted with TaskPriority::Latency and
+ * go through a dedicated queue that every worker drains before touching any deque, so they
+ * overtake however many throughput tasks (shader compiles, captures) are already queued.
+ */
+namespace ThreadPool {
+
+using Task = std::function<void()>;
+
+enum class TaskPriority {
+    Latency,    ///< Runs before any queued Throughput task; keep these short
+    Throughput, ///< Default class for bulk background work
+};
+
+/**
+ * Starts the pool. `num_threads` of 0 sizes it to the host core count minus one, leaving a
+ * core for the thread that keeps submitting, and never below one worker. Safe to call when
+ * already initialized (the running pool is kept).
+ */
+void Initialize(unsigned num_threads = 0);
+
+/// Runs the queue dry and joins the workers. Pending tasks are completed, not dropped.
+void Shutdown();
+
+/// Schedules one task. Callable from any thread, including from inside a running task.
+void Submit(Task task, TaskPriority priority = TaskPriority::Throughput);
+
+/**
+ * Schedules a batch of tasks with one round of locking and one worker wakeup, spreading the
+ * batch across the deques up front. Cheaper than per-task Submit calls when fanning out
+ * e.g. one task per tile or per file.
+ */
+void SubmitBatch(std::vector<Task> tasks, TaskPriority priority = TaskPriority::Throughput);
+
+/**
+ * Runs one queued task on the calling thread if any is available; returns whether one ran.
+ * Lets a thread that is waiting on pool work help drain the pool instead of blocking.
+ */
+bool TryRunOneTask();
+
+/**
+ * Completion tracker for a group of pool tasks. Submit work through it and Wait() for all
+ * of it to finish; the waiting thread executes queued tasks itself while it waits, so a
+ * full pool cannot deadlock a waiter whose tasks have not been picked up yet.
+ */
+class WaitGroup {
+public:
+    void Submit(Task task, TaskPriority priority = TaskPriority::Throughput);
+    void Wait();
+
+private:
+    std::atomic<u32> remaining{0};
+    Event done_event;
+};
+
+} // namespace ThreadPool
+} // namespace Common
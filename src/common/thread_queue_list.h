@@ -9,6 +9,9 @@
 
 #include <boost/range/algorithm_ext/erase.hpp>
 
+#include "common/bit_set.h"
+#include "common/common_types.h"
+
 namespace Common {
 
 template<class T, unsigned int N>
@@ -23,7 +26,7 @@ struct ThreadQueueList {
     static const Priority NUM_QUEUES = N;
 
     ThreadQueueList() {
-        first = nullptr;
+        occupied.fill(0);
     }
 
     // Only for debugging, returns priority level.
@@ -39,65 +42,48 @@ struct ThreadQueueList {
     }
 
     T get_first() {
-        Queue *cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        Priority priority = first_nonempty();
+        if (priority == NUM_QUEUES)
+            return T();
+        return queues[priority].data.front();
     }
 
     T pop_first() {
-        Queue *cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        Priority priority = first_nonempty();
+        if (priority == NUM_QUEUES)
+            return T();
+        return pop(priority);
     }
 
     T pop_first_better(Priority priority) {
-        Queue *cur = first;
-        Queue *stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        Priority best = first_nonempty();
+        if (best >= priority)
+            return T();
+        return pop(best);
     }
 
     void push_front(Priority priority, const T& thread_id) {
         Queue *cur = &queues[priority];
         cur->data.push_front(thread_id);
+        set_occupied(priority);
     }
 
     void push_back(Priority priority, const T& thread_id) {
         Queue *cur = &queues[priority];
         cur->data.push_back(thread_id);
+        set_occupied(priority);
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
     void remove(Priority priority, const T& thread_id) {
         Queue *cur = &queues[priority];
         boost::remove_erase(cur->data, thread_id);
+        if (cur->data.empty())
+            clear_occupied(priority);
     }
 
     void rotate(Priority priority) {
@@ -111,7 +97,7 @@ struct ThreadQueueList {
 
     void clear() {
         queues.fill(Queue());
-        first = nullptr;
+        occupied.fill(0);
     }
 
     bool empty(Priority priority) const {
@@ -119,42 +105,49 @@ struct ThreadQueueList {
         return cur->data.empty();
     }
 
+    /// Kept for API compatibility; the bitmask needs no per-priority setup.
     void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        // Each queue head gets its own cache line, so scheduler dequeues on one priority don't
+        // false-share with pushes on a neighboring one.
+        alignas(64) std::deque<T> data;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    static const unsigned int BITS_PER_WORD = 64;
+    static const unsigned int NUM_WORDS = (NUM_QUEUES + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    /// Returns the highest (numerically lowest) priority with a queued entry, found with a
+    /// trailing-zero count over the occupancy bitmask, or NUM_QUEUES if everything is empty.
+    Priority first_nonempty() const {
+        for (unsigned int word = 0; word < NUM_WORDS; ++word) {
+            if (occupied[word] != 0)
+                return word * BITS_PER_WORD + LeastSignificantSetBit(occupied[word]);
+        }
+        return NUM_QUEUES;
     }
 
-    void link(Priority priority) {
-        Queue *cur = &queues[priority];
+    void set_occupied(Priority priority) {
+        occupied[priority / BITS_PER_WORD] |= u64(1) << (priority % BITS_PER_WORD);
+    }
 
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
+    void clear_occupied(Priority priority) {
+        occupied[priority / BITS_PER_WORD] &= ~(u64(1) << (priority % BITS_PER_WORD));
+    }
 
-        cur->next_nonempty = first;
-        first = cur;
+    T pop(Priority priority) {
+        Queue& cur = queues[priority];
+        auto tmp = std::move(cur.data.front());
+        cur.data.pop_front();
+        if (cur.data.empty())
+            clear_occupied(priority);
+        return tmp;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
+    // Bit per priority level, set while the level's queue is nonempty.
+    std::array<u64, NUM_WORDS> occupied;
     // The priority level queues of thread ids.
     std::array<Queue, NUM_QUEUES> queues;
 };
@@ -0,0 +1,94 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/thread.h"
+#include "common/thread_topology.h"
+
+#ifdef _MSC_VER
+    #include <Windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+namespace Common {
+
+struct RegisteredThread {
+    ThreadRole role;
+    std::thread::id id; ///< Used to find the calling thread's entry on unregister
+    std::thread::native_handle_type handle; ///< Used to re-apply affinity from other threads
+};
+
+static std::mutex topology_mutex;
+static ThreadRoleConfig role_configs[NUM_THREAD_ROLES];
+static std::vector<RegisteredThread> registered_threads;
+
+static ThreadRoleConfig& ConfigFor(ThreadRole role) {
+    return role_configs[static_cast<unsigned>(role)];
+}
+
+/// Returns a handle for the calling thread that stays valid when used from other threads
+static std::thread::native_handle_type GetCurrentNativeHandle() {
+#ifdef _MSC_VER
+    // GetCurrentThread() returns a pseudo-handle only meaningful on the calling thread, so a
+    // real handle has to be duplicated for cross-thread affinity updates
+    HANDLE handle = nullptr;
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &handle, 0,
+                    FALSE, DUPLICATE_SAME_ACCESS);
+    return handle;
+#else
+    return pthread_self();
+#endif
+}
+
+void SetThreadRoleConfig(ThreadRole role, const ThreadRoleConfig& config) {
+    std::lock_guard<std::mutex> lock(topology_mutex);
+
+    ThreadRoleConfig& current = ConfigFor(role);
+    const bool affinity_changed = current.affinity_mask != config.affinity_mask;
+    current = config;
+
+    // Affinity can be pushed onto already-running threads; priority is only applied on
+    // registration since the portable helpers act on the calling thread
+    if (affinity_changed && config.affinity_mask != 0) {
+        for (const RegisteredThread& thread : registered_threads) {
+            if (thread.role == role)
+                SetThreadAffinity(thread.handle, config.affinity_mask);
+        }
+    }
+}
+
+void RegisterCurrentThread(ThreadRole role, const char* name) {
+    SetCurrentThreadName(name);
+
+    std::lock_guard<std::mutex> lock(topology_mutex);
+
+    const ThreadRoleConfig& config = ConfigFor(role);
+    if (config.affinity_mask != 0)
+        SetCurrentThreadAffinity(config.affinity_mask);
+    if (config.priority != 0)
+        SetCurrentThreadPriority(config.priority);
+
+    registered_threads.push_back({ role, std::this_thread::get_id(), GetCurrentNativeHandle() });
+}
+
+void UnregisterCurrentThread() {
+    std::lock_guard<std::mutex> lock(topology_mutex);
+
+    auto itr = std::find_if(registered_threads.begin(), registered_threads.end(),
+        [](const RegisteredThread& thread) { return thread.id == std::this_thread::get_id(); });
+    if (itr == registered_threads.end())
+        return;
+
+#ifdef _MSC_VER
+    CloseHandle(itr->handle);
+#endif
+    registered_threads.erase(itr);
+}
+
+} // namespace Common
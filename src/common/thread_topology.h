@@ -0,0 +1,52 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Roles under which emulator threads register themselves. Each role can be given its own CPU
+ * affinity mask and priority, so e.g. the emulation thread can own an isolated core while the
+ * pooled workers spread across the remaining ones.
+ */
+enum class ThreadRole {
+    Emu,    ///< Main emulation (CPU/GPU) thread
+    Render, ///< Presentation and other GL-side threads
+    Audio,  ///< Audio output thread
+    Worker, ///< Pooled compute workers (SW rasterizer, shader compiler, ...)
+    IO,     ///< Background IO: pollers, logging, captures
+};
+
+/// Number of entries in ThreadRole, for sizing per-role configuration tables
+const unsigned NUM_THREAD_ROLES = 5;
+
+/// Scheduling configuration for one thread role
+struct ThreadRoleConfig {
+    u32 affinity_mask = 0; ///< CPU affinity mask; 0 leaves thread placement to the OS
+    int priority = 0;      ///< Relative priority in [-2, 2]; positive raises, 0 keeps the default
+};
+
+/**
+ * Sets the configuration for a thread role. The affinity mask is re-applied to threads already
+ * registered under the role, so it can be changed at runtime; priorities only take effect for
+ * threads registered after the call.
+ */
+void SetThreadRoleConfig(ThreadRole role, const ThreadRoleConfig& config);
+
+/**
+ * Registers the calling thread under the given role: sets its debugger-visible name and applies
+ * the role's affinity mask and priority, now and whenever the role is reconfigured. Threads
+ * should call this once at the top of their entry function; registration is undone automatically
+ * when UnregisterCurrentThread is called or can be left to process teardown for threads that
+ * live for the whole session.
+ */
+void RegisterCurrentThread(ThreadRole role, const char* name);
+
+/// Removes the calling thread from the topology registry (affinity/priority are left as-is)
+void UnregisterCurrentThread();
+
+} // namespace Common
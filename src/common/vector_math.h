@@ -34,6 +34,10 @@
 #include <cmath>
 #include <type_traits>
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace Math {
 
 template<typename T> class Vec2;
@@ -559,6 +563,55 @@ static inline Vec3<decltype(T{}*T{}-T{}*T{})> Cross(const Vec3<T>& a, const Vec3
     return MakeVec(a.y*b.z-a.z*b.y, a.z*b.x-a.x*b.z, a.x*b.y-a.y*b.x);
 }
 
+#ifdef ARCHITECTURE_x86_64
+
+// SSE implementations for the float vector types. These are plain (non-template) overloads, so
+// they win overload resolution over the generic templates above while other element types such
+// as float24 keep using the scalar code. Unaligned loads are used throughout: the vector classes
+// are embedded in tightly packed GPU state structures, so imposing 16-byte alignment on them
+// would change those layouts.
+
+/// Loads a Vec3 into the low three lanes of an SSE register without reading past the object
+static inline __m128 LoadVec3(const Vec3<float>& v)
+{
+    __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&v.x)));
+    return _mm_movelh_ps(xy, _mm_load_ss(&v.z));
+}
+
+/// Sums all four lanes of the given register
+static inline float HorizontalSum(__m128 v)
+{
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)); // y x w z
+    __m128 sums = _mm_add_ps(v, shuf);                           // x+y, ., z+w, .
+    return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuf, sums)));
+}
+
+static inline float Dot(const Vec3<float>& a, const Vec3<float>& b)
+{
+    return HorizontalSum(_mm_mul_ps(LoadVec3(a), LoadVec3(b)));
+}
+
+static inline float Dot(const Vec4<float>& a, const Vec4<float>& b)
+{
+    return HorizontalSum(_mm_mul_ps(_mm_loadu_ps(&a.x), _mm_loadu_ps(&b.x)));
+}
+
+static inline Vec3<float> Cross(const Vec3<float>& a, const Vec3<float>& b)
+{
+    __m128 va = LoadVec3(a);
+    __m128 vb = LoadVec3(b);
+    __m128 result = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 0, 2, 1)),
+                   _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 1, 0, 2))),
+        _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 1, 0, 2)),
+                   _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 0, 2, 1))));
+    return Vec3<float>(_mm_cvtss_f32(result),
+                       _mm_cvtss_f32(_mm_shuffle_ps(result, result, _MM_SHUFFLE(1, 1, 1, 1))),
+                       _mm_cvtss_f32(_mm_movehl_ps(result, result)));
+}
+
+#endif // ARCHITECTURE_x86_64
+
 // linear interpolation via float: 0.0=begin, 1.0=end
 template<typename X>
 static inline decltype(X{}*float{}+X{}*float{}) Lerp(const X& begin, const X& end, const float t)
@@ -331,6 +331,11 @@ class XEmitter
     friend struct OpArg;  // for Write8 etc
 private:
     u8 *code;
+    // Added to code addresses when storing bytes, for regions whose writable view lives
+    // at a different address than the executable view (see CodeBlock::AllocCodeSpace).
+    // All address arithmetic (labels, branch distances, returned pointers) stays in
+    // terms of the executable view.
+    ptrdiff_t write_diff;
     bool flags_locked;
 
     void CheckFlags();
@@ -347,7 +352,8 @@ private:
     void WriteSSSE3Op(u8 opPrefix, u16 op, X64Reg regOp, const OpArg& arg, int extrabytes = 0);
     void WriteSSE41Op(u8 opPrefix, u16 op, X64Reg regOp, const OpArg& arg, int extrabytes = 0);
     void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp, const OpArg& arg, int extrabytes = 0);
-    void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int extrabytes = 0);
+    void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int extrabytes = 0, int L = 0);
+    void WriteFMA3Op(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0);
     void WriteVEXOp(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int extrabytes = 0);
     void WriteBMI1Op(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int extrabytes = 0);
     void WriteBMI2Op(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int extrabytes = 0);
@@ -363,14 +369,15 @@ protected:
     void Write64(u64 value);
 
 public:
-    XEmitter() { code = nullptr; flags_locked = false; }
-    XEmitter(u8 *code_ptr) { code = code_ptr; flags_locked = false; }
+    XEmitter() { code = nullptr; write_diff = 0; flags_locked = false; }
+    XEmitter(u8 *code_ptr) { code = code_ptr; write_diff = 0; flags_locked = false; }
     virtual ~XEmitter() {}
 
     void WriteModRM(int mod, int rm, int reg);
     void WriteSIB(int scale, int index, int base);
 
     void SetCodePtr(u8 *ptr);
+    void SetWritableDiff(ptrdiff_t diff);
     void ReserveCodeSpace(int bytes);
     const u8 *AlignCode4();
     const u8 *AlignCode16();
@@ -637,6 +644,8 @@ public:
 
     // SSE/SSE2: Useful alternative to shuffle in some cases.
     void MOVDDUP(X64Reg regOp, const OpArg& arg);
+    void MOVSLDUP(X64Reg regOp, const OpArg& arg); // SSE3; caller must check support
+    void MOVSHDUP(X64Reg regOp, const OpArg& arg); // SSE3; caller must check support
 
     // SSE3: Horizontal operations in SIMD registers. Very slow! shufps-based code beats it handily on Ivy.
     void HADDPS(X64Reg dest, const OpArg& src);
@@ -868,6 +877,12 @@ public:
     void VSUBPD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
     void VMULPD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
     void VDIVPD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+    void VADDPS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+    void VSUBPS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+    void VMULPS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+    void VDIVPS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+    void VCMPPS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg, u8 compare);
+    void VSHUFPS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg, u8 shuffle);
     void VSQRTSD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
     void VSHUFPD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg, u8 shuffle);
     void VUNPCKLPD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
@@ -142,6 +142,23 @@ public:
     /// Prepare core for thread reschedule (if needed to correctly handle state)
     virtual void PrepareReschedule() = 0;
 
+    /**
+     * Pre-translates the code in the given virtual address range so its first execution
+     * doesn't pay for translation. Cores without a translation cache may ignore this.
+     * @param addr Start of the code range
+     * @param size Size of the code range in bytes
+     */
+    virtual void PrepareCodeRegion(u32 addr, u32 size) {}
+
+    /**
+     * Discards translations covering the given virtual address range after its code has
+     * been modified, e.g. by a runtime patch. Only the affected blocks are retranslated;
+     * cores without a translation cache may ignore this.
+     * @param addr Start of the modified range
+     * @param size Size of the modified range in bytes
+     */
+    virtual void InvalidateCodeRange(u32 addr, u32 size) {}
+
     /// Getter for num_instructions
     u64 GetNumInstructions() const {
         return num_instructions;
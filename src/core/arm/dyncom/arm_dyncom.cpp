@@ -5,6 +5,8 @@
 #include <cstring>
 #include <memory>
 
+#include "common/memory_accounting.h"
+
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
@@ -12,15 +14,27 @@
 #include "core/arm/dyncom/arm_dyncom.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
 #include "core/arm/dyncom/arm_dyncom_run.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
 
 #include "core/core.h"
 #include "core/core_timing.h"
 
 ARM_DynCom::ARM_DynCom(PrivilegeMode initial_mode) {
     state = std::make_unique<ARMul_State>(initial_mode);
+
+    // The translation cache arena is shared by both cores; register it once. It is a
+    // fixed-capacity static buffer with its own eviction policy, so it only reports.
+    static bool accounting_registered = false;
+    if (!accounting_registered) {
+        accounting_registered = true;
+        Common::MemoryAccounting::Register(
+            "cpu_translation_cache", [] { return static_cast<u64>(trans_cache_buf_top); },
+            nullptr);
+    }
 }
 
 ARM_DynCom::~ARM_DynCom() {
+    InterpreterDumpHotBlocks();
 }
 
 void ARM_DynCom::SetPC(u32 pc) {
@@ -125,3 +139,11 @@ void ARM_DynCom::LoadContext(const Core::ThreadContext& ctx) {
 void ARM_DynCom::PrepareReschedule() {
     state->NumInstrsToExecute = 0;
 }
+
+void ARM_DynCom::PrepareCodeRegion(u32 addr, u32 size) {
+    InterpreterPreTranslate(state.get(), addr, size);
+}
+
+void ARM_DynCom::InvalidateCodeRange(u32 addr, u32 size) {
+    InterpreterInvalidateCodeRange(state.get(), addr, size);
+}
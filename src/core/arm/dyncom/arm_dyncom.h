@@ -41,6 +41,8 @@ public:
     void LoadContext(const Core::ThreadContext& ctx) override;
 
     void PrepareReschedule() override;
+    void PrepareCodeRegion(u32 addr, u32 size) override;
+    void InvalidateCodeRange(u32 addr, u32 size) override;
     void ExecuteInstructions(int num_instructions) override;
 
 private:
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <vector>
+
 #include "core/arm/dyncom/arm_dyncom_dec.h"
 #include "core/arm/skyeye_common/armsupp.h"
 
@@ -412,59 +414,101 @@ const InstructionSetEncodingItem arm_exclusion_code[] = {
     { "invalid", 0, INVALID,     { 0 }}
 };
 
-ARMDecodeStatus DecodeARMInstruction(u32 instr, s32* idx) {
-    int n = 0;
+// Returns true if arm_instruction[slot] matches instr and is not vetoed by the
+// matching entry of the exclusion table.
+static bool MatchInstruction(u32 instr, int slot) {
+    const InstructionSetEncodingItem& item = arm_instruction[slot];
+
     int base = 0;
-    int instr_slots = sizeof(arm_instruction) / sizeof(InstructionSetEncodingItem);
-    ARMDecodeStatus ret = ARMDecodeStatus::FAILURE;
+    for (int n = item.attribute_value; n > 0; n--) {
+        if (item.content[base + 1] == 31 && item.content[base] == 0) {
+            // clrex
+            if (instr != item.content[base + 2])
+                return false;
+        } else if (BITS(instr, item.content[base], item.content[base + 1]) != item.content[base + 2]) {
+            return false;
+        }
+        base += 3;
+    }
 
-    for (int i = 0; i < instr_slots; i++) {
-        n = arm_instruction[i].attribute_value;
+    const InstructionSetEncodingItem& exclusion = arm_exclusion_code[slot];
+    int n = exclusion.attribute_value;
+    if (n != 0) {
         base = 0;
-
-        // 3DS has no VFP3 support
-        if (arm_instruction[i].version == ARMVFP3)
-            continue;
-
         while (n) {
-            if (arm_instruction[i].content[base + 1] == 31 && arm_instruction[i].content[base] == 0) {
-                // clrex
-                if (instr != arm_instruction[i].content[base + 2]) {
-                    break;
-                }
-            } else if (BITS(instr, arm_instruction[i].content[base], arm_instruction[i].content[base + 1]) != arm_instruction[i].content[base + 2]) {
+            if (BITS(instr, exclusion.content[base], exclusion.content[base + 1]) != exclusion.content[base + 2]) {
                 break;
             }
             base += 3;
             n--;
         }
 
-        // All conditions are satisfied.
+        // All exclusion conditions are satisfied.
         if (n == 0)
-            ret = ARMDecodeStatus::SUCCESS;
+            return false;
+    }
 
-        if (ret == ARMDecodeStatus::SUCCESS) {
-            n = arm_exclusion_code[i].attribute_value;
-            if (n != 0) {
-                base = 0;
-                while (n) {
-                    if (BITS(instr, arm_exclusion_code[i].content[base], arm_exclusion_code[i].content[base + 1]) != arm_exclusion_code[i].content[base + 2]) {
-                        break;
-                    }
-                    base += 3;
-                    n--;
-                }
+    return true;
+}
 
-                // All conditions are satisfied.
-                if (n == 0)
-                    ret = ARMDecodeStatus::FAILURE;
+// First-level dispatch index over the decode table. The 4096 buckets are keyed on
+// instruction bits 27-20 and 7-4 (the bits that distinguish nearly every encoding),
+// so decoding only scans the handful of table entries compatible with those bits
+// instead of the entire table.
+static std::vector<u16> arm_dispatch_index[4096];
+static bool arm_dispatch_index_built = false;
+
+static inline u32 DispatchKeyOf(u32 instr) {
+    return ((instr >> 16) & 0xFF0) | ((instr >> 4) & 0xF);
+}
+
+static void BuildDispatchIndex() {
+    const int instr_slots = sizeof(arm_instruction) / sizeof(InstructionSetEncodingItem);
+
+    for (int i = 0; i < instr_slots; i++) {
+        // 3DS has no VFP3 support
+        if (arm_instruction[i].version == ARMVFP3)
+            continue;
+
+        // Collapse the entry's bit-range constraints into a mask/value pair over the
+        // twelve key bits; constraints outside the key are still checked at decode time.
+        u32 mask = 0;
+        u32 value = 0;
+        int base = 0;
+        for (int n = arm_instruction[i].attribute_value; n > 0; n--) {
+            const u32 lo = arm_instruction[i].content[base];
+            const u32 hi = arm_instruction[i].content[base + 1];
+            const u32 val = arm_instruction[i].content[base + 2];
+            for (u32 bit = lo; bit <= hi; bit++) {
+                if ((bit >= 4 && bit <= 7) || (bit >= 20 && bit <= 27)) {
+                    mask |= 1u << bit;
+                    value |= ((val >> (bit - lo)) & 1) << bit;
+                }
             }
+            base += 3;
+        }
+
+        for (u32 key = 0; key < 4096; key++) {
+            const u32 word = ((key >> 4) << 20) | ((key & 0xF) << 4);
+            if ((word & mask) == value)
+                arm_dispatch_index[key].push_back(static_cast<u16>(i));
         }
+    }
+
+    arm_dispatch_index_built = true;
+}
+
+ARMDecodeStatus DecodeARMInstruction(u32 instr, s32* idx) {
+    if (!arm_dispatch_index_built)
+        BuildDispatchIndex();
 
-        if (ret == ARMDecodeStatus::SUCCESS) {
-            *idx = i;
-            return ret;
+    // Buckets preserve table order, so the first hit is the same entry the
+    // full linear scan would have selected.
+    for (u16 slot : arm_dispatch_index[DispatchKeyOf(instr)]) {
+        if (MatchInstruction(instr, slot)) {
+            *idx = slot;
+            return ARMDecodeStatus::SUCCESS;
         }
     }
-    return ret;
+    return ARMDecodeStatus::FAILURE;
 }
@@ -6,12 +6,15 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <unordered_map>
+#include <vector>
 
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 
 #include "core/memory.h"
+#include "core/settings.h"
 #include "core/hle/svc.h"
 #include "core/arm/disassembler/arm_disasm.h"
 #include "core/arm/dyncom/arm_dyncom_dec.h"
@@ -19,6 +22,9 @@
 #include "core/arm/dyncom/arm_dyncom_thumb.h"
 #include "core/arm/dyncom/arm_dyncom_trans.h"
 #include "core/arm/dyncom/arm_dyncom_run.h"
+#ifdef ARCHITECTURE_x86_64
+#include "core/arm/dyncom/arm_dyncom_jit.h"
+#endif
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
@@ -89,6 +95,20 @@ static unsigned int DPO(Immediate)(ARMul_State* cpu, unsigned int sht_oper) {
     return shifter_operand;
 }
 
+// Counterparts of DPO(Immediate) for operands folded at translation time: sht_oper
+// already holds the rotated value, so only the carry-out remains to be produced. With a
+// non-zero rotation it is the folded value's bit 31; with a zero rotation it passes the
+// C flag through.
+static unsigned int DPO(FoldedImmediate)(ARMul_State* cpu, unsigned int sht_oper) {
+    cpu->shifter_carry_out = BIT(sht_oper, 31);
+    return sht_oper;
+}
+
+static unsigned int DPO(FoldedImmediateNoCarry)(ARMul_State* cpu, unsigned int sht_oper) {
+    cpu->shifter_carry_out = cpu->CFlag;
+    return sht_oper;
+}
+
 static unsigned int DPO(Register)(ARMul_State* cpu, unsigned int sht_oper) {
     unsigned int rm = CHECK_READ_REG15(cpu, RM);
     unsigned int shifter_operand = rm;
@@ -674,6 +694,19 @@ shtop_fp_t GetShifterOp(unsigned int inst) {
     return nullptr;
 }
 
+shtop_fp_t GetShifterOpFolded(unsigned int inst, unsigned int* shifter_operand) {
+    // Immediate operands never depend on registers, so the rotation DPO(Immediate) does
+    // per execution can be folded into the stored operand at translation time
+    if (BIT(inst, 25)) {
+        unsigned int immed_8 = BITS(inst, 0, 7);
+        unsigned int rotate_imm = BITS(inst, 8, 11);
+        *shifter_operand = ROTATE_RIGHT_32(immed_8, rotate_imm * 2);
+        return rotate_imm == 0 ? DPO(FoldedImmediateNoCarry) : DPO(FoldedImmediate);
+    }
+    *shifter_operand = BITS(inst, 0, 11);
+    return GetShifterOp(inst);
+}
+
 get_addr_fp_t GetAddressingOp(unsigned int inst) {
     if (BITS(inst, 24, 27) == 5 && BIT(inst, 21) == 0) {
         return LnSWoUB(ImmediateOffset);
@@ -737,13 +770,34 @@ enum {
     FETCH_FAILURE
 };
 
+// A Thumb instruction expands to its ARM equivalent as a pure function of the 16-bit
+// halfword, so the expansion is memoized in a table indexed by the halfword itself.
+// Retranslating a block after the translation cache is flushed then reuses the cached
+// expansion instead of re-running the bit-level rewrite for every instruction.
+struct ThumbExpansion {
+    u32 arm_instr;
+    u32 inst_size;
+    ThumbDecodeStatus status = ThumbDecodeStatus::UNINITIALIZED;
+};
+static ThumbExpansion thumb_expansion_cache[0x10000];
+
 static ThumbDecodeStatus DecodeThumbInstruction(u32 inst, u32 addr, u32* arm_inst, u32* inst_size, ARM_INST_PTR* ptr_inst_base) {
-    // Check if in Thumb mode
-    ThumbDecodeStatus ret = TranslateThumbInstruction (addr, inst, arm_inst, inst_size);
+    u32 tinstr = GetThumbInstruction(inst, addr);
+
+    ThumbExpansion& cached = thumb_expansion_cache[tinstr & 0xFFFF];
+    if (cached.status == ThumbDecodeStatus::UNINITIALIZED) {
+        cached.arm_instr = 0;
+        cached.inst_size = 4;
+        cached.status = TranslateThumbInstruction(addr, inst, &cached.arm_instr, &cached.inst_size);
+    }
+
+    ThumbDecodeStatus ret = cached.status;
+    *arm_inst = cached.arm_instr;
+    *inst_size = cached.inst_size;
+
     if (ret == ThumbDecodeStatus::BRANCH) {
         int inst_index;
         int table_length = arm_instruction_trans_len;
-        u32 tinstr = GetThumbInstruction(inst, addr);
 
         switch ((tinstr & 0xF800) >> 11) {
         case 26:
@@ -790,9 +844,102 @@ enum {
     FETCH_EXCEPTION
 };
 
+// Optional hot-block profile (Debugging::profile_hot_blocks): number of times each
+// translated block has been dispatched, keyed on its start PC with the Thumb state in
+// the low bit. Summarized by InterpreterDumpHotBlocks() when the core shuts down.
+static std::unordered_map<u32, u64> hot_block_counts;
+
+void InterpreterDumpHotBlocks() {
+    if (hot_block_counts.empty())
+        return;
+
+    u64 total_dispatches = 0;
+    for (const auto& entry : hot_block_counts)
+        total_dispatches += entry.second;
+
+    std::vector<std::pair<u32, u64>> blocks(hot_block_counts.begin(), hot_block_counts.end());
+    const size_t top_n = std::min<size_t>(blocks.size(), 20);
+    std::partial_sort(blocks.begin(), blocks.begin() + top_n, blocks.end(),
+                      [](const std::pair<u32, u64>& lhs, const std::pair<u32, u64>& rhs) {
+                          return lhs.second > rhs.second;
+                      });
+
+    LOG_INFO(Core_ARM11, "Hottest translated blocks (%llu dispatches over %zu blocks):",
+             (unsigned long long)total_dispatches, blocks.size());
+    for (size_t i = 0; i < top_n; i++) {
+        const u32 pc = blocks[i].first & ~1u;
+        const bool thumb = (blocks[i].first & 1) != 0;
+        LOG_INFO(Core_ARM11, "#%2zu: 0x%08X%s %llu dispatches (%.2f%%)", i + 1, pc,
+                 thumb ? " (thumb)" : "", (unsigned long long)blocks[i].second,
+                 blocks[i].second * 100.0 / total_dispatches);
+
+        // Disassemble the leading instructions of ARM blocks, stopping at the branch
+        // that terminates the block.
+        if (thumb)
+            continue;
+        for (u32 addr = pc; addr < pc + 8 * 4; addr += 4) {
+            if (!Memory::IsValidVirtualAddress(addr))
+                break;
+            const u32 inst = Memory::Read32(addr);
+            LOG_INFO(Core_ARM11, "      %s", ARM_Disasm::Disassemble(addr, inst).c_str());
+            if ((inst & 0x0E000000) == 0x0A000000)
+                break;
+        }
+    }
+}
+
 MICROPROFILE_DEFINE(DynCom_Decode, "DynCom", "Decode", MP_RGB(255, 64, 64));
 
-static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, const u32 phys_addr, ARM_INST_PTR& inst_base) {
+/**
+ * Approximate cost in cycles of one ARM instruction, for the accurate cycle tier. The
+ * figures are rough ARM11 issue latencies per instruction class; the goal is the relative
+ * weight of multiplies, memory accesses and coprocessor traffic against single-cycle data
+ * processing, not cycle exactness (no pipeline, forwarding or memory system model).
+ */
+static unsigned int CyclesForARMInstruction(u32 inst) {
+    // Data processing / multiply / misc (group 00)
+    if ((inst & 0x0C000000) == 0x00000000) {
+        if ((inst & 0x90) == 0x90) {
+            if ((inst & 0x0FC000F0) == 0x00000090) // MUL/MLA
+                return 2;
+            if ((inst & 0x0F8000F0) == 0x00800090) // [SU]MULL/[SU]MLAL
+                return 3;
+            if ((inst & 0x0FB00FF0) == 0x01000090) // SWP/SWPB
+                return 4;
+            return 2; // halfword/doubleword transfers, exclusives
+        }
+        if ((inst & 0x0FF000D0) == 0x01200010) // BX/BLX (register): pipeline refill
+            return 3;
+        return 1;
+    }
+    // Single data transfer / media (group 01)
+    if ((inst & 0x0C000000) == 0x04000000)
+        return (inst & (1 << 20)) != 0 ? 2 : 1;
+    // Block data transfer: about one cycle per transferred register
+    if ((inst & 0x0E000000) == 0x08000000) {
+        unsigned int n = 0;
+        for (u32 list = inst & 0xFFFF; list != 0; list &= list - 1)
+            n++;
+        return 1 + n;
+    }
+    // B/BL: pipeline refill
+    if ((inst & 0x0E000000) == 0x0A000000)
+        return 3;
+    // SWI
+    if ((inst & 0x0F000000) == 0x0F000000)
+        return 3;
+    // LDC/STC/MCRR/MRRC
+    if ((inst & 0x0E000000) == 0x0C000000)
+        return 2;
+    // CDP/MCR/MRC, which is where all the VFP arithmetic lives
+    if ((inst & 0x0F000000) == 0x0E000000)
+        return (inst & 0x10) != 0 ? 2 : 4;
+
+    return 1;
+}
+
+static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, const u32 phys_addr, ARM_INST_PTR& inst_base,
+                                                    unsigned int* extra_cycles = nullptr) {
     unsigned int inst_size = 4;
     unsigned int inst = Memory::Read32(phys_addr & 0xFFFFFFFC);
 
@@ -803,6 +950,8 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
 
         // We have translated the Thumb branch instruction in the Thumb decoder
         if (state == ThumbDecodeStatus::BRANCH) {
+            if (extra_cycles != nullptr)
+                *extra_cycles += 2; // pipeline refill, as for the ARM branches below
             return inst_size;
         }
         inst = arm_inst;
@@ -815,12 +964,249 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
         LOG_ERROR(Core_ARM11, "cpsr=0x%x, cpu->TFlag=%d, r15=0x%x", cpu->Cpsr, cpu->TFlag, cpu->Reg[15]);
         CITRA_IGNORE_EXIT(-1);
     }
+    // Thumb instructions have been rewritten to their ARM equivalent at this point, so
+    // the ARM cost table applies to both instruction sets.
+    if (extra_cycles != nullptr)
+        *extra_cycles += CyclesForARMInstruction(inst) - 1;
     inst_base = arm_instruction_trans[idx](inst, idx);
 
     return inst_size;
 }
 
-static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr) {
+/**
+ * Whether an ARM instruction is free of side effects beyond its own registers and memory
+ * loads, making it safe inside a skippable idle loop. Covers data-processing ops,
+ * multiplies and loads; stores, swaps, exclusive accesses, coprocessor transfers and
+ * everything else disqualify the loop.
+ */
+static bool IsIdleLoopInstruction(u32 inst) {
+    // Data processing / multiply / misc (group 00)
+    if ((inst & 0x0C000000) == 0x00000000) {
+        // "Extra" encodings with bits 7 and 4 set: only plain multiplies are safe, the
+        // rest are halfword/doubleword transfers, swaps and exclusive accesses.
+        if ((inst & 0x90) == 0x90) {
+            const bool is_mul = (inst & 0x0FC000F0) == 0x00000090;  // MUL/MLA
+            const bool is_mull = (inst & 0x0F8000F0) == 0x00800090; // [SU]MULL/[SU]MLAL
+            return is_mul || is_mull;
+        }
+        return true;
+    }
+    // Single data transfer / media (group 01): loads only, no stores
+    if ((inst & 0x0C000000) == 0x04000000)
+        return (inst & (1 << 20)) != 0;
+
+    return false;
+}
+
+/**
+ * Number of consecutive ARM instructions starting at phys_addr that share one non-AL,
+ * non-NV condition code and can be guarded as a unit. Branches end a run without joining
+ * it: their handlers link the not-taken successor block, which the guard's skip path
+ * would bypass. Runs never cross a page boundary since translation ends blocks there.
+ */
+static int CountConditionalRun(u32 phys_addr) {
+    static const int MAX_COND_RUN = 32;
+
+    const u32 first = Memory::Read32(phys_addr & 0xFFFFFFFC);
+    const u32 cond = first >> 28;
+    if (cond == 0xE || cond == 0xF || (first & 0x0E000000) == 0x0A000000)
+        return 0;
+
+    int count = 1;
+    while (count < MAX_COND_RUN && ((phys_addr + count * 4) & 0xfff) != 0) {
+        const u32 inst = Memory::Read32((phys_addr + count * 4) & 0xFFFFFFFC);
+        if ((inst >> 28) != cond || (inst & 0x0E000000) == 0x0A000000)
+            break;
+        count++;
+    }
+    return count;
+}
+
+// Flag bit masks for the dead-flag scan
+enum : unsigned int {
+    FLAG_N = 1 << 0,
+    FLAG_Z = 1 << 1,
+    FLAG_C = 1 << 2,
+    FLAG_V = 1 << 3,
+    FLAG_NZCV = FLAG_N | FLAG_Z | FLAG_C | FLAG_V,
+};
+
+/**
+ * Conservative NZCV read/write sets of one raw ARM instruction, for the dead-flag scan.
+ * Returns false when the instruction cannot be classified or may leave the block, in
+ * which case the scan must assume every flag is read.
+ */
+static bool GetFlagUsage(u32 inst, unsigned int* reads, unsigned int* writes) {
+    *reads = 0;
+    *writes = 0;
+
+    // Conditional execution reads the flags
+    if ((inst >> 28) != 0xE) {
+        *reads = FLAG_NZCV;
+        return true;
+    }
+
+    // Data processing / multiply / misc (group 00)
+    if ((inst & 0x0C000000) == 0x00000000) {
+        if ((inst & 0x02000090) == 0x90) {
+            // Multiplies set NZ when their S bit is set; the rest of the "extra"
+            // encodings (halfword/doubleword transfers, swaps, exclusives) are flag-free
+            if (((inst & 0x0FC000F0) == 0x00000090 || (inst & 0x0F8000F0) == 0x00800090) &&
+                BIT(inst, 20))
+                *writes = FLAG_N | FLAG_Z;
+            return true;
+        }
+
+        const unsigned int opcode = BITS(inst, 21, 24);
+        const bool S = BIT(inst, 20) != 0;
+
+        // The compare encodings with S clear are the misc space: MRS reads the flags,
+        // MSR with the f field overwrites them, and the rest (BX, CLZ, saturating
+        // arithmetic, BKPT, ...) either leave the block or defy cheap classification
+        if (!S && opcode >= 0x8 && opcode <= 0xB) {
+            if ((inst & 0x0FB00000) == 0x01000000) { // MRS
+                *reads = FLAG_NZCV;
+                return true;
+            }
+            if ((inst & 0x0DB00000) == 0x01200000) { // MSR
+                if (BIT(inst, 19))
+                    *writes = FLAG_NZCV;
+                return true;
+            }
+            return false;
+        }
+
+        // A data-processing destination of PC leaves the block
+        if (opcode < 0x8 || opcode > 0xB) {
+            if (BITS(inst, 12, 15) == 15)
+                return false;
+        }
+
+        // ADC/SBC/RSC consume the carry, as does RRX through its operand value
+        if (opcode >= 0x5 && opcode <= 0x7)
+            *reads |= FLAG_C;
+        if (BIT(inst, 25) == 0 && BITS(inst, 4, 11) == 0x06)
+            *reads |= FLAG_C;
+
+        if (S) {
+            const bool logical = opcode <= 0x1 || (opcode >= 0x8 && opcode <= 0x9) ||
+                                 opcode >= 0xC;
+            if (logical) {
+                // Logical S ops take C from the shifter carry-out, which passes the C
+                // flag through for register operands, register-specified shifts and
+                // zero-rotation immediates; only a known non-trivial immediate shift
+                // provably does not read it
+                const bool imm_shift_reads_c =
+                    BIT(inst, 25) ? BITS(inst, 8, 11) == 0
+                                  : (BIT(inst, 4) || BITS(inst, 4, 11) == 0);
+                if (imm_shift_reads_c)
+                    *reads |= FLAG_C;
+                *writes |= FLAG_N | FLAG_Z | FLAG_C;
+            } else {
+                *writes |= FLAG_NZCV;
+            }
+        }
+        return true;
+    }
+
+    // Single data transfer (group 01): flag-free unless it loads the PC; the media
+    // space (bit 4 set alongside) is left unclassified
+    if ((inst & 0x0C000000) == 0x04000000) {
+        if ((inst & 0x0E000010) == 0x06000010)
+            return false;
+        if (BIT(inst, 20) && BITS(inst, 12, 15) == 15)
+            return false;
+        return true;
+    }
+
+    // Block data transfer: flag-free, unless it loads the PC or restores the CPSR
+    if ((inst & 0x0E000000) == 0x08000000) {
+        if (BIT(inst, 20) && (BIT(inst, 15) || BIT(inst, 22)))
+            return false;
+        return true;
+    }
+
+    // MRC with Rt=15 copies the coprocessor condition flags into the CPSR (e.g. VMRS
+    // APSR_nzcv after a VFP compare); other coprocessor traffic is flag-free
+    if ((inst & 0x0F000010) == 0x0E000010) {
+        if (BIT(inst, 20) && BITS(inst, 12, 15) == 15)
+            *writes = FLAG_NZCV;
+        return true;
+    }
+    if ((inst & 0x0F000010) == 0x0E000000) // CDP
+        return true;
+    if ((inst & 0x0E000000) == 0x0C000000) // LDC/STC/MCRR/MRRC
+        return true;
+
+    // Branches, SWI and anything unrecognized end the scan
+    return false;
+}
+
+/// Instruction limit of the dead-flag scan below. A block's translation depends on up to
+/// this many instructions past its own end, so invalidation must reach that far too.
+static const int MAX_DEAD_FLAG_SCAN = 32;
+
+/**
+ * Whether the flags in live written by the instruction at addr are all provably
+ * overwritten before anything can read them. Conservative: reaching the end of the scan
+ * window counts as a read, since the next block may consume the flags.
+ */
+static bool FlagWritesAreDead(u32 addr, unsigned int live) {
+
+    for (int i = 1; i <= MAX_DEAD_FLAG_SCAN && ((addr + i * 4) & 0xfff) != 0; i++) {
+        const u32 inst = Memory::Read32((addr + i * 4) & 0xFFFFFFFC);
+        unsigned int reads;
+        unsigned int writes;
+        if (!GetFlagUsage(inst, &reads, &writes))
+            return false;
+        if ((reads & live) != 0)
+            return false;
+        live &= ~writes;
+        if (live == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Clears the S bit of a freshly translated data-processing instruction whose flag
+ * results are provably dead, so its handler skips the flag code on every execution.
+ * Compares are excluded since the flags are their only effect, and Rd=15 is excluded
+ * because there the S bit selects an SPSR restore rather than a flag update.
+ */
+static void TryEliminateDeadFlags(u32 inst, u32 addr, arm_inst* inst_base) {
+    if ((inst >> 28) != 0xE || (inst & 0x0C000000) != 0 || BIT(inst, 20) == 0)
+        return;
+    if (BIT(inst, 25) == 0 && (inst & 0x90) == 0x90)
+        return;
+    const unsigned int opcode = BITS(inst, 21, 24);
+    if (opcode >= 0x8 && opcode <= 0xB)
+        return;
+    if (BITS(inst, 12, 15) == 15)
+        return;
+
+    // Logical ops write NZC (C through the shifter), arithmetic ops write all of NZCV
+    const bool logical = opcode <= 0x1 || opcode >= 0xC;
+    if (!FlagWritesAreDead(addr, logical ? (FLAG_N | FLAG_Z | FLAG_C) : FLAG_NZCV))
+        return;
+
+    switch (opcode) {
+    case 0x0: ((and_inst*)inst_base->component)->S = 0; break;
+    case 0x1: ((eor_inst*)inst_base->component)->S = 0; break;
+    case 0x2: ((sub_inst*)inst_base->component)->S = 0; break;
+    case 0x3: ((rsb_inst*)inst_base->component)->S = 0; break;
+    case 0x4: ((add_inst*)inst_base->component)->S = 0; break;
+    case 0x5: ((adc_inst*)inst_base->component)->S = 0; break;
+    case 0x6: ((sbc_inst*)inst_base->component)->S = 0; break;
+    case 0x7: ((rsc_inst*)inst_base->component)->S = 0; break;
+    case 0xC: ((orr_inst*)inst_base->component)->S = 0; break;
+    case 0xD: ((mov_inst*)inst_base->component)->S = 0; break;
+    case 0xE: ((bic_inst*)inst_base->component)->S = 0; break;
+    case 0xF: ((mvn_inst*)inst_base->component)->S = 0; break;
+    }
+}
+
+static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr, u32* out_end_addr = nullptr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     // Decode instruction, get index
@@ -830,13 +1216,54 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr)
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
     int size = 0; // instruction size of basic block
+
+    TransCacheEnsureSpace();
     bb_start = trans_cache_buf_top;
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
 
+    // Number of instructions an idle loop may span, branch included.
+    static const int MAX_IDLE_LOOP_SIZE = 8;
+    bool idle_loop_safe = !cpu->TFlag;
+
+    // Pending condition guard, sized once the run behind it has actually been translated
+    cond_guard_inst* guard = nullptr;
+    size_t guard_run_start = 0;
+    int guard_remaining = 0;
+
+    // Every block starts with a ticks header, so the no-debug dispatch loop can charge
+    // the block's whole instruction count (plus the accurate tier's per-class surcharge,
+    // accumulated below) in one step at block entry.
+    block_cycles_inst* cycles_header =
+        (block_cycles_inst*)InterpreterTranslateBlockCycles()->component;
+    unsigned int extra_cycles = 0;
+    const bool accurate_cycles = Settings::values.accurate_cpu_timing;
+
     while (ret == TransExtData::NON_BRANCH) {
-        unsigned int inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+        if (idle_loop_safe) {
+            const u32 raw_inst = Memory::Read32(phys_addr & 0xFFFFFFFC);
+            // The terminating branch itself is checked below; everything before it must
+            // be side-effect free for the block to qualify as an idle loop.
+            if ((raw_inst & 0x0E000000) != 0x0A000000 && !IsIdleLoopInstruction(raw_inst))
+                idle_loop_safe = false;
+        }
+
+        // Runs of two or more consecutive instructions under one condition get a
+        // block-level guard in front of them, so a failed condition costs a single
+        // check instead of one per instruction.
+        if (!cpu->TFlag && guard == nullptr) {
+            const int run_length = CountConditionalRun(phys_addr);
+            if (run_length >= 2) {
+                const u32 cond = Memory::Read32(phys_addr & 0xFFFFFFFC) >> 28;
+                guard = (cond_guard_inst*)InterpreterTranslateCondGuard(cond)->component;
+                guard_run_start = trans_cache_buf_top;
+                guard_remaining = run_length;
+            }
+        }
+
+        unsigned int inst_size = InterpreterTranslateInstruction(
+            cpu, phys_addr, inst_base, accurate_cycles ? &extra_cycles : nullptr);
 
         size++;
 
@@ -846,29 +1273,137 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr)
             inst_base->br = TransExtData::END_OF_PAGE;
         }
         ret = inst_base->br;
+
+        if (!cpu->TFlag)
+            TryEliminateDeadFlags(Memory::Read32((phys_addr - inst_size) & 0xFFFFFFFC),
+                                  phys_addr - inst_size, inst_base);
+
+        if (guard != nullptr) {
+            guard->count++;
+            // An instruction the scan could not predict may still end the block (e.g. a
+            // data-processing op writing PC), so the guard is sized from what was
+            // actually translated rather than from the scan.
+            if (--guard_remaining == 0 || ret != TransExtData::NON_BRANCH) {
+                guard->skip_bytes =
+                    static_cast<unsigned int>(trans_cache_buf_top - guard_run_start);
+                guard->end_of_block = (ret != TransExtData::NON_BRANCH) ? 1 : 0;
+                guard = nullptr;
+            }
+        }
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cycles_header->ticks = static_cast<unsigned int>(size) + extra_cycles;
+    cycles_header->extra_cycles = extra_cycles;
+
+    // A short, side-effect-free ARM block whose terminating branch jumps back to its own
+    // start is an idle loop: executing it again can only re-read the same memory until an
+    // external event changes it, so taking the branch may consume the rest of the slice.
+    if (idle_loop_safe && size <= MAX_IDLE_LOOP_SIZE && ret == TransExtData::DIRECT_BRANCH) {
+        bbl_inst* branch = (bbl_inst*)inst_base->component;
+        const u32 branch_pc = pc_start + (size - 1) * 4;
+        if (branch->L == 0 && branch_pc + 8 + branch->signed_immed_24 == pc_start)
+            branch->idle_loop = 1;
+    }
+
+    cpu->instruction_cache[pc_start] = {bb_start, TransCacheGenerationOf(bb_start), phys_addr};
+    Memory::MarkRegionAsCode(pc_start, phys_addr - pc_start);
+
+    if (out_end_addr != nullptr)
+        *out_end_addr = phys_addr;
 
     return KEEP_GOING;
 }
 
+/// True if the block's header has been poisoned by a code patch; see the chain check below
+static bool BlockInvalidated(int ptr) {
+    arm_inst* header = (arm_inst*)&trans_cache_buf[ptr];
+    return header->idx == BLOCK_CYCLES_INST_INDEX &&
+           ((block_cycles_inst*)header->component)->invalidated != 0;
+}
+
+void InterpreterInvalidateCodeRange(ARMul_State* cpu, u32 start_addr, u32 size) {
+    const u32 end_addr = start_addr + size;
+    for (auto itr = cpu->instruction_cache.begin(); itr != cpu->instruction_cache.end();) {
+        // The dead-flag scan reads up to MAX_DEAD_FLAG_SCAN instructions past a block's
+        // last instruction, so cleared S bits can depend on bytes beyond guest_end; a
+        // write just past the block must drop it too, hence the widened reach.
+        if (itr->first < end_addr &&
+            itr->second.guest_end + MAX_DEAD_FLAG_SCAN * 4 > start_addr) {
+            // Chained branches jump straight to the block without consulting the map, so
+            // the block's header is poisoned too: the chain check treats a poisoned target
+            // as a broken link, severs it, and retranslates through the map.
+            if (itr->second.generation == TransCacheGenerationOf(itr->second.ptr)) {
+                arm_inst* header = (arm_inst*)&trans_cache_buf[itr->second.ptr];
+                if (header->idx == BLOCK_CYCLES_INST_INDEX)
+                    ((block_cycles_inst*)header->component)->invalidated = 1;
+            }
+            itr = cpu->instruction_cache.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+
+#ifdef ARCHITECTURE_x86_64
+    Jit::InvalidateRange(start_addr, size);
+#endif
+}
+
+void InterpreterPreTranslate(ARMul_State* cpu, u32 start_addr, u32 size) {
+    // Translation keys the instruction cache on Reg[15] and reads the Thumb flag, so both
+    // are staged for the walk and restored afterwards. Entry points are ARM mode.
+    const u32 saved_pc = cpu->Reg[15];
+    const u32 saved_tflag = cpu->TFlag;
+    cpu->TFlag = 0;
+
+    u32 addr = start_addr & 0xFFFFFFFC;
+    const u32 end_addr = start_addr + size;
+    while (addr < end_addr) {
+        auto cached = cpu->instruction_cache.find(addr);
+        if (cached != cpu->instruction_cache.end()) {
+            // Already translated; resume the walk past the cached block
+            addr = std::max(cached->second.guest_end & 0xFFFFFFFC, addr + 4);
+            continue;
+        }
+
+        cpu->Reg[15] = addr;
+        int bb_start;
+        u32 block_end = addr + 4;
+        if (InterpreterTranslateBlock(cpu, bb_start, addr, &block_end) == FETCH_EXCEPTION)
+            break;
+        addr = std::max(block_end, addr + 4);
+    }
+
+    cpu->Reg[15] = saved_pc;
+    cpu->TFlag = saved_tflag;
+}
+
 static int InterpreterTranslateSingle(ARMul_State* cpu, int& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     ARM_INST_PTR inst_base = nullptr;
+
+    TransCacheEnsureSpace();
     bb_start = trans_cache_buf_top;
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
 
-    InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+    // Single-instruction translations land in the same instruction cache as blocks and
+    // may later be dispatched by the block-granular fast path, so they need a ticks
+    // header too (flat cost; the accurate tier's surcharge is skipped while stepping)
+    block_cycles_inst* cycles_header =
+        (block_cycles_inst*)InterpreterTranslateBlockCycles()->component;
+    cycles_header->ticks = 1;
+
+    unsigned int inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
 
     if (inst_base->br == TransExtData::NON_BRANCH) {
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache[pc_start] =
+        {bb_start, TransCacheGenerationOf(bb_start), pc_start + inst_size};
+    Memory::MarkRegionAsCode(pc_start, inst_size);
 
     return KEEP_GOING;
 }
@@ -919,7 +1454,7 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 #define GDB_BP_CHECK \
     cpu->Cpsr &= ~(1 << 5); \
     cpu->Cpsr |= cpu->TFlag << 5; \
-    if (GDBStub::g_server_enabled) { \
+    if (GDBStub::IsServerEnabled()) { \
         if (GDBStub::IsMemoryBreak() || (breakpoint_data.type != GDBStub::BreakpointType::None && PC == breakpoint_data.address)) { \
             GDBStub::Break(); \
             goto END; \
@@ -928,17 +1463,25 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 
 // GCC and Clang have a C++ extension to support a lookup table of labels. Otherwise, fallback to a
 // clunky switch statement.
+// In the common no-debug case blocks are charged as a whole by their ticks header and the
+// remaining slice is only checked once per block at DISPATCH, so retiring an instruction
+// is just the indirect jump. The per-instruction path (breakpoint check, slice check and
+// count) only activates under gdbstub control or while single-stepping.
 #if defined __GNUC__ || defined __clang__
 #define GOTO_NEXT_INST \
-    GDB_BP_CHECK; \
-    if (num_instrs >= cpu->NumInstrsToExecute) goto END; \
-    num_instrs++; \
+    if (per_inst_step) { \
+        GDB_BP_CHECK; \
+        if (num_instrs >= cpu->NumInstrsToExecute) goto END; \
+        num_instrs++; \
+    } \
     goto *InstLabel[inst_base->idx]
 #else
 #define GOTO_NEXT_INST \
-    GDB_BP_CHECK; \
-    if (num_instrs >= cpu->NumInstrsToExecute) goto END; \
-    num_instrs++; \
+    if (per_inst_step) { \
+        GDB_BP_CHECK; \
+        if (num_instrs >= cpu->NumInstrsToExecute) goto END; \
+        num_instrs++; \
+    } \
     switch(inst_base->idx) { \
     case 0: goto VMLA_INST; \
     case 1: goto VMLS_INST; \
@@ -1145,6 +1688,8 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     case 202: goto DISPATCH; \
     case 203: goto INIT_INST_LENGTH; \
     case 204: goto END; \
+    case 205: goto COND_GUARD_INST; \
+    case 206: goto BLOCK_CYCLES_INST; \
     }
 #endif
 
@@ -1194,18 +1739,32 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
         &&LDRB_INST,&&STRB_INST,&&LDR_INST,&&LDRCOND_INST, &&STR_INST,&&CDP_INST,&&STC_INST,&&LDC_INST, &&LDREXD_INST,
         &&STREXD_INST,&&LDREXH_INST,&&STREXH_INST, &&NOP_INST, &&YIELD_INST, &&WFE_INST, &&WFI_INST, &&SEV_INST, &&SWI_INST,&&BBL_INST,
         &&B_2_THUMB, &&B_COND_THUMB,&&BL_1_THUMB, &&BL_2_THUMB, &&BLX_1_THUMB, &&DISPATCH,
-        &&INIT_INST_LENGTH,&&END
+        &&INIT_INST_LENGTH,&&END, &&COND_GUARD_INST, &&BLOCK_CYCLES_INST
         };
 #endif
     arm_inst* inst_base;
     unsigned int addr;
     unsigned int num_instrs = 0;
 
+    // Whether stepping must be tracked per instruction rather than per block: the gdbstub
+    // needs its breakpoint check on every dispatch, and a one-instruction slice must stop
+    // in the middle of whatever block it lands in.
+    const bool per_inst_step = GDBStub::IsServerEnabled() || cpu->NumInstrsToExecute == 1;
+
     int ptr;
 
+    // Points at the successor slot of the static branch that was just taken, if any.
+    // Used to link basic blocks together so hot paths bypass the translation map.
+    BlockLink* chain_slot = nullptr;
+
     LOAD_NZCVT;
     DISPATCH:
     {
+        // Block-granular slice check: every control transfer funnels through here, so in
+        // the no-debug case this is the only place the remaining slice is tested.
+        if (num_instrs >= cpu->NumInstrsToExecute)
+            goto END;
+
         if (!cpu->NirqSig) {
             if (!(cpu->Cpsr & 0x80)) {
                 goto END;
@@ -1217,20 +1776,77 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
         else
             cpu->Reg[15] &= 0xfffffffc;
 
+        // Every block entry passes through here, including linked branches, so this one
+        // counter covers all dispatch paths. Thumb entries are tagged in the low bit.
+        if (Settings::values.profile_hot_blocks)
+            ++hot_block_counts[cpu->Reg[15] | (cpu->TFlag ? 1 : 0)];
+
+        // If the branch just executed has already been linked to its successor, skip the
+        // translation map lookup entirely. Single-stepping must not use (or create) links,
+        // since those translations end after one instruction.
+        int chain_slot_offset = 0;
+        unsigned chain_slot_home_generation = 0;
+        if (chain_slot != nullptr) {
+            if (cpu->NumInstrsToExecute == 1) {
+                chain_slot = nullptr;
+            } else if (chain_slot->ptr != TRANS_CACHE_NO_LINK &&
+                       chain_slot->generation == TransCacheGenerationOf(chain_slot->ptr) &&
+                       !BlockInvalidated(chain_slot->ptr)) {
+                ptr = chain_slot->ptr;
+                chain_slot = nullptr;
+                goto LOOKUP_DONE;
+            } else {
+                // The link will be filled in after translation below; note which generation
+                // the slot's own block lives in, since translating may evict it.
+                chain_slot_offset =
+                    static_cast<int>(reinterpret_cast<char*>(chain_slot) - trans_cache_buf);
+                chain_slot_home_generation = TransCacheGenerationOf(chain_slot_offset);
+            }
+        }
+
+#ifdef ARCHITECTURE_x86_64
+        // Blocks of unconditional ARM code may have been compiled to native code; breakpoints and
+        // single-stepping bypass the JIT so that execution still breaks on instruction dispatch.
+        // The accurate cycle tier does too, so that every block is costed by the same model.
+        if (Settings::values.use_cpu_jit && !cpu->TFlag && cpu->NumInstrsToExecute != 1 &&
+            !Settings::values.accurate_cpu_timing && !GDBStub::IsServerEnabled()) {
+            unsigned jitted_instrs = Jit::TryRunBlock(cpu);
+            if (jitted_instrs > 0) {
+                chain_slot = nullptr;
+                num_instrs += jitted_instrs;
+                if (num_instrs >= cpu->NumInstrsToExecute)
+                    goto END;
+                goto DISPATCH;
+            }
+        }
+#endif
+
         // Find the cached instruction cream, otherwise translate it...
-        auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-        if (itr != cpu->instruction_cache.end()) {
-            ptr = itr->second;
-        } else if (cpu->NumInstrsToExecute != 1) {
-            if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-                goto END;
-        } else {
-            if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-                goto END;
+        {
+            auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
+            if (itr != cpu->instruction_cache.end() &&
+                itr->second.generation == TransCacheGenerationOf(itr->second.ptr)) {
+                ptr = itr->second.ptr;
+            } else if (cpu->NumInstrsToExecute != 1) {
+                if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            } else {
+                if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            }
+        }
+
+        // Remember where this branch's successor lives, to skip the lookup next time.
+        // Skipped if the slot's own block was evicted while translating the successor.
+        if (chain_slot != nullptr) {
+            if (TransCacheGenerationOf(chain_slot_offset) == chain_slot_home_generation)
+                *chain_slot = {ptr, TransCacheGenerationOf(ptr)};
+            chain_slot = nullptr;
         }
 
+    LOOKUP_DONE:
         // Find breakpoint if one exists within the block
-        if (GDBStub::g_server_enabled && GDBStub::IsConnected()) {
+        if (GDBStub::IsServerEnabled() && GDBStub::IsConnected()) {
             breakpoint_data = GDBStub::GetNextBreakpointFromAddress(cpu->Reg[15], GDBStub::BreakpointType::Execute);
         }
 
@@ -1246,9 +1862,13 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
             if (inst_cream->Rn == 15)
                 rn_val += 2 * cpu->GetInstructionSize();
 
+            // Only compute carry/overflow when the S bit will consume them; with a
+            // null pointer the inlined AddWithCarry reduces to the bare addition.
+            const bool update_flags = inst_cream->S != 0;
             bool carry;
             bool overflow;
-            RD = AddWithCarry(rn_val, SHIFTER_OPERAND, cpu->CFlag, &carry, &overflow);
+            RD = AddWithCarry(rn_val, SHIFTER_OPERAND, cpu->CFlag,
+                              update_flags ? &carry : nullptr, update_flags ? &overflow : nullptr);
 
             if (inst_cream->S && (inst_cream->Rd == 15)) {
                 if (CurrentModeHasSPSR) {
@@ -1279,9 +1899,11 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 
             u32 rn_val = CHECK_READ_REG15_WA(cpu, inst_cream->Rn);
 
+            const bool update_flags = inst_cream->S != 0;
             bool carry;
             bool overflow;
-            RD = AddWithCarry(rn_val, SHIFTER_OPERAND, 0, &carry, &overflow);
+            RD = AddWithCarry(rn_val, SHIFTER_OPERAND, 0,
+                              update_flags ? &carry : nullptr, update_flags ? &overflow : nullptr);
 
             if (inst_cream->S && (inst_cream->Rd == 15)) {
                 if (CurrentModeHasSPSR) {
@@ -1341,19 +1963,73 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     }
     BBL_INST:
     {
+        bbl_inst *inst_cream = (bbl_inst *)inst_base->component;
         if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
-            bbl_inst *inst_cream = (bbl_inst *)inst_base->component;
             if (inst_cream->L) {
                 LINK_RTN_ADDR;
             }
             SET_PC;
             INC_PC(sizeof(bbl_inst));
+            if (inst_cream->idle_loop && !GDBStub::IsServerEnabled()) {
+                // Spinning on this loop cannot change state until the next event fires;
+                // report the rest of the slice as executed so core timing advances to it.
+                num_instrs = cpu->NumInstrsToExecute;
+                goto END;
+            }
+            chain_slot = &inst_cream->bb_taken;
             goto DISPATCH;
         }
         cpu->Reg[15] += cpu->GetInstructionSize();
         INC_PC(sizeof(bbl_inst));
+        chain_slot = &inst_cream->bb_not_taken;
         goto DISPATCH;
     }
+    COND_GUARD_INST:
+    {
+        cond_guard_inst* inst_cream = (cond_guard_inst*)inst_base->component;
+        // With the GDB stub active the run must retire instruction by instruction so
+        // breakpoints inside it are still honored.
+        if (GDBStub::IsServerEnabled() || CondPassed(cpu, inst_base->cond)) {
+            // Fall through into the run; each covered instruction still performs its own
+            // condition check, so flag writes inside the run are honored. The guard is
+            // not an architectural instruction, so its dispatch tick is given back.
+            if (per_inst_step)
+                num_instrs--;
+            INC_PC(sizeof(cond_guard_inst));
+            FETCH_INST;
+            GOTO_NEXT_INST;
+        }
+        // The condition failed: since none of the covered instructions can execute (and
+        // skipped instructions cannot change the flags), jump over the whole run. Each
+        // skipped instruction still counts as retired, exactly as the per-instruction
+        // condition failures it replaces would have (the block header has already
+        // charged them on the block-granular path).
+        cpu->Reg[15] += inst_cream->count * 4;
+        if (per_inst_step)
+            num_instrs += inst_cream->count - 1;
+        if (inst_cream->end_of_block)
+            goto DISPATCH;
+        ptr += sizeof(arm_inst) + sizeof(cond_guard_inst) + inst_cream->skip_bytes;
+        FETCH_INST;
+        GOTO_NEXT_INST;
+    }
+    BLOCK_CYCLES_INST:
+    {
+        block_cycles_inst* inst_cream = (block_cycles_inst*)inst_base->component;
+        if (per_inst_step) {
+            // The per-instruction path counts the instructions itself; charge only the
+            // accurate tier's surcharge, and give back the header's own dispatch tick
+            // since it is not an architectural instruction.
+            num_instrs += inst_cream->extra_cycles;
+            num_instrs--;
+        } else {
+            // Charge the whole block in one step; nothing past this point counts
+            num_instrs += inst_cream->ticks;
+        }
+        INC_PC(sizeof(block_cycles_inst));
+        FETCH_INST;
+        GOTO_NEXT_INST;
+    }
     BIC_INST:
     {
         bic_inst *inst_cream = (bic_inst *)inst_base->component;
@@ -2457,9 +3133,11 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
             if (inst_cream->Rn == 15)
                 rn_val += 2 * cpu->GetInstructionSize();
 
+            const bool update_flags = inst_cream->S != 0;
             bool carry;
             bool overflow;
-            RD = AddWithCarry(~rn_val, SHIFTER_OPERAND, 1, &carry, &overflow);
+            RD = AddWithCarry(~rn_val, SHIFTER_OPERAND, 1,
+                              update_flags ? &carry : nullptr, update_flags ? &overflow : nullptr);
 
             if (inst_cream->S && (inst_cream->Rd == 15)) {
                 if (CurrentModeHasSPSR) {
@@ -2492,9 +3170,11 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
             if (inst_cream->Rn == 15)
                 rn_val += 2 * cpu->GetInstructionSize();
 
+            const bool update_flags = inst_cream->S != 0;
             bool carry;
             bool overflow;
-            RD = AddWithCarry(~rn_val, SHIFTER_OPERAND, cpu->CFlag, &carry, &overflow);
+            RD = AddWithCarry(~rn_val, SHIFTER_OPERAND, cpu->CFlag,
+                              update_flags ? &carry : nullptr, update_flags ? &overflow : nullptr);
 
             if (inst_cream->S && (inst_cream->Rd == 15)) {
                 if (CurrentModeHasSPSR) {
@@ -2636,9 +3316,11 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
             if (inst_cream->Rn == 15)
                 rn_val += 2 * cpu->GetInstructionSize();
 
+            const bool update_flags = inst_cream->S != 0;
             bool carry;
             bool overflow;
-            RD = AddWithCarry(rn_val, ~SHIFTER_OPERAND, cpu->CFlag, &carry, &overflow);
+            RD = AddWithCarry(rn_val, ~SHIFTER_OPERAND, cpu->CFlag,
+                              update_flags ? &carry : nullptr, update_flags ? &overflow : nullptr);
 
             if (inst_cream->S && (inst_cream->Rd == 15)) {
                 if (CurrentModeHasSPSR) {
@@ -3494,9 +4176,11 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 
             u32 rn_val = CHECK_READ_REG15_WA(cpu, inst_cream->Rn);
 
+            const bool update_flags = inst_cream->S != 0;
             bool carry;
             bool overflow;
-            RD = AddWithCarry(rn_val, ~SHIFTER_OPERAND, 1, &carry, &overflow);
+            RD = AddWithCarry(rn_val, ~SHIFTER_OPERAND, 1,
+                              update_flags ? &carry : nullptr, update_flags ? &overflow : nullptr);
 
             if (inst_cream->S && (inst_cream->Rd == 15)) {
                 if (CurrentModeHasSPSR) {
@@ -3990,16 +4674,20 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
         b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
         INC_PC(sizeof(b_2_thumb));
+        chain_slot = &inst_cream->bb_taken;
         goto DISPATCH;
     }
     B_COND_THUMB:
     {
         b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-        if(CondPassed(cpu, inst_cream->cond))
+        if(CondPassed(cpu, inst_cream->cond)) {
             cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-        else
+            chain_slot = &inst_cream->bb_taken;
+        } else {
             cpu->Reg[15] += 2;
+            chain_slot = &inst_cream->bb_not_taken;
+        }
 
         INC_PC(sizeof(b_cond_thumb));
         goto DISPATCH;
@@ -4,6 +4,22 @@
 
 #pragma once
 
+#include "common/common_types.h"
+
 struct ARMul_State;
 
 unsigned InterpreterMainLoop(ARMul_State* state);
+
+/// Translates the basic blocks covering [start_addr, start_addr + size) ahead of execution,
+/// so the first pass over freshly loaded code doesn't pay the cold decode burst. Blocks that
+/// are already cached are skipped.
+void InterpreterPreTranslate(ARMul_State* cpu, u32 start_addr, u32 size);
+
+/// Discards exactly the translated blocks overlapping [start_addr, start_addr + size),
+/// e.g. after a code patch, leaving the rest of the translation cache intact. Chained
+/// branches into a discarded block are severed on their next use.
+void InterpreterInvalidateCodeRange(ARMul_State* cpu, u32 start_addr, u32 size);
+
+/// Logs the hottest translated blocks recorded by the Debugging::profile_hot_blocks
+/// option, with their execution share and disassembly. No-op if profiling was off.
+void InterpreterDumpHotBlocks();
@@ -0,0 +1,323 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/common_types.h"
+#include "common/microprofile.h"
+#include "common/x64/abi.h"
+#include "common/x64/emitter.h"
+
+#include "core/arm/dyncom/arm_dyncom_jit.h"
+#include "core/arm/skyeye_common/armstate.h"
+#include "core/memory.h"
+
+using namespace Gen;
+
+namespace Jit {
+
+namespace {
+
+/// Memory allocated for compiled blocks. When exhausted, the whole cache is flushed.
+constexpr size_t JIT_CACHE_SIZE = 1024 * 1024 * 16;
+
+/// A compiled block is never longer than this many guest instructions.
+constexpr unsigned MAX_BLOCK_INSTRUCTIONS = 64;
+
+/// Pointer to the emulated CPU state, live for the whole duration of a compiled block.
+constexpr X64Reg CPU = ABI_PARAM1;
+
+constexpr size_t RegOffset(unsigned reg) {
+    return offsetof(ARMul_State, Reg) + reg * sizeof(u32);
+}
+
+MICROPROFILE_DEFINE(DynCom_Jit, "DynCom", "Jit Compile", MP_RGB(128, 64, 255));
+
+class BlockCompiler final : public XCodeBlock {
+public:
+    BlockCompiler() {
+        AllocCodeSpace(JIT_CACHE_SIZE);
+    }
+
+    unsigned Run(ARMul_State* cpu) {
+        const u32 pc = cpu->Reg[15];
+
+        auto iter = blocks.find(pc);
+        CompiledBlock block;
+        if (iter != blocks.end()) {
+            block = iter->second;
+        } else {
+            if (blacklist.count(pc) != 0)
+                return 0;
+
+            block = CompileBlock(pc);
+            if (block == nullptr) {
+                blacklist.insert(pc);
+                return 0;
+            }
+            blocks[pc] = block;
+        }
+
+        return block(cpu);
+    }
+
+    void Clear() {
+        blocks.clear();
+        blacklist.clear();
+        ResetCodePtr();
+    }
+
+    void InvalidateRange(u32 addr, u32 size) {
+        // Blocks don't record their guest length, so any block that could reach into the
+        // range is dropped; the orphaned host code is simply never entered again and its
+        // space is reclaimed by the next full flush. The extra 32 instructions mirror the
+        // interpreter's dead-flag scan window (MAX_DEAD_FLAG_SCAN), keeping this reach
+        // valid if the same lookahead is ever added here.
+        const u32 reach = (MAX_BLOCK_INSTRUCTIONS + 32) * 4;
+        for (auto itr = blocks.begin(); itr != blocks.end();) {
+            if (itr->first < addr + size && itr->first + reach > addr)
+                itr = blocks.erase(itr);
+            else
+                ++itr;
+        }
+        // A patched instruction may now be compilable (or newly unsupported)
+        for (auto itr = blacklist.begin(); itr != blacklist.end();) {
+            if (*itr >= addr && *itr < addr + size)
+                itr = blacklist.erase(itr);
+            else
+                ++itr;
+        }
+    }
+
+private:
+    using CompiledBlock = unsigned (*)(ARMul_State* cpu);
+
+    /// Guest PC -> entry point of the compiled code for the block starting there
+    std::unordered_map<u32, CompiledBlock> blocks;
+    /// Blocks whose first instruction is unsupported; these always use the interpreter
+    std::unordered_set<u32> blacklist;
+
+    CompiledBlock CompileBlock(u32 addr) {
+        MICROPROFILE_SCOPE(DynCom_Jit);
+
+        if (GetSpaceLeft() < 0x8000)
+            Clear();
+
+        const u8* entry = GetCodePtr();
+        u32 pc = addr;
+        unsigned num_instructions = 0;
+        bool block_ended = false;
+
+        while (!block_ended && num_instructions < MAX_BLOCK_INSTRUCTIONS) {
+            const u32 inst = Memory::Read32(pc & 0xFFFFFFFC);
+            if (!CompileInstruction(inst, pc, block_ended))
+                break;
+            ++num_instructions;
+            pc += 4;
+        }
+
+        if (num_instructions == 0) {
+            // Nothing was compiled; undo any partial emission and let the interpreter handle it.
+            SetCodePtr(const_cast<u8*>(entry));
+            return nullptr;
+        }
+
+        // A straight-line exit (unsupported instruction or block size limit) continues at the
+        // next uncompiled instruction; branches have already written R15 themselves.
+        if (!block_ended)
+            MOV(32, MDisp(CPU, RegOffset(15)), Imm32(pc));
+
+        MOV(32, R(RAX), Imm32(num_instructions));
+        RET();
+
+        Memory::MarkRegionAsCode(addr, pc - addr);
+
+        return reinterpret_cast<CompiledBlock>(const_cast<u8*>(entry));
+    }
+
+    /**
+     * Emits code for a single ARM instruction, if it belongs to the supported subset:
+     * unconditional data-processing instructions with an immediate or unshifted register
+     * operand (except the carry-in consumers ADC/SBC/RSC), and static B/BL branches.
+     * @return true if code was emitted, false if the instruction is unsupported.
+     */
+    bool CompileInstruction(u32 inst, u32 pc, bool& block_ended) {
+        // Only unconditionally executed instructions are compiled.
+        if ((inst >> 28) != ConditionCode::AL)
+            return false;
+
+        // B/BL with a static target ends the block.
+        if ((inst & 0x0E000000) == 0x0A000000) {
+            const bool link = (inst & (1 << 24)) != 0;
+            const s32 offset = (static_cast<s32>(inst << 8) >> 8) << 2;
+            if (link)
+                MOV(32, MDisp(CPU, RegOffset(14)), Imm32(pc + 4));
+            MOV(32, MDisp(CPU, RegOffset(15)), Imm32(pc + 8 + offset));
+            block_ended = true;
+            return true;
+        }
+
+        if ((inst & 0x0C000000) != 0)
+            return false;
+
+        const bool imm_operand = (inst & (1 << 25)) != 0;
+        const unsigned opcode = (inst >> 21) & 0xF;
+        const bool update_flags = (inst & (1 << 20)) != 0;
+        const unsigned rn = (inst >> 16) & 0xF;
+        const unsigned rd = (inst >> 12) & 0xF;
+
+        // Opcodes 0x8-0xB without the S bit are MRS/MSR/BX/etc., not data-processing.
+        if (!update_flags && opcode >= 0x8 && opcode <= 0xB)
+            return false;
+        // ADC/SBC/RSC consume the carry flag; leave them to the interpreter.
+        if (opcode >= 0x5 && opcode <= 0x7)
+            return false;
+        // Writes to PC are indirect branches.
+        const bool is_compare = opcode >= 0x8 && opcode <= 0xB;
+        if (rd == 15 && !is_compare)
+            return false;
+
+        // Evaluate the shifter operand. Only rotated immediates and plain (unshifted)
+        // registers are supported; both have compile-time known carry behaviour.
+        bool op2_is_constant;
+        u32 op2_value = 0;
+        unsigned rm = 0;
+        bool carry_known = false;
+        u32 carry_value = 0;
+        if (imm_operand) {
+            const u32 imm8 = inst & 0xFF;
+            const unsigned rotate = ((inst >> 8) & 0xF) * 2;
+            op2_value = (rotate == 0) ? imm8 : ((imm8 >> rotate) | (imm8 << (32 - rotate)));
+            op2_is_constant = true;
+            if (rotate != 0) {
+                carry_known = true;
+                carry_value = op2_value >> 31;
+            }
+        } else {
+            if ((inst & 0xFF0) != 0)
+                return false;
+            rm = inst & 0xF;
+            if (rm == 15) {
+                op2_value = pc + 8;
+                op2_is_constant = true;
+            } else {
+                op2_is_constant = false;
+            }
+        }
+
+        const OpArg op2 = op2_is_constant ? Imm32(op2_value) : MDisp(CPU, RegOffset(rm));
+        const OpArg rn_arg =
+            (rn == 15) ? Imm32(pc + 8) : MDisp(CPU, RegOffset(rn));
+
+        // Carry semantics of the host operation: logical ops take the (compile-time)
+        // shifter carry, additions take CF, subtractions take !CF.
+        enum class CarrySource { Shifter, HostCarry, HostNotCarry };
+        CarrySource carry_source = CarrySource::Shifter;
+
+        switch (opcode) {
+        case 0x0: // AND
+        case 0x8: // TST
+            MOV(32, R(RAX), rn_arg);
+            AND(32, R(RAX), op2);
+            break;
+        case 0x1: // EOR
+        case 0x9: // TEQ
+            MOV(32, R(RAX), rn_arg);
+            XOR(32, R(RAX), op2);
+            break;
+        case 0x2: // SUB
+        case 0xA: // CMP
+            MOV(32, R(RAX), rn_arg);
+            SUB(32, R(RAX), op2);
+            carry_source = CarrySource::HostNotCarry;
+            break;
+        case 0x3: // RSB
+            MOV(32, R(RAX), op2);
+            SUB(32, R(RAX), rn_arg);
+            carry_source = CarrySource::HostNotCarry;
+            break;
+        case 0x4: // ADD
+        case 0xB: // CMN
+            MOV(32, R(RAX), rn_arg);
+            ADD(32, R(RAX), op2);
+            carry_source = CarrySource::HostCarry;
+            break;
+        case 0xC: // ORR
+            MOV(32, R(RAX), rn_arg);
+            OR(32, R(RAX), op2);
+            break;
+        case 0xD: // MOV
+            MOV(32, R(RAX), op2);
+            if (update_flags)
+                TEST(32, R(RAX), R(RAX));
+            break;
+        case 0xE: // BIC
+            MOV(32, R(RAX), op2);
+            NOT(32, R(RAX));
+            AND(32, R(RAX), rn_arg);
+            break;
+        case 0xF: // MVN
+            MOV(32, R(RAX), op2);
+            // XOR instead of NOT so that NZ are set for the S variant.
+            XOR(32, R(RAX), Imm32(0xFFFFFFFF));
+            break;
+        default:
+            return false;
+        }
+
+        if (update_flags) {
+            SETcc(CC_S, R(RDX));
+            SETcc(CC_Z, R(Gen::R8));
+            if (carry_source == CarrySource::HostCarry)
+                SETcc(CC_C, R(Gen::R9));
+            else if (carry_source == CarrySource::HostNotCarry)
+                SETcc(CC_NC, R(Gen::R9));
+            if (carry_source != CarrySource::Shifter)
+                SETcc(CC_O, R(Gen::R10));
+
+            MOVZX(32, 8, RDX, R(RDX));
+            MOV(32, MDisp(CPU, offsetof(ARMul_State, NFlag)), R(RDX));
+            MOVZX(32, 8, Gen::R8, R(Gen::R8));
+            MOV(32, MDisp(CPU, offsetof(ARMul_State, ZFlag)), R(Gen::R8));
+            if (carry_source != CarrySource::Shifter) {
+                MOVZX(32, 8, Gen::R9, R(Gen::R9));
+                MOV(32, MDisp(CPU, offsetof(ARMul_State, CFlag)), R(Gen::R9));
+                MOVZX(32, 8, Gen::R10, R(Gen::R10));
+                MOV(32, MDisp(CPU, offsetof(ARMul_State, VFlag)), R(Gen::R10));
+            } else if (carry_known) {
+                MOV(32, MDisp(CPU, offsetof(ARMul_State, CFlag)), Imm32(carry_value));
+            }
+        }
+
+        if (!is_compare)
+            MOV(32, MDisp(CPU, RegOffset(rd)), R(RAX));
+
+        return true;
+    }
+};
+
+std::unique_ptr<BlockCompiler> compiler;
+
+} // namespace
+
+unsigned TryRunBlock(ARMul_State* cpu) {
+    if (compiler == nullptr)
+        compiler = std::make_unique<BlockCompiler>();
+    return compiler->Run(cpu);
+}
+
+void FlushCache() {
+    if (compiler != nullptr)
+        compiler->Clear();
+}
+
+void InvalidateRange(u32 addr, u32 size) {
+    if (compiler != nullptr)
+        compiler->InvalidateRange(addr, size);
+}
+
+} // namespace Jit
@@ -0,0 +1,31 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+struct ARMul_State;
+
+namespace Jit {
+
+/**
+ * Attempts to execute natively compiled code for the basic block starting at the current PC.
+ * Blocks are compiled on first visit; blocks containing instructions the compiler does not
+ * support are blacklisted and permanently handled by the interpreter instead.
+ * Must only be called in ARM (not Thumb) mode.
+ * @return The number of guest instructions executed, or 0 if no compiled block was run.
+ */
+unsigned TryRunBlock(ARMul_State* cpu);
+
+/// Throws away all compiled code, e.g. when the emulated instruction stream may have changed.
+void FlushCache();
+
+/**
+ * Forgets compiled blocks that may contain instructions from [addr, addr + size), so a code
+ * patch only costs recompiling the blocks it touches rather than the whole cache.
+ */
+void InvalidateRange(u32 addr, u32 size);
+
+} // namespace Jit
@@ -11,6 +11,27 @@
 
 char trans_cache_buf[TRANS_CACHE_SIZE];
 size_t trans_cache_buf_top = 0;
+unsigned trans_cache_generation[2] = {};
+
+// Upper bound on the cache space a single translated block can take: blocks are cut at
+// page boundaries, so at most 1024 instructions of maximum decoded size.
+static const size_t TRANS_CACHE_MAX_BLOCK_SIZE = 64 * 1024 * 4;
+
+void TransCacheEnsureSpace() {
+    const size_t half_size = TRANS_CACHE_SIZE / 2;
+    const size_t active_half = trans_cache_buf_top < half_size ? 0 : 1;
+    const size_t half_end = (active_half + 1) * half_size;
+
+    if (half_end - trans_cache_buf_top >= TRANS_CACHE_MAX_BLOCK_SIZE)
+        return;
+
+    // Move translation over to the other half and evict everything it held. Outstanding
+    // references (instruction_cache entries and block links) notice the generation bump
+    // and retranslate lazily.
+    const size_t next_half = active_half ^ 1;
+    trans_cache_buf_top = next_half * half_size;
+    ++trans_cache_generation[next_half];
+}
 
 static void* AllocBuffer(size_t size) {
     size_t start = trans_cache_buf_top;
@@ -19,10 +40,41 @@ static void* AllocBuffer(size_t size) {
     return static_cast<void*>(&trans_cache_buf[start]);
 }
 
+ARM_INST_PTR InterpreterTranslateCondGuard(unsigned int cond) {
+    arm_inst* inst_base = (arm_inst*)AllocBuffer(sizeof(arm_inst) + sizeof(cond_guard_inst));
+    cond_guard_inst* inst_cream = (cond_guard_inst*)inst_base->component;
+
+    inst_base->cond = cond;
+    inst_base->idx  = COND_GUARD_INST_INDEX;
+    inst_base->br   = TransExtData::NON_BRANCH;
+
+    inst_cream->count = 0;
+    inst_cream->skip_bytes = 0;
+    inst_cream->end_of_block = 0;
+
+    return inst_base;
+}
+
+ARM_INST_PTR InterpreterTranslateBlockCycles() {
+    arm_inst* inst_base = (arm_inst*)AllocBuffer(sizeof(arm_inst) + sizeof(block_cycles_inst));
+    block_cycles_inst* inst_cream = (block_cycles_inst*)inst_base->component;
+
+    inst_base->cond = 0xE;
+    inst_base->idx  = BLOCK_CYCLES_INST_INDEX;
+    inst_base->br   = TransExtData::NON_BRANCH;
+
+    inst_cream->ticks = 0;
+    inst_cream->extra_cycles = 0;
+    inst_cream->invalidated = 0;
+
+    return inst_base;
+}
+
 #define glue(x, y) x ## y
 #define INTERPRETER_TRANSLATE(s) glue(InterpreterTranslate_, s)
 
 shtop_fp_t GetShifterOp(unsigned int inst);
+shtop_fp_t GetShifterOpFolded(unsigned int inst, unsigned int* shifter_operand);
 get_addr_fp_t GetAddressingOp(unsigned int inst);
 get_addr_fp_t GetAddressingOpLoadStoreT(unsigned int inst);
 
@@ -39,8 +91,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(adc)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -60,8 +111,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(add)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -81,8 +131,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(and)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -106,6 +155,9 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bbl)(unsigned int inst, int index)
 
     inst_cream->L      = BIT(inst, 24);
     inst_cream->signed_immed_24 = BIT(inst, 23) ? NEGBRANCH : POSBRANCH;
+    inst_cream->idle_loop = 0;
+    inst_cream->bb_taken.ptr = TRANS_CACHE_NO_LINK;
+    inst_cream->bb_not_taken.ptr = TRANS_CACHE_NO_LINK;
 
     return inst_base;
 }
@@ -122,8 +174,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bic)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -233,8 +284,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(cmn)(unsigned int inst, int index)
 
     inst_cream->I  = BIT(inst, 25);
     inst_cream->Rn = BITS(inst, 16, 19);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     return inst_base;
 }
@@ -249,8 +299,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(cmp)(unsigned int inst, int index)
 
     inst_cream->I  = BIT(inst, 25);
     inst_cream->Rn = BITS(inst, 16, 19);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     return inst_base;
 }
@@ -285,8 +334,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(cpy)(unsigned int inst, int index)
     inst_cream->I  = BIT(inst, 25);
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15) {
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -306,8 +354,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(eor)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -614,8 +661,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(mov)(unsigned int inst, int index)
     inst_cream->I  = BIT(inst, 25);
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15) {
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -702,8 +748,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(mvn)(unsigned int inst, int index)
     inst_cream->I  = BIT(inst, 25);
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15) {
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -724,8 +769,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(orr)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rd = BITS(inst, 12, 15);
     inst_cream->Rn = BITS(inst, 16, 19);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -898,8 +942,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(rsb)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -919,8 +962,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(rsc)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -978,8 +1020,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(sbc)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -1518,8 +1559,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(sub)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     if (inst_cream->Rd == 15)
         inst_base->br = TransExtData::INDIRECT_BRANCH;
@@ -1649,8 +1689,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(tst)(unsigned int inst, int index)
     inst_cream->S  = BIT(inst, 20);
     inst_cream->Rn = BITS(inst, 16, 19);
     inst_cream->Rd = BITS(inst, 12, 15);
-    inst_cream->shifter_operand = BITS(inst, 0, 11);
-    inst_cream->shtop_func = GetShifterOp(inst);
+    inst_cream->shtop_func = GetShifterOpFolded(inst, &inst_cream->shifter_operand);
 
     return inst_base;
 }
@@ -1787,6 +1826,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_2_thumb)(unsigned int tinst, int ind
     b_2_thumb *inst_cream = (b_2_thumb *)inst_base->component;
 
     inst_cream->imm = ((tinst & 0x3FF) << 1) | ((tinst & (1 << 10)) ? 0xFFFFF800 : 0);
+    inst_cream->bb_taken.ptr = TRANS_CACHE_NO_LINK;
 
     inst_base->idx = index;
     inst_base->br  = TransExtData::DIRECT_BRANCH;
@@ -1801,6 +1841,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_cond_thumb)(unsigned int tinst, int
 
     inst_cream->imm  = (((tinst & 0x7F) << 1) | ((tinst & (1 << 7)) ?    0xFFFFFF00 : 0));
     inst_cream->cond = ((tinst >> 8) & 0xf);
+    inst_cream->bb_taken.ptr = TRANS_CACHE_NO_LINK;
+    inst_cream->bb_not_taken.ptr = TRANS_CACHE_NO_LINK;
     inst_base->idx   = index;
     inst_base->br    = TransExtData::DIRECT_BRANCH;
 
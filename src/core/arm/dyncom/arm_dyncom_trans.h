@@ -74,11 +74,28 @@ struct eor_inst {
     shtop_fp_t shtop_func;
 };
 
+// Sentinel for an unlinked basic-block successor slot (see the dispatch loop)
+#define TRANS_CACHE_NO_LINK (-1)
+
+// Reference to a block in the translation cache. Only valid while the generation
+// of the cache half holding the block is unchanged; eviction bumps the generation.
+struct BlockLink {
+    int ptr;
+    unsigned generation;
+};
+
 struct bbl_inst {
     unsigned int L;
     int signed_immed_24;
     unsigned int next_addr;
     unsigned int jmp_addr;
+    // Set when this branch closes a detected idle loop (a short, side-effect-free block
+    // that branches back to its own start); taking it consumes the rest of the timeslice.
+    unsigned int idle_loop;
+    // Cached locations of the successor blocks in the translation cache, so that
+    // executing this branch again skips the translation map lookup.
+    BlockLink bb_taken;
+    BlockLink bb_not_taken;
 };
 
 struct bx_inst {
@@ -446,10 +463,13 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    BlockLink bb_taken;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    BlockLink bb_taken;
+    BlockLink bb_not_taken;
 };
 
 struct bl_1_thumb {
@@ -488,6 +508,61 @@ typedef ARM_INST_PTR (*transop_fp_t)(unsigned int, int);
 extern const transop_fp_t arm_instruction_trans[];
 extern const size_t arm_instruction_trans_len;
 
+// Dispatch index of the condition guard pseudo-instruction. It has no entry in the decode
+// tables; the interpreter's dispatch tables append a matching label (and switch case) one
+// past the END label.
+#define COND_GUARD_INST_INDEX 205
+
+// Block-level guard emitted in front of a run of consecutive ARM instructions sharing one
+// (non-AL) condition. If the condition fails at the guard it must fail for every
+// instruction in the run -- skipped instructions cannot write the flags -- so the whole
+// run is skipped with a single check instead of one per instruction. When the condition
+// passes the guard falls through and each covered instruction still performs its own
+// check, so flag writes inside the run are honored.
+struct cond_guard_inst {
+    unsigned int count;        // Number of ARM instructions covered by the guard
+    unsigned int skip_bytes;   // Translated size of the covered run in the cache
+    unsigned int end_of_block; // Set when the covered run terminates its basic block
+};
+
+// Emits a condition guard for a run of instructions sharing cond. The caller sizes the
+// guard once the run has actually been translated behind it.
+ARM_INST_PTR InterpreterTranslateCondGuard(unsigned int cond);
+
+// Dispatch index of the block cycles pseudo-instruction (see COND_GUARD_INST_INDEX)
+#define BLOCK_CYCLES_INST_INDEX 206
+
+// Header pseudo-instruction emitted at the start of every translated block. In the
+// common no-debug case the dispatch loop charges the block's whole tick count here in a
+// single step and retires instructions without any per-instruction bookkeeping; under
+// gdbstub control (or single-stepping) instructions are counted one by one and only the
+// accurate tier's surcharge is charged by the header.
+struct block_cycles_inst {
+    unsigned int ticks;        // Instruction count plus the accurate tier's surcharge
+    unsigned int extra_cycles; // The surcharge alone, for the per-instruction path
+    unsigned int invalidated;  // Set when a code patch hits the block; chained branches
+                               // check it before jumping in, since they bypass the map
+};
+
+// Emits a block cycles header. The caller fills in the tick counts once the block has
+// been translated behind it.
+ARM_INST_PTR InterpreterTranslateBlockCycles();
+
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
 extern char trans_cache_buf[TRANS_CACHE_SIZE];
 extern size_t trans_cache_buf_top;
+
+// The translation cache is split into two halves so that filling it up evicts only the
+// (colder) half that was translated into least recently, instead of flushing every hot
+// block at once. Each half has a generation counter which is bumped on eviction;
+// references into the cache are only valid while the generation they were created
+// against still matches.
+extern unsigned trans_cache_generation[2];
+
+inline unsigned TransCacheGenerationOf(int offset) {
+    return trans_cache_generation[offset < TRANS_CACHE_SIZE / 2 ? 0 : 1];
+}
+
+// Ensures the active half has room for one more translated block, switching halves
+// (and evicting the other one) if it does not.
+void TransCacheEnsureSpace();
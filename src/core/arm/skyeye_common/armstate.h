@@ -236,9 +236,18 @@ public:
     unsigned bigendSig;
     unsigned syscallSig;
 
+    // An entry of the translated basic block map. The generation records which translation
+    // cache generation the block was decoded into; a stale generation means the block has
+    // been evicted and must be retranslated.
+    struct CacheEntry {
+        int ptr;
+        unsigned generation;
+        u32 guest_end; // Guest address one past the block's last instruction
+    };
+
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
-    std::unordered_map<u32, int> instruction_cache;
+    std::unordered_map<u32, CacheEntry> instruction_cache;
 
 private:
     void ResetMPCoreCP15Registers();
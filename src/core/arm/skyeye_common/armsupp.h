@@ -15,7 +15,24 @@
 bool AddOverflow(u32, u32, u32);
 bool SubOverflow(u32, u32, u32);
 
-u32 AddWithCarry(u32, u32, u32, bool*, bool*);
+// Add with carry, indicates if a carry-out or signed overflow occurred.
+// Inline so that callers passing null flag pointers (non flag-setting
+// instructions) compile down to the bare addition.
+inline u32 AddWithCarry(u32 left, u32 right, u32 carry_in, bool* carry_out_occurred, bool* overflow_occurred)
+{
+    u64 unsigned_sum = (u64)left + (u64)right + (u64)carry_in;
+    s64 signed_sum = (s64)(s32)left + (s64)(s32)right + (s64)carry_in;
+    u64 result = (unsigned_sum & 0xFFFFFFFF);
+
+    if (carry_out_occurred)
+        *carry_out_occurred = (result != unsigned_sum);
+
+    if (overflow_occurred)
+        *overflow_occurred = ((s64)(s32)result != signed_sum);
+
+    return (u32)result;
+}
+
 bool ARMul_AddOverflowQ(u32, u32);
 
 u8 ARMul_SignedSaturatedAdd8(u8, u8);
@@ -393,6 +393,33 @@ inline s64 vfp_double_pack(const vfp_double* s)
 
 u32 vfp_estimate_sqrt_significand(u32 exponent, u32 significand);
 
+// Whether the host-FP fast paths may be used under the current FPSCR configuration:
+// round-to-nearest, no flush-to-zero, and no exception traps enabled.
+inline bool vfp_fastmath_usable(u32 fpscr)
+{
+    const u32 blocking_bits = FPSCR_RMODE_MASK | FPSCR_FLUSH_TO_ZERO | FPSCR_IDE |
+                              FPSCR_IXE | FPSCR_UFE | FPSCR_OFE | FPSCR_DZE | FPSCR_IOE;
+    return (fpscr & blocking_bits) == FPSCR_ROUND_NEAREST;
+}
+
+// True for packed values which host arithmetic handles exactly like the soft-float
+// path: normal numbers and zeros (not denormals, infinities or NaNs).
+inline bool vfp_single_is_hostsafe(s32 v)
+{
+    const u32 exponent = vfp_single_packed_exponent(v);
+    if (exponent == 255)
+        return false;
+    return exponent != 0 || vfp_single_packed_mantissa(v) == 0;
+}
+
+inline bool vfp_double_is_hostsafe(u64 v)
+{
+    const u32 exponent = vfp_double_packed_exponent(v);
+    if (exponent == 2047)
+        return false;
+    return exponent != 0 || vfp_double_packed_mantissa(v) == 0;
+}
+
 // A special flag to tell the normalisation code not to normalise.
 #define VFP_NAN_FLAG 0x100
 
@@ -52,10 +52,62 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 #include "core/arm/skyeye_common/vfp/vfp_helper.h"
 #include "core/arm/skyeye_common/vfp/asm_vfp.h"
+#include "core/settings.h"
+
+/**
+ * Executes dd = dn <op> dm with host floating point instead of the bit-exact soft-float
+ * path. Only taken when both operands and the result are normal numbers or zeros and the
+ * FPSCR is in its default configuration, so the only observable difference is that
+ * cumulative exception bits (e.g. inexact) are not accumulated.
+ * @return true if the fast path was applicable and the result has been written.
+ */
+static bool vfp_double_try_fast_op(ARMul_State* state, int dd, int dn, int dm, u32 fpscr, char op)
+{
+    if (!Settings::values.use_fast_vfp || !vfp_fastmath_usable(fpscr))
+        return false;
+
+    const u64 n = vfp_get_double(state, dn);
+    const u64 m = vfp_get_double(state, dm);
+    if (!vfp_double_is_hostsafe(n) || !vfp_double_is_hostsafe(m))
+        return false;
+
+    double fn, fm, fd;
+    std::memcpy(&fn, &n, sizeof(fn));
+    std::memcpy(&fm, &m, sizeof(fm));
+
+    switch (op) {
+    case '+':
+        fd = fn + fm;
+        break;
+    case '-':
+        fd = fn - fm;
+        break;
+    case '*':
+        fd = fn * fm;
+        break;
+    case 'n': // negated multiply
+        fd = -(fn * fm);
+        break;
+    case '/':
+        fd = fn / fm;
+        break;
+    default:
+        return false;
+    }
+
+    u64 d;
+    std::memcpy(&d, &fd, sizeof(d));
+    if (!vfp_double_is_hostsafe(d))
+        return false;
+
+    vfp_put_double(state, d, dd);
+    return true;
+}
 
 static struct vfp_double vfp_double_default_qnan = {
     2047,
@@ -991,6 +1043,9 @@ static u32 vfp_double_fmul(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     u32 exceptions = 0;
 
     LOG_TRACE(Core_ARM11, "In %s", __FUNCTION__);
+
+    if (vfp_double_try_fast_op(state, dd, dn, dm, fpscr, '*'))
+        return 0;
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     if (vdn.exponent == 0 && vdn.significand)
         vfp_double_normalise_denormal(&vdn);
@@ -1014,6 +1069,9 @@ static u32 vfp_double_fnmul(ARMul_State* state, int dd, int dn, int dm, u32 fpsc
     u32 exceptions = 0;
 
     LOG_TRACE(Core_ARM11, "In %s", __FUNCTION__);
+
+    if (vfp_double_try_fast_op(state, dd, dn, dm, fpscr, 'n'))
+        return 0;
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     if (vdn.exponent == 0 && vdn.significand)
         vfp_double_normalise_denormal(&vdn);
@@ -1038,6 +1096,9 @@ static u32 vfp_double_fadd(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     u32 exceptions = 0;
 
     LOG_TRACE(Core_ARM11, "In %s", __FUNCTION__);
+
+    if (vfp_double_try_fast_op(state, dd, dn, dm, fpscr, '+'))
+        return 0;
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     if (vdn.exponent == 0 && vdn.significand)
         vfp_double_normalise_denormal(&vdn);
@@ -1061,6 +1122,9 @@ static u32 vfp_double_fsub(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     u32 exceptions = 0;
 
     LOG_TRACE(Core_ARM11, "In %s", __FUNCTION__);
+
+    if (vfp_double_try_fast_op(state, dd, dn, dm, fpscr, '-'))
+        return 0;
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     if (vdn.exponent == 0 && vdn.significand)
         vfp_double_normalise_denormal(&vdn);
@@ -1090,6 +1154,9 @@ static u32 vfp_double_fdiv(ARMul_State* state, int dd, int dn, int dm, u32 fpscr
     int tm, tn;
 
     LOG_TRACE(Core_ARM11, "In %s", __FUNCTION__);
+
+    if (vfp_double_try_fast_op(state, dd, dn, dm, fpscr, '/'))
+        return 0;
     exceptions |= vfp_double_unpack(&vdn, vfp_get_double(state, dn), fpscr);
     exceptions |= vfp_double_unpack(&vdm, vfp_get_double(state, dm), fpscr);
 
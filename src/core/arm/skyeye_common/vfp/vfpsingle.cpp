@@ -53,6 +53,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstring>
 
 #include "common/common_funcs.h"
 #include "common/common_types.h"
@@ -61,6 +62,51 @@
 #include "core/arm/skyeye_common/vfp/vfp_helper.h"
 #include "core/arm/skyeye_common/vfp/asm_vfp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
+#include "core/settings.h"
+
+/**
+ * Executes sd = sn <op> sm with host floating point instead of the bit-exact soft-float
+ * path. Only taken when both operands and the result are normal numbers or zeros and the
+ * FPSCR is in its default configuration, so the only observable difference is that
+ * cumulative exception bits (e.g. inexact) are not accumulated.
+ * @return true if the fast path was applicable and the result has been written.
+ */
+static bool vfp_single_try_fast_op(ARMul_State* state, int sd, s32 n, s32 m, u32 fpscr, char op)
+{
+    if (!Settings::values.use_fast_vfp || !vfp_fastmath_usable(fpscr))
+        return false;
+    if (!vfp_single_is_hostsafe(n) || !vfp_single_is_hostsafe(m))
+        return false;
+
+    float fn, fm, fd;
+    std::memcpy(&fn, &n, sizeof(fn));
+    std::memcpy(&fm, &m, sizeof(fm));
+
+    switch (op) {
+    case '+':
+        fd = fn + fm;
+        break;
+    case '*':
+        fd = fn * fm;
+        break;
+    case 'n': // negated multiply
+        fd = -(fn * fm);
+        break;
+    case '/':
+        fd = fn / fm;
+        break;
+    default:
+        return false;
+    }
+
+    s32 d;
+    std::memcpy(&d, &fd, sizeof(d));
+    if (!vfp_single_is_hostsafe(d))
+        return false;
+
+    vfp_put_float(state, d, sd);
+    return true;
+}
 
 static struct vfp_single vfp_single_default_qnan = {
     255,
@@ -1032,6 +1078,9 @@ static u32 vfp_single_fmul(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s%u = %08x", sn, n);
 
+    if (vfp_single_try_fast_op(state, sd, n, m, fpscr, '*'))
+        return 0;
+
     exceptions |= vfp_single_unpack(&vsn, n, fpscr);
     if (vsn.exponent == 0 && vsn.significand)
         vfp_single_normalise_denormal(&vsn);
@@ -1057,6 +1106,9 @@ static u32 vfp_single_fnmul(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr
 
     LOG_TRACE(Core_ARM11, "s%u = %08x", sn, n);
 
+    if (vfp_single_try_fast_op(state, sd, n, m, fpscr, 'n'))
+        return 0;
+
     exceptions |= vfp_single_unpack(&vsn, n, fpscr);
     if (vsn.exponent == 0 && vsn.significand)
         vfp_single_normalise_denormal(&vsn);
@@ -1083,6 +1135,9 @@ static u32 vfp_single_fadd(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s%u = %08x", sn, n);
 
+    if (vfp_single_try_fast_op(state, sd, n, m, fpscr, '+'))
+        return 0;
+
     /*
      * Unpack and normalise denormals.
      */
@@ -1127,6 +1182,9 @@ static u32 vfp_single_fdiv(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s%u = %08x", sn, n);
 
+    if (vfp_single_try_fast_op(state, sd, n, m, fpscr, '/'))
+        return 0;
+
     exceptions |= vfp_single_unpack(&vsn, n, fpscr);
     exceptions |= vfp_single_unpack(&vsm, m, fpscr);
 
@@ -22,9 +22,19 @@ namespace Core {
 std::unique_ptr<ARM_Interface> g_app_core; ///< ARM11 application core
 std::unique_ptr<ARM_Interface> g_sys_core; ///< ARM11 system (OS) core
 
+unsigned g_running_core = 0;
+
+ARM_Interface& GetCpuCore(unsigned core_index) {
+    return core_index == 0 ? *g_app_core : *g_sys_core;
+}
+
+ARM_Interface& CurrentCpuCore() {
+    return GetCpuCore(g_running_core);
+}
+
 /// Run the core CPU loop
 void RunLoop(int tight_loop) {
-    if (GDBStub::g_server_enabled) {
+    if (GDBStub::IsServerEnabled()) {
         GDBStub::HandlePacket();
 
         // If the loop is halted and we want to step, use a tiny (1) number of instructions to execute.
@@ -54,6 +64,24 @@ void RunLoop(int tight_loop) {
     if (HLE::IsReschedulePending()) {
         Kernel::Reschedule();
     }
+
+    // Interleave a SysCore slice when a title has scheduled threads there. The global timeline
+    // is driven by the AppCore's downcount, so work done here occupies the same time window as
+    // the AppCore slice above: the two cores advance in parallel rather than serially.
+    if (Kernel::HasRunnableThreads(1)) {
+        g_running_core = 1;
+        Kernel::Reschedule();
+        if (Kernel::GetCurrentThread() != nullptr) {
+            // Top up the SysCore's downcount so its AddTicks never re-enters
+            // CoreTiming::Advance, which only manages the AppCore's slice.
+            g_sys_core->down_count = tight_loop * 4;
+            g_sys_core->Run(tight_loop);
+        }
+        if (HLE::IsReschedulePending()) {
+            Kernel::Reschedule();
+        }
+        g_running_core = 0;
+    }
 }
 
 /// Step the CPU one instruction
@@ -75,6 +103,7 @@ void Stop() {
 void Init() {
     g_sys_core = std::make_unique<ARM_DynCom>(USER32MODE);
     g_app_core = std::make_unique<ARM_DynCom>(USER32MODE);
+    g_running_core = 0;
 
     LOG_DEBUG(Core, "Initialized OK");
 }
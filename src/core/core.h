@@ -27,6 +27,16 @@ struct ThreadContext {
 extern std::unique_ptr<ARM_Interface> g_app_core; ///< ARM11 application core
 extern std::unique_ptr<ARM_Interface> g_sys_core; ///< ARM11 system (OS) core
 
+/// Index of the emulated CPU core the kernel is currently scheduling and executing on.
+/// Core 0 is the AppCore and core 1 the SysCore; see Kernel::ThreadProcessorId.
+extern unsigned g_running_core;
+
+/// Returns the ARM core instance for the given emulated core index
+ARM_Interface& GetCpuCore(unsigned core_index);
+
+/// Returns the ARM core instance guest code is currently executing on
+ARM_Interface& CurrentCpuCore();
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Start the core
@@ -2,12 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cinttypes>
 #include <mutex>
+#include <thread>
+#include <tuple>
 #include <vector>
 
-#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 
@@ -36,35 +39,61 @@ struct EventType
 
 static std::vector<EventType> event_types;
 
-struct BaseEvent
+// The pending events are a binary min-heap of plain values, ordered by time and then by
+// insertion order so that events scheduled for the same cycle fire FIFO, as they did with
+// the old sorted list. The vector doubles as the event arena: its capacity is retained
+// across pops, so steady-state scheduling performs no allocation.
+struct Event
 {
     s64 time;
+    u64 sequence;
     u64 userdata;
     int type;
 };
 
-typedef LinkedListItem<BaseEvent> Event;
+/// Heap comparator; with std::push_heap's max-heap convention, "greater" yields a min-heap.
+static bool EventAfter(const Event& lhs, const Event& rhs) {
+    return std::tie(lhs.time, lhs.sequence) > std::tie(rhs.time, rhs.sequence);
+}
+
+static std::vector<Event> event_queue;
+static u64 event_sequence;
 
-static Event* first;
-static Event* ts_first;
-static Event* ts_last;
+// Cross-thread scheduling goes through a bounded MPSC ring: producers serialize among
+// themselves with a light mutex and the consumer (the CPU thread, in MoveEvents) drains
+// without taking it. Positions are monotonic counters masked into the ring.
+constexpr size_t TS_QUEUE_SIZE = 256;
+static_assert((TS_QUEUE_SIZE & (TS_QUEUE_SIZE - 1)) == 0, "TS_QUEUE_SIZE must be a power of two");
 
-// event pools
-static Event* event_pool = nullptr;
-static Event* event_ts_pool = nullptr;
-static int allocated_ts_events = 0;
+struct TsEvent
+{
+    s64 time;
+    u64 userdata;
+    int type;
+};
+
+static std::array<TsEvent, TS_QUEUE_SIZE> ts_queue;
+static std::atomic<size_t> ts_write(0);
+static std::atomic<size_t> ts_read(0);
+static std::mutex ts_producer_lock;
 // Optimization to skip MoveEvents when possible.
 static std::atomic<bool> has_ts_events(false);
+// Identity of the draining thread, recorded by MoveEvents. A producer that turns out to
+// be the drainer itself must not wait for the ring to empty (see ScheduleEvent_Threadsafe).
+static std::atomic<std::thread::id> ts_consumer_thread;
 
 int g_slice_length;
 
+// Events due within this many cycles of "now" are fired in the same Advance pass, so a
+// cluster of nearby periodic events costs one main-loop exit instead of one per event.
+// 512 cycles is ~2us of emulated time, well under any event's cadence.
+static s64 event_coalesce_window = 512;
+
 static s64 global_timer;
 static s64 idled_cycles;
 static s64 last_global_time_ticks;
 static s64 last_global_time_us;
 
-static std::recursive_mutex external_event_section;
-
 // Warning: not included in save state.
 using AdvanceCallback = void(int cycles_executed);
 static AdvanceCallback* advance_callback = nullptr;
@@ -98,35 +127,43 @@ u64 GetGlobalTimeUs() {
     return last_global_time_us + us_since_last;
 }
 
-static Event* GetNewEvent() {
-    if (!event_pool)
-        return new Event;
-
-    Event* event = event_pool;
-    event_pool = event->next;
-    return event;
+static void PushEvent(s64 time, int type, u64 userdata) {
+    event_queue.push_back(Event{ time, event_sequence++, userdata, type });
+    std::push_heap(event_queue.begin(), event_queue.end(), EventAfter);
 }
 
-static Event* GetNewTsEvent() {
-    allocated_ts_events++;
+static Event PopEvent() {
+    std::pop_heap(event_queue.begin(), event_queue.end(), EventAfter);
+    Event evt = event_queue.back();
+    event_queue.pop_back();
+    return evt;
+}
 
-    if (!event_ts_pool)
-        return new Event;
+/**
+ * Removes every pending event matching `predicate`, restoring the heap property afterwards.
+ * @return The scheduled time of the latest-firing removed event, or 0 if none matched.
+ */
+template <typename Predicate>
+static s64 RemovePendingEvents(Predicate predicate) {
+    s64 latest_time = 0;
+    bool removed = false;
 
-    Event* event = event_ts_pool;
-    event_ts_pool = event->next;
-    return event;
-}
+    const auto it = std::remove_if(event_queue.begin(), event_queue.end(),
+        [&](const Event& evt) {
+            if (!predicate(evt))
+                return false;
+            if (!removed || evt.time > latest_time)
+                latest_time = evt.time;
+            removed = true;
+            return true;
+        });
 
-static void FreeEvent(Event* event) {
-    event->next = event_pool;
-    event_pool = event;
-}
+    if (removed) {
+        event_queue.erase(it, event_queue.end());
+        std::make_heap(event_queue.begin(), event_queue.end(), EventAfter);
+    }
 
-static void FreeTsEvent(Event* event) {
-    event->next = event_ts_pool;
-    event_ts_pool = event;
-    allocated_ts_events--;
+    return removed ? latest_time : 0;
 }
 
 int RegisterEvent(const char* name, TimedCallback callback) {
@@ -147,7 +184,7 @@ void RestoreRegisterEvent(int event_type, const char* name, TimedCallback callba
 }
 
 void UnregisterAllEvents() {
-    if (first)
+    if (!event_queue.empty())
         LOG_ERROR(Core_Timing, "Cannot unregister events with events pending");
     event_types.clear();
 }
@@ -159,16 +196,15 @@ void Init() {
     idled_cycles = 0;
     last_global_time_ticks = 0;
     last_global_time_us = 0;
-    has_ts_events = 0;
+    has_ts_events = false;
     mhz_change_callbacks.clear();
 
-    first = nullptr;
-    ts_first = nullptr;
-    ts_last = nullptr;
+    event_queue.clear();
+    event_queue.reserve(128);
+    event_sequence = 0;
 
-    event_pool = nullptr;
-    event_ts_pool = nullptr;
-    allocated_ts_events = 0;
+    ts_write = 0;
+    ts_read = 0;
 
     advance_callback = nullptr;
 }
@@ -178,18 +214,7 @@ void Shutdown() {
     ClearPendingEvents();
     UnregisterAllEvents();
 
-    while (event_pool) {
-        Event* event = event_pool;
-        event_pool = event->next;
-        delete event;
-    }
-
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    while (event_ts_pool) {
-        Event* event = event_ts_pool;
-        event_ts_pool = event->next;
-        delete event;
-    }
+    std::vector<Event>().swap(event_queue);
 }
 
 u64 GetTicks() {
@@ -204,19 +229,31 @@ u64 GetIdleTicks() {
 // This is to be called when outside threads, such as the graphics thread, wants to
 // schedule things to be executed on the main thread.
 void ScheduleEvent_Threadsafe(s64 cycles_into_future, int event_type, u64 userdata) {
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    Event* new_event = GetNewTsEvent();
-    new_event->time = GetTicks() + cycles_into_future;
-    new_event->type = event_type;
-    new_event->next = nullptr;
-    new_event->userdata = userdata;
-    if (!ts_first)
-        ts_first = new_event;
-    if (ts_last)
-        ts_last->next = new_event;
-    ts_last = new_event;
+    std::lock_guard<std::mutex> lock(ts_producer_lock);
+
+    const size_t write = ts_write.load(std::memory_order_relaxed);
+    unsigned spins = 0;
+    while (write - ts_read.load(std::memory_order_acquire) >= TS_QUEUE_SIZE) {
+        // Only the CPU thread drains the ring, so waiting for space on that thread would
+        // deadlock; it can simply drain in place instead (MoveEvents does not take the
+        // producer lock held here).
+        if (std::this_thread::get_id() == ts_consumer_thread.load(std::memory_order_relaxed)) {
+            MoveEvents();
+            continue;
+        }
 
-    has_ts_events = true;
+        // On any other thread the CPU thread drains the ring every Advance, so this
+        // resolves quickly -- unless emulation is paused, which the log makes diagnosable.
+        if (++spins == 10000)
+            LOG_ERROR(Core_Timing,
+                      "Threadsafe event ring full and not draining; is emulation paused?");
+        std::this_thread::yield();
+    }
+
+    ts_queue[write & (TS_QUEUE_SIZE - 1)] = TsEvent{ (s64)GetTicks() + cycles_into_future, userdata, event_type };
+    ts_write.store(write + 1, std::memory_order_release);
+
+    has_ts_events.store(true, std::memory_order_release);
 }
 
 // Same as ScheduleEvent_Threadsafe(0, ...) EXCEPT if we are already on the CPU thread
@@ -224,7 +261,6 @@ void ScheduleEvent_Threadsafe(s64 cycles_into_future, int event_type, u64 userda
 void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata) {
     if (false) //Core::IsCPUThread())
     {
-        std::lock_guard<std::recursive_mutex> lock(external_event_section);
         event_types[event_type].callback(userdata, 0);
     }
     else
@@ -232,115 +268,25 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata) {
 }
 
 void ClearPendingEvents() {
-    while (first) {
-        Event* event = first->next;
-        FreeEvent(first);
-        first = event;
-    }
-}
-
-static void AddEventToQueue(Event* new_event) {
-    Event* prev_event = nullptr;
-    Event** next_event = &first;
-    for (;;) {
-        Event*& next = *next_event;
-        if (!next || new_event->time < next->time) {
-            new_event->next = next;
-            next = new_event;
-            break;
-        }
-        prev_event = next;
-        next_event = &prev_event->next;
-    }
+    event_queue.clear();
 }
 
 void ScheduleEvent(s64 cycles_into_future, int event_type, u64 userdata) {
-    Event* new_event = GetNewEvent();
-    new_event->userdata = userdata;
-    new_event->type = event_type;
-    new_event->time = GetTicks() + cycles_into_future;
-    AddEventToQueue(new_event);
+    PushEvent(GetTicks() + cycles_into_future, event_type, userdata);
 }
 
 s64 UnscheduleEvent(int event_type, u64 userdata) {
-    s64 result = 0;
-    if (!first)
-        return result;
-    while (first) {
-        if (first->type == event_type && first->userdata == userdata) {
-            result = first->time - GetTicks();
-
-            Event* next = first->next;
-            FreeEvent(first);
-            first = next;
-        } else {
-            break;
-        }
-    }
-    if (!first)
-        return result;
-
-    Event* prev_event = first;
-    Event* ptr = prev_event->next;
-
-    while (ptr) {
-        if (ptr->type == event_type && ptr->userdata == userdata) {
-            result = ptr->time - GetTicks();
-
-            prev_event->next = ptr->next;
-            FreeEvent(ptr);
-            ptr = prev_event->next;
-        } else {
-            prev_event = ptr;
-            ptr = ptr->next;
-        }
-    }
-
-    return result;
+    const s64 latest_time = RemovePendingEvents([&](const Event& evt) {
+        return evt.type == event_type && evt.userdata == userdata;
+    });
+    return latest_time != 0 ? latest_time - GetTicks() : 0;
 }
 
 s64 UnscheduleThreadsafeEvent(int event_type, u64 userdata) {
-    s64 result = 0;
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    if (!ts_first)
-        return result;
-
-    while (ts_first) {
-        if (ts_first->type == event_type && ts_first->userdata == userdata) {
-            result = ts_first->time - GetTicks();
-
-            Event* next = ts_first->next;
-            FreeTsEvent(ts_first);
-            ts_first = next;
-        } else {
-            break;
-        }
-    }
-
-    if (!ts_first)
-    {
-        ts_last = nullptr;
-        return result;
-    }
-
-    Event* prev_event = ts_first;
-    Event* next = prev_event->next;
-    while (next) {
-        if (next->type == event_type && next->userdata == userdata) {
-            result = next->time - GetTicks();
-
-            prev_event->next = next->next;
-            if (next == ts_last)
-                ts_last = prev_event;
-            FreeTsEvent(next);
-            next = prev_event->next;
-        } else {
-            prev_event = next;
-            next = next->next;
-        }
-    }
-
-    return result;
+    // Threadsafe events live in the MPSC ring only until the CPU thread drains them; this
+    // function is CPU-thread-only, so drain first and remove from the main queue.
+    MoveEvents();
+    return UnscheduleEvent(event_type, userdata);
 }
 
 // Warning: not included in save state.
@@ -353,79 +299,21 @@ void RegisterMHzChangeCallback(MHzChangeCallback callback) {
 }
 
 bool IsScheduled(int event_type) {
-    if (!first)
-        return false;
-    Event* event = first;
-    while (event) {
-        if (event->type == event_type)
-            return true;
-        event = event->next;
-    }
-    return false;
+    return std::any_of(event_queue.begin(), event_queue.end(), [&](const Event& evt) {
+        return evt.type == event_type;
+    });
 }
 
 void RemoveEvent(int event_type) {
-    if (!first)
-        return;
-    while (first) {
-        if (first->type == event_type) {
-            Event *next = first->next;
-            FreeEvent(first);
-            first = next;
-        } else {
-            break;
-        }
-    }
-    if (!first)
-        return;
-    Event* prev = first;
-    Event* next = prev->next;
-    while (next) {
-        if (next->type == event_type) {
-            prev->next = next->next;
-            FreeEvent(next);
-            next = prev->next;
-        } else {
-            prev = next;
-            next = next->next;
-        }
-    }
+    RemovePendingEvents([&](const Event& evt) {
+        return evt.type == event_type;
+    });
 }
 
 void RemoveThreadsafeEvent(int event_type) {
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    if (!ts_first)
-        return;
-
-    while (ts_first) {
-        if (ts_first->type == event_type) {
-            Event* next = ts_first->next;
-            FreeTsEvent(ts_first);
-            ts_first = next;
-        } else {
-            break;
-        }
-    }
-
-    if (!ts_first) {
-        ts_last = nullptr;
-        return;
-    }
-
-    Event* prev = ts_first;
-    Event* next = prev->next;
-    while (next) {
-        if (next->type == event_type) {
-            prev->next = next->next;
-            if (next == ts_last)
-                ts_last = prev;
-            FreeTsEvent(next);
-            next = prev->next;
-        } else {
-            prev = next;
-            next = next->next;
-        }
-    }
+    // See UnscheduleThreadsafeEvent for why draining suffices.
+    MoveEvents();
+    RemoveEvent(event_type);
 }
 
 void RemoveAllEvents(int event_type) {
@@ -433,40 +321,31 @@ void RemoveAllEvents(int event_type) {
     RemoveEvent(event_type);
 }
 
+void SetEventCoalesceWindow(int cycles) {
+    event_coalesce_window = cycles;
+}
+
 // This raise only the events required while the fifo is processing data
 void ProcessFifoWaitEvents() {
-    while (first) {
-        if (first->time <= (s64)GetTicks()) {
-            Event* evt = first;
-            first = first->next;
-            event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
-            FreeEvent(evt);
-        } else {
-            break;
-        }
+    while (!event_queue.empty() && event_queue.front().time <= (s64)GetTicks()) {
+        Event evt = PopEvent();
+        event_types[evt.type].callback(evt.userdata, (int)(GetTicks() - evt.time));
     }
 }
 
 void MoveEvents() {
-    has_ts_events = false;
-
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    // Move events from async queue into main queue
-    while (ts_first) {
-        Event* next = ts_first->next;
-        AddEventToQueue(ts_first);
-        ts_first = next;
-    }
-    ts_last = nullptr;
-
-    // Move free events to threadsafe pool
-    while (allocated_ts_events > 0 && event_pool) {
-        Event* event = event_pool;
-        event_pool = event->next;
-        event->next = event_ts_pool;
-        event_ts_pool = event;
-        allocated_ts_events--;
+    ts_consumer_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    has_ts_events.store(false, std::memory_order_relaxed);
+
+    // Drain the MPSC ring into the main queue. Only this thread moves ts_read.
+    const size_t write = ts_write.load(std::memory_order_acquire);
+    size_t read = ts_read.load(std::memory_order_relaxed);
+    while (read != write) {
+        const TsEvent& evt = ts_queue[read & (TS_QUEUE_SIZE - 1)];
+        PushEvent(evt.time, evt.type, evt.userdata);
+        read++;
     }
+    ts_read.store(read, std::memory_order_release);
 }
 
 void ForceCheck() {
@@ -483,18 +362,26 @@ void Advance() {
     global_timer += cycles_executed;
     Core::g_app_core->down_count = g_slice_length;
 
-    if (has_ts_events)
+    if (has_ts_events.load(std::memory_order_acquire))
         MoveEvents();
-    ProcessFifoWaitEvents();
 
-    if (!first) {
+    // Fire everything that is due, plus anything due within the coalescing window, so the
+    // slice granted below covers the whole cluster. Lateness stays relative to the event's
+    // scheduled time and may be negative for coalesced-in events.
+    while (!event_queue.empty() &&
+           event_queue.front().time <= (s64)GetTicks() + event_coalesce_window) {
+        Event evt = PopEvent();
+        event_types[evt.type].callback(evt.userdata, (int)(GetTicks() - evt.time));
+    }
+
+    if (event_queue.empty()) {
         if (g_slice_length < 10000) {
             g_slice_length += 10000;
             Core::g_app_core->down_count += g_slice_length;
         }
     } else {
         // Note that events can eat cycles as well.
-        int target = (int)(first->time - global_timer);
+        int target = (int)(event_queue.front().time - global_timer);
         if (target > MAX_SLICE_LENGTH)
             target = MAX_SLICE_LENGTH;
 
@@ -507,10 +394,9 @@ void Advance() {
 }
 
 void LogPendingEvents() {
-    Event* event = first;
-    while (event) {
-        //LOG_TRACE(Core_Timing, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer, next->time, next->type);
-        event = event->next;
+    for (const Event& evt : event_queue) {
+        (void)evt;
+        //LOG_TRACE(Core_Timing, "PENDING: Now: %lld Pending: %lld Type: %d", global_timer, evt.time, evt.type);
     }
 }
 
@@ -519,9 +405,9 @@ void Idle(int max_idle) {
     if (max_idle != 0 && cycles_down > max_idle)
         cycles_down = max_idle;
 
-    if (first && cycles_down > 0) {
+    if (!event_queue.empty() && cycles_down > 0) {
         s64 cycles_executed = g_slice_length - Core::g_app_core->down_count;
-        s64 cycles_next_event = first->time - global_timer;
+        s64 cycles_next_event = event_queue.front().time - global_timer;
 
         if (cycles_next_event < cycles_executed + cycles_down) {
             cycles_down = cycles_next_event - cycles_executed;
@@ -540,19 +426,22 @@ void Idle(int max_idle) {
 }
 
 std::string GetScheduledEventsSummary() {
-    Event* event = first;
+    std::vector<Event> sorted = event_queue;
+    std::sort(sorted.begin(), sorted.end(), [](const Event& lhs, const Event& rhs) {
+        return std::tie(lhs.time, lhs.sequence) < std::tie(rhs.time, rhs.sequence);
+    });
+
     std::string text = "Scheduled events\n";
     text.reserve(1000);
-    while (event) {
-        unsigned int t = event->type;
+    for (const Event& evt : sorted) {
+        unsigned int t = evt.type;
         if (t >= event_types.size())
             LOG_ERROR(Core_Timing, "Invalid event type"); // %i", t);
-        const char* name = event_types[event->type].name;
+        const char* name = event_types[evt.type].name;
         if (!name)
             name = "[unknown]";
-        text += Common::StringFromFormat("%s : %i %08x%08x\n", name, (int)event->time,
-                (u32)(event->userdata >> 32), (u32)(event->userdata));
-        event = event->next;
+        text += Common::StringFromFormat("%s : %i %08x%08x\n", name, (int)evt.time,
+                (u32)(evt.userdata >> 32), (u32)(evt.userdata));
     }
     return text;
 }
@@ -113,6 +113,16 @@ void RemoveEvent(int event_type);
 void RemoveThreadsafeEvent(int event_type);
 void RemoveAllEvents(int event_type);
 bool IsScheduled(int event_type);
+/**
+ * Sets the event coalescing window used by Advance. Events due within this many cycles of
+ * the current time are fired together in one Advance pass instead of each one ending the
+ * CPU slice, cutting the main-loop exit/reentry churn when several periodic events (VBlank,
+ * audio tick, kernel timers) cluster around a frame boundary. A window of 0 disables
+ * coalescing. Events still receive their true (possibly negative) lateness, so periodic
+ * callbacks that reschedule relative to it keep their long-term cadence.
+ */
+void SetEventCoalesceWindow(int cycles);
+
 /// Runs any pending events and updates downcount for the next slice of cycles
 void Advance();
 void MoveEvents();
@@ -99,6 +99,26 @@ std::u16string Path::AsU16Str() const {
     }
 }
 
+std::string Path::BuildCacheKey() const {
+    std::string key(1, static_cast<char>(type));
+    switch (GetType()) {
+    case Char:
+        key.append(string);
+        break;
+    case Wchar:
+        key.append(reinterpret_cast<const char*>(u16str.data()), u16str.size() * sizeof(char16_t));
+        break;
+    case Binary:
+        key.append(binary.begin(), binary.end());
+        break;
+    case Empty:
+    case Invalid:
+    default:
+        break;
+    }
+    return key;
+}
+
 std::vector<u8> Path::AsBinary() const {
     switch (GetType()) {
     case Binary:
@@ -56,6 +56,12 @@ public:
     std::u16string AsU16Str() const;
     std::vector<u8> AsBinary() const;
 
+    /**
+     * Builds a cheap, stable key identifying this path for use in resolution caches: the type
+     * tag followed by the raw path bytes, with no encoding conversion performed.
+     */
+    std::string BuildCacheKey() const;
+
 private:
     LowPathType type;
     std::vector<u8> binary;
@@ -84,7 +84,7 @@ ResultVal<std::unique_ptr<ArchiveBackend>> ArchiveFactory_ExtSaveData::Open(cons
                               ErrorSummary::InvalidState, ErrorLevel::Status);
         }
     }
-    auto archive = std::make_unique<DiskArchive>(fullpath);
+    auto archive = std::make_unique<DiskArchive>(fullpath, true);
     return MakeResult<std::unique_ptr<ArchiveBackend>>(std::move(archive));
 }
 
@@ -53,7 +53,7 @@ ResultVal<std::unique_ptr<ArchiveBackend>> ArchiveFactory_SaveData::Open(const P
             ErrorSummary::InvalidState, ErrorLevel::Status);
     }
 
-    auto archive = std::make_unique<DiskArchive>(std::move(concrete_mount_point));
+    auto archive = std::make_unique<DiskArchive>(std::move(concrete_mount_point), true);
     return MakeResult<std::unique_ptr<ArchiveBackend>>(std::move(archive));
 }
 
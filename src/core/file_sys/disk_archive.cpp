@@ -11,59 +11,92 @@
 #include "common/logging/log.h"
 
 #include "core/file_sys/disk_archive.h"
+#include "core/file_sys/write_behind.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
 
 namespace FileSys {
 
+/// stdio buffer size used for files opened through the archive, in bytes
+static const size_t BUFFER_SIZE = 64 * 1024;
+
+const DiskArchive::ResolvedPath& DiskArchive::ResolvePath(const Path& path) const {
+    std::string key = path.BuildCacheKey();
+    auto itr = path_cache.find(key);
+    if (itr != path_cache.end())
+        return itr->second;
+
+    ResolvedPath resolved;
+    resolved.host_path = mount_point + path.AsString();
+    resolved.is_directory = FileUtil::IsDirectory(resolved.host_path);
+    resolved.exists = resolved.is_directory || FileUtil::Exists(resolved.host_path);
+    return path_cache.emplace(std::move(key), std::move(resolved)).first->second;
+}
+
+void DiskArchive::InvalidatePath(const Path& path) const {
+    path_cache.erase(path.BuildCacheKey());
+}
+
 ResultVal<std::unique_ptr<FileBackend>> DiskArchive::OpenFile(const Path& path, const Mode mode) const {
     LOG_DEBUG(Service_FS, "called path=%s mode=%01X", path.DebugStr().c_str(), mode.hex);
     auto file = std::make_unique<DiskFile>(*this, path, mode);
     ResultCode result = file->Open();
     if (result.IsError())
         return result;
+    // Opening with the create flag may have created the file; drop the stale stat.
+    if (mode.create_flag)
+        InvalidatePath(path);
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(file));
 }
 
 ResultCode DiskArchive::DeleteFile(const Path& path) const {
-    std::string file_path = mount_point + path.AsString();
+    const ResolvedPath resolved = ResolvePath(path);
 
-    if (FileUtil::IsDirectory(file_path))
+    if (resolved.is_directory)
         return ResultCode(ErrorDescription::FS_NotAFile, ErrorModule::FS, ErrorSummary::Canceled, ErrorLevel::Status);
 
-    if (!FileUtil::Exists(file_path))
+    if (!resolved.exists)
         return ResultCode(ErrorDescription::FS_NotFound, ErrorModule::FS, ErrorSummary::NotFound, ErrorLevel::Status);
 
-    if (FileUtil::Delete(file_path))
+    InvalidatePath(path);
+    if (FileUtil::Delete(resolved.host_path))
         return RESULT_SUCCESS;
 
     return ResultCode(ErrorDescription::FS_NotAFile, ErrorModule::FS, ErrorSummary::Canceled, ErrorLevel::Status);
 }
 
 bool DiskArchive::RenameFile(const Path& src_path, const Path& dest_path) const {
-    return FileUtil::Rename(mount_point + src_path.AsString(), mount_point + dest_path.AsString());
+    const std::string src_host = ResolvePath(src_path).host_path;
+    const std::string dest_host = ResolvePath(dest_path).host_path;
+    InvalidatePath(src_path);
+    InvalidatePath(dest_path);
+    return FileUtil::Rename(src_host, dest_host);
 }
 
 bool DiskArchive::DeleteDirectory(const Path& path) const {
-    return FileUtil::DeleteDir(mount_point + path.AsString());
+    const std::string host_path = ResolvePath(path).host_path;
+    InvalidatePath(path);
+    return FileUtil::DeleteDir(host_path);
 }
 
 ResultCode DiskArchive::CreateFile(const FileSys::Path& path, u64 size) const {
-    std::string full_path = mount_point + path.AsString();
+    const ResolvedPath resolved = ResolvePath(path);
 
-    if (FileUtil::IsDirectory(full_path))
+    if (resolved.is_directory)
         return ResultCode(ErrorDescription::FS_NotAFile, ErrorModule::FS, ErrorSummary::Canceled, ErrorLevel::Status);
 
-    if (FileUtil::Exists(full_path))
+    if (resolved.exists)
         return ResultCode(ErrorDescription::FS_AlreadyExists, ErrorModule::FS, ErrorSummary::NothingHappened, ErrorLevel::Status);
 
+    InvalidatePath(path);
+
     if (size == 0) {
-        FileUtil::CreateEmptyFile(full_path);
+        FileUtil::CreateEmptyFile(resolved.host_path);
         return RESULT_SUCCESS;
     }
 
-    FileUtil::IOFile file(full_path, "wb");
+    FileUtil::IOFile file(resolved.host_path, "wb");
     // Creates a sparse file (or a normal file on filesystems without the concept of sparse files)
     // We do this by seeking to the right size, then writing a single null byte.
     if (file.Seek(size - 1, SEEK_SET) && file.WriteBytes("", 1) == 1)
@@ -74,11 +107,17 @@ ResultCode DiskArchive::CreateFile(const FileSys::Path& path, u64 size) const {
 
 
 bool DiskArchive::CreateDirectory(const Path& path) const {
-    return FileUtil::CreateDir(mount_point + path.AsString());
+    const std::string host_path = ResolvePath(path).host_path;
+    InvalidatePath(path);
+    return FileUtil::CreateDir(host_path);
 }
 
 bool DiskArchive::RenameDirectory(const Path& src_path, const Path& dest_path) const {
-    return FileUtil::Rename(mount_point + src_path.AsString(), mount_point + dest_path.AsString());
+    const std::string src_host = ResolvePath(src_path).host_path;
+    const std::string dest_host = ResolvePath(dest_path).host_path;
+    InvalidatePath(src_path);
+    InvalidatePath(dest_path);
+    return FileUtil::Rename(src_host, dest_host);
 }
 
 std::unique_ptr<DirectoryBackend> DiskArchive::OpenDirectory(const Path& path) const {
@@ -100,12 +139,22 @@ DiskFile::DiskFile(const DiskArchive& archive, const Path& path, const Mode mode
     // TODO(Link Mauve): normalize path into an absolute path without "..", it can currently bypass
     // the root directory we set while opening the archive.
     // For example, opening /../../etc/passwd can give the emulated program your users list.
-    this->path = archive.mount_point + path.AsString();
+    const DiskArchive::ResolvedPath& resolved = archive.ResolvePath(path);
+    this->path = resolved.host_path;
+    this->path_exists = resolved.exists;
+    this->path_is_directory = resolved.is_directory;
+    this->write_behind = archive.write_behind;
     this->mode.hex = mode.hex;
 }
 
+DiskFile::~DiskFile() {
+    // Apply any journaled writes before the IOFile (and its FILE*) is destroyed.
+    if (write_behind && file != nullptr)
+        WriteBehind::DrainFile(file.get());
+}
+
 ResultCode DiskFile::Open() {
-    if (FileUtil::IsDirectory(path))
+    if (path_is_directory)
         return ResultCode(ErrorDescription::FS_NotAFile, ErrorModule::FS, ErrorSummary::Canceled, ErrorLevel::Status);
 
     // Specifying only the Create flag is invalid
@@ -113,7 +162,7 @@ ResultCode DiskFile::Open() {
         return ResultCode(ErrorDescription::FS_InvalidOpenFlags, ErrorModule::FS, ErrorSummary::Canceled, ErrorLevel::Status);
     }
 
-    if (!FileUtil::Exists(path)) {
+    if (!path_exists) {
         if (!mode.create_flag) {
             LOG_ERROR(Service_FS, "Non-existing file %s can't be open without mode create.", path.c_str());
             return ResultCode(ErrorDescription::FS_NotFound, ErrorModule::FS, ErrorSummary::NotFound, ErrorLevel::Status);
@@ -133,8 +182,11 @@ ResultCode DiskFile::Open() {
     mode_string += "b";
 
     file = std::make_unique<FileUtil::IOFile>(path, mode_string.c_str());
-    if (file->IsOpen())
+    if (file->IsOpen()) {
+        // Widen the stdio buffer so sequential guest reads are served from fewer host requests
+        file->SetBufferSize(BUFFER_SIZE);
         return RESULT_SUCCESS;
+    }
     return ResultCode(ErrorDescription::FS_NotFound, ErrorModule::FS, ErrorSummary::NotFound, ErrorLevel::Status);
 }
 
@@ -142,46 +194,71 @@ ResultVal<size_t> DiskFile::Read(const u64 offset, const size_t length, u8* buff
     if (!mode.read_flag && !mode.write_flag)
         return ResultCode(ErrorDescription::FS_InvalidOpenFlags, ErrorModule::FS, ErrorSummary::Canceled, ErrorLevel::Status);
 
-    file->Seek(offset, SEEK_SET);
-    return MakeResult<size_t>(file->ReadBytes(buffer, length));
+    if (write_behind)
+        WriteBehind::DrainFile(file.get());
+
+    return MakeResult<size_t>(file->ReadAt(buffer, length, offset));
 }
 
 ResultVal<size_t> DiskFile::Write(const u64 offset, const size_t length, const bool flush, const u8* buffer) const {
     if (!mode.write_flag)
         return ResultCode(ErrorDescription::FS_InvalidOpenFlags, ErrorModule::FS, ErrorSummary::Canceled, ErrorLevel::Status);
 
-    file->Seek(offset, SEEK_SET);
-    size_t written = file->WriteBytes(buffer, length);
+    // Games autosave in bursts of small writes; journal them instead of blocking on host I/O.
+    // Writes with the flush flag set ask for durability now, so they stay synchronous.
+    if (write_behind && !flush) {
+        if (WriteBehind::Enqueue(file.get(), offset, std::vector<u8>(buffer, buffer + length)))
+            return MakeResult<size_t>(length);
+    }
+
+    if (write_behind)
+        WriteBehind::DrainFile(file.get());
+
+    size_t written = file->WriteAt(buffer, length, offset);
     if (flush)
         file->Flush();
     return MakeResult<size_t>(written);
 }
 
 u64 DiskFile::GetSize() const {
+    if (write_behind)
+        WriteBehind::DrainFile(file.get());
     return file->GetSize();
 }
 
 bool DiskFile::SetSize(const u64 size) const {
+    if (write_behind)
+        WriteBehind::DrainFile(file.get());
     file->Resize(size);
     file->Flush();
     return true;
 }
 
 bool DiskFile::Close() const {
+    if (write_behind)
+        WriteBehind::DrainFile(file.get());
     return file->Close();
 }
 
+void DiskFile::Flush() const {
+    if (write_behind)
+        WriteBehind::DrainFile(file.get());
+    file->Flush();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 DiskDirectory::DiskDirectory(const DiskArchive& archive, const Path& path) : directory() {
     // TODO(Link Mauve): normalize path into an absolute path without "..", it can currently bypass
     // the root directory we set while opening the archive.
     // For example, opening /../../usr/bin can give the emulated program your installed programs.
-    this->path = archive.mount_point + path.AsString();
+    const DiskArchive::ResolvedPath& resolved = archive.ResolvePath(path);
+    this->path = resolved.host_path;
+    this->path_is_directory = resolved.is_directory;
 }
 
 bool DiskDirectory::Open() {
-    if (!FileUtil::IsDirectory(path))
+    if (!path_is_directory)
         return false;
     unsigned size = FileUtil::ScanDirectoryTree(path, directory);
     directory.size = size;
@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "common/common_types.h"
@@ -29,7 +30,13 @@ namespace FileSys {
  */
 class DiskArchive : public ArchiveBackend {
 public:
-    DiskArchive(const std::string& mount_point_) : mount_point(mount_point_) {}
+    /**
+     * @param mount_point_ Base directory on the host filesystem
+     * @param write_behind_ If true, file writes are deferred to the write-behind journal instead
+     *                      of hitting host I/O on the emulation thread (used for save archives)
+     */
+    DiskArchive(const std::string& mount_point_, bool write_behind_ = false)
+        : mount_point(mount_point_), write_behind(write_behind_) {}
 
     virtual std::string GetName() const override { return "DiskArchive: " + mount_point; }
 
@@ -43,17 +50,40 @@ public:
     std::unique_ptr<DirectoryBackend> OpenDirectory(const Path& path) const override;
     u64 GetFreeBytes() const override;
 
+    /// Cached result of resolving a guest path against this archive's mount point.
+    struct ResolvedPath {
+        std::string host_path;
+        bool exists;
+        bool is_directory;
+    };
+
+    /**
+     * Resolves a guest path to a host path plus stat metadata, consulting a cache keyed on the
+     * raw path bytes first. Titles reopen the same files constantly; cache hits skip the UTF16
+     * conversion and the host stat calls entirely.
+     */
+    const ResolvedPath& ResolvePath(const Path& path) const;
+
+    /// Drops a path's cache entry. Must be called whenever the entry's host file is mutated.
+    void InvalidatePath(const Path& path) const;
+
 protected:
     friend class DiskFile;
     friend class DiskDirectory;
 
     std::string mount_point;
+    bool write_behind;
+
+    /// Cache of path resolutions, keyed on Path::BuildCacheKey().
+    mutable std::unordered_map<std::string, ResolvedPath> path_cache;
 };
 
 class DiskFile : public FileBackend {
 public:
     DiskFile(const DiskArchive& archive, const Path& path, const Mode mode);
 
+    ~DiskFile() override;
+
     ResultCode Open() override;
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
@@ -61,12 +91,13 @@ public:
     bool SetSize(u64 size) const override;
     bool Close() const override;
 
-    void Flush() const override {
-        file->Flush();
-    }
+    void Flush() const override;
 
 protected:
     std::string path;
+    bool path_exists;
+    bool path_is_directory;
+    bool write_behind;
     Mode mode;
     std::unique_ptr<FileUtil::IOFile> file;
 };
@@ -88,6 +119,7 @@ public:
 
 protected:
     std::string path;
+    bool path_is_directory;
     u32 total_entries_in_directory;
     FileUtil::FSTEntry directory;
 
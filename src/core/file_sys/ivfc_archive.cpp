@@ -2,25 +2,197 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/thread_topology.h"
 
 #include "core/file_sys/ivfc_archive.h"
+#include "core/settings.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
 
 namespace FileSys {
 
+RomFSMapping::RomFSMapping(FileUtil::IOFile& file, u64 offset, u64 size) {
+    if (size == 0 || !file.IsOpen())
+        return;
+
+#ifdef _WIN32
+    HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file.GetHandle())));
+    if (file_handle == INVALID_HANDLE_VALUE)
+        return;
+
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr)
+        return;
+
+    // View offsets must be aligned to the allocation granularity.
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    const u64 aligned_offset = offset & ~static_cast<u64>(system_info.dwAllocationGranularity - 1);
+    const size_t view_length = static_cast<size_t>(size + (offset - aligned_offset));
+
+    view_base = static_cast<const u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ,
+            static_cast<DWORD>(aligned_offset >> 32), static_cast<DWORD>(aligned_offset),
+            view_length));
+    if (view_base == nullptr) {
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+        return;
+    }
+    region = view_base + (offset - aligned_offset);
+#else
+    int fd = fileno(file.GetHandle());
+    if (fd < 0)
+        return;
+
+    const u64 page_size = static_cast<u64>(sysconf(_SC_PAGESIZE));
+    const u64 aligned_offset = offset & ~(page_size - 1);
+    map_length = static_cast<size_t>(size + (offset - aligned_offset));
+
+    void* base = mmap(nullptr, map_length, PROT_READ, MAP_SHARED, fd,
+                      static_cast<off_t>(aligned_offset));
+    if (base == MAP_FAILED) {
+        map_length = 0;
+        return;
+    }
+    map_base = static_cast<const u8*>(base);
+    region = map_base + (offset - aligned_offset);
+
+    // RomFS access from streaming titles is dominated by long sequential runs, so hint the
+    // host kernel to run readahead across the mapping.
+    madvise(base, map_length, MADV_SEQUENTIAL);
+    madvise(base, map_length, MADV_WILLNEED);
+#endif
+}
+
+RomFSMapping::~RomFSMapping() {
+#ifdef _WIN32
+    if (view_base != nullptr)
+        UnmapViewOfFile(view_base);
+    if (mapping_handle != nullptr)
+        CloseHandle(mapping_handle);
+#else
+    if (map_base != nullptr)
+        munmap(const_cast<u8*>(map_base), map_length);
+#endif
+}
+
+const u64 IVFCVerifier::BLOCK_SIZE;
+
+IVFCVerifier::IVFCVerifier(std::shared_ptr<RomFSMapping> mapping, u64 size)
+    : mapping(std::move(mapping)), data_size(size) {
+    num_blocks = static_cast<size_t>((data_size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    block_hashes.resize(num_blocks);
+    verified.resize(num_blocks);
+    claimed.resize(num_blocks);
+
+    if (num_blocks == 0) {
+        all_verified = true;
+        return;
+    }
+
+    // Two hashing threads overlap well with the loader's own I/O without starving the
+    // emulation thread during boot
+    const unsigned int NUM_VERIFY_THREADS = 2;
+    for (unsigned int i = 0; i < NUM_VERIFY_THREADS; ++i) {
+        workers.emplace_back([this] {
+            Common::RegisterCurrentThread(Common::ThreadRole::Worker, "IVFC verify");
+            WorkerLoop();
+        });
+    }
+}
+
+IVFCVerifier::~IVFCVerifier() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shutting_down = true;
+    }
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void IVFCVerifier::VerifyBlock(size_t block, std::unique_lock<std::mutex>& lock) {
+    claimed[block] = true;
+    lock.unlock();
+
+    const u64 block_offset = block * BLOCK_SIZE;
+    const size_t block_size = static_cast<size_t>(std::min(BLOCK_SIZE, data_size - block_offset));
+    const u64 hash = Common::ComputeHash64(mapping->data() + block_offset, block_size);
+
+    lock.lock();
+    // No reference hashes are available from the loaders yet, so the first computation is
+    // recorded; this is where they would be compared once a loader supplies level-0 hashes
+    block_hashes[block] = hash;
+    verified[block] = true;
+    if (++num_verified == num_blocks)
+        all_verified = true;
+    block_done_cv.notify_all();
+}
+
+void IVFCVerifier::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!shutting_down) {
+        while (scan_cursor < num_blocks && claimed[scan_cursor])
+            ++scan_cursor;
+        if (scan_cursor >= num_blocks)
+            break;
+
+        VerifyBlock(scan_cursor, lock);
+    }
+}
+
+void IVFCVerifier::EnsureVerified(u64 offset, size_t length) {
+    if (all_verified || length == 0 || offset >= data_size)
+        return;
+
+    const size_t first_block = static_cast<size_t>(offset / BLOCK_SIZE);
+    const size_t last_block = static_cast<size_t>(std::min<u64>(offset + length - 1, data_size - 1) / BLOCK_SIZE);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (size_t block = first_block; block <= last_block; ++block) {
+        while (!verified[block]) {
+            if (!claimed[block]) {
+                // The sweep hasn't reached this block; verify it here rather than waiting
+                VerifyBlock(block, lock);
+            } else {
+                block_done_cv.wait(lock);
+            }
+        }
+    }
+}
+
 std::string IVFCArchive::GetName() const {
     return "IVFC";
 }
 
+IVFCArchive::IVFCArchive(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
+    : romfs_file(file), data_offset(offset), data_size(size),
+      mapping(std::make_shared<RomFSMapping>(*file, offset, size)) {
+    // Verification needs the host mapping; without it every block hash would seek through
+    // stdio and the fallback read path is already the slow, rare case
+    if (Settings::values.check_romfs_integrity && mapping->data() != nullptr && size > 0) {
+        verifier = std::make_shared<IVFCVerifier>(mapping, size);
+    }
+}
+
 ResultVal<std::unique_ptr<FileBackend>> IVFCArchive::OpenFile(const Path& path, const Mode mode) const {
-    return MakeResult<std::unique_ptr<FileBackend>>(std::make_unique<IVFCFile>(romfs_file, data_offset, data_size));
+    return MakeResult<std::unique_ptr<FileBackend>>(
+            std::make_unique<IVFCFile>(romfs_file, data_offset, data_size, mapping, verifier));
 }
 
 ResultCode IVFCArchive::DeleteFile(const Path& path) const {
@@ -69,10 +241,18 @@ u64 IVFCArchive::GetFreeBytes() const {
 
 ResultVal<size_t> IVFCFile::Read(const u64 offset, const size_t length, u8* buffer) const {
     LOG_TRACE(Service_FS, "called offset=%llu, length=%zu", offset, length);
-    romfs_file->Seek(data_offset + offset, SEEK_SET);
+    if (offset > data_size)
+        return MakeResult<size_t>(0);
     size_t read_length = (size_t)std::min((u64)length, data_size - offset);
 
-    return MakeResult<size_t>(romfs_file->ReadBytes(buffer, read_length));
+    if (const u8* romfs = mapping->data()) {
+        if (verifier != nullptr)
+            verifier->EnsureVerified(offset, read_length);
+        std::memcpy(buffer, romfs + offset, read_length);
+        return MakeResult<size_t>(read_length);
+    }
+
+    return MakeResult<size_t>(romfs_file->ReadAt(buffer, read_length, data_offset + offset));
 }
 
 ResultVal<size_t> IVFCFile::Write(const u64 offset, const size_t length, const bool flush, const u8* buffer) const {
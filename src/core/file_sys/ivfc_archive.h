@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/common_types.h"
@@ -22,6 +26,79 @@
 
 namespace FileSys {
 
+/**
+ * Shared read-only host memory mapping of the RomFS region of a container file. Created once
+ * when the archive is opened; open files then serve guest reads as bounds-checked memcpys from
+ * the mapping instead of seeking and reading through stdio for every access. If the platform
+ * mapping fails for any reason, data() returns nullptr and callers fall back to seek+read.
+ */
+class RomFSMapping : NonCopyable {
+public:
+    RomFSMapping(FileUtil::IOFile& file, u64 offset, u64 size);
+    ~RomFSMapping();
+
+    /// Pointer to the first byte of the RomFS region, or nullptr if mapping was unavailable.
+    const u8* data() const { return region; }
+
+private:
+    const u8* region = nullptr;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+    const u8* view_base = nullptr;
+#else
+    const u8* map_base = nullptr;
+    size_t map_length = 0;
+#endif
+};
+
+/**
+ * Background integrity checker for the RomFS region of a container, enabled with the
+ * check_romfs_integrity setting. The region is partitioned into fixed-size blocks which a
+ * small pool of worker threads hashes independently while the title boots, maintaining a
+ * verified-block bitmap; reads consult the bitmap and verify the blocks they touch on demand
+ * so no data is ever served unverified, without waiting for the whole background sweep.
+ *
+ * The loaders do not currently parse the container's IVFC hash-tree levels, so there is no
+ * reference to compare against yet: VerifyBlock() records each block's hash on first
+ * computation and is the hook point for comparing against real level-0 hashes once a loader
+ * provides them. The parallel sweep, on-demand path and bitmap are all independent of where
+ * the expected hashes come from.
+ */
+class IVFCVerifier : NonCopyable {
+public:
+    IVFCVerifier(std::shared_ptr<RomFSMapping> mapping, u64 size);
+    ~IVFCVerifier();
+
+    /// Blocks until every block overlapping [offset, offset + length) has been verified,
+    /// verifying them on the calling thread if the background sweep hasn't reached them yet
+    void EnsureVerified(u64 offset, size_t length);
+
+private:
+    static const u64 BLOCK_SIZE = 64 * 1024;
+
+    /// Hashes one block and records the result; returns with the block marked verified
+    void VerifyBlock(size_t block, std::unique_lock<std::mutex>& lock);
+
+    /// Runs on the pool threads: claims and verifies blocks until none remain
+    void WorkerLoop();
+
+    std::shared_ptr<RomFSMapping> mapping;
+    u64 data_size;
+    size_t num_blocks;
+
+    std::vector<u64> block_hashes;  ///< Recorded (eventually: expected) per-block hashes
+    std::vector<bool> verified;     ///< Verified-block bitmap consulted by reads
+    std::vector<bool> claimed;      ///< Blocks some thread is already hashing
+    size_t scan_cursor = 0;         ///< Next block the background sweep will claim
+    size_t num_verified = 0;
+    std::atomic<bool> all_verified{false};
+    bool shutting_down = false;
+
+    std::mutex mutex;
+    std::condition_variable block_done_cv;
+    std::vector<std::thread> workers;
+};
+
 /**
  * Helper which implements an interface to deal with IVFC images used in some archives
  * This should be subclassed by concrete archive types, which will provide the
@@ -29,8 +106,7 @@ namespace FileSys {
  */
 class IVFCArchive : public ArchiveBackend {
 public:
-    IVFCArchive(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
-        : romfs_file(file), data_offset(offset), data_size(size) {}
+    IVFCArchive(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size);
 
     std::string GetName() const override;
 
@@ -48,12 +124,16 @@ protected:
     std::shared_ptr<FileUtil::IOFile> romfs_file;
     u64 data_offset;
     u64 data_size;
+    std::shared_ptr<RomFSMapping> mapping;
+    std::shared_ptr<IVFCVerifier> verifier;
 };
 
 class IVFCFile : public FileBackend {
 public:
-    IVFCFile(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
-        : romfs_file(file), data_offset(offset), data_size(size) {}
+    IVFCFile(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size,
+             std::shared_ptr<RomFSMapping> mapping, std::shared_ptr<IVFCVerifier> verifier)
+        : romfs_file(file), data_offset(offset), data_size(size), mapping(std::move(mapping)),
+          verifier(std::move(verifier)) {}
 
     ResultCode Open() override { return RESULT_SUCCESS; }
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
@@ -67,6 +147,8 @@ private:
     std::shared_ptr<FileUtil::IOFile> romfs_file;
     u64 data_offset;
     u64 data_size;
+    std::shared_ptr<RomFSMapping> mapping;
+    std::shared_ptr<IVFCVerifier> verifier;
 };
 
 class IVFCDirectory : public DirectoryBackend {
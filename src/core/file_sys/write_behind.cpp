@@ -0,0 +1,143 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+
+#include "core/file_sys/write_behind.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FileSys namespace
+
+namespace FileSys {
+namespace WriteBehind {
+
+struct PendingWrite {
+    FileUtil::IOFile* file;
+    u64 offset;
+    std::vector<u8> data;
+};
+
+static std::deque<PendingWrite> write_queue;
+/// Files written since their last flush. Entries are removed by DrainFile before file close.
+static std::vector<FileUtil::IOFile*> dirty_files;
+/// The file whose write is currently being applied, so DrainFile cannot return under it.
+static FileUtil::IOFile* in_flight_file = nullptr;
+
+static std::mutex journal_mutex;
+static std::condition_variable journal_cv;      ///< Wakes the journal thread
+static std::condition_variable journal_done_cv; ///< Wakes DrainFile waiters
+static std::thread journal_thread;
+static bool journal_exit = false;
+
+/// How long the journal sits idle before flushing every dirtied file.
+static constexpr std::chrono::milliseconds flush_interval{500};
+
+// Must be called with journal_mutex held.
+static bool FileHasPendingWrites(const FileUtil::IOFile* file) {
+    if (in_flight_file == file)
+        return true;
+    return std::any_of(write_queue.begin(), write_queue.end(),
+            [file](const PendingWrite& write) { return write.file == file; });
+}
+
+// Must be called with journal_mutex held.
+static void MarkDirty(FileUtil::IOFile* file) {
+    if (std::find(dirty_files.begin(), dirty_files.end(), file) == dirty_files.end())
+        dirty_files.push_back(file);
+}
+
+// Must be called with journal_mutex held. DrainFile holds the mutex while files are closed,
+// so every pointer in dirty_files is still valid here.
+static void FlushDirtyFiles() {
+    for (FileUtil::IOFile* file : dirty_files)
+        file->Flush();
+    dirty_files.clear();
+}
+
+static void JournalThread() {
+    Common::SetCurrentThreadName("FS Journal");
+
+    std::unique_lock<std::mutex> lock(journal_mutex);
+    while (true) {
+        if (write_queue.empty()) {
+            // Idle: flush what has accumulated, then sleep until new work or the next period.
+            FlushDirtyFiles();
+            if (journal_exit)
+                return;
+            journal_cv.wait_for(lock, flush_interval,
+                    [] { return journal_exit || !write_queue.empty(); });
+            continue;
+        }
+
+        PendingWrite write = std::move(write_queue.front());
+        write_queue.pop_front();
+        in_flight_file = write.file;
+
+        lock.unlock();
+        // WriteAt rather than Seek+WriteBytes: it holds the file's I/O mutex, so the
+        // journal cannot interleave with a concurrent read or write on the same stream
+        if (write.file->WriteAt(write.data.data(), write.data.size(), write.offset) !=
+            write.data.size()) {
+            LOG_ERROR(Service_FS, "Deferred write of %zu bytes at offset %llu failed",
+                      write.data.size(), (unsigned long long)write.offset);
+        }
+        lock.lock();
+
+        in_flight_file = nullptr;
+        MarkDirty(write.file);
+        journal_done_cv.notify_all();
+    }
+}
+
+bool Enqueue(FileUtil::IOFile* file, u64 offset, std::vector<u8> data) {
+    {
+        std::lock_guard<std::mutex> lock(journal_mutex);
+        if (!journal_thread.joinable())
+            return false;
+        write_queue.push_back(PendingWrite{ file, offset, std::move(data) });
+    }
+    journal_cv.notify_one();
+    return true;
+}
+
+void DrainFile(FileUtil::IOFile* file) {
+    std::unique_lock<std::mutex> lock(journal_mutex);
+    journal_done_cv.wait(lock, [file] { return !FileHasPendingWrites(file); });
+
+    const auto itr = std::find(dirty_files.begin(), dirty_files.end(), file);
+    if (itr != dirty_files.end()) {
+        file->Flush();
+        dirty_files.erase(itr);
+    }
+}
+
+void Init() {
+    journal_exit = false;
+    journal_thread = std::thread(JournalThread);
+}
+
+void Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(journal_mutex);
+        journal_exit = true;
+    }
+    journal_cv.notify_one();
+    if (journal_thread.joinable())
+        journal_thread.join();
+    // The thread drains the queue and flushes before exiting, so all saves are durable here.
+    dirty_files.clear();
+    write_queue.clear();
+}
+
+} // namespace WriteBehind
+} // namespace FileSys
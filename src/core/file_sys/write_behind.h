@@ -0,0 +1,47 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace FileUtil {
+class IOFile;
+}
+
+namespace FileSys {
+
+/**
+ * Write-behind journal for save archives. Guest writes are buffered in memory and applied to
+ * the host file from a background thread, so autosave bursts cost the emulation thread only a
+ * memcpy instead of synchronous host I/O. Dirtied files are flushed periodically while the
+ * journal is idle, and DrainFile provides the ordering barrier that keeps reads, resizes and
+ * explicit flushes coherent with writes still in the queue.
+ */
+namespace WriteBehind {
+
+/**
+ * Queues a write of `data` at `offset` into `file`.
+ * @return True if the write was queued, false if the journal thread is not running and the
+ *         caller must perform the write synchronously.
+ */
+bool Enqueue(FileUtil::IOFile* file, u64 offset, std::vector<u8> data);
+
+/**
+ * Blocks until every queued write to `file` has been applied and flushed. Must be called
+ * before reading from, resizing, closing or destroying a file that uses the journal.
+ */
+void DrainFile(FileUtil::IOFile* file);
+
+/// Starts the journal thread.
+void Init();
+
+/// Applies and flushes all outstanding writes, then stops the journal thread.
+void Shutdown();
+
+} // namespace WriteBehind
+
+} // namespace FileSys
@@ -0,0 +1,65 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+
+#include "core/frame_limiter.h"
+#include "core/settings.h"
+
+namespace FrameLimiter {
+
+using Clock = std::chrono::steady_clock;
+
+/// Wall-clock duration of one emulated frame; the GPU schedules VBlank at exactly 60 Hz
+static const std::chrono::nanoseconds frame_period(1000000000ull / 60);
+
+/// Margin handed to the spin-wait; sleeps are requested only beyond this, so OS wakeup
+/// granularity (typically up to ~1 ms) never overshoots the deadline
+static const std::chrono::milliseconds spin_margin(1);
+
+/// Falling further behind than this abandons the old schedule instead of fast-forwarding
+static const auto max_lag = 4 * frame_period;
+
+static Clock::time_point next_frame_time;
+static bool deadline_valid = false;
+
+/// Settings snapshot refreshed once per frame, so the per-frame check stays a local read
+static Settings::Values settings_snapshot;
+static u32 settings_snapshot_version = 0;
+
+void Reset() {
+    deadline_valid = false;
+}
+
+void DoFrameLimiting() {
+    Settings::UpdateSnapshot(settings_snapshot, settings_snapshot_version);
+
+    if (!settings_snapshot.use_frame_limit) {
+        deadline_valid = false;
+        return;
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (!deadline_valid || now > next_frame_time + max_lag) {
+        // First frame, or emulation fell well behind (load, pause, a long stall): restart the
+        // schedule from here rather than racing through frames to catch up
+        next_frame_time = now + frame_period;
+        deadline_valid = true;
+        return;
+    }
+
+    // Sleep off all but the last millisecond, then spin for the remainder. Advancing the
+    // deadline by exactly one period per frame corrects any per-frame drift: an early frame
+    // waits longer, a slightly late one waits less.
+    while (next_frame_time - Clock::now() > spin_margin) {
+        std::this_thread::sleep_for(next_frame_time - Clock::now() - spin_margin);
+    }
+    while (Clock::now() < next_frame_time) {
+    }
+
+    next_frame_time += frame_period;
+}
+
+} // namespace FrameLimiter
@@ -0,0 +1,21 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+namespace FrameLimiter {
+
+/**
+ * Blocks until the wall clock reaches the next emulated VBlank deadline, keeping frame pacing
+ * flat without relying on driver vsync. The wait is hybrid: coarse sleeps cover all but the
+ * final fraction of the interval, which is spin-waited so OS scheduler granularity doesn't leak
+ * into the frame times. Called once per emulated frame from the VBlank handler; does nothing
+ * when the frame limit setting is disabled or emulation is running behind schedule.
+ */
+void DoFrameLimiting();
+
+/// Resets the deadline, e.g. after init or after emulation was paused
+void Reset();
+
+} // namespace FrameLimiter
@@ -670,6 +670,14 @@ static void WriteMemory() {
     }
 
     GdbHexToMem(dst, len_pos + 1, len);
+
+    // The client may have patched code that is already translated (e.g. a software
+    // breakpoint); drop just the affected blocks so it takes effect
+    if (Core::g_app_core != nullptr)
+        Core::g_app_core->InvalidateCodeRange(addr, len);
+    if (Core::g_sys_core != nullptr)
+        Core::g_sys_core->InvalidateCodeRange(addr, len);
+
     SendReply("OK");
 }
 
@@ -28,6 +28,23 @@ struct BreakpointAddress {
 /// If set to false, the server will never be started and no gdbstub-related functions will be executed.
 extern std::atomic<bool> g_server_enabled;
 
+#ifdef RELEASE_FAST
+/**
+ * Fast gate for the per-block debugger checks in the CPU loop. In release-fast builds this is
+ * constant false, so the stub is compiled out of the instruction path entirely (the server can
+ * still be toggled, but the CPU never polls it).
+ */
+constexpr bool IsServerEnabled() {
+    return false;
+}
+#else
+/// Fast gate for the per-block debugger checks in the CPU loop: a single relaxed load of the
+/// enable flag, so the common not-attached case costs one predictable branch per block.
+inline bool IsServerEnabled() {
+    return g_server_enabled.load(std::memory_order_relaxed);
+}
+#endif
+
 /**
  * Set the port the gdbstub should use to listen for connections.
  *
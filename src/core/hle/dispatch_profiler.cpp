@@ -0,0 +1,186 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/string_util.h"
+
+#include "core/hle/dispatch_profiler.h"
+
+namespace HLE {
+namespace DispatchProfiler {
+
+// Entry 0 is a sink for samples recorded before registration or after the table filled up; it
+// is counted but never reported. The capacity covers the SVC table plus every service port with
+// plenty of slack.
+static const size_t MAX_ENTRIES = 256;
+static const size_t TOP_K = 16;
+
+struct Entry {
+    std::string group;
+    std::string name;
+    std::atomic<u64> count;
+    std::atomic<u64> total_cycles;
+    std::array<std::atomic<u64>, NUM_BINS> bins;
+};
+
+/// One of the slowest invocations seen so far
+struct SlowSample {
+    u64 cycles;
+    u32 entry_index;
+    u32 guest_pc;
+    const char* detail;
+};
+
+static Entry entries[MAX_ENTRIES];
+static std::atomic<u32> num_entries{1};
+static std::mutex register_mutex;
+
+static SlowSample slowest[TOP_K];
+/// Smallest cycle count currently on the slowest-calls list; samples below it skip the lock
+static std::atomic<u64> slow_threshold{0};
+static std::mutex slowest_mutex;
+
+u64 GetCycleCount() {
+#if defined(_MSC_VER)
+    return __rdtsc();
+#elif defined(ARCHITECTURE_x86_64)
+    return __builtin_ia32_rdtsc();
+#else
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+u32 RegisterEntry(const char* group, const char* name) {
+    std::lock_guard<std::mutex> lock(register_mutex);
+
+    u32 n = num_entries.load(std::memory_order_relaxed);
+    for (u32 i = 1; i < n; ++i) {
+        if (entries[i].group == group && entries[i].name == name)
+            return i;
+    }
+    if (n >= MAX_ENTRIES)
+        return 0;
+
+    entries[n].group = group;
+    entries[n].name = name;
+    // Publish the strings before the index becomes visible to recorders
+    num_entries.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+static size_t BinIndex(u64 cycles) {
+    size_t bin = 0;
+    while (cycles > 1 && bin < NUM_BINS - 1) {
+        cycles >>= 1;
+        ++bin;
+    }
+    return bin;
+}
+
+static void ConsiderForSlowest(u64 cycles, u32 entry_index, u32 guest_pc, const char* detail) {
+    std::lock_guard<std::mutex> lock(slowest_mutex);
+
+    // Replace the smallest sample on the list and recompute the admission threshold
+    size_t min_slot = 0;
+    for (size_t i = 1; i < TOP_K; ++i) {
+        if (slowest[i].cycles < slowest[min_slot].cycles)
+            min_slot = i;
+    }
+    if (cycles <= slowest[min_slot].cycles)
+        return;
+    slowest[min_slot] = {cycles, entry_index, guest_pc, detail};
+
+    u64 new_min = slowest[0].cycles;
+    for (size_t i = 1; i < TOP_K; ++i)
+        new_min = std::min(new_min, slowest[i].cycles);
+    slow_threshold.store(new_min, std::memory_order_relaxed);
+}
+
+void Record(u32 entry_index, u64 cycles, u32 guest_pc, const char* detail) {
+    if (entry_index >= num_entries.load(std::memory_order_acquire))
+        entry_index = 0;
+    Entry& entry = entries[entry_index];
+
+    entry.bins[BinIndex(cycles)].fetch_add(1, std::memory_order_relaxed);
+    entry.count.fetch_add(1, std::memory_order_relaxed);
+    entry.total_cycles.fetch_add(cycles, std::memory_order_relaxed);
+
+    if (entry_index != 0 && cycles > slow_threshold.load(std::memory_order_relaxed))
+        ConsiderForSlowest(cycles, entry_index, guest_pc, detail);
+}
+
+void DumpJSON() {
+    std::string json = "{\n  \"entries\": [\n";
+
+    u32 n = num_entries.load(std::memory_order_acquire);
+    bool first = true;
+    for (u32 i = 1; i < n; ++i) {
+        const Entry& entry = entries[i];
+        u64 count = entry.count.load(std::memory_order_relaxed);
+        if (count == 0)
+            continue;
+
+        json += Common::StringFromFormat(
+            "%s    {\"group\": \"%s\", \"name\": \"%s\", \"count\": %llu, "
+            "\"total_cycles\": %llu, \"bins\": [",
+            first ? "" : ",\n", entry.group.c_str(), entry.name.c_str(),
+            static_cast<unsigned long long>(count),
+            static_cast<unsigned long long>(entry.total_cycles.load(std::memory_order_relaxed)));
+        first = false;
+
+        // Trailing zero bins are elided; bin b counts invocations of [2^b, 2^(b+1)) cycles
+        size_t last_used = 0;
+        for (size_t b = 0; b < NUM_BINS; ++b) {
+            if (entry.bins[b].load(std::memory_order_relaxed) != 0)
+                last_used = b + 1;
+        }
+        for (size_t b = 0; b < last_used; ++b) {
+            json += Common::StringFromFormat(
+                "%s%llu", b == 0 ? "" : ",",
+                static_cast<unsigned long long>(entry.bins[b].load(std::memory_order_relaxed)));
+        }
+        json += "]}";
+    }
+    json += "\n  ],\n  \"slowest\": [\n";
+
+    {
+        std::lock_guard<std::mutex> lock(slowest_mutex);
+        first = true;
+        for (size_t i = 0; i < TOP_K; ++i) {
+            const SlowSample& sample = slowest[i];
+            if (sample.cycles == 0)
+                continue;
+            const Entry& entry = entries[sample.entry_index];
+            json += Common::StringFromFormat(
+                "%s    {\"group\": \"%s\", \"name\": \"%s\", \"detail\": \"%s\", "
+                "\"cycles\": %llu, \"pc\": \"0x%08X\"}",
+                first ? "" : ",\n", entry.group.c_str(), entry.name.c_str(),
+                sample.detail != nullptr ? sample.detail : "",
+                static_cast<unsigned long long>(sample.cycles), sample.guest_pc);
+            first = false;
+        }
+    }
+    json += "\n  ]\n}\n";
+
+    std::string filename = FileUtil::GetUserPath(D_LOGS_IDX) + "hle_profile.json";
+    FileUtil::CreateFullPath(filename);
+    FileUtil::WriteStringToFile(true, json, filename.c_str());
+}
+
+} // namespace DispatchProfiler
+} // namespace HLE
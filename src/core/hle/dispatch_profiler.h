@@ -0,0 +1,47 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/common_types.h"
+
+namespace HLE {
+
+/**
+ * Always-on latency attribution for HLE dispatch. Each instrumented dispatch site registers a
+ * named entry (one per SVC, one per service port) and records the TSC delta of every invocation
+ * into that entry's power-of-two cycle histogram. The slowest invocations overall are kept with
+ * the guest PC that issued them, so a frame spike can be attributed to an exact call like
+ * fs_user OpenFile rather than just "SVC time". Recording is a pair of relaxed atomic adds.
+ */
+namespace DispatchProfiler {
+
+/// Number of power-of-two cycle bins per entry; bin i covers [2^i, 2^(i+1)) host cycles
+static const size_t NUM_BINS = 32;
+
+/// Reads the host cycle counter (rdtsc where available, a nanosecond clock otherwise)
+u64 GetCycleCount();
+
+/**
+ * Registers a histogram entry for a dispatch site, or returns the existing entry with the same
+ * group and name. Returns 0 (a sink that discards samples) if the entry table is full.
+ * Registration takes a lock; call once per site and cache the index.
+ */
+u32 RegisterEntry(const char* group, const char* name);
+
+/**
+ * Adds one invocation to the given entry's histogram and considers it for the slowest-calls
+ * list. `detail` may name the specific function within the entry (e.g. the service command for
+ * a per-port entry) and must point to storage that outlives the profiler (a string literal or
+ * static table entry).
+ */
+void Record(u32 entry_index, u64 cycles, u32 guest_pc, const char* detail = nullptr);
+
+/// Writes all entries and the slowest-calls list as JSON to <user>/logs/hle_profile.json
+void DumpJSON();
+
+} // namespace DispatchProfiler
+} // namespace HLE
@@ -0,0 +1,81 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <string>
+
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/string_util.h"
+
+#include "core/core_timing.h"
+#include "core/hle/flight_recorder.h"
+
+namespace HLE {
+namespace FlightRecorder {
+
+struct Event {
+    u64 timestamp;   ///< CoreTiming tick count at dispatch
+    const char* port; ///< Service port name, or null for an SVC
+    const char* name;
+    u32 id;          ///< SVC number, or the full command header for a service call
+    u32 caller_pc;
+    u32 args[NUM_EVENT_ARGS];
+};
+
+// 64K events of 48 bytes: a fixed ~3MB that covers several seconds of dispatch at typical
+// call rates. Slots are claimed with a relaxed fetch_add; a dump racing a recording thread
+// may see one half-written slot, which the text dump tolerates.
+static const size_t RING_SIZE = 1 << 16;
+
+static Event ring[RING_SIZE];
+static std::atomic<u64> write_index{0};
+
+static void Record(const char* port, const char* name, u32 id, u32 caller_pc, const u32* args) {
+    Event& event = ring[write_index.fetch_add(1, std::memory_order_relaxed) % RING_SIZE];
+    event.timestamp = CoreTiming::GetTicks();
+    event.port = port;
+    event.name = name;
+    event.id = id;
+    event.caller_pc = caller_pc;
+    for (size_t i = 0; i < NUM_EVENT_ARGS; ++i)
+        event.args[i] = args[i];
+}
+
+void RecordSVC(u32 id, const char* name, u32 caller_pc, const u32* args) {
+    Record(nullptr, name, id, caller_pc, args);
+}
+
+void RecordServiceCall(const char* port, const char* name, u32 header, u32 caller_pc,
+                       const u32* args) {
+    Record(port, name, header, caller_pc, args);
+}
+
+void Dump() {
+    const u64 end = write_index.load(std::memory_order_relaxed);
+    const u64 begin = (end > RING_SIZE) ? end - RING_SIZE : 0;
+
+    std::string text = Common::StringFromFormat(
+        "%llu events recorded, dumping the last %llu (oldest first)\n",
+        static_cast<unsigned long long>(end), static_cast<unsigned long long>(end - begin));
+
+    for (u64 i = begin; i < end; ++i) {
+        const Event& event = ring[i % RING_SIZE];
+        if (event.name == nullptr)
+            continue;
+        text += Common::StringFromFormat(
+            "[%16llu] pc=%08X %s%s%s(%02X): %08X %08X %08X %08X\n",
+            static_cast<unsigned long long>(event.timestamp), event.caller_pc,
+            event.port != nullptr ? event.port : "svc",
+            event.port != nullptr ? "::" : " ", event.name, event.id, event.args[0],
+            event.args[1], event.args[2], event.args[3]);
+    }
+
+    std::string filename = FileUtil::GetUserPath(D_LOGS_IDX) + "flight_record.log";
+    FileUtil::CreateFullPath(filename);
+    FileUtil::WriteStringToFile(true, text, filename.c_str());
+}
+
+} // namespace FlightRecorder
+} // namespace HLE
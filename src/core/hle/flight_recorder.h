@@ -0,0 +1,42 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace HLE {
+
+/**
+ * Always-on flight recorder for HLE dispatch. Every SVC and every service command is appended
+ * to a preallocated ring holding the most recent calls, with its CoreTiming timestamp, the
+ * guest PC that issued it, and the first few arguments. Recording is a relaxed atomic index
+ * bump and a few stores -- cheap enough to leave enabled in ordinary runs, so the events
+ * leading up to a stall or crash can be dumped after the fact instead of reproducing the run
+ * with logging enabled (which changes timing enough to hide many issues).
+ */
+namespace FlightRecorder {
+
+/// Number of arguments captured per event (SVC r0-r3, or cmd_buff[1..4] for service calls)
+static const size_t NUM_EVENT_ARGS = 4;
+
+/**
+ * Records one SVC invocation. `name` must point to storage that outlives the recorder (the
+ * static SVC table provides this); `args` points at the first NUM_EVENT_ARGS argument words.
+ */
+void RecordSVC(u32 id, const char* name, u32 caller_pc, const u32* args);
+
+/**
+ * Records one service command. `port` and `name` must point to storage that outlives the
+ * recorder (the port's cached name and static function tables provide this); `args` points
+ * at cmd_buff[1], the first NUM_EVENT_ARGS parameter words.
+ */
+void RecordServiceCall(const char* port, const char* name, u32 header, u32 caller_pc,
+                       const u32* args);
+
+/// Writes the recorded ring, oldest event first, to <user>/logs/flight_record.log
+void Dump();
+
+} // namespace FlightRecorder
+} // namespace HLE
@@ -14,7 +14,7 @@
 
 namespace HLE {
 
-#define PARAM(n)    Core::g_app_core->GetReg(n)
+#define PARAM(n)    Core::CurrentCpuCore().GetReg(n)
 
 /// An invalid result code that is meant to be overwritten when a thread resumes from waiting
 static const ResultCode RESULT_INVALID(0xDEADC0DE);
@@ -24,7 +24,7 @@ static const ResultCode RESULT_INVALID(0xDEADC0DE);
  * @param res Result to return
  */
 static inline void FuncReturn(u32 res) {
-    Core::g_app_core->SetReg(0, res);
+    Core::CurrentCpuCore().SetReg(0, res);
 }
 
 /**
@@ -33,8 +33,8 @@ static inline void FuncReturn(u32 res) {
  * @todo Verify that this function is correct
  */
 static inline void FuncReturn64(u64 res) {
-    Core::g_app_core->SetReg(0, (u32)(res & 0xFFFFFFFF));
-    Core::g_app_core->SetReg(1, (u32)((res >> 32) & 0xFFFFFFFF));
+    Core::CurrentCpuCore().SetReg(0, (u32)(res & 0xFFFFFFFF));
+    Core::CurrentCpuCore().SetReg(1, (u32)((res >> 32) & 0xFFFFFFFF));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -47,14 +47,14 @@ template<ResultCode func(u32, u32, u32, u32)> void Wrap() {
 template<ResultCode func(u32*, u32, u32, u32, u32, u32)> void Wrap(){
     u32 param_1 = 0;
     u32 retval = func(&param_1, PARAM(0), PARAM(1), PARAM(2), PARAM(3), PARAM(4)).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
 template<ResultCode func(u32*, s32, u32, u32, u32, s32)> void Wrap() {
     u32 param_1 = 0;
     u32 retval = func(&param_1, PARAM(0), PARAM(1), PARAM(2), PARAM(3), PARAM(4)).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
@@ -64,7 +64,7 @@ template<ResultCode func(s32*, u32*, s32, bool, s64)> void Wrap() {
         (PARAM(3) != 0), (((s64)PARAM(4) << 32) | PARAM(0))).raw;
 
     if (retval != RESULT_INVALID.raw) {
-        Core::g_app_core->SetReg(1, (u32)param_1);
+        Core::CurrentCpuCore().SetReg(1, (u32)param_1);
         FuncReturn(retval);
     }
 }
@@ -76,7 +76,7 @@ template<ResultCode func(u32, u32, u32, u32, s64)> void Wrap() {
 template<ResultCode func(u32*)> void Wrap(){
     u32 param_1 = 0;
     u32 retval = func(&param_1).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
@@ -92,11 +92,11 @@ template<ResultCode func(MemoryInfo*, PageInfo*, u32)> void Wrap() {
     MemoryInfo memory_info = {};
     PageInfo page_info = {};
     u32 retval = func(&memory_info, &page_info, PARAM(2)).raw;
-    Core::g_app_core->SetReg(1, memory_info.base_address);
-    Core::g_app_core->SetReg(2, memory_info.size);
-    Core::g_app_core->SetReg(3, memory_info.permission);
-    Core::g_app_core->SetReg(4, memory_info.state);
-    Core::g_app_core->SetReg(5, page_info.flags);
+    Core::CurrentCpuCore().SetReg(1, memory_info.base_address);
+    Core::CurrentCpuCore().SetReg(2, memory_info.size);
+    Core::CurrentCpuCore().SetReg(3, memory_info.permission);
+    Core::CurrentCpuCore().SetReg(4, memory_info.state);
+    Core::CurrentCpuCore().SetReg(5, page_info.flags);
     FuncReturn(retval);
 }
 
@@ -104,18 +104,18 @@ template<ResultCode func(MemoryInfo*, PageInfo*, Handle, u32)> void Wrap() {
     MemoryInfo memory_info = {};
     PageInfo page_info = {};
     u32 retval = func(&memory_info, &page_info, PARAM(2), PARAM(3)).raw;
-    Core::g_app_core->SetReg(1, memory_info.base_address);
-    Core::g_app_core->SetReg(2, memory_info.size);
-    Core::g_app_core->SetReg(3, memory_info.permission);
-    Core::g_app_core->SetReg(4, memory_info.state);
-    Core::g_app_core->SetReg(5, page_info.flags);
+    Core::CurrentCpuCore().SetReg(1, memory_info.base_address);
+    Core::CurrentCpuCore().SetReg(2, memory_info.size);
+    Core::CurrentCpuCore().SetReg(3, memory_info.permission);
+    Core::CurrentCpuCore().SetReg(4, memory_info.state);
+    Core::CurrentCpuCore().SetReg(5, page_info.flags);
     FuncReturn(retval);
 }
 
 template<ResultCode func(s32*, u32)> void Wrap(){
     s32 param_1 = 0;
     u32 retval = func(&param_1, PARAM(1)).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
@@ -126,7 +126,7 @@ template<ResultCode func(u32, s32)> void Wrap() {
 template<ResultCode func(u32*, u32)> void Wrap(){
     u32 param_1 = 0;
     u32 retval = func(&param_1, PARAM(1)).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
@@ -142,29 +142,29 @@ template<ResultCode func(s64*, u32, u32*, u32)> void Wrap(){
 template<ResultCode func(u32*, const char*)> void Wrap() {
     u32 param_1 = 0;
     u32 retval = func(&param_1, (char*)Memory::GetPointer(PARAM(1))).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
 template<ResultCode func(u32*, s32, s32)> void Wrap() {
     u32 param_1 = 0;
     u32 retval = func(&param_1, PARAM(1), PARAM(2)).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
 template<ResultCode func(s32*, u32, s32)> void Wrap() {
     s32 param_1 = 0;
     u32 retval = func(&param_1, PARAM(1), PARAM(2)).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
 template<ResultCode func(s64*, u32, s32)> void Wrap() {
     s64 param_1 = 0;
     u32 retval = func(&param_1, PARAM(1), PARAM(2)).raw;
-    Core::g_app_core->SetReg(1, (u32)param_1);
-    Core::g_app_core->SetReg(2, (u32)(param_1 >> 32));
+    Core::CurrentCpuCore().SetReg(1, (u32)param_1);
+    Core::CurrentCpuCore().SetReg(2, (u32)(param_1 >> 32));
     FuncReturn(retval);
 }
 
@@ -172,7 +172,7 @@ template<ResultCode func(u32*, u32, u32, u32, u32)> void Wrap() {
     u32 param_1 = 0;
     // The last parameter is passed in R0 instead of R4
     u32 retval = func(&param_1, PARAM(1), PARAM(2), PARAM(3), PARAM(0)).raw;
-    Core::g_app_core->SetReg(1, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_1);
     FuncReturn(retval);
 }
 
@@ -185,8 +185,8 @@ template<ResultCode func(u32, s64, s64)> void Wrap() {
 template<ResultCode func(s64*, Handle, u32)> void Wrap() {
     s64 param_1 = 0;
     u32 retval = func(&param_1, PARAM(1), PARAM(2)).raw;
-    Core::g_app_core->SetReg(1, (u32)param_1);
-    Core::g_app_core->SetReg(2, (u32)(param_1 >> 32));
+    Core::CurrentCpuCore().SetReg(1, (u32)param_1);
+    Core::CurrentCpuCore().SetReg(2, (u32)(param_1 >> 32));
     FuncReturn(retval);
 }
 
@@ -199,8 +199,8 @@ template<ResultCode func(Handle*, Handle*, const char*, u32)> void Wrap() {
     Handle param_2 = 0;
     u32 retval = func(&param_1, &param_2, reinterpret_cast<const char*>(Memory::GetPointer(PARAM(2))), PARAM(3)).raw;
     // The first out parameter is moved into R2 and the second is moved into R1.
-    Core::g_app_core->SetReg(1, param_2);
-    Core::g_app_core->SetReg(2, param_1);
+    Core::CurrentCpuCore().SetReg(1, param_2);
+    Core::CurrentCpuCore().SetReg(2, param_1);
     FuncReturn(retval);
 }
 
@@ -33,14 +33,8 @@ ResultCode AddressArbiter::ArbitrateAddress(ArbitrationType type, VAddr address,
 
     // Signal thread(s) waiting for arbitrate address...
     case ArbitrationType::Signal:
-        // Negative value means resume all threads
-        if (value < 0) {
-            ArbitrateAllThreads(address);
-        } else {
-            // Resume first N threads
-            for(int i = 0; i < value; i++)
-                ArbitrateHighestPriorityThread(address);
-        }
+        // Resume the first N threads in one batch; a negative value means resume all threads
+        ArbitrateThreads(address, value);
         break;
 
     // Wait current thread (acquire the arbiter)...
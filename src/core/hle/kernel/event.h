@@ -7,6 +7,7 @@
 #include "common/common_types.h"
 
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/slab_allocator.h"
 
 namespace Kernel {
 
@@ -46,6 +47,8 @@ public:
 private:
     Event();
     ~Event() override;
+
+    KERNEL_OBJECT_SLAB_ALLOCATED(Event)
 };
 
 } // namespace
@@ -22,22 +22,59 @@ unsigned int Object::next_object_id;
 HandleTable g_handle_table;
 
 void WaitObject::AddWaitingThread(SharedPtr<Thread> thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+    // A thread may wait on the same object through several handles; only the thread's own
+    // handful of nodes is examined here, never the object's full wait list.
+    if (thread->GetWaitNode(this) != nullptr)
+        return;
+
+    WaitListNode* node = thread->AcquireWaitNode(this);
+    node->thread = std::move(thread);
+    node->prev = waiting_threads_tail;
+    node->next = nullptr;
+    if (waiting_threads_tail != nullptr)
+        waiting_threads_tail->next = node;
+    else
+        waiting_threads_head = node;
+    waiting_threads_tail = node;
+}
+
+void WaitObject::ReleaseWaitNode(WaitListNode* node) {
+    if (node->prev != nullptr)
+        node->prev->next = node->next;
+    else
+        waiting_threads_head = node->next;
+    if (node->next != nullptr)
+        node->next->prev = node->prev;
+    else
+        waiting_threads_tail = node->prev;
+
+    node->prev = node->next = nullptr;
+    node->object = nullptr; // Marks the node free for reuse by its thread
+    node->thread = nullptr;
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr != waiting_threads.end())
-        waiting_threads.erase(itr);
+    WaitListNode* node = thread->GetWaitNode(this);
+    if (node != nullptr)
+        ReleaseWaitNode(node);
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
-    for (auto thread : waiting_threads)
-        thread->ResumeFromWait();
+    // Detach the whole list up front; resuming a thread must not observe a half-walked list
+    WaitListNode* node = waiting_threads_head;
+    waiting_threads_head = waiting_threads_tail = nullptr;
+
+    while (node != nullptr) {
+        WaitListNode* next = node->next;
 
-    waiting_threads.clear();
+        // Keep the thread alive until it has been resumed, then release its node
+        SharedPtr<Thread> thread = std::move(node->thread);
+        node->prev = node->next = nullptr;
+        node->object = nullptr;
+
+        thread->ResumeFromWait();
+        node = next;
+    }
 
     HLE::Reschedule(__func__);
 }
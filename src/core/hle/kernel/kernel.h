@@ -123,6 +123,19 @@ using SharedPtr = boost::intrusive_ptr<T>;
 class WaitObject : public Object {
 public:
 
+    /**
+     * A node in a WaitObject's intrusive list of waiting threads. One node represents one
+     * (thread, object) wait relationship. Nodes are owned and reused by the waiting thread
+     * (see Thread::AcquireWaitNode), so enqueueing and dequeueing are pure pointer operations
+     * that never allocate.
+     */
+    struct WaitListNode {
+        SharedPtr<Thread> thread;     ///< Keeps the thread alive while it is enqueued
+        WaitObject* object = nullptr; ///< Object this node is enqueued on; nullptr when free
+        WaitListNode* prev = nullptr;
+        WaitListNode* next = nullptr;
+    };
+
     /**
      * Check if the current thread should wait until the object is available
      * @return True if the current thread should wait due to this object being unavailable
@@ -148,8 +161,12 @@ public:
     void WakeupAllWaitingThreads();
 
 private:
-    /// Threads waiting for this object to become available
-    std::vector<SharedPtr<Thread>> waiting_threads;
+    /// Unlinks a node from the wait list and releases it back to its thread for reuse
+    void ReleaseWaitNode(WaitListNode* node);
+
+    /// Intrusive doubly-linked list of threads waiting for this object to become available
+    WaitListNode* waiting_threads_head = nullptr;
+    WaitListNode* waiting_threads_tail = nullptr;
 };
 
 /**
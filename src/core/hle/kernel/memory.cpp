@@ -11,6 +11,7 @@
 
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/memory_util.h"
 
 #include "core/hle/config_mem.h"
 #include "core/hle/kernel/memory.h"
@@ -58,6 +59,9 @@ void MemoryInit(u32 mem_type) {
         // Reserve enough space for this region of FCRAM.
         // We do not want this block of memory to be relocated when allocating from it.
         memory_regions[i].linear_heap_memory->reserve(memory_regions[i].size);
+        // FCRAM is the hottest host allocation there is -- every guest load and store
+        // lands in it -- so ask for 2MB pages to keep it from thrashing the host dTLB.
+        HintLargePages(memory_regions[i].linear_heap_memory->data(), memory_regions[i].size);
 
         base += memory_regions[i].size;
     }
@@ -125,6 +129,7 @@ void InitLegacyAddressSpace(Kernel::VMManager& address_space) {
 
     for (MemoryArea& area : memory_areas) {
         auto block = std::make_shared<std::vector<u8>>(area.size);
+        HintLargePages(block->data(), block->size());
         address_space.MapMemoryBlock(area.base, std::move(block), 0, area.size, MemoryState::Private).Unwrap();
     }
 
@@ -9,6 +9,7 @@
 #include "common/common_types.h"
 
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/slab_allocator.h"
 
 namespace Kernel {
 
@@ -47,6 +48,8 @@ public:
 private:
     Mutex();
     ~Mutex() override;
+
+    KERNEL_OBJECT_SLAB_ALLOCATED(Mutex)
 };
 
 /**
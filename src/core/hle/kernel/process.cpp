@@ -2,12 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
 
 #include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
 
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
@@ -129,6 +132,16 @@ void Process::Run(s32 main_thread_priority, u32 stack_size) {
 
     vm_manager.LogLayout(Log::Level::Debug);
     Kernel::SetupMainThread(codeset->entrypoint, main_thread_priority);
+
+    // Warm the CPU's translation cache over the entry-point page now that the code is
+    // mapped, shaving the cold decode burst off the first slices of guest execution.
+    // Exception vectors aren't covered since the HLE kernel never executes them.
+    u32 pretranslate_end = std::min(codeset->entrypoint + Memory::PAGE_SIZE,
+                                    codeset->code.addr + codeset->code.size);
+    if (pretranslate_end > codeset->entrypoint) {
+        Core::g_app_core->PrepareCodeRegion(codeset->entrypoint,
+                                            pretranslate_end - codeset->entrypoint);
+    }
 }
 
 VAddr Process::GetLinearHeapAreaAddress() const {
@@ -10,6 +10,7 @@
 #include "common/common_types.h"
 
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/slab_allocator.h"
 
 namespace Kernel {
 
@@ -48,6 +49,8 @@ public:
 private:
     Semaphore();
     ~Semaphore() override;
+
+    KERNEL_OBJECT_SLAB_ALLOCATED(Semaphore)
 };
 
 } // namespace
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -50,6 +51,33 @@ constexpr u32 MappedBufferDesc(u32 size, MappedBufferPermissions perms) {
     return 0x8 | (size << 4) | (u32)perms;
 }
 
+constexpr bool IsMappedBufferDesc(u32 descriptor) {
+    return (descriptor & 0x8) != 0;
+}
+
+constexpr bool IsStaticBufferDesc(u32 descriptor) {
+    return (descriptor & 0xE) == 0x2;
+}
+
+/// Returns the buffer size encoded in a static- or mapped-buffer translation descriptor.
+constexpr u32 BufferDescSize(u32 descriptor) {
+    return IsMappedBufferDesc(descriptor) ? descriptor >> 4 : descriptor >> 14;
+}
+
+/**
+ * Resolves a static- or mapped-buffer descriptor/address pair from a command buffer into a
+ * read-only span of guest memory covering the whole buffer. Returns nullptr if the region is
+ * not contiguously mapped plain memory; the caller must then fall back to Memory::ReadBlock.
+ */
+inline const u8* GetBufferSpan(u32 descriptor, VAddr address) {
+    return Memory::GetSpan(address, BufferDescSize(descriptor));
+}
+
+/// Writable variant of GetBufferSpan, for buffers the handler fills in. See Memory::GetWriteSpan.
+inline u8* GetWritableBufferSpan(u32 descriptor, VAddr address) {
+    return Memory::GetWriteSpan(address, BufferDescSize(descriptor));
+}
+
 }
 
 namespace Kernel {
@@ -106,6 +134,29 @@ public:
      */
     virtual ResultVal<bool> SyncRequest() = 0;
 
+    /**
+     * Borrows `size` bytes of scratch storage owned by this session, for staging IPC buffer
+     * contents during the current request. Each borrow gets its own stable slot whose backing
+     * allocation is kept across requests, so steady-state service calls perform no heap
+     * allocation. Borrowed memory is only valid until the reply: the kernel resets the arena
+     * once SyncRequest returns, so data that must outlive the request (e.g. handed to an
+     * asynchronous job) still needs owning storage.
+     */
+    u8* BorrowScratch(size_t size) {
+        if (scratch_buffers.size() <= scratch_borrowed)
+            scratch_buffers.emplace_back();
+        std::vector<u8>& buffer = scratch_buffers[scratch_borrowed++];
+        if (buffer.size() < size)
+            buffer.resize(size);
+        return buffer.data();
+    }
+
+    /// Returns all borrowed scratch storage, keeping the backing allocations for reuse.
+    /// Called by the kernel after each reply.
+    void ResetScratch() {
+        scratch_borrowed = 0;
+    }
+
     // TODO(bunnei): These functions exist to satisfy a hardware test with a Session object
     // passed into WaitSynchronization. Figure out the meaning of them.
 
@@ -116,6 +167,11 @@ public:
     void Acquire() override {
         ASSERT_MSG(!ShouldWait(), "object unavailable!");
     }
+
+private:
+    /// Backing storage for BorrowScratch; one entry per borrow slot, grown on demand
+    std::vector<std::vector<u8>> scratch_buffers;
+    size_t scratch_borrowed = 0; ///< Number of slots handed out for the current request
 };
 
 }
@@ -4,6 +4,7 @@
 
 #include <cstring>
 
+#include "common/assert.h"
 #include "common/logging/log.h"
 
 #include "core/memory.h"
@@ -53,16 +54,19 @@ SharedPtr<SharedMemory> SharedMemory::Create(SharedPtr<Process> owner_process, u
     } else {
         // TODO(Subv): What happens if an application tries to create multiple memory blocks pointing to the same address?
         auto& vm_manager = shared_memory->owner_process->vm_manager;
-        // The memory is already available and mapped in the owner process.
+        // The memory is already available and mapped in the owner process. Alias the
+        // existing backing block instead of copying it out, so every process that maps
+        // this object shares the one physical copy with the owner and no coherency
+        // copies are ever needed.
         auto vma = vm_manager.FindVMA(address)->second;
-        // Copy it over to our own storage
-        shared_memory->backing_block = std::make_shared<std::vector<u8>>(vma.backing_block->data() + vma.offset,
-                                                                         vma.backing_block->data() + vma.offset + size);
-        shared_memory->backing_block_offset = 0;
-        // Unmap the existing pages
+        ASSERT_MSG(vma.base + vma.size >= address + size,
+                   "Shared memory exceeds bounds of mapped block");
+        shared_memory->backing_block = vma.backing_block;
+        shared_memory->backing_block_offset = vma.offset + (address - vma.base);
+        // Remap the owner's pages from the same backing block so they are tagged Shared
         vm_manager.UnmapRange(address, size);
-        // Map our own block into the address space
-        vm_manager.MapMemoryBlock(address, shared_memory->backing_block, 0, size, MemoryState::Shared);
+        vm_manager.MapMemoryBlock(address, shared_memory->backing_block,
+                                  shared_memory->backing_block_offset, size, MemoryState::Shared);
         // Reprotect the block with the new permissions
         vm_manager.ReprotectRange(address, size, ConvertPermissions(permissions));
     }
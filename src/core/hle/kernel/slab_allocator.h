@@ -0,0 +1,84 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace Kernel {
+
+/**
+ * Per-type arena for kernel objects. Objects are carved out of contiguous slabs and recycled
+ * through an intrusive free list, so frequently created and destroyed objects (events, timers,
+ * threads) stay densely packed instead of scattering across the general heap. Handle lookups
+ * on the SVC hot path then chase pointers into warm memory. Slabs are only returned to the
+ * system when the allocator itself is destroyed.
+ */
+template <typename T, size_t ObjectsPerSlab = 64>
+class SlabAllocator final : NonCopyable {
+public:
+    /// Returns storage for one object; grows by a whole slab when the free list is empty.
+    void* Allocate() {
+        if (free_list == nullptr)
+            AllocateSlab();
+        Slot* slot = free_list;
+        free_list = slot->next_free;
+        return slot;
+    }
+
+    /// Returns an object's storage to the free list. Must have come from this allocator.
+    void Free(void* object) {
+        Slot* slot = static_cast<Slot*>(object);
+        slot->next_free = free_list;
+        free_list = slot;
+    }
+
+private:
+    /// A slot is either live object storage or, while free, a link in the free list.
+    union Slot {
+        Slot* next_free;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    void AllocateSlab() {
+        slabs.emplace_back(new Slot[ObjectsPerSlab]);
+        Slot* slab = slabs.back().get();
+        // Push in reverse so the free list hands out slots in ascending address order.
+        for (size_t i = ObjectsPerSlab; i-- > 0;) {
+            slab[i].next_free = free_list;
+            free_list = &slab[i];
+        }
+    }
+
+    Slot* free_list = nullptr;
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+};
+
+} // namespace
+
+/**
+ * Gives a kernel object class slab-backed operator new/delete. The class must be final, since
+ * slot size is sizeof(type). Thanks to virtual destructors, deleting through an Object* still
+ * dispatches to the most-derived class' operator delete, returning the slot to the right slab.
+ */
+#define KERNEL_OBJECT_SLAB_ALLOCATED(type) \
+public: \
+    static void* operator new(std::size_t size) { \
+        DEBUG_ASSERT(size == sizeof(type)); \
+        return GetSlabAllocator().Allocate(); \
+    } \
+    static void operator delete(void* object) { \
+        GetSlabAllocator().Free(object); \
+    } \
+private: \
+    static ::Kernel::SlabAllocator<type>& GetSlabAllocator() { \
+        static ::Kernel::SlabAllocator<type> slab_allocator; \
+        return slab_allocator; \
+    }
@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <list>
+#include <memory>
 #include <vector>
 
 #include "common/assert.h"
@@ -45,14 +47,29 @@ static Kernel::HandleTable wakeup_callback_handle_table;
 // Lists all thread ids that aren't deleted/etc.
 static std::vector<SharedPtr<Thread>> thread_list;
 
-// Lists only ready thread ids.
-static Common::ThreadQueueList<Thread*, THREADPRIO_LOWEST+1> ready_queue;
+// Per-core ready queues; a thread only ever sits in the queue of its home core.
+static std::array<Common::ThreadQueueList<Thread*, THREADPRIO_LOWEST+1>, NUM_CPU_CORES> ready_queues;
 
-static Thread* current_thread;
+// The thread running on each emulated core. The thread API (GetCurrentThread, Reschedule)
+// operates on the core selected by Core::g_running_core.
+static std::array<Thread*, NUM_CPU_CORES> current_threads;
 
 // The first available thread id at startup
 static u32 next_thread_id;
 
+// Set whenever scheduler state changes in a way that could alter the outcome of Reschedule:
+// a thread becoming ready or blocking, a priority change, or a thread being created or stopped.
+// While a core's flag is clear, a reschedule with its current thread still running and no other
+// thread ready is a guaranteed no-op and can skip the queue scan entirely.
+static std::array<bool, NUM_CPU_CORES> thread_schedule_dirty;
+
+// Conservatively marks every core: most state changes are tied to a single thread's core, but
+// the few that aren't don't justify threading a core index through every call site, and the
+// cost of a stale flag is one redundant queue scan.
+static void MarkScheduleDirty() {
+    thread_schedule_dirty.fill(true);
+}
+
 /**
  * Creates a new thread ID
  * @return The new thread ID
@@ -65,7 +82,11 @@ Thread::Thread() {}
 Thread::~Thread() {}
 
 Thread* GetCurrentThread() {
-    return current_thread;
+    return current_threads[Core::g_running_core];
+}
+
+bool HasRunnableThreads(u32 core) {
+    return current_threads[core] != nullptr || ready_queues[core].get_first() != nullptr;
 }
 
 /**
@@ -92,6 +113,27 @@ static bool CheckWait_AddressArbiter(const Thread* thread, VAddr wait_address) {
     return thread->status == THREADSTATUS_WAIT_ARB && wait_address == thread->wait_address;
 }
 
+WaitObject::WaitListNode* Thread::GetWaitNode(const WaitObject* object) {
+    for (auto& node : wait_nodes) {
+        if (node->object == object)
+            return node.get();
+    }
+    return nullptr;
+}
+
+WaitObject::WaitListNode* Thread::AcquireWaitNode(WaitObject* object) {
+    for (auto& node : wait_nodes) {
+        if (node->object == nullptr) {
+            node->object = object;
+            return node.get();
+        }
+    }
+
+    wait_nodes.push_back(std::make_unique<WaitObject::WaitListNode>());
+    wait_nodes.back()->object = object;
+    return wait_nodes.back().get();
+}
+
 void Thread::Stop() {
     // Release all the mutexes that this thread holds
     ReleaseThreadMutexes(this);
@@ -104,7 +146,7 @@ void Thread::Stop() {
     // Clean up thread from ready queue
     // This is only needed when the thread is termintated forcefully (SVC TerminateProcess)
     if (status == THREADSTATUS_READY){
-        ready_queue.remove(current_priority, this);
+        ready_queues[core_id].remove(current_priority, this);
     }
 
     status = THREADSTATUS_DEAD;
@@ -122,41 +164,35 @@ void Thread::Stop() {
     u32 tls_slot = ((tls_address - Memory::TLS_AREA_VADDR) % Memory::PAGE_SIZE) / Memory::TLS_ENTRY_SIZE;
     Kernel::g_current_process->tls_slots[tls_page].reset(tls_slot);
 
+    MarkScheduleDirty();
     HLE::Reschedule(__func__);
 }
 
-Thread* ArbitrateHighestPriorityThread(u32 address) {
-    Thread* highest_priority_thread = nullptr;
-    s32 priority = THREADPRIO_LOWEST;
+void ArbitrateThreads(u32 address, s32 count) {
+    if (count == 0)
+        return;
 
-    // Iterate through threads, find highest priority thread that is waiting to be arbitrated...
+    // Collect every waiter in one pass over the thread list, instead of rescanning the whole
+    // list once per resumed thread. Arbiter-based userland locks signal in storms, so the scan
+    // cost per signal should not scale with the number of threads woken.
+    std::vector<Thread*> waiters;
     for (auto& thread : thread_list) {
-        if (!CheckWait_AddressArbiter(thread.get(), address))
-            continue;
-
-        if (thread == nullptr)
-            continue;
-
-        if(thread->current_priority <= priority) {
-            highest_priority_thread = thread.get();
-            priority = thread->current_priority;
-        }
+        if (CheckWait_AddressArbiter(thread.get(), address))
+            waiters.push_back(thread.get());
     }
 
-    // If a thread was arbitrated, resume it
-    if (nullptr != highest_priority_thread) {
-        highest_priority_thread->ResumeFromWait();
+    if (count >= 0 && static_cast<size_t>(count) < waiters.size()) {
+        // Matches the order repeated highest-priority extraction used to produce: best (lowest
+        // numeric) priority first, ties resolved in favor of threads later in the list.
+        std::reverse(waiters.begin(), waiters.end());
+        std::stable_sort(waiters.begin(), waiters.end(), [](const Thread* lhs, const Thread* rhs) {
+            return lhs->current_priority < rhs->current_priority;
+        });
+        waiters.resize(count);
     }
 
-    return highest_priority_thread;
-}
-
-void ArbitrateAllThreads(u32 address) {
-    // Resume all threads found to be waiting on the address
-    for (auto& thread : thread_list) {
-        if (CheckWait_AddressArbiter(thread.get(), address))
-            thread->ResumeFromWait();
-    }
+    for (Thread* thread : waiters)
+        thread->ResumeFromWait();
 }
 
 /// Boost low priority threads (temporarily) that have been starved
@@ -175,7 +211,7 @@ static void PriorityBoostStarvedThreads() {
         u64 delta = current_ticks - thread->last_running_ticks;
 
         if (thread->status == THREADSTATUS_READY && delta > boost_timeout) {
-            const s32 priority = std::max(ready_queue.get_first()->current_priority - 1, 0);
+            const s32 priority = std::max(ready_queues[thread->core_id].get_first()->current_priority - 1, 0);
             thread->BoostPriority(priority);
         }
     }
@@ -229,16 +265,17 @@ static void UpdateTimeoutParameter(u32* timeout_low, u32* timeout_high, u64 last
  */
 static void SwitchContext(Thread* new_thread) {
     Thread* previous_thread = GetCurrentThread();
+    ARM_Interface& cpu = Core::CurrentCpuCore();
 
     // Save context for previous thread
     if (previous_thread) {
         previous_thread->last_running_ticks = CoreTiming::GetTicks();
-        Core::g_app_core->SaveContext(previous_thread->context);
+        cpu.SaveContext(previous_thread->context);
 
         if (previous_thread->status == THREADSTATUS_RUNNING) {
             // This is only the case when a reschedule is triggered without the current thread
             // yielding execution (i.e. an event triggered, system core time-sliced, etc)
-            ready_queue.push_front(previous_thread->current_priority, previous_thread);
+            ready_queues[previous_thread->core_id].push_front(previous_thread->current_priority, previous_thread);
             previous_thread->status = THREADSTATUS_READY;
         }
     }
@@ -246,11 +283,13 @@ static void SwitchContext(Thread* new_thread) {
     // Load context of new thread
     if (new_thread) {
         DEBUG_ASSERT_MSG(new_thread->status == THREADSTATUS_READY, "Thread must be ready to become running.");
+        DEBUG_ASSERT_MSG(new_thread->core_id == Core::g_running_core,
+                         "Thread must be scheduled on the core being executed.");
 
         // Cancel any outstanding wakeup events for this thread
         CoreTiming::UnscheduleEvent(ThreadWakeupEventType, new_thread->callback_handle);
 
-        current_thread = new_thread;
+        current_threads[Core::g_running_core] = new_thread;
 
         // If the thread was waited by a svcWaitSynch call, step back PC by one instruction to rerun
         // the SVC when the thread wakes up. This is necessary to ensure that the thread can acquire
@@ -278,16 +317,16 @@ static void SwitchContext(Thread* new_thread) {
         }
         new_thread->wait_objects.clear();
 
-        ready_queue.remove(new_thread->current_priority, new_thread);
+        ready_queues[new_thread->core_id].remove(new_thread->current_priority, new_thread);
         new_thread->status = THREADSTATUS_RUNNING;
 
         // Restores thread to its nominal priority if it has been temporarily changed
         new_thread->current_priority = new_thread->nominal_priority;
 
-        Core::g_app_core->LoadContext(new_thread->context);
-        Core::g_app_core->SetCP15Register(CP15_THREAD_URO, new_thread->GetTLSAddress());
+        cpu.LoadContext(new_thread->context);
+        cpu.SetCP15Register(CP15_THREAD_URO, new_thread->GetTLSAddress());
     } else {
-        current_thread = nullptr;
+        current_threads[Core::g_running_core] = nullptr;
     }
 }
 
@@ -298,6 +337,7 @@ static void SwitchContext(Thread* new_thread) {
 static Thread* PopNextReadyThread() {
     Thread* next;
     Thread* thread = GetCurrentThread();
+    auto& ready_queue = ready_queues[Core::g_running_core];
 
     if (thread && thread->status == THREADSTATUS_RUNNING) {
         // We have to do better than the current thread.
@@ -318,22 +358,26 @@ void WaitCurrentThread_Sleep() {
     Thread* thread = GetCurrentThread();
     thread->status = THREADSTATUS_WAIT_SLEEP;
 
+    MarkScheduleDirty();
     HLE::Reschedule(__func__);
 }
 
-void WaitCurrentThread_WaitSynchronization(std::vector<SharedPtr<WaitObject>> wait_objects, bool wait_set_output, bool wait_all) {
+void WaitCurrentThread_WaitSynchronization(bool wait_set_output, bool wait_all) {
     Thread* thread = GetCurrentThread();
     thread->wait_set_output = wait_set_output;
     thread->wait_all = wait_all;
-    thread->wait_objects = std::move(wait_objects);
     thread->waitsynch_waited = true;
     thread->status = THREADSTATUS_WAIT_SYNCH;
+
+    MarkScheduleDirty();
 }
 
 void WaitCurrentThread_ArbitrateAddress(VAddr wait_address) {
     Thread* thread = GetCurrentThread();
     thread->wait_address = wait_address;
     thread->status = THREADSTATUS_WAIT_ARB;
+
+    MarkScheduleDirty();
 }
 
 /**
@@ -393,8 +437,10 @@ void Thread::ResumeFromWait() {
             return;
     }
 
-    ready_queue.push_back(current_priority, this);
+    ready_queues[core_id].push_back(current_priority, this);
     status = THREADSTATUS_READY;
+
+    MarkScheduleDirty();
 }
 
 /**
@@ -409,7 +455,7 @@ static void DebugThreadQueue() {
     }
 
     for (auto& t : thread_list) {
-        s32 priority = ready_queue.contains(t.get());
+        s32 priority = ready_queues[t->core_id].contains(t.get());
         if (priority != -1) {
             LOG_DEBUG(Kernel, "0x%02X %u", priority, t->GetObjectId());
         }
@@ -462,7 +508,6 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     SharedPtr<Thread> thread(new Thread);
 
     thread_list.push_back(thread);
-    ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = THREADSTATUS_DORMANT;
@@ -471,6 +516,25 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     thread->nominal_priority = thread->current_priority = priority;
     thread->last_running_ticks = CoreTiming::GetTicks();
     thread->processor_id = processor_id;
+
+    // Resolve the thread's home core. Threads allowed to run on either core are kept on the
+    // AppCore for now; migrating them to whichever core is idle is left for when the scheduler
+    // grows load balancing.
+    switch (processor_id) {
+    case THREADPROCESSORID_1:
+        thread->core_id = 1;
+        break;
+    case THREADPROCESSORID_DEFAULT:
+        thread->core_id = (g_current_process->ideal_processor == THREADPROCESSORID_1) ? 1 : 0;
+        break;
+    case THREADPROCESSORID_0:
+    case THREADPROCESSORID_ALL:
+    default:
+        thread->core_id = 0;
+        break;
+    }
+    ready_queues[thread->core_id].prepare(priority);
+
     thread->wait_set_output = false;
     thread->wait_all = false;
     thread->wait_objects.clear();
@@ -523,13 +587,12 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     tls_slots[available_page].set(available_slot);
     thread->tls_address = Memory::TLS_AREA_VADDR + available_page * Memory::PAGE_SIZE + available_slot * Memory::TLS_ENTRY_SIZE;
 
-    // TODO(peachum): move to ScheduleThread() when scheduler is added so selected core is used
-    // to initialize the context
-    Core::g_app_core->ResetContext(thread->context, stack_top, entry_point, arg);
+    Core::GetCpuCore(thread->core_id).ResetContext(thread->context, stack_top, entry_point, arg);
 
-    ready_queue.push_back(thread->current_priority, thread.get());
+    ready_queues[thread->core_id].push_back(thread->current_priority, thread.get());
     thread->status = THREADSTATUS_READY;
 
+    MarkScheduleDirty();
     HLE::Reschedule(__func__);
 
     return MakeResult<SharedPtr<Thread>>(std::move(thread));
@@ -554,16 +617,20 @@ void Thread::SetPriority(s32 priority) {
 
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
-        ready_queue.move(this, current_priority, priority);
+        ready_queues[core_id].move(this, current_priority, priority);
     else
-        ready_queue.prepare(priority);
+        ready_queues[core_id].prepare(priority);
 
     nominal_priority = current_priority = priority;
+
+    MarkScheduleDirty();
 }
 
 void Thread::BoostPriority(s32 priority) {
-    ready_queue.move(this, current_priority, priority);
+    ready_queues[core_id].move(this, current_priority, priority);
     current_priority = priority;
+
+    MarkScheduleDirty();
 }
 
 SharedPtr<Thread> SetupMainThread(u32 entry_point, s32 priority) {
@@ -584,9 +651,21 @@ SharedPtr<Thread> SetupMainThread(u32 entry_point, s32 priority) {
 }
 
 void Reschedule() {
+    const u32 core = Core::g_running_core;
+    Thread* cur = GetCurrentThread();
+
+    // Fast path: nothing has changed scheduler state since this core's last reschedule, its
+    // current thread is still runnable and no other thread is ready, so the scan below could
+    // only pick `cur` again. SVC-dense titles hit this on the majority of reschedule requests.
+    if (!thread_schedule_dirty[core] && cur && cur->status == THREADSTATUS_RUNNING &&
+            !cur->waitsynch_waited && ready_queues[core].get_first() == nullptr) {
+        HLE::DoneRescheduling();
+        return;
+    }
+    thread_schedule_dirty[core] = false;
+
     PriorityBoostStarvedThreads();
 
-    Thread* cur = GetCurrentThread();
     Thread* next = PopNextReadyThread();
 
     HLE::DoneRescheduling();
@@ -623,18 +702,20 @@ void Thread::SetWaitSynchronizationOutput(s32 output) {
 void ThreadingInit() {
     ThreadWakeupEventType = CoreTiming::RegisterEvent("ThreadWakeupCallback", ThreadWakeupCallback);
 
-    current_thread = nullptr;
+    current_threads.fill(nullptr);
     next_thread_id = 1;
+    thread_schedule_dirty.fill(true);
 }
 
 void ThreadingShutdown() {
-    current_thread = nullptr;
+    current_threads.fill(nullptr);
 
     for (auto& t : thread_list) {
         t->Stop();
     }
     thread_list.clear();
-    ready_queue.clear();
+    for (auto& queue : ready_queues)
+        queue.clear();
 }
 
 } // namespace
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,7 @@
 
 #include "core/hle/hle.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/slab_allocator.h"
 #include "core/hle/result.h"
 
 enum ThreadPriority : s32{
@@ -32,6 +34,9 @@ enum ThreadProcessorId : s32 {
     THREADPROCESSORID_MAX       =  2, ///< Processor ID must be less than this
 };
 
+/// Number of emulated CPU cores threads can be scheduled on (core 0: AppCore, core 1: SysCore)
+static const u32 NUM_CPU_CORES = 2;
+
 enum ThreadStatus {
     THREADSTATUS_RUNNING,       ///< Currently running
     THREADSTATUS_READY,         ///< Ready to run
@@ -129,6 +134,19 @@ public:
      */
     VAddr GetTLSAddress() const { return tls_address; }
 
+    /**
+     * Returns this thread's wait list node for the given object, or nullptr if the thread is
+     * not enqueued on it. Only the thread's own nodes are scanned.
+     */
+    WaitObject::WaitListNode* GetWaitNode(const WaitObject* object);
+
+    /**
+     * Takes a free wait list node from this thread's pool, growing the pool if necessary, and
+     * tags it with the given object. The pool is reused between waits, so waiting allocates at
+     * most once per pool slot over the thread's lifetime.
+     */
+    WaitObject::WaitListNode* AcquireWaitNode(WaitObject* object);
+
     Core::ThreadContext context;
 
     u32 thread_id;
@@ -143,6 +161,7 @@ public:
     u64 last_running_ticks; ///< CPU tick when thread was last running
 
     s32 processor_id;
+    u32 core_id; ///< Emulated core this thread is scheduled on, resolved from processor_id
 
     VAddr tls_address; ///< Virtual address of the Thread Local Storage of the thread
 
@@ -153,6 +172,9 @@ public:
 
     SharedPtr<Process> owner_process; ///< Process that owns this thread
     std::vector<SharedPtr<WaitObject>> wait_objects; ///< Objects that the thread is waiting on
+
+    /// Pool of wait list nodes backing this thread's entries in WaitObject wait lists
+    std::vector<std::unique_ptr<WaitObject::WaitListNode>> wait_nodes;
     VAddr wait_address;     ///< If waiting on an AddressArbiter, this is the arbitration address
     bool wait_all;          ///< True if the thread is waiting on all objects before resuming
     bool wait_set_output;   ///< True if the output parameter should be set on thread wakeup
@@ -165,6 +187,8 @@ public:
 private:
     Thread();
     ~Thread() override;
+
+    KERNEL_OBJECT_SLAB_ALLOCATED(Thread)
 };
 
 /**
@@ -176,21 +200,24 @@ private:
 SharedPtr<Thread> SetupMainThread(u32 entry_point, s32 priority);
 
 /**
- * Reschedules to the next available thread (call after current thread is suspended)
+ * Reschedules the core currently being executed (Core::g_running_core) to the next available
+ * thread (call after current thread is suspended)
  */
 void Reschedule();
 
 /**
- * Arbitrate the highest priority thread that is waiting
- * @param address The address for which waiting threads should be arbitrated
+ * Checks whether the given emulated core has any thread to execute: a running thread or at
+ * least one thread in its ready queue. Used by the core loop to decide whether a SysCore
+ * slice needs to be interleaved.
  */
-Thread* ArbitrateHighestPriorityThread(u32 address);
+bool HasRunnableThreads(u32 core);
 
 /**
- * Arbitrate all threads currently waiting.
+ * Arbitrate threads waiting on the given address, in a single pass over the thread list.
  * @param address The address for which waiting threads should be arbitrated
+ * @param count Number of highest priority threads to resume, or a negative value to resume all
  */
-void ArbitrateAllThreads(u32 address);
+void ArbitrateThreads(u32 address, s32 count);
 
 /**
  * Gets the current thread
@@ -203,12 +230,13 @@ Thread* GetCurrentThread();
 void WaitCurrentThread_Sleep();
 
 /**
- * Waits the current thread from a WaitSynchronization call
- * @param wait_objects Kernel objects that we are waiting on
+ * Waits the current thread from a WaitSynchronization call. The caller must already have
+ * enqueued the thread on each object (AddWaitingThread) and recorded the objects in the
+ * thread's wait_objects list.
  * @param wait_set_output If true, set the output parameter on thread wakeup (for WaitSynchronizationN only)
  * @param wait_all If true, wait on all objects before resuming (for WaitSynchronizationN only)
  */
-void WaitCurrentThread_WaitSynchronization(std::vector<SharedPtr<WaitObject>> wait_objects, bool wait_set_output, bool wait_all);
+void WaitCurrentThread_WaitSynchronization(bool wait_set_output, bool wait_all);
 
 /**
  * Waits the current thread from an ArbitrateAddress call
@@ -2,8 +2,6 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <cinttypes>
-
 #include "common/assert.h"
 #include "common/logging/log.h"
 
@@ -14,14 +12,60 @@
 
 namespace Kernel {
 
-/// The event type of the generic timer callback event
+/// The event type of the shared timer callback event
 static int timer_callback_event_type;
-// TODO(yuriks): This can be removed if Timer objects are explicitly pooled in the future, allowing
-//               us to simply use a pool index or similar.
-static Kernel::HandleTable timer_callback_handle_table;
+
+// All armed timers are kept in one intrusive doubly-linked list and share a single CoreTiming
+// event, scheduled for the earliest deadline among them. Arming or cancelling a timer is a
+// pointer operation plus, at worst, one reschedule of that shared event, so a title running
+// many timers no longer pays one CoreTiming queue insertion or removal per timer operation.
+static Timer* armed_timers_head;
+static u64 scheduled_fire_time_us; ///< Deadline the shared event is currently scheduled for
+static bool timer_event_scheduled;
+
+/// Schedules the shared timer event so that it fires no later than the given absolute time
+static void ScheduleTimerEvent(u64 fire_time_us) {
+    if (timer_event_scheduled) {
+        if (scheduled_fire_time_us <= fire_time_us)
+            return;
+        CoreTiming::UnscheduleEvent(timer_callback_event_type, 0);
+    }
+
+    u64 now_us = CoreTiming::GetGlobalTimeUs();
+    u64 delay_us = fire_time_us > now_us ? fire_time_us - now_us : 0;
+    CoreTiming::ScheduleEvent(usToCycles(delay_us), timer_callback_event_type, 0);
+
+    scheduled_fire_time_us = fire_time_us;
+    timer_event_scheduled = true;
+}
+
+static void LinkArmedTimer(Timer* timer) {
+    timer->armed_prev = nullptr;
+    timer->armed_next = armed_timers_head;
+    if (armed_timers_head != nullptr)
+        armed_timers_head->armed_prev = timer;
+    armed_timers_head = timer;
+    timer->armed = true;
+}
+
+static void UnlinkArmedTimer(Timer* timer) {
+    if (timer->armed_prev != nullptr)
+        timer->armed_prev->armed_next = timer->armed_next;
+    else
+        armed_timers_head = timer->armed_next;
+    if (timer->armed_next != nullptr)
+        timer->armed_next->armed_prev = timer->armed_prev;
+
+    timer->armed_prev = timer->armed_next = nullptr;
+    timer->armed = false;
+}
 
 Timer::Timer() {}
-Timer::~Timer() {}
+
+Timer::~Timer() {
+    if (armed)
+        UnlinkArmedTimer(this);
+}
 
 SharedPtr<Timer> Timer::Create(ResetType reset_type, std::string name) {
     SharedPtr<Timer> timer(new Timer);
@@ -31,7 +75,10 @@ SharedPtr<Timer> Timer::Create(ResetType reset_type, std::string name) {
     timer->name = std::move(name);
     timer->initial_delay = 0;
     timer->interval_delay = 0;
-    timer->callback_handle = timer_callback_handle_table.Create(timer).MoveFrom();
+    timer->fire_time_us = 0;
+    timer->armed_next = nullptr;
+    timer->armed_prev = nullptr;
+    timer->armed = false;
 
     return timer;
 }
@@ -48,21 +95,24 @@ void Timer::Acquire() {
 }
 
 void Timer::Set(s64 initial, s64 interval) {
-    // Ensure we get rid of any previous scheduled event
-    Cancel();
+    if (armed)
+        UnlinkArmedTimer(this);
 
     initial_delay = initial;
     interval_delay = interval;
 
-    u64 initial_microseconds = initial / 1000;
-    CoreTiming::ScheduleEvent(usToCycles(initial_microseconds),
-            timer_callback_event_type, callback_handle);
+    fire_time_us = CoreTiming::GetGlobalTimeUs() + initial / 1000;
+    LinkArmedTimer(this);
+    ScheduleTimerEvent(fire_time_us);
 
     HLE::Reschedule(__func__);
 }
 
 void Timer::Cancel() {
-    CoreTiming::UnscheduleEvent(timer_callback_event_type, callback_handle);
+    if (armed)
+        UnlinkArmedTimer(this);
+    // The shared event is left scheduled: if it fires with no timer due, it simply re-arms
+    // itself for the next remaining deadline, or goes idle.
 
     HLE::Reschedule(__func__);
 }
@@ -71,36 +121,57 @@ void Timer::Clear() {
     signaled = false;
 }
 
-/// The timer callback event, called when a timer is fired
-static void TimerCallback(u64 timer_handle, int cycles_late) {
-    SharedPtr<Timer> timer = timer_callback_handle_table.Get<Timer>(static_cast<Handle>(timer_handle));
+/// The shared timer event, called when the earliest armed timer is due to fire
+static void TimerCallback(u64 /*userdata*/, int /*cycles_late*/) {
+    timer_event_scheduled = false;
 
-    if (timer == nullptr) {
-        LOG_CRITICAL(Kernel, "Callback fired for invalid timer %08" PRIx64, timer_handle);
-        return;
-    }
+    u64 now_us = CoreTiming::GetGlobalTimeUs();
+    bool have_next = false;
+    u64 next_fire_time_us = 0;
 
-    LOG_TRACE(Kernel, "Timer %08" PRIx64 " fired", timer_handle);
+    Timer* timer = armed_timers_head;
+    while (timer != nullptr) {
+        Timer* next = timer->armed_next;
 
-    timer->signaled = true;
+        if (timer->fire_time_us <= now_us) {
+            LOG_TRACE(Kernel, "Timer %u fired", timer->GetObjectId());
 
-    // Resume all waiting threads
-    timer->WakeupAllWaitingThreads();
+            timer->signaled = true;
 
-    if (timer->interval_delay != 0) {
-        // Reschedule the timer with the interval delay
-        u64 interval_microseconds = timer->interval_delay / 1000;
-        CoreTiming::ScheduleEvent(usToCycles(interval_microseconds) - cycles_late,
-                timer_callback_event_type, timer_handle);
+            // Resume all waiting threads
+            timer->WakeupAllWaitingThreads();
+
+            if (timer->interval_delay != 0) {
+                // Advance relative to the previous deadline rather than the current time, so
+                // that periodic timers do not accumulate drift from callback latency
+                timer->fire_time_us += timer->interval_delay / 1000;
+            } else {
+                UnlinkArmedTimer(timer);
+            }
+        }
+
+        if (timer->armed && (!have_next || timer->fire_time_us < next_fire_time_us)) {
+            next_fire_time_us = timer->fire_time_us;
+            have_next = true;
+        }
+
+        timer = next;
     }
+
+    if (have_next)
+        ScheduleTimerEvent(next_fire_time_us);
 }
 
 void TimersInit() {
-    timer_callback_handle_table.Clear();
+    armed_timers_head = nullptr;
+    scheduled_fire_time_us = 0;
+    timer_event_scheduled = false;
     timer_callback_event_type = CoreTiming::RegisterEvent("TimerCallback", TimerCallback);
 }
 
 void TimersShutdown() {
+    while (armed_timers_head != nullptr)
+        UnlinkArmedTimer(armed_timers_head);
 }
 
 } // namespace
@@ -8,6 +8,7 @@
 
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/slab_allocator.h"
 
 namespace Kernel {
 
@@ -35,6 +36,13 @@ public:
     u64 initial_delay;                      ///< The delay until the timer fires for the first time
     u64 interval_delay;                     ///< The delay until the timer fires after the first time
 
+    u64 fire_time_us;                       ///< Absolute time, in microseconds, at which this timer next fires
+
+    /// Intrusive links in the armed timer list shared by all timers (managed by timer.cpp)
+    Timer* armed_next;
+    Timer* armed_prev;
+    bool armed;                             ///< Whether this timer is currently linked in the armed timer list
+
     bool ShouldWait() override;
     void Acquire() override;
 
@@ -52,8 +60,7 @@ private:
     Timer();
     ~Timer() override;
 
-    /// Handle used as userdata to reference this object when inserting into the CoreTiming queue.
-    Handle callback_handle;
+    KERNEL_OBJECT_SLAB_ALLOCATED(Timer)
 };
 
 /// Initializes the required variables for timers
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <iterator>
 
 #include "common/assert.h"
@@ -57,6 +58,7 @@ void VMManager::Reset() {
     VirtualMemoryArea initial_vma;
     initial_vma.size = MAX_ADDRESS;
     vma_map.emplace(initial_vma.base, initial_vma);
+    vma_lookup_dirty = true;
 
     UpdatePageTableForVMA(initial_vma);
 }
@@ -64,9 +66,22 @@ void VMManager::Reset() {
 VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
     if (target >= MAX_ADDRESS) {
         return vma_map.end();
-    } else {
-        return std::prev(vma_map.upper_bound(target));
     }
+
+    if (vma_lookup_dirty) {
+        vma_lookup.clear();
+        vma_lookup.reserve(vma_map.size());
+        for (auto iter = vma_map.cbegin(); iter != vma_map.cend(); ++iter) {
+            vma_lookup.emplace_back(iter->first, iter);
+        }
+        vma_lookup_dirty = false;
+    }
+
+    // Find the last VMA with base <= target. The map always contains a VMA at base 0, so
+    // the upper bound is never the first element.
+    auto it = std::upper_bound(vma_lookup.begin(), vma_lookup.end(), target,
+            [](VAddr addr, const std::pair<VAddr, VMAHandle>& vma) { return addr < vma.first; });
+    return std::prev(it)->second;
 }
 
 ResultVal<VMManager::VMAHandle> VMManager::MapMemoryBlock(VAddr target,
@@ -299,10 +314,13 @@ VMManager::VMAIter VMManager::SplitVMA(VMAIter vma_handle, u32 offset_in_vma) {
 
     ASSERT(old_vma.CanBeMergedWith(new_vma));
 
+    vma_lookup_dirty = true;
     return vma_map.emplace_hint(std::next(vma_handle), new_vma.base, new_vma);
 }
 
 VMManager::VMAIter VMManager::MergeAdjacent(VMAIter iter) {
+    vma_lookup_dirty = true;
+
     VMAIter next_vma = std::next(iter);
     if (next_vma != vma_map.end() && iter->second.CanBeMergedWith(next_vma->second)) {
         iter->second.size += next_vma->second.size;
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "common/common_types.h"
@@ -195,6 +196,15 @@ public:
 private:
     using VMAIter = decltype(vma_map)::iterator;
 
+    /**
+     * Flat mirror of vma_map used by FindVMA: VMA base addresses paired with iterators
+     * into the map, sorted by base. Mappings change rarely but are queried constantly, so
+     * address resolution binary-searches this cache-friendly vector instead of chasing
+     * tree nodes; the mirror is rebuilt lazily after any map mutation.
+     */
+    mutable std::vector<std::pair<VAddr, VMAHandle>> vma_lookup;
+    mutable bool vma_lookup_dirty = true;
+
     /// Converts a VMAHandle to a mutable VMAIter.
     VMAIter StripIterConstness(const VMAHandle& iter);
 
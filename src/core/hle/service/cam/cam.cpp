@@ -2,6 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
 #include "common/logging/log.h"
 
 #include "core/hle/kernel/event.h"
@@ -11,12 +16,53 @@
 #include "core/hle/service/cam/cam_s.h"
 #include "core/hle/service/cam/cam_u.h"
 #include "core/hle/service/service.h"
+#include "core/memory.h"
 
 namespace Service {
 namespace CAM {
 
 static const u32 TRANSFER_BYTES = 5 * 1024;
 
+/// Largest frame the service delivers: VGA at 16 bits per pixel
+static const u32 MAX_FRAME_BYTES = 640 * 480 * 2;
+
+/**
+ * Per-port capture pipeline. The staging buffer is allocated once in Init() at the largest
+ * frame size and refilled in place, so delivering a frame is a single copy into the guest
+ * buffer with no per-frame allocation. Frames are synthetic (no host camera is attached): a
+ * gradient regenerated only when the geometry changes, stamped with a frame counter on every
+ * delivery so consecutive frames are distinguishable.
+ */
+struct PortState {
+    bool capturing = false;
+    u16 width = 640;
+    u16 height = 480;
+    u16 transfer_lines = 0;
+    u32 frame_counter = 0;
+    bool pattern_dirty = true;
+    std::vector<u8> frame_buffer;
+};
+
+static std::array<PortState, 2> ports;
+
+static PortState& GetPortState(u8 port) {
+    return ports[(Port)port == Port::Cam2 ? 1 : 0];
+}
+
+/// Regenerates the synthetic gradient for the port's current geometry, in place
+static void FillSyntheticFrame(PortState& state) {
+    const u32 frame_bytes = std::min<u32>(state.width * state.height * 2, MAX_FRAME_BYTES);
+    u16* pixels = reinterpret_cast<u16*>(state.frame_buffer.data());
+    for (u32 i = 0; i < frame_bytes / 2; ++i) {
+        const u32 x = i % state.width;
+        const u32 y = i / state.width;
+        // RGB565 gradient: red across, green down
+        pixels[i] = static_cast<u16>(((x * 31 / state.width) << 11) |
+                                     ((y * 63 / state.height) << 5));
+    }
+    state.pattern_dirty = false;
+}
+
 static Kernel::SharedPtr<Kernel::Event> completion_event_cam1;
 static Kernel::SharedPtr<Kernel::Event> completion_event_cam2;
 static Kernel::SharedPtr<Kernel::Event> interrupt_error_event;
@@ -27,10 +73,12 @@ void StartCapture(Service::Interface* self) {
 
     u8 port = cmd_buff[1] & 0xFF;
 
+    GetPortState(port).capturing = true;
+
     cmd_buff[0] = IPC::MakeHeader(0x1, 1, 0);
     cmd_buff[1] = RESULT_SUCCESS.raw;
 
-    LOG_WARNING(Service_CAM, "(STUBBED) called, port=%d", port);
+    LOG_DEBUG(Service_CAM, "called, port=%d", port);
 }
 
 void StopCapture(Service::Interface* self) {
@@ -38,10 +86,12 @@ void StopCapture(Service::Interface* self) {
 
     u8 port = cmd_buff[1] & 0xFF;
 
+    GetPortState(port).capturing = false;
+
     cmd_buff[0] = IPC::MakeHeader(0x2, 1, 0);
     cmd_buff[1] = RESULT_SUCCESS.raw;
 
-    LOG_WARNING(Service_CAM, "(STUBBED) called, port=%d", port);
+    LOG_DEBUG(Service_CAM, "called, port=%d", port);
 }
 
 void GetVsyncInterruptEvent(Service::Interface* self) {
@@ -81,6 +131,15 @@ void SetReceiving(Service::Interface* self) {
     Kernel::Event* completion_event = (Port)port == Port::Cam2 ?
             completion_event_cam2.get() : completion_event_cam1.get();
 
+    // Deliver one synthetic frame straight out of the preallocated staging buffer. WriteBlock
+    // walks the guest pages, so destinations in rasterizer-cached or MMIO memory stay correct.
+    PortState& state = GetPortState(port);
+    if (state.pattern_dirty)
+        FillSyntheticFrame(state);
+    reinterpret_cast<u16*>(state.frame_buffer.data())[0] = static_cast<u16>(state.frame_counter++);
+    const u32 copy_size = std::min(image_size, MAX_FRAME_BYTES);
+    Memory::WriteBlock(dest, state.frame_buffer.data(), copy_size);
+
     completion_event->Signal();
 
     cmd_buff[0] = IPC::MakeHeader(0x7, 1, 2);
@@ -88,7 +147,7 @@ void SetReceiving(Service::Interface* self) {
     cmd_buff[2] = IPC::MoveHandleDesc();
     cmd_buff[3] = Kernel::g_handle_table.Create(completion_event).MoveFrom();
 
-    LOG_WARNING(Service_CAM, "(STUBBED) called, addr=0x%X, port=%d, image_size=%d, trans_unit=%d",
+    LOG_DEBUG(Service_CAM, "called, addr=0x%X, port=%d, image_size=%d, trans_unit=%d",
             dest, port, image_size, trans_unit);
 }
 
@@ -100,10 +159,18 @@ void SetTransferLines(Service::Interface* self) {
     u16 width          = cmd_buff[3] & 0xFFFF;
     u16 height         = cmd_buff[4] & 0xFFFF;
 
+    PortState& state = GetPortState(port);
+    state.transfer_lines = transfer_lines;
+    if (state.width != width || state.height != height) {
+        state.width = width;
+        state.height = height;
+        state.pattern_dirty = true;
+    }
+
     cmd_buff[0] = IPC::MakeHeader(0x9, 1, 0);
     cmd_buff[1] = RESULT_SUCCESS.raw;
 
-    LOG_WARNING(Service_CAM, "(STUBBED) called, port=%d, lines=%d, width=%d, height=%d",
+    LOG_DEBUG(Service_CAM, "called, port=%d, lines=%d, width=%d, height=%d",
             port, transfer_lines, width, height);
 }
 
@@ -194,10 +261,31 @@ void SetSize(Service::Interface* self) {
     u8 size       = cmd_buff[2] & 0xFF;
     u8 context    = cmd_buff[3] & 0xFF;
 
+    static const struct { u16 width, height; } dimensions[] = {
+        {640, 480}, // VGA
+        {320, 240}, // QVGA
+        {160, 120}, // QQVGA
+        {352, 288}, // CIF
+        {176, 144}, // QCIF
+        {256, 192}, // DS_LCD
+        {512, 384}, // DS_LCDx4
+        {400, 240}, // CTR_TOP_LCD
+    };
+    if (size < 8) {
+        // Camera-to-port routing isn't modeled; geometry applies to both staging buffers
+        for (PortState& state : ports) {
+            if (state.width != dimensions[size].width || state.height != dimensions[size].height) {
+                state.width = dimensions[size].width;
+                state.height = dimensions[size].height;
+                state.pattern_dirty = true;
+            }
+        }
+    }
+
     cmd_buff[0] = IPC::MakeHeader(0x1F, 1, 0);
     cmd_buff[1] = RESULT_SUCCESS.raw;
 
-    LOG_WARNING(Service_CAM, "(STUBBED) called, cam_select=%d, size=%d, context=%d",
+    LOG_DEBUG(Service_CAM, "called, cam_select=%d, size=%d, context=%d",
             cam_select, size, context);
 }
 
@@ -297,9 +385,18 @@ void Init() {
     completion_event_cam2 = Kernel::Event::Create(ResetType::OneShot, "CAM_U::completion_event_cam2");
     interrupt_error_event = Kernel::Event::Create(ResetType::OneShot, "CAM_U::interrupt_error_event");
     vsync_interrupt_error_event = Kernel::Event::Create(ResetType::OneShot, "CAM_U::vsync_interrupt_error_event");
+
+    // Size the staging buffers for the largest frame up front; captures never reallocate
+    for (PortState& state : ports) {
+        state = PortState();
+        state.frame_buffer.resize(MAX_FRAME_BYTES);
+    }
 }
 
 void Shutdown() {
+    for (PortState& state : ports)
+        state = PortState();
+
     completion_event_cam1 = nullptr;
     completion_event_cam2 = nullptr;
     interrupt_error_event = nullptr;
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstring>
 
 #include "audio_core/hle/pipe.h"
 
@@ -142,13 +143,13 @@ static void LoadComponent(Service::Interface* self) {
 
     ASSERT(Memory::IsValidVirtualAddress(buffer));
 
-    std::vector<u8> component_data(size);
-    Memory::ReadBlock(buffer, component_data.data(), component_data.size());
+    u8* component_data = self->BorrowScratch(size);
+    Memory::ReadBlock(buffer, component_data, size);
 
-    LOG_INFO(Service_DSP, "Firmware hash: %#" PRIx64, Common::ComputeHash64(component_data.data(), component_data.size()));
+    LOG_INFO(Service_DSP, "Firmware hash: %#" PRIx64, Common::ComputeHash64(component_data, size));
     // Some versions of the firmware have the location of DSP structures listed here.
     ASSERT(size > 0x37C);
-    LOG_INFO(Service_DSP, "Structures hash: %#" PRIx64, Common::ComputeHash64(component_data.data() + 0x340, 60));
+    LOG_INFO(Service_DSP, "Structures hash: %#" PRIx64, Common::ComputeHash64(component_data + 0x340, 60));
 
     LOG_WARNING(Service_DSP, "(STUBBED) called size=0x%X, prog_mask=0x%08X, data_mask=0x%08X, buffer=0x%08X",
                 size, prog_mask, data_mask, buffer);
@@ -290,13 +291,17 @@ static void WriteProcessPipe(Service::Interface* self) {
 
     ASSERT_MSG(Memory::IsValidVirtualAddress(buffer), "Invalid Buffer: pipe=%u, size=0x%X, buffer=0x%08X", pipe, size, buffer);
 
-    std::vector<u8> message(size);
-    for (u32 i = 0; i < size; i++) {
-        message[i] = Memory::Read8(buffer + i);
+    if (const u8* span = Memory::GetSpan(buffer, size)) {
+        // Write straight out of guest memory; the pipe doesn't retain the pointer.
+        DSP::HLE::PipeWrite(pipe, span, size);
+    } else {
+        u8* message = self->BorrowScratch(size);
+        for (u32 i = 0; i < size; i++) {
+            message[i] = Memory::Read8(buffer + i);
+        }
+        DSP::HLE::PipeWrite(pipe, message, size);
     }
 
-    DSP::HLE::PipeWrite(pipe, message);
-
     cmd_buff[0] = IPC::MakeHeader(0xD, 1, 0);
     cmd_buff[1] = RESULT_SUCCESS.raw; // No error
 
@@ -332,11 +337,13 @@ static void ReadPipeIfPossible(Service::Interface* self) {
     cmd_buff[0] = IPC::MakeHeader(0x10, 1, 2);
     cmd_buff[1] = RESULT_SUCCESS.raw; // No error
     if (DSP::HLE::GetPipeReadableSize(pipe) >= size) {
-        std::vector<u8> response = DSP::HLE::PipeRead(pipe, size);
+        u32 read_length = size;
+        const u8* response = DSP::HLE::PipeRead(pipe, read_length);
 
-        Memory::WriteBlock(addr, response.data(), response.size());
+        if (read_length > 0)
+            Memory::WriteBlock(addr, response, read_length);
 
-        cmd_buff[2] = static_cast<u32>(response.size());
+        cmd_buff[2] = read_length;
     } else {
         cmd_buff[2] = 0; // Return no data
     }
@@ -370,13 +377,15 @@ static void ReadPipe(Service::Interface* self) {
     ASSERT_MSG(Memory::IsValidVirtualAddress(addr), "Invalid addr: pipe=0x%08X, unknown=0x%08X, size=0x%X, buffer=0x%08X", pipe, unknown, size, addr);
 
     if (DSP::HLE::GetPipeReadableSize(pipe) >= size) {
-        std::vector<u8> response = DSP::HLE::PipeRead(pipe, size);
+        u32 read_length = size;
+        const u8* response = DSP::HLE::PipeRead(pipe, read_length);
 
-        Memory::WriteBlock(addr, response.data(), response.size());
+        if (read_length > 0)
+            Memory::WriteBlock(addr, response, read_length);
 
         cmd_buff[0] = IPC::MakeHeader(0xE, 2, 2);
         cmd_buff[1] = RESULT_SUCCESS.raw; // No error
-        cmd_buff[2] = static_cast<u32>(response.size());
+        cmd_buff[2] = read_length;
         cmd_buff[3] = IPC::StaticBufferDesc(size, 0);
         cmd_buff[4] = addr;
     } else {
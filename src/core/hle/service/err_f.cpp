@@ -6,6 +6,7 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 
+#include "core/hle/flight_recorder.h"
 #include "core/hle/service/err_f.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -106,6 +107,10 @@ static void ThrowFatalError(Service::Interface* self) {
     u32* cmd_buff = Kernel::GetCommandBuffer();
 
     LOG_CRITICAL(Service_ERR, "Fatal error!");
+
+    // The guest is crashing; preserve the dispatch history leading up to it
+    HLE::FlightRecorder::Dump();
+
     const ErrInfo* errinfo = reinterpret_cast<ErrInfo*>(&cmd_buff[1]);
 
     switch (errinfo->specifier) {
@@ -2,12 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
+#include <mutex>
 #include <system_error>
+#include <thread>
 #include <type_traits>
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <boost/container/flat_map.hpp>
 
@@ -15,6 +21,7 @@
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/archive_extsavedata.h"
@@ -24,7 +31,10 @@
 #include "core/file_sys/archive_systemsavedata.h"
 #include "core/file_sys/directory_backend.h"
 #include "core/file_sys/file_backend.h"
+#include "core/file_sys/write_behind.h"
+#include "core/core_timing.h"
 #include "core/hle/hle.h"
+#include "core/hle/kernel/thread.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/fs_user.h"
@@ -84,6 +94,131 @@ enum class DirectoryCommand : u32 {
     Close           = 0x08020000,
 };
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Asynchronous file reads
+//
+// File reads are dispatched to host I/O worker threads instead of blocking the emulation thread
+// on disk. The guest thread is put to sleep and the reply is delivered through a threadsafe
+// CoreTiming event once the host I/O completes. Titles expect file reads to take time on the
+// real console, so the extra latency is unremarkable to them.
+
+/// State for one in-flight asynchronous read.
+struct AsyncReadJob {
+    Kernel::SharedPtr<File> file;              ///< Keeps the file and its backend alive
+    Kernel::SharedPtr<Kernel::Thread> thread;  ///< Guest thread sleeping on the result
+
+    u64 offset;               ///< File offset to read from
+    u32 length;               ///< Number of bytes to read
+    u8* span;                 ///< Direct destination in guest memory, or nullptr to use staging
+    std::vector<u8> staging;  ///< Staging buffer used when the guest buffer is not contiguous
+    VAddr address;            ///< Guest destination address for the staging fallback
+
+    ResultVal<size_t> result; ///< Filled in by the I/O worker
+};
+
+/// In-flight jobs, indexed by the userdata of the completion event. Empty slots are reused.
+static std::vector<std::unique_ptr<AsyncReadJob>> async_read_jobs;
+static std::mutex async_read_jobs_mutex;
+
+static int async_read_completion_event;
+
+struct IoWorker {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<size_t> queue; ///< Ids of jobs waiting to be serviced by this worker
+};
+
+static constexpr size_t num_io_workers = 2;
+static std::array<IoWorker, num_io_workers> io_workers;
+static bool io_workers_exit = false;
+
+static void IoWorkerLoop(IoWorker& worker) {
+    Common::SetCurrentThreadName("FS IO Worker");
+
+    while (true) {
+        size_t job_id;
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.cv.wait(lock, [&worker] { return io_workers_exit || !worker.queue.empty(); });
+            if (worker.queue.empty())
+                return;
+            job_id = worker.queue.front();
+            worker.queue.pop_front();
+        }
+
+        AsyncReadJob* job;
+        {
+            std::lock_guard<std::mutex> lock(async_read_jobs_mutex);
+            job = async_read_jobs[job_id].get();
+        }
+
+        u8* destination = job->span != nullptr ? job->span : job->staging.data();
+        job->result = job->file->backend->Read(job->offset, job->length, destination);
+
+        // Deliver the reply on the emulation thread at its next Advance.
+        CoreTiming::ScheduleEvent_Threadsafe(0, async_read_completion_event, job_id);
+    }
+}
+
+/// Runs on the emulation thread once host I/O has finished; writes the reply and wakes the caller.
+static void AsyncReadCompletionCallback(u64 job_id, int cycles_late) {
+    std::unique_ptr<AsyncReadJob> job;
+    {
+        std::lock_guard<std::mutex> lock(async_read_jobs_mutex);
+        job = std::move(async_read_jobs[job_id]);
+    }
+    ASSERT(job != nullptr);
+
+    // The reply goes into the sleeping thread's TLS command buffer.
+    const VAddr cmd_buff = job->thread->GetTLSAddress() + Kernel::kCommandHeaderOffset;
+    if (job->result.Succeeded()) {
+        const size_t read = *job->result;
+        if (job->span == nullptr)
+            Memory::WriteBlock(job->address, job->staging.data(), read);
+        Memory::Write32(cmd_buff + 1 * sizeof(u32), RESULT_SUCCESS.raw);
+        Memory::Write32(cmd_buff + 2 * sizeof(u32), static_cast<u32>(read));
+    } else {
+        Memory::Write32(cmd_buff + 1 * sizeof(u32), job->result.Code().raw);
+    }
+
+    job->thread->ResumeFromWait();
+}
+
+/**
+ * Queues a read on an I/O worker. Jobs are distributed by backend so that operations on the
+ * same file stay ordered between themselves.
+ * @return True if the job was queued, false if the workers are not running (the caller must
+ *         then perform the read synchronously).
+ */
+static bool EnqueueAsyncRead(std::unique_ptr<AsyncReadJob> job) {
+    const uintptr_t backend_key = reinterpret_cast<uintptr_t>(job->file->backend.get());
+    IoWorker& worker = io_workers[(backend_key >> 4) % num_io_workers];
+    if (!worker.thread.joinable())
+        return false;
+
+    size_t job_id;
+    {
+        std::lock_guard<std::mutex> lock(async_read_jobs_mutex);
+        for (job_id = 0; job_id < async_read_jobs.size(); ++job_id) {
+            if (async_read_jobs[job_id] == nullptr)
+                break;
+        }
+        if (job_id == async_read_jobs.size())
+            async_read_jobs.emplace_back();
+        async_read_jobs[job_id] = std::move(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(job_id);
+    }
+    worker.cv.notify_one();
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 File::File(std::unique_ptr<FileSys::FileBackend>&& backend, const FileSys::Path & path)
     : path(path), priority(0), backend(std::move(backend)) {}
 
@@ -99,22 +234,55 @@ ResultVal<bool> File::SyncRequest() {
         {
             u64 offset = cmd_buff[1] | ((u64)cmd_buff[2]) << 32;
             u32 length = cmd_buff[3];
+            u32 descriptor = cmd_buff[4];
             u32 address = cmd_buff[5];
             LOG_TRACE(Service_FS, "Read %s %s: offset=0x%llx length=%d address=0x%x",
                       GetTypeName().c_str(), GetName().c_str(), offset, length, address);
 
+            if (IPC::BufferDescSize(descriptor) < length) {
+                LOG_WARNING(Service_FS, "Output buffer descriptor is smaller than the read length "
+                            "(descriptor=0x%08X length=0x%08X)", descriptor, length);
+            }
+
             if (offset + length > backend->GetSize()) {
                 LOG_ERROR(Service_FS, "Reading from out of bounds offset=0x%llX length=0x%08X file_size=0x%llX",
                           offset, length, backend->GetSize());
             }
 
-            std::vector<u8> data(length);
-            ResultVal<size_t> read = backend->Read(offset, data.size(), data.data());
+            u8* span = Memory::GetWriteSpan(address, length);
+
+            auto job = std::make_unique<AsyncReadJob>();
+            job->file = this;
+            job->thread = Kernel::GetCurrentThread();
+            job->offset = offset;
+            job->length = length;
+            job->span = span;
+            job->address = address;
+            if (span == nullptr)
+                job->staging.resize(length);
+
+            if (EnqueueAsyncRead(std::move(job))) {
+                // The reply, including the result code in cmd_buff[1], is written by the
+                // completion callback once host I/O finishes; sleep until then.
+                Kernel::WaitCurrentThread_Sleep();
+                break;
+            }
+
+            // I/O workers are not running; fall back to a synchronous read.
+            ResultVal<size_t> read;
+            if (span != nullptr) {
+                // The mapped output buffer is contiguous in host memory: read straight into it.
+                read = backend->Read(offset, length, span);
+            } else {
+                u8* data = BorrowScratch(length);
+                read = backend->Read(offset, length, data);
+                if (read.Succeeded())
+                    Memory::WriteBlock(address, data, *read);
+            }
             if (read.Failed()) {
                 cmd_buff[1] = read.Code().raw;
                 return read.Code();
             }
-            Memory::WriteBlock(address, data.data(), *read);
             cmd_buff[2] = static_cast<u32>(*read);
             break;
         }
@@ -125,13 +293,25 @@ ResultVal<bool> File::SyncRequest() {
             u64 offset = cmd_buff[1] | ((u64)cmd_buff[2]) << 32;
             u32 length = cmd_buff[3];
             u32 flush = cmd_buff[4];
+            u32 descriptor = cmd_buff[5];
             u32 address = cmd_buff[6];
             LOG_TRACE(Service_FS, "Write %s %s: offset=0x%llx length=%d address=0x%x, flush=0x%x",
                       GetTypeName().c_str(), GetName().c_str(), offset, length, address, flush);
 
-            std::vector<u8> data(length);
-            Memory::ReadBlock(address, data.data(), data.size());
-            ResultVal<size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
+            if (IPC::BufferDescSize(descriptor) < length) {
+                LOG_WARNING(Service_FS, "Input buffer descriptor is smaller than the write length "
+                            "(descriptor=0x%08X length=0x%08X)", descriptor, length);
+            }
+
+            ResultVal<size_t> written;
+            if (const u8* span = Memory::GetSpan(address, length)) {
+                // The mapped input buffer is contiguous in host memory: write straight from it.
+                written = backend->Write(offset, length, flush != 0, span);
+            } else {
+                u8* data = BorrowScratch(length);
+                Memory::ReadBlock(address, data, length);
+                written = backend->Write(offset, length, flush != 0, data);
+            }
             if (written.Failed()) {
                 cmd_buff[1] = written.Code().raw;
                 return written.Code();
@@ -520,6 +700,14 @@ ResultCode CreateSystemSaveData(u32 high, u32 low) {
 void ArchiveInit() {
     next_handle = 1;
 
+    async_read_completion_event =
+        CoreTiming::RegisterEvent("AsyncFileReadCompletion", AsyncReadCompletionCallback);
+    io_workers_exit = false;
+    for (auto& worker : io_workers)
+        worker.thread = std::thread(IoWorkerLoop, std::ref(worker));
+
+    FileSys::WriteBehind::Init();
+
     AddService(new FS::Interface);
 
     // TODO(Subv): Add the other archive types (see here for the known types:
@@ -560,6 +748,29 @@ void ArchiveInit() {
 
 /// Shutdown archives
 void ArchiveShutdown() {
+    // Stop the I/O workers; they drain their queues before exiting, so no read is lost.
+    for (auto& worker : io_workers) {
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            io_workers_exit = true;
+        }
+        worker.cv.notify_one();
+    }
+    for (auto& worker : io_workers) {
+        if (worker.thread.joinable())
+            worker.thread.join();
+    }
+
+    // Drop any completion events and jobs that were still pending delivery.
+    CoreTiming::RemoveThreadsafeEvent(async_read_completion_event);
+    {
+        std::lock_guard<std::mutex> lock(async_read_jobs_mutex);
+        async_read_jobs.clear();
+    }
+
+    // Apply and flush all journaled save writes before the archive handles are destroyed.
+    FileSys::WriteBehind::Shutdown();
+
     handle_map.clear();
     id_code_map.clear();
 }
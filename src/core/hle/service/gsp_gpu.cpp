@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+
 #include "common/bit_field.h"
 #include "common/microprofile.h"
 
@@ -98,6 +100,17 @@ static ResultCode WriteHWRegs(u32 base_address, u32 size_in_bytes, VAddr data_va
             LOG_ERROR(Service_GSP, "Misaligned size 0x%08x", size_in_bytes);
             return ERR_GSP_REGS_MISALIGNED;
         } else {
+            if (base_address >= 0x400000 && base_address + size_in_bytes <= 0x404000) {
+                // The span is entirely GPU registers: stage the whole (at most 0x80 byte)
+                // source and hand it to the GPU as one block write, instead of taking the
+                // MMIO dispatch path once per register.
+                u32 reg_data[max_size_in_bytes / sizeof(u32)];
+                Memory::ReadBlock(data_vaddr, reg_data, size_in_bytes);
+                GPU::WriteBlock(base_address + REGS_BEGIN, reg_data, size_in_bytes / 4);
+                return RESULT_SUCCESS;
+            }
+
+            // LCD registers (and anything else in the IO window) keep the per-word path
             while (size_in_bytes > 0) {
                 WriteSingleHWReg(base_address, Memory::Read32(data_vaddr));
 
@@ -137,14 +150,28 @@ static ResultCode WriteHWRegsWithMask(u32 base_address, u32 size_in_bytes, VAddr
             LOG_ERROR(Service_GSP, "Misaligned size 0x%08x", size_in_bytes);
             return ERR_GSP_REGS_MISALIGNED;
         } else {
+            // Both buffers are tiny and nearly always land in one contiguous mapping,
+            // so read them through a zero-copy span when possible.
+            const u8* data_span = Memory::GetSpan(data_vaddr, size_in_bytes);
+            const u8* masks_span = Memory::GetSpan(masks_vaddr, size_in_bytes);
+
             while (size_in_bytes > 0) {
                 const u32 reg_address = base_address + REGS_BEGIN;
 
                 u32 reg_value;
                 HW::Read<u32>(reg_value, reg_address);
 
-                u32 data = Memory::Read32(data_vaddr);
-                u32 mask = Memory::Read32(masks_vaddr);
+                u32 data;
+                u32 mask;
+                if (data_span != nullptr && masks_span != nullptr) {
+                    std::memcpy(&data, data_span, sizeof(data));
+                    std::memcpy(&mask, masks_span, sizeof(mask));
+                    data_span += 4;
+                    masks_span += 4;
+                } else {
+                    data = Memory::Read32(data_vaddr);
+                    mask = Memory::Read32(masks_vaddr);
+                }
 
                 // Update the current value of the register only for set mask bits
                 reg_value = (reg_value & ~mask) | (data | mask);
@@ -226,6 +253,16 @@ static void ReadHWRegs(Service::Interface* self) {
 
     VAddr dst_vaddr = cmd_buff[0x41];
 
+    // GPU register reads have no side effects, so a contiguous destination takes the whole
+    // span as a single block copy instead of an MMIO round trip per register. Spans touching
+    // the LCD registers keep the per-word path below.
+    if (reg_addr >= 0x400000 && reg_addr + size <= 0x404000) {
+        if (u8* dest = Memory::GetWriteSpan(dst_vaddr, size)) {
+            GPU::ReadBlock(reg_addr + REGS_BEGIN, dest, size / 4);
+            return;
+        }
+    }
+
     while (size > 0) {
         u32 value;
         HW::Read<u32>(value, reg_addr + REGS_BEGIN);
@@ -384,6 +421,24 @@ static void UnregisterInterruptRelayQueue(Service::Interface* self) {
     LOG_WARNING(Service_GSP, "(STUBBED) called");
 }
 
+/// Set while interrupt wakeups are being batched (see BeginInterruptBatch)
+static bool batching_interrupts = false;
+/// Whether any interrupt was raised while batching and the event signal is still owed
+static bool deferred_interrupt_signal = false;
+
+void BeginInterruptBatch() {
+    batching_interrupts = true;
+    deferred_interrupt_signal = false;
+}
+
+void EndInterruptBatch() {
+    batching_interrupts = false;
+    if (deferred_interrupt_signal) {
+        deferred_interrupt_signal = false;
+        g_interrupt_event->Signal();
+    }
+}
+
 /**
  * Signals that the specified interrupt type has occurred to userland code
  * @param interrupt_id ID of interrupt that is being signalled
@@ -408,11 +463,13 @@ void SignalInterrupt(InterruptId interrupt_id) {
         next += interrupt_relay_queue->number_interrupts;
         next = next % 0x34; // 0x34 is the number of interrupt slots
 
-        interrupt_relay_queue->number_interrupts += 1;
-
         interrupt_relay_queue->slot[next] = interrupt_id;
         interrupt_relay_queue->error_code = 0x0; // No error
 
+        // Publish the entry last, so the guest never observes a count that covers a slot
+        // which has not been written yet
+        interrupt_relay_queue->number_interrupts += 1;
+
         // Update framebuffer information if requested
         // TODO(yuriks): Confirm where this code should be called. It is definitely updated without
         //               executing any GSP commands, only waiting on the event.
@@ -425,6 +482,14 @@ void SignalInterrupt(InterruptId interrupt_id) {
             }
         }
     }
+
+    // While a command batch is being drained, the queue slots above are still written for every
+    // interrupt (guests count them), but the event wakeup is coalesced into a single signal once
+    // the whole batch is done, instead of a full kernel round trip per command.
+    if (batching_interrupts) {
+        deferred_interrupt_signal = true;
+        return;
+    }
     g_interrupt_event->Signal();
 }
 
@@ -583,22 +648,34 @@ static void SetLcdForceBlack(Service::Interface* self) {
 
 /// This triggers handling of the GX command written to the command buffer in shared memory.
 static void TriggerCmdReqQueue(Service::Interface* self) {
+    // The guest cannot observe the queue while it is inside this call, so the entire batch is
+    // drained in one pass: interrupt wakeups raised by the commands are coalesced into a single
+    // event signal and the shared-memory command count is cleared with a single write at the
+    // end, rather than decremented per command.
+    BeginInterruptBatch();
+
     // Iterate through each thread's command queue...
     for (unsigned thread_id = 0; thread_id < 0x4; ++thread_id) {
         CommandBuffer* command_buffer = (CommandBuffer*)GetCommandBuffer(thread_id);
 
+        u32 number_commands = command_buffer->number_commands;
+        if (number_commands == 0)
+            continue;
+
         // Iterate through each command...
-        for (unsigned i = 0; i < command_buffer->number_commands; ++i) {
+        for (unsigned i = 0; i < number_commands; ++i) {
             g_debugger.GXCommandProcessed((u8*)&command_buffer->commands[i]);
 
             // Decode and execute command
             ExecuteCommand(command_buffer->commands[i], thread_id);
-
-            // Indicates that command has completed
-            command_buffer->number_commands.Assign(command_buffer->number_commands - 1);
         }
+
+        // Indicates that all commands have completed
+        command_buffer->number_commands.Assign(0);
     }
 
+    EndInterruptBatch();
+
     u32* cmd_buff = Kernel::GetCommandBuffer();
     cmd_buff[1] = 0; // No error
 }
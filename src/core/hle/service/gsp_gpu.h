@@ -195,6 +195,16 @@ public:
  */
 void SignalInterrupt(InterruptId interrupt_id);
 
+/**
+ * Starts coalescing interrupt wakeups: SignalInterrupt calls still queue their relay-queue
+ * entries, but the event signal is deferred until EndInterruptBatch, so a burst of interrupts
+ * (e.g. the per-screen VBlank pair) costs a single kernel wakeup.
+ */
+void BeginInterruptBatch();
+
+/// Ends a batch started with BeginInterruptBatch, delivering the deferred wakeup if one is owed
+void EndInterruptBatch();
+
 ResultCode SetBufferSwap(u32 screen_id, const FrameBufferInfo& info);
 
 /**
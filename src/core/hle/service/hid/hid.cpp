@@ -15,6 +15,8 @@
 #include "core/core_timing.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/shared_memory.h"
+#include "core/movie.h"
+#include "core/settings.h"
 
 #include "video_core/video_core.h"
 
@@ -36,6 +38,23 @@ static u32 next_touch_index;
 static u32 next_accelerometer_index;
 static u32 next_gyroscope_index;
 
+// Last pad/touch sample written to shared memory, used to skip the ring update and the event
+// signals entirely when nothing changed since the previous poll
+static u32 last_pad_state_hex;
+static s16 last_circle_pad_x;
+static s16 last_circle_pad_y;
+static u16 last_touch_x;
+static u16 last_touch_y;
+static bool last_touch_pressed;
+static bool pad_state_valid;
+
+// Counts VBlank-driven polls skipped to approximate the configured update rate
+static int update_rate_counter;
+
+/// Settings snapshot refreshed once per update tick; see Settings::UpdateSnapshot
+static Settings::Values settings_snapshot;
+static u32 settings_snapshot_version;
+
 static int enable_accelerometer_count = 0; // positive means enabled
 static int enable_gyroscope_count = 0; // positive means enabled
 
@@ -66,6 +85,10 @@ static PadState GetCirclePadDirectionState(s16 circle_pad_x, s16 circle_pad_y) {
     return state;
 }
 
+static void UpdatePadTouch(SharedMem* mem, PadState state, s16 circle_pad_x, s16 circle_pad_y,
+                           u16 touch_x, u16 touch_y, bool touch_pressed);
+static void UpdateMotionSensors(SharedMem* mem);
+
 void Update() {
     SharedMem* mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
@@ -74,6 +97,18 @@ void Update() {
         return;
     }
 
+    // VBlank drives this at ~60Hz; skip polls to approximate the configured update rate
+    Settings::UpdateSnapshot(settings_snapshot, settings_snapshot_version);
+    const int update_rate = settings_snapshot.hid_update_rate;
+    if (update_rate > 0 && update_rate < 60) {
+        if (++update_rate_counter < 60 / update_rate)
+            return;
+        update_rate_counter = 0;
+    }
+
+    // Apply every button event received since the last update, in order, so presses shorter
+    // than an update period still reach the sampled state with their receipt time recorded
+    VideoCore::g_emu_window->DrainInputEvents();
     PadState state = VideoCore::g_emu_window->GetPadState();
 
     // Get current circle pad position and update circle pad direction
@@ -81,6 +116,58 @@ void Update() {
     std::tie(circle_pad_x, circle_pad_y) = VideoCore::g_emu_window->GetCirclePadState();
     state.hex |= GetCirclePadDirectionState(circle_pad_x, circle_pad_y).hex;
 
+    u16 touch_x, touch_y;
+    bool touch_pressed;
+    std::tie(touch_x, touch_y, touch_pressed) = VideoCore::g_emu_window->GetTouchState();
+
+    // In deterministic mode the host input never reaches the game: a movie provides the
+    // input stream, and without one the pad is held in its neutral state on every update
+    if (settings_snapshot.deterministic_mode && !Movie::IsPlaying()) {
+        state.hex = 0;
+        circle_pad_x = circle_pad_y = 0;
+        touch_x = touch_y = 0;
+        touch_pressed = false;
+    }
+
+    // Movie hook: when recording, this captures the fully sampled input; when replaying, it
+    // replaces it with the recorded stream, so the game sees bit-exact input across runs
+    Movie::InputSample sample = { state.hex, circle_pad_x, circle_pad_y,
+                                  touch_x, touch_y, touch_pressed };
+    Movie::HandleInputSample(sample);
+    state.hex = sample.pad_state_hex;
+    circle_pad_x = sample.circle_pad_x;
+    circle_pad_y = sample.circle_pad_y;
+    touch_x = sample.touch_x;
+    touch_y = sample.touch_y;
+    touch_pressed = sample.touch_pressed;
+
+    // When no pad or touch input changed since the last poll, skip both the shared-page ring
+    // update and the event signals: the page already holds exactly the data a reader would see,
+    // and waking listeners for an identical sample only burns kernel wakeups in idle scenes.
+    const bool input_changed = !pad_state_valid ||
+            state.hex != last_pad_state_hex ||
+            circle_pad_x != last_circle_pad_x || circle_pad_y != last_circle_pad_y ||
+            touch_x != last_touch_x || touch_y != last_touch_y ||
+            touch_pressed != last_touch_pressed;
+
+    if (input_changed) {
+        last_pad_state_hex = state.hex;
+        last_circle_pad_x = circle_pad_x;
+        last_circle_pad_y = circle_pad_y;
+        last_touch_x = touch_x;
+        last_touch_y = touch_y;
+        last_touch_pressed = touch_pressed;
+        pad_state_valid = true;
+
+        UpdatePadTouch(mem, state, circle_pad_x, circle_pad_y, touch_x, touch_y, touch_pressed);
+    }
+
+    UpdateMotionSensors(mem);
+}
+
+/// Writes a new pad/touch sample into the shared-page rings and signals the pad/touch events
+static void UpdatePadTouch(SharedMem* mem, PadState state, s16 circle_pad_x, s16 circle_pad_y,
+                           u16 touch_x, u16 touch_y, bool touch_pressed) {
     mem->pad.current_state.hex = state.hex;
     mem->pad.index = next_pad_index;
     next_pad_index = (next_pad_index + 1) % mem->pad.entries.size();
@@ -113,10 +200,9 @@ void Update() {
 
     // Get the current touch entry
     TouchDataEntry& touch_entry = mem->touch.entries[mem->touch.index];
-    bool pressed = false;
-
-    std::tie(touch_entry.x, touch_entry.y, pressed) = VideoCore::g_emu_window->GetTouchState();
-    touch_entry.valid.Assign(pressed ? 1 : 0);
+    touch_entry.x = touch_x;
+    touch_entry.y = touch_y;
+    touch_entry.valid.Assign(touch_pressed ? 1 : 0);
 
     // TODO(bunnei): We're not doing anything with offset 0xA8 + 0x18 of HID SharedMemory, which
     // supposedly is "Touch-screen entry, which contains the raw coordinate data prior to being
@@ -131,7 +217,11 @@ void Update() {
     // Signal both handles when there's an update to Pad or touch
     event_pad_or_touch_1->Signal();
     event_pad_or_touch_2->Signal();
+}
 
+/// Samples the motion sensors into the shared page. Accelerometer and gyroscope data is analog
+/// and effectively always changing, so it is not subject to the pad/touch change detection.
+static void UpdateMotionSensors(SharedMem* mem) {
     // Update accelerometer
     if (enable_accelerometer_count > 0) {
         mem->accelerometer.index = next_accelerometer_index;
@@ -293,6 +383,9 @@ void Init() {
     next_pad_index = 0;
     next_touch_index = 0;
 
+    pad_state_valid = false;
+    update_rate_counter = 0;
+
     // Create event handles
     event_pad_or_touch_1 = Event::Create(ResetType::OneShot, "HID:EventPadOrTouch1");
     event_pad_or_touch_2 = Event::Create(ResetType::OneShot, "HID:EventPadOrTouch2");
@@ -12,6 +12,12 @@
 
 namespace LDR_RO {
 
+// NOTE: CRO/CRS loading and relocation are not implemented yet; every function below is a stub.
+// When relocation application is implemented, process the tables against a span of the target
+// segment obtained once via Memory::GetWriteSpan rather than per-entry Read32/Write32 calls --
+// titles load CRO plugins at level transitions and per-word accesses turn linking into a
+// multi-hundred-millisecond pause.
+
 /**
  * LDR_RO::Initialize service function
  *  Inputs:
@@ -2,6 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+
+#include "common/logging/log.h"
+
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/mic_u.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -9,21 +17,239 @@
 
 namespace MIC_U {
 
+// Sample delivery writes directly into the guest-mapped shared memory block — the ring buffer
+// the title hands us in Initialize is the only buffer; there is no host-side staging, so the
+// steady-state path never allocates. No host microphone is attached: samples are silence, and
+// the fill loop below is where a real capture source would drop its data.
+
+static Kernel::SharedPtr<Kernel::SharedMemory> shared_memory;
+static Kernel::SharedPtr<Kernel::Event> buffer_full_event;
+
+static u32 shared_memory_size = 0;
+static u32 audio_buffer_offset = 0;
+static u32 audio_buffer_size = 0;
+static bool audio_buffer_loop = false;
+static u32 write_offset = 0;
+
+static bool is_sampling = false;
+static bool mic_power = false;
+static u8 mic_gain = 0;
+static bool clamp = false;
+
+/// Hardware sampling rates, indexed by the rate field the title passes to Initialize
+static const u32 sample_rates[] = { 32728, 16364, 10909, 8182 };
+static u32 sample_rate = 32728;
+
+/// Interval between sample delivery ticks; ~131 samples per tick at the highest rate
+static const int SAMPLE_TICK_US = 4000;
+
+static int sample_tick_event;
+static bool tick_scheduled = false;
+
+static void SampleTickCallback(u64 userdata, int cycles_late) {
+    if (!is_sampling || shared_memory == nullptr || audio_buffer_size == 0) {
+        tick_scheduled = false;
+        return;
+    }
+
+    u8* buffer = shared_memory->GetPointer(audio_buffer_offset);
+    u32 bytes_to_write = (sample_rate * SAMPLE_TICK_US / 1000000) * sizeof(s16);
+    while (bytes_to_write > 0) {
+        const u32 span = std::min(bytes_to_write, audio_buffer_size - write_offset);
+        std::memset(buffer + write_offset, 0, span);
+        write_offset += span;
+        bytes_to_write -= span;
+
+        if (write_offset == audio_buffer_size) {
+            write_offset = 0;
+            if (!audio_buffer_loop) {
+                is_sampling = false;
+                buffer_full_event->Signal();
+                tick_scheduled = false;
+                return;
+            }
+        }
+    }
+
+    // Titles poll the last written offset from the final word of the shared memory block
+    if (shared_memory_size >= sizeof(u32)) {
+        std::memcpy(shared_memory->GetPointer(shared_memory_size - sizeof(u32)),
+                    &write_offset, sizeof(u32));
+    }
+
+    CoreTiming::ScheduleEvent(usToCycles(SAMPLE_TICK_US) - cycles_late,
+                              sample_tick_event);
+}
+
+static void MapSharedMem(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    u32 size      = cmd_buff[1];
+    Handle handle = cmd_buff[3];
+
+    if (Kernel::g_handle_table.IsValid(handle)) {
+        shared_memory = Kernel::g_handle_table.Get<Kernel::SharedMemory>(handle);
+        shared_memory->name = "MIC_U:SharedMemory";
+        shared_memory_size = size;
+    }
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called, size=0x%X, handle=0x%08X", size, handle);
+}
+
+static void UnmapSharedMem(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    is_sampling = false;
+    shared_memory = nullptr;
+    shared_memory_size = 0;
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called");
+}
+
+static void Initialize(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    u8  encoding          = cmd_buff[1] & 0xFF;
+    u8  sample_rate_index = cmd_buff[2] & 0xFF;
+    u32 buffer_offset     = cmd_buff[3];
+    u32 buffer_size       = cmd_buff[4];
+    bool loop             = (cmd_buff[5] & 0xFF) != 0;
+
+    if (sample_rate_index < 4)
+        sample_rate = sample_rates[sample_rate_index];
+    audio_buffer_offset = buffer_offset;
+    audio_buffer_size = buffer_size;
+    audio_buffer_loop = loop;
+    write_offset = 0;
+    is_sampling = shared_memory != nullptr && buffer_size > 0;
+
+    if (is_sampling && !tick_scheduled) {
+        tick_scheduled = true;
+        CoreTiming::ScheduleEvent(usToCycles(SAMPLE_TICK_US), sample_tick_event);
+    }
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called, encoding=%u, sample_rate_index=%u, offset=0x%X, size=0x%X, loop=%d",
+              encoding, sample_rate_index, buffer_offset, buffer_size, loop);
+}
+
+static void AdjustSampling(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    u8 sample_rate_index = cmd_buff[1] & 0xFF;
+    if (sample_rate_index < 4)
+        sample_rate = sample_rates[sample_rate_index];
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called, sample_rate_index=%u", sample_rate_index);
+}
+
+static void StopSampling(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    is_sampling = false;
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called");
+}
+
+static void IsSampling(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+    cmd_buff[2] = is_sampling ? 1 : 0;
+
+    LOG_DEBUG(Service, "called");
+}
+
+static void GetEventHandle(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+    cmd_buff[3] = Kernel::g_handle_table.Create(buffer_full_event).MoveFrom();
+
+    LOG_DEBUG(Service, "called");
+}
+
+static void SetGain(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    mic_gain = cmd_buff[1] & 0xFF;
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called, gain=%u", mic_gain);
+}
+
+static void GetGain(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+    cmd_buff[2] = mic_gain;
+
+    LOG_DEBUG(Service, "called");
+}
+
+static void SetPower(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    mic_power = (cmd_buff[1] & 0xFF) != 0;
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called, power=%d", mic_power);
+}
+
+static void GetPower(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+    cmd_buff[2] = mic_power ? 1 : 0;
+
+    LOG_DEBUG(Service, "called");
+}
+
+static void SetClamp(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    clamp = (cmd_buff[1] & 0xFF) != 0;
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+
+    LOG_DEBUG(Service, "called, clamp=%d", clamp);
+}
+
+static void GetClamp(Service::Interface* self) {
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+
+    cmd_buff[1] = RESULT_SUCCESS.raw;
+    cmd_buff[2] = clamp ? 1 : 0;
+
+    LOG_DEBUG(Service, "called");
+}
+
 const Interface::FunctionInfo FunctionTable[] = {
-    {0x00010042, nullptr,               "MapSharedMem"},
-    {0x00020000, nullptr,               "UnmapSharedMem"},
-    {0x00030140, nullptr,               "Initialize"},
-    {0x00040040, nullptr,               "AdjustSampling"},
-    {0x00050000, nullptr,               "StopSampling"},
-    {0x00060000, nullptr,               "IsSampling"},
-    {0x00070000, nullptr,               "GetEventHandle"},
-    {0x00080040, nullptr,               "SetGain"},
-    {0x00090000, nullptr,               "GetGain"},
-    {0x000A0040, nullptr,               "SetPower"},
-    {0x000B0000, nullptr,               "GetPower"},
+    {0x00010042, MapSharedMem,          "MapSharedMem"},
+    {0x00020000, UnmapSharedMem,        "UnmapSharedMem"},
+    {0x00030140, Initialize,            "Initialize"},
+    {0x00040040, AdjustSampling,        "AdjustSampling"},
+    {0x00050000, StopSampling,          "StopSampling"},
+    {0x00060000, IsSampling,            "IsSampling"},
+    {0x00070000, GetEventHandle,        "GetEventHandle"},
+    {0x00080040, SetGain,               "SetGain"},
+    {0x00090000, GetGain,               "GetGain"},
+    {0x000A0040, SetPower,              "SetPower"},
+    {0x000B0000, GetPower,              "GetPower"},
     {0x000C0042, nullptr,               "size"},
-    {0x000D0040, nullptr,               "SetClamp"},
-    {0x000E0000, nullptr,               "GetClamp"},
+    {0x000D0040, SetClamp,              "SetClamp"},
+    {0x000E0000, GetClamp,              "GetClamp"},
     {0x000F0040, nullptr,               "SetAllowShellClosed"},
     {0x00100040, nullptr,               "unknown_input2"},
 };
@@ -33,6 +259,19 @@ const Interface::FunctionInfo FunctionTable[] = {
 
 Interface::Interface() {
     Register(FunctionTable);
+
+    buffer_full_event = Kernel::Event::Create(Kernel::ResetType::OneShot,
+                                              "MIC_U::buffer_full_event");
+    sample_tick_event = CoreTiming::RegisterEvent("MIC_U::SampleTick", SampleTickCallback);
+    tick_scheduled = false;
+    is_sampling = false;
+    write_offset = 0;
+}
+
+Interface::~Interface() {
+    is_sampling = false;
+    shared_memory = nullptr;
+    buffer_full_event = nullptr;
 }
 
 } // namespace
@@ -16,6 +16,7 @@ namespace MIC_U {
 class Interface : public Service::Interface {
 public:
     Interface();
+    ~Interface();
 
     std::string GetPortName() const override {
         return "mic:u";
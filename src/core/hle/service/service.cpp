@@ -5,6 +5,11 @@
 #include "common/logging/log.h"
 #include "common/string_util.h"
 
+#include "core/core.h"
+#include "core/arm/arm_interface.h"
+
+#include "core/hle/dispatch_profiler.h"
+#include "core/hle/flight_recorder.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/ac_u.h"
 #include "core/hle/service/act_a.h"
@@ -63,28 +68,54 @@ static std::string MakeFunctionString(const char* name, const char* port_name, c
 
 ResultVal<bool> Interface::SyncRequest() {
     u32* cmd_buff = Kernel::GetCommandBuffer();
-    auto itr = m_functions.find(cmd_buff[0]);
+    const u32 header = cmd_buff[0];
+    const u32 ordinal = header >> 16;
+
+    // Dispatch is a single array index; a full header comparison still guards against a call
+    // with the right ordinal but mismatched parameter descriptor.
+    const FunctionInfo* info = nullptr;
+    if (ordinal < m_functions.size() && m_functions[ordinal].id == header)
+        info = &m_functions[ordinal];
 
-    if (itr == m_functions.end() || itr->second.func == nullptr) {
-        std::string function_name = (itr == m_functions.end()) ? Common::StringFromFormat("0x%08X", cmd_buff[0]) : itr->second.name;
+    if (info == nullptr || info->func == nullptr) {
+        std::string function_name = (info == nullptr) ? Common::StringFromFormat("0x%08X", header) : info->name;
         LOG_ERROR(Service, "unknown / unimplemented %s", MakeFunctionString(function_name.c_str(), GetPortName().c_str(), cmd_buff).c_str());
 
         // TODO(bunnei): Hack - ignore error
         cmd_buff[1] = 0;
         return MakeResult<bool>(false);
     }
-    LOG_TRACE(Service, "%s", MakeFunctionString(itr->second.name, GetPortName().c_str(), cmd_buff).c_str());
+    LOG_TRACE(Service, "%s", MakeFunctionString(info->name, GetPortName().c_str(), cmd_buff).c_str());
+
+    // One histogram entry per port; the function name within the port travels along as the
+    // detail for the slowest-calls list. The PC is captured before dispatch since the handler
+    // may reschedule to another thread.
+    if (profiler_entry == 0) {
+        port_name = GetPortName();
+        profiler_entry = HLE::DispatchProfiler::RegisterEntry("service", port_name.c_str());
+    }
+    const u32 caller_pc = Core::CurrentCpuCore().GetPC();
+
+    HLE::FlightRecorder::RecordServiceCall(port_name.c_str(), info->name, header, caller_pc,
+                                           &cmd_buff[1]);
+
+    const u64 start_cycles = HLE::DispatchProfiler::GetCycleCount();
+
+    info->func(this);
 
-    itr->second.func(this);
+    HLE::DispatchProfiler::Record(profiler_entry,
+                                  HLE::DispatchProfiler::GetCycleCount() - start_cycles,
+                                  caller_pc, info->name);
 
     return MakeResult<bool>(false); // TODO: Implement return from actual function
 }
 
 void Interface::Register(const FunctionInfo* functions, size_t n) {
-    m_functions.reserve(n);
     for (size_t i = 0; i < n; ++i) {
-        // Usually this array is sorted by id already, so hint to instead at the end
-        m_functions.emplace_hint(m_functions.cend(), functions[i].id, functions[i]);
+        const u32 ordinal = functions[i].id >> 16;
+        if (ordinal >= m_functions.size())
+            m_functions.resize(ordinal + 1, FunctionInfo{ 0, nullptr, nullptr });
+        m_functions[ordinal] = functions[i];
     }
 }
 
@@ -7,8 +7,7 @@
 #include <cstddef>
 #include <string>
 #include <unordered_map>
-
-#include <boost/container/flat_map.hpp>
+#include <vector>
 
 #include "common/common_types.h"
 
@@ -61,8 +60,18 @@ protected:
     void Register(const FunctionInfo* functions, size_t n);
 
 private:
-    boost::container::flat_map<u32, FunctionInfo> m_functions;
+    /**
+     * Dispatch table indexed by function ordinal (the high 16 bits of the command header), so
+     * resolving a service function is an array index instead of a map lookup. Unused ordinals
+     * hold a null entry. The stored header is still compared in full on dispatch.
+     */
+    std::vector<FunctionInfo> m_functions;
+
+    /// Dispatch profiler entry for this port, registered on the first dispatched request
+    u32 profiler_entry = 0;
 
+    /// Port name cached at first dispatch; the flight recorder keeps pointers into it
+    std::string port_name;
 };
 
 /// Initialize ServiceManager
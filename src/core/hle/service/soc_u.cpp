@@ -3,7 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -12,8 +17,12 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
+#include "common/thread.h"
+#include "common/thread_topology.h"
 
+#include "core/core_timing.h"
 #include "core/hle/kernel/session.h"
+#include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 #include "core/hle/service/soc_u.h"
 #include "core/memory.h"
@@ -333,6 +342,292 @@ static void CleanupSockets() {
     open_sockets.clear();
 }
 
+/// Checks whether a guest socket is in blocking mode, i.e. whether an operation on it may stall
+static bool IsSocketBlocking(u32 socket_handle) {
+#ifdef _WIN32
+    auto iter = open_sockets.find(socket_handle);
+    return iter == open_sockets.end() || iter->second.blocking;
+#else
+    int flags = ::fcntl(socket_handle, F_GETFL, 0);
+    return flags == SOCKET_ERROR_VALUE || (flags & O_NONBLOCK) == 0;
+#endif
+}
+
+/**
+ * A potentially-blocking socket operation in flight on the poller thread. The guest thread that
+ * issued it sleeps until the poller reports the socket ready, the syscall has been executed and
+ * the completion callback has written the reply into the thread's command buffer.
+ */
+struct AsyncSocketJob {
+    enum class Op {
+        Accept,
+        Connect,
+        RecvFrom,
+        SendTo,
+        Poll,
+    };
+
+    Op op;
+    u32 socket_handle = 0;
+    Kernel::SharedPtr<Kernel::Thread> thread; ///< Guest thread sleeping until this job completes
+
+    // Inputs, captured from guest memory before the thread goes to sleep
+    u32 len = 0;
+    u32 flags = 0;
+    socklen_t max_addr_len = 0;          ///< Accept: size of the guest's address output buffer
+    sockaddr dest_addr;                  ///< SendTo destination
+    bool has_dest_addr = false;
+    std::vector<u8> input_buff;          ///< SendTo payload
+    VAddr output_buffer_addr = 0;        ///< RecvFrom data output
+    VAddr output_src_address_buffer = 0; ///< RecvFrom source address output
+    VAddr output_static_buffer = 0;      ///< Accept address output
+    VAddr output_fds_addr = 0;           ///< Poll results output
+    std::vector<pollfd> poll_fds;        ///< Poll set; revents are filled in by the poller
+    std::chrono::steady_clock::time_point poll_deadline;
+    bool poll_infinite = false;          ///< Poll was called with a negative timeout
+
+    // Results, filled in by the poller thread
+    int ret = 0;
+    int result = 0;
+    sockaddr addr;                       ///< Accept peer / RecvFrom source address
+    socklen_t addr_len = 0;
+    std::vector<u8> output_buff;         ///< RecvFrom payload
+    bool done = false;
+};
+
+/// In-flight socket jobs, indexed by the job id carried in the completion event's userdata
+static std::vector<std::unique_ptr<AsyncSocketJob>> async_jobs;
+static std::mutex async_jobs_mutex;
+static std::condition_variable async_jobs_cv;
+static std::thread soc_poller_thread;
+static bool soc_poller_exit = false;
+static int async_completion_event;
+
+/// Executes a job whose socket the poller reported ready. Runs on the poller thread; the socket
+/// is ready, so the syscall completes without blocking in practice.
+static void ExecuteAsyncJob(AsyncSocketJob* job) {
+    switch (job->op) {
+    case AsyncSocketJob::Op::Accept: {
+        job->addr_len = sizeof(job->addr);
+        job->ret = static_cast<int>(::accept(job->socket_handle, &job->addr, &job->addr_len));
+        job->result = (job->ret == SOCKET_ERROR_VALUE) ? TranslateError(GET_ERRNO) : 0;
+        break;
+    }
+    case AsyncSocketJob::Op::Connect: {
+        // The connection was initiated without blocking; the socket turning writable means it
+        // has either completed or failed, with the outcome stored in SO_ERROR.
+        int err = 0;
+        socklen_t err_len = sizeof(err);
+        ::getsockopt(job->socket_handle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&err), &err_len);
+        job->ret = (err == 0) ? 0 : SOCKET_ERROR_VALUE;
+        job->result = (err == 0) ? 0 : TranslateError(err);
+        break;
+    }
+    case AsyncSocketJob::Op::RecvFrom: {
+        job->output_buff.resize(job->len);
+        job->addr_len = sizeof(job->addr);
+        job->ret = ::recvfrom(job->socket_handle, reinterpret_cast<char*>(job->output_buff.data()),
+                              job->len, job->flags, &job->addr, &job->addr_len);
+        job->result = (job->ret == SOCKET_ERROR_VALUE) ? TranslateError(GET_ERRNO) : 0;
+        break;
+    }
+    case AsyncSocketJob::Op::SendTo: {
+        if (job->has_dest_addr) {
+            job->ret = ::sendto(job->socket_handle, reinterpret_cast<const char*>(job->input_buff.data()),
+                                job->len, job->flags, &job->dest_addr, sizeof(job->dest_addr));
+        } else {
+            job->ret = ::sendto(job->socket_handle, reinterpret_cast<const char*>(job->input_buff.data()),
+                                job->len, job->flags, nullptr, 0);
+        }
+        job->result = (job->ret == SOCKET_ERROR_VALUE) ? TranslateError(GET_ERRNO) : 0;
+        break;
+    }
+    case AsyncSocketJob::Op::Poll:
+        // Results are recorded by the poller loop itself
+        break;
+    }
+}
+
+/// Poller thread: waits on every pending job's socket at once and executes the ones that become
+/// ready, so a slow peer can never stall the emulation thread.
+static void SocPollerLoop() {
+    Common::RegisterCurrentThread(Common::ThreadRole::IO, "SOC Poller");
+
+    std::unique_lock<std::mutex> lock(async_jobs_mutex);
+    while (true) {
+        if (soc_poller_exit) {
+            Common::UnregisterCurrentThread();
+            return;
+        }
+
+        std::vector<std::pair<size_t, AsyncSocketJob*>> active;
+        for (size_t i = 0; i < async_jobs.size(); ++i) {
+            if (async_jobs[i] != nullptr && !async_jobs[i]->done)
+                active.emplace_back(i, async_jobs[i].get());
+        }
+
+        if (active.empty()) {
+            async_jobs_cv.wait(lock);
+            continue;
+        }
+
+        // Build one combined pollfd set covering every pending job.
+        std::vector<pollfd> fds;
+        std::vector<size_t> job_first_fd(active.size());
+        // Cap the wait so newly enqueued jobs and shutdown are picked up promptly.
+        int timeout_ms = 100;
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < active.size(); ++i) {
+            AsyncSocketJob* job = active[i].second;
+            job_first_fd[i] = fds.size();
+            if (job->op == AsyncSocketJob::Op::Poll) {
+                fds.insert(fds.end(), job->poll_fds.begin(), job->poll_fds.end());
+                if (!job->poll_infinite) {
+                    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            job->poll_deadline - now).count();
+                    timeout_ms = std::min<int>(timeout_ms, std::max<int>(0, static_cast<int>(remaining)));
+                }
+            } else {
+                pollfd pfd;
+                pfd.fd = job->socket_handle;
+                pfd.events = (job->op == AsyncSocketJob::Op::SendTo ||
+                              job->op == AsyncSocketJob::Op::Connect) ? POLLOUT : POLLIN;
+                pfd.revents = 0;
+                fds.push_back(pfd);
+            }
+        }
+
+        lock.unlock();
+        int poll_ret = 0;
+        if (fds.empty()) {
+            // Only fd-less Poll jobs are pending (pure sleeps); WSAPoll rejects an empty set
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        } else {
+            poll_ret = ::poll(fds.data(), static_cast<unsigned int>(fds.size()), timeout_ms);
+        }
+
+        std::vector<size_t> completed;
+        if (poll_ret >= 0) {
+            const auto after = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < active.size(); ++i) {
+                AsyncSocketJob* job = active[i].second;
+                if (job->op == AsyncSocketJob::Op::Poll) {
+                    int ready = 0;
+                    for (size_t j = 0; j < job->poll_fds.size(); ++j) {
+                        job->poll_fds[j].revents = fds[job_first_fd[i] + j].revents;
+                        if (job->poll_fds[j].revents != 0)
+                            ++ready;
+                    }
+                    if (ready > 0 || (!job->poll_infinite && after >= job->poll_deadline)) {
+                        job->ret = ready;
+                        job->result = 0;
+                        completed.push_back(active[i].first);
+                    }
+                } else if (fds[job_first_fd[i]].revents != 0) {
+                    ExecuteAsyncJob(job);
+                    completed.push_back(active[i].first);
+                }
+            }
+        }
+        lock.lock();
+
+        for (size_t job_id : completed) {
+            async_jobs[job_id]->done = true;
+            CoreTiming::ScheduleEvent_Threadsafe(0, async_completion_event, job_id);
+        }
+    }
+}
+
+/// Writes a completed job's reply into the issuing thread's command buffer and wakes it. Runs on
+/// the emulation thread via CoreTiming, so guest memory and open_sockets are safe to touch.
+static void AsyncSocketCompletionCallback(u64 job_id, int cycles_late) {
+    std::unique_ptr<AsyncSocketJob> job;
+    {
+        std::lock_guard<std::mutex> lock(async_jobs_mutex);
+        job = std::move(async_jobs[job_id]);
+    }
+    if (job == nullptr)
+        return;
+
+    const VAddr cmd_buff = job->thread->GetTLSAddress() + Kernel::kCommandHeaderOffset;
+    switch (job->op) {
+    case AsyncSocketJob::Op::Accept:
+        if (job->ret != SOCKET_ERROR_VALUE) {
+            u32 accepted = static_cast<u32>(job->ret);
+            open_sockets[accepted] = { accepted, true };
+            CTRSockAddr ctr_addr = CTRSockAddr::FromPlatform(job->addr);
+            Memory::WriteBlock(job->output_static_buffer, &ctr_addr, sizeof(ctr_addr));
+        }
+        Memory::Write32(cmd_buff + 0 * sizeof(u32), IPC::MakeHeader(4, 2, 2));
+        Memory::Write32(cmd_buff + 1 * sizeof(u32), static_cast<u32>(job->result));
+        Memory::Write32(cmd_buff + 2 * sizeof(u32), static_cast<u32>(job->ret));
+        Memory::Write32(cmd_buff + 3 * sizeof(u32),
+                        IPC::StaticBufferDesc(static_cast<u32>(job->max_addr_len), 0));
+        break;
+    case AsyncSocketJob::Op::Connect:
+        Memory::Write32(cmd_buff + 0 * sizeof(u32), IPC::MakeHeader(6, 2, 0));
+        Memory::Write32(cmd_buff + 1 * sizeof(u32), static_cast<u32>(job->result));
+        Memory::Write32(cmd_buff + 2 * sizeof(u32), static_cast<u32>(job->ret));
+        break;
+    case AsyncSocketJob::Op::RecvFrom: {
+        int total_received = (job->ret == SOCKET_ERROR_VALUE) ? 0 : job->ret;
+        if (job->ret >= 0 && job->output_src_address_buffer != 0 && job->addr_len > 0) {
+            CTRSockAddr ctr_src_addr = CTRSockAddr::FromPlatform(job->addr);
+            Memory::WriteBlock(job->output_src_address_buffer, &ctr_src_addr, sizeof(ctr_src_addr));
+        }
+        // Write only the data we received to avoid overwriting parts of the buffer with zeros
+        if (total_received > 0)
+            Memory::WriteBlock(job->output_buffer_addr, job->output_buff.data(), total_received);
+        Memory::Write32(cmd_buff + 1 * sizeof(u32), static_cast<u32>(job->result));
+        Memory::Write32(cmd_buff + 2 * sizeof(u32), static_cast<u32>(job->ret));
+        Memory::Write32(cmd_buff + 3 * sizeof(u32), static_cast<u32>(total_received));
+        break;
+    }
+    case AsyncSocketJob::Op::SendTo:
+        Memory::Write32(cmd_buff + 1 * sizeof(u32), static_cast<u32>(job->result));
+        Memory::Write32(cmd_buff + 2 * sizeof(u32), static_cast<u32>(job->ret));
+        break;
+    case AsyncSocketJob::Op::Poll: {
+        std::vector<CTRPollFD> ctr_fds(job->poll_fds.size());
+        std::transform(job->poll_fds.begin(), job->poll_fds.end(), ctr_fds.begin(),
+                       CTRPollFD::FromPlatform);
+        Memory::WriteBlock(job->output_fds_addr, ctr_fds.data(), ctr_fds.size() * sizeof(CTRPollFD));
+        Memory::Write32(cmd_buff + 1 * sizeof(u32), static_cast<u32>(job->result));
+        Memory::Write32(cmd_buff + 2 * sizeof(u32), static_cast<u32>(job->ret));
+        break;
+    }
+    }
+
+    job->thread->ResumeFromWait();
+}
+
+/**
+ * Hands a job to the poller thread. The caller must put the current guest thread to sleep
+ * afterwards; the completion callback wakes it.
+ * @return True if the job was queued, false if the poller is not running and the caller must
+ *         perform the operation synchronously.
+ */
+static bool EnqueueAsyncSocketJob(std::unique_ptr<AsyncSocketJob> job) {
+    {
+        std::lock_guard<std::mutex> lock(async_jobs_mutex);
+        if (!soc_poller_thread.joinable() || soc_poller_exit)
+            return false;
+
+        size_t job_id = async_jobs.size();
+        for (size_t i = 0; i < async_jobs.size(); ++i) {
+            if (async_jobs[i] == nullptr) {
+                job_id = i;
+                break;
+            }
+        }
+        if (job_id == async_jobs.size())
+            async_jobs.emplace_back();
+        async_jobs[job_id] = std::move(job);
+    }
+    async_jobs_cv.notify_one();
+    return true;
+}
+
 static void Socket(Service::Interface* self) {
     u32* cmd_buffer = Kernel::GetCommandBuffer();
     u32 domain = cmd_buffer[1]; // Address family
@@ -482,12 +777,25 @@ static void Listen(Service::Interface* self) {
 }
 
 static void Accept(Service::Interface* self) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     u32* cmd_buffer = Kernel::GetCommandBuffer();
     u32 socket_handle = cmd_buffer[1];
     socklen_t max_addr_len = static_cast<socklen_t>(cmd_buffer[2]);
+
+    // A blocking accept would stall the emulation thread until a peer connects; hand it to the
+    // poller and put the guest thread to sleep instead.
+    if (IsSocketBlocking(socket_handle)) {
+        auto job = std::make_unique<AsyncSocketJob>();
+        job->op = AsyncSocketJob::Op::Accept;
+        job->socket_handle = socket_handle;
+        job->max_addr_len = max_addr_len;
+        job->output_static_buffer = cmd_buffer[0x104 >> 2];
+        job->thread = Kernel::GetCurrentThread();
+        if (EnqueueAsyncSocketJob(std::move(job))) {
+            Kernel::WaitCurrentThread_Sleep();
+            return;
+        }
+    }
+
     sockaddr addr;
     socklen_t addr_len = sizeof(addr);
     u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
@@ -570,6 +878,28 @@ static void SendTo(Service::Interface* self) {
     CTRSockAddr ctr_dest_addr;
     Memory::ReadBlock(dest_addr_addr, &ctr_dest_addr, sizeof(ctr_dest_addr));
 
+    // A full send buffer (slow peer) makes a blocking send stall; let the poller wait for the
+    // socket to become writable instead.
+    if (IsSocketBlocking(socket_handle)) {
+        auto job = std::make_unique<AsyncSocketJob>();
+        job->op = AsyncSocketJob::Op::SendTo;
+        job->socket_handle = socket_handle;
+        job->len = len;
+        job->flags = flags;
+        job->input_buff = std::move(input_buff);
+        job->has_dest_addr = addr_len > 0;
+        if (job->has_dest_addr)
+            job->dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
+        job->thread = Kernel::GetCurrentThread();
+        if (EnqueueAsyncSocketJob(std::move(job))) {
+            Kernel::WaitCurrentThread_Sleep();
+            return;
+        }
+        // The poller is not running; redo the capture the job consumed and send synchronously.
+        input_buff.resize(len);
+        Memory::ReadBlock(input_buff_address, input_buff.data(), input_buff.size());
+    }
+
     int ret = -1;
     if (addr_len > 0) {
         sockaddr dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
@@ -587,9 +917,6 @@ static void SendTo(Service::Interface* self) {
 }
 
 static void RecvFrom(Service::Interface* self) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     u32* cmd_buffer = Kernel::GetCommandBuffer();
     u32 socket_handle = cmd_buffer[1];
     u32 len = cmd_buffer[2];
@@ -616,10 +943,27 @@ static void RecvFrom(Service::Interface* self) {
         return;
     }
 
-    std::vector<u8> output_buff(len);
+    // A blocking receive waits for the peer to send; run it on the poller thread so network
+    // latency never stalls emulation.
+    if (IsSocketBlocking(socket_handle)) {
+        auto job = std::make_unique<AsyncSocketJob>();
+        job->op = AsyncSocketJob::Op::RecvFrom;
+        job->socket_handle = socket_handle;
+        job->len = len;
+        job->flags = flags;
+        job->output_buffer_addr = buffer_parameters.output_buffer_addr;
+        job->output_src_address_buffer = buffer_parameters.output_src_address_buffer;
+        job->thread = Kernel::GetCurrentThread();
+        if (EnqueueAsyncSocketJob(std::move(job))) {
+            Kernel::WaitCurrentThread_Sleep();
+            return;
+        }
+    }
+
+    u8* output_buff = self->BorrowScratch(len);
     sockaddr src_addr;
     socklen_t src_addr_len = sizeof(src_addr);
-    int ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags, &src_addr, &src_addr_len);
+    int ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff), len, flags, &src_addr, &src_addr_len);
 
     if (ret >= 0 && buffer_parameters.output_src_address_buffer != 0 && src_addr_len > 0) {
         CTRSockAddr ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
@@ -633,7 +977,7 @@ static void RecvFrom(Service::Interface* self) {
         total_received = 0;
     } else {
         // Write only the data we received to avoid overwriting parts of the buffer with zeros
-        Memory::WriteBlock(buffer_parameters.output_buffer_addr, output_buff.data(), total_received);
+        Memory::WriteBlock(buffer_parameters.output_buffer_addr, output_buff, total_received);
     }
 
     cmd_buffer[1] = result;
@@ -661,6 +1005,25 @@ static void Poll(Service::Interface* self) {
     std::vector<pollfd> platform_pollfd(nfds);
     std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd.begin(), CTRPollFD::ToPlatform);
 
+    // A zero timeout can never block, so answer it inline; anything else goes to the poller so
+    // the wait happens off the emulation thread.
+    if (timeout != 0) {
+        auto job = std::make_unique<AsyncSocketJob>();
+        job->op = AsyncSocketJob::Op::Poll;
+        job->poll_fds = std::move(platform_pollfd);
+        job->poll_infinite = timeout < 0;
+        if (!job->poll_infinite)
+            job->poll_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        job->output_fds_addr = output_fds_addr;
+        job->thread = Kernel::GetCurrentThread();
+        if (EnqueueAsyncSocketJob(std::move(job))) {
+            Kernel::WaitCurrentThread_Sleep();
+            return;
+        }
+        platform_pollfd.resize(nfds);
+        std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd.begin(), CTRPollFD::ToPlatform);
+    }
+
     const int ret = ::poll(platform_pollfd.data(), nfds, timeout);
 
     // Now update the output pollfd structure
@@ -746,9 +1109,6 @@ static void GetPeerName(Service::Interface* self) {
 }
 
 static void Connect(Service::Interface* self) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     u32* cmd_buffer = Kernel::GetCommandBuffer();
     u32 socket_handle = cmd_buffer[1];
     socklen_t len = cmd_buffer[2];
@@ -764,7 +1124,46 @@ static void Connect(Service::Interface* self) {
     Memory::ReadBlock(ctr_input_addr_addr, &ctr_input_addr, sizeof(ctr_input_addr));
 
     sockaddr input_addr = CTRSockAddr::ToPlatform(ctr_input_addr);
-    int ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
+
+    int ret;
+    if (IsSocketBlocking(socket_handle)) {
+        // Initiate the connection with blocking temporarily disabled; if it does not complete
+        // immediately, the poller waits for the socket to become writable and the outcome is
+        // read back from SO_ERROR, so the handshake never stalls the emulation thread.
+#ifdef _WIN32
+        unsigned long enable = 1, disable = 0;
+        ioctlsocket(socket_handle, FIONBIO, &enable);
+        ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
+        int initiate_error = GET_ERRNO;
+        ioctlsocket(socket_handle, FIONBIO, &disable);
+#else
+        int socket_flags = ::fcntl(socket_handle, F_GETFL, 0);
+        ::fcntl(socket_handle, F_SETFL, socket_flags | O_NONBLOCK);
+        ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
+        int initiate_error = GET_ERRNO;
+        ::fcntl(socket_handle, F_SETFL, socket_flags);
+#endif
+        if (ret != 0 && (initiate_error == ERRNO(EINPROGRESS) || initiate_error == ERRNO(EWOULDBLOCK))) {
+            auto job = std::make_unique<AsyncSocketJob>();
+            job->op = AsyncSocketJob::Op::Connect;
+            job->socket_handle = socket_handle;
+            job->thread = Kernel::GetCurrentThread();
+            if (EnqueueAsyncSocketJob(std::move(job))) {
+                Kernel::WaitCurrentThread_Sleep();
+                return;
+            }
+        }
+        int result = 0;
+        if (ret != 0)
+            result = TranslateError(initiate_error);
+
+        cmd_buffer[0] = IPC::MakeHeader(6, 2, 0);
+        cmd_buffer[1] = result;
+        cmd_buffer[2] = ret;
+        return;
+    }
+
+    ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
     int result = 0;
     if (ret != 0)
         result = TranslateError(GET_ERRNO);
@@ -904,10 +1303,31 @@ const Interface::FunctionInfo FunctionTable[] = {
 // Interface class
 
 Interface::Interface() {
+    async_completion_event =
+        CoreTiming::RegisterEvent("AsyncSocketCompletion", AsyncSocketCompletionCallback);
+    soc_poller_exit = false;
+    soc_poller_thread = std::thread(SocPollerLoop);
+
     Register(FunctionTable);
 }
 
 Interface::~Interface() {
+    // Stop the poller; jobs that were still waiting on a peer are abandoned, their guest
+    // threads are going away along with the rest of the emulated state.
+    {
+        std::lock_guard<std::mutex> lock(async_jobs_mutex);
+        soc_poller_exit = true;
+    }
+    async_jobs_cv.notify_one();
+    if (soc_poller_thread.joinable())
+        soc_poller_thread.join();
+
+    CoreTiming::RemoveThreadsafeEvent(async_completion_event);
+    {
+        std::lock_guard<std::mutex> lock(async_jobs_mutex);
+        async_jobs.clear();
+    }
+
     CleanupSockets();
 #ifdef _WIN32
     WSACleanup();
@@ -6,6 +6,7 @@
 
 #include "common/common_types.h"
 #include "core/hle/service/ssl_c.h"
+#include "core/settings.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Namespace SSL_C
@@ -18,9 +19,14 @@ static std::mt19937 rand_gen;
 static void Initialize(Service::Interface* self) {
     u32* cmd_buff = Kernel::GetCommandBuffer();
 
-    // Seed random number generator when the SSL service is initialized
-    std::random_device rand_device;
-    rand_gen.seed(rand_device());
+    // Seed random number generator when the SSL service is initialized. Deterministic
+    // runs use a fixed seed so the data handed to the game is identical across runs.
+    if (Settings::values.deterministic_mode) {
+        rand_gen.seed(std::mt19937::default_seed);
+    } else {
+        std::random_device rand_device;
+        rand_gen.seed(rand_device());
+    }
 
     // Stub, return success
     cmd_buff[1] = RESULT_SUCCESS.raw;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <map>
 
 #include "common/logging/log.h"
@@ -10,8 +11,11 @@
 #include "common/string_util.h"
 #include "common/symbols.h"
 
+#include "core/core.h"
 #include "core/core_timing.h"
 #include "core/arm/arm_interface.h"
+#include "core/hle/dispatch_profiler.h"
+#include "core/hle/flight_recorder.h"
 
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
@@ -229,7 +233,10 @@ static ResultCode SendSyncRequest(Handle handle) {
 
     LOG_TRACE(Kernel_SVC, "called handle=0x%08X(%s)", handle, session->GetName().c_str());
 
-    return session->SyncRequest().Code();
+    ResultCode result = session->SyncRequest().Code();
+    // Scratch storage the handler borrowed for staging is only valid until the reply
+    session->ResetScratch();
+    return result;
 }
 
 /// Close a handle
@@ -257,7 +264,9 @@ static ResultCode WaitSynchronization1(Handle handle, s64 nano_seconds) {
     if (object->ShouldWait()) {
 
         object->AddWaitingThread(thread);
-        Kernel::WaitCurrentThread_WaitSynchronization({ object }, false, false);
+        thread->wait_objects.clear();
+        thread->wait_objects.push_back(object);
+        Kernel::WaitCurrentThread_WaitSynchronization(false, false);
 
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
@@ -335,16 +344,17 @@ static ResultCode WaitSynchronizationN(s32* out, Handle* handles, s32 handle_cou
     if (wait_thread) {
 
         // Actually wait the current thread on each object if we decided to wait...
-        std::vector<SharedPtr<Kernel::WaitObject>> wait_objects;
-        wait_objects.reserve(handle_count);
+        // The thread's wait list is filled in place; its capacity persists across waits, so no
+        // temporary vector is built per call.
+        thread->wait_objects.clear();
 
         for (int i = 0; i < handle_count; ++i) {
             auto object = Kernel::g_handle_table.GetWaitObject(handles[i]);
-            object->AddWaitingThread(Kernel::GetCurrentThread());
-            wait_objects.push_back(object);
+            object->AddWaitingThread(thread);
+            thread->wait_objects.push_back(std::move(object));
         }
 
-        Kernel::WaitCurrentThread_WaitSynchronization(std::move(wait_objects), true, wait_all);
+        Kernel::WaitCurrentThread_WaitSynchronization(true, wait_all);
 
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         Kernel::GetCurrentThread()->WakeAfterDelay(nano_seconds);
@@ -498,9 +508,9 @@ static ResultCode CreateThread(Handle* out_handle, s32 priority, u32 entry_point
         break;
     }
 
-    if (processor_id == THREADPROCESSORID_1 || processor_id == THREADPROCESSORID_ALL ||
-        (processor_id == THREADPROCESSORID_DEFAULT && Kernel::g_current_process->ideal_processor == THREADPROCESSORID_1)) {
-        LOG_WARNING(Kernel_SVC, "Newly created thread is allowed to be run in the SysCore, unimplemented.");
+    if (processor_id == THREADPROCESSORID_ALL) {
+        LOG_WARNING(Kernel_SVC, "Newly created thread is allowed to run on either core; "
+                    "migration is unimplemented, so it stays on the AppCore.");
     }
 
     CASCADE_RESULT(SharedPtr<Thread> thread, Kernel::Thread::Create(
@@ -519,7 +529,7 @@ static ResultCode CreateThread(Handle* out_handle, s32 priority, u32 entry_point
 
 /// Called when a thread exits
 static void ExitThread() {
-    LOG_TRACE(Kernel_SVC, "called, pc=0x%08X", Core::g_app_core->GetPC());
+    LOG_TRACE(Kernel_SVC, "called, pc=0x%08X", Core::CurrentCpuCore().GetPC());
 
     Kernel::GetCurrentThread()->Stop();
 }
@@ -783,7 +793,7 @@ static void SleepThread(s64 nanoseconds) {
 static s64 GetSystemTick() {
     s64 result = CoreTiming::GetTicks();
     // Advance time to defeat dumb games (like Cubic Ninja) that busy-wait for the frame to end.
-    Core::g_app_core->AddTicks(150); // Measured time between two calls on a 9.2 o3DS with Ninjhax 1.1b
+    Core::CurrentCpuCore().AddTicks(150); // Measured time between two calls on a 9.2 o3DS with Ninjhax 1.1b
     return result;
 }
 
@@ -1103,7 +1113,24 @@ void CallSVC(u32 immediate) {
     const FunctionDef* info = GetSVCInfo(immediate);
     if (info) {
         if (info->func) {
+            // One histogram entry per SVC number, registered on first use. The PC is captured
+            // before dispatch since the handler may reschedule to another thread.
+            static std::array<u32, ARRAY_SIZE(SVC_Table)> profiler_entries{};
+            u32& entry = profiler_entries[immediate];
+            if (entry == 0)
+                entry = HLE::DispatchProfiler::RegisterEntry("svc", info->name);
+
+            const u32 caller_pc = Core::CurrentCpuCore().GetPC();
+
+            u32 args[HLE::FlightRecorder::NUM_EVENT_ARGS];
+            for (u32 i = 0; i < HLE::FlightRecorder::NUM_EVENT_ARGS; ++i)
+                args[i] = Core::CurrentCpuCore().GetReg(i);
+            HLE::FlightRecorder::RecordSVC(immediate, info->name, caller_pc, args);
+
+            const u64 start_cycles = HLE::DispatchProfiler::GetCycleCount();
             info->func();
+            HLE::DispatchProfiler::Record(entry, HLE::DispatchProfiler::GetCycleCount() - start_cycles,
+                                     caller_pc);
         } else {
             LOG_ERROR(Kernel_SVC, "unimplemented SVC function %s(..)", info->name);
         }
@@ -2,19 +2,31 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <memory>
 #include <numeric>
+#include <thread>
 #include <type_traits>
+#include <vector>
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread.h"
 #include "common/vector_math.h"
 
 #include "core/settings.h"
 #include "core/memory.h"
 #include "core/core_timing.h"
+#include "core/frame_limiter.h"
+#include "core/rewind.h"
 
 #include "core/hle/service/gsp_gpu.h"
 #include "core/hle/service/hid/hid.h"
@@ -24,6 +36,7 @@
 
 #include "core/tracer/recorder.h"
 
+#include "video_core/color_convert.h"
 #include "video_core/command_processor.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
@@ -45,8 +58,15 @@ const u64 frame_ticks = 268123480ull / 60;
 static int vblank_event;
 /// Total number of frames drawn
 static u64 frame_count;
-/// True if the last frame was skipped
-static bool last_skip_frame;
+/// Wall-clock budget of one emulated frame (frame_ticks at the 268MHz clock rate)
+static const std::chrono::microseconds frame_budget(16667);
+/// Wall-clock time of the previous VBlank, used to detect falling behind schedule
+static std::chrono::steady_clock::time_point previous_vblank_time;
+/// Number of upcoming frames the skip pattern stays engaged after falling behind
+static int frames_behind_schedule;
+/// Settings snapshot refreshed once per VBlank; per-frame decisions read this local copy
+static Settings::Values settings_snapshot;
+static u32 settings_snapshot_version;
 
 template <typename T>
 inline void Read(T &var, const u32 raw_addr) {
@@ -85,22 +105,159 @@ static Math::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_
     }
 }
 
-MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
-MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
+/// Fills [start, end) with a repeated 16-bit value using wide stores where available
+static void FillMemory16(u8* start, u8* end, u16 value) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128i wide_value = _mm_set1_epi16(value);
+    for (; start + 16 <= end; start += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(start), wide_value);
+#endif
+    for (; start + sizeof(u16) <= end; start += sizeof(u16))
+        memcpy(start, &value, sizeof(u16));
+}
 
-template <typename T>
-inline void Write(u32 addr, const T data) {
-    addr -= HW::VADDR_GPU;
-    u32 index = addr / 4;
+/// Fills [start, end) with a repeated 32-bit value using wide stores where available
+static void FillMemory32(u8* start, u8* end, u32 value) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128i wide_value = _mm_set1_epi32(value);
+    for (; start + 16 <= end; start += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(start), wide_value);
+#endif
+    for (; start + sizeof(u32) <= end; start += sizeof(u32))
+        memcpy(start, &value, sizeof(u32));
+}
 
-    // Writes other than u32 are untested, so I'd rather have them abort than silently fail
-    if (index >= Regs::NumIds() || !std::is_same<T, u32>::value) {
-        LOG_ERROR(HW_GPU, "unknown Write%lu 0x%08X @ 0x%08X", sizeof(data) * 8, (u32)data, addr);
+/// Fills [start, end) with a repeated 3-byte value using wide stores where available
+static void FillMemory24(u8* start, u8* end, u8 r, u8 g, u8 b) {
+#ifdef ARCHITECTURE_x86_64
+    // 48 bytes is the smallest multiple of 16 that holds a whole number of 3-byte values,
+    // so three vector stores cover 16 values with the pattern phase preserved
+    u8 pattern[48];
+    for (size_t i = 0; i < sizeof(pattern); i += 3) {
+        pattern[i + 0] = r;
+        pattern[i + 1] = g;
+        pattern[i + 2] = b;
+    }
+    const __m128i pattern0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+    const __m128i pattern1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + 16));
+    const __m128i pattern2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + 32));
+    for (; start + 48 <= end; start += 48) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(start), pattern0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(start + 16), pattern1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(start + 32), pattern2);
+    }
+#endif
+    for (; start + 3 <= end; start += 3) {
+        start[0] = r;
+        start[1] = g;
+        start[2] = b;
+    }
+}
+
+// Worker pool for the CPU fallback of scaled (anti-aliased) display transfers. Like the
+// software rasterizer pool, thread i (the emu thread acting as thread 0) processes output
+// rows i, i + N, i + 2N, ..., so every destination row is owned by exactly one thread.
+// Transfers are memory-bound, so the pool is kept small regardless of core count.
+static std::vector<std::thread> transfer_worker_threads;
+static std::unique_ptr<Common::Barrier> transfer_start_barrier;
+static std::unique_ptr<Common::Barrier> transfer_done_barrier;
+static bool transfer_workers_should_exit = false;
+static unsigned num_transfer_threads = 1; ///< Total threads converting, including the emu thread
+
+/// Scaled transfers with fewer output rows than this are converted on the emu thread alone;
+/// the barrier round-trip costs more than the averaging it would spread out.
+static const u32 MIN_PARALLEL_TRANSFER_ROWS = 64;
+
+/// Description of the row conversion work of the scaled transfer currently being processed
+static struct {
+    const u8* src_linear; ///< Input image, already untiled, at input_width * (rows * scale)
+    u8* dst_rows;         ///< Output rows, linear; retiled by the caller if needed
+    u32 input_width;
+    u32 output_width;
+    u32 output_height;
+    Regs::PixelFormat input_format;
+    Regs::PixelFormat output_format;
+    bool scale_xy;
+    bool flip_vertically;
+} transfer_job;
+
+/// Converts this thread's share of the current scaled transfer's output rows: widen the
+/// input row(s) to RGBA8, average with the vectorized kernels, convert to the output format
+static void RunScaledTransferRows(unsigned thread_index, unsigned num_threads) {
+    const u32 src_bytes_per_pixel = Regs::BytesPerPixel(transfer_job.input_format);
+    const u32 dst_bytes_per_pixel = Regs::BytesPerPixel(transfer_job.output_format);
+    const u32 input_row_pixels = transfer_job.output_width * 2;
+
+    // Scratch rows are retained per thread across transfers, so the steady state allocates
+    // nothing. Averaging happens in the RGBA8 domain, which matches the decoded values the
+    // per-pixel path averaged.
+    static thread_local std::vector<u8> widened0;
+    static thread_local std::vector<u8> widened1;
+    static thread_local std::vector<u8> averaged;
+    widened0.resize(input_row_pixels * 4);
+    averaged.resize(transfer_job.output_width * 4);
+    if (transfer_job.scale_xy)
+        widened1.resize(input_row_pixels * 4);
+
+    for (u32 y = thread_index; y < transfer_job.output_height; y += num_threads) {
+        const u32 input_y = transfer_job.scale_xy ? y * 2 : y;
+        const u8* input_row =
+            transfer_job.src_linear + input_y * transfer_job.input_width * src_bytes_per_pixel;
+
+        VideoCore::ConvertColorRow(transfer_job.input_format, input_row,
+                                   Regs::PixelFormat::RGBA8, widened0.data(), input_row_pixels);
+        if (transfer_job.scale_xy) {
+            VideoCore::ConvertColorRow(transfer_job.input_format,
+                                       input_row + transfer_job.input_width * src_bytes_per_pixel,
+                                       Regs::PixelFormat::RGBA8, widened1.data(), input_row_pixels);
+            VideoCore::Average2x2RGBA8Rows(widened0.data(), widened1.data(), averaged.data(),
+                                           transfer_job.output_width);
+        } else {
+            VideoCore::AveragePairsRGBA8Row(widened0.data(), averaged.data(),
+                                            transfer_job.output_width);
+        }
+
+        const u32 out_y =
+            transfer_job.flip_vertically ? transfer_job.output_height - 1 - y : y;
+        VideoCore::ConvertColorRow(
+            Regs::PixelFormat::RGBA8, averaged.data(), transfer_job.output_format,
+            transfer_job.dst_rows + out_y * transfer_job.output_width * dst_bytes_per_pixel,
+            transfer_job.output_width);
+    }
+}
+
+static void TransferWorkerThread(unsigned thread_index) {
+    Common::SetCurrentThreadName("GPU transfer");
+    while (true) {
+        transfer_start_barrier->Sync();
+        if (transfer_workers_should_exit)
+            return;
+        RunScaledTransferRows(thread_index, num_transfer_threads);
+        transfer_done_barrier->Sync();
+    }
+}
+
+/// Runs the conversion rows of `transfer_job` across the pool (or in place if it's small)
+static void RunScaledTransfer() {
+    if (transfer_worker_threads.empty() ||
+        transfer_job.output_height < MIN_PARALLEL_TRANSFER_ROWS) {
+        RunScaledTransferRows(0, 1);
         return;
     }
 
-    g_regs[index] = static_cast<u32>(data);
+    transfer_start_barrier->Sync();
+    RunScaledTransferRows(0, num_transfer_threads);
+    transfer_done_barrier->Sync();
+}
+
+MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
+MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
 
+/**
+ * Runs the side effects of a write to register `index`: the memory fill, display transfer and
+ * command list triggers. Writes to any other register are plain state updates with no handler.
+ */
+static void RunWriteSideEffects(u32 index) {
     switch (index) {
 
     // Memory fills are triggered once the fill value is written.
@@ -129,24 +286,13 @@ inline void Write(u32 addr, const T data) {
 
                     if (config.fill_24bit) {
                         // fill with 24-bit values
-                        for (u8* ptr = start; ptr < end; ptr += 3) {
-                            ptr[0] = config.value_24bit_r;
-                            ptr[1] = config.value_24bit_g;
-                            ptr[2] = config.value_24bit_b;
-                        }
+                        FillMemory24(start, end, config.value_24bit_r, config.value_24bit_g, config.value_24bit_b);
                     } else if (config.fill_32bit) {
                         // fill with 32-bit values
-                        if (end > start) {
-                            u32 value = config.value_32bit;
-                            size_t len = (end - start) / sizeof(u32);
-                            for (size_t i = 0; i < len; ++i)
-                                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-                        }
+                        FillMemory32(start, end, config.value_32bit);
                     } else {
                         // fill with 16-bit values
-                        u16 value_16bit = config.value_16bit.Value();
-                        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-                            memcpy(ptr, &value_16bit, sizeof(u16));
+                        FillMemory16(start, end, config.value_16bit.Value());
                     }
                 }
 
@@ -177,6 +323,15 @@ inline void Write(u32 addr, const T data) {
             if (Pica::g_debug_context)
                 Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer, nullptr);
 
+            // Skipped frames drop the presentation transfers but still acknowledge them, so
+            // GSP timing is unaffected. Raw texture copies always run; games use those to
+            // move data the next frame depends on.
+            if (g_skip_frame && !config.is_texture_copy) {
+                g_regs.display_transfer_config.trigger = 0;
+                GSP_GPU::SignalInterrupt(GSP_GPU::InterruptId::PPF);
+                break;
+            }
+
             if (!VideoCore::g_renderer->Rasterizer()->AccelerateDisplayTransfer(config)) {
                 u8* src_pointer = Memory::GetPhysicalPointer(config.GetPhysicalInputAddress());
                 u8* dst_pointer = Memory::GetPhysicalPointer(config.GetPhysicalOutputAddress());
@@ -251,7 +406,116 @@ inline void Write(u32 addr, const T data) {
                 Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
                 Memory::RasterizerFlushAndInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-                for (u32 y = 0; y < output_height; ++y) {
+                // When no format conversion, scaling or flipping is involved, the
+                // transfer is a pure (un)swizzle and can copy whole 8x8 tiles at a time
+                // instead of recomputing the Morton offset per pixel.
+                bool whole_tiles_copied = false;
+                if (!config.dont_swizzle && config.scaling == config.NoScale &&
+                    !config.flip_vertically &&
+                    config.input_format == config.output_format &&
+                    config.input_width.Value() == output_width &&
+                    config.input_height.Value() == output_height) {
+                    const u32 bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+                    const bool tiled_to_linear = !config.input_linear;
+                    u8* tiled_data = tiled_to_linear ? src_pointer : dst_pointer;
+                    u8* linear_data = tiled_to_linear ? dst_pointer : src_pointer;
+                    whole_tiles_copied = VideoCore::MortonCopyTiles(
+                        output_width, output_height, bytes_per_pixel, tiled_data, linear_data,
+                        static_cast<std::ptrdiff_t>(output_width * bytes_per_pixel),
+                        tiled_to_linear);
+                }
+
+                // With no scaling and matching dimensions the transfer is row-parallel:
+                // (un)swizzle whole tiles where a layout change is involved, then run the
+                // format conversion (and any vertical flip) over linear rows with the
+                // vectorized kernels instead of dispatching per pixel.
+                bool rows_converted = false;
+                if (!whole_tiles_copied && config.scaling == config.NoScale &&
+                    config.input_width.Value() == output_width &&
+                    config.input_height.Value() == output_height) {
+                    const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+                    const u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+                    const bool input_tiled = !config.input_linear;
+                    const bool output_tiled = config.input_linear ? !config.dont_swizzle
+                                                                  : config.dont_swizzle != 0;
+
+                    std::vector<u8> src_linear;
+                    std::vector<u8> dst_linear;
+                    const u8* src_rows = src_pointer;
+                    if (input_tiled) {
+                        src_linear.resize(input_size);
+                        src_rows = VideoCore::MortonCopyTiles(
+                                       output_width, output_height, src_bytes_per_pixel,
+                                       src_pointer, src_linear.data(),
+                                       output_width * src_bytes_per_pixel, true)
+                                       ? src_linear.data()
+                                       : nullptr;
+                    }
+
+                    if (src_rows != nullptr) {
+                        u8* dst_rows = dst_pointer;
+                        if (output_tiled) {
+                            dst_linear.resize(output_size);
+                            dst_rows = dst_linear.data();
+                        }
+
+                        for (u32 y = 0; y < output_height; ++y) {
+                            u32 out_y = config.flip_vertically ? output_height - 1 - y : y;
+                            VideoCore::ConvertColorRow(config.input_format,
+                                src_rows + y * output_width * src_bytes_per_pixel,
+                                config.output_format,
+                                dst_rows + out_y * output_width * dst_bytes_per_pixel,
+                                output_width);
+                        }
+
+                        rows_converted = !output_tiled ||
+                            VideoCore::MortonCopyTiles(output_width, output_height,
+                                dst_bytes_per_pixel, dst_pointer, dst_linear.data(),
+                                output_width * dst_bytes_per_pixel, false);
+                    }
+                }
+
+                // The scaled (anti-aliasing) modes follow the same untile -> row kernels
+                // structure, with the averaging rows split across the transfer worker pool.
+                // Scaling implies tiled input (the linear case bailed out above).
+                bool scaled_rows_converted = false;
+                if (!whole_tiles_copied && !rows_converted && config.scaling != config.NoScale &&
+                    config.input_width.Value() >= output_width * 2 &&
+                    config.input_height.Value() >= (output_height << vertical_scale)) {
+                    const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+                    const u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+
+                    std::vector<u8> src_linear(input_size);
+                    std::vector<u8> dst_linear;
+                    if (VideoCore::MortonCopyTiles(config.input_width, config.input_height,
+                                                   src_bytes_per_pixel, src_pointer,
+                                                   src_linear.data(),
+                                                   config.input_width * src_bytes_per_pixel,
+                                                   true)) {
+                        // With tiled input the output stays tiled only when swizzling is skipped
+                        const bool output_tiled = (config.dont_swizzle != 0);
+                        u8* dst_rows = dst_pointer;
+                        if (output_tiled) {
+                            dst_linear.resize(output_size);
+                            dst_rows = dst_linear.data();
+                        }
+
+                        transfer_job = { src_linear.data(), dst_rows, config.input_width,
+                                         output_width, output_height,
+                                         config.input_format, config.output_format,
+                                         config.scaling == config.ScaleXY,
+                                         config.flip_vertically != 0 };
+                        RunScaledTransfer();
+
+                        scaled_rows_converted = !output_tiled ||
+                            VideoCore::MortonCopyTiles(output_width, output_height,
+                                dst_bytes_per_pixel, dst_pointer, dst_linear.data(),
+                                output_width * dst_bytes_per_pixel, false);
+                    }
+                }
+
+                for (u32 y = 0; !whole_tiles_copied && !rows_converted &&
+                                !scaled_rows_converted && y < output_height; ++y) {
                     for (u32 x = 0; x < output_width; ++x) {
                         Math::Vec4<u8> src_color;
 
@@ -368,7 +632,30 @@ inline void Write(u32 addr, const T data) {
         {
             MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
 
-            u32* buffer = (u32*)Memory::GetPhysicalPointer(config.GetPhysicalAddress());
+            const PAddr list_addr = config.GetPhysicalAddress();
+
+            // Resolve the whole list against host memory once. Within a physical region the
+            // guest-to-host mapping is linear, so a single bounds check covers every word the
+            // interpreter will read; a list crossing a region boundary is staged into a reused
+            // buffer so interpretation always runs over contiguous host memory.
+            const Memory::PhysicalRegion region = Memory::GetPhysicalRegion(list_addr);
+            u32* buffer = reinterpret_cast<u32*>(region.GetPointer(list_addr));
+            if (buffer == nullptr || config.size > region.size - (list_addr - region.base)) {
+                static std::vector<u32> staged_list;
+                staged_list.resize((config.size + sizeof(u32) - 1) / sizeof(u32));
+                u8* dest = reinterpret_cast<u8*>(staged_list.data());
+                for (u32 offset = 0; offset < config.size;) {
+                    const u32 chunk = std::min(config.size - offset,
+                        static_cast<u32>(Memory::PAGE_SIZE - ((list_addr + offset) & Memory::PAGE_MASK)));
+                    const u8* src = Memory::GetPhysicalPointer(list_addr + offset);
+                    if (src != nullptr)
+                        std::memcpy(dest + offset, src, chunk);
+                    else
+                        std::memset(dest + offset, 0, chunk);
+                    offset += chunk;
+                }
+                buffer = staged_list.data();
+            }
 
             if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
                 Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, config.size * sizeof(u32), config.GetPhysicalAddress());
@@ -384,6 +671,22 @@ inline void Write(u32 addr, const T data) {
     default:
         break;
     }
+}
+
+template <typename T>
+inline void Write(u32 addr, const T data) {
+    addr -= HW::VADDR_GPU;
+    u32 index = addr / 4;
+
+    // Writes other than u32 are untested, so I'd rather have them abort than silently fail
+    if (index >= Regs::NumIds() || !std::is_same<T, u32>::value) {
+        LOG_ERROR(HW_GPU, "unknown Write%lu 0x%08X @ 0x%08X", sizeof(data) * 8, (u32)data, addr);
+        return;
+    }
+
+    g_regs[index] = static_cast<u32>(data);
+
+    RunWriteSideEffects(index);
 
     // Notify tracer about the register write
     // This is happening *after* handling the write to make sure we properly catch all memory reads.
@@ -393,6 +696,43 @@ inline void Write(u32 addr, const T data) {
     }
 }
 
+void WriteBlock(u32 addr, const void* data, u32 count) {
+    addr -= HW::VADDR_GPU;
+    const u32 index = addr / 4;
+
+    if ((addr & 3) != 0 || index >= Regs::NumIds() || count > Regs::NumIds() - index) {
+        LOG_ERROR(HW_GPU, "out of range WriteBlock of %u registers @ 0x%08X", count, addr);
+        return;
+    }
+
+    // The whole span lands in g_regs before any trigger handler runs, so a call that both
+    // configures and triggers an operation sees its complete configuration -- the same state
+    // the per-word path would have built up by the time it reached the trigger register.
+    std::memcpy(&g_regs[index], data, count * sizeof(u32));
+
+    for (u32 i = 0; i < count; ++i)
+        RunWriteSideEffects(index + i);
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        for (u32 i = 0; i < count; ++i) {
+            Pica::g_debug_context->recorder->RegisterWritten<u32>(
+                (addr + i * 4) + 0x1EF00000 - 0x1EC00000 + 0x10100000, g_regs[index + i]);
+        }
+    }
+}
+
+void ReadBlock(u32 addr, void* data, u32 count) {
+    addr -= HW::VADDR_GPU;
+    const u32 index = addr / 4;
+
+    if ((addr & 3) != 0 || index >= Regs::NumIds() || count > Regs::NumIds() - index) {
+        LOG_ERROR(HW_GPU, "out of range ReadBlock of %u registers @ 0x%08X", count, addr);
+        return;
+    }
+
+    std::memcpy(data, &g_regs[index], count * sizeof(u32));
+}
+
 // Explicitly instantiate template functions because we aren't defining this in the header:
 
 template void Read<u64>(u64 &var, const u32 addr);
@@ -408,31 +748,57 @@ template void Write<u8>(u32 addr, const u8 data);
 /// Update hardware
 static void VBlankCallback(u64 userdata, int cycles_late) {
     frame_count++;
-    last_skip_frame = g_skip_frame;
-    g_skip_frame = (frame_count & Settings::values.frame_skip) != 0;
-
-    // Swap buffers based on the frameskip mode, which is a little bit tricky. When
-    // a frame is being skipped, nothing is being rendered to the internal framebuffer(s).
-    // So, we should only swap frames if the last frame was rendered. The rules are:
-    //  - If frameskip == 0 (disabled), always swap buffers
-    //  - If frameskip == 1, swap buffers every other frame (starting from the first frame)
-    //  - If frameskip > 1, swap buffers every frameskip^n frames (starting from the second frame)
-    if ((((Settings::values.frame_skip != 1) ^ last_skip_frame) && last_skip_frame != g_skip_frame) ||
-            Settings::values.frame_skip == 0) {
+
+    // The frame boundary is where settings changes take effect
+    Settings::UpdateSnapshot(settings_snapshot, settings_snapshot_version);
+
+    // Present the frame that just finished. Skipped frames rendered nothing, so swapping
+    // after one would only present stale data.
+    if (!g_skip_frame) {
         VideoCore::g_renderer->SwapBuffers();
     }
 
-    // Signal to GSP that GPU interrupt has occurred
+    // Pace the emulated VBlank against the wall clock, independently of driver vsync
+    FrameLimiter::DoFrameLimiting();
+
+    // Decide whether the upcoming frame is skipped. frame_skip is the N-of-M pattern mask;
+    // with auto frame-skip enabled the pattern only engages while emulation is running
+    // behind its wall-clock schedule, so fast scenes still render every frame.
+    bool skip_next_frame = (frame_count & settings_snapshot.frame_skip) != 0;
+    if (settings_snapshot.auto_frame_skip) {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = now - previous_vblank_time;
+        previous_vblank_time = now;
+
+        // 25% over budget counts as falling behind; stay engaged for a few frames so the
+        // decision doesn't oscillate on the cheaper skipped frames
+        if (elapsed > frame_budget + frame_budget / 4) {
+            frames_behind_schedule = 4;
+        } else if (frames_behind_schedule > 0) {
+            frames_behind_schedule--;
+        }
+
+        skip_next_frame &= frames_behind_schedule > 0;
+    }
+    g_skip_frame = skip_next_frame;
+
+    // Signal to GSP that GPU interrupt has occurred. The two PDC interrupts are delivered with
+    // a single coalesced event wakeup, rather than one kernel round trip per screen.
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
     // screen, or if both use the same interrupts and these two instead determine the
     // beginning and end of the VBlank period. If needed, split the interrupt firing into
     // two different intervals.
+    GSP_GPU::BeginInterruptBatch();
     GSP_GPU::SignalInterrupt(GSP_GPU::InterruptId::PDC0);
     GSP_GPU::SignalInterrupt(GSP_GPU::InterruptId::PDC1);
+    GSP_GPU::EndInterruptBatch();
 
     // Check for user input updates
     Service::HID::Update();
 
+    // Let the rewind recorder take its periodic snapshot
+    Rewind::NotifyFrame();
+
     // Reschedule recurrent event
     CoreTiming::ScheduleEvent(frame_ticks - cycles_late, vblank_event);
 }
@@ -467,18 +833,42 @@ void Init() {
     framebuffer_sub.color_format.Assign(Regs::PixelFormat::RGB8);
     framebuffer_sub.active_fb = 0;
 
-    last_skip_frame = false;
     g_skip_frame = false;
     frame_count = 0;
+    frames_behind_schedule = 0;
+    previous_vblank_time = std::chrono::steady_clock::now();
+    FrameLimiter::Reset();
 
     vblank_event = CoreTiming::RegisterEvent("GPU::VBlankCallback", VBlankCallback);
     CoreTiming::ScheduleEvent(frame_ticks, vblank_event);
 
+    // Memory-bound row conversion stops scaling past a few threads, so cap the pool
+    unsigned threads = std::min(4u, std::max(1u, std::thread::hardware_concurrency()));
+    if (threads > 1) {
+        num_transfer_threads = threads;
+        transfer_start_barrier = std::make_unique<Common::Barrier>(num_transfer_threads);
+        transfer_done_barrier = std::make_unique<Common::Barrier>(num_transfer_threads);
+        for (unsigned i = 1; i < num_transfer_threads; ++i)
+            transfer_worker_threads.emplace_back(TransferWorkerThread, i);
+    }
+
     LOG_DEBUG(HW_GPU, "initialized OK");
 }
 
 /// Shutdown hardware
 void Shutdown() {
+    if (!transfer_worker_threads.empty()) {
+        transfer_workers_should_exit = true;
+        transfer_start_barrier->Sync();
+        for (auto& thread : transfer_worker_threads)
+            thread.join();
+        transfer_worker_threads.clear();
+        transfer_workers_should_exit = false;
+    }
+    transfer_start_barrier = nullptr;
+    transfer_done_barrier = nullptr;
+    num_transfer_threads = 1;
+
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
@@ -320,6 +320,16 @@ void Read(T &var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Writes `count` sequential registers from `data` in one go: the span is validated once,
+ * copied into g_regs with a single memcpy, and trigger side effects run once per affected
+ * register afterwards. Out-of-range or misaligned spans are rejected whole.
+ */
+void WriteBlock(u32 addr, const void* data, u32 count);
+
+/// Reads `count` sequential registers into `data`. Register reads have no side effects.
+void ReadBlock(u32 addr, void* data, u32 count);
+
 /// Initialize hardware
 void Init();
 
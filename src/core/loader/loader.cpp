@@ -2,9 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 
@@ -24,20 +28,123 @@ const std::initializer_list<Kernel::AddressMapping> default_address_mappings = {
 };
 
 FileType IdentifyFile(FileUtil::IOFile& file) {
+    // A single read of the first 0x104 bytes covers every magic we probe for:
+    // 3DSX and ELF at offset 0, NCSD/NCCH at offset 0x100.
+    u8 header[0x104];
+    file.Seek(0, SEEK_SET);
+    size_t header_size = file.ReadBytes(header, sizeof(header));
+
+    u32 magic;
+    if (header_size >= sizeof(magic)) {
+        memcpy(&magic, header, sizeof(magic));
+
+        if (MakeMagic('3', 'D', 'S', 'X') == magic)
+            return FileType::THREEDSX;
+        if (MakeMagic('\x7f', 'E', 'L', 'F') == magic)
+            return FileType::ELF;
+    }
+
+    if (header_size >= sizeof(header)) {
+        memcpy(&magic, header + 0x100, sizeof(magic));
+
+        if (MakeMagic('N', 'C', 'S', 'D') == magic)
+            return FileType::CCI;
+        if (MakeMagic('N', 'C', 'C', 'H') == magic)
+            return FileType::CXI;
+    }
+
+    return FileType::Unknown;
+}
+
+/// An IdentifyFile result cached on disk, validated against the file's size and mtime
+struct CachedFileType {
+    u64 mtime;
+    u64 size;
     FileType type;
+};
 
-#define CHECK_TYPE(loader) \
-    type = AppLoader_##loader::IdentifyType(file); \
-    if (FileType::Error != type) \
-        return type;
+static std::unordered_map<std::string, CachedFileType> type_cache;
+static std::mutex type_cache_mutex;
+static bool type_cache_loaded = false;
 
-    CHECK_TYPE(THREEDSX)
-    CHECK_TYPE(ELF)
-    CHECK_TYPE(NCCH)
+static std::string GetTypeCachePath() {
+    return FileUtil::GetUserPath(D_CACHE_IDX) + "loader_types.cache";
+}
 
-#undef CHECK_TYPE
+/// Loads the on-disk identification cache. Expects type_cache_mutex to be held.
+static void LoadTypeCache() {
+    if (type_cache_loaded)
+        return;
+    type_cache_loaded = true;
+
+    std::string contents;
+    if (FileUtil::ReadFileToString(true, GetTypeCachePath().c_str(), contents) == 0)
+        return;
+
+    // One entry per line: "<type> <size> <mtime> <path>". The file is append-only, so a
+    // later line for the same path supersedes earlier ones.
+    size_t pos = 0;
+    while (pos < contents.size()) {
+        size_t eol = contents.find('\n', pos);
+        if (eol == std::string::npos)
+            eol = contents.size();
+        std::string line = contents.substr(pos, eol - pos);
+        pos = eol + 1;
+
+        unsigned int type;
+        unsigned long long size, mtime;
+        int path_offset = 0;
+        if (sscanf(line.c_str(), "%u %llu %llu %n", &type, &size, &mtime, &path_offset) != 3 ||
+            path_offset == 0 || type > static_cast<unsigned int>(FileType::THREEDSX))
+            continue;
+
+        type_cache[line.substr(path_offset)] = { mtime, size, static_cast<FileType>(type) };
+    }
+}
 
-    return FileType::Unknown;
+/// Appends one entry to the on-disk identification cache. Expects type_cache_mutex to be held.
+static void AppendTypeCacheEntry(const std::string& path, const CachedFileType& entry) {
+    FileUtil::CreateFullPath(FileUtil::GetUserPath(D_CACHE_IDX));
+    FileUtil::IOFile file(GetTypeCachePath(), "ab");
+    if (!file.IsOpen())
+        return;
+
+    std::string line = Common::StringFromFormat("%u %llu %llu %s\n",
+        static_cast<unsigned int>(entry.type), static_cast<unsigned long long>(entry.size),
+        static_cast<unsigned long long>(entry.mtime), path.c_str());
+    file.WriteBytes(line.data(), line.size());
+}
+
+/**
+ * Identifies the type of the file, consulting the persistent identification cache before
+ * sniffing the header. Unidentifiable files are cached too so they are not re-sniffed.
+ * @param path Path of the file (cache key)
+ * @param file Open file to sniff on a cache miss
+ * @return FileType of the file
+ */
+static FileType IdentifyFileCached(const std::string& path, FileUtil::IOFile& file) {
+    u64 mtime = FileUtil::GetModificationTime(path);
+    u64 size = file.GetSize();
+
+    if (mtime != 0) {
+        std::lock_guard<std::mutex> lock(type_cache_mutex);
+        LoadTypeCache();
+
+        auto iter = type_cache.find(path);
+        if (iter != type_cache.end() && iter->second.mtime == mtime && iter->second.size == size)
+            return iter->second.type;
+    }
+
+    FileType type = IdentifyFile(file);
+
+    if (mtime != 0) {
+        std::lock_guard<std::mutex> lock(type_cache_mutex);
+        CachedFileType entry = { mtime, size, type };
+        type_cache[path] = entry;
+        AppendTypeCacheEntry(path, entry);
+    }
+
+    return type;
 }
 
 FileType IdentifyFile(const std::string& file_name) {
@@ -47,7 +154,7 @@ FileType IdentifyFile(const std::string& file_name) {
         return FileType::Unknown;
     }
 
-    return IdentifyFile(file);
+    return IdentifyFileCached(file_name, file);
 }
 
 FileType GuessFromExtension(const std::string& extension_) {
@@ -131,7 +238,7 @@ std::unique_ptr<AppLoader> GetLoader(const std::string& filename) {
     std::string filename_filename, filename_extension;
     Common::SplitPath(filename, nullptr, &filename_filename, &filename_extension);
 
-    FileType type = IdentifyFile(file);
+    FileType type = IdentifyFileCached(filename, file);
     FileType filename_type = GuessFromExtension(filename_extension);
 
     if (type != filename_type) {
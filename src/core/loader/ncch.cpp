@@ -16,6 +16,7 @@
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/ncch.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Loader namespace
@@ -51,18 +52,18 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
     u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
     u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
 
-    memset(decompressed, 0, decompressed_size);
+    // Everything below stop_index is stored uncompressed; only the tail past the
+    // compressed image needs to be cleared in case the stream terminates early.
     memcpy(decompressed, compressed, compressed_size);
+    memset(decompressed + compressed_size, 0, decompressed_size - compressed_size);
 
     while (index > stop_index) {
-       u8 control = compressed[--index];
+        u8 control = compressed[--index];
 
         for (unsigned i = 0; i < 8; i++) {
             if (index <= stop_index)
                 break;
-            if (index <= 0)
-                break;
-            if (out <= 0)
+            if (out == 0)
                 break;
 
             if (control & 0x80) {
@@ -76,23 +77,42 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
                 segment_offset &= 0x0FFF;
                 segment_offset += 2;
 
-                // Check if compression is out of bounds
+                // Check if compression is out of bounds. The match is copied top-down,
+                // so the first (and highest) source byte bounds all following ones.
                 if (out < segment_size)
                     return false;
+                if (out + segment_offset >= decompressed_size)
+                    return false;
 
-                for (unsigned j = 0; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed_size)
-                        return false;
-
-                    u8 data = decompressed[out + segment_offset];
-                    decompressed[--out] = data;
+                // Copy the match with a single block copy per pattern period. The source
+                // runs a constant distance ahead of the destination; when the match is
+                // longer than that distance it reads bytes this match already produced,
+                // so replicate the pattern in distance-sized chunks from the top down.
+                const u32 distance = segment_offset + 1;
+                u8* dest_end = decompressed + out;
+                u32 remaining = segment_size;
+                while (remaining > 0) {
+                    u32 chunk = std::min(distance, remaining);
+                    memcpy(dest_end - chunk, dest_end - chunk + distance, chunk);
+                    dest_end -= chunk;
+                    remaining -= chunk;
                 }
+                out -= segment_size;
             } else {
-                // Check if compression is out of bounds
-                if (out < 1)
-                    return false;
-                decompressed[--out] = compressed[--index];
+                // Batch consecutive literal bits into one block copy; both cursors
+                // walk downwards in lockstep, so the run is a contiguous reversal-free
+                // copy out of the compressed stream.
+                u32 run = 1;
+                while (i + run < 8 && (control & (0x80 >> run)) == 0)
+                    run++;
+                run = std::min(run, std::min(index - stop_index, out));
+
+                index -= run;
+                out -= run;
+                memcpy(decompressed + out, compressed + index, run);
+
+                i += run - 1;
+                control <<= run - 1;
             }
             control <<= 1;
         }
@@ -193,9 +213,28 @@ ResultStatus AppLoader_NCCH::LoadSectionExeFS(const char* name, std::vector<u8>&
                       section.offset, section.size, section.name);
 
             s64 section_offset = (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset);
+            bool compressed = (strcmp(section.name, ".code") == 0 && is_compressed);
+
+            if (mapped_file.IsOpen() &&
+                static_cast<u64>(section_offset) + section.size <= mapped_file.GetSize()) {
+                // Serve the section straight out of the mapped container; its pages are only
+                // faulted in as they are consumed, and nothing is staged in between.
+                const u8* section_data = mapped_file.GetData() + section_offset;
+
+                if (compressed) {
+                    u32 decompressed_size = LZSS_GetDecompressedSize(section_data, section.size);
+                    buffer.resize(decompressed_size);
+                    if (!LZSS_Decompress(section_data, section.size, &buffer[0], decompressed_size))
+                        return ResultStatus::ErrorInvalidFormat;
+                } else {
+                    buffer.assign(section_data, section_data + section.size);
+                }
+                return ResultStatus::Success;
+            }
+
             file.Seek(section_offset, SEEK_SET);
 
-            if (strcmp(section.name, ".code") == 0 && is_compressed) {
+            if (compressed) {
                 // Section is compressed, read compressed .code section...
                 std::unique_ptr<u8[]> temp_buffer;
                 try {
@@ -279,6 +318,10 @@ ResultStatus AppLoader_NCCH::LoadExeFS() {
         return ResultStatus::ErrorEncrypted;
     }
 
+    // With the program ID confirmed, let the frontend overlay this title's settings
+    // profile before any of its code runs
+    Settings::NotifyTitleLoaded(ncch_header.program_id);
+
     // Read ExeFS...
 
     exefs_offset = ncch_header.exefs_offset * kBlockSize;
@@ -291,6 +334,11 @@ ResultStatus AppLoader_NCCH::LoadExeFS() {
     if (file.ReadBytes(&exefs_header, sizeof(ExeFs_Header)) != sizeof(ExeFs_Header))
         return ResultStatus::Error;
 
+    // Map the container so sections can be read without intermediate buffers. Failure is not
+    // fatal; LoadSectionExeFS falls back to regular file reads.
+    if (!mapped_file.IsOpen() && !mapped_file.Open(filepath))
+        LOG_DEBUG(Loader, "Failed to memory-map %s, using file reads", filepath.c_str());
+
     is_exefs_loaded = true;
     return ResultStatus::Success;
 }
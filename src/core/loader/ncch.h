@@ -8,6 +8,7 @@
 
 #include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/mapped_file.h"
 #include "common/swap.h"
 
 #include "core/loader/loader.h"
@@ -263,6 +264,10 @@ private:
     ExeFs_Header    exefs_header;
     ExHeader_Header exheader_header;
 
+    /// Read-only mapping of the container; sections are served straight out of it when the
+    /// mapping succeeds, falling back to IOFile reads when it does not.
+    FileUtil::MappedFile mapped_file;
+
     std::string     filepath;
 };
 
@@ -24,29 +24,30 @@ bool IsValidSMDH(const std::vector<u8>& smdh_data) {
     return Loader::MakeMagic('S', 'M', 'D', 'H') == magic;
 }
 
-std::vector<u16> SMDH::GetIcon(bool large) const {
-    u32 size;
-    const u8* icon_data;
-
-    if (large) {
-        size = 48;
-        icon_data = large_icon.data();
-    } else {
-        size = 24;
-        icon_data = small_icon.data();
-    }
-
+std::vector<u16> DecodeSMDHIcon(const u8* icon_data, u32 size) {
     std::vector<u16> icon(size * size);
-    for (u32 x = 0; x < size; ++x) {
-        for (u32 y = 0; y < size; ++y) {
-            u32 coarse_y = y & ~7;
-            const u8* pixel = icon_data + VideoCore::GetMortonOffset(x, y, 2) + coarse_y * size * 2;
-            icon[x + size * y] = (pixel[1] << 8) + pixel[0];
+
+    // Icon dimensions are tile-aligned (24 and 48), so the whole image de-swizzles as
+    // straight two-pixel copies; the per-pixel walk only backs up unexpected sizes
+    if (!VideoCore::MortonCopyTiles(size, size, 2, const_cast<u8*>(icon_data),
+                                    reinterpret_cast<u8*>(icon.data()), size * 2, true)) {
+        for (u32 x = 0; x < size; ++x) {
+            for (u32 y = 0; y < size; ++y) {
+                u32 coarse_y = y & ~7;
+                const u8* pixel = icon_data + VideoCore::GetMortonOffset(x, y, 2) + coarse_y * size * 2;
+                icon[x + size * y] = (pixel[1] << 8) + pixel[0];
+            }
         }
     }
     return icon;
 }
 
+std::vector<u16> SMDH::GetIcon(bool large) const {
+    if (large)
+        return DecodeSMDHIcon(large_icon.data(), 48);
+    return DecodeSMDHIcon(small_icon.data(), 24);
+}
+
 std::array<u16, 0x40> SMDH::GetShortTitle(Loader::SMDH::TitleLanguage language) const {
     return titles[static_cast<int>(language)].short_title;
 }
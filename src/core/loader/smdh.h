@@ -20,6 +20,14 @@ namespace Loader {
  */
 bool IsValidSMDH(const std::vector<u8>& smdh_data);
 
+/**
+ * Decodes a tiled RGB565 icon, as stored in the SMDH, into row-linear pixels.
+ * @param icon_data tiled icon data (size * size RGB565 pixels)
+ * @param size width/height of the square icon in pixels
+ * @return vector of row-linear RGB565 data
+ */
+std::vector<u16> DecodeSMDHIcon(const u8* icon_data, u32 size);
+
 /// SMDH data structure that contains titles, icons etc. See https://www.3dbrew.org/wiki/SMDH
 struct SMDH {
     u32_le magic;
@@ -10,6 +10,8 @@
 #include "common/logging/log.h"
 #include "common/swap.h"
 
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
 #include "core/hle/kernel/process.h"
 #include "core/memory.h"
 #include "core/memory_setup.h"
@@ -70,6 +72,20 @@ struct PageTable {
      * flushed before the memory is accessed
      */
     std::array<u8, NUM_ENTRIES> cached_res_count;
+
+    /**
+     * Raw MMIO handler pointer for each page of type `Special`, so IO dispatch is an
+     * indexed fetch instead of a scan of `special_regions` (which keeps ownership of
+     * the handlers). Null for pages of every other type.
+     */
+    std::array<MMIORegion*, NUM_ENTRIES> mmio_handlers;
+
+    /**
+     * Set for pages covered by at least one translated CPU block. Writes to such pages
+     * discard the translations covering them (see InvalidateCodePages); pages with a
+     * clear flag take the write paths unchanged.
+     */
+    std::array<u8, NUM_ENTRIES> contains_code;
 };
 
 /// Singular page table used for the singleton process
@@ -77,6 +93,10 @@ static PageTable main_page_table;
 /// Currently active page table
 static PageTable* current_page_table = &main_page_table;
 
+u8** current_page_pointers = main_page_table.pointers.data();
+
+const u8* current_page_contains_code = main_page_table.contains_code.data();
+
 static void MapPages(u32 base, u32 size, u8* memory, PageType type) {
     LOG_DEBUG(HW_Memory, "Mapping %p onto %08X-%08X", memory, base * PAGE_SIZE, (base + size) * PAGE_SIZE);
 
@@ -94,6 +114,7 @@ static void MapPages(u32 base, u32 size, u8* memory, PageType type) {
         current_page_table->attributes[base] = type;
         current_page_table->pointers[base] = memory;
         current_page_table->cached_res_count[base] = 0;
+        current_page_table->contains_code[base] = 0;
 
         base += 1;
         if (memory != nullptr)
@@ -105,6 +126,34 @@ void InitMemoryMap() {
     main_page_table.pointers.fill(nullptr);
     main_page_table.attributes.fill(PageType::Unmapped);
     main_page_table.cached_res_count.fill(0);
+    main_page_table.mmio_handlers.fill(nullptr);
+    main_page_table.contains_code.fill(0);
+}
+
+void MarkRegionAsCode(const VAddr start, const u32 size) {
+    const u32 last_page = (start + size - 1) >> PAGE_BITS;
+    for (u32 page = start >> PAGE_BITS; page <= last_page; ++page)
+        current_page_table->contains_code[page] = 1;
+}
+
+/**
+ * Discards the translations covering any code-flagged page in [vaddr, vaddr + size).
+ * Invalidation is page-granular: every translation intersecting a written page is
+ * dropped on both cores, so the page's flag can be cleared exactly. Pages a dropped
+ * block merely spilled into keep their flag until they are written themselves.
+ */
+static void InvalidateCodePages(const VAddr vaddr, const u32 size) {
+    const u32 last_page = (vaddr + size - 1) >> PAGE_BITS;
+    for (u32 page = vaddr >> PAGE_BITS; page <= last_page; ++page) {
+        if (!current_page_table->contains_code[page])
+            continue;
+
+        current_page_table->contains_code[page] = 0;
+        if (Core::g_app_core != nullptr)
+            Core::g_app_core->InvalidateCodeRange(page << PAGE_BITS, PAGE_SIZE);
+        if (Core::g_sys_core != nullptr)
+            Core::g_sys_core->InvalidateCodeRange(page << PAGE_BITS, PAGE_SIZE);
+    }
 }
 
 void MapMemoryRegion(VAddr base, u32 size, u8* target) {
@@ -118,6 +167,9 @@ void MapIoRegion(VAddr base, u32 size, MMIORegionPointer mmio_handler) {
     ASSERT_MSG((base & PAGE_MASK) == 0, "non-page aligned base: %08X", base);
     MapPages(base / PAGE_SIZE, size / PAGE_SIZE, nullptr, PageType::Special);
 
+    for (u32 page = base / PAGE_SIZE; page < (base + size) / PAGE_SIZE; ++page)
+        current_page_table->mmio_handlers[page] = mmio_handler.get();
+
     current_page_table->special_regions.emplace_back(SpecialRegion{base, size, mmio_handler});
 }
 
@@ -125,6 +177,9 @@ void UnmapRegion(VAddr base, u32 size) {
     ASSERT_MSG((size & PAGE_MASK) == 0, "non-page aligned size: %08X", size);
     ASSERT_MSG((base & PAGE_MASK) == 0, "non-page aligned base: %08X", base);
     MapPages(base / PAGE_SIZE, size / PAGE_SIZE, nullptr, PageType::Unmapped);
+
+    for (u32 page = base / PAGE_SIZE; page < (base + size) / PAGE_SIZE; ++page)
+        current_page_table->mmio_handlers[page] = nullptr;
 }
 
 /**
@@ -152,18 +207,17 @@ static u8* GetPointerFromVMA(VAddr vaddr) {
 /**
  * This function should only be called for virtual addreses with attribute `PageType::Special`.
  */
-static MMIORegionPointer GetMMIOHandler(VAddr vaddr) {
-    for (const auto& region : current_page_table->special_regions) {
-        if (vaddr >= region.base && vaddr < (region.base + region.size)) {
-            return region.handler;
-        }
+static MMIORegion* GetMMIOHandler(VAddr vaddr) {
+    MMIORegion* handler = current_page_table->mmio_handlers[vaddr >> PAGE_BITS];
+    if (handler != nullptr) {
+        return handler;
     }
     ASSERT_MSG(false, "Mapped IO page without a handler @ %08X", vaddr);
     return nullptr; // Should never happen
 }
 
 template<typename T>
-T ReadMMIO(MMIORegionPointer mmio_handler, VAddr addr);
+T ReadMMIO(MMIORegion* mmio_handler, VAddr addr);
 
 template <typename T>
 T Read(const VAddr vaddr) {
@@ -205,10 +259,14 @@ T Read(const VAddr vaddr) {
 }
 
 template<typename T>
-void WriteMMIO(MMIORegionPointer mmio_handler, VAddr addr, const T data);
+void WriteMMIO(MMIORegion* mmio_handler, VAddr addr, const T data);
 
 template <typename T>
 void Write(const VAddr vaddr, const T data) {
+    // Self-modifying code check: a single predictable branch for data pages
+    if (current_page_table->contains_code[vaddr >> PAGE_BITS])
+        InvalidateCodePages(vaddr, sizeof(T));
+
     u8* page_pointer = current_page_table->pointers[vaddr >> PAGE_BITS];
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
@@ -254,7 +312,7 @@ bool IsValidVirtualAddress(const VAddr vaddr) {
     if (current_page_table->attributes[vaddr >> PAGE_BITS] != PageType::Special)
         return false;
 
-    MMIORegionPointer mmio_region = GetMMIOHandler(vaddr);
+    MMIORegion* mmio_region = GetMMIOHandler(vaddr);
     if (mmio_region) {
         return mmio_region->IsValidAddress(vaddr);
     }
@@ -280,11 +338,70 @@ u8* GetPointer(const VAddr vaddr) {
     return nullptr;
 }
 
+const u8* GetSpan(const VAddr vaddr, const size_t size) {
+    if (size == 0)
+        return nullptr;
+
+    const size_t first_page = vaddr >> PAGE_BITS;
+    const size_t last_page = (vaddr + size - 1) >> PAGE_BITS;
+    if (last_page >= PageTable::NUM_ENTRIES)
+        return nullptr;
+
+    const u8* base = current_page_table->pointers[first_page];
+    if (base == nullptr)
+        return nullptr;
+
+    // Every page of the range must be plain memory and mapped contiguously on the host.
+    for (size_t page = first_page + 1; page <= last_page; ++page) {
+        if (current_page_table->pointers[page] != base + (page - first_page) * PAGE_SIZE)
+            return nullptr;
+    }
+
+    return base + (vaddr & PAGE_MASK);
+}
+
+u8* GetWriteSpan(const VAddr vaddr, const size_t size) {
+    u8* span = const_cast<u8*>(GetSpan(vaddr, size));
+
+    // The caller will store through the span without going through the checked write
+    // paths, so any translations covering it must be dropped up front -- file reads into
+    // an executed page (overlay streaming) are exactly the self-modifying-code case.
+    // The underlying backing memory is writable; GetSpan only returns plain Memory pages,
+    // so casting away the const applied for the read-only view is fine.
+    if (span != nullptr)
+        InvalidateCodePages(vaddr, static_cast<u32>(size));
+
+    return span;
+}
+
 u8* GetPhysicalPointer(PAddr address) {
     // TODO(Subv): This call should not go through the application's memory mapping.
     return GetPointer(PhysicalToVirtualAddress(address));
 }
 
+PhysicalRegion GetPhysicalRegion(const PAddr address) {
+    PhysicalRegion region;
+    if (address >= FCRAM_PADDR && address < FCRAM_PADDR_END) {
+        region.base = FCRAM_PADDR;
+        region.size = FCRAM_SIZE;
+    } else if (address >= VRAM_PADDR && address < VRAM_PADDR_END) {
+        region.base = VRAM_PADDR;
+        region.size = VRAM_SIZE;
+    } else if (address >= DSP_RAM_PADDR && address < DSP_RAM_PADDR_END) {
+        region.base = DSP_RAM_PADDR;
+        region.size = DSP_RAM_SIZE;
+    } else {
+        return region;
+    }
+
+    // Physical-to-virtual translation is linear within a region (see
+    // RasterizerMarkRegionCached), so the queried address anchors the whole mapping
+    u8* host = GetPhysicalPointer(address);
+    if (host != nullptr)
+        region.host_base = host - (address - region.base);
+    return region;
+}
+
 void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
     if (start == 0) {
         return;
@@ -293,46 +410,68 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
     u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
     PAddr paddr = start;
 
-    for (unsigned i = 0; i < num_pages; ++i) {
+    while (num_pages > 0) {
+        // Physical-to-virtual translation is linear within a physical region, so it only
+        // needs to be performed once per region the range touches rather than per page.
         VAddr vaddr = PhysicalToVirtualAddress(paddr);
-        u8& res_count = current_page_table->cached_res_count[vaddr >> PAGE_BITS];
-        ASSERT_MSG(count_delta <= UINT8_MAX - res_count, "Rasterizer resource cache counter overflow!");
-        ASSERT_MSG(count_delta >= -res_count, "Rasterizer resource cache counter underflow!");
-
-        // Switch page type to cached if now cached
-        if (res_count == 0) {
-            PageType& page_type = current_page_table->attributes[vaddr >> PAGE_BITS];
-            switch (page_type) {
-            case PageType::Memory:
-                page_type = PageType::RasterizerCachedMemory;
-                current_page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
-                break;
-            case PageType::Special:
-                page_type = PageType::RasterizerCachedSpecial;
-                break;
-            default:
-                UNREACHABLE();
+
+        PAddr region_end;
+        if (paddr >= VRAM_PADDR && paddr < VRAM_PADDR_END)
+            region_end = VRAM_PADDR_END;
+        else if (paddr >= FCRAM_PADDR && paddr < FCRAM_PADDR_END)
+            region_end = FCRAM_PADDR_END;
+        else if (paddr >= DSP_RAM_PADDR && paddr < DSP_RAM_PADDR_END)
+            region_end = DSP_RAM_PADDR_END;
+        else if (paddr >= IO_AREA_PADDR && paddr < IO_AREA_PADDR_END)
+            region_end = IO_AREA_PADDR_END;
+        else
+            region_end = paddr + PAGE_SIZE; // Unknown region, process one page at a time
+
+        const u32 region_pages =
+            std::min(num_pages, (u32)((region_end - (paddr & ~PAGE_MASK)) >> PAGE_BITS));
+        num_pages -= region_pages;
+        paddr += region_pages * PAGE_SIZE;
+
+        for (u32 i = 0; i < region_pages; ++i, vaddr += PAGE_SIZE) {
+            const size_t page_index = vaddr >> PAGE_BITS;
+            u8& res_count = current_page_table->cached_res_count[page_index];
+            ASSERT_MSG(count_delta <= UINT8_MAX - res_count, "Rasterizer resource cache counter overflow!");
+            ASSERT_MSG(count_delta >= -res_count, "Rasterizer resource cache counter underflow!");
+
+            // Switch page type to cached if now cached
+            if (res_count == 0) {
+                PageType& page_type = current_page_table->attributes[page_index];
+                switch (page_type) {
+                case PageType::Memory:
+                    page_type = PageType::RasterizerCachedMemory;
+                    current_page_table->pointers[page_index] = nullptr;
+                    break;
+                case PageType::Special:
+                    page_type = PageType::RasterizerCachedSpecial;
+                    break;
+                default:
+                    UNREACHABLE();
+                }
             }
-        }
 
-        res_count += count_delta;
-
-        // Switch page type to uncached if now uncached
-        if (res_count == 0) {
-            PageType& page_type = current_page_table->attributes[vaddr >> PAGE_BITS];
-            switch (page_type) {
-            case PageType::RasterizerCachedMemory:
-                page_type = PageType::Memory;
-                current_page_table->pointers[vaddr >> PAGE_BITS] = GetPointerFromVMA(vaddr & ~PAGE_MASK);
-                break;
-            case PageType::RasterizerCachedSpecial:
-                page_type = PageType::Special;
-                break;
-            default:
-                UNREACHABLE();
+            res_count += count_delta;
+
+            // Switch page type to uncached if now uncached
+            if (res_count == 0) {
+                PageType& page_type = current_page_table->attributes[page_index];
+                switch (page_type) {
+                case PageType::RasterizerCachedMemory:
+                    page_type = PageType::Memory;
+                    current_page_table->pointers[page_index] = GetPointerFromVMA(vaddr & ~PAGE_MASK);
+                    break;
+                case PageType::RasterizerCachedSpecial:
+                    page_type = PageType::Special;
+                    break;
+                default:
+                    UNREACHABLE();
+                }
             }
         }
-        paddr += PAGE_SIZE;
     }
 }
 
@@ -348,29 +487,47 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
     }
 }
 
-u8 Read8(const VAddr addr) {
+u8 ReadSlow8(const VAddr addr) {
     return Read<u8>(addr);
 }
 
-u16 Read16(const VAddr addr) {
+u16 ReadSlow16(const VAddr addr) {
     return Read<u16_le>(addr);
 }
 
-u32 Read32(const VAddr addr) {
+u32 ReadSlow32(const VAddr addr) {
     return Read<u32_le>(addr);
 }
 
-u64 Read64(const VAddr addr) {
+u64 ReadSlow64(const VAddr addr) {
     return Read<u64_le>(addr);
 }
 
+/**
+ * Starting at page_index (already known to be of type `Memory`), extends copy_amount over
+ * the maximal run of contiguously-mapped pages, so that bulk transfers covering one mapped
+ * region become a single memcpy instead of one PageType dispatch per 4KB page. page_index
+ * is advanced to the last page consumed.
+ */
+static size_t ExtendContiguousSpan(size_t& page_index, size_t copy_amount, size_t remaining_size) {
+    while (copy_amount < remaining_size &&
+           page_index + 1 < PageTable::NUM_ENTRIES &&
+           current_page_table->attributes[page_index + 1] == PageType::Memory &&
+           current_page_table->pointers[page_index + 1] ==
+               current_page_table->pointers[page_index] + PAGE_SIZE) {
+        page_index++;
+        copy_amount += std::min<size_t>(PAGE_SIZE, remaining_size - copy_amount);
+    }
+    return copy_amount;
+}
+
 void ReadBlock(const VAddr src_addr, void* dest_buffer, const size_t size) {
     size_t remaining_size = size;
     size_t page_index = src_addr >> PAGE_BITS;
     size_t page_offset = src_addr & PAGE_MASK;
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
+        size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
         const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
 
         switch (current_page_table->attributes[page_index]) {
@@ -383,6 +540,7 @@ void ReadBlock(const VAddr src_addr, void* dest_buffer, const size_t size) {
             DEBUG_ASSERT(current_page_table->pointers[page_index]);
 
             const u8* src_ptr = current_page_table->pointers[page_index] + page_offset;
+            copy_amount = ExtendContiguousSpan(page_index, copy_amount, remaining_size);
             std::memcpy(dest_buffer, src_ptr, copy_amount);
             break;
         }
@@ -417,19 +575,19 @@ void ReadBlock(const VAddr src_addr, void* dest_buffer, const size_t size) {
     }
 }
 
-void Write8(const VAddr addr, const u8 data) {
+void WriteSlow8(const VAddr addr, const u8 data) {
     Write<u8>(addr, data);
 }
 
-void Write16(const VAddr addr, const u16 data) {
+void WriteSlow16(const VAddr addr, const u16 data) {
     Write<u16_le>(addr, data);
 }
 
-void Write32(const VAddr addr, const u32 data) {
+void WriteSlow32(const VAddr addr, const u32 data) {
     Write<u32_le>(addr, data);
 }
 
-void Write64(const VAddr addr, const u64 data) {
+void WriteSlow64(const VAddr addr, const u64 data) {
     Write<u64_le>(addr, data);
 }
 
@@ -439,7 +597,7 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const size_t size
     size_t page_offset = dest_addr & PAGE_MASK;
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
+        size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
         const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
 
         switch (current_page_table->attributes[page_index]) {
@@ -451,6 +609,7 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const size_t size
             DEBUG_ASSERT(current_page_table->pointers[page_index]);
 
             u8* dest_ptr = current_page_table->pointers[page_index] + page_offset;
+            copy_amount = ExtendContiguousSpan(page_index, copy_amount, remaining_size);
             std::memcpy(dest_ptr, src_buffer, copy_amount);
             break;
         }
@@ -478,6 +637,10 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const size_t size
             UNREACHABLE();
         }
 
+        // The span may hold translated code (checked after the copy so the extended
+        // contiguous length is known; execution only resumes once the block returns)
+        InvalidateCodePages(current_vaddr, static_cast<u32>(copy_amount));
+
         page_index++;
         page_offset = 0;
         src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
@@ -493,7 +656,7 @@ void ZeroBlock(const VAddr dest_addr, const size_t size) {
     static const std::array<u8, PAGE_SIZE> zeros = {};
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
+        size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
         const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
 
         switch (current_page_table->attributes[page_index]) {
@@ -504,7 +667,10 @@ void ZeroBlock(const VAddr dest_addr, const size_t size) {
         case PageType::Memory: {
             DEBUG_ASSERT(current_page_table->pointers[page_index]);
 
+            // One wide memset over the maximal contiguous span; the libc implementation
+            // already uses the widest stores the host supports.
             u8* dest_ptr = current_page_table->pointers[page_index] + page_offset;
+            copy_amount = ExtendContiguousSpan(page_index, copy_amount, remaining_size);
             std::memset(dest_ptr, 0, copy_amount);
             break;
         }
@@ -532,6 +698,8 @@ void ZeroBlock(const VAddr dest_addr, const size_t size) {
             UNREACHABLE();
         }
 
+        InvalidateCodePages(current_vaddr, static_cast<u32>(copy_amount));
+
         page_index++;
         page_offset = 0;
         remaining_size -= copy_amount;
@@ -544,7 +712,7 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, const size_t size) {
     size_t page_offset = src_addr & PAGE_MASK;
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
+        size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
         const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
 
         switch (current_page_table->attributes[page_index]) {
@@ -555,7 +723,11 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, const size_t size) {
         }
         case PageType::Memory: {
             DEBUG_ASSERT(current_page_table->pointers[page_index]);
+
+            // Hand WriteBlock the maximal contiguous source span; if the destination is
+            // contiguous too, the whole transfer collapses into a single memcpy.
             const u8* src_ptr = current_page_table->pointers[page_index] + page_offset;
+            copy_amount = ExtendContiguousSpan(page_index, copy_amount, remaining_size);
             WriteBlock(dest_addr, src_ptr, copy_amount);
             break;
         }
@@ -595,43 +767,49 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, const size_t size) {
     }
 }
 
+void ApplyCodePatch(const VAddr dest_addr, const void* patch, const size_t size) {
+    // WriteBlock consults the per-page code map and drops exactly the translations
+    // covering the patched pages on each core; nothing further is needed here.
+    WriteBlock(dest_addr, patch, size);
+}
+
 template<>
-u8 ReadMMIO<u8>(MMIORegionPointer mmio_handler, VAddr addr) {
+u8 ReadMMIO<u8>(MMIORegion* mmio_handler, VAddr addr) {
     return mmio_handler->Read8(addr);
 }
 
 template<>
-u16 ReadMMIO<u16>(MMIORegionPointer mmio_handler, VAddr addr) {
+u16 ReadMMIO<u16>(MMIORegion* mmio_handler, VAddr addr) {
     return mmio_handler->Read16(addr);
 }
 
 template<>
-u32 ReadMMIO<u32>(MMIORegionPointer mmio_handler, VAddr addr) {
+u32 ReadMMIO<u32>(MMIORegion* mmio_handler, VAddr addr) {
     return mmio_handler->Read32(addr);
 }
 
 template<>
-u64 ReadMMIO<u64>(MMIORegionPointer mmio_handler, VAddr addr) {
+u64 ReadMMIO<u64>(MMIORegion* mmio_handler, VAddr addr) {
     return mmio_handler->Read64(addr);
 }
 
 template<>
-void WriteMMIO<u8>(MMIORegionPointer mmio_handler, VAddr addr, const u8 data) {
+void WriteMMIO<u8>(MMIORegion* mmio_handler, VAddr addr, const u8 data) {
     mmio_handler->Write8(addr, data);
 }
 
 template<>
-void WriteMMIO<u16>(MMIORegionPointer mmio_handler, VAddr addr, const u16 data) {
+void WriteMMIO<u16>(MMIORegion* mmio_handler, VAddr addr, const u16 data) {
     mmio_handler->Write16(addr, data);
 }
 
 template<>
-void WriteMMIO<u32>(MMIORegionPointer mmio_handler, VAddr addr, const u32 data) {
+void WriteMMIO<u32>(MMIORegion* mmio_handler, VAddr addr, const u32 data) {
     mmio_handler->Write32(addr, data);
 }
 
 template<>
-void WriteMMIO<u64>(MMIORegionPointer mmio_handler, VAddr addr, const u64 data) {
+void WriteMMIO<u64>(MMIORegion* mmio_handler, VAddr addr, const u64 data) {
     mmio_handler->Write64(addr, data);
 }
 
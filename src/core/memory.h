@@ -5,8 +5,10 @@
 #pragma once
 
 #include <cstddef>
+#include <cstring>
 
 #include "common/common_types.h"
+#include "common/swap.h"
 
 namespace Memory {
 
@@ -113,23 +115,134 @@ enum : VAddr {
 bool IsValidVirtualAddress(const VAddr addr);
 bool IsValidPhysicalAddress(const PAddr addr);
 
-u8 Read8(VAddr addr);
-u16 Read16(VAddr addr);
-u32 Read32(VAddr addr);
-u64 Read64(VAddr addr);
+/**
+ * Page-pointer array of the currently active page table, exported so that the sized
+ * accessors below can inline the common case of an access to regular memory — one
+ * indexed fetch, a null check and a host load — into their callers. Everything else
+ * (MMIO, rasterizer-cached and unmapped pages) goes through the out-of-line slow
+ * paths in memory.cpp. The CPU interpreter is the main beneficiary; accessor call
+ * overhead is a significant share of its run time.
+ */
+extern u8** current_page_pointers;
 
-void Write8(VAddr addr, u8 data);
-void Write16(VAddr addr, u16 data);
-void Write32(VAddr addr, u32 data);
-void Write64(VAddr addr, u64 data);
+/**
+ * Per-page self-modifying-code flags of the current page table (see
+ * PageTable::contains_code), exposed alongside the pointer array so the inline write fast
+ * path can test them. Writes to flagged pages must take the slow path, which drops the
+ * translations covering the page before storing.
+ */
+extern const u8* current_page_contains_code;
+
+u8 ReadSlow8(VAddr addr);
+u16 ReadSlow16(VAddr addr);
+u32 ReadSlow32(VAddr addr);
+u64 ReadSlow64(VAddr addr);
+
+void WriteSlow8(VAddr addr, u8 data);
+void WriteSlow16(VAddr addr, u16 data);
+void WriteSlow32(VAddr addr, u32 data);
+void WriteSlow64(VAddr addr, u64 data);
+
+template <typename T>
+inline T ReadGeneric(const VAddr addr) {
+    const u8* page_pointer = current_page_pointers[addr >> PAGE_BITS];
+    if (page_pointer) {
+        // NOTE: Avoid adding any extra logic to this fast-path block
+        T value;
+        std::memcpy(&value, &page_pointer[addr & PAGE_MASK], sizeof(T));
+        return value;
+    }
+
+    switch (sizeof(T)) {
+    case 1: return static_cast<T>(ReadSlow8(addr));
+    case 2: return static_cast<T>(ReadSlow16(addr));
+    case 4: return static_cast<T>(ReadSlow32(addr));
+    default: return static_cast<T>(ReadSlow64(addr));
+    }
+}
+
+template <typename T>
+inline void WriteGeneric(const VAddr addr, const T data) {
+    u8* page_pointer = current_page_pointers[addr >> PAGE_BITS];
+    if (page_pointer && !current_page_contains_code[addr >> PAGE_BITS]) {
+        // NOTE: Avoid adding any extra logic to this fast-path block
+        std::memcpy(&page_pointer[addr & PAGE_MASK], &data, sizeof(T));
+        return;
+    }
+
+    switch (sizeof(T)) {
+    case 1: WriteSlow8(addr, static_cast<u8>(data)); break;
+    case 2: WriteSlow16(addr, static_cast<u16>(data)); break;
+    case 4: WriteSlow32(addr, static_cast<u32>(data)); break;
+    default: WriteSlow64(addr, static_cast<u64>(data)); break;
+    }
+}
+
+inline u8 Read8(const VAddr addr) {
+    return ReadGeneric<u8>(addr);
+}
+inline u16 Read16(const VAddr addr) {
+    return ReadGeneric<u16_le>(addr);
+}
+inline u32 Read32(const VAddr addr) {
+    return ReadGeneric<u32_le>(addr);
+}
+inline u64 Read64(const VAddr addr) {
+    return ReadGeneric<u64_le>(addr);
+}
+
+inline void Write8(const VAddr addr, const u8 data) {
+    WriteGeneric<u8>(addr, data);
+}
+inline void Write16(const VAddr addr, const u16 data) {
+    WriteGeneric<u16_le>(addr, data);
+}
+inline void Write32(const VAddr addr, const u32 data) {
+    WriteGeneric<u32_le>(addr, data);
+}
+inline void Write64(const VAddr addr, const u64 data) {
+    WriteGeneric<u64_le>(addr, data);
+}
 
 void ReadBlock(const VAddr src_addr, void* dest_buffer, size_t size);
 void WriteBlock(const VAddr dest_addr, const void* src_buffer, size_t size);
 void ZeroBlock(const VAddr dest_addr, const size_t size);
 void CopyBlock(VAddr dest_addr, VAddr src_addr, size_t size);
 
+/**
+ * Writes a runtime code patch (cheat, game patch) into guest memory and discards exactly
+ * the translated blocks covering the patched range on each CPU core. Use this instead of
+ * WriteBlock when the destination may hold code that has already executed, so the patch
+ * takes effect without flushing the whole translation cache.
+ */
+void ApplyCodePatch(VAddr dest_addr, const void* patch, size_t size);
+
+/**
+ * Marks the pages covering [start, start + size) as containing translated CPU code. The
+ * translation layer calls this for every block it translates; subsequent guest writes to
+ * a marked page discard only the translations covering that page, so streaming an
+ * overlay or decompressing code at runtime leaves unrelated hot blocks alive.
+ */
+void MarkRegionAsCode(VAddr start, u32 size);
+
 u8* GetPointer(VAddr virtual_address);
 
+/**
+ * Attempts to resolve [vaddr, vaddr + size) to one contiguous host span backed by plain
+ * memory, so that hot consumers can operate on guest data without copying it out.
+ * Returns a read-only pointer to the start of the span, or nullptr if the range touches
+ * unmapped, MMIO or rasterizer-cached pages or crosses a mapping discontinuity; callers
+ * must then fall back to ReadBlock or the sized accessors.
+ */
+const u8* GetSpan(VAddr vaddr, size_t size);
+
+/**
+ * Writable variant of GetSpan, with the same contiguity rules. Writing through the span is
+ * safe because MMIO and rasterizer-cached pages never yield one; those take the WriteBlock
+ * fallback, which performs the necessary special handling.
+ */
+u8* GetWriteSpan(VAddr vaddr, size_t size);
+
 /**
 * Converts a virtual address inside a region with 1:1 mapping to physical memory to a physical
 * address. This should be used by services to translate addresses for use by the hardware.
@@ -148,6 +261,29 @@ VAddr PhysicalToVirtualAddress(PAddr addr);
  */
 u8* GetPhysicalPointer(PAddr address);
 
+/**
+ * Host mapping of the physical memory region (FCRAM, VRAM, DSP RAM) containing one address.
+ * Units that touch many elements of a single surface or stream resolve the region once per
+ * operation with GetPhysicalRegion and then turn each physical address into a host pointer
+ * with a bounds check and an add, instead of re-running GetPhysicalPointer's classification
+ * chain and page table walk per element.
+ */
+struct PhysicalRegion {
+    PAddr base = 0;          ///< Physical base address of the region
+    u32 size = 0;            ///< Region size in bytes
+    u8* host_base = nullptr; ///< Host pointer to the region's base; nullptr if unmapped
+
+    /// Returns the host pointer for an address inside the region, or nullptr outside it
+    u8* GetPointer(PAddr addr) const {
+        if (host_base == nullptr || addr - base >= size)
+            return nullptr;
+        return host_base + (addr - base);
+    }
+};
+
+/// Resolves the physical region containing the address; see PhysicalRegion
+PhysicalRegion GetPhysicalRegion(PAddr address);
+
 /**
  * Adds the supplied value to the rasterizer resource cache counter of each
  * page touching the region.
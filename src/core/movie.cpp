@@ -0,0 +1,216 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+
+#include "common/file_util.h"
+#include "common/logging/log.h"
+
+#include "core/movie.h"
+
+namespace Movie {
+
+enum class Mode {
+    None,
+    Recording,
+    Playing,
+};
+
+static const u32 MOVIE_MAGIC = 0x564D5443; // 'CTMV'
+static const u32 MOVIE_VERSION = 1;
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+static_assert(sizeof(FileHeader) == 8, "Movie file header has wrong size");
+
+/// One change of the input sample, keyed by the HID update it first applies to
+struct FileEntry {
+    u64 update_index;
+    u32 pad_state_hex;
+    s16 circle_pad_x;
+    s16 circle_pad_y;
+    u16 touch_x;
+    u16 touch_y;
+    u8 touch_pressed;
+    u8 reserved[3];
+};
+static_assert(sizeof(FileEntry) == 24, "Movie file entry has wrong size");
+
+static Mode mode = Mode::None;
+static FileUtil::IOFile movie_file;
+
+/// Number of HID updates seen since recording/playback started
+static u64 update_count;
+
+/// Last sample written (recording) or applied (playback)
+static InputSample current_sample;
+static bool current_sample_valid;
+
+// Playback state: all entries read up front, consumed in order
+static std::vector<FileEntry> playback_entries;
+static size_t playback_cursor;
+static bool playback_end_logged;
+
+static void Reset() {
+    mode = Mode::None;
+    update_count = 0;
+    current_sample_valid = false;
+    playback_entries.clear();
+    playback_cursor = 0;
+    playback_end_logged = false;
+}
+
+bool StartRecording(const std::string& path) {
+    if (mode != Mode::None) {
+        LOG_ERROR(Core, "A movie is already being recorded or played");
+        return false;
+    }
+
+    movie_file.Open(path, "wb");
+    if (!movie_file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to create movie file %s", path.c_str());
+        return false;
+    }
+
+    FileHeader header = { MOVIE_MAGIC, MOVIE_VERSION };
+    if (movie_file.WriteBytes(&header, sizeof(header)) != sizeof(header)) {
+        LOG_ERROR(Core, "Failed to write movie header to %s", path.c_str());
+        movie_file.Close();
+        return false;
+    }
+
+    Reset();
+    mode = Mode::Recording;
+    LOG_INFO(Core, "Recording input movie to %s", path.c_str());
+    return true;
+}
+
+bool StartPlayback(const std::string& path) {
+    if (mode != Mode::None) {
+        LOG_ERROR(Core, "A movie is already being recorded or played");
+        return false;
+    }
+
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to open movie file %s", path.c_str());
+        return false;
+    }
+
+    FileHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != MOVIE_MAGIC) {
+        LOG_ERROR(Core, "%s is not a movie file", path.c_str());
+        return false;
+    }
+    if (header.version != MOVIE_VERSION) {
+        LOG_ERROR(Core, "Movie file %s has unsupported version %u", path.c_str(), header.version);
+        return false;
+    }
+
+    Reset();
+
+    const u64 num_entries = (file.GetSize() - sizeof(header)) / sizeof(FileEntry);
+    playback_entries.resize(static_cast<size_t>(num_entries));
+    if (file.ReadBytes(playback_entries.data(), num_entries * sizeof(FileEntry)) !=
+        num_entries * sizeof(FileEntry)) {
+        LOG_ERROR(Core, "Movie file %s is truncated", path.c_str());
+        playback_entries.clear();
+        return false;
+    }
+
+    mode = Mode::Playing;
+    LOG_INFO(Core, "Playing back input movie %s (%llu input changes)", path.c_str(),
+             (unsigned long long)num_entries);
+    return true;
+}
+
+bool IsRecording() {
+    return mode == Mode::Recording;
+}
+
+bool IsPlaying() {
+    return mode == Mode::Playing;
+}
+
+static bool SamplesEqual(const InputSample& a, const InputSample& b) {
+    return a.pad_state_hex == b.pad_state_hex &&
+           a.circle_pad_x == b.circle_pad_x && a.circle_pad_y == b.circle_pad_y &&
+           a.touch_x == b.touch_x && a.touch_y == b.touch_y &&
+           a.touch_pressed == b.touch_pressed;
+}
+
+void HandleInputSample(InputSample& sample) {
+    switch (mode) {
+    case Mode::None:
+        return;
+
+    case Mode::Recording:
+        if (!current_sample_valid || !SamplesEqual(sample, current_sample)) {
+            FileEntry entry = {};
+            entry.update_index = update_count;
+            entry.pad_state_hex = sample.pad_state_hex;
+            entry.circle_pad_x = sample.circle_pad_x;
+            entry.circle_pad_y = sample.circle_pad_y;
+            entry.touch_x = sample.touch_x;
+            entry.touch_y = sample.touch_y;
+            entry.touch_pressed = sample.touch_pressed ? 1 : 0;
+
+            if (movie_file.WriteBytes(&entry, sizeof(entry)) != sizeof(entry)) {
+                LOG_ERROR(Core, "Failed to write movie entry; stopping recording");
+                movie_file.Close();
+                Reset();
+                return;
+            }
+
+            current_sample = sample;
+            current_sample_valid = true;
+        }
+        break;
+
+    case Mode::Playing:
+        // Advance to the last recorded change at or before this update; the sample then holds
+        // until the next change, exactly as it did when recorded
+        while (playback_cursor < playback_entries.size() &&
+               playback_entries[playback_cursor].update_index <= update_count) {
+            const FileEntry& entry = playback_entries[playback_cursor++];
+            current_sample.pad_state_hex = entry.pad_state_hex;
+            current_sample.circle_pad_x = entry.circle_pad_x;
+            current_sample.circle_pad_y = entry.circle_pad_y;
+            current_sample.touch_x = entry.touch_x;
+            current_sample.touch_y = entry.touch_y;
+            current_sample.touch_pressed = entry.touch_pressed != 0;
+            current_sample_valid = true;
+        }
+
+        if (current_sample_valid) {
+            sample = current_sample;
+        } else {
+            // Before the first recorded change the pad is in its neutral state
+            sample = InputSample();
+        }
+
+        if (!playback_end_logged && playback_cursor == playback_entries.size()) {
+            LOG_INFO(Core, "Movie playback reached the end of the recorded input stream");
+            playback_end_logged = true;
+        }
+        break;
+    }
+
+    update_count++;
+}
+
+void Shutdown() {
+    if (mode == Mode::Recording) {
+        movie_file.Close();
+        LOG_INFO(Core, "Finished recording input movie (%llu HID updates)",
+                 (unsigned long long)update_count);
+    }
+    Reset();
+}
+
+} // namespace Movie
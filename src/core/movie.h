@@ -0,0 +1,51 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "common/common_types.h"
+
+namespace Movie {
+
+/// The input sample fed into the HID shared page on one update
+struct InputSample {
+    u32 pad_state_hex;
+    s16 circle_pad_x;
+    s16 circle_pad_y;
+    u16 touch_x;
+    u16 touch_y;
+    bool touch_pressed;
+};
+
+/**
+ * Starts recording the HID input stream to the given file. Only updates where the sample
+ * changed are written, keyed by the HID update index, so idle stretches cost nothing.
+ * @return false if the file could not be created
+ */
+bool StartRecording(const std::string& path);
+
+/**
+ * Starts replaying a previously recorded input stream from the given file. While playback is
+ * active, host input is ignored and the recorded samples are fed to HID at the exact update
+ * indices they were captured at; since HID updates are driven by CoreTiming, the stream the
+ * game sees is bit-exact across runs and builds.
+ * @return false if the file is missing or malformed
+ */
+bool StartPlayback(const std::string& path);
+
+bool IsRecording();
+bool IsPlaying();
+
+/**
+ * Called once per HID update with the freshly sampled input. Writes the sample to the movie
+ * when recording; replaces it with the recorded one when replaying.
+ */
+void HandleInputSample(InputSample& sample);
+
+/// Finalizes any active recording or playback and closes the movie file
+void Shutdown();
+
+} // namespace Movie
@@ -0,0 +1,193 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/logging/log.h"
+
+#include "core/rewind.h"
+#include "core/savestate.h"
+#include "core/settings.h"
+
+namespace Rewind {
+
+/// A snapshot is taken every this many frames (half a second at 60 FPS).
+static const u32 SNAPSHOT_INTERVAL_FRAMES = 30;
+
+/// Maximum number of deltas kept, bounding how far back the user can rewind.
+static const size_t MAX_RING_ENTRIES = 120;
+
+/// Granularity of the delta comparison, in bytes.
+static const size_t DELTA_BLOCK_SIZE = 64;
+
+// Ring of backward deltas, newest at the back. Applying the back entry to `newest_state`
+// turns it into the previous snapshot, so rewinding is repeated application + pop.
+// Each delta is a sequence of (u32 offset, u32 length, `length` bytes of old contents).
+static std::deque<std::vector<u8>> delta_ring;
+static std::vector<u8> newest_state; ///< Full snapshot matching the most recent capture
+static std::mutex ring_mutex;
+
+static std::thread worker_thread;
+static std::mutex queue_mutex;
+static std::condition_variable queue_cv;
+static std::deque<std::vector<u8>> pending_snapshots;
+static bool worker_running = false;
+static bool stop_worker = false;
+
+static u32 frames_until_capture = SNAPSHOT_INTERVAL_FRAMES;
+
+/**
+ * Builds a backward delta turning `new_state` into `old_state`: for every block that
+ * differs, the old contents are recorded. Runs of equal blocks — the overwhelming
+ * majority between two snapshots half a second apart — cost nothing but the compare.
+ */
+static std::vector<u8> BuildBackwardDelta(const std::vector<u8>& old_state,
+                                          const std::vector<u8>& new_state) {
+    std::vector<u8> delta;
+
+    size_t offset = 0;
+    const size_t size = old_state.size();
+    while (offset < size) {
+        const size_t block = std::min(DELTA_BLOCK_SIZE, size - offset);
+        if (std::memcmp(&old_state[offset], &new_state[offset], block) != 0) {
+            // Extend the run over consecutive differing blocks
+            size_t run_end = offset + block;
+            while (run_end < size) {
+                const size_t next = std::min(DELTA_BLOCK_SIZE, size - run_end);
+                if (std::memcmp(&old_state[run_end], &new_state[run_end], next) == 0)
+                    break;
+                run_end += next;
+            }
+
+            const u32 run_offset = static_cast<u32>(offset);
+            const u32 run_length = static_cast<u32>(run_end - offset);
+            const size_t pos = delta.size();
+            delta.resize(pos + 2 * sizeof(u32) + run_length);
+            std::memcpy(&delta[pos], &run_offset, sizeof(u32));
+            std::memcpy(&delta[pos + sizeof(u32)], &run_length, sizeof(u32));
+            std::memcpy(&delta[pos + 2 * sizeof(u32)], &old_state[offset], run_length);
+
+            offset = run_end;
+        } else {
+            offset += block;
+        }
+    }
+    return delta;
+}
+
+/// Applies a backward delta produced by BuildBackwardDelta() to `state` in place.
+static void ApplyBackwardDelta(const std::vector<u8>& delta, std::vector<u8>& state) {
+    size_t pos = 0;
+    while (pos + 2 * sizeof(u32) <= delta.size()) {
+        u32 run_offset, run_length;
+        std::memcpy(&run_offset, &delta[pos], sizeof(u32));
+        std::memcpy(&run_length, &delta[pos + sizeof(u32)], sizeof(u32));
+        pos += 2 * sizeof(u32);
+
+        if (run_offset + run_length > state.size() || pos + run_length > delta.size()) {
+            LOG_ERROR(Core, "Corrupt rewind delta, dropping remainder");
+            return;
+        }
+        std::memcpy(&state[run_offset], &delta[pos], run_length);
+        pos += run_length;
+    }
+}
+
+static void WorkerLoop() {
+    while (true) {
+        std::vector<u8> raw;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [] { return stop_worker || !pending_snapshots.empty(); });
+            if (stop_worker && pending_snapshots.empty())
+                return;
+            raw = std::move(pending_snapshots.front());
+            pending_snapshots.pop_front();
+        }
+
+        std::lock_guard<std::mutex> lock(ring_mutex);
+        if (newest_state.size() != raw.size()) {
+            // First snapshot, or the address-space layout changed: restart the ring
+            delta_ring.clear();
+        } else {
+            delta_ring.push_back(BuildBackwardDelta(newest_state, raw));
+            if (delta_ring.size() > MAX_RING_ENTRIES)
+                delta_ring.pop_front();
+        }
+        newest_state = std::move(raw);
+    }
+}
+
+void Init() {
+    if (!Settings::values.enable_rewind || worker_running)
+        return;
+
+    stop_worker = false;
+    worker_thread = std::thread(WorkerLoop);
+    worker_running = true;
+}
+
+void Shutdown() {
+    if (worker_running) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stop_worker = true;
+        }
+        queue_cv.notify_one();
+        worker_thread.join();
+        worker_running = false;
+    }
+
+    pending_snapshots.clear();
+    delta_ring.clear();
+    newest_state.clear();
+    frames_until_capture = SNAPSHOT_INTERVAL_FRAMES;
+}
+
+void NotifyFrame() {
+    if (!worker_running)
+        return;
+    if (--frames_until_capture > 0)
+        return;
+    frames_until_capture = SNAPSHOT_INTERVAL_FRAMES;
+
+    {
+        // If the worker has fallen behind, skip this capture rather than queueing
+        // unboundedly; the next interval will pick it up.
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (pending_snapshots.size() >= 2)
+            return;
+    }
+
+    std::vector<u8> raw;
+    if (!SaveState::Save(raw))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        pending_snapshots.push_back(std::move(raw));
+    }
+    queue_cv.notify_one();
+}
+
+bool PopState() {
+    std::lock_guard<std::mutex> lock(ring_mutex);
+    if (newest_state.empty())
+        return false;
+
+    if (!delta_ring.empty()) {
+        ApplyBackwardDelta(delta_ring.back(), newest_state);
+        delta_ring.pop_back();
+    }
+    return SaveState::Load(newest_state);
+}
+
+} // namespace Rewind
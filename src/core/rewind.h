@@ -0,0 +1,29 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+namespace Rewind {
+
+/// Starts the delta-compression worker if rewind recording is enabled in the settings.
+void Init();
+
+/// Stops the worker and discards all recorded snapshots.
+void Shutdown();
+
+/**
+ * Called once per emulated frame (from the VBlank handler). Every few frames this takes
+ * a raw savestate snapshot and hands it to the worker thread, which delta-compresses it
+ * against the previous snapshot off the emu thread.
+ */
+void NotifyFrame();
+
+/**
+ * Steps the emulated state back by one recorded snapshot, re-applying the stored deltas
+ * in reverse. Must be called from the emu thread (or with emulation paused). Returns
+ * false if nothing has been recorded yet.
+ */
+bool PopState();
+
+} // namespace Rewind
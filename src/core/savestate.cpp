@@ -0,0 +1,143 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include "common/chunk_file.h"
+#include "common/logging/log.h"
+
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/hw/gpu.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/savestate.h"
+
+#include "video_core/pica_state.h"
+
+namespace SaveState {
+
+/// Bumped whenever the serialized layout below changes.
+static const u32 STATE_VERSION = 1;
+
+/// Number of entries in the page-pointer array (one per 4KB page of the 32-bit space).
+static const u32 PAGE_TABLE_NUM_ENTRIES = 1 << (32 - Memory::PAGE_BITS);
+
+static void DoCpuState(PointerWrap& p) {
+    Core::ThreadContext app_context, sys_context;
+
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        Core::g_app_core->SaveContext(app_context);
+        Core::g_sys_core->SaveContext(sys_context);
+    }
+
+    p.DoVoid(&app_context, sizeof(app_context));
+    p.DoVoid(&sys_context, sizeof(sys_context));
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        Core::g_app_core->LoadContext(app_context);
+        Core::g_sys_core->LoadContext(sys_context);
+    }
+}
+
+static void DoVideoState(PointerWrap& p) {
+    p.DoVoid(&GPU::g_regs, sizeof(GPU::g_regs));
+    p.DoVoid(&LCD::g_regs, sizeof(LCD::g_regs));
+
+    // Only the POD portions of the Pica state are captured. The command list pointers
+    // and the primitive assembler hold transient per-command-list state that is dead
+    // between command lists, which is when snapshots are taken.
+    Pica::State& state = Pica::g_state;
+    p.DoVoid(&state.regs, sizeof(state.regs));
+    p.DoVoid(&state.vs, sizeof(state.vs));
+    p.DoVoid(&state.gs, sizeof(state.gs));
+    p.DoVoid(&state.vs_default_attributes, sizeof(state.vs_default_attributes));
+    p.DoVoid(&state.lighting, sizeof(state.lighting));
+    p.DoVoid(&state.fog, sizeof(state.fog));
+    p.DoVoid(&state.immediate, sizeof(state.immediate));
+}
+
+/**
+ * Serializes the contents of every mapped guest page by walking the active page-pointer
+ * array. Pages are recorded as (index, contents) pairs so that Load() can detect layout
+ * changes; the layout itself (kernel objects, VMAs) is not serialized.
+ */
+static bool DoMemoryState(PointerWrap& p) {
+    u32 num_pages = 0;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (u32 i = 0; i < PAGE_TABLE_NUM_ENTRIES; ++i) {
+            if (Memory::current_page_pointers[i] != nullptr)
+                ++num_pages;
+        }
+    }
+    p.Do(num_pages);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        for (u32 i = 0; i < num_pages; ++i) {
+            u32 page_index = 0;
+            p.Do(page_index);
+
+            u8* page_pointer = page_index < PAGE_TABLE_NUM_ENTRIES
+                ? Memory::current_page_pointers[page_index] : nullptr;
+            if (page_pointer == nullptr) {
+                LOG_ERROR(Core, "Snapshot page %08X is no longer mapped, aborting load",
+                          page_index << Memory::PAGE_BITS);
+                return false;
+            }
+            p.DoVoid(page_pointer, Memory::PAGE_SIZE);
+        }
+    } else {
+        for (u32 i = 0; i < PAGE_TABLE_NUM_ENTRIES; ++i) {
+            u8* page_pointer = Memory::current_page_pointers[i];
+            if (page_pointer == nullptr)
+                continue;
+
+            u32 page_index = i;
+            p.Do(page_index);
+            p.DoVoid(page_pointer, Memory::PAGE_SIZE);
+        }
+    }
+    return true;
+}
+
+static bool DoState(PointerWrap& p) {
+    u32 version = STATE_VERSION;
+    p.Do(version);
+    if (version != STATE_VERSION) {
+        LOG_ERROR(Core, "Unsupported snapshot version %u (expected %u)", version,
+                  STATE_VERSION);
+        return false;
+    }
+
+    DoCpuState(p);
+    DoVideoState(p);
+    return DoMemoryState(p);
+}
+
+bool Save(std::vector<u8>& buffer) {
+    if (Core::g_app_core == nullptr)
+        return false;
+
+    // Measure first, then serialize into the exactly-sized buffer.
+    u8* ptr = nullptr;
+    PointerWrap p_measure(&ptr, PointerWrap::MODE_MEASURE);
+    if (!DoState(p_measure))
+        return false;
+
+    buffer.resize(reinterpret_cast<size_t>(ptr));
+    ptr = buffer.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    return DoState(p) && p.error != PointerWrap::ERROR_FAILURE;
+}
+
+bool Load(const std::vector<u8>& buffer) {
+    if (Core::g_app_core == nullptr || buffer.empty())
+        return false;
+
+    u8* ptr = const_cast<u8*>(buffer.data());
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    return DoState(p) && p.error != PointerWrap::ERROR_FAILURE;
+}
+
+} // namespace SaveState
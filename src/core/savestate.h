@@ -0,0 +1,30 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace SaveState {
+
+/**
+ * Captures the state of the currently running title into `buffer`: CPU core contexts,
+ * the GPU/LCD register files, the Pica state and every page of guest memory that is
+ * currently mapped. The snapshot is only meaningful within the session that took it —
+ * it records page contents against the live address-space layout rather than
+ * re-creating kernel objects — which is all that rewind and quick save/load need.
+ * Returns false if no title is running.
+ */
+bool Save(std::vector<u8>& buffer);
+
+/**
+ * Restores a snapshot previously produced by Save() in this session. Returns false if
+ * the buffer is from an incompatible version or the address-space layout has changed
+ * since the snapshot was taken (e.g. pages were mapped or unmapped).
+ */
+bool Load(const std::vector<u8>& buffer);
+
+} // namespace SaveState
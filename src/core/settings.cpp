@@ -4,6 +4,9 @@
 
 #include "settings.h"
 
+#include "common/memory_accounting.h"
+#include "common/thread_topology.h"
+
 #include "audio_core/audio_core.h"
 
 #include "core/gdbstub/gdbstub.h"
@@ -14,7 +17,11 @@ namespace Settings {
 
 Values values = {};
 
+/// Bumped by Apply() whenever a new set of values is published; snapshots compare against it
+static u32 version = 1;
+
 void Apply() {
+    ++version;
 
     GDBStub::SetServerPort(static_cast<u32>(values.gdbstub_port));
     GDBStub::ToggleServer(values.use_gdbstub);
@@ -22,9 +29,46 @@ void Apply() {
     VideoCore::g_hw_renderer_enabled = values.use_hw_renderer;
     VideoCore::g_shader_jit_enabled = values.use_shader_jit;
     VideoCore::g_scaled_resolution_enabled = values.use_scaled_resolution;
+    VideoCore::g_dynamic_resolution_enabled = values.use_dynamic_resolution;
+    VideoCore::g_hw_vertex_shaders_enabled = values.use_hw_vertex_shaders;
+
+    // Deterministic runs always use the null sink: generation stays paced by CoreTiming
+    // and no host audio callback can influence the run
+    AudioCore::SelectSink(values.deterministic_mode ? "null" : values.sink_id);
+
+    Common::MemoryAccounting::SetBudget(static_cast<u64>(values.cache_budget_mb) * 1024 * 1024);
+
+    for (unsigned i = 0; i < Common::NUM_THREAD_ROLES; ++i) {
+        Common::ThreadRoleConfig config;
+        config.affinity_mask = static_cast<u32>(values.thread_affinity_masks[i]);
+        config.priority = values.thread_priorities[i];
+        Common::SetThreadRoleConfig(static_cast<Common::ThreadRole>(i), config);
+    }
+
+}
+
+static std::function<void(u64)> title_profile_delegate;
+
+void SetTitleProfileDelegate(std::function<void(u64 program_id)> delegate) {
+    title_profile_delegate = std::move(delegate);
+}
+
+void NotifyTitleLoaded(u64 program_id) {
+    if (title_profile_delegate)
+        title_profile_delegate(program_id);
+}
+
+u32 GetVersion() {
+    return version;
+}
 
-    AudioCore::SelectSink(values.sink_id);
+bool UpdateSnapshot(Values& snapshot, u32& snapshot_version) {
+    if (snapshot_version == version)
+        return false;
 
+    snapshot = values;
+    snapshot_version = version;
+    return true;
 }
 
 } // namespace
@@ -4,13 +4,22 @@
 
 #pragma once
 
-#include <string>
 #include <array>
+#include <functional>
+#include <string>
 
 #include "common/common_types.h"
+#include "common/thread_topology.h"
 
 namespace Settings {
 
+namespace ThreadRoleNames {
+/// Config key prefixes for each Common::ThreadRole, in enum order
+static const std::array<const char*, Common::NUM_THREAD_ROLES> Mapping = {{
+    "emu", "render", "audio", "worker", "io",
+}};
+}
+
 namespace NativeInput {
 enum Values {
     // directly mapped keys
@@ -58,12 +67,20 @@ struct Values {
     // Controls
     std::array<int, NativeInput::NUM_INPUTS> input_mappings;
     float pad_circle_modifier_scale;
+    int hid_update_rate;
 
     // Core
+    bool use_cpu_jit;
+    bool use_fast_vfp;
     int frame_skip;
+    bool auto_frame_skip;
+    bool use_frame_limit;
+    bool enable_rewind;
+    bool accurate_cpu_timing;
 
     // Data Storage
     bool use_virtual_sd;
+    bool check_romfs_integrity;
 
     // System Region
     int region_value;
@@ -71,7 +88,10 @@ struct Values {
     // Renderer
     bool use_hw_renderer;
     bool use_shader_jit;
+    bool use_hw_vertex_shaders;
+    int sw_rasterizer_threads;
     bool use_scaled_resolution;
+    bool use_dynamic_resolution;
 
     float bg_red;
     float bg_green;
@@ -82,11 +102,57 @@ struct Values {
     // Audio
     std::string sink_id;
 
+    // Total budget, in megabytes, for the host-side caches registered with
+    // Common::MemoryAccounting (surface cache, decoded texture cache, ...). When the
+    // caches collectively exceed it each one is pressured to evict down to its
+    // proportional share. 0 leaves the caches unbounded.
+    int cache_budget_mb;
+
+    // Threading: per-role CPU affinity masks (0 = leave placement to the OS) and relative
+    // priorities in [-2, 2], indexed by Common::ThreadRole
+    std::array<int, Common::NUM_THREAD_ROLES> thread_affinity_masks;
+    std::array<int, Common::NUM_THREAD_ROLES> thread_priorities;
+
     // Debugging
     bool use_gdbstub;
     u16 gdbstub_port;
+    bool profile_hot_blocks;
+
+    // Removes every host-dependent influence on the guest instruction stream: input is
+    // taken from the movie system (or held neutral without one), audio goes to the
+    // CoreTiming-paced null sink, and guest-visible random sources use a fixed seed.
+    // Two runs of the same build then execute identically, so performance regressions
+    // can be bisected with exact diffs instead of statistics.
+    bool deterministic_mode;
 } extern values;
 
 void Apply();
 
+/**
+ * Registers the frontend delegate that overlays a title's settings profile. The NCCH
+ * loader reports the booting title's program ID through NotifyTitleLoaded() before any
+ * guest code runs; the delegate mutates `values` with the profile and calls Apply().
+ * Pass nullptr to unregister.
+ */
+void SetTitleProfileDelegate(std::function<void(u64 program_id)> delegate);
+
+/// Called by the loader once the booting title's program ID is known
+void NotifyTitleLoaded(u64 program_id);
+
+/**
+ * Returns the current settings version. Apply() bumps it every time it publishes a new set of
+ * values, so subsystems can detect changes with a single integer compare.
+ */
+u32 GetVersion();
+
+/**
+ * Refreshes a local snapshot of the settings. The snapshot is copied from `values` only when
+ * the global version differs from `snapshot_version`, letting hot paths read settings from a
+ * local copy refreshed once per frame instead of rereading the global struct field by field.
+ * @param snapshot Local copy of the settings to refresh
+ * @param snapshot_version Version the snapshot was last taken at; updated on refresh
+ * @return True if the snapshot was refreshed
+ */
+bool UpdateSnapshot(Values& snapshot, u32& snapshot_version);
+
 }
@@ -4,20 +4,29 @@
 
 #include "audio_core/audio_core.h"
 
+#include "common/memory_accounting.h"
+#include "common/telemetry.h"
+#include "common/thread_pool.h"
+
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/system.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hw/hw.h"
+#include "core/hle/dispatch_profiler.h"
+#include "core/hle/flight_recorder.h"
 #include "core/hle/hle.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
+#include "core/movie.h"
+#include "core/rewind.h"
 
 #include "video_core/video_core.h"
 
 namespace System {
 
 Result Init(EmuWindow* emu_window) {
+    Common::ThreadPool::Initialize();
     Core::Init();
     CoreTiming::Init();
     Memory::Init();
@@ -29,11 +38,21 @@ Result Init(EmuWindow* emu_window) {
     }
     AudioCore::Init();
     GDBStub::Init();
+    Rewind::Init();
 
     return Result::Success;
 }
 
 void Shutdown() {
+    // Dump the cache memory breakdown while the caches are still registered
+    Common::MemoryAccounting::LogBreakdown();
+
+    // Written before the services are torn down: the recorded events point into the port
+    // name storage that HLE::Shutdown destroys
+    HLE::FlightRecorder::Dump();
+
+    Movie::Shutdown();
+    Rewind::Shutdown();
     GDBStub::Shutdown();
     AudioCore::Shutdown();
     VideoCore::Shutdown();
@@ -42,6 +61,10 @@ void Shutdown() {
     HW::Shutdown();
     CoreTiming::Shutdown();
     Core::Shutdown();
+    // After every subsystem that may still have work in flight has shut down
+    Common::ThreadPool::Shutdown();
+    Common::Telemetry::DumpJSON();
+    HLE::DispatchProfiler::DumpJSON();
 }
 
 } // namespace
@@ -0,0 +1,166 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/file_util.h"
+#include "common/logging/log.h"
+
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+
+#include "playback.h"
+
+namespace CiTrace {
+
+Playback::Playback(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to open CiTrace file %s", filename.c_str());
+        return;
+    }
+
+    file_data.resize(static_cast<size_t>(file.GetSize()));
+    if (file_data.size() < sizeof(CTHeader) ||
+        file.ReadBytes(file_data.data(), file_data.size()) != file_data.size()) {
+        LOG_ERROR(Core, "Failed to read CiTrace file %s", filename.c_str());
+        return;
+    }
+
+    header = reinterpret_cast<const CTHeader*>(file_data.data());
+    if (std::memcmp(header->magic, CTHeader::ExpectedMagicWord(), 4) != 0 ||
+        header->version != CTHeader::ExpectedVersion()) {
+        LOG_ERROR(Core, "%s is not a version %u CiTrace file", filename.c_str(),
+                  CTHeader::ExpectedVersion());
+        return;
+    }
+
+    if (header->stream_offset + header->stream_size * sizeof(CTStreamElement) > file_data.size()) {
+        LOG_ERROR(Core, "CiTrace stream in %s extends past the end of the file", filename.c_str());
+        return;
+    }
+
+    stream = reinterpret_cast<const CTStreamElement*>(file_data.data() + header->stream_offset);
+    stream_size = header->stream_size;
+    for (u32 i = 0; i < stream_size; ++i) {
+        if (stream[i].type == FrameMarker)
+            frame_count++;
+    }
+
+    valid = true;
+}
+
+/// Copies an initial-state register block from the trace into an emulated register file
+static void LoadRegisterBlock(const u8* file_data, u32 offset, u32 size_in_words,
+                              void* registers, size_t register_bytes) {
+    size_t bytes = std::min<size_t>(size_in_words * sizeof(u32), register_bytes);
+    std::memcpy(registers, file_data + offset, bytes);
+}
+
+void Playback::LoadInitialState() {
+    const auto& offsets = header->initial_state_offsets;
+    const u8* data = file_data.data();
+
+    LoadRegisterBlock(data, offsets.gpu_registers, offsets.gpu_registers_size,
+                      &GPU::g_regs, sizeof(GPU::g_regs));
+    LoadRegisterBlock(data, offsets.lcd_registers, offsets.lcd_registers_size,
+                      &LCD::g_regs, sizeof(LCD::g_regs));
+    LoadRegisterBlock(data, offsets.pica_registers, offsets.pica_registers_size,
+                      &Pica::g_state.regs, sizeof(Pica::g_state.regs));
+    LoadRegisterBlock(data, offsets.vs_program_binary, offsets.vs_program_binary_size,
+                      Pica::g_state.vs.program_code.data(),
+                      Pica::g_state.vs.program_code.size() * sizeof(u32));
+    LoadRegisterBlock(data, offsets.vs_swizzle_data, offsets.vs_swizzle_data_size,
+                      Pica::g_state.vs.swizzle_data.data(),
+                      Pica::g_state.vs.swizzle_data.size() * sizeof(u32));
+
+    // Default attributes and float uniforms are stored as raw 24-bit floats, four words per
+    // register; see the capture side in the tracing widget
+    const u32* default_attributes = reinterpret_cast<const u32*>(data + offsets.default_attributes);
+    for (u32 i = 0; i < offsets.default_attributes_size / 4 && i < 16; ++i) {
+        for (unsigned comp = 0; comp < 4; ++comp) {
+            Pica::g_state.vs_default_attributes[i][comp] =
+                Pica::float24::FromRaw(default_attributes[4 * i + comp]);
+        }
+    }
+
+    const u32* vs_float_uniforms = reinterpret_cast<const u32*>(data + offsets.vs_float_uniforms);
+    for (u32 i = 0; i < offsets.vs_float_uniforms_size / 4 && i < 96; ++i) {
+        for (unsigned comp = 0; comp < 4; ++comp) {
+            Pica::g_state.vs.uniforms.f[i][comp] =
+                Pica::float24::FromRaw(vs_float_uniforms[4 * i + comp]);
+        }
+    }
+
+    // Geometry shader state is not captured by the recorder yet
+}
+
+void Playback::ReplayElement(const CTStreamElement& element) {
+    switch (element.type) {
+    case MemoryLoad:
+    {
+        const auto& load = element.memory_load;
+        u8* dest = Memory::GetPhysicalPointer(load.physical_address);
+        if (dest == nullptr || load.file_offset + load.size > file_data.size()) {
+            LOG_WARNING(Core, "Skipping invalid CiTrace memory load to 0x%08x (%u bytes)",
+                        load.physical_address, load.size);
+            break;
+        }
+        std::memcpy(dest, file_data.data() + load.file_offset, load.size);
+        Memory::RasterizerFlushAndInvalidateRegion(load.physical_address, load.size);
+        break;
+    }
+
+    case RegisterWrite:
+    {
+        const auto& write = element.register_write;
+        // The recorder stores MMIO physical addresses; map them back to the virtual range
+        // HW::Write expects (the inverse of the offset applied when recording)
+        u32 vaddr = write.physical_address - 0x10100000 + 0x1EC00000;
+        switch (write.size) {
+        case CTRegisterWrite::SIZE_8:
+            HW::Write<u8>(vaddr, static_cast<u8>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_16:
+            HW::Write<u16>(vaddr, static_cast<u16>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_32:
+            HW::Write<u32>(vaddr, static_cast<u32>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_64:
+            HW::Write<u64>(vaddr, write.value);
+            break;
+        }
+        break;
+    }
+
+    case FrameMarker:
+        break;
+
+    default:
+        LOG_WARNING(Core, "Unknown CiTrace stream element type 0x%x", element.type);
+        break;
+    }
+}
+
+bool Playback::AdvanceFrame() {
+    if (stream_cursor >= stream_size)
+        return false;
+
+    while (stream_cursor < stream_size) {
+        const CTStreamElement& element = stream[stream_cursor++];
+        ReplayElement(element);
+        if (element.type == FrameMarker)
+            break;
+    }
+    return true;
+}
+
+} // namespace CiTrace
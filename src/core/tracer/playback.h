@@ -0,0 +1,62 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+
+#include "citrace.h"
+
+namespace CiTrace {
+
+/**
+ * Replays a CiTrace recording straight into the GPU/LCD register interfaces and emulated
+ * memory, without the CPU core running. This turns a recorded trace into a deterministic,
+ * GPU-only workload that can be used to benchmark video_core in isolation.
+ */
+class Playback {
+public:
+    /// Loads the given .ctf file; check IsValid() before using the other methods.
+    explicit Playback(const std::string& filename);
+
+    bool IsValid() const {
+        return valid;
+    }
+
+    /// Number of frame markers in the trace
+    u32 GetFrameCount() const {
+        return frame_count;
+    }
+
+    /// Writes the trace's initial GPU/LCD/Pica register state and shader setup into the emulator
+    void LoadInitialState();
+
+    /**
+     * Replays stream elements up to and including the next frame marker.
+     * @return false once the end of the stream has been reached.
+     */
+    bool AdvanceFrame();
+
+    /// Rewinds the stream to the first element so the trace can be replayed again
+    void Rewind() {
+        stream_cursor = 0;
+    }
+
+private:
+    void ReplayElement(const CTStreamElement& element);
+
+    /// Entire trace file; memory loads reference ranges of this buffer by file offset
+    std::vector<u8> file_data;
+    const CTHeader* header = nullptr;
+    const CTStreamElement* stream = nullptr;
+    u32 stream_size = 0;
+    u32 stream_cursor = 0;
+    u32 frame_count = 0;
+    bool valid = false;
+};
+
+} // namespace CiTrace
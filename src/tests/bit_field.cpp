@@ -0,0 +1,71 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <tuple>
+
+#include <catch.hpp>
+
+#include "common/bit_field.h"
+#include "common/common_types.h"
+
+// The extraction helpers are constexpr; evaluating them in static_asserts both verifies the
+// decoded values and proves the shift-mask formulation is a constant expression, so any change
+// that introduces non-constexpr constructs (and with them potential branches) fails to compile.
+static_assert(ExtractBits<0, 16>(0xABCD1234u) == 0x1234, "low unsigned field");
+static_assert(ExtractBits<16, 4>(0xABCD1234u) == 0xD, "mid unsigned field");
+static_assert(ExtractBits<20, 11>(0xABCD1234u) == 0x2BC, "wide unsigned field");
+static_assert(ExtractBits<31, 1>(0xABCD1234u) == 1, "top bit");
+static_assert(ExtractBits<0, 32>(0xDEADBEEFu) == 0xDEADBEEF, "full width");
+
+static_assert(ExtractSignedBits<4, 8>(0x00000770u) == 0x77, "positive signed field");
+static_assert(ExtractSignedBits<4, 8>(0x00000F80u) == -0x08, "negative signed field");
+static_assert(ExtractSignedBits<0, 32>(0xFFFFFFFFu) == -1, "full-width signed field");
+static_assert(ExtractSignedBits<12, 12>(0x00800000u) == -0x800, "minimum signed field value");
+
+static_assert(ExtractFields<UnsignedField<0, 16>, UnsignedField<16, 4>>(0xABCD1234u) ==
+                  std::make_tuple(0x1234u, 0xDu),
+              "multi-field extraction");
+
+namespace {
+
+union TestRegister {
+    u32 hex;
+
+    BitField<0, 16, u32> low;
+    BitField<16, 4, u32> nibble;
+    BitField<4, 8, s32> signed_byte;
+    BitField<20, 11, u32> wide;
+};
+
+} // namespace
+
+TEST_CASE("Extraction helpers match BitField decoding", "[common]") {
+    static const u32 patterns[] = {
+        0x00000000, 0xFFFFFFFF, 0xABCD1234, 0x80000001, 0x00000F80, 0x7FF00000, 0xDEADBEEF,
+    };
+
+    for (u32 pattern : patterns) {
+        TestRegister reg;
+        reg.hex = pattern;
+
+        const u32 extracted_low = ExtractBits<0, 16>(pattern);
+        const u32 extracted_nibble = ExtractBits<16, 4>(pattern);
+        const u32 extracted_wide = ExtractBits<20, 11>(pattern);
+        const s32 extracted_signed = ExtractSignedBits<4, 8>(pattern);
+        CHECK(extracted_low == reg.low);
+        CHECK(extracted_nibble == reg.nibble);
+        CHECK(extracted_wide == reg.wide);
+        CHECK(extracted_signed == reg.signed_byte);
+
+        u32 low, nibble, wide;
+        s32 signed_byte;
+        std::tie(low, nibble, wide, signed_byte) =
+            ExtractFields<UnsignedField<0, 16>, UnsignedField<16, 4>, UnsignedField<20, 11>,
+                          SignedField<4, 8>>(pattern);
+        CHECK(low == reg.low);
+        CHECK(nibble == reg.nibble);
+        CHECK(wide == reg.wide);
+        CHECK(signed_byte == reg.signed_byte);
+    }
+}
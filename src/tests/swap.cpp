@@ -0,0 +1,35 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <catch.hpp>
+
+#include "common/common_types.h"
+#include "common/swap.h"
+
+TEST_CASE("Bulk byte swap matches scalar swap", "[common]") {
+    // Odd lengths exercise both the vector body and the scalar tail of the bulk routines
+    static const size_t lengths[] = { 0, 1, 7, 8, 9, 64, 67 };
+
+    for (size_t length : lengths) {
+        std::vector<u16> data16(length);
+        std::vector<u32> data32(length);
+        std::vector<u16> expected16(length);
+        std::vector<u32> expected32(length);
+        for (size_t i = 0; i < length; ++i) {
+            const u32 pattern = static_cast<u32>(0x01020304u * (i + 1) + i);
+            data16[i] = static_cast<u16>(pattern);
+            data32[i] = pattern;
+            expected16[i] = Common::swap16(static_cast<u16>(pattern));
+            expected32[i] = Common::swap32(pattern);
+        }
+
+        Common::SwapBuffer16(data16.data(), length);
+        Common::SwapBuffer32(data32.data(), length);
+
+        CHECK(data16 == expected16);
+        CHECK(data32 == expected32);
+    }
+}
@@ -18,6 +18,7 @@
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
+#include "video_core/pipeline_stats.h"
 #include "video_core/rasterizer.h"
 #include "video_core/shader/shader.h"
 
@@ -90,16 +91,25 @@ static void InitScreenCoordinates(OutputVertex& vtx)
     vtx.screenpos[2] = vtx.pos.z * inv_w;
 }
 
-void ProcessTriangle(const OutputVertex &v0, const OutputVertex &v1, const OutputVertex &v2) {
+void ProcessTriangle(OutputVertex &v0, OutputVertex &v1, OutputVertex &v2) {
     using boost::container::static_vector;
 
+    VideoCore::PipelineCounters::triangles_submitted.fetch_add(1, std::memory_order_relaxed);
+
     // Clipping a planar n-gon against a plane will remove at least 1 vertex and introduces 2 at
     // the new edge (or less in degenerate cases). As such, we can say that each clipping plane
     // introduces at most 1 new vertex to the polygon. Since we start with a triangle and have a
     // fixed 6 clipping planes, the maximum number of vertices of the clipped polygon is 3 + 6 = 9.
     static const size_t MAX_VERTICES = 9;
-    static_vector<OutputVertex, MAX_VERTICES> buffer_a = { v0, v1, v2 };
-    static_vector<OutputVertex, MAX_VERTICES> buffer_b;
+
+    // An OutputVertex spans about two cache lines, so the clip loop ping-pongs pointers
+    // between the polygon buffers instead of vertex values. Only vertices created at plane
+    // intersections are materialized, into buffer_vertices: the intermediate polygons are
+    // convex, so each plane is crossed by at most two edges and the seven planes create at
+    // most 14 new vertices. The pool never reallocates, so the pointers stay valid.
+    alignas(64) static_vector<OutputVertex, 14> buffer_vertices;
+    static_vector<OutputVertex*, MAX_VERTICES> buffer_a = { &v0, &v1, &v2 };
+    static_vector<OutputVertex*, MAX_VERTICES> buffer_b;
     auto* output_list = &buffer_a;
     auto* input_list  = &buffer_b;
 
@@ -130,34 +140,42 @@ void ProcessTriangle(const OutputVertex &v0, const OutputVertex &v1, const Outpu
         std::swap(input_list, output_list);
         output_list->clear();
 
-        const OutputVertex* reference_vertex = &input_list->back();
+        const OutputVertex* reference_vertex = input_list->back();
 
-        for (const auto& vertex : *input_list) {
+        for (auto* vertex : *input_list) {
             // NOTE: This algorithm changes vertex order in some cases!
-            if (edge.IsInside(vertex)) {
+            if (edge.IsInside(*vertex)) {
                 if (edge.IsOutSide(*reference_vertex)) {
-                    output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
+                    buffer_vertices.push_back(edge.GetIntersection(*vertex, *reference_vertex));
+                    output_list->push_back(&buffer_vertices.back());
                 }
 
                 output_list->push_back(vertex);
             } else if (edge.IsInside(*reference_vertex)) {
-                output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
+                buffer_vertices.push_back(edge.GetIntersection(*vertex, *reference_vertex));
+                output_list->push_back(&buffer_vertices.back());
             }
-            reference_vertex = &vertex;
+            reference_vertex = vertex;
         }
 
         // Need to have at least a full triangle to continue...
-        if (output_list->size() < 3)
+        if (output_list->size() < 3) {
+            VideoCore::PipelineCounters::triangles_clipped.fetch_add(1, std::memory_order_relaxed);
             return;
+        }
     }
 
-    InitScreenCoordinates((*output_list)[0]);
-    InitScreenCoordinates((*output_list)[1]);
+    // Any vertex materialized at a plane intersection means the triangle was actually cut
+    if (!buffer_vertices.empty())
+        VideoCore::PipelineCounters::triangles_clipped.fetch_add(1, std::memory_order_relaxed);
+
+    InitScreenCoordinates(*(*output_list)[0]);
+    InitScreenCoordinates(*(*output_list)[1]);
 
     for (size_t i = 0; i < output_list->size() - 2; i ++) {
-        OutputVertex& vtx0 = (*output_list)[0];
-        OutputVertex& vtx1 = (*output_list)[i+1];
-        OutputVertex& vtx2 = (*output_list)[i+2];
+        OutputVertex& vtx0 = *(*output_list)[0];
+        OutputVertex& vtx1 = *(*output_list)[i+1];
+        OutputVertex& vtx2 = *(*output_list)[i+2];
 
         InitScreenCoordinates(vtx2);
 
@@ -14,7 +14,9 @@ namespace Clipper {
 
 using Shader::OutputVertex;
 
-void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2);
+// NOTE: The input vertices may be modified in place (screen coordinates are written back
+// into them), which is what lets the clipper hand them to the rasterizer without copying.
+void ProcessTriangle(OutputVertex& v0, OutputVertex& v1, OutputVertex& v2);
 
 } // namespace
 
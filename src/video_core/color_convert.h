@@ -0,0 +1,290 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstring>
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+#include "common/color.h"
+#include "common/common_types.h"
+#include "common/vector_math.h"
+
+#include "core/hw/gpu.h"
+
+namespace VideoCore {
+
+/**
+ * Rotates a row of raw D24S8 values from the 3DS component order (stencil in the low byte) to
+ * the OpenGL GL_UNSIGNED_INT_24_8 order. Operates in place so it can run over the linear side
+ * of a tile copy after the tiles have been moved in bulk.
+ */
+static inline void SwapD24S8RowToGL(u32* row, size_t count) {
+    size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    for (; i + 4 <= count; i += 4) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        values = _mm_or_si128(_mm_slli_epi32(values, 8), _mm_srli_epi32(values, 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), values);
+    }
+#endif
+    for (; i < count; ++i) {
+        row[i] = (row[i] << 8) | (row[i] >> 24);
+    }
+}
+
+/// Inverse of SwapD24S8RowToGL; rotates GL-ordered D24S8 values back to the 3DS order in place
+static inline void SwapD24S8RowFromGL(u32* row, size_t count) {
+    size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    for (; i + 4 <= count; i += 4) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        values = _mm_or_si128(_mm_srli_epi32(values, 8), _mm_slli_epi32(values, 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), values);
+    }
+#endif
+    for (; i < count; ++i) {
+        row[i] = (row[i] >> 8) | (row[i] << 24);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+/// Packs two vectors of four 16-bit values stored in 32-bit lanes into one vector of eight u16
+static inline __m128i PackU32ToU16(__m128i lo, __m128i hi) {
+    // There is no unsigned 32 -> 16 pack in SSE2, so bias into signed range around the
+    // saturating signed pack and flip the result back.
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    __m128i packed = _mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias));
+    return _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000)));
+}
+
+/// Converts four RGBA8 pixels (as u32 lanes) to RGB565 values in the low halves of the lanes
+static inline __m128i ConvertFourRGBA8ToRGB565(__m128i rgba) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(rgba, 16), _mm_set1_epi32(0xF800));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(rgba, 13), _mm_set1_epi32(0x07E0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(rgba, 11), _mm_set1_epi32(0x001F));
+    return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+/// Converts four RGBA8 pixels (as u32 lanes) to RGB5A1 values in the low halves of the lanes
+static inline __m128i ConvertFourRGBA8ToRGB5A1(__m128i rgba) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(rgba, 16), _mm_set1_epi32(0xF800));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(rgba, 13), _mm_set1_epi32(0x07C0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(rgba, 10), _mm_set1_epi32(0x003E));
+    __m128i a = _mm_and_si128(_mm_srli_epi32(rgba, 7), _mm_set1_epi32(0x0001));
+    return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+/// Converts four RGBA8 pixels (as u32 lanes) to RGBA4 values in the low halves of the lanes
+static inline __m128i ConvertFourRGBA8ToRGBA4(__m128i rgba) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(rgba, 16), _mm_set1_epi32(0xF000));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(rgba, 12), _mm_set1_epi32(0x0F00));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(rgba, 8), _mm_set1_epi32(0x00F0));
+    __m128i a = _mm_and_si128(_mm_srli_epi32(rgba, 4), _mm_set1_epi32(0x000F));
+    return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+/// Converts four RGB565 values (as u32 lanes) to RGBA8 pixels
+static inline __m128i ConvertFourRGB565ToRGBA8(__m128i pixels) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 11), _mm_set1_epi32(0x1F));
+    r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 5), _mm_set1_epi32(0x3F));
+    g = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+    __m128i b = _mm_and_si128(pixels, _mm_set1_epi32(0x1F));
+    b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 24), _mm_slli_epi32(g, 16)),
+                        _mm_or_si128(_mm_slli_epi32(b, 8), _mm_set1_epi32(0xFF)));
+}
+
+/// Converts four RGB5A1 values (as u32 lanes) to RGBA8 pixels
+static inline __m128i ConvertFourRGB5A1ToRGBA8(__m128i pixels) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 11), _mm_set1_epi32(0x1F));
+    r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 6), _mm_set1_epi32(0x1F));
+    g = _mm_or_si128(_mm_slli_epi32(g, 3), _mm_srli_epi32(g, 2));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 1), _mm_set1_epi32(0x1F));
+    b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+    // Expand the alpha bit to 0x00 or 0xFF via (a << 8) - a
+    __m128i a = _mm_and_si128(pixels, _mm_set1_epi32(0x1));
+    a = _mm_sub_epi32(_mm_slli_epi32(a, 8), a);
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 24), _mm_slli_epi32(g, 16)),
+                        _mm_or_si128(_mm_slli_epi32(b, 8), a));
+}
+
+/// Converts four RGBA4 values (as u32 lanes) to RGBA8 pixels
+static inline __m128i ConvertFourRGBA4ToRGBA8(__m128i pixels) {
+    // Replicating each nibble into both halves of a byte is exact 4 -> 8 conversion
+    __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 12), _mm_set1_epi32(0xF));
+    r = _mm_or_si128(_mm_slli_epi32(r, 4), r);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xF));
+    g = _mm_or_si128(_mm_slli_epi32(g, 4), g);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 4), _mm_set1_epi32(0xF));
+    b = _mm_or_si128(_mm_slli_epi32(b, 4), b);
+    __m128i a = _mm_and_si128(pixels, _mm_set1_epi32(0xF));
+    a = _mm_or_si128(_mm_slli_epi32(a, 4), a);
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 24), _mm_slli_epi32(g, 16)),
+                        _mm_or_si128(_mm_slli_epi32(b, 8), a));
+}
+
+/// Narrows a row of RGBA8 pixels to a 16-bit format, eight pixels per iteration
+template <__m128i (*convert_four)(__m128i)>
+static inline size_t NarrowRGBA8Row(const u8* src, u8* dst, size_t count) {
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4 + 16));
+        __m128i packed = PackU32ToU16(convert_four(lo), convert_four(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 2), packed);
+    }
+    return x;
+}
+
+/// Widens a row of 16-bit pixels to RGBA8, eight pixels per iteration
+template <__m128i (*convert_four)(__m128i)>
+static inline size_t WidenToRGBA8Row(const u8* src, u8* dst, size_t count) {
+    size_t x = 0;
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 8 <= count; x += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+        __m128i lo = convert_four(_mm_unpacklo_epi16(pixels, zero));
+        __m128i hi = convert_four(_mm_unpackhi_epi16(pixels, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4 + 16), hi);
+    }
+    return x;
+}
+
+#endif // ARCHITECTURE_x86_64
+
+/**
+ * Averages each horizontally adjacent pair of RGBA8 pixels in a row into one output pixel
+ * (the ScaleX anti-aliasing mode of display transfers). The arithmetic truncates like the
+ * per-pixel path: out = (a + b) / 2 per channel.
+ */
+static inline void AveragePairsRGBA8Row(const u8* src, u8* dst, size_t count) {
+    size_t x = 0;
+#ifdef ARCHITECTURE_x86_64
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 2 <= count; x += 2) {
+        // Four input pixels a b c d; regroup to (a c) and (b d) so one u16 add forms both sums
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 8));
+        pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i sum = _mm_add_epi16(_mm_unpacklo_epi8(pixels, zero),
+                                    _mm_unpackhi_epi8(pixels, zero));
+        __m128i avg = _mm_srli_epi16(sum, 1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(avg, avg));
+    }
+#endif
+    for (; x < count; ++x) {
+        for (size_t c = 0; c < 4; ++c) {
+            dst[x * 4 + c] = static_cast<u8>((src[x * 8 + c] + src[x * 8 + 4 + c]) / 2);
+        }
+    }
+}
+
+/**
+ * Averages 2x2 blocks of RGBA8 pixels from two adjacent rows into one output pixel (the
+ * ScaleXY anti-aliasing mode of display transfers), truncating: out = (sum of four) / 4.
+ */
+static inline void Average2x2RGBA8Rows(const u8* src0, const u8* src1, u8* dst, size_t count) {
+    size_t x = 0;
+#ifdef ARCHITECTURE_x86_64
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 2 <= count; x += 2) {
+        __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0 + x * 8));
+        __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + x * 8));
+        row0 = _mm_shuffle_epi32(row0, _MM_SHUFFLE(3, 1, 2, 0));
+        row1 = _mm_shuffle_epi32(row1, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i sum = _mm_add_epi16(
+            _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpackhi_epi8(row0, zero)),
+            _mm_add_epi16(_mm_unpacklo_epi8(row1, zero), _mm_unpackhi_epi8(row1, zero)));
+        __m128i avg = _mm_srli_epi16(sum, 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(avg, avg));
+    }
+#endif
+    for (; x < count; ++x) {
+        for (size_t c = 0; c < 4; ++c) {
+            dst[x * 4 + c] = static_cast<u8>(
+                ((src0[x * 8 + c] + src0[x * 8 + 4 + c]) +
+                 (src1[x * 8 + c] + src1[x * 8 + 4 + c])) / 4);
+        }
+    }
+}
+
+/**
+ * Converts a row of pixels between two of the five framebuffer color formats. The format
+ * dispatch happens once per row instead of once per pixel; conversions between RGBA8 and the
+ * 16-bit formats additionally take SSE2 fast paths on x86-64. RGBA8 here means the 3DS memory
+ * encoding (see common/color.h), not the GL channel order.
+ */
+static inline void ConvertColorRow(GPU::Regs::PixelFormat src_format, const u8* src,
+                                   GPU::Regs::PixelFormat dst_format, u8* dst, size_t count) {
+    using PixelFormat = GPU::Regs::PixelFormat;
+
+    if (src_format == dst_format) {
+        std::memcpy(dst, src, count * GPU::Regs::BytesPerPixel(src_format));
+        return;
+    }
+
+    size_t x = 0;
+#ifdef ARCHITECTURE_x86_64
+    if (src_format == PixelFormat::RGBA8) {
+        switch (dst_format) {
+        case PixelFormat::RGB565:
+            x = NarrowRGBA8Row<ConvertFourRGBA8ToRGB565>(src, dst, count);
+            break;
+        case PixelFormat::RGB5A1:
+            x = NarrowRGBA8Row<ConvertFourRGBA8ToRGB5A1>(src, dst, count);
+            break;
+        case PixelFormat::RGBA4:
+            x = NarrowRGBA8Row<ConvertFourRGBA8ToRGBA4>(src, dst, count);
+            break;
+        default:
+            break;
+        }
+    } else if (dst_format == PixelFormat::RGBA8) {
+        switch (src_format) {
+        case PixelFormat::RGB565:
+            x = WidenToRGBA8Row<ConvertFourRGB565ToRGBA8>(src, dst, count);
+            break;
+        case PixelFormat::RGB5A1:
+            x = WidenToRGBA8Row<ConvertFourRGB5A1ToRGBA8>(src, dst, count);
+            break;
+        case PixelFormat::RGBA4:
+            x = WidenToRGBA8Row<ConvertFourRGBA4ToRGBA8>(src, dst, count);
+            break;
+        default:
+            break;
+        }
+    }
+#endif
+
+    // Scalar tail of the vectorized pairs and generic path for the remaining ones, with the
+    // per-format decode/encode selected outside the pixel loop
+    typedef const Math::Vec4<u8> (*DecodeFunc)(const u8*);
+    typedef void (*EncodeFunc)(const Math::Vec4<u8>&, u8*);
+    static const DecodeFunc decode_table[5] = {
+        Color::DecodeRGBA8, Color::DecodeRGB8, Color::DecodeRGB565,
+        Color::DecodeRGB5A1, Color::DecodeRGBA4,
+    };
+    static const EncodeFunc encode_table[5] = {
+        Color::EncodeRGBA8, Color::EncodeRGB8, Color::EncodeRGB565,
+        Color::EncodeRGB5A1, Color::EncodeRGBA4,
+    };
+
+    const DecodeFunc decode = decode_table[static_cast<u32>(src_format)];
+    const EncodeFunc encode = encode_table[static_cast<u32>(dst_format)];
+    const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(src_format);
+    const u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(dst_format);
+
+    for (; x < count; ++x) {
+        encode(decode(src + x * src_bytes_per_pixel), dst + x * dst_bytes_per_pixel);
+    }
+}
+
+} // namespace VideoCore
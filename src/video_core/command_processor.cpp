@@ -2,12 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
@@ -20,6 +26,7 @@
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/pica.h"
+#include "video_core/pipeline_stats.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
 #include "video_core/primitive_assembly.h"
@@ -51,52 +58,51 @@ static const u32 expand_bits_to_bytes[] = {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
-static void WritePicaReg(u32 id, u32 value, u32 mask) {
-    auto& regs = g_state.regs;
-
-    if (id >= regs.NumIds())
-        return;
-
-    // If we're skipping this frame, only allow trigger IRQ
-    if (GPU::g_skip_frame && id != PICA_REG_INDEX(trigger_irq))
-        return;
-
-    // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
-    u32 old_value = regs[id];
+// Post-transform vertex cache: retains shaded vertices across draw calls. Entries are keyed on
+// a hash of the vertex's input attributes combined with a tag over all state feeding the shader
+// (program, swizzle data, uniforms), so stale results can't be returned when games stream new
+// vertex data or uniform values between draws. Direct-mapped; sized so strip-heavy meshes that
+// revisit shared vertices over several indexed draws keep their entries resident.
+static const size_t POST_TRANSFORM_CACHE_SIZE = 2048;
+
+struct PostTransformCacheEntry {
+    u64 key = 0;
+    bool valid = false;
+    Shader::OutputRegisters registers;
+};
 
-    const u32 write_mask = expand_bits_to_bytes[mask];
+static std::array<PostTransformCacheEntry, POST_TRANSFORM_CACHE_SIZE> post_transform_cache;
 
-    regs[id] = (old_value & ~write_mask) | (value & write_mask);
+// Cache hits and shader invocations feed the pipeline statistics counters directly;
+// the post-draw trace report below reads them back.
 
-    DebugUtils::OnPicaRegWrite({ (u16)id, (u16)mask, regs[id] });
+// Register write handlers, invoked through the dispatch table below once the register
+// file has been updated. `value` is the raw written word (before masking); the
+// FIFO-style upload registers consume it directly, matching the old switch behaviour.
 
-    if (g_debug_context)
-        g_debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded, reinterpret_cast<void*>(&id));
-
-    switch(id) {
-        // Trigger IRQ
-        case PICA_REG_INDEX(trigger_irq):
-            GSP_GPU::SignalInterrupt(GSP_GPU::InterruptId::P3D);
-            break;
+static void WriteTriggerIrq(u32 id, u32 value) {
+    GSP_GPU::SignalInterrupt(GSP_GPU::InterruptId::P3D);
+}
 
-        case PICA_REG_INDEX_WORKAROUND(triangle_topology, 0x25E):
-            g_state.primitive_assembler.Reconfigure(regs.triangle_topology);
-            break;
+static void WriteTriangleTopology(u32 id, u32 value) {
+    g_state.primitive_assembler.Reconfigure(g_state.regs.triangle_topology);
+    g_state.input_vertex_assembler.Reconfigure(g_state.regs.triangle_topology);
+}
 
-        case PICA_REG_INDEX_WORKAROUND(restart_primitive, 0x25F):
-            g_state.primitive_assembler.Reset();
-            break;
+static void WriteRestartPrimitive(u32 id, u32 value) {
+    g_state.primitive_assembler.Reset();
+    g_state.input_vertex_assembler.Reset();
+}
 
-        case PICA_REG_INDEX_WORKAROUND(vs_default_attributes_setup.index, 0x232):
-            g_state.immediate.current_attribute = 0;
-            default_attr_counter = 0;
-            break;
+static void WriteDefaultAttributesIndex(u32 id, u32 value) {
+    g_state.immediate.current_attribute = 0;
+    default_attr_counter = 0;
+}
 
-        // Load default vertex input attributes
-        case PICA_REG_INDEX_WORKAROUND(vs_default_attributes_setup.set_value[0], 0x233):
-        case PICA_REG_INDEX_WORKAROUND(vs_default_attributes_setup.set_value[1], 0x234):
-        case PICA_REG_INDEX_WORKAROUND(vs_default_attributes_setup.set_value[2], 0x235):
-        {
+// Load default vertex input attributes
+static void WriteDefaultAttributeWord(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    {
             // TODO: Does actual hardware indeed keep an intermediate buffer or does
             //       it directly write the values?
             default_attr_write_buffer[default_attr_counter++] = value;
@@ -111,16 +117,24 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
                 if (setup.index >= 16) {
                     LOG_ERROR(HW_GPU, "Invalid VS default attribute index %d", (int)setup.index);
-                    break;
+                    return;
                 }
 
                 Math::Vec4<float24> attribute;
 
                 // NOTE: The destination component order indeed is "backwards"
-                attribute.w = float24::FromRaw(default_attr_write_buffer[0] >> 8);
-                attribute.z = float24::FromRaw(((default_attr_write_buffer[0] & 0xFF) << 16) | ((default_attr_write_buffer[1] >> 16) & 0xFFFF));
-                attribute.y = float24::FromRaw(((default_attr_write_buffer[1] & 0xFFFF) << 8) | ((default_attr_write_buffer[2] >> 24) & 0xFF));
-                attribute.x = float24::FromRaw(default_attr_write_buffer[2] & 0xFFFFFF);
+                const u32 raw[4] = {
+                    default_attr_write_buffer[2] & 0xFFFFFF,
+                    ((default_attr_write_buffer[1] & 0xFFFF) << 8) | ((default_attr_write_buffer[2] >> 24) & 0xFF),
+                    ((default_attr_write_buffer[0] & 0xFF) << 16) | ((default_attr_write_buffer[1] >> 16) & 0xFFFF),
+                    default_attr_write_buffer[0] >> 8,
+                };
+                float24 converted[4];
+                Float24x4FromRaw(raw, converted);
+                attribute.x = converted[0];
+                attribute.y = converted[1];
+                attribute.z = converted[2];
+                attribute.w = converted[3];
 
                 LOG_TRACE(HW_GPU, "Set default VS attribute %x to (%f %f %f %f)", (int)setup.index,
                           attribute.x.ToFloat32(), attribute.y.ToFloat32(), attribute.z.ToFloat32(),
@@ -143,14 +157,41 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     if (immediate_attribute_id >= regs.vs.num_input_attributes+1) {
                         immediate_attribute_id = 0;
 
-                        Shader::UnitState<false> shader_unit;
-                        g_state.vs.Setup();
-
-                        // Send to vertex shader
-                        if (g_debug_context)
-                            g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation, static_cast<void*>(&immediate_input));
-                        g_state.vs.Run(shader_unit, immediate_input, regs.vs.num_input_attributes+1);
-                        Shader::OutputVertex output_vertex = shader_unit.output_registers.ToVertex(regs.vs);
+                        const int num_attributes = regs.vs.num_input_attributes + 1;
+
+                        // Immediate vertices go through the same post-transform cache as array
+                        // draws. Titles that redraw the same UI quads with immediate mode every
+                        // frame resubmit identical attribute values under unchanged shader
+                        // state, so the repeated case skips shader setup and execution entirely.
+                        u64 shading_tag =
+                            g_state.vs.GetProgramCodeHash() ^
+                            g_state.vs.GetSwizzleDataHash() ^
+                            g_state.vs.GetUniformsHash() ^
+                            (static_cast<u64>(regs.vs.main_offset) << 32) ^ static_cast<u64>(num_attributes);
+                        u64 key = shading_tag ^ Common::ComputeHash64(
+                            &immediate_input.attr[0], num_attributes * sizeof(immediate_input.attr[0]));
+
+                        Shader::OutputVertex output_vertex;
+                        PostTransformCacheEntry& entry = post_transform_cache[key & (POST_TRANSFORM_CACHE_SIZE - 1)];
+                        if (entry.valid && entry.key == key) {
+                            VideoCore::PipelineCounters::vertex_cache_hits.fetch_add(1, std::memory_order_relaxed);
+                            output_vertex = entry.registers.ToVertex(regs.vs);
+                        } else {
+                            VideoCore::PipelineCounters::vertices_shaded.fetch_add(1, std::memory_order_relaxed);
+
+                            Shader::UnitState<false> shader_unit;
+                            g_state.vs.Setup();
+
+                            // Send to vertex shader
+                            if (g_debug_context)
+                                g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation, static_cast<void*>(&immediate_input));
+                            g_state.vs.Run(shader_unit, immediate_input, num_attributes);
+
+                            entry.key = key;
+                            entry.valid = true;
+                            entry.registers = shader_unit.output_registers;
+                            output_vertex = shader_unit.output_registers.ToVertex(regs.vs);
+                        }
 
                         // Send to renderer
                         using Pica::Shader::OutputVertex;
@@ -162,34 +203,32 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     }
                 }
             }
-            break;
         }
+}
 
-        case PICA_REG_INDEX(gpu_mode):
-            if (regs.gpu_mode == Regs::GPUMode::Configuring) {
-                // Draw immediate mode triangles when GPU Mode is set to GPUMode::Configuring
-                VideoCore::g_renderer->Rasterizer()->DrawTriangles();
-
-                if (g_debug_context) {
-                    g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
-                }
-            }
-            break;
+static void WriteGPUMode(u32 id, u32 value) {
+    if (g_state.regs.gpu_mode == Regs::GPUMode::Configuring) {
+        // Draw immediate mode triangles when GPU Mode is set to GPUMode::Configuring
+        VideoCore::g_renderer->Rasterizer()->DrawTriangles();
 
-        case PICA_REG_INDEX_WORKAROUND(command_buffer.trigger[0], 0x23c):
-        case PICA_REG_INDEX_WORKAROUND(command_buffer.trigger[1], 0x23d):
-        {
-            unsigned index = static_cast<unsigned>(id - PICA_REG_INDEX(command_buffer.trigger[0]));
-            u32* head_ptr = (u32*)Memory::GetPhysicalPointer(regs.command_buffer.GetPhysicalAddress(index));
-            g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = head_ptr;
-            g_state.cmd_list.length = regs.command_buffer.GetSize(index) / sizeof(u32);
-            break;
+        if (g_debug_context) {
+            g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
         }
+    }
+}
 
-        // It seems like these trigger vertex rendering
-        case PICA_REG_INDEX(trigger_draw):
-        case PICA_REG_INDEX(trigger_draw_indexed):
-        {
+static void WriteCommandBufferTrigger(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    unsigned index = static_cast<unsigned>(id - PICA_REG_INDEX(command_buffer.trigger[0]));
+    u32* head_ptr = (u32*)Memory::GetPhysicalPointer(regs.command_buffer.GetPhysicalAddress(index));
+    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = head_ptr;
+    g_state.cmd_list.length = regs.command_buffer.GetSize(index) / sizeof(u32);
+}
+
+// It seems like these trigger vertex rendering
+static void WriteTriggerDraw(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    {
             MICROPROFILE_SCOPE(GPU_Drawing);
 
 #if PICA_LOG_TEV
@@ -227,112 +266,231 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
             DebugUtils::MemoryAccessTracker memory_accesses;
 
-            // Simple circular-replacement vertex cache
-            // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-            const size_t VERTEX_CACHE_SIZE = 32;
-            std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-            std::array<Shader::OutputRegisters, VERTEX_CACHE_SIZE> vertex_cache;
+            // Whether attribute and index reads are recorded for the debugger. In release-fast
+            // builds this is constant false, so the tracking hooks below compile to nothing.
+#ifdef RELEASE_FAST
+            const bool track_accesses = false;
+#else
+            const bool track_accesses = g_debug_context && Pica::g_debug_context->recorder != nullptr;
+#endif
 
-            unsigned int vertex_cache_pos = 0;
-            vertex_cache_ids.fill(-1);
+            if (VideoCore::g_renderer->Rasterizer()->AcceleratesVertexShader()) {
+                // The renderer shades these vertices on the GPU, so submit the raw input
+                // attributes instead of running the CPU shader engines. The batch is flushed
+                // before this command returns because register writes issued after the draw
+                // (e.g. new uniform values) must not affect the vertices submitted here.
+                using Pica::Shader::InputVertex;
+                auto AddRawTriangle = [](
+                        InputVertex& v0, InputVertex& v1, InputVertex& v2) {
+                    VideoCore::g_renderer->Rasterizer()->AddRawTriangle(v0, v1, v2);
+                };
 
-            Shader::UnitState<false> shader_unit;
-            g_state.vs.Setup();
+                const unsigned int LOAD_BATCH_SIZE = 16;
+                std::array<InputVertex, LOAD_BATCH_SIZE> loaded_vertices;
+                std::array<u32, LOAD_BATCH_SIZE> loaded_indices;
 
-            for (unsigned int index = 0; index < regs.num_vertices; ++index)
-            {
-                // Indexed rendering doesn't use the start offset
-                unsigned int vertex = is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index]) : (index + regs.vertex_offset);
+                for (unsigned int batch_start = 0; batch_start < regs.num_vertices; batch_start += LOAD_BATCH_SIZE)
+                {
+                    unsigned int batch_size = std::min(LOAD_BATCH_SIZE, regs.num_vertices - batch_start);
 
-                // -1 is a common special value used for primitive restart. Since it's unknown if
-                // the PICA supports it, and it would mess up the caching, guard against it here.
-                ASSERT(vertex != -1);
+                    for (unsigned int slot = 0; slot < batch_size; ++slot) {
+                        unsigned int index = batch_start + slot;
 
-                bool vertex_cache_hit = false;
-                Shader::OutputRegisters output_registers;
+                        // Indexed rendering doesn't use the start offset
+                        unsigned int vertex = is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index]) : (index + regs.vertex_offset);
 
-                if (is_indexed) {
-                    if (g_debug_context && Pica::g_debug_context->recorder) {
-                        int size = index_u16 ? 2 : 1;
-                        memory_accesses.AddAccess(base_address + index_info.offset + size * index, size);
-                    }
+                        // -1 is a common special value used for primitive restart. Since it's unknown if
+                        // the PICA supports it, guard against it here.
+                        ASSERT(vertex != -1);
 
-                    for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                        if (vertex == vertex_cache_ids[i]) {
-                            output_registers = vertex_cache[i];
-                            vertex_cache_hit = true;
-                            break;
+                        if (is_indexed && track_accesses) {
+                            int size = index_u16 ? 2 : 1;
+                            memory_accesses.AddAccess(base_address + index_info.offset + size * index, size);
                         }
+
+                        loaded_indices[slot] = vertex;
                     }
-                }
 
-                if (!vertex_cache_hit) {
-                    // Initialize data for the current vertex
-                    Shader::InputVertex input;
-                    loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
-
-                    // Send to vertex shader
-                    if (g_debug_context)
-                        g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation, (void*)&input);
-                    g_state.vs.Run(shader_unit, input, loader.GetNumTotalAttributes());
-                    output_registers = shader_unit.output_registers;
-
-                    if (is_indexed) {
-                        vertex_cache[vertex_cache_pos] = output_registers;
-                        vertex_cache_ids[vertex_cache_pos] = vertex;
-                        vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                    // Load the whole batch per attribute stream rather than per vertex
+                    if (track_accesses)
+                        loader.LoadVertices<true>(base_address, loaded_indices.data(), batch_size, loaded_vertices.data(), memory_accesses);
+                    else
+                        loader.LoadVertices<false>(base_address, loaded_indices.data(), batch_size, loaded_vertices.data(), memory_accesses);
+
+                    for (unsigned int slot = 0; slot < batch_size; ++slot) {
+                        g_state.input_vertex_assembler.SubmitVertex(loaded_vertices[slot], AddRawTriangle);
                     }
                 }
 
-                // Retreive vertex from register data
-                Shader::OutputVertex output_vertex = output_registers.ToVertex(regs.vs);
+                VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+            } else {
+                Shader::UnitState<false> shader_unit;
+                g_state.vs.Setup();
+
+                // Tag covering every piece of state that feeds vertex shading. Combined with the
+                // per-vertex hash of the loaded input attributes this forms a post-transform
+                // cache key that stays valid across draw calls.
+                const int num_attributes = loader.GetNumTotalAttributes();
+                u64 shading_tag =
+                    g_state.vs.GetProgramCodeHash() ^
+                    g_state.vs.GetSwizzleDataHash() ^
+                    g_state.vs.GetUniformsHash() ^
+                    (static_cast<u64>(regs.vs.main_offset) << 32) ^ static_cast<u64>(num_attributes);
 
-                // Send to renderer
                 using Pica::Shader::OutputVertex;
                 auto AddTriangle = [](
                         const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2) {
                     VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
                 };
 
-                primitive_assembler.SubmitVertex(output_vertex, AddTriangle);
+                // Vertices are shaded in batches so that the shader engine can amortize its
+                // per-invocation dispatch work. Each batch first resolves vertex cache hits, then
+                // shades the remaining misses in one `RunBatch` call before submitting the batch to
+                // the primitive assembler in draw order.
+                const unsigned int VERTEX_BATCH_SIZE = 16;
+                std::array<Shader::InputVertex, VERTEX_BATCH_SIZE> loaded_input;
+                std::array<u32, VERTEX_BATCH_SIZE> loaded_indices;
+                std::array<Shader::InputVertex, VERTEX_BATCH_SIZE> batch_input;
+                std::array<Shader::OutputRegisters, VERTEX_BATCH_SIZE> batch_output;
+                std::array<Shader::OutputRegisters, VERTEX_BATCH_SIZE> batch_registers;
+                // Per-slot index of the shader invocation producing the slot's registers, or -1 for
+                // vertex cache hits (whose registers are copied into `batch_registers` up front)
+                std::array<int, VERTEX_BATCH_SIZE> batch_source;
+                std::array<u64, VERTEX_BATCH_SIZE> batch_miss_keys;
+
+                for (unsigned int batch_start = 0; batch_start < regs.num_vertices; batch_start += VERTEX_BATCH_SIZE)
+                {
+                    unsigned int batch_size = std::min(VERTEX_BATCH_SIZE, regs.num_vertices - batch_start);
+                    unsigned int num_misses = 0;
+
+                    for (unsigned int slot = 0; slot < batch_size; ++slot) {
+                        unsigned int index = batch_start + slot;
+
+                        // Indexed rendering doesn't use the start offset
+                        unsigned int vertex = is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index]) : (index + regs.vertex_offset);
+
+                        // -1 is a common special value used for primitive restart. Since it's unknown if
+                        // the PICA supports it, and it would mess up the caching, guard against it here.
+                        ASSERT(vertex != -1);
+
+                        if (is_indexed && track_accesses) {
+                            int size = index_u16 ? 2 : 1;
+                            memory_accesses.AddAccess(base_address + index_info.offset + size * index, size);
+                        }
+
+                        loaded_indices[slot] = vertex;
+                    }
+
+                    // The input attributes must be loaded before the cache can be probed since
+                    // the key is derived from their values; loading the whole batch up front
+                    // lets the loader walk each attribute stream linearly
+                    if (track_accesses)
+                        loader.LoadVertices<true>(base_address, loaded_indices.data(), batch_size, loaded_input.data(), memory_accesses);
+                    else
+                        loader.LoadVertices<false>(base_address, loaded_indices.data(), batch_size, loaded_input.data(), memory_accesses);
+
+                    for (unsigned int slot = 0; slot < batch_size; ++slot) {
+                        batch_source[slot] = -1;
+
+                        u64 key = shading_tag ^ Common::ComputeHash64(
+                            &loaded_input[slot].attr[0], num_attributes * sizeof(loaded_input[slot].attr[0]));
+
+                        PostTransformCacheEntry& entry = post_transform_cache[key & (POST_TRANSFORM_CACHE_SIZE - 1)];
+                        if (entry.valid && entry.key == key) {
+                            batch_registers[slot] = entry.registers;
+                            VideoCore::PipelineCounters::vertex_cache_hits.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        // A repeated miss within this batch would shade the vertex twice; reuse
+                        // the pending invocation instead so the batch stays equivalent to the
+                        // old one-at-a-time loop (which would have hit the cache here).
+                        bool pending_hit = false;
+                        for (unsigned int i = 0; i < num_misses; ++i) {
+                            if (key == batch_miss_keys[i]) {
+                                batch_source[slot] = i;
+                                pending_hit = true;
+                                break;
+                            }
+                        }
+                        if (pending_hit) {
+                            VideoCore::PipelineCounters::vertex_cache_hits.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        batch_source[slot] = static_cast<int>(num_misses);
+                        batch_miss_keys[num_misses] = key;
+                        batch_input[num_misses] = loaded_input[slot];
+                        num_misses++;
+                        VideoCore::PipelineCounters::vertices_shaded.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    if (num_misses > 0) {
+                        // Send to vertex shader
+                        if (g_debug_context) {
+                            for (unsigned int i = 0; i < num_misses; ++i)
+                                g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation, (void*)&batch_input[i]);
+                        }
+                        g_state.vs.RunBatch(shader_unit, batch_input.data(), batch_output.data(),
+                                            num_misses, num_attributes);
+
+                        for (unsigned int i = 0; i < num_misses; ++i) {
+                            PostTransformCacheEntry& entry = post_transform_cache[batch_miss_keys[i] & (POST_TRANSFORM_CACHE_SIZE - 1)];
+                            entry.key = batch_miss_keys[i];
+                            entry.valid = true;
+                            entry.registers = batch_output[i];
+                        }
+                    }
+
+                    for (unsigned int slot = 0; slot < batch_size; ++slot) {
+                        if (batch_source[slot] >= 0)
+                            batch_registers[slot] = batch_output[batch_source[slot]];
+
+                        // Retreive vertex from register data
+                        Shader::OutputVertex output_vertex = batch_registers[slot].ToVertex(regs.vs);
+
+                        // Send to renderer
+                        primitive_assembler.SubmitVertex(output_vertex, AddTriangle);
+                    }
+                }
+
+                LOG_TRACE(HW_GPU, "Post-transform cache: %llu hits / %llu misses",
+                          static_cast<unsigned long long>(
+                              VideoCore::PipelineCounters::vertex_cache_hits.load(std::memory_order_relaxed)),
+                          static_cast<unsigned long long>(
+                              VideoCore::PipelineCounters::vertices_shaded.load(std::memory_order_relaxed)));
+
+                // Ends the batch; register writes issued after the draw must not observe
+                // triangles still in flight (the software rasterizer drains its clipper
+                // worker here)
+                VideoCore::g_renderer->Rasterizer()->DrawTriangles();
             }
 
             for (auto& range : memory_accesses.ranges) {
                 g_debug_context->recorder->MemoryAccessed(Memory::GetPhysicalPointer(range.first),
                                                           range.second, range.first);
             }
+    }
+}
 
-            break;
-        }
-
-        case PICA_REG_INDEX(vs.bool_uniforms):
-            for (unsigned i = 0; i < 16; ++i)
-                g_state.vs.uniforms.b[i] = (regs.vs.bool_uniforms.Value() & (1 << i)) != 0;
-
-            break;
+static void WriteBoolUniforms(u32 id, u32 value) {
+    for (unsigned i = 0; i < 16; ++i)
+        g_state.vs.uniforms.b[i] = (g_state.regs.vs.bool_uniforms.Value() & (1 << i)) != 0;
+    g_state.vs.MarkIntBoolUniformsDirty();
+}
 
-        case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1):
-        case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[1], 0x2b2):
-        case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[2], 0x2b3):
-        case PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[3], 0x2b4):
-        {
-            int index = (id - PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1));
-            auto values = regs.vs.int_uniforms[index];
-            g_state.vs.uniforms.i[index] = Math::Vec4<u8>(values.x, values.y, values.z, values.w);
-            LOG_TRACE(HW_GPU, "Set integer uniform %d to %02x %02x %02x %02x",
-                      index, values.x.Value(), values.y.Value(), values.z.Value(), values.w.Value());
-            break;
-        }
+static void WriteIntUniform(u32 id, u32 value) {
+    int index = (id - PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1));
+    auto values = g_state.regs.vs.int_uniforms[index];
+    g_state.vs.uniforms.i[index] = Math::Vec4<u8>(values.x, values.y, values.z, values.w);
+    g_state.vs.MarkIntBoolUniformsDirty();
+    LOG_TRACE(HW_GPU, "Set integer uniform %d to %02x %02x %02x %02x",
+              index, values.x.Value(), values.y.Value(), values.z.Value(), values.w.Value());
+}
 
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1):
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[1], 0x2c2):
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[2], 0x2c3):
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[3], 0x2c4):
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[4], 0x2c5):
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[5], 0x2c6):
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[6], 0x2c7):
-        case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[7], 0x2c8):
-        {
+static void WriteFloatUniformWord(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    {
             auto& uniform_setup = regs.vs.uniform_setup;
 
             // TODO: Does actual hardware indeed keep an intermediate buffer or does
@@ -350,7 +508,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
                 if (uniform_setup.index > 95) {
                     LOG_ERROR(HW_GPU, "Invalid VS uniform index %d", (int)uniform_setup.index);
-                    break;
+                    return;
                 }
 
                 // NOTE: The destination component order indeed is "backwards"
@@ -359,12 +517,22 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                         uniform[3 - i] = float24::FromFloat32(*(float*)(&uniform_write_buffer[i]));
                 } else {
                     // TODO: Untested
-                    uniform.w = float24::FromRaw(uniform_write_buffer[0] >> 8);
-                    uniform.z = float24::FromRaw(((uniform_write_buffer[0] & 0xFF) << 16) | ((uniform_write_buffer[1] >> 16) & 0xFFFF));
-                    uniform.y = float24::FromRaw(((uniform_write_buffer[1] & 0xFFFF) << 8) | ((uniform_write_buffer[2] >> 24) & 0xFF));
-                    uniform.x = float24::FromRaw(uniform_write_buffer[2] & 0xFFFFFF);
+                    const u32 raw[4] = {
+                        uniform_write_buffer[2] & 0xFFFFFF,
+                        ((uniform_write_buffer[1] & 0xFFFF) << 8) | ((uniform_write_buffer[2] >> 24) & 0xFF),
+                        ((uniform_write_buffer[0] & 0xFF) << 16) | ((uniform_write_buffer[1] >> 16) & 0xFFFF),
+                        uniform_write_buffer[0] >> 8,
+                    };
+                    float24 converted[4];
+                    Float24x4FromRaw(raw, converted);
+                    uniform.x = converted[0];
+                    uniform.y = converted[1];
+                    uniform.z = converted[2];
+                    uniform.w = converted[3];
                 }
 
+                g_state.vs.MarkFloatUniformDirty(uniform_setup.index);
+
                 LOG_TRACE(HW_GPU, "Set uniform %x to (%f %f %f %f)", (int)uniform_setup.index,
                           uniform.x.ToFloat32(), uniform.y.ToFloat32(), uniform.z.ToFloat32(),
                           uniform.w.ToFloat32());
@@ -372,74 +540,103 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                 // TODO: Verify that this actually modifies the register!
                 uniform_setup.index.Assign(uniform_setup.index + 1);
             }
-            break;
-        }
+    }
+}
 
-        // Load shader program code
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[0], 0x2cc):
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[1], 0x2cd):
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[2], 0x2ce):
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[3], 0x2cf):
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[4], 0x2d0):
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[5], 0x2d1):
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[6], 0x2d2):
-        case PICA_REG_INDEX_WORKAROUND(vs.program.set_word[7], 0x2d3):
-        {
-            g_state.vs.program_code[regs.vs.program.offset] = value;
-            regs.vs.program.offset++;
-            break;
-        }
+// Load shader program code
+static void WriteProgramCodeWord(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    g_state.vs.program_code[regs.vs.program.offset] = value;
+    g_state.vs.MarkProgramCodeDirty();
+    regs.vs.program.offset++;
+}
 
-        // Load swizzle pattern data
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[0], 0x2d6):
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[1], 0x2d7):
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[2], 0x2d8):
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[3], 0x2d9):
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[4], 0x2da):
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[5], 0x2db):
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[6], 0x2dc):
-        case PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[7], 0x2dd):
-        {
-            g_state.vs.swizzle_data[regs.vs.swizzle_patterns.offset] = value;
-            regs.vs.swizzle_patterns.offset++;
-            break;
-        }
+// Load swizzle pattern data
+static void WriteSwizzleDataWord(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    g_state.vs.swizzle_data[regs.vs.swizzle_patterns.offset] = value;
+    g_state.vs.MarkSwizzleDataDirty();
+    regs.vs.swizzle_patterns.offset++;
+}
 
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8):
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[1], 0x1c9):
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[2], 0x1ca):
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[3], 0x1cb):
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[4], 0x1cc):
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[5], 0x1cd):
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[6], 0x1ce):
-        case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[7], 0x1cf):
-        {
-            auto& lut_config = regs.lighting.lut_config;
-
-            ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
-
-            g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
-            lut_config.index.Assign(lut_config.index + 1);
-            break;
-        }
+static void WriteLightingLutWord(u32 id, u32 value) {
+    auto& lut_config = g_state.regs.lighting.lut_config;
 
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8):
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[1], 0xe9):
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[2], 0xea):
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[3], 0xeb):
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[4], 0xec):
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[5], 0xed):
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[6], 0xee):
-        case PICA_REG_INDEX_WORKAROUND(fog_lut_data[7], 0xef):
-        {
-            g_state.fog.lut[regs.fog_lut_offset % 128].raw = value;
-            regs.fog_lut_offset.Assign(regs.fog_lut_offset + 1);
-            break;
-        }
+    ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
 
-        default:
-            break;
-    }
+    g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
+    lut_config.index.Assign(lut_config.index + 1);
+}
+
+static void WriteFogLutWord(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+    g_state.fog.lut[regs.fog_lut_offset % 128].raw = value;
+    regs.fog_lut_offset.Assign(regs.fog_lut_offset + 1);
+}
+
+using RegWriteHandler = void (*)(u32 id, u32 value);
+
+// Dispatch table indexed by register id, replacing the old monolithic switch. The dense
+// upload ranges (float uniforms, program code, swizzle patterns, LUT data) get dedicated
+// handlers so streaming writes cost one indirect call each; registers without side
+// effects stay null.
+static std::array<RegWriteHandler, Regs::NumIds()> BuildRegWriteHandlerTable() {
+    std::array<RegWriteHandler, Regs::NumIds()> table{};
+
+    table[PICA_REG_INDEX(trigger_irq)] = WriteTriggerIrq;
+    table[PICA_REG_INDEX_WORKAROUND(triangle_topology, 0x25E)] = WriteTriangleTopology;
+    table[PICA_REG_INDEX_WORKAROUND(restart_primitive, 0x25F)] = WriteRestartPrimitive;
+    table[PICA_REG_INDEX_WORKAROUND(vs_default_attributes_setup.index, 0x232)] = WriteDefaultAttributesIndex;
+    for (u32 i = 0; i < 3; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(vs_default_attributes_setup.set_value[0], 0x233) + i] = WriteDefaultAttributeWord;
+    table[PICA_REG_INDEX(gpu_mode)] = WriteGPUMode;
+    for (u32 i = 0; i < 2; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(command_buffer.trigger[0], 0x23c) + i] = WriteCommandBufferTrigger;
+    table[PICA_REG_INDEX(trigger_draw)] = WriteTriggerDraw;
+    table[PICA_REG_INDEX(trigger_draw_indexed)] = WriteTriggerDraw;
+    table[PICA_REG_INDEX(vs.bool_uniforms)] = WriteBoolUniforms;
+    for (u32 i = 0; i < 4; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1) + i] = WriteIntUniform;
+    for (u32 i = 0; i < 8; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1) + i] = WriteFloatUniformWord;
+    for (u32 i = 0; i < 8; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(vs.program.set_word[0], 0x2cc) + i] = WriteProgramCodeWord;
+    for (u32 i = 0; i < 8; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[0], 0x2d6) + i] = WriteSwizzleDataWord;
+    for (u32 i = 0; i < 8; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8) + i] = WriteLightingLutWord;
+    for (u32 i = 0; i < 8; ++i)
+        table[PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8) + i] = WriteFogLutWord;
+
+    return table;
+}
+
+static const std::array<RegWriteHandler, Regs::NumIds()> reg_write_handlers = BuildRegWriteHandlerTable();
+
+static void WritePicaReg(u32 id, u32 value, u32 mask) {
+    auto& regs = g_state.regs;
+
+    if (id >= regs.NumIds())
+        return;
+
+    // If we're skipping this frame, only allow trigger IRQ
+    if (GPU::g_skip_frame && id != PICA_REG_INDEX(trigger_irq))
+        return;
+
+    // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
+    u32 old_value = regs[id];
+
+    const u32 write_mask = expand_bits_to_bytes[mask];
+
+    regs[id] = (old_value & ~write_mask) | (value & write_mask);
+
+    DebugUtils::OnPicaRegWrite({ (u16)id, (u16)mask, regs[id] });
+
+    if (g_debug_context)
+        g_debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded, reinterpret_cast<void*>(&id));
+
+    if (RegWriteHandler handler = reg_write_handlers[id])
+        handler(id, value);
 
     VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
 
@@ -447,10 +644,142 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed, reinterpret_cast<void*>(&id));
 }
 
+// Batched upload fast path: a command that streams N words into one of the shader upload
+// FIFOs is replayed as N direct handler calls instead of N full WritePicaReg dispatches
+// (register merge, debug hooks and rasterizer notification for every word).
+
+static bool IsUploadFifoReg(u32 id) {
+    return (id >= PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1) &&
+            id <= PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[7], 0x2c8)) ||
+           (id >= PICA_REG_INDEX_WORKAROUND(vs.program.set_word[0], 0x2cc) &&
+            id <= PICA_REG_INDEX_WORKAROUND(vs.program.set_word[7], 0x2d3)) ||
+           (id >= PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[0], 0x2d6) &&
+            id <= PICA_REG_INDEX_WORKAROUND(vs.swizzle_patterns.set_word[7], 0x2dd));
+}
+
+/// The full dispatch must be kept whenever frame skipping or a per-write debug hook is active
+static bool UploadFastPathUsable() {
+    return !GPU::g_skip_frame && g_debug_context == nullptr && !DebugUtils::IsPicaTracing();
+}
+
+/**
+ * Writes `count` words to the upload FIFO register `id` in one dispatch; `stride` is the
+ * byte distance between consecutive value words. Callers must have checked
+ * UploadFastPathUsable() and that the write mask selects the whole word.
+ */
+static void WriteUploadFifoBatch(u32 id, const u8* values, size_t stride, u32 count) {
+    const RegWriteHandler handler = reg_write_handlers[id];
+    u32 value = 0;
+    for (u32 i = 0; i < count; ++i) {
+        std::memcpy(&value, values + i * stride, sizeof(value));
+        handler(id, value);
+    }
+    // The FIFO register itself holds the last word written. Neither rasterizer reacts to
+    // these ids, so one notification per run keeps observers in sync.
+    g_state.regs[id] = value;
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+}
+
+// Cache of command lists decoded into flat register write sequences. Titles resubmit nearly
+// identical lists every frame; hashing the raw words and replaying the decoded form skips the
+// per-word header parsing and grouped-command expansion on every submission after the first.
+static const size_t MAX_CACHED_COMMAND_LISTS = 256;
+
+/// A single pre-decoded register write
+struct CommandListOp {
+    u16 id;
+    u8 mask;
+    u32 value;
+};
+
+struct CachedCommandList {
+    std::vector<CommandListOp> ops;
+    // Lists that rewire the command list mid-stream via command_buffer.trigger can't be
+    // replayed from the decoded form, since the jump target isn't known until execution
+    bool replayable;
+};
+
+static std::unordered_map<u64, CachedCommandList> command_list_cache;
+
+/// Decodes a raw command list into a flat op sequence; returns false if it can't be replayed
+static bool DecodeCommandList(const u32* list, u32 length, std::vector<CommandListOp>& ops) {
+    const u32* current_ptr = list;
+    bool replayable = true;
+
+    while (current_ptr < list + length) {
+
+        // Align read pointer to 8 bytes
+        if ((list - current_ptr) % 2 != 0)
+            ++current_ptr;
+
+        u32 value = *current_ptr++;
+        const u32 header = *current_ptr++;
+
+        // One register load feeds all four field extractions
+        u32 cmd_id, parameter_mask, extra_data_length, group_commands;
+        std::tie(cmd_id, parameter_mask, extra_data_length, group_commands) =
+            ExtractFields<UnsignedField<0, 16>, UnsignedField<16, 4>, UnsignedField<20, 11>,
+                          UnsignedField<31, 1>>(header);
+
+        ops.push_back({ (u16)cmd_id, (u8)parameter_mask, value });
+
+        for (unsigned i = 0; i < extra_data_length; ++i) {
+            u32 cmd = cmd_id + (group_commands ? i + 1 : 0);
+            ops.push_back({ (u16)cmd, (u8)parameter_mask, *current_ptr++ });
+        }
+    }
+
+    for (const auto& op : ops) {
+        if (op.id == PICA_REG_INDEX_WORKAROUND(command_buffer.trigger[0], 0x23c) ||
+            op.id == PICA_REG_INDEX_WORKAROUND(command_buffer.trigger[1], 0x23d)) {
+            replayable = false;
+            break;
+        }
+    }
+
+    return replayable;
+}
+
 void ProcessCommandList(const u32* list, u32 size) {
     g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
     g_state.cmd_list.length = size / sizeof(u32);
 
+    u64 hash = Common::ComputeHash64(list, size);
+
+    auto cached = command_list_cache.find(hash);
+    if (cached == command_list_cache.end()) {
+        if (command_list_cache.size() >= MAX_CACHED_COMMAND_LISTS)
+            command_list_cache.clear();
+
+        CachedCommandList decoded;
+        decoded.replayable = DecodeCommandList(list, g_state.cmd_list.length, decoded.ops);
+        if (!decoded.replayable)
+            decoded.ops.clear();
+
+        cached = command_list_cache.emplace(hash, std::move(decoded)).first;
+    }
+
+    if (cached->second.replayable) {
+        const auto& ops = cached->second.ops;
+        const bool fast_upload = UploadFastPathUsable();
+        for (size_t i = 0; i < ops.size();) {
+            const auto& op = ops[i];
+            size_t run_end = i + 1;
+            if (fast_upload && op.mask == 0xF && IsUploadFifoReg(op.id)) {
+                while (run_end < ops.size() && ops[run_end].id == op.id && ops[run_end].mask == 0xF)
+                    ++run_end;
+            }
+            if (run_end - i > 1) {
+                WriteUploadFifoBatch(op.id, reinterpret_cast<const u8*>(&op.value),
+                                     sizeof(CommandListOp), static_cast<u32>(run_end - i));
+            } else {
+                WritePicaReg(op.id, op.value, op.mask);
+            }
+            i = run_end;
+        }
+        return;
+    }
+
     while (g_state.cmd_list.current_ptr < g_state.cmd_list.head_ptr + g_state.cmd_list.length) {
 
         // Align read pointer to 8 bytes
@@ -462,6 +791,18 @@ void ProcessCommandList(const u32* list, u32 size) {
 
         WritePicaReg(header.cmd_id, value, header.parameter_mask);
 
+        // A non-grouped header streams its extra words into the same register; uploads to
+        // the shader FIFOs take the batched path
+        if (header.extra_data_length != 0 && !header.group_commands &&
+            header.parameter_mask == 0xF && IsUploadFifoReg(header.cmd_id) &&
+            UploadFastPathUsable()) {
+            WriteUploadFifoBatch(header.cmd_id,
+                                 reinterpret_cast<const u8*>(g_state.cmd_list.current_ptr),
+                                 sizeof(u32), header.extra_data_length);
+            g_state.cmd_list.current_ptr += header.extra_data_length;
+            continue;
+        }
+
         for (unsigned i = 0; i < header.extra_data_length; ++i) {
             u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
             WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
@@ -222,6 +222,36 @@ struct TextureInfo {
 const Math::Vec4<u8> LookupTexture(const u8* source, int s, int t, const TextureInfo& info,
                                    bool disable_alpha = false);
 
+/**
+ * Texel decoder with the format dispatch resolved up front: construction validates the
+ * TextureInfo once and collapses the per-format switch into a function pointer (with the
+ * texel byte count baked into the selected function), so Get() does no per-texel format
+ * branching. Use this instead of LookupTexture wherever many texels are read with the same
+ * setup — the software rasterizer's sampling loops, surface viewers and texture dumping.
+ */
+struct TextureDecoder {
+    using LookupFn = Math::Vec4<u8> (*)(const TextureDecoder&, int x, int y);
+
+    TextureDecoder() = default;
+    TextureDecoder(const u8* source, const TextureInfo& info, bool disable_alpha = false);
+
+    /// Whether construction resolved a known format and a non-null source
+    explicit operator bool() const {
+        return lookup_fn != nullptr;
+    }
+
+    Math::Vec4<u8> Get(int x, int y) const {
+        if (lookup_fn == nullptr)
+            return {};
+        return lookup_fn(*this, x, y);
+    }
+
+    const u8* source = nullptr;
+    TextureInfo info = {};
+    bool disable_alpha = false;
+    LookupFn lookup_fn = nullptr;
+};
+
 void DumpTexture(const Pica::Regs::TextureConfig& texture_config, u8* data);
 
 std::string GetTevStageConfigColorCombinerString(const Pica::Regs::TevStageConfig& tev_stage);
@@ -10,6 +10,7 @@
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/primitive_assembly.h"
+#include "video_core/rasterizer.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica {
@@ -497,9 +498,11 @@ std::string Regs::GetCommandName(int index) {
 
 void Init() {
     g_state.Reset();
+    Rasterizer::Init();
 }
 
 void Shutdown() {
+    Rasterizer::Shutdown();
     Shader::ClearCache();
 }
 
@@ -512,6 +515,8 @@ void State::Reset() {
     Zero(regs);
     Zero(vs);
     Zero(gs);
+    vs.MarkAllDirty();
+    gs.MarkAllDirty();
     Zero(cmd_list);
     Zero(immediate);
     primitive_assembler.Reconfigure(Regs::TriangleTopology::List);
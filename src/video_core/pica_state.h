@@ -75,6 +75,10 @@ struct State {
 
     // This is constructed with a dummy triangle topology
     PrimitiveAssembler<Shader::OutputVertex> primitive_assembler;
+
+    // Assembles raw input vertices into triangles when the renderer runs the vertex shader on
+    // the GPU; kept in lockstep with `primitive_assembler`
+    PrimitiveAssembler<Shader::InputVertex> input_vertex_assembler;
 };
 
 extern State g_state; ///< Current Pica state
@@ -7,6 +7,10 @@
 #include <cmath>
 #include <cstring>
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 #include "common/common_types.h"
 
 namespace Pica {
@@ -144,4 +148,32 @@ using float24 = Float<16, 7>;
 using float20 = Float<12, 7>;
 using float16 = Float<10, 5>;
 
+/**
+ * Converts four raw 24-bit PICA floats to float24 in one step; with SSE2 all four values are
+ * converted in parallel. The output matches float24::FromRaw applied per element.
+ */
+inline void Float24x4FromRaw(const u32 raw[4], float24 out[4]) {
+#ifdef ARCHITECTURE_x86_64
+    static_assert(sizeof(float24) == sizeof(u32), "float24 must be bit-castable for batch conversion");
+
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw));
+    __m128i sign = _mm_slli_epi32(_mm_srli_epi32(v, 23), 31);
+    __m128i mantissa = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xFFFF)), 7);
+    __m128i exponent = _mm_slli_epi32(
+        _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0x7F)), _mm_set1_epi32(64)), 23);
+
+    // Values with zero mantissa and exponent collapse to a signed zero, as in FromRaw
+    __m128i is_zero = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(0x7FFFFF)), _mm_setzero_si128());
+    __m128i bits = _mm_or_si128(
+        _mm_and_si128(is_zero, sign),
+        _mm_andnot_si128(is_zero, _mm_or_si128(sign, _mm_or_si128(mantissa, exponent))));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bits);
+#else
+    for (int i = 0; i < 4; ++i) {
+        out[i] = float24::FromRaw(raw[i]);
+    }
+#endif
+}
+
 } // namespace Pica
@@ -0,0 +1,56 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/pipeline_stats.h"
+
+namespace VideoCore {
+
+namespace PipelineCounters {
+std::atomic<u64> vertices_shaded{0};
+std::atomic<u64> vertex_cache_hits{0};
+std::atomic<u64> triangles_submitted{0};
+std::atomic<u64> triangles_clipped{0};
+std::atomic<u64> triangles_rasterized{0};
+std::atomic<u64> pixels_shaded{0};
+std::atomic<u64> pixels_early_rejected{0};
+std::array<std::atomic<u64>, NUM_TEXTURE_FORMATS> texture_samples{};
+} // namespace PipelineCounters
+
+/// Lifetime totals, folded in as the per-frame counters are polled
+static PipelineStats totals;
+
+PipelineStats GetAndResetPipelineStats() {
+    using namespace PipelineCounters;
+
+    PipelineStats out;
+    out.vertices_shaded = vertices_shaded.exchange(0, std::memory_order_relaxed);
+    out.vertex_cache_hits = vertex_cache_hits.exchange(0, std::memory_order_relaxed);
+    out.triangles_submitted = triangles_submitted.exchange(0, std::memory_order_relaxed);
+    out.triangles_clipped = triangles_clipped.exchange(0, std::memory_order_relaxed);
+    out.triangles_rasterized = triangles_rasterized.exchange(0, std::memory_order_relaxed);
+    out.pixels_shaded = pixels_shaded.exchange(0, std::memory_order_relaxed);
+    out.pixels_early_rejected = pixels_early_rejected.exchange(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < NUM_TEXTURE_FORMATS; ++i)
+        out.texture_samples[i] = texture_samples[i].exchange(0, std::memory_order_relaxed);
+
+    totals.vertices_shaded += out.vertices_shaded;
+    totals.vertex_cache_hits += out.vertex_cache_hits;
+    totals.triangles_submitted += out.triangles_submitted;
+    totals.triangles_clipped += out.triangles_clipped;
+    totals.triangles_rasterized += out.triangles_rasterized;
+    totals.pixels_shaded += out.pixels_shaded;
+    totals.pixels_early_rejected += out.pixels_early_rejected;
+    for (size_t i = 0; i < NUM_TEXTURE_FORMATS; ++i)
+        totals.texture_samples[i] += out.texture_samples[i];
+
+    return out;
+}
+
+PipelineStats GetPipelineStatsTotals() {
+    // Fold in whatever has accumulated since the last per-frame poll
+    GetAndResetPipelineStats();
+    return totals;
+}
+
+} // namespace VideoCore
@@ -0,0 +1,57 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "common/common_types.h"
+
+namespace VideoCore {
+
+/// Number of distinct Pica texture formats (values of Pica::Regs::TextureFormat)
+static const size_t NUM_TEXTURE_FORMATS = 14;
+
+/**
+ * Counters over the Pica pipeline stages, as accumulated since the last call to
+ * GetAndResetPipelineStats(). The vertex counters are fed by the command processor and
+ * apply to both renderers; the triangle and pixel counters are only fed by the software
+ * rasterizer and stay zero while the hardware renderer is active.
+ */
+struct PipelineStats {
+    u64 vertices_shaded = 0;       ///< Vertex shader invocations
+    u64 vertex_cache_hits = 0;     ///< Vertices served from the post-transform cache instead
+    u64 triangles_submitted = 0;   ///< Triangles handed to the clipper
+    u64 triangles_clipped = 0;     ///< Triangles cut by at least one clipping plane or rejected whole
+    u64 triangles_rasterized = 0;  ///< Triangles surviving culling and reaching the pixel loop
+    u64 pixels_shaded = 0;         ///< Covered pixels that ran the texture/combiner pipeline
+    u64 pixels_early_rejected = 0; ///< Covered pixels discarded by the early depth test
+    std::array<u64, NUM_TEXTURE_FORMATS> texture_samples{}; ///< Texel fetches, by texture format
+};
+
+/**
+ * The live counters behind PipelineStats. Atomic because the software rasterizer shades
+ * on worker threads; per-pixel code should tally into locals and flush per triangle
+ * rather than incrementing these in inner loops.
+ */
+namespace PipelineCounters {
+extern std::atomic<u64> vertices_shaded;
+extern std::atomic<u64> vertex_cache_hits;
+extern std::atomic<u64> triangles_submitted;
+extern std::atomic<u64> triangles_clipped;
+extern std::atomic<u64> triangles_rasterized;
+extern std::atomic<u64> pixels_shaded;
+extern std::atomic<u64> pixels_early_rejected;
+extern std::array<std::atomic<u64>, NUM_TEXTURE_FORMATS> texture_samples;
+} // namespace PipelineCounters
+
+/// Returns the counters accumulated since the last call and resets them
+PipelineStats GetAndResetPipelineStats();
+
+/// Totals since emulation start, unaffected by the per-frame reset above
+PipelineStats GetPipelineStatsTotals();
+
+} // namespace VideoCore
@@ -67,5 +67,7 @@ void PrimitiveAssembler<VertexType>::Reconfigure(Regs::TriangleTopology topology
 // explicitly instantiate use cases
 template
 struct PrimitiveAssembler<Shader::OutputVertex>;
+template
+struct PrimitiveAssembler<Shader::InputVertex>;
 
 } // namespace
@@ -4,7 +4,17 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -12,15 +22,19 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
+#include "common/memory_accounting.h"
 #include "common/microprofile.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 
 #include "core/memory.h"
+#include "core/settings.h"
 #include "core/hw/gpu.h"
 
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
+#include "video_core/pipeline_stats.h"
 #include "video_core/pica_types.h"
 #include "video_core/rasterizer.h"
 #include "video_core/utils.h"
@@ -30,9 +44,8 @@ namespace Pica {
 
 namespace Rasterizer {
 
-static void DrawPixel(int x, int y, const Math::Vec4<u8>& color) {
+static void DrawPixel(u8* color_buffer, int x, int y, const Math::Vec4<u8>& color) {
     const auto& framebuffer = g_state.regs.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
 
     // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
     // NOTE: The framebuffer height register contains the actual FB height minus one.
@@ -41,7 +54,7 @@ static void DrawPixel(int x, int y, const Math::Vec4<u8>& color) {
     const u32 coarse_y = y & ~7;
     u32 bytes_per_pixel = GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
     u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = Memory::GetPhysicalPointer(addr) + dst_offset;
+    u8* dst_pixel = color_buffer + dst_offset;
 
     switch (framebuffer.color_format) {
     case Regs::ColorFormat::RGBA8:
@@ -70,16 +83,15 @@ static void DrawPixel(int x, int y, const Math::Vec4<u8>& color) {
     }
 }
 
-static const Math::Vec4<u8> GetPixel(int x, int y) {
+static const Math::Vec4<u8> GetPixel(const u8* color_buffer, int x, int y) {
     const auto& framebuffer = g_state.regs.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
 
     y = framebuffer.height - y;
 
     const u32 coarse_y = y & ~7;
     u32 bytes_per_pixel = GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
     u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* src_pixel = Memory::GetPhysicalPointer(addr) + src_offset;
+    const u8* src_pixel = color_buffer + src_offset;
 
     switch (framebuffer.color_format) {
     case Regs::ColorFormat::RGBA8:
@@ -105,10 +117,8 @@ static const Math::Vec4<u8> GetPixel(int x, int y) {
     return {0, 0, 0, 0};
 }
 
-static u32 GetDepth(int x, int y) {
+static u32 GetDepth(const u8* depth_buffer, int x, int y) {
     const auto& framebuffer = g_state.regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -117,7 +127,7 @@ static u32 GetDepth(int x, int y) {
     u32 stride = framebuffer.width * bytes_per_pixel;
 
     u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
+    const u8* src_pixel = depth_buffer + src_offset;
 
     switch (framebuffer.depth_format) {
         case Regs::DepthFormat::D16:
@@ -133,10 +143,8 @@ static u32 GetDepth(int x, int y) {
     }
 }
 
-static u8 GetStencil(int x, int y) {
+static u8 GetStencil(const u8* depth_buffer, int x, int y) {
     const auto& framebuffer = g_state.regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -145,7 +153,7 @@ static u8 GetStencil(int x, int y) {
     u32 stride = framebuffer.width * bytes_per_pixel;
 
     u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
+    const u8* src_pixel = depth_buffer + src_offset;
 
     switch (framebuffer.depth_format) {
         case Regs::DepthFormat::D24S8:
@@ -157,10 +165,8 @@ static u8 GetStencil(int x, int y) {
     }
 }
 
-static void SetDepth(int x, int y, u32 value) {
+static void SetDepth(u8* depth_buffer, int x, int y, u32 value) {
     const auto& framebuffer = g_state.regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -191,10 +197,8 @@ static void SetDepth(int x, int y, u32 value) {
     }
 }
 
-static void SetStencil(int x, int y, u8 value) {
+static void SetStencil(u8* depth_buffer, int x, int y, u8 value) {
     const auto& framebuffer = g_state.regs.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
 
     y = framebuffer.height - y;
 
@@ -257,6 +261,35 @@ static u8 PerformStencilAction(Regs::StencilAction action, u8 old_stencil, u8 re
     }
 }
 
+static bool PassesDepthTest(Regs::CompareFunc func, u32 z, u32 ref_z) {
+    switch (func) {
+    case Regs::CompareFunc::Never:
+        return false;
+
+    case Regs::CompareFunc::Always:
+        return true;
+
+    case Regs::CompareFunc::Equal:
+        return z == ref_z;
+
+    case Regs::CompareFunc::NotEqual:
+        return z != ref_z;
+
+    case Regs::CompareFunc::LessThan:
+        return z < ref_z;
+
+    case Regs::CompareFunc::LessThanOrEqual:
+        return z <= ref_z;
+
+    case Regs::CompareFunc::GreaterThan:
+        return z > ref_z;
+
+    case Regs::CompareFunc::GreaterThanOrEqual:
+        return z >= ref_z;
+    }
+    return false;
+}
+
 // NOTE: Assuming that rasterizer coordinates are 12.4 fixed-point values
 struct Fix12P4 {
     Fix12P4() {}
@@ -292,6 +325,287 @@ static int SignedArea (const Math::Vec2<Fix12P4>& vtx1,
     return Math::Cross(vec1, vec2).z;
 };
 
+#ifdef ARCHITECTURE_x86_64
+
+// SSE2 kernels for the per-pixel combiner and blend arithmetic. The rasterizer shades
+// one pixel at a time, so these vectorize across the colour channels of that pixel:
+// the multiply/divide-by-255 chains below are executed for every covered pixel and per
+// channel in the scalar code. Configurations without a kernel keep the scalar path.
+
+/// Loads up to four u8 channels into the low 16-bit lanes of an SSE register.
+static inline __m128i LoadChannels(const u8* channels, size_t count) {
+    u32 raw = 0;
+    std::memcpy(&raw, channels, count);
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), _mm_setzero_si128());
+}
+
+/**
+ * Truncating division by 255 of four signed 32-bit lanes. Negative lanes are clamped
+ * to zero first; the scalar code clamps the quotient to [0, 255] afterwards, and every
+ * negative numerator truncates/clamps to zero either way, so results are identical.
+ */
+static inline __m128i DivideChannelsBy255(__m128i v) {
+    v = _mm_and_si128(v, _mm_cmpgt_epi32(v, _mm_setzero_si128()));
+    // x/255 == (x * 0x80808081) >> 39, exact for any u32 x (the usual reciprocal
+    // constant compilers emit for unsigned division by 255)
+    const __m128i magic = _mm_set1_epi32(static_cast<int>(0x80808081u));
+    const __m128i even = _mm_srli_epi64(_mm_mul_epu32(v, magic), 39);
+    const __m128i odd =
+        _mm_slli_epi64(_mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(v, 32), magic), 39), 32);
+    return _mm_or_si128(even, odd);
+}
+
+/// Saturates four 32-bit lanes into u8 channels and stores the low `count` of them.
+static inline void PackChannels(__m128i v32, u8* channels, size_t count) {
+    const __m128i v16 = _mm_packs_epi32(v32, v32);
+    const __m128i v8 = _mm_packus_epi16(v16, v16);
+    const u32 raw = static_cast<u32>(_mm_cvtsi128_si32(v8));
+    std::memcpy(channels, &raw, count);
+}
+
+/// Computes (a * b) / 255 per channel, the combiner Modulate/Lerp building block.
+static inline __m128i MultiplyChannels(__m128i a, __m128i b) {
+    // Products of u8 values fit in the 16-bit lanes exactly
+    return _mm_unpacklo_epi16(_mm_mullo_epi16(a, b), _mm_setzero_si128());
+}
+
+#endif // ARCHITECTURE_x86_64
+
+// Decoded-texture cache. Sampling used to run Morton address computation and the
+// per-format decode in DebugUtils::LookupTexture for every texel, re-decoding the same
+// texels millions of times per frame. Textures are instead decoded to linear RGBA once
+// and invalidated through the rasterizer cache hooks in core/memory.cpp when the guest
+// writes to their backing pages.
+struct CachedTexture {
+    DebugUtils::TextureInfo info;
+    u32 size_in_bytes;
+    std::vector<Math::Vec4<u8>> texels; ///< Decoded texels, indexed as [y * width + x]
+};
+
+static std::unordered_map<PAddr, CachedTexture> texture_cache;
+static std::mutex texture_cache_mutex;
+
+static bool RegionsOverlap(PAddr a, u32 a_size, PAddr b, u32 b_size) {
+    return a < b + b_size && b < a + a_size;
+}
+
+/**
+ * Whether the given physical region aliases the current colour or depth buffer.
+ * DrawPixel and SetDepth write through raw pointers rather than the page table, so
+ * render-target memory can never be cached in decoded form.
+ */
+static bool OverlapsCurrentFramebuffer(PAddr addr, u32 size) {
+    const auto& framebuffer = g_state.regs.framebuffer;
+    // NOTE: The framebuffer height register contains the actual FB height minus one.
+    const u32 num_pixels = framebuffer.width * (framebuffer.height + 1);
+    const u32 color_size = num_pixels *
+        Regs::BytesPerColorPixel(framebuffer.color_format);
+    const u32 depth_size = num_pixels *
+        Regs::BytesPerDepthPixel(framebuffer.depth_format);
+
+    return RegionsOverlap(addr, size, framebuffer.GetColorBufferPhysicalAddress(), color_size) ||
+           RegionsOverlap(addr, size, framebuffer.GetDepthBufferPhysicalAddress(), depth_size);
+}
+
+void InvalidateTextureCacheRegion(PAddr addr, u32 size) {
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    for (auto it = texture_cache.begin(); it != texture_cache.end();) {
+        const auto& entry = it->second;
+        if (RegionsOverlap(addr, size, entry.info.physical_address, entry.size_in_bytes)) {
+            Memory::RasterizerMarkRegionCached(entry.info.physical_address, entry.size_in_bytes, -1);
+            it = texture_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ClearTextureCache() {
+    InvalidateTextureCacheRegion(0, 0xFFFFFFFF);
+}
+
+static u64 TextureCacheUsage() {
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    u64 total = 0;
+    for (const auto& pair : texture_cache)
+        total += pair.second.texels.size() * sizeof(Math::Vec4<u8>);
+    return total;
+}
+
+static void ShrinkTextureCache(u64 target_bytes) {
+    // No recency information is kept, so eviction order is arbitrary; an evicted
+    // texture is simply re-decoded the next time it is sampled
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    u64 total = 0;
+    for (const auto& pair : texture_cache)
+        total += pair.second.texels.size() * sizeof(Math::Vec4<u8>);
+    for (auto it = texture_cache.begin(); it != texture_cache.end() && total > target_bytes;) {
+        const auto& entry = it->second;
+        total -= entry.texels.size() * sizeof(Math::Vec4<u8>);
+        Memory::RasterizerMarkRegionCached(entry.info.physical_address, entry.size_in_bytes, -1);
+        it = texture_cache.erase(it);
+    }
+}
+
+// Fog LUT pre-expanded to interpolation-ready floats, rebuilt lazily on the first triangle
+// after the LUT registers change. Per-pixel fog then costs two table reads and a lerp
+// instead of unpacking the 1.1.11/0.0.11 fixed-point entries every fragment.
+static std::array<float, 128> fog_lut_value;
+static std::array<float, 128> fog_lut_difference;
+static std::atomic<bool> fog_lut_cache_valid(false);
+
+void InvalidateFogLutCache() {
+    fog_lut_cache_valid.store(false, std::memory_order_relaxed);
+}
+
+static void RebuildFogLutCache() {
+    for (size_t i = 0; i < g_state.fog.lut.size(); ++i) {
+        fog_lut_value[i] = g_state.fog.lut[i].value / 2047.0f;
+        fog_lut_difference[i] = g_state.fog.lut[i].difference / 2047.0f;
+    }
+    fog_lut_cache_valid.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * Returns the decoded form of the texture described by `info`, decoding it first if
+ * this is the first time it is sampled, or nullptr if it cannot be cached (it aliases
+ * the current framebuffer). The returned entry stays valid at least until the next
+ * call to ProcessTriangle.
+ */
+static const CachedTexture* GetCachedTexture(const u8* source, const DebugUtils::TextureInfo& info) {
+    const u32 size_in_bytes = static_cast<u32>(info.stride * info.height);
+    if (source == nullptr || info.width <= 0 || info.height <= 0 ||
+        OverlapsCurrentFramebuffer(info.physical_address, size_in_bytes))
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    auto it = texture_cache.find(info.physical_address);
+    if (it != texture_cache.end()) {
+        const auto& entry = it->second;
+        if (entry.info.width == info.width && entry.info.height == info.height &&
+            entry.info.format == info.format)
+            return &entry;
+
+        // Same address sampled with a different configuration: re-decode
+        Memory::RasterizerMarkRegionCached(entry.info.physical_address, entry.size_in_bytes, -1);
+        texture_cache.erase(it);
+    }
+
+    CachedTexture entry;
+    entry.info = info;
+    entry.size_in_bytes = size_in_bytes;
+    entry.texels.resize(info.width * info.height);
+    const DebugUtils::TextureDecoder decoder(source, info);
+    for (int y = 0; y < info.height; ++y) {
+        for (int x = 0; x < info.width; ++x)
+            entry.texels[y * info.width + x] = decoder.Get(x, y);
+    }
+
+    Memory::RasterizerMarkRegionCached(info.physical_address, size_in_bytes, 1);
+    auto& slot = texture_cache[info.physical_address];
+    slot = std::move(entry);
+    return &slot;
+}
+
+/**
+ * Per-unit texture sampler with every per-texel decision resolved when it is set up: the
+ * wrap modes, the border-color clamp and the cached-vs-fallback source select one fully
+ * specialized sampling function (the same approach TextureDecoder takes for the texel
+ * format), so Sample() runs branch-free per texel.
+ */
+struct TextureSampler {
+    using SampleFn = Math::Vec4<u8> (*)(const TextureSampler&, int s, int t);
+
+    const CachedTexture* cached = nullptr;
+    DebugUtils::TextureDecoder fallback;
+    int width = 0;
+    int height = 0;
+    Math::Vec4<u8> border = {};
+    SampleFn sample_fn = nullptr;
+
+    Math::Vec4<u8> Sample(int s, int t) const {
+        return sample_fn(*this, s, t);
+    }
+};
+
+template <Regs::TextureConfig::WrapMode mode>
+static int WrapTexCoord(int val, int size) {
+    switch (mode) { // mode is a template constant; the switch vanishes at compile time
+    case Regs::TextureConfig::ClampToEdge:
+        return std::min(std::max(val, 0), size - 1);
+
+    case Regs::TextureConfig::ClampToBorder:
+        return val;
+
+    case Regs::TextureConfig::Repeat:
+        return (int)((unsigned)val % size);
+
+    case Regs::TextureConfig::MirroredRepeat:
+    {
+        unsigned int coord = ((unsigned)val % (2 * size));
+        if (coord >= (unsigned)size)
+            coord = 2 * size - 1 - coord;
+        return (int)coord;
+    }
+    }
+    return 0;
+}
+
+template <Regs::TextureConfig::WrapMode wrap_s, Regs::TextureConfig::WrapMode wrap_t, bool cached>
+static Math::Vec4<u8> SampleTextureSpec(const TextureSampler& sampler, int s, int t) {
+    if ((wrap_s == Regs::TextureConfig::ClampToBorder && (s < 0 || s >= sampler.width)) ||
+        (wrap_t == Regs::TextureConfig::ClampToBorder && (t < 0 || t >= sampler.height)))
+        return sampler.border;
+
+    s = WrapTexCoord<wrap_s>(s, sampler.width);
+    // Textures are laid out from bottom to top, hence we invert the t coordinate.
+    // NOTE: This may not be the right place for the inversion.
+    // TODO: Check if this applies to ETC textures, too.
+    t = sampler.height - 1 - WrapTexCoord<wrap_t>(t, sampler.height);
+
+    if (cached)
+        return sampler.cached->texels[t * sampler.width + s];
+    return sampler.fallback.Get(s, t);
+}
+
+template <Regs::TextureConfig::WrapMode wrap_s, Regs::TextureConfig::WrapMode wrap_t>
+static TextureSampler::SampleFn SelectSampleFnSource(bool cached) {
+    return cached ? SampleTextureSpec<wrap_s, wrap_t, true>
+                  : SampleTextureSpec<wrap_s, wrap_t, false>;
+}
+
+template <Regs::TextureConfig::WrapMode wrap_s>
+static TextureSampler::SampleFn SelectSampleFnWrapT(Regs::TextureConfig::WrapMode wrap_t,
+                                                    bool cached) {
+    switch (wrap_t) {
+    case Regs::TextureConfig::ClampToBorder:
+        return SelectSampleFnSource<wrap_s, Regs::TextureConfig::ClampToBorder>(cached);
+    case Regs::TextureConfig::Repeat:
+        return SelectSampleFnSource<wrap_s, Regs::TextureConfig::Repeat>(cached);
+    case Regs::TextureConfig::MirroredRepeat:
+        return SelectSampleFnSource<wrap_s, Regs::TextureConfig::MirroredRepeat>(cached);
+    case Regs::TextureConfig::ClampToEdge:
+    default:
+        return SelectSampleFnSource<wrap_s, Regs::TextureConfig::ClampToEdge>(cached);
+    }
+}
+
+/// Picks the sampling specialization for a (wrap_s, wrap_t, source) combination
+static TextureSampler::SampleFn SelectSampleFn(Regs::TextureConfig::WrapMode wrap_s,
+                                               Regs::TextureConfig::WrapMode wrap_t, bool cached) {
+    switch (wrap_s) {
+    case Regs::TextureConfig::ClampToBorder:
+        return SelectSampleFnWrapT<Regs::TextureConfig::ClampToBorder>(wrap_t, cached);
+    case Regs::TextureConfig::Repeat:
+        return SelectSampleFnWrapT<Regs::TextureConfig::Repeat>(wrap_t, cached);
+    case Regs::TextureConfig::MirroredRepeat:
+        return SelectSampleFnWrapT<Regs::TextureConfig::MirroredRepeat>(wrap_t, cached);
+    case Regs::TextureConfig::ClampToEdge:
+    default:
+        return SelectSampleFnWrapT<Regs::TextureConfig::ClampToEdge>(wrap_t, cached);
+    }
+}
+
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
 /**
@@ -301,7 +615,9 @@ MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 24
 static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                                     const Shader::OutputVertex& v1,
                                     const Shader::OutputVertex& v2,
-                                    bool reversed = false)
+                                    bool reversed = false,
+                                    unsigned row_offset = 0,
+                                    unsigned row_stride = 1)
 {
     const auto& regs = g_state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
@@ -323,13 +639,13 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
     if (regs.cull_mode == Regs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, true, row_offset, row_stride);
             return;
         }
     } else {
         if (!reversed && regs.cull_mode == Regs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, true, row_offset, row_stride);
             return;
         }
 
@@ -338,7 +654,6 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
             return;
     }
 
-    // TODO: Proper scissor rect test!
     u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
     u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
     u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
@@ -349,6 +664,25 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
 
+    // This register set exposes no scissor rect, so the tightest rejection rect available is
+    // the framebuffer extent; clamp against it so degenerate post-clip coordinates can't walk
+    // rows that lie entirely outside the render target.
+    max_x = std::min<u16>(max_x, static_cast<u16>(regs.framebuffer.GetWidth() << 4));
+    max_y = std::min<u16>(max_y, static_cast<u16>(regs.framebuffer.GetHeight() << 4));
+    if (min_x >= max_x || min_y >= max_y)
+        return;
+
+    // When shading in parallel every thread runs this function for the same triangle,
+    // so only the emu thread (row_offset 0) counts it
+    if (row_offset == 0)
+        VideoCore::PipelineCounters::triangles_rasterized.fetch_add(1, std::memory_order_relaxed);
+
+    // Pixel-frequency statistics are tallied into locals and flushed once per triangle,
+    // keeping atomic traffic out of the inner loop
+    u64 stat_pixels_shaded = 0;
+    u64 stat_pixels_early_rejected = 0;
+    u64 stat_texture_samples[3] = {};
+
     // Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
     // drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
     // values which are added to the barycentric coordinates w0, w1 and w2, respectively.
@@ -375,22 +709,127 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
     auto textures = regs.GetTextures();
     auto tev_stages = regs.GetTevStages();
 
+    // Set up the active texture units once per triangle rather than per pixel: look up
+    // (and decode on first use) each texture and select the sampling specialization for
+    // its wrap modes and source, leaving no per-texel dispatch in the sampling path.
+    TextureSampler texture_samplers[3];
+    for (int i = 0; i < 3; ++i) {
+        if (!textures[i].enabled)
+            continue;
+        const auto info = DebugUtils::TextureInfo::FromPicaRegister(textures[i].config, textures[i].format);
+        const u8* texture_data = Memory::GetPhysicalPointer(textures[i].config.GetPhysicalAddress());
+
+        TextureSampler& sampler = texture_samplers[i];
+        sampler.cached = GetCachedTexture(texture_data, info);
+        if (sampler.cached == nullptr) {
+            sampler.fallback = DebugUtils::TextureDecoder(texture_data, info);
+#if PICA_DUMP_TEXTURES
+            DebugUtils::DumpTexture(textures[i].config, texture_data);
+#endif
+        }
+        sampler.width = textures[i].config.width;
+        sampler.height = textures[i].config.height;
+        const auto border_color = textures[i].config.border_color;
+        sampler.border = {border_color.r, border_color.g, border_color.b, border_color.a};
+        sampler.sample_fn = SelectSampleFn(textures[i].config.wrap_s, textures[i].config.wrap_t,
+                                           sampler.cached != nullptr);
+    }
+
     bool stencil_action_enable = g_state.regs.output_merger.stencil_test.enable && g_state.regs.framebuffer.depth_format == Regs::DepthFormat::D24S8;
     const auto stencil_test = g_state.regs.output_merger.stencil_test;
 
+    // With stencil disabled, a depth-rejected pixel leaves the framebuffer untouched no
+    // matter what the rest of the pipeline would have computed, so the depth test can run
+    // before texturing and the combiner stack. With stencil enabled the test has to stay
+    // late, since a depth fail still applies the depth-fail stencil action.
+    const bool early_depth_test = !stencil_action_enable &&
+                                  g_state.regs.output_merger.depth_test_enable;
+
+    // One physical-region classification per triangle instead of per pixel access: the
+    // color and depth buffers are resolved to host pointers here and handed to the pixel
+    // accessors. A triangle against an unmapped color buffer is dropped up front; every
+    // pixel write would fault the same way.
+    const PAddr color_addr = regs.framebuffer.GetColorBufferPhysicalAddress();
+    u8* const color_buffer = Memory::GetPhysicalRegion(color_addr).GetPointer(color_addr);
+    const PAddr depth_addr = regs.framebuffer.GetDepthBufferPhysicalAddress();
+    u8* const depth_buffer = Memory::GetPhysicalRegion(depth_addr).GetPointer(depth_addr);
+    if (color_buffer == nullptr)
+        return;
+
+    // The edge functions are linear in x; stepping one pixel (0x10 subpixels) along a
+    // scanline changes SignedArea(a, b, p) by (a.y - b.y) * 0x10. This drives both the
+    // incremental per-pixel evaluation and the span classification below.
+    const int w_dx[3] = {
+        ((int)vtxpos[1].y - (int)vtxpos[2].y) * 0x10,
+        ((int)vtxpos[2].y - (int)vtxpos[0].y) * 0x10,
+        ((int)vtxpos[0].y - (int)vtxpos[1].y) * 0x10,
+    };
+
+    // Pixels per hierarchical coverage span; spans rather than square blocks because
+    // scanlines are interleaved across shading threads
+    static const int SPAN_PIXELS = 8;
+
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
+    // When shading in parallel, each thread only visits its own interleaved subset of
+    // scanlines (row_offset, row_offset + row_stride, ...), so row ownership is disjoint
+    // and no pixel-level synchronization is needed.
     // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
+    for (u16 y = min_y + 8 + static_cast<u16>(row_offset * 0x10); y < max_y;
+         y += static_cast<u16>(row_stride * 0x10)) {
+
+        // Running edge function values at the current pixel of this scanline
+        int w_row[3] = {
+            bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {(u16)(min_x + 8), y}),
+            bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {(u16)(min_x + 8), y}),
+            bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {(u16)(min_x + 8), y}),
+        };
+
+        // Hierarchical coverage: classify SPAN_PIXELS-wide spans of the scanline against
+        // the three edge functions before testing individual pixels. The functions are
+        // linear along the row, so evaluating a span's two end samples is exact: a span
+        // with any edge negative at both ends lies fully outside and is skipped whole,
+        // while a span with all edges non-negative at both ends is fully covered and
+        // takes a no-test fast path. Thin diagonal triangles spend most of their
+        // bounding box in fully-outside spans.
+        int span_remaining = 0;
+        bool span_inside = false;
+
         for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+            if (span_remaining == 0) {
+                int span_len = std::min<int>(SPAN_PIXELS, (max_x - x + 0xf) >> 4);
+
+                bool span_outside = false;
+                span_inside = true;
+                for (int i = 0; i < 3; ++i) {
+                    int w_first = w_row[i];
+                    int w_last = w_row[i] + w_dx[i] * (span_len - 1);
+                    span_outside |= (w_first < 0 && w_last < 0);
+                    span_inside &= (w_first >= 0 && w_last >= 0);
+                }
 
-            // Calculate the barycentric coordinates w0, w1 and w2
-            int w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-            int w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-            int w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
+                if (span_outside) {
+                    // Skip the whole span; the surrounding loop adds the final pixel step
+                    for (int i = 0; i < 3; ++i)
+                        w_row[i] += w_dx[i] * span_len;
+                    x += static_cast<u16>((span_len - 1) * 0x10);
+                    continue;
+                }
+
+                span_remaining = span_len;
+            }
+            span_remaining--;
+
+            // Current barycentric coordinates w0, w1 and w2
+            int w0 = w_row[0];
+            int w1 = w_row[1];
+            int w2 = w_row[2];
+            w_row[0] += w_dx[0];
+            w_row[1] += w_dx[1];
+            w_row[2] += w_dx[2];
             int wsum = w0 + w1 + w2;
 
             // If current pixel is not covered by the current primitive
-            if (w0 < 0 || w1 < 0 || w2 < 0)
+            if (!span_inside && (w0 < 0 || w1 < 0 || w2 < 0))
                 continue;
 
             auto baricentric_coordinates = Math::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
@@ -418,6 +857,19 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
             // Clamp the result
             depth = MathUtil::Clamp(depth, 0.0f, 1.0f);
 
+            // Convert float to integer
+            unsigned num_bits = Regs::DepthBitsPerPixel(regs.framebuffer.depth_format);
+            u32 z = (u32)(depth * ((1 << num_bits) - 1));
+
+            // Early-Z: reject on depth before any texture fetch or combiner math
+            if (early_depth_test &&
+                !PassesDepthTest(regs.output_merger.depth_test_func, z, GetDepth(depth_buffer, x >> 4, y >> 4))) {
+                stat_pixels_early_rejected++;
+                continue;
+            }
+
+            stat_pixels_shaded++;
+
             // Perspective correct attribute interpolation:
             // Attribute values cannot be calculated by simple linear interpolation since
             // they are not linear in screen space. For example, when interpolating a
@@ -439,20 +891,68 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                 return interpolated_attr_over_w * interpolated_w_inverse;
             };
 
-            Math::Vec4<u8> primary_color{
+            Math::Vec4<u8> primary_color;
+            Math::Vec2<float24> uv[3];
+
+#ifdef ARCHITECTURE_x86_64
+            // float24 stores a plain IEEE float, so the vec4/vec2 attributes can be loaded
+            // directly and interpolated across all components in one SSE op each, with the
+            // hoisted 1/w applied once per attribute vector. The clipper clamps w to at
+            // least EPSILON, so the attribute-over-w values are finite and the PICA
+            // 0 * inf multiply quirk cannot trigger on this path.
+            static_assert(sizeof(float24) == sizeof(float),
+                          "float24 must alias float for vector interpolation");
+            const __m128 bary0 = _mm_set1_ps(static_cast<float>(w0));
+            const __m128 bary1 = _mm_set1_ps(static_cast<float>(w1));
+            const __m128 bary2 = _mm_set1_ps(static_cast<float>(w2));
+            const __m128 inv_w = _mm_set1_ps(interpolated_w_inverse.ToFloat32());
+
+            const auto InterpolateAttributes = [&](const void* a0, const void* a1, const void* a2) {
+                __m128 sum = _mm_mul_ps(_mm_loadu_ps(static_cast<const float*>(a0)), bary0);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(static_cast<const float*>(a1)), bary1));
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(static_cast<const float*>(a2)), bary2));
+                return _mm_mul_ps(sum, inv_w);
+            };
+
+            // Scale to [0, 255] and keep the low byte of the truncated result, matching the
+            // scalar (u8) casts
+            __m128i color_i = _mm_cvttps_epi32(_mm_mul_ps(
+                InterpolateAttributes(&v0.color, &v1.color, &v2.color), _mm_set1_ps(255.f)));
+            color_i = _mm_and_si128(color_i, _mm_set1_epi32(0xFF));
+            const u32 color_raw = static_cast<u32>(_mm_cvtsi128_si32(
+                _mm_packus_epi16(_mm_packs_epi32(color_i, color_i), _mm_setzero_si128())));
+            std::memcpy(&primary_color, &color_raw, sizeof(color_raw));
+
+            // tc0 and tc1 are adjacent in OutputVertex and interpolate as one vector; the
+            // tc2 load's upper two lanes read (and discard) struct padding
+            static_assert(offsetof(Shader::OutputVertex, tc1) ==
+                          offsetof(Shader::OutputVertex, tc0) + 2 * sizeof(float24),
+                          "tc0 and tc1 must be adjacent for vector interpolation");
+            alignas(16) float tc01[4];
+            alignas(16) float tc2[4];
+            _mm_store_ps(tc01, InterpolateAttributes(&v0.tc0, &v1.tc0, &v2.tc0));
+            _mm_store_ps(tc2, InterpolateAttributes(&v0.tc2, &v1.tc2, &v2.tc2));
+            uv[0].u() = float24::FromFloat32(tc01[0]);
+            uv[0].v() = float24::FromFloat32(tc01[1]);
+            uv[1].u() = float24::FromFloat32(tc01[2]);
+            uv[1].v() = float24::FromFloat32(tc01[3]);
+            uv[2].u() = float24::FromFloat32(tc2[0]);
+            uv[2].v() = float24::FromFloat32(tc2[1]);
+#else
+            primary_color = {
                 (u8)(GetInterpolatedAttribute(v0.color.r(), v1.color.r(), v2.color.r()).ToFloat32() * 255),
                 (u8)(GetInterpolatedAttribute(v0.color.g(), v1.color.g(), v2.color.g()).ToFloat32() * 255),
                 (u8)(GetInterpolatedAttribute(v0.color.b(), v1.color.b(), v2.color.b()).ToFloat32() * 255),
                 (u8)(GetInterpolatedAttribute(v0.color.a(), v1.color.a(), v2.color.a()).ToFloat32() * 255)
             };
 
-            Math::Vec2<float24> uv[3];
             uv[0].u() = GetInterpolatedAttribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
             uv[0].v() = GetInterpolatedAttribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
             uv[1].u() = GetInterpolatedAttribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
             uv[1].v() = GetInterpolatedAttribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
             uv[2].u() = GetInterpolatedAttribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
             uv[2].v() = GetInterpolatedAttribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+#endif
 
             Math::Vec4<u8> texture_color[3]{};
             for (int i = 0; i < 3; ++i) {
@@ -489,54 +989,9 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                 int t = (int)(v * float24::FromFloat32(static_cast<float>(texture.config.height))).ToFloat32();
 
 
-                static auto GetWrappedTexCoord = [](Regs::TextureConfig::WrapMode mode, int val, unsigned size) {
-                    switch (mode) {
-                        case Regs::TextureConfig::ClampToEdge:
-                            val = std::max(val, 0);
-                            val = std::min(val, (int)size - 1);
-                            return val;
-
-                        case Regs::TextureConfig::ClampToBorder:
-                            return val;
-
-                        case Regs::TextureConfig::Repeat:
-                            return (int)((unsigned)val % size);
-
-                        case Regs::TextureConfig::MirroredRepeat:
-                        {
-                            unsigned int coord = ((unsigned)val % (2 * size));
-                            if (coord >= size)
-                                coord = 2 * size - 1 - coord;
-                            return (int)coord;
-                        }
-
-                        default:
-                            LOG_ERROR(HW_GPU, "Unknown texture coordinate wrapping mode %x", (int)mode);
-                            UNIMPLEMENTED();
-                            return 0;
-                    }
-                };
-
-                if ((texture.config.wrap_s == Regs::TextureConfig::ClampToBorder && (s < 0 || s >= texture.config.width))
-                    || (texture.config.wrap_t == Regs::TextureConfig::ClampToBorder && (t < 0 || t >= texture.config.height))) {
-                    auto border_color = texture.config.border_color;
-                    texture_color[i] = { border_color.r, border_color.g, border_color.b, border_color.a };
-                } else {
-                    // Textures are laid out from bottom to top, hence we invert the t coordinate.
-                    // NOTE: This may not be the right place for the inversion.
-                    // TODO: Check if this applies to ETC textures, too.
-                    s = GetWrappedTexCoord(texture.config.wrap_s, s, texture.config.width);
-                    t = texture.config.height - 1 - GetWrappedTexCoord(texture.config.wrap_t, t, texture.config.height);
-
-                    u8* texture_data = Memory::GetPhysicalPointer(texture.config.GetPhysicalAddress());
-                    auto info = DebugUtils::TextureInfo::FromPicaRegister(texture.config, texture.format);
-
-                    // TODO: Apply the min and mag filters to the texture
-                    texture_color[i] = DebugUtils::LookupTexture(texture_data, s, t, info);
-#if PICA_DUMP_TEXTURES
-                    DebugUtils::DumpTexture(texture.config, texture_data);
-#endif
-                }
+                // TODO: Apply the min and mag filters to the texture
+                stat_texture_samples[i]++;
+                texture_color[i] = texture_samplers[i].Sample(s, t);
             }
 
             // Texture environment - consists of 6 stages of color and alpha combining.
@@ -665,7 +1120,18 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                         return input[0];
 
                     case Operation::Modulate:
+                    {
+#ifdef ARCHITECTURE_x86_64
+                        const __m128i product =
+                            MultiplyChannels(LoadChannels(reinterpret_cast<const u8*>(&input[0]), 3),
+                                             LoadChannels(reinterpret_cast<const u8*>(&input[1]), 3));
+                        Math::Vec3<u8> result;
+                        PackChannels(DivideChannelsBy255(product), reinterpret_cast<u8*>(&result), 3);
+                        return result;
+#else
                         return ((input[0] * input[1]) / 255).Cast<u8>();
+#endif
+                    }
 
                     case Operation::Add:
                     {
@@ -687,7 +1153,20 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                     }
 
                     case Operation::Lerp:
+                    {
+#ifdef ARCHITECTURE_x86_64
+                        const __m128i factor = LoadChannels(reinterpret_cast<const u8*>(&input[2]), 3);
+                        const __m128i inverse_factor = _mm_sub_epi16(_mm_set1_epi16(255), factor);
+                        const __m128i numerator = _mm_add_epi32(
+                            MultiplyChannels(LoadChannels(reinterpret_cast<const u8*>(&input[0]), 3), factor),
+                            MultiplyChannels(LoadChannels(reinterpret_cast<const u8*>(&input[1]), 3), inverse_factor));
+                        Math::Vec3<u8> result;
+                        PackChannels(DivideChannelsBy255(numerator), reinterpret_cast<u8*>(&result), 3);
+                        return result;
+#else
                         return ((input[0] * input[2] + input[1] * (Math::MakeVec<u8>(255, 255, 255) - input[2]).Cast<u8>()) / 255).Cast<u8>();
+#endif
+                    }
 
                     case Operation::Subtract:
                     {
@@ -875,8 +1354,8 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                 // Generate clamped fog factor from LUT for given fog index
                 float fog_i = MathUtil::Clamp(floorf(fog_index), 0.0f, 127.0f);
                 float fog_f = fog_index - fog_i;
-                const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
-                float fog_factor = (fog_lut_entry.value + fog_lut_entry.difference * fog_f) / 2047.0f; // This is signed fixed point 1.11
+                const unsigned int fog_lut_index = static_cast<unsigned int>(fog_i);
+                float fog_factor = fog_lut_value[fog_lut_index] + fog_lut_difference[fog_lut_index] * fog_f;
                 fog_factor = MathUtil::Clamp(fog_factor, 0.0f, 1.0f);
 
                 // Blend the fog
@@ -887,14 +1366,15 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
 
             u8 old_stencil = 0;
 
-            auto UpdateStencil = [stencil_test, x, y, &old_stencil](Pica::Regs::StencilAction action) {
+            auto UpdateStencil = [stencil_test, x, y, &old_stencil,
+                                  depth_buffer](Pica::Regs::StencilAction action) {
                 u8 new_stencil = PerformStencilAction(action, old_stencil, stencil_test.reference_value);
                 if (g_state.regs.framebuffer.allow_depth_stencil_write != 0)
-                    SetStencil(x >> 4, y >> 4, (new_stencil & stencil_test.write_mask) | (old_stencil & ~stencil_test.write_mask));
+                    SetStencil(depth_buffer, x >> 4, y >> 4, (new_stencil & stencil_test.write_mask) | (old_stencil & ~stencil_test.write_mask));
             };
 
             if (stencil_action_enable) {
-                old_stencil = GetStencil(x >> 4, y >> 4);
+                old_stencil = GetStencil(depth_buffer, x >> 4, y >> 4);
                 u8 dest = old_stencil & stencil_test.input_mask;
                 u8 ref = stencil_test.reference_value & stencil_test.input_mask;
 
@@ -939,50 +1419,9 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                 }
             }
 
-            // Convert float to integer
-            unsigned num_bits = Regs::DepthBitsPerPixel(regs.framebuffer.depth_format);
-            u32 z = (u32)(depth * ((1 << num_bits) - 1));
-
-            if (output_merger.depth_test_enable) {
-                u32 ref_z = GetDepth(x >> 4, y >> 4);
-
-                bool pass = false;
-
-                switch (output_merger.depth_test_func) {
-                case Regs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case Regs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case Regs::CompareFunc::Equal:
-                    pass = z == ref_z;
-                    break;
-
-                case Regs::CompareFunc::NotEqual:
-                    pass = z != ref_z;
-                    break;
-
-                case Regs::CompareFunc::LessThan:
-                    pass = z < ref_z;
-                    break;
-
-                case Regs::CompareFunc::LessThanOrEqual:
-                    pass = z <= ref_z;
-                    break;
-
-                case Regs::CompareFunc::GreaterThan:
-                    pass = z > ref_z;
-                    break;
-
-                case Regs::CompareFunc::GreaterThanOrEqual:
-                    pass = z >= ref_z;
-                    break;
-                }
-
-                if (!pass) {
+            // The early-Z path above already performed the depth test for this pixel
+            if (output_merger.depth_test_enable && !early_depth_test) {
+                if (!PassesDepthTest(output_merger.depth_test_func, z, GetDepth(depth_buffer, x >> 4, y >> 4))) {
                     if (stencil_action_enable)
                         UpdateStencil(stencil_test.action_depth_fail);
                     continue;
@@ -990,13 +1429,13 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
             }
 
             if (regs.framebuffer.allow_depth_stencil_write != 0 && output_merger.depth_write_enable)
-                SetDepth(x >> 4, y >> 4, z);
+                SetDepth(depth_buffer, x >> 4, y >> 4, z);
 
             // The stencil depth_pass action is executed even if depth testing is disabled
             if (stencil_action_enable)
                 UpdateStencil(stencil_test.action_depth_pass);
 
-            auto dest = GetPixel(x >> 4, y >> 4);
+            auto dest = GetPixel(color_buffer, x >> 4, y >> 4);
             Math::Vec4<u8> blend_output = combiner_output;
 
             if (output_merger.alphablend_enable) {
@@ -1075,6 +1514,31 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
                                                        Regs::BlendEquation equation) {
                     Math::Vec4<int> result;
 
+#ifdef ARCHITECTURE_x86_64
+                    if (equation == Regs::BlendEquation::Add ||
+                        equation == Regs::BlendEquation::Subtract ||
+                        equation == Regs::BlendEquation::ReverseSubtract) {
+                        const __m128i src_product =
+                            MultiplyChannels(LoadChannels(reinterpret_cast<const u8*>(&src), 4),
+                                             LoadChannels(reinterpret_cast<const u8*>(&srcfactor), 4));
+                        const __m128i dst_product =
+                            MultiplyChannels(LoadChannels(reinterpret_cast<const u8*>(&dest), 4),
+                                             LoadChannels(reinterpret_cast<const u8*>(&destfactor), 4));
+
+                        __m128i numerator;
+                        if (equation == Regs::BlendEquation::Add)
+                            numerator = _mm_add_epi32(src_product, dst_product);
+                        else if (equation == Regs::BlendEquation::Subtract)
+                            numerator = _mm_sub_epi32(src_product, dst_product);
+                        else
+                            numerator = _mm_sub_epi32(dst_product, src_product);
+
+                        Math::Vec4<u8> blended;
+                        PackChannels(DivideChannelsBy255(numerator), reinterpret_cast<u8*>(&blended), 4);
+                        return blended;
+                    }
+#endif
+
                     auto src_result = (src  *  srcfactor).Cast<int>();
                     auto dst_result = (dest * destfactor).Cast<int>();
 
@@ -1199,7 +1663,63 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
             };
 
             if (regs.framebuffer.allow_color_write != 0)
-                DrawPixel(x >> 4, y >> 4, result);
+                DrawPixel(color_buffer, x >> 4, y >> 4, result);
+        }
+    }
+
+    using namespace VideoCore::PipelineCounters;
+    pixels_shaded.fetch_add(stat_pixels_shaded, std::memory_order_relaxed);
+    pixels_early_rejected.fetch_add(stat_pixels_early_rejected, std::memory_order_relaxed);
+    for (int i = 0; i < 3; ++i) {
+        const size_t format = static_cast<size_t>(textures[i].format);
+        if (stat_texture_samples[i] != 0 && format < VideoCore::NUM_TEXTURE_FORMATS)
+            texture_samples[format].fetch_add(stat_texture_samples[i], std::memory_order_relaxed);
+    }
+}
+
+// Parallel triangle shading, run on the shared worker pool. Every sufficiently large
+// triangle is shaded in num_shading_threads slices at once: slice i (the emu thread
+// taking slice 0) walks scanlines i, i + N, i + 2N, ... of the bounding box, so the
+// per-triangle setup is redone per slice but all framebuffer rows are owned by exactly
+// one of them. Pica register state only changes between triangles, which makes the
+// per-triangle fork/join correct without capturing anything beyond the vertex pointers.
+static unsigned num_shading_threads = 1; ///< Total slices shading, including the emu thread
+
+/// Triangles with a smaller bounding box are shaded in place; the pool round-trip
+/// costs more than shading a few dozen pixels.
+static const int MIN_PARALLEL_PIXELS = 32 * 32;
+
+static int texture_cache_accounting_handle = -1;
+
+void Init() {
+    texture_cache_accounting_handle = Common::MemoryAccounting::Register(
+        "sw_texture_cache", TextureCacheUsage, ShrinkTextureCache);
+
+    int threads = Settings::values.sw_rasterizer_threads;
+    if (threads <= 1)
+        return;
+
+    num_shading_threads = static_cast<unsigned>(threads);
+}
+
+void Shutdown() {
+    num_shading_threads = 1;
+
+    Common::MemoryAccounting::Unregister(texture_cache_accounting_handle);
+    ClearTextureCache();
+}
+
+/// Drops decoded textures that alias the current framebuffer, so that memory written
+/// through DrawPixel/SetDepth is re-decoded when it is later sampled as a texture.
+static void InvalidateFramebufferOverlaps() {
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    for (auto it = texture_cache.begin(); it != texture_cache.end();) {
+        const auto& entry = it->second;
+        if (OverlapsCurrentFramebuffer(entry.info.physical_address, entry.size_in_bytes)) {
+            Memory::RasterizerMarkRegionCached(entry.info.physical_address, entry.size_in_bytes, -1);
+            it = texture_cache.erase(it);
+        } else {
+            ++it;
         }
     }
 }
@@ -1207,6 +1727,42 @@ static void ProcessTriangleInternal(const Shader::OutputVertex& v0,
 void ProcessTriangle(const Shader::OutputVertex& v0,
                      const Shader::OutputVertex& v1,
                      const Shader::OutputVertex& v2) {
+    InvalidateFramebufferOverlaps();
+
+    // The expanded LUT is rebuilt here, before any worker can touch it, so the workers
+    // only ever see a fully built table
+    if (g_state.regs.fog_mode == Regs::FogMode::Fog &&
+        !fog_lut_cache_valid.load(std::memory_order_relaxed)) {
+        RebuildFogLutCache();
+    }
+
+    if (num_shading_threads > 1) {
+        const float min_x = std::min({v0.screenpos.x.ToFloat32(), v1.screenpos.x.ToFloat32(),
+                                      v2.screenpos.x.ToFloat32()});
+        const float max_x = std::max({v0.screenpos.x.ToFloat32(), v1.screenpos.x.ToFloat32(),
+                                      v2.screenpos.x.ToFloat32()});
+        const float min_y = std::min({v0.screenpos.y.ToFloat32(), v1.screenpos.y.ToFloat32(),
+                                      v2.screenpos.y.ToFloat32()});
+        const float max_y = std::max({v0.screenpos.y.ToFloat32(), v1.screenpos.y.ToFloat32(),
+                                      v2.screenpos.y.ToFloat32()});
+
+        if ((max_x - min_x) * (max_y - min_y) >= MIN_PARALLEL_PIXELS) {
+            // Latency class: the emu thread blocks on these slices, so they must overtake
+            // whatever throughput work is queued on the pool
+            Common::ThreadPool::WaitGroup wait_group;
+            for (unsigned i = 1; i < num_shading_threads; ++i) {
+                wait_group.Submit(
+                    [&v0, &v1, &v2, i] {
+                        ProcessTriangleInternal(v0, v1, v2, false, i, num_shading_threads);
+                    },
+                    Common::ThreadPool::TaskPriority::Latency);
+            }
+            ProcessTriangleInternal(v0, v1, v2, false, 0, num_shading_threads);
+            wait_group.Wait();
+            return;
+        }
+    }
+
     ProcessTriangleInternal(v0, v1, v2);
 }
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "common/common_types.h"
+
 namespace Pica {
 
 namespace Shader {
@@ -12,6 +14,21 @@ namespace Shader {
 
 namespace Rasterizer {
 
+/// Spawns the parallel shading worker pool if enabled in the settings.
+void Init();
+
+/// Joins the worker pool and drops all decoded textures.
+void Shutdown();
+
+/// Invalidates any decoded textures overlapping the given physical region.
+void InvalidateTextureCacheRegion(PAddr addr, u32 size);
+
+/// Drops every decoded texture.
+void ClearTextureCache();
+
+/// Invalidates the pre-expanded fog LUT; called when the fog LUT registers are rewritten.
+void InvalidateFogLutCache();
+
 void ProcessTriangle(const Shader::OutputVertex& v0,
                      const Shader::OutputVertex& v1,
                      const Shader::OutputVertex& v2);
@@ -12,6 +12,7 @@ struct ScreenInfo;
 
 namespace Pica {
 namespace Shader {
+struct InputVertex;
 struct OutputVertex;
 }
 }
@@ -30,6 +31,18 @@ public:
     /// Draw the current batch of triangles
     virtual void DrawTriangles() = 0;
 
+    /**
+     * Returns true if the renderer will run the current Pica vertex shader on the GPU, in which
+     * case triangles must be submitted as raw input attributes through AddRawTriangle instead
+     * of being shaded on the CPU and passed to AddTriangle.
+     */
+    virtual bool AcceleratesVertexShader() { return false; }
+
+    /// Queues a triangle of raw (untransformed) vertex attributes for GPU-side shading
+    virtual void AddRawTriangle(const Pica::Shader::InputVertex& v0,
+                                const Pica::Shader::InputVertex& v1,
+                                const Pica::Shader::InputVertex& v2) {}
+
     /// Notify rasterizer that the specified PICA register has been changed
     virtual void NotifyPicaRegisterChanged(u32 id) = 0;
 
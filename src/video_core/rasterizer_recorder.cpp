@@ -0,0 +1,153 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_recorder.h"
+
+namespace VideoCore {
+
+void RecordingRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
+                                      const Pica::Shader::OutputVertex& v1,
+                                      const Pica::Shader::OutputVertex& v2) {
+    commands.push_back({CommandType::AddTriangle});
+    vertices.push_back(v0);
+    vertices.push_back(v1);
+    vertices.push_back(v2);
+
+    inner->AddTriangle(v0, v1, v2);
+}
+
+void RecordingRasterizer::DrawTriangles() {
+    commands.push_back({CommandType::DrawTriangles});
+
+    inner->DrawTriangles();
+}
+
+bool RecordingRasterizer::AcceleratesVertexShader() {
+    // Not recorded: this is a query, and the replay target makes its own choice (recordings
+    // taken with GPU-side shading replay AddRawTriangle commands instead of AddTriangle ones)
+    return inner->AcceleratesVertexShader();
+}
+
+void RecordingRasterizer::AddRawTriangle(const Pica::Shader::InputVertex& v0,
+                                         const Pica::Shader::InputVertex& v1,
+                                         const Pica::Shader::InputVertex& v2) {
+    commands.push_back({CommandType::AddRawTriangle});
+    raw_vertices.push_back(v0);
+    raw_vertices.push_back(v1);
+    raw_vertices.push_back(v2);
+
+    inner->AddRawTriangle(v0, v1, v2);
+}
+
+void RecordingRasterizer::NotifyPicaRegisterChanged(u32 id) {
+    Command command;
+    command.type = CommandType::RegisterChanged;
+    command.register_changed.id = id;
+    command.register_changed.value = Pica::g_state.regs[static_cast<int>(id)];
+    commands.push_back(command);
+
+    inner->NotifyPicaRegisterChanged(id);
+}
+
+void RecordingRasterizer::FlushAll() {
+    commands.push_back({CommandType::FlushAll});
+
+    inner->FlushAll();
+}
+
+void RecordingRasterizer::FlushRegion(PAddr addr, u32 size) {
+    Command command;
+    command.type = CommandType::FlushRegion;
+    command.region.addr = addr;
+    command.region.size = size;
+    commands.push_back(command);
+
+    inner->FlushRegion(addr, size);
+}
+
+void RecordingRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    Command command;
+    command.type = CommandType::FlushAndInvalidateRegion;
+    command.region.addr = addr;
+    command.region.size = size;
+    commands.push_back(command);
+
+    inner->FlushAndInvalidateRegion(addr, size);
+}
+
+bool RecordingRasterizer::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
+    commands.push_back({CommandType::DisplayTransfer});
+    transfers.push_back(config);
+
+    return inner->AccelerateDisplayTransfer(config);
+}
+
+bool RecordingRasterizer::AccelerateFill(const GPU::Regs::MemoryFillConfig& config) {
+    commands.push_back({CommandType::MemoryFill});
+    fills.push_back(config);
+
+    return inner->AccelerateFill(config);
+}
+
+bool RecordingRasterizer::AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr, u32 pixel_stride, ScreenInfo& screen_info) {
+    return inner->AccelerateDisplay(config, framebuffer_addr, pixel_stride, screen_info);
+}
+
+void RecordingRasterizer::Replay(RasterizerInterface& target) const {
+    std::size_t vertex_cursor = 0;
+    std::size_t raw_vertex_cursor = 0;
+    std::size_t transfer_cursor = 0;
+    std::size_t fill_cursor = 0;
+
+    for (const Command& command : commands) {
+        switch (command.type) {
+        case CommandType::AddTriangle:
+            target.AddTriangle(vertices[vertex_cursor], vertices[vertex_cursor + 1],
+                               vertices[vertex_cursor + 2]);
+            vertex_cursor += 3;
+            break;
+        case CommandType::AddRawTriangle:
+            target.AddRawTriangle(raw_vertices[raw_vertex_cursor], raw_vertices[raw_vertex_cursor + 1],
+                                  raw_vertices[raw_vertex_cursor + 2]);
+            raw_vertex_cursor += 3;
+            break;
+        case CommandType::DrawTriangles:
+            target.DrawTriangles();
+            break;
+        case CommandType::RegisterChanged:
+            // Restore the register before the notification so the target observes the same
+            // register file the recorded rasterizer did
+            Pica::g_state.regs[static_cast<int>(command.register_changed.id)] =
+                command.register_changed.value;
+            target.NotifyPicaRegisterChanged(command.register_changed.id);
+            break;
+        case CommandType::FlushAll:
+            target.FlushAll();
+            break;
+        case CommandType::FlushRegion:
+            target.FlushRegion(command.region.addr, command.region.size);
+            break;
+        case CommandType::FlushAndInvalidateRegion:
+            target.FlushAndInvalidateRegion(command.region.addr, command.region.size);
+            break;
+        case CommandType::DisplayTransfer:
+            target.AccelerateDisplayTransfer(transfers[transfer_cursor++]);
+            break;
+        case CommandType::MemoryFill:
+            target.AccelerateFill(fills[fill_cursor++]);
+            break;
+        }
+    }
+}
+
+void RecordingRasterizer::Clear() {
+    commands.clear();
+    vertices.clear();
+    raw_vertices.clear();
+    transfers.clear();
+    fills.clear();
+}
+
+} // namespace VideoCore
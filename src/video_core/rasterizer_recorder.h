@@ -0,0 +1,98 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "common/common_types.h"
+
+#include "video_core/rasterizer_interface.h"
+#include "video_core/shader/shader.h"
+
+namespace VideoCore {
+
+/**
+ * Wraps another rasterizer and records the interface call stream flowing into it. A recording
+ * can then be replayed against any RasterizerInterface, so the software and OpenGL rasterizers
+ * can be benchmarked on identical workloads without in-game variance.
+ *
+ * Register change notifications are recorded together with the register's value at the time, and
+ * replay writes the value back into the Pica register file before forwarding the notification.
+ * The recording does not capture guest memory, so a replay is only faithful while the memory the
+ * commands reference (textures, framebuffers) still holds the same contents it did when
+ * recording; benchmark runs should replay immediately or against a snapshot.
+ */
+class RecordingRasterizer : public RasterizerInterface {
+public:
+    /// Calls are forwarded to `inner` after being recorded; it must outlive this object
+    explicit RecordingRasterizer(RasterizerInterface* inner) : inner(inner) {}
+
+    void AddTriangle(const Pica::Shader::OutputVertex& v0,
+                     const Pica::Shader::OutputVertex& v1,
+                     const Pica::Shader::OutputVertex& v2) override;
+    void DrawTriangles() override;
+    bool AcceleratesVertexShader() override;
+    void AddRawTriangle(const Pica::Shader::InputVertex& v0,
+                        const Pica::Shader::InputVertex& v1,
+                        const Pica::Shader::InputVertex& v2) override;
+    void NotifyPicaRegisterChanged(u32 id) override;
+    void FlushAll() override;
+    void FlushRegion(PAddr addr, u32 size) override;
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
+    bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
+    // Not recorded: presentation depends on renderer-side screen state that a replay
+    // target doesn't share, and it does no rendering work worth measuring
+    bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr, u32 pixel_stride, ScreenInfo& screen_info) override;
+
+    /// Replays the recorded call stream against the given rasterizer
+    void Replay(RasterizerInterface& target) const;
+
+    /// Discards the recording
+    void Clear();
+
+    std::size_t GetNumCommands() const {
+        return commands.size();
+    }
+
+private:
+    enum class CommandType : u8 {
+        AddTriangle,
+        AddRawTriangle,
+        DrawTriangles,
+        RegisterChanged,
+        FlushAll,
+        FlushRegion,
+        FlushAndInvalidateRegion,
+        DisplayTransfer,
+        MemoryFill,
+    };
+
+    struct Command {
+        CommandType type;
+        union {
+            struct {
+                u32 id;
+                u32 value; ///< Value of the register when the notification was recorded
+            } register_changed;
+            struct {
+                PAddr addr;
+                u32 size;
+            } region;
+        };
+    };
+
+    RasterizerInterface* inner;
+
+    // The fixed-size command stream; variable payloads live in the side arrays below and are
+    // consumed in order during replay
+    std::vector<Command> commands;
+    std::vector<Pica::Shader::OutputVertex> vertices;     ///< Three per AddTriangle command
+    std::vector<Pica::Shader::InputVertex> raw_vertices;  ///< Three per AddRawTriangle command
+    std::vector<GPU::Regs::DisplayTransferConfig> transfers;
+    std::vector<GPU::Regs::MemoryFillConfig> fills;
+};
+
+} // namespace VideoCore
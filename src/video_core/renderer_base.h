@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "common/common_types.h"
 
@@ -40,6 +41,16 @@ public:
     /// Shutdown the renderer
     virtual void ShutDown() = 0;
 
+    /// Requests that the next presented frame be saved to the given file; ignored by renderers
+    /// without capture support
+    virtual void RequestScreenshot(const std::string& path) {}
+
+    /// Starts dumping every presented frame as a numbered file under the given directory
+    virtual bool StartVideoDump(const std::string& path) { return false; }
+
+    /// Stops a video dump started with StartVideoDump()
+    virtual void StopVideoDump() {}
+
     // Getter/setter functions:
     // ------------------------
 
@@ -0,0 +1,251 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "common/thread_topology.h"
+
+#include "video_core/renderer_opengl/gl_frame_capture.h"
+
+static u32 RowSizeBytes(u32 width) {
+    // GL_PACK_ALIGNMENT is left at its default of 4, which happens to match the row padding
+    // BMP requires, so rows can be dumped to disk as-is
+    return (width * 3 + 3) & ~3u;
+}
+
+static void WriteLE16(u8* out, u16 value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+static void WriteLE32(u8* out, u32 value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+static bool WriteBMP(const std::string& path, const u8* pixels, u32 width, u32 height) {
+    const u32 data_size = RowSizeBytes(width) * height;
+
+    // BITMAPFILEHEADER followed by BITMAPINFOHEADER
+    u8 header[54] = {};
+    header[0] = 'B';
+    header[1] = 'M';
+    WriteLE32(&header[2], sizeof(header) + data_size); // file size
+    WriteLE32(&header[10], sizeof(header));            // offset to pixel data
+    WriteLE32(&header[14], 40);                        // BITMAPINFOHEADER size
+    WriteLE32(&header[18], width);
+    WriteLE32(&header[22], height); // positive height: rows bottom-up, as GL returns them
+    WriteLE16(&header[26], 1);      // color planes
+    WriteLE16(&header[28], 24);     // bits per pixel
+    WriteLE32(&header[34], data_size);
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen())
+        return false;
+
+    return file.WriteBytes(header, sizeof(header)) == sizeof(header) &&
+           file.WriteBytes(pixels, data_size) == data_size;
+}
+
+void FrameCapture::Init() {
+    for (auto& slot : readbacks)
+        slot.pbo.Create();
+
+    worker_exit = false;
+    worker_thread = std::thread(&FrameCapture::WorkerLoop, this);
+}
+
+void FrameCapture::Shutdown() {
+    if (worker_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            worker_exit = true;
+        }
+        queue_cv.notify_one();
+        // The worker drains the queue before exiting, so already captured frames still land
+        // on disk
+        worker_thread.join();
+    }
+
+    for (auto& slot : readbacks) {
+        if (slot.fence != nullptr) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        slot.pbo.Release();
+    }
+
+    if (dropped_frames != 0) {
+        LOG_WARNING(Render_OpenGL, "Frame capture dropped %llu frames",
+                    (unsigned long long)dropped_frames);
+    }
+}
+
+void FrameCapture::RequestScreenshot(const std::string& path) {
+    std::lock_guard<std::mutex> lock(request_mutex);
+    requested_screenshot = path;
+}
+
+bool FrameCapture::StartVideoDump(const std::string& path) {
+    if (dumping_video)
+        return false;
+
+    std::string dump_path = path;
+    if (!dump_path.empty() && dump_path.back() != '/')
+        dump_path += '/';
+
+    if (!FileUtil::CreateFullPath(dump_path)) {
+        LOG_ERROR(Render_OpenGL, "Failed to create video dump directory %s", dump_path.c_str());
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(request_mutex);
+        video_dump_path = dump_path;
+    }
+    video_frame_counter = 0;
+    dumping_video = true;
+
+    LOG_INFO(Render_OpenGL, "Dumping frames to %s", dump_path.c_str());
+    return true;
+}
+
+void FrameCapture::StopVideoDump() {
+    dumping_video = false;
+}
+
+void FrameCapture::OnFrameRendered(GLuint read_fbo, u32 width, u32 height) {
+    // Completing transfers a full ring lap after they were issued means the map below never
+    // waits on the GPU. Run this even when no capture is active so the trailing frames of a
+    // stopped dump still get flushed.
+    for (auto& slot : readbacks) {
+        if (slot.fence != nullptr)
+            TryFinishReadback(slot);
+    }
+
+    std::string screenshot_path;
+    std::string video_path;
+    {
+        std::lock_guard<std::mutex> lock(request_mutex);
+        screenshot_path.swap(requested_screenshot);
+        if (dumping_video)
+            video_path = video_dump_path;
+    }
+
+    if (screenshot_path.empty() && video_path.empty())
+        return;
+
+    Readback& slot = readbacks[frame_counter++ % NUM_PBOS];
+    if (slot.fence != nullptr) {
+        // The transfer is still in flight after a full lap around the ring; drop this frame
+        // rather than waiting for the GPU to catch up
+        dropped_frames++;
+        return;
+    }
+
+    slot.is_screenshot = !screenshot_path.empty();
+    if (slot.is_screenshot) {
+        slot.path = screenshot_path;
+    } else {
+        slot.path = Common::StringFromFormat("%sframe_%08llu.bmp", video_path.c_str(),
+                                             (unsigned long long)video_frame_counter);
+        video_frame_counter++;
+    }
+
+    IssueReadback(slot, read_fbo, width, height);
+}
+
+void FrameCapture::IssueReadback(Readback& slot, GLuint read_fbo, u32 width, u32 height) {
+    const u32 size = RowSizeBytes(width) * height;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo.handle);
+    if (slot.buffer_size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.buffer_size = size;
+    }
+
+    // OpenGLState doesn't track the pixel pack binding, but the read framebuffer binding must
+    // be restored exactly so its cache stays coherent
+    GLint prev_read_fbo;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_fbo);
+
+    // BGR matches the channel order BMP stores, making the disk write a straight dump
+    glReadPixels(0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read_fbo));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+}
+
+void FrameCapture::TryFinishReadback(Readback& slot) {
+    if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        return;
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    CapturedFrame frame;
+    bool mapped = false;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo.handle);
+    const u8* data = static_cast<const u8*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+    if (data != nullptr) {
+        frame.pixels.assign(data, data + RowSizeBytes(slot.width) * slot.height);
+        frame.width = slot.width;
+        frame.height = slot.height;
+        frame.is_screenshot = slot.is_screenshot;
+        frame.path = std::move(slot.path);
+        mapped = true;
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!mapped)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (frame_queue.size() >= MAX_QUEUED_FRAMES && !frame.is_screenshot) {
+            // The writer can't keep up with the disk; drop the frame rather than letting the
+            // queue grow without bound
+            dropped_frames++;
+            return;
+        }
+        frame_queue.push_back(std::move(frame));
+    }
+    queue_cv.notify_one();
+}
+
+void FrameCapture::WorkerLoop() {
+    Common::RegisterCurrentThread(Common::ThreadRole::IO, "FrameCapture");
+    while (true) {
+        CapturedFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return !frame_queue.empty() || worker_exit; });
+            if (frame_queue.empty())
+                break;
+
+            frame = std::move(frame_queue.front());
+            frame_queue.pop_front();
+        }
+
+        if (!WriteBMP(frame.path, frame.pixels.data(), frame.width, frame.height)) {
+            LOG_ERROR(Render_OpenGL, "Failed to write captured frame to %s", frame.path.c_str());
+        } else if (frame.is_screenshot) {
+            LOG_INFO(Render_OpenGL, "Saved screenshot to %s", frame.path.c_str());
+        }
+    }
+
+    Common::UnregisterCurrentThread();
+}
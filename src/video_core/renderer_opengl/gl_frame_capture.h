@@ -0,0 +1,105 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+/**
+ * Captures presented frames without stalling emulation. glReadPixels goes through a ring of
+ * pixel buffer objects so the GL thread never waits on the transfer; each buffer is only mapped
+ * a full ring lap after the readback was issued, by which point the copy has long finished, and
+ * file writes happen on a worker thread. If either the GPU transfer or the worker falls behind,
+ * frames are dropped instead of blocking the emulation thread.
+ *
+ * Frames are written as 24bpp BMP files: screenshots at the requested path, video dumps as a
+ * numbered frame sequence which external tools can assemble into a video.
+ */
+class FrameCapture {
+public:
+    /// Creates the readback buffers and starts the writer thread; requires a current GL context
+    void Init();
+
+    /// Flushes pending frames, stops the writer thread and destroys the GL objects; requires
+    /// the same GL context to be current
+    void Shutdown();
+
+    /// Saves the next presented frame to the given file
+    void RequestScreenshot(const std::string& path);
+
+    /// Starts writing every presented frame as a numbered file under the given directory
+    bool StartVideoDump(const std::string& path);
+
+    void StopVideoDump();
+
+    bool IsDumpingVideo() const {
+        return dumping_video;
+    }
+
+    /**
+     * Issues an asynchronous readback of the just-composited frame and completes readbacks
+     * issued on previous frames. Called on the GL thread once per presented frame; returns
+     * immediately when no capture is active.
+     * @param read_fbo Framebuffer object holding the frame, or 0 for the default framebuffer
+     */
+    void OnFrameRendered(GLuint read_fbo, u32 width, u32 height);
+
+private:
+    /// An asynchronous readback in flight through one PBO of the ring
+    struct Readback {
+        OGLBuffer pbo;
+        GLsync fence = nullptr;
+        u32 width = 0;
+        u32 height = 0;
+        u32 buffer_size = 0;       ///< Currently allocated PBO size, in bytes
+        bool is_screenshot = false;
+        std::string path;          ///< Destination file for this frame
+    };
+
+    /// A frame copied out of a PBO, waiting to be written to disk
+    struct CapturedFrame {
+        std::vector<u8> pixels;
+        u32 width;
+        u32 height;
+        bool is_screenshot;
+        std::string path;
+    };
+
+    void IssueReadback(Readback& slot, GLuint read_fbo, u32 width, u32 height);
+    void TryFinishReadback(Readback& slot);
+    void WorkerLoop();
+
+    static const size_t NUM_PBOS = 4;
+    static const size_t MAX_QUEUED_FRAMES = 8;
+
+    std::array<Readback, NUM_PBOS> readbacks;
+    u64 frame_counter = 0;
+    u64 dropped_frames = 0;
+
+    std::atomic<bool> dumping_video{false};
+    std::string video_dump_path;     ///< Guarded by request_mutex
+    u64 video_frame_counter = 0;
+
+    std::mutex request_mutex;
+    std::string requested_screenshot;
+
+    std::thread worker_thread;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<CapturedFrame> frame_queue;
+    bool worker_exit = false;
+};
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -9,21 +10,49 @@
 
 #include <glad/glad.h>
 
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/color.h"
+#include "common/emu_window.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
+#include "common/thread.h"
+#include "common/thread_topology.h"
 #include "common/vector_math.h"
 
 #include "core/hw/gpu.h"
+#include "core/settings.h"
 
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
+#include "video_core/renderer_opengl/gl_shader_decompiler.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
+#include "video_core/video_core.h"
+
+/// Size of the uniform ring buffer; large enough that the orphaning wrap is rare
+static const GLsizeiptr UNIFORM_BUFFER_SIZE = 1024 * 1024;
+
+/// Size of the streaming vertex ring buffer, split into three fence-guarded regions
+static const GLsizeiptr VERTEX_BUFFER_SIZE = 6 * 1024 * 1024;
+
+/// Blocks until the given fence has signaled, then deletes and clears it
+static void WaitAndClearFence(GLsync& fence) {
+    if (fence == nullptr)
+        return;
+
+    GLenum result;
+    do {
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    } while (result == GL_TIMEOUT_EXPIRED);
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
 
 static bool IsPassThroughTevStage(const Pica::Regs::TevStageConfig& stage) {
     return (stage.color_op == Pica::Regs::TevStageConfig::Operation::Replace &&
@@ -37,6 +66,12 @@ static bool IsPassThroughTevStage(const Pica::Regs::TevStageConfig& stage) {
 }
 
 RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
+    // The batch vectors are cleared (not deallocated) after every draw, so reserving them
+    // up front keeps the steady-state draw loop free of heap allocations from the first
+    // frame on instead of reallocating while the batches grow towards their working size.
+    vertex_batch.reserve(4096);
+    raw_vertex_batch.reserve(4096);
+
     // Create sampler objects
     for (size_t i = 0; i < texture_samplers.size(); ++i) {
         texture_samplers[i].Create();
@@ -56,6 +91,18 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     // Bind the UBO to binding point 0
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, uniform_buffer.handle);
 
+    // Allocate the uniform ring buffer up front; dirty blocks are then streamed into it with
+    // unsynchronized maps and offset rebinds instead of re-specifying the storage every draw
+    glBufferData(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+
+    // Same for the vertex ring; DrawTriangles streams shaded batches into thirds of the ring
+    // guarded by fences so an upload never stalls on buffer orphaning
+    glBufferData(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+
+    GLint ub_alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ub_alignment);
+    uniform_buffer_alignment = ub_alignment;
+
     uniform_block_data.dirty = true;
 
     for (unsigned index = 0; index < lighting_luts.size(); index++) {
@@ -87,6 +134,24 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     glVertexAttribPointer(GLShader::ATTRIBUTE_VIEW, 3, GL_FLOAT, GL_FALSE, sizeof(HardwareVertex), (GLvoid*)offsetof(HardwareVertex, view));
     glEnableVertexAttribArray(GLShader::ATTRIBUTE_VIEW);
 
+    // Generate the VBO and VAO used when vertex shading runs on the GPU, with one vec4 input
+    // per PICA attribute register
+    raw_vertex_buffer.Create();
+    raw_vertex_array.Create();
+
+    state.draw.vertex_array = raw_vertex_array.handle;
+    state.draw.vertex_buffer = raw_vertex_buffer.handle;
+    state.Apply();
+
+    for (GLuint reg = 0; reg < 16; ++reg) {
+        glVertexAttribPointer(reg, 4, GL_FLOAT, GL_FALSE, sizeof(HardwareRawVertex), (GLvoid*)(reg * 4 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(reg);
+    }
+
+    state.draw.vertex_array = vertex_array.handle;
+    state.draw.vertex_buffer = vertex_buffer.handle;
+    state.Apply();
+
     // Create render framebuffer
     framebuffer.Create();
 
@@ -98,7 +163,7 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     state.Apply();
 
     for (size_t i = 0; i < lighting_luts.size(); ++i) {
-        glActiveTexture(static_cast<GLenum>(GL_TEXTURE3 + i));
+        OpenGLState::SetActiveTextureUnit(static_cast<GLenum>(GL_TEXTURE3 + i));
         glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, 256, 0, GL_RGBA, GL_FLOAT, nullptr);
         glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -111,7 +176,7 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     }
     state.Apply();
 
-    glActiveTexture(GL_TEXTURE9);
+    OpenGLState::SetActiveTextureUnit(GL_TEXTURE9);
     glTexImage1D(GL_TEXTURE_1D, 0, GL_R32UI, 128, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -130,7 +195,15 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
 }
 
 RasterizerOpenGL::~RasterizerOpenGL() {
+    StopShaderCompiler();
+    GLShader::DiskCache::Close();
 
+    for (auto& fence : vertex_buffer_fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
 }
 
 /**
@@ -163,28 +236,100 @@ void RasterizerOpenGL::AddTriangle(const Pica::Shader::OutputVertex& v0,
     vertex_batch.emplace_back(v2, AreQuaternionsOpposite(v0.quat, v2.quat));
 }
 
+bool RasterizerOpenGL::AcceleratesVertexShader() {
+    if (!VideoCore::g_hw_vertex_shaders_enabled)
+        return false;
+
+    current_vs_hash = GLShader::Decompiler::GetSetupHash(Pica::g_state.vs, Pica::g_state.regs);
+
+    auto cached = vs_support_cache.find(current_vs_hash);
+    if (cached != vs_support_cache.end())
+        return cached->second;
+
+    bool supported = GLShader::Decompiler::IsSetupSupported(Pica::g_state.vs, Pica::g_state.regs);
+    if (!supported)
+        LOG_DEBUG(Render_OpenGL, "Vertex shader uses unsupported features, shading on the CPU");
+
+    vs_support_cache.emplace(current_vs_hash, supported);
+    return supported;
+}
+
+void RasterizerOpenGL::AddRawTriangle(const Pica::Shader::InputVertex& v0,
+                                      const Pica::Shader::InputVertex& v1,
+                                      const Pica::Shader::InputVertex& v2) {
+    // NOTE: The quaternion flip AddTriangle applies can't be replicated here since the output
+    //       quaternions aren't known before the GPU runs the vertex program.
+    raw_vertex_batch.emplace_back(v0);
+    raw_vertex_batch.emplace_back(v1);
+    raw_vertex_batch.emplace_back(v2);
+}
+
 void RasterizerOpenGL::DrawTriangles() {
+    // Raw batches run the Pica vertex shader on the GPU and must be issued before the
+    // caller touches shader state again, so they can't be held across draw commands
+    if (!raw_vertex_batch.empty()) {
+        FlushDrawBatch();
+        return;
+    }
+
     if (vertex_batch.empty())
         return;
 
+    // Defer the host draw: consecutive Pica draw commands that only rewrite geometry
+    // pipeline registers (index array, vertex counts, shader program and uniform uploads)
+    // keep accumulating into this batch and are issued as one glDrawArrays. Any GL-visible
+    // register write or cache flush ends the merge window (see NotifyPicaRegisterChanged).
+    draw_batch_pending = true;
+
+    // Keep merged batches within half a vertex ring region so the streaming path doesn't
+    // fall back to re-specifying the buffer
+    if (vertex_batch.size() * sizeof(HardwareVertex) >= VERTEX_BUFFER_SIZE / 6)
+        FlushDrawBatch();
+}
+
+void RasterizerOpenGL::FlushDrawBatch() {
+    draw_batch_pending = false;
+
+    if (vertex_batch.empty() && raw_vertex_batch.empty())
+        return;
+
     const auto& regs = Pica::g_state.regs;
 
     // Sync and bind the framebuffer surfaces
     CachedSurface* color_surface;
     CachedSurface* depth_surface;
     MathUtil::Rectangle<int> rect;
-    std::tie(color_surface, depth_surface, rect) = res_cache.GetFramebufferSurfaces(regs.framebuffer);
 
-    state.draw.draw_framebuffer = framebuffer.handle;
-    state.Apply();
+    if (framebuffer_binding_cache.valid &&
+        framebuffer_binding_cache.cache_generation == g_rasterizer_cache_generation) {
+        // Unchanged framebuffer registers and an unchanged surface cache: the attachments
+        // from the previous draw are still in place and passed the completeness check then
+        color_surface = framebuffer_binding_cache.color_surface;
+        depth_surface = framebuffer_binding_cache.depth_surface;
+        rect = framebuffer_binding_cache.rect;
+
+        state.draw.draw_framebuffer = framebuffer.handle;
+    } else {
+        std::tie(color_surface, depth_surface, rect) = res_cache.GetFramebufferSurfaces(regs.framebuffer);
+
+        state.draw.draw_framebuffer = framebuffer.handle;
+        state.Apply();
 
-    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_surface != nullptr ? color_surface->texture.handle : 0, 0);
-    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth_surface != nullptr ? depth_surface->texture.handle : 0, 0);
-    bool has_stencil = regs.framebuffer.depth_format == Pica::Regs::DepthFormat::D24S8;
-    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, (has_stencil && depth_surface != nullptr) ? depth_surface->texture.handle : 0, 0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_surface != nullptr ? color_surface->texture.handle : 0, 0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth_surface != nullptr ? depth_surface->texture.handle : 0, 0);
+        bool has_stencil = regs.framebuffer.depth_format == Pica::Regs::DepthFormat::D24S8;
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, (has_stencil && depth_surface != nullptr) ? depth_surface->texture.handle : 0, 0);
 
-    if (OpenGLState::CheckFBStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        return;
+        if (OpenGLState::CheckFBStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            return;
+        }
+
+        // Record the generation after the lookup, since creating a surface bumps it
+        framebuffer_binding_cache.valid = true;
+        framebuffer_binding_cache.color_surface = color_surface;
+        framebuffer_binding_cache.depth_surface = depth_surface;
+        framebuffer_binding_cache.rect = rect;
+        framebuffer_binding_cache.cache_generation = g_rasterizer_cache_generation;
     }
 
     // Sync the viewport
@@ -200,10 +345,19 @@ void RasterizerOpenGL::DrawTriangles() {
     const auto pica_textures = regs.GetTextures();
     for (unsigned texture_index = 0; texture_index < pica_textures.size(); ++texture_index) {
         const auto& texture = pica_textures[texture_index];
+        TextureBinding& binding = texture_binding_cache[texture_index];
+
+        // Unchanged config registers and an unchanged surface cache mean the previous lookup
+        // result still holds; consecutive draws with the same textures take this path
+        if (binding.valid && binding.cache_generation == g_rasterizer_cache_generation) {
+            state.texture_units[texture_index].texture_2d = binding.texture;
+            continue;
+        }
 
         if (texture.enabled) {
-            texture_samplers[texture_index].SyncWithConfig(texture.config);
             CachedSurface* surface = res_cache.GetTextureSurface(texture);
+            texture_samplers[texture_index].SyncWithConfig(
+                texture.config, surface != nullptr && surface->max_level > 1);
             if (surface != nullptr) {
                 state.texture_units[texture_index].texture_2d = surface->texture.handle;
             } else {
@@ -213,10 +367,17 @@ void RasterizerOpenGL::DrawTriangles() {
         } else {
             state.texture_units[texture_index].texture_2d = 0;
         }
+
+        // Record the generation after the lookup, since creating a surface bumps it
+        binding.valid = true;
+        binding.texture = state.texture_units[texture_index].texture_2d;
+        binding.cache_generation = g_rasterizer_cache_generation;
     }
 
-    // Sync and bind the shader
-    if (shader_dirty) {
+    // Sync and bind the shader. `shader_pending` keeps this retrying while a background
+    // compile for the current config is still in flight. Draws shaded entirely on the GPU
+    // bind their own program in DrawRawVertexBatch instead.
+    if ((shader_dirty || shader_pending) && !vertex_batch.empty()) {
         SetShader();
         shader_dirty = false;
     }
@@ -236,25 +397,81 @@ void RasterizerOpenGL::DrawTriangles() {
     }
 
     // Sync the uniform data
-    if (uniform_block_data.dirty) {
-        glBufferData(GL_UNIFORM_BUFFER, sizeof(UniformData), &uniform_block_data.data, GL_STATIC_DRAW);
-        uniform_block_data.dirty = false;
-    }
+    UploadUniformBlock();
 
     state.Apply();
 
     // Draw the vertex batch
-    glBufferData(GL_ARRAY_BUFFER, vertex_batch.size() * sizeof(HardwareVertex), vertex_batch.data(), GL_STREAM_DRAW);
-    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertex_batch.size());
+    if (!vertex_batch.empty()) {
+        const GLsizeiptr batch_size = vertex_batch.size() * sizeof(HardwareVertex);
+        // Keep region starts aligned to whole vertices so ranges can be drawn by index
+        static const GLsizeiptr region_size =
+            VERTEX_BUFFER_SIZE / 3 / sizeof(HardwareVertex) * sizeof(HardwareVertex);
+
+        GLint first_vertex = 0;
+        bool streamed = false;
+
+        if (batch_size <= region_size) {
+            if (vertex_buffer_storage_lost) {
+                // An oversized batch replaced the ring storage; rebuild it
+                glBufferData(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+                for (auto& fence : vertex_buffer_fences) {
+                    if (fence != nullptr) {
+                        glDeleteSync(fence);
+                        fence = nullptr;
+                    }
+                }
+                vertex_buffer_offset = 0;
+                vertex_buffer_region = 0;
+                vertex_buffer_storage_lost = false;
+            }
+
+            if (vertex_buffer_offset + batch_size > (vertex_buffer_region + 1) * region_size) {
+                // Leaving the current region: fence it behind the draws already issued, then
+                // claim the next one once the GPU has finished reading it from the last cycle
+                if (vertex_buffer_fences[vertex_buffer_region] != nullptr)
+                    glDeleteSync(vertex_buffer_fences[vertex_buffer_region]);
+                vertex_buffer_fences[vertex_buffer_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+                vertex_buffer_region = (vertex_buffer_region + 1) % 3;
+                vertex_buffer_offset = vertex_buffer_region * region_size;
+                WaitAndClearFence(vertex_buffer_fences[vertex_buffer_region]);
+            }
+
+            void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, vertex_buffer_offset, batch_size,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (mapped != nullptr) {
+                std::memcpy(mapped, vertex_batch.data(), batch_size);
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+
+                first_vertex = static_cast<GLint>(vertex_buffer_offset / sizeof(HardwareVertex));
+                vertex_buffer_offset += batch_size;
+                streamed = true;
+            }
+        }
+
+        if (!streamed) {
+            // Batch too large for a ring region (or the map failed): fall back to
+            // re-specifying the buffer and rebuild the ring on the next draw
+            glBufferData(GL_ARRAY_BUFFER, batch_size, vertex_batch.data(), GL_STREAM_DRAW);
+            vertex_buffer_storage_lost = true;
+        }
+
+        glDrawArrays(GL_TRIANGLES, first_vertex, (GLsizei)vertex_batch.size());
+    }
+
+    // Draw the raw vertex batch through the GPU-side vertex shader
+    if (!raw_vertex_batch.empty())
+        DrawRawVertexBatch();
 
     // Mark framebuffer surfaces as dirty
     // TODO: Restrict invalidation area to the viewport
     if (color_surface != nullptr) {
-        color_surface->dirty = true;
+        color_surface->MarkDirty();
         res_cache.FlushRegion(color_surface->addr, color_surface->size, color_surface, true);
     }
     if (depth_surface != nullptr) {
-        depth_surface->dirty = true;
+        depth_surface->MarkDirty();
         res_cache.FlushRegion(depth_surface->addr, depth_surface->size, depth_surface, true);
     }
 
@@ -270,6 +487,14 @@ void RasterizerOpenGL::DrawTriangles() {
 void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     const auto& regs = Pica::g_state.regs;
 
+    // End the merge window: a pending draw must be issued with the state it was recorded
+    // under before this write takes effect. Geometry pipeline registers (0x200 and up:
+    // attribute/index setup, draw triggers, shader program and uniform uploads) are only
+    // consumed while a draw command is assembled on the CPU and can't affect the GL
+    // submission of already-shaded vertices, so they keep the window open.
+    if (draw_batch_pending && id < 0x200)
+        FlushDrawBatch();
+
     switch(id) {
     // Culling
     case PICA_REG_INDEX(cull_mode):
@@ -328,8 +553,20 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
         SyncStencilWriteMask();
         break;
     case PICA_REG_INDEX(output_merger.stencil_test.raw_op):
+        SyncStencilTest();
+        break;
     case PICA_REG_INDEX(framebuffer.depth_format):
         SyncStencilTest();
+        framebuffer_binding_cache.valid = false;
+        break;
+
+    // Framebuffer attachments
+    // (Width and height share one register)
+    case PICA_REG_INDEX(framebuffer.color_format):
+    case PICA_REG_INDEX(framebuffer.depth_buffer_address):
+    case PICA_REG_INDEX(framebuffer.color_buffer_address):
+    case PICA_REG_INDEX(framebuffer.width):
+        framebuffer_binding_cache.valid = false;
         break;
 
     // Sync GL depth test + depth and color write mask
@@ -359,8 +596,38 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
         break;
 
     // Texture 0 type
+    // (This register also holds the unit's filter and wrap modes, so the cached binding's
+    // sampler state is stale as well)
     case PICA_REG_INDEX(texture0.type):
         shader_dirty = true;
+        texture_binding_cache[0].valid = false;
+        break;
+
+    // Texture units
+    // (The enable bits for all three units share one register)
+    case PICA_REG_INDEX(texture0_enable):
+        for (auto& binding : texture_binding_cache)
+            binding.valid = false;
+        break;
+    case PICA_REG_INDEX(texture0.border_color):
+    case PICA_REG_INDEX(texture0.height):
+    case PICA_REG_INDEX(texture0.address):
+    case PICA_REG_INDEX(texture0_format):
+        texture_binding_cache[0].valid = false;
+        break;
+    case PICA_REG_INDEX(texture1.border_color):
+    case PICA_REG_INDEX(texture1.height):
+    case PICA_REG_INDEX(texture1.mag_filter):
+    case PICA_REG_INDEX(texture1.address):
+    case PICA_REG_INDEX(texture1_format):
+        texture_binding_cache[1].valid = false;
+        break;
+    case PICA_REG_INDEX(texture2.border_color):
+    case PICA_REG_INDEX(texture2.height):
+    case PICA_REG_INDEX(texture2.mag_filter):
+    case PICA_REG_INDEX(texture2.address):
+    case PICA_REG_INDEX(texture2_format):
+        texture_binding_cache[2].valid = false;
         break;
 
     // TEV stages
@@ -653,24 +920,76 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
 }
 
 void RasterizerOpenGL::FlushAll() {
+    // Pending merged draws render into cached surfaces, so they must be issued before
+    // any of those surfaces can be flushed or consumed
+    if (draw_batch_pending)
+        FlushDrawBatch();
+
     res_cache.FlushAll();
 }
 
 void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
+    if (draw_batch_pending)
+        FlushDrawBatch();
+
     res_cache.FlushRegion(addr, size, nullptr, false);
+    // The caller is about to consume the bytes, so in-flight readbacks must land now
+    res_cache.ResolvePendingDownloads(addr, size);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    if (draw_batch_pending)
+        FlushDrawBatch();
+
     res_cache.FlushRegion(addr, size, nullptr, true);
+    // The CPU is about to overwrite the region; stale readbacks must not land on top of it
+    res_cache.ResolvePendingDownloads(addr, size);
 }
 
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
     using PixelFormat = CachedSurface::PixelFormat;
     using SurfaceType = CachedSurface::SurfaceType;
 
+    if (draw_batch_pending)
+        FlushDrawBatch();
+
     if (config.is_texture_copy) {
-        // TODO(tfarley): Try to hardware accelerate this
-        return false;
+        u32 input_gap = config.texture_copy.input_gap * 16;
+        u32 output_gap = config.texture_copy.output_gap * 16;
+        u32 copy_size = config.texture_copy.size;
+
+        // Only contiguous copies map cleanly onto surface rectangles
+        if (input_gap != 0 || output_gap != 0 || copy_size == 0) {
+            return false;
+        }
+
+        MathUtil::Rectangle<int> src_rect;
+        CachedSurface* src_surface = res_cache.GetTextureCopySurface(config.GetPhysicalInputAddress(), copy_size, src_rect);
+        if (src_surface == nullptr) {
+            return false;
+        }
+
+        MathUtil::Rectangle<int> dst_rect;
+        CachedSurface* dst_surface = res_cache.GetTextureCopySurface(config.GetPhysicalOutputAddress(), copy_size, dst_rect);
+        if (dst_surface == nullptr || src_surface == dst_surface) {
+            return false;
+        }
+
+        // A texture copy moves raw bytes, so both ends must interpret them identically for a
+        // blit to be equivalent
+        if (src_surface->pixel_format != dst_surface->pixel_format ||
+            src_surface->is_tiled != dst_surface->is_tiled ||
+            src_surface->width != dst_surface->width) {
+            return false;
+        }
+
+        if (!res_cache.TryBlitSurfaces(src_surface, src_rect, dst_surface, dst_rect)) {
+            return false;
+        }
+
+        dst_surface->MarkDirty(config.GetPhysicalOutputAddress(), config.GetPhysicalOutputAddress() + copy_size);
+        res_cache.FlushRegion(config.GetPhysicalOutputAddress(), copy_size, dst_surface, true);
+        return true;
     }
 
     CachedSurface src_params;
@@ -719,7 +1038,7 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
     }
 
     u32 dst_size = dst_params.width * dst_params.height * CachedSurface::GetFormatBpp(dst_params.pixel_format) / 8;
-    dst_surface->dirty = true;
+    dst_surface->MarkDirty();
     res_cache.FlushRegion(config.GetPhysicalOutputAddress(), dst_size, dst_surface, true);
     return true;
 }
@@ -728,6 +1047,9 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
     using PixelFormat = CachedSurface::PixelFormat;
     using SurfaceType = CachedSurface::SurfaceType;
 
+    if (draw_batch_pending)
+        FlushDrawBatch();
+
     CachedSurface* dst_surface = res_cache.TryGetFillSurface(config);
 
     if (dst_surface == nullptr) {
@@ -740,6 +1062,8 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
 
     GLuint old_fb = cur_state.draw.draw_framebuffer;
     cur_state.draw.draw_framebuffer = framebuffer.handle;
+    // The fill re-attaches the draw FBO, so the next draw has to rebuild its attachments
+    framebuffer_binding_cache.valid = false;
     // TODO: When scissor test is implemented, need to disable scissor test in cur_state here so Clear call isn't affected
     cur_state.Apply();
 
@@ -867,16 +1191,23 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
     // TODO: Return scissor test to previous value when scissor test is implemented
     cur_state.Apply();
 
-    dst_surface->dirty = true;
+    dst_surface->MarkDirty();
     res_cache.FlushRegion(dst_surface->addr, dst_surface->size, dst_surface, true);
     return true;
 }
 
 bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr, u32 pixel_stride, ScreenInfo& screen_info) {
+    // Displaying a screen is the closest thing to a frame boundary the rasterizer sees; use
+    // it to age the surface cache's texture recycling pool
+    res_cache.TickFrame();
+
     if (framebuffer_addr == 0) {
         return false;
     }
 
+    if (draw_batch_pending)
+        FlushDrawBatch();
+
     CachedSurface src_params;
     src_params.addr = framebuffer_addr;
     src_params.width = config.width;
@@ -907,7 +1238,8 @@ bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& con
 
 void RasterizerOpenGL::SamplerInfo::Create() {
     sampler.Create();
-    mag_filter = min_filter = TextureConfig::Linear;
+    mag_filter = TextureConfig::Linear;
+    min_filter = GL_LINEAR;
     wrap_s = wrap_t = TextureConfig::Repeat;
     border_color = 0;
 
@@ -915,16 +1247,23 @@ void RasterizerOpenGL::SamplerInfo::Create() {
     // Other attributes have correct defaults
 }
 
-void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const Pica::Regs::TextureConfig& config) {
+void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const Pica::Regs::TextureConfig& config, bool mipmapped) {
     GLuint s = sampler.handle;
 
     if (mag_filter != config.mag_filter) {
         mag_filter = config.mag_filter;
         glSamplerParameteri(s, GL_TEXTURE_MAG_FILTER, PicaToGL::TextureFilterMode(mag_filter));
     }
-    if (min_filter != config.min_filter) {
-        min_filter = config.min_filter;
-        glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER, PicaToGL::TextureFilterMode(min_filter));
+
+    // Surfaces with a mip pyramid are minified through it; the PICA filter bit then selects
+    // the within-level filter and levels are always blended to avoid popping
+    GLenum gl_min_filter = mipmapped
+        ? (config.min_filter == TextureConfig::Linear ? GL_LINEAR_MIPMAP_LINEAR
+                                                      : GL_NEAREST_MIPMAP_LINEAR)
+        : PicaToGL::TextureFilterMode(config.min_filter);
+    if (min_filter != gl_min_filter) {
+        min_filter = gl_min_filter;
+        glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER, min_filter);
     }
 
     if (wrap_s != config.wrap_s) {
@@ -945,79 +1284,400 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const Pica::Regs::TextureConf
     }
 }
 
+// Hash of a shader config with its TEV scale fields masked out, identifying the combiner
+// "structure" shared by all scale-only variants
+static u64 TevStructureHash(const PicaShaderConfig& config) {
+    PicaShaderConfig masked = config;
+    for (auto& stage : masked.state.tev_stages)
+        stage.scales_raw = 0;
+    masked.state.tev_scales_from_uniform = false;
+    return std::hash<PicaShaderConfig>()(masked);
+}
+
+// Number of scale-only program variants a combiner structure may compile before further
+// draws on it switch to the generic variant reading the scales from the uniform block
+static const u32 TEV_SCALE_CHURN_THRESHOLD = 4;
+
 void RasterizerOpenGL::SetShader() {
+    if (!shader_warmup_done)
+        WarmUpShaderCache();
+
     PicaShaderConfig config = PicaShaderConfig::CurrentConfig();
-    std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
+
+    // Titles that animate the TEV scale multipliers would otherwise compile a new program
+    // for every scale combination on the same combiner structure. Once a structure has
+    // produced enough scale-only variants, select the generic variant instead, ending the
+    // churn for that structure.
+    const u64 structure_hash = TevStructureHash(config);
+    auto churn = tev_scale_compile_counts.find(structure_hash);
+    if (churn != tev_scale_compile_counts.end() && churn->second >= TEV_SCALE_CHURN_THRESHOLD) {
+        config.state.tev_scales_from_uniform = true;
+        for (auto& stage : config.state.tev_stages)
+            stage.scales_raw = 0;
+        SyncTevScales();
+    }
+
+    // Move finished background compiles into the cache first, so a pending config that just
+    // completed is picked up by the lookup below
+    AdoptCompletedShaders();
 
     // Find (or generate) the GLSL shader for the current TEV state
     auto cached_shader = shader_cache.find(config);
     if (cached_shader != shader_cache.end()) {
         current_shader = cached_shader->second.get();
+        shader_pending = false;
 
         state.draw.shader_program = current_shader->shader.handle;
         state.Apply();
-    } else {
-        LOG_DEBUG(Render_OpenGL, "Creating new shader");
+        return;
+    }
+
+    LOG_DEBUG(Render_OpenGL, "Creating new shader");
+
+    if (!config.state.tev_scales_from_uniform)
+        ++tev_scale_compile_counts[structure_hash];
+
+    // The disk cache is opened lazily here rather than in the constructor because the title
+    // (whose id names the cache file) isn't loaded yet when the renderer is created.
+    GLShader::DiskCache::Open();
+
+    std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
+    if (GLShader::DiskCache::LoadProgram(shader->shader.handle, config)) {
+        SetupNewShader(std::move(shader), config);
+        shader_pending = false;
+        return;
+    }
+
+    if (!shader_compiler_started)
+        StartShaderCompiler();
+
+    // Hand the compile to the worker thread when possible and keep drawing with the previous
+    // program in the meantime: a few draws with a stale combiner setup are far less noticeable
+    // than a frame frozen on a driver compile.
+    if (shader_compiler_available && current_shader != nullptr) {
+        QueueShaderCompile(config);
+        shader_pending = true;
+        return;
+    }
+
+    shader->shader.Create(GLShader::GenerateVertexShader().c_str(), GLShader::GenerateFragmentShader(config).c_str());
+    GLShader::DiskCache::SaveProgram(shader->shader.handle, config);
+    SetupNewShader(std::move(shader), config);
+    shader_pending = false;
+}
+
+void RasterizerOpenGL::SetupNewShader(std::unique_ptr<PicaShader> shader, const PicaShaderConfig& config) {
+    state.draw.shader_program = shader->shader.handle;
+    state.Apply();
+
+    current_shader = shader_cache.emplace(config, std::move(shader)).first->second.get();
+    ConfigureShaderProgram(current_shader);
+
+    GLShader::DiskCache::RecordConfig(config);
+}
+
+void RasterizerOpenGL::WarmUpShaderCache() {
+    shader_warmup_done = true;
+
+    GLShader::DiskCache::Open();
+    const std::vector<PicaShaderConfig>& configs = GLShader::DiskCache::WarmupConfigs();
+    if (configs.empty())
+        return;
+
+    if (!shader_compiler_started)
+        StartShaderCompiler();
+
+    // ConfigureShaderProgram pokes the bound program, so remember the binding across the
+    // loop; in particular the first-draw behavior (a synchronous compile when no program
+    // was ever bound) must not change because warmup bound one.
+    const PicaShader* prev_shader = current_shader;
+    GLuint prev_program = state.draw.shader_program;
+
+    unsigned int num_loaded = 0;
+    unsigned int num_queued = 0;
+    for (const PicaShaderConfig& config : configs) {
+        if (shader_cache.count(config) != 0)
+            continue;
+
+        // Prefer the cached program binary; only programs missing from the binary cache
+        // (or all of them, on drivers without binary support) need a compile
+        std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
+        if (GLShader::DiskCache::LoadProgram(shader->shader.handle, config)) {
+            SetupNewShader(std::move(shader), config);
+            num_loaded++;
+            continue;
+        }
+
+        QueueShaderCompile(config);
+        num_queued++;
+    }
+
+    current_shader = prev_shader;
+    state.draw.shader_program = prev_program;
+    state.Apply();
+
+    LOG_INFO(Render_OpenGL, "Shader warmup: %u programs loaded from binaries, %u queued for compilation",
+             num_loaded, num_queued);
+}
+
+void RasterizerOpenGL::ConfigureShaderProgram(const PicaShader* shader) {
+    // Set the texture samplers to correspond to different texture units
+    GLuint uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[0]");
+    if (uniform_tex != -1) { glUniform1i(uniform_tex, 0); }
+    uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[1]");
+    if (uniform_tex != -1) { glUniform1i(uniform_tex, 1); }
+    uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[2]");
+    if (uniform_tex != -1) { glUniform1i(uniform_tex, 2); }
+
+    // Set the texture samplers to correspond to different lookup table texture units
+    GLuint uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[0]");
+    if (uniform_lut != -1) { glUniform1i(uniform_lut, 3); }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[1]");
+    if (uniform_lut != -1) { glUniform1i(uniform_lut, 4); }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[2]");
+    if (uniform_lut != -1) { glUniform1i(uniform_lut, 5); }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[3]");
+    if (uniform_lut != -1) { glUniform1i(uniform_lut, 6); }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[4]");
+    if (uniform_lut != -1) { glUniform1i(uniform_lut, 7); }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[5]");
+    if (uniform_lut != -1) { glUniform1i(uniform_lut, 8); }
+
+    GLuint uniform_fog_lut = glGetUniformLocation(shader->shader.handle, "fog_lut");
+    if (uniform_fog_lut != -1) { glUniform1i(uniform_fog_lut, 9); }
+
+    unsigned int block_index = glGetUniformBlockIndex(shader->shader.handle, "shader_data");
+    GLint block_size;
+    glGetActiveUniformBlockiv(shader->shader.handle, block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+    ASSERT_MSG(block_size == sizeof(UniformData), "Uniform block size did not match!");
+    glUniformBlockBinding(shader->shader.handle, block_index, 0);
+
+    // Update uniforms
+    SyncDepthScale();
+    SyncDepthOffset();
+    SyncAlphaTest();
+    SyncCombinerColor();
+    auto& tev_stages = Pica::g_state.regs.GetTevStages();
+    for (int index = 0; index < tev_stages.size(); ++index)
+        SyncTevConstColor(index, tev_stages[index]);
+    SyncTevScales();
+
+    SyncGlobalAmbient();
+    for (int light_index = 0; light_index < 8; light_index++) {
+        SyncLightSpecular0(light_index);
+        SyncLightSpecular1(light_index);
+        SyncLightDiffuse(light_index);
+        SyncLightAmbient(light_index);
+        SyncLightPosition(light_index);
+        SyncLightDistanceAttenuationBias(light_index);
+        SyncLightDistanceAttenuationScale(light_index);
+    }
+
+    SyncFogColor();
+}
 
-        shader->shader.Create(GLShader::GenerateVertexShader().c_str(), GLShader::GenerateFragmentShader(config).c_str());
+void RasterizerOpenGL::SetHardwareVertexShader() {
+    PicaShaderConfig config = PicaShaderConfig::CurrentConfig();
+
+    // Scale-churning combiner structures use the generic fragment side here too, sharing
+    // the churn bookkeeping with SetShader
+    const u64 structure_hash = TevStructureHash(config);
+    auto churn = tev_scale_compile_counts.find(structure_hash);
+    if (churn != tev_scale_compile_counts.end() && churn->second >= TEV_SCALE_CHURN_THRESHOLD) {
+        config.state.tev_scales_from_uniform = true;
+        for (auto& stage : config.state.tev_stages)
+            stage.scales_raw = 0;
+        SyncTevScales();
+    }
+
+    // The generated program covers both the vertex program and the fragment-side TEV state, so
+    // the key must combine the two. `current_vs_hash` was computed by AcceleratesVertexShader
+    // when this batch was assembled.
+    u64 key = current_vs_hash ^ std::hash<PicaShaderConfig>()(config);
 
-        state.draw.shader_program = shader->shader.handle;
+    auto cached_shader = hw_vs_shader_cache.find(key);
+    if (cached_shader != hw_vs_shader_cache.end()) {
+        state.draw.shader_program = cached_shader->second->shader.handle;
         state.Apply();
+        return;
+    }
 
-        // Set the texture samplers to correspond to different texture units
-        GLuint uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[0]");
-        if (uniform_tex != -1) { glUniform1i(uniform_tex, 0); }
-        uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[1]");
-        if (uniform_tex != -1) { glUniform1i(uniform_tex, 1); }
-        uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[2]");
-        if (uniform_tex != -1) { glUniform1i(uniform_tex, 2); }
-
-        // Set the texture samplers to correspond to different lookup table texture units
-        GLuint uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[0]");
-        if (uniform_lut != -1) { glUniform1i(uniform_lut, 3); }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[1]");
-        if (uniform_lut != -1) { glUniform1i(uniform_lut, 4); }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[2]");
-        if (uniform_lut != -1) { glUniform1i(uniform_lut, 5); }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[3]");
-        if (uniform_lut != -1) { glUniform1i(uniform_lut, 6); }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[4]");
-        if (uniform_lut != -1) { glUniform1i(uniform_lut, 7); }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[5]");
-        if (uniform_lut != -1) { glUniform1i(uniform_lut, 8); }
-
-        GLuint uniform_fog_lut = glGetUniformLocation(shader->shader.handle, "fog_lut");
-        if (uniform_fog_lut != -1) { glUniform1i(uniform_fog_lut, 9); }
-
-        current_shader = shader_cache.emplace(config, std::move(shader)).first->second.get();
-
-        unsigned int block_index = glGetUniformBlockIndex(current_shader->shader.handle, "shader_data");
-        GLint block_size;
-        glGetActiveUniformBlockiv(current_shader->shader.handle, block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
-        ASSERT_MSG(block_size == sizeof(UniformData), "Uniform block size did not match!");
-        glUniformBlockBinding(current_shader->shader.handle, block_index, 0);
-
-        // Update uniforms
-        SyncDepthScale();
-        SyncDepthOffset();
-        SyncAlphaTest();
-        SyncCombinerColor();
-        auto& tev_stages = Pica::g_state.regs.GetTevStages();
-        for (int index = 0; index < tev_stages.size(); ++index)
-            SyncTevConstColor(index, tev_stages[index]);
+    LOG_DEBUG(Render_OpenGL, "Creating new hardware vertex shader");
 
-        SyncGlobalAmbient();
-        for (int light_index = 0; light_index < 8; light_index++) {
-            SyncLightSpecular0(light_index);
-            SyncLightSpecular1(light_index);
-            SyncLightDiffuse(light_index);
-            SyncLightAmbient(light_index);
-            SyncLightPosition(light_index);
-            SyncLightDistanceAttenuationBias(light_index);
-            SyncLightDistanceAttenuationScale(light_index);
+    if (!config.state.tev_scales_from_uniform)
+        ++tev_scale_compile_counts[structure_hash];
+
+    std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
+    shader->shader.Create(
+        GLShader::Decompiler::GenerateVertexShader(Pica::g_state.vs, Pica::g_state.regs).c_str(),
+        GLShader::GenerateFragmentShader(config).c_str());
+
+    const PicaShader* new_shader = hw_vs_shader_cache.emplace(key, std::move(shader)).first->second.get();
+    state.draw.shader_program = new_shader->shader.handle;
+    state.Apply();
+    ConfigureShaderProgram(new_shader);
+}
+
+void RasterizerOpenGL::UploadUniformBlock() {
+    if (!uniform_block_data.dirty)
+        return;
+
+    GLsizeiptr block_size = static_cast<GLsizeiptr>(
+        Common::AlignUp(sizeof(UniformData), static_cast<size_t>(uniform_buffer_alignment)));
+
+    if (uniform_buffer_offset + block_size > UNIFORM_BUFFER_SIZE) {
+        // Orphan the ring once it wraps; the driver keeps the old storage alive for any
+        // in-flight draws still reading from it
+        glBufferData(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+        uniform_buffer_offset = 0;
+    }
+
+    void* mapped = glMapBufferRange(GL_UNIFORM_BUFFER, uniform_buffer_offset, sizeof(UniformData),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped != nullptr) {
+        std::memcpy(mapped, &uniform_block_data.data, sizeof(UniformData));
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, uniform_buffer.handle, uniform_buffer_offset, sizeof(UniformData));
+        uniform_buffer_offset += block_size;
+    } else {
+        // Mapping can fail on context loss; fall back to a plain upload and force the next
+        // call to re-specify the ring storage
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(UniformData), &uniform_block_data.data, GL_STATIC_DRAW);
+        uniform_buffer_offset = UNIFORM_BUFFER_SIZE;
+    }
+
+    uniform_block_data.dirty = false;
+}
+
+void RasterizerOpenGL::DrawRawVertexBatch() {
+    SetHardwareVertexShader();
+
+    // ConfigureShaderProgram may have dirtied the uniform block after the upload in
+    // DrawTriangles already happened
+    UploadUniformBlock();
+
+    // Upload the float uniforms the vertex program reads. Unlike the CPU shader engines, which
+    // capture uniform values when each vertex is shaded, the GPU reads them at draw time - the
+    // command processor flushes the raw batch after every draw call to keep the two equivalent.
+    GLint uniform_f = glGetUniformLocation(state.draw.shader_program, "vs_uniform_f[0]");
+    if (uniform_f != -1) {
+        std::array<GLfloat, 96 * 4> float_uniforms;
+        for (unsigned i = 0; i < 96; ++i) {
+            for (unsigned comp = 0; comp < 4; ++comp)
+                float_uniforms[i * 4 + comp] = Pica::g_state.vs.uniforms.f[i][comp].ToFloat32();
         }
+        glUniform4fv(uniform_f, 96, float_uniforms.data());
+    }
 
-        SyncFogColor();
+    state.draw.vertex_array = raw_vertex_array.handle;
+    state.draw.vertex_buffer = raw_vertex_buffer.handle;
+    state.Apply();
+
+    glBufferData(GL_ARRAY_BUFFER, raw_vertex_batch.size() * sizeof(HardwareRawVertex), raw_vertex_batch.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)raw_vertex_batch.size());
+
+    raw_vertex_batch.clear();
+
+    // Restore the shaded-vertex stream objects and force the CPU-path program to be rebound by
+    // the next batch that needs it
+    state.draw.vertex_array = vertex_array.handle;
+    state.draw.vertex_buffer = vertex_buffer.handle;
+    shader_dirty = true;
+}
+
+void RasterizerOpenGL::StartShaderCompiler() {
+    shader_compiler_started = true;
+    shader_compiler_thread = std::thread(&RasterizerOpenGL::ShaderCompilerLoop, this);
+}
+
+void RasterizerOpenGL::StopShaderCompiler() {
+    if (!shader_compiler_started)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(shader_queue_mutex);
+        shader_compiler_exit = true;
+    }
+    shader_queue_cv.notify_all();
+    shader_compiler_thread.join();
+
+    // Release any programs that finished compiling but were never adopted
+    for (const auto& job : completed_shader_jobs)
+        glDeleteProgram(job.program);
+    completed_shader_jobs.clear();
+
+    shader_compiler_started = false;
+    shader_compiler_available = false;
+}
+
+void RasterizerOpenGL::ShaderCompilerLoop() {
+    Common::RegisterCurrentThread(Common::ThreadRole::Worker, "ShaderCompiler");
+
+    if (!VideoCore::g_emu_window->MakeSharedContextCurrent()) {
+        LOG_INFO(Render_OpenGL, "No shared GL context available, shaders will compile synchronously");
+        Common::UnregisterCurrentThread();
+        return;
+    }
+    shader_compiler_available = true;
+
+    while (true) {
+        PendingShaderJob job;
+        {
+            std::unique_lock<std::mutex> lock(shader_queue_mutex);
+            shader_queue_cv.wait(lock, [this] { return shader_compiler_exit || !pending_shader_jobs.empty(); });
+            if (shader_compiler_exit)
+                break;
+
+            job = std::move(pending_shader_jobs.front());
+            pending_shader_jobs.pop_front();
+        }
+
+        GLuint program = GLShader::LoadProgram(job.vertex_source.c_str(), job.fragment_source.c_str());
+        // LoadProgram already blocked on the link status query (on this thread, where it's
+        // harmless); flush so the program object becomes visible to the main context
+        glFlush();
+
+        {
+            std::lock_guard<std::mutex> lock(shader_queue_mutex);
+            completed_shader_jobs.push_back({job.config, program});
+        }
+    }
+
+    VideoCore::g_emu_window->DoneSharedContextCurrent();
+    Common::UnregisterCurrentThread();
+}
+
+void RasterizerOpenGL::QueueShaderCompile(const PicaShaderConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(shader_queue_mutex);
+        if (queued_shader_configs.count(config) != 0)
+            return;
+
+        queued_shader_configs.insert(config);
+        pending_shader_jobs.push_back({config, GLShader::GenerateVertexShader(), GLShader::GenerateFragmentShader(config)});
+    }
+    shader_queue_cv.notify_one();
+}
+
+void RasterizerOpenGL::AdoptCompletedShaders() {
+    std::vector<CompletedShaderJob> completed;
+    {
+        std::lock_guard<std::mutex> lock(shader_queue_mutex);
+        if (completed_shader_jobs.empty())
+            return;
+
+        completed.swap(completed_shader_jobs);
+        for (const auto& job : completed)
+            queued_shader_configs.erase(job.config);
+    }
+
+    for (auto& job : completed) {
+        std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
+        shader->shader.handle = job.program;
+
+        GLShader::DiskCache::SaveProgram(job.program, job.config);
+        SetupNewShader(std::move(shader), job.config);
     }
 }
 
@@ -1103,7 +1763,7 @@ void RasterizerOpenGL::SyncFogLUT() {
 
     if (new_data != fog_lut_data) {
         fog_lut_data = new_data;
-        glActiveTexture(GL_TEXTURE9);
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE9);
         glTexSubImage1D(GL_TEXTURE_1D, 0, 0, 128, GL_RED_INTEGER, GL_UNSIGNED_INT, fog_lut_data.data());
     }
 }
@@ -1182,6 +1842,18 @@ void RasterizerOpenGL::SyncTevConstColor(int stage_index, const Pica::Regs::TevS
     }
 }
 
+void RasterizerOpenGL::SyncTevScales() {
+    const auto& tev_stages = Pica::g_state.regs.GetTevStages();
+    for (size_t index = 0; index < tev_stages.size(); ++index) {
+        GLvec4 scale = {static_cast<GLfloat>(tev_stages[index].GetColorMultiplier()),
+                        static_cast<GLfloat>(tev_stages[index].GetAlphaMultiplier()), 0.0f, 0.0f};
+        if (scale != uniform_block_data.data.tev_scale[index]) {
+            uniform_block_data.data.tev_scale[index] = scale;
+            uniform_block_data.dirty = true;
+        }
+    }
+}
+
 void RasterizerOpenGL::SyncGlobalAmbient() {
     auto color = PicaToGL::LightColor(Pica::g_state.regs.lighting.global_ambient);
     if (color != uniform_block_data.data.lighting_global_ambient) {
@@ -1202,7 +1874,7 @@ void RasterizerOpenGL::SyncLightingLUT(unsigned lut_index) {
 
     if (new_data != lighting_lut_data[lut_index]) {
         lighting_lut_data[lut_index] = new_data;
-        glActiveTexture(GL_TEXTURE3 + lut_index);
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE3 + lut_index);
         glTexSubImage1D(GL_TEXTURE_1D, 0, 0, 256, GL_RGBA, GL_FLOAT, lighting_lut_data[lut_index].data());
     }
 }
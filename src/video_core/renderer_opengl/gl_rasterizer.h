@@ -5,17 +5,25 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <glad/glad.h>
 
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/hash.h"
+#include "common/math_util.h"
 #include "common/vector_math.h"
 
 #include "core/hw/gpu.h"
@@ -180,6 +188,12 @@ union PicaShaderConfig {
         Pica::Regs::FogMode fog_mode;
         bool fog_flip;
 
+        /// When set, the TEV scale multipliers are read from the uniform block instead of
+        /// being baked into the GLSL (the scales_raw fields are zeroed in the key). Selected
+        /// for combiner structures that keep compiling scale-only variants, so that titles
+        /// animating the scales stop triggering shader compiles.
+        bool tev_scales_from_uniform;
+
         struct {
             struct {
                 unsigned num;
@@ -240,6 +254,10 @@ public:
     bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
     bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr, u32 pixel_stride, ScreenInfo& screen_info) override;
+    bool AcceleratesVertexShader() override;
+    void AddRawTriangle(const Pica::Shader::InputVertex& v0,
+                        const Pica::Shader::InputVertex& v1,
+                        const Pica::Shader::InputVertex& v2) override;
 
     /// OpenGL shader generated for a given Pica register state
     struct PicaShader {
@@ -257,11 +275,12 @@ private:
         /// Creates the sampler object, initializing its state so that it's in sync with the SamplerInfo struct.
         void Create();
         /// Syncs the sampler object with the config, updating any necessary state.
-        void SyncWithConfig(const TextureConfig& config);
+        /// `mipmapped` selects minification through the bound surface's mip pyramid.
+        void SyncWithConfig(const TextureConfig& config, bool mipmapped);
 
     private:
         TextureConfig::TextureFilter mag_filter;
-        TextureConfig::TextureFilter min_filter;
+        GLenum min_filter;
         TextureConfig::WrapMode wrap_s;
         TextureConfig::WrapMode wrap_t;
         u32 border_color;
@@ -310,6 +329,17 @@ private:
         GLfloat view[3];
     };
 
+    /// Raw input attributes of a vertex shaded on the GPU instead of by the CPU shader engines
+    struct HardwareRawVertex {
+        HardwareRawVertex(const Pica::Shader::InputVertex& v) {
+            for (unsigned reg = 0; reg < 16; ++reg)
+                for (unsigned comp = 0; comp < 4; ++comp)
+                    attr[reg][comp] = v.attr[reg][comp].ToFloat32();
+        }
+
+        GLfloat attr[16][4];
+    };
+
     struct LightSrc {
         alignas(16) GLvec3 specular_0;
         alignas(16) GLvec3 specular_1;
@@ -333,14 +363,56 @@ private:
         LightSrc light_src[8];
         alignas(16) GLvec4 const_color[6]; // A vec4 color for each of the six tev stages
         alignas(16) GLvec4 tev_combiner_buffer_color;
+        alignas(16) GLvec4 tev_scale[6]; // Color (x) and alpha (y) multipliers, only read by generic variants
     };
 
-    static_assert(sizeof(UniformData) == 0x3A0, "The size of the UniformData structure has changed, update the structure in the shader");
+    static_assert(sizeof(UniformData) == 0x400, "The size of the UniformData structure has changed, update the structure in the shader");
     static_assert(sizeof(UniformData) < 16384, "UniformData structure must be less than 16kb as per the OpenGL spec");
 
     /// Sets the OpenGL shader in accordance with the current PICA register state
     void SetShader();
 
+    /// Binds a freshly built program, sets up its sampler/uniform bindings and caches it
+    void SetupNewShader(std::unique_ptr<PicaShader> shader, const PicaShaderConfig& config);
+
+    /// Builds every program in the title's recorded warmup list, loading cached binaries on
+    /// this thread and handing the rest to the compiler thread. Runs once, at the first
+    /// shader selection of the session (i.e. during the title's first draws).
+    void WarmUpShaderCache();
+
+    /// Sets up the sampler and uniform block bindings of the currently bound program
+    void ConfigureShaderProgram(const PicaShader* shader);
+
+    /// Spawns the shader compiler thread; compilation stays synchronous if no shared context
+    void StartShaderCompiler();
+
+    /// Signals the shader compiler thread to exit and joins it
+    void StopShaderCompiler();
+
+    /// Shader compiler thread entry point, runs on the frontend's shared GL context
+    void ShaderCompilerLoop();
+
+    /// Hands a shader configuration to the compiler thread unless it is already queued
+    void QueueShaderCompile(const PicaShaderConfig& config);
+
+    /// Moves programs the compiler thread has finished into the shader cache
+    void AdoptCompletedShaders();
+
+    /// Binds the program generated from the current PICA vertex shader and fragment state,
+    /// compiling and caching it on first use
+    void SetHardwareVertexShader();
+
+    /// Draws the queued raw vertex batch through the GPU-side vertex shader
+    void DrawRawVertexBatch();
+
+    /// Issues the accumulated vertex batch to the driver. DrawTriangles defers to this
+    /// lazily, so consecutive Pica draw commands whose GL-visible state is identical
+    /// merge into a single host draw call.
+    void FlushDrawBatch();
+
+    /// Streams the uniform block into the ring buffer and rebinds it if it was dirtied
+    void UploadUniformBlock();
+
     /// Syncs the cull mode to match the PICA register
     void SyncCullMode();
 
@@ -390,6 +462,10 @@ private:
     /// Syncs the TEV constant color to match the PICA register
     void SyncTevConstColor(int tev_index, const Pica::Regs::TevStageConfig& tev_stage);
 
+    /// Syncs the TEV scale multipliers to match the PICA registers (only read by generic
+    /// shader variants, see PicaShaderConfig::State::tev_scales_from_uniform)
+    void SyncTevScales();
+
     /// Syncs the lighting global ambient color to match the PICA register
     void SyncGlobalAmbient();
 
@@ -422,10 +498,55 @@ private:
     RasterizerCacheOpenGL res_cache;
 
     std::vector<HardwareVertex> vertex_batch;
+    std::vector<HardwareRawVertex> raw_vertex_batch;
+    /// Set while `vertex_batch` holds triangles from completed Pica draw commands whose
+    /// host draw hasn't been issued yet (the merge window is still open)
+    bool draw_batch_pending = false;
 
     std::unordered_map<PicaShaderConfig, std::unique_ptr<PicaShader>> shader_cache;
+    /// Number of programs compiled per combiner structure (the config with its scale fields
+    /// masked out). Once a structure exceeds the churn threshold, further draws on it select
+    /// the generic uniform-driven variant instead of compiling more specialized ones.
+    std::unordered_map<u64, u32> tev_scale_compile_counts;
+    /// Set once WarmUpShaderCache has run for this session
+    bool shader_warmup_done = false;
     const PicaShader* current_shader = nullptr;
     bool shader_dirty;
+    /// True while a compile for the current config is in flight and an old program is bound
+    bool shader_pending = false;
+
+    /// A shader compile handed to the compiler thread, with the sources pre-generated since
+    /// the generators read Pica state that must not be touched off the emu thread
+    struct PendingShaderJob {
+        PicaShaderConfig config;
+        std::string vertex_source;
+        std::string fragment_source;
+    };
+
+    /// A program the compiler thread has linked, awaiting adoption into the shader cache
+    struct CompletedShaderJob {
+        PicaShaderConfig config;
+        GLuint program;
+    };
+
+    std::thread shader_compiler_thread;
+    std::mutex shader_queue_mutex;
+    std::condition_variable shader_queue_cv;
+    std::deque<PendingShaderJob> pending_shader_jobs;
+    std::vector<CompletedShaderJob> completed_shader_jobs;
+    std::unordered_set<PicaShaderConfig> queued_shader_configs;
+    std::atomic<bool> shader_compiler_available{false};
+    bool shader_compiler_started = false;
+    bool shader_compiler_exit = false;
+
+    /// Programs running the PICA vertex shader on the GPU, keyed over both the vertex program
+    /// hash and the fragment-side PicaShaderConfig. These are not shared with the disk cache or
+    /// the compiler thread since their key covers more state than a PicaShaderConfig.
+    std::unordered_map<u64, std::unique_ptr<PicaShader>> hw_vs_shader_cache;
+
+    /// Caches Decompiler::IsSetupSupported per vertex program hash
+    std::unordered_map<u64, bool> vs_support_cache;
+    u64 current_vs_hash = 0;
 
     struct {
         UniformData data;
@@ -434,9 +555,46 @@ private:
         bool dirty;
     } uniform_block_data = {};
 
+    /// Write offset into the uniform ring buffer; the block for the next draw is streamed to
+    /// this offset and bound with glBindBufferRange
+    GLintptr uniform_buffer_offset = 0;
+    GLsizeiptr uniform_buffer_alignment = 256; // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+    /// Ring state for the streaming vertex buffer; each third of the ring is fenced when left
+    /// so it is only rewritten once the GPU has finished reading it
+    GLintptr vertex_buffer_offset = 0;
+    int vertex_buffer_region = 0;
+    std::array<GLsync, 3> vertex_buffer_fences{};
+    bool vertex_buffer_storage_lost = false;
+
+    /// Cached result of the last bind of one texture unit. While the unit's Pica config
+    /// registers and the surface cache generation are both unchanged since the previous draw,
+    /// the stored GL handle is reused and the whole surface cache lookup is skipped.
+    struct TextureBinding {
+        bool valid = false;
+        GLuint texture = 0;
+        u32 cache_generation = 0;
+    };
+    std::array<TextureBinding, 3> texture_binding_cache;
+
+    /// Cached result of the last framebuffer surface lookup and attachment setup. While the
+    /// framebuffer registers and the surface cache generation are both unchanged since the
+    /// previous draw, the attachments from that draw are still in place and the surface
+    /// lookup, attachment rebind and completeness check are all skipped.
+    struct FramebufferBinding {
+        bool valid = false;
+        CachedSurface* color_surface = nullptr;
+        CachedSurface* depth_surface = nullptr;
+        MathUtil::Rectangle<int> rect{0, 0, 0, 0};
+        u32 cache_generation = 0;
+    };
+    FramebufferBinding framebuffer_binding_cache;
+
     std::array<SamplerInfo, 3> texture_samplers;
     OGLVertexArray vertex_array;
     OGLBuffer vertex_buffer;
+    OGLVertexArray raw_vertex_array;
+    OGLBuffer raw_vertex_buffer;
     OGLBuffer uniform_buffer;
     OGLFramebuffer framebuffer;
 
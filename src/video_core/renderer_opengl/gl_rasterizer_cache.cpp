@@ -16,11 +16,13 @@
 #include "common/emu_window.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
+#include "common/memory_accounting.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
 
 #include "core/memory.h"
 
+#include "video_core/color_convert.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
@@ -49,15 +51,55 @@ static const std::array<FormatTuple, 4> depth_format_tuples = {{
     { GL_DEPTH24_STENCIL8,  GL_DEPTH_STENCIL,   GL_UNSIGNED_INT_24_8 }, // D24S8
 }};
 
+u32 g_rasterizer_cache_generation = 0;
+
 RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
     transfer_framebuffers[0].Create();
     transfer_framebuffers[1].Create();
+
+    accounting_handle = Common::MemoryAccounting::Register(
+        "gl_surface_cache", [this] { return GetMemoryUsage(); },
+        [this](u64 target_bytes) { ShrinkToBudget(target_bytes); });
 }
 
 RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
+    Common::MemoryAccounting::Unregister(accounting_handle);
     FlushAll();
 }
 
+/// Approximate texture storage for a surface; the GL internal formats used here are all
+/// four bytes per texel
+static u64 SurfaceTextureBytes(const CachedSurface& surface) {
+    return static_cast<u64>(surface.width * surface.res_scale_width) *
+           static_cast<u64>(surface.height * surface.res_scale_height) * 4;
+}
+
+u64 RasterizerCacheOpenGL::GetMemoryUsage() const {
+    // A surface spans several intervals of the cache map; count each only once
+    std::unordered_set<const CachedSurface*> counted;
+    u64 total = 0;
+    for (const auto& surfaces : surface_cache) {
+        for (const auto& surface : surfaces.second) {
+            if (counted.insert(surface.get()).second)
+                total += SurfaceTextureBytes(*surface);
+        }
+    }
+    return total;
+}
+
+void RasterizerCacheOpenGL::ShrinkToBudget(u64 target_bytes) {
+    // No recency information is tracked, so eviction order is arbitrary; an evicted
+    // surface is written back first and re-created from guest memory if used again
+    u64 usage = GetMemoryUsage();
+    while (usage > target_bytes && !surface_cache.empty()) {
+        std::shared_ptr<CachedSurface> surface = *surface_cache.begin()->second.begin();
+        const u64 bytes = SurfaceTextureBytes(*surface);
+        FlushRegion(surface->addr, surface->size, nullptr, true);
+        usage -= std::min(usage, bytes);
+    }
+    ResolvePendingDownloads(0, 0xFFFFFFFF);
+}
+
 static void MortonCopyPixels(CachedSurface::PixelFormat pixel_format, u32 width, u32 height, u32 bytes_per_pixel, u32 gl_bytes_per_pixel, u8* morton_data, u8* gl_data, bool morton_to_gl) {
     using PixelFormat = CachedSurface::PixelFormat;
 
@@ -69,6 +111,25 @@ static void MortonCopyPixels(CachedSurface::PixelFormat pixel_format, u32 width,
     }
 
     if (pixel_format == PixelFormat::D24S8) {
+        // Move the tiles in bulk and swap the depth/stencil component order with a row kernel
+        // over the linear copy instead of rotating every value behind a Morton address
+        // computation. The GL-side buffer is always a scratch copy here, so swapping it in
+        // place before swizzling back to 3DS order is safe.
+        u32* gl_pixels = reinterpret_cast<u32*>(gl_data);
+        const size_t num_pixels = static_cast<size_t>(width) * height;
+        if (!morton_to_gl)
+            VideoCore::SwapD24S8RowFromGL(gl_pixels, num_pixels);
+        if (VideoCore::MortonCopyTiles(width, height, bytes_per_pixel, morton_data,
+                                       gl_data + static_cast<size_t>(height - 1) * width * gl_bytes_per_pixel,
+                                       -static_cast<std::ptrdiff_t>(width * gl_bytes_per_pixel),
+                                       morton_to_gl)) {
+            if (morton_to_gl)
+                VideoCore::SwapD24S8RowToGL(gl_pixels, num_pixels);
+            return;
+        }
+        if (!morton_to_gl)
+            VideoCore::SwapD24S8RowToGL(gl_pixels, num_pixels);
+
         for (unsigned y = 0; y < height; ++y) {
             for (unsigned x = 0; x < width; ++x) {
                 const u32 coarse_y = y & ~7;
@@ -87,6 +148,16 @@ static void MortonCopyPixels(CachedSurface::PixelFormat pixel_format, u32 width,
             }
         }
     } else {
+        // Whole-tile conversion: the GL image is row-linear bottom-up, so tiled row 0
+        // corresponds to its last row and the stride walks backwards.
+        if (bytes_per_pixel == gl_bytes_per_pixel &&
+            VideoCore::MortonCopyTiles(width, height, bytes_per_pixel, morton_data,
+                                       gl_data + static_cast<size_t>(height - 1) * width * gl_bytes_per_pixel,
+                                       -static_cast<std::ptrdiff_t>(width * gl_bytes_per_pixel),
+                                       morton_to_gl)) {
+            return;
+        }
+
         for (unsigned y = 0; y < height; ++y) {
             for (unsigned x = 0; x < width; ++x) {
                 const u32 coarse_y = y & ~7;
@@ -177,6 +248,17 @@ bool RasterizerCacheOpenGL::TryBlitSurfaces(CachedSurface* src_surface, const Ma
     return BlitTextures(src_surface->texture.handle, dst_surface->texture.handle, CachedSurface::GetFormatType(src_surface->pixel_format), src_rect, dst_rect);
 }
 
+/// Length of the full mip chain for the given base dimensions
+static u32 MipLevelsForSize(u32 width, u32 height) {
+    u32 levels = 1;
+    while (width > 1 || height > 1) {
+        width = std::max<u32>(width / 2, 1);
+        height = std::max<u32>(height / 2, 1);
+        ++levels;
+    }
+    return levels;
+}
+
 static void AllocateSurfaceTexture(GLuint texture, CachedSurface::PixelFormat pixel_format, u32 width, u32 height) {
     // Allocate an uninitialized texture of appropriate size and format for the surface
     using SurfaceType = CachedSurface::SurfaceType;
@@ -187,7 +269,7 @@ static void AllocateSurfaceTexture(GLuint texture, CachedSurface::PixelFormat pi
     GLuint old_tex = cur_state.texture_units[0].texture_2d;
     cur_state.texture_units[0].texture_2d = texture;
     cur_state.Apply();
-    glActiveTexture(GL_TEXTURE0);
+    OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
 
     SurfaceType type = CachedSurface::GetFormatType(pixel_format);
 
@@ -216,6 +298,116 @@ static void AllocateSurfaceTexture(GLuint texture, CachedSurface::PixelFormat pi
     cur_state.Apply();
 }
 
+/// Buckets recycled textures by everything that determines their storage: the Citra pixel
+/// format (which fixes the GL format tuple) and the allocated dimensions
+static u64 TexturePoolKey(CachedSurface::PixelFormat pixel_format, u32 width, u32 height) {
+    return ((u64)pixel_format << 48) | ((u64)width << 24) | (u64)height;
+}
+
+GLuint RasterizerCacheOpenGL::AllocateTexture(CachedSurface::PixelFormat pixel_format, u32 width, u32 height) {
+    auto bucket = texture_pool.find(TexturePoolKey(pixel_format, width, height));
+    if (bucket != texture_pool.end() && !bucket->second.empty()) {
+        OGLTexture texture = std::move(bucket->second.back().texture);
+        bucket->second.pop_back();
+
+        // The storage already matches; just put the sampling state back the way a fresh
+        // allocation leaves it, since the previous owner may have changed it while bound
+        // as a Pica texture
+        OpenGLState cur_state = OpenGLState::GetCurState();
+        GLuint old_tex = cur_state.texture_units[0].texture_2d;
+        cur_state.texture_units[0].texture_2d = texture.handle;
+        cur_state.Apply();
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        cur_state.texture_units[0].texture_2d = old_tex;
+        cur_state.Apply();
+
+        GLuint handle = texture.handle;
+        texture.handle = 0;
+        return handle;
+    }
+
+    OGLTexture texture;
+    texture.Create();
+    AllocateSurfaceTexture(texture.handle, pixel_format, width, height);
+
+    GLuint handle = texture.handle;
+    texture.handle = 0;
+    return handle;
+}
+
+void RasterizerCacheOpenGL::RecycleTexture(OGLTexture&& texture, CachedSurface::PixelFormat pixel_format, u32 width, u32 height, u32 max_level) {
+    if (texture.handle == 0) {
+        return;
+    }
+
+    // Mip pyramids may have been allocated as immutable storage, and the pool hands textures
+    // to callers expecting single-level storage, so only base-level textures are kept
+    if (max_level > 1) {
+        texture.Release();
+        return;
+    }
+
+    TexturePoolEntry entry;
+    entry.texture = std::move(texture);
+    entry.tick_released = pool_tick;
+    texture_pool[TexturePoolKey(pixel_format, width, height)].push_back(std::move(entry));
+}
+
+// Pool entries unclaimed for this many ticks are freed. TickFrame runs once per displayed
+// screen (about twice per frame), so this covers roughly two seconds of frames.
+static const u32 TEXTURE_POOL_TRIM_AGE = 240;
+
+void RasterizerCacheOpenGL::TickFrame() {
+    ++pool_tick;
+
+    for (auto it = texture_pool.begin(); it != texture_pool.end();) {
+        auto& entries = it->second;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [this](const TexturePoolEntry& entry) {
+                                         return pool_tick - entry.tick_released > TEXTURE_POOL_TRIM_AGE;
+                                     }),
+                      entries.end());
+        if (entries.empty()) {
+            it = texture_pool.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Widens a byte range touching a surface into the span of whole rows (whole 8-pixel tile rows
+ * for tiled surfaces) covering it, the granularity partial uploads and downloads operate at.
+ * Returns false if the surface's format doesn't allow addressing rows by byte offset (4-bit
+ * texel formats), in which case the caller has to transfer the whole surface.
+ */
+static bool GetDirtyRowSpan(const CachedSurface* surface, PAddr start, PAddr end, u32& first_row, u32& end_row) {
+    u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    if (bytes_per_pixel == 0) {
+        return false;
+    }
+
+    u32 pitch = (surface->stride != 0) ? surface->stride : surface->width;
+    u32 rows_per_band = surface->is_tiled ? 8 : 1;
+    u32 band_bytes = surface->is_tiled ? surface->width * 8 * bytes_per_pixel : pitch * bytes_per_pixel;
+
+    start = std::max(start, surface->addr);
+    end = std::min(end, surface->addr + surface->size);
+    if (start >= end) {
+        return false;
+    }
+
+    first_row = (start - surface->addr) / band_bytes * rows_per_band;
+    end_row = std::min<u32>((end - surface->addr + band_bytes - 1) / band_bytes * rows_per_band, surface->height);
+    return first_row < end_row;
+}
+
 MICROPROFILE_DEFINE(OpenGL_SurfaceUpload, "OpenGL", "Surface Upload", MP_RGB(128, 64, 192));
 CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bool match_res_scale, bool load_if_create) {
     using PixelFormat = CachedSurface::PixelFormat;
@@ -230,6 +422,7 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
     // Check for an exact match in existing surfaces
     CachedSurface* best_exact_surface = nullptr;
     float exact_surface_goodness = -1.f;
+    bool found_same_addr_surface = false;
 
     auto surface_interval = boost::icl::interval<PAddr>::right_open(params.addr, params.addr + params_size);
     auto range = surface_cache.equal_range(surface_interval);
@@ -237,6 +430,13 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
         for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
             CachedSurface* surface = it2->get();
 
+            // Surfaces starting at the requested address but failing the exact match below
+            // are recreated rather than plain misses; track them separately since frequent
+            // recreations indicate format/size thrashing
+            if (params.addr == surface->addr) {
+                found_same_addr_surface = true;
+            }
+
             // Check if the request matches the surface exactly
             if (params.addr == surface->addr &&
                 params.width == surface->width && params.height == surface->height &&
@@ -259,9 +459,17 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
 
     // Return the best exact surface if found
     if (best_exact_surface != nullptr) {
+        MICROPROFILE_META_CPU("Surface Cache Hits", 1);
+        ReloadInvalidRegion(best_exact_surface);
         return best_exact_surface;
     }
 
+    if (found_same_addr_surface) {
+        MICROPROFILE_META_CPU("Surface Recreations", 1);
+    } else {
+        MICROPROFILE_META_CPU("Surface Cache Misses", 1);
+    }
+
     // No matching surfaces found, so create a new one
     u8* texture_src_data = Memory::GetPhysicalPointer(params.addr);
     if (texture_src_data == nullptr) {
@@ -269,13 +477,13 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
     }
 
     MICROPROFILE_SCOPE(OpenGL_SurfaceUpload);
+    MICROPROFILE_META_CPU("Surface Bytes Uploaded", static_cast<int>(params_size));
 
     std::shared_ptr<CachedSurface> new_surface = std::make_shared<CachedSurface>();
 
     new_surface->addr = params.addr;
     new_surface->size = params_size;
 
-    new_surface->texture.Create();
     new_surface->width = params.width;
     new_surface->height = params.height;
     new_surface->stride = params.stride;
@@ -285,11 +493,14 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
     new_surface->is_tiled = params.is_tiled;
     new_surface->pixel_format = params.pixel_format;
     new_surface->dirty = false;
+    new_surface->max_level = load_if_create ? params.max_level : 1;
 
     if (!load_if_create) {
-        // Don't load any data; just allocate the surface's texture
-        AllocateSurfaceTexture(new_surface->texture.handle, new_surface->pixel_format, new_surface->GetScaledWidth(), new_surface->GetScaledHeight());
+        // Don't load any data; just allocate the surface's texture (pooled when available)
+        new_surface->texture.handle = AllocateTexture(new_surface->pixel_format, new_surface->GetScaledWidth(), new_surface->GetScaledHeight());
     } else {
+        new_surface->texture.Create();
+
         // TODO: Consider attempting subrect match in existing surfaces and direct blit here instead of memory upload below if that's a common scenario in some game
 
         Memory::RasterizerFlushRegion(params.addr, params_size);
@@ -300,7 +511,7 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
         GLuint old_tex = cur_state.texture_units[0].texture_2d;
         cur_state.texture_units[0].texture_2d = new_surface->texture.handle;
         cur_state.Apply();
-        glActiveTexture(GL_TEXTURE0);
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
 
         glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)new_surface->stride);
         if (!new_surface->is_tiled) {
@@ -330,13 +541,21 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
                 tex_info.format = (Pica::Regs::TextureFormat)params.pixel_format;
                 tex_info.physical_address = params.addr;
 
+                const Pica::DebugUtils::TextureDecoder decoder(texture_src_data, tex_info);
                 for (unsigned y = 0; y < params.height; ++y) {
                     for (unsigned x = 0; x < params.width; ++x) {
-                        tex_buffer[x + params.width * y] = Pica::DebugUtils::LookupTexture(texture_src_data, x, params.height - 1 - y, tex_info);
+                        tex_buffer[x + params.width * y] = decoder.Get(x, params.height - 1 - y);
                     }
                 }
 
-                glTexImage2D(GL_TEXTURE_2D, 0, tuple.internal_format, params.width, params.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex_buffer.data());
+                if (new_surface->max_level > 1 && glad_glTexStorage2D != nullptr) {
+                    // Allocate the whole pyramid as immutable storage when the driver
+                    // provides it; levels above the base are generated below
+                    glTexStorage2D(GL_TEXTURE_2D, new_surface->max_level, tuple.internal_format, params.width, params.height);
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, params.width, params.height, GL_RGBA, GL_UNSIGNED_BYTE, tex_buffer.data());
+                } else {
+                    glTexImage2D(GL_TEXTURE_2D, 0, tuple.internal_format, params.width, params.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex_buffer.data());
+                }
             } else {
                 // Depth/Stencil formats need special treatment since they aren't sampleable using LookupTexture and can't use RGBA format
                 size_t tuple_idx = (size_t)params.pixel_format - 14;
@@ -362,24 +581,26 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
         }
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
+        if (new_surface->max_level > 1) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+
         // If not 1x scale, blit 1x texture to a new scaled texture and replace texture in surface
         if (new_surface->res_scale_width != 1.f || new_surface->res_scale_height != 1.f) {
             OGLTexture scaled_texture;
-            scaled_texture.Create();
-
-            AllocateSurfaceTexture(scaled_texture.handle, new_surface->pixel_format, new_surface->GetScaledWidth(), new_surface->GetScaledHeight());
+            scaled_texture.handle = AllocateTexture(new_surface->pixel_format, new_surface->GetScaledWidth(), new_surface->GetScaledHeight());
             BlitTextures(new_surface->texture.handle, scaled_texture.handle, CachedSurface::GetFormatType(new_surface->pixel_format),
                 MathUtil::Rectangle<int>(0, 0, new_surface->width, new_surface->height),
                 MathUtil::Rectangle<int>(0, 0, new_surface->GetScaledWidth(), new_surface->GetScaledHeight()));
 
-            new_surface->texture.Release();
+            RecycleTexture(std::move(new_surface->texture), new_surface->pixel_format, new_surface->width, new_surface->height, new_surface->max_level);
             new_surface->texture.handle = scaled_texture.handle;
             scaled_texture.handle = 0;
             cur_state.texture_units[0].texture_2d = new_surface->texture.handle;
             cur_state.Apply();
         }
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, new_surface->max_level - 1);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -389,10 +610,155 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
     }
 
     Memory::RasterizerMarkRegionCached(new_surface->addr, new_surface->size, 1);
+    ++g_rasterizer_cache_generation;
     surface_cache.add(std::make_pair(boost::icl::interval<PAddr>::right_open(new_surface->addr, new_surface->addr + new_surface->size), std::set<std::shared_ptr<CachedSurface>>({ new_surface })));
     return new_surface.get();
 }
 
+void RasterizerCacheOpenGL::ReloadInvalidRegion(CachedSurface* surface) {
+    using PixelFormat = CachedSurface::PixelFormat;
+    using SurfaceType = CachedSurface::SurfaceType;
+
+    if (!surface->IsInvalid()) {
+        return;
+    }
+
+    // Surfaces at a scaled resolution can't be patched with a sub-rectangle upload and are
+    // dropped from the cache on invalidation instead
+    DEBUG_ASSERT(surface->res_scale_width == 1.f && surface->res_scale_height == 1.f);
+
+    u8* texture_src_data = Memory::GetPhysicalPointer(surface->addr);
+    if (texture_src_data == nullptr) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_SurfaceUpload);
+
+    // Convert each contiguous run of invalidated blocks into a row band, merging bands whose
+    // block runs round onto overlapping rows. Two distant single-texel writes thus reload two
+    // small bands instead of everything between them.
+    std::vector<std::pair<u32, u32>> bands;
+    auto add_band = [&](PAddr start, PAddr end) {
+        u32 first_row, end_row;
+        if (!GetDirtyRowSpan(surface, start, end, first_row, end_row))
+            return;
+        if (!bands.empty() && first_row <= bands.back().second) {
+            bands.back().second = std::max(bands.back().second, end_row);
+        } else {
+            bands.emplace_back(first_row, end_row);
+        }
+    };
+
+    if (surface->invalid_blocks.empty()) {
+        add_band(surface->invalid_min, surface->invalid_max);
+    } else {
+        const u32 num_blocks = surface->NumInvalidBlocks();
+        u32 block = 0;
+        while (block < num_blocks) {
+            if (!surface->invalid_blocks[block]) {
+                ++block;
+                continue;
+            }
+            u32 run_end = block;
+            while (run_end < num_blocks && surface->invalid_blocks[run_end])
+                ++run_end;
+            add_band(surface->addr + block * CachedSurface::INVALID_BLOCK_BYTES,
+                     surface->addr + std::min<u32>(run_end * CachedSurface::INVALID_BLOCK_BYTES, surface->size));
+            block = run_end;
+        }
+    }
+
+    if (bands.empty()) {
+        surface->ClearInvalid();
+        return;
+    }
+
+    u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    u32 pitch = (surface->stride != 0) ? surface->stride : surface->width;
+
+    // Write back any other surfaces holding newer data for the rows about to be read
+    Memory::RasterizerFlushRegion(surface->addr, surface->size);
+
+    OpenGLState cur_state = OpenGLState::GetCurState();
+
+    GLuint old_tex = cur_state.texture_units[0].texture_2d;
+    cur_state.texture_units[0].texture_2d = surface->texture.handle;
+    cur_state.Apply();
+    OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)surface->stride);
+    for (const auto& band : bands) {
+        const u32 first_row = band.first;
+        const u32 end_row = band.second;
+        const u32 rows = end_row - first_row;
+
+        MICROPROFILE_META_CPU("Surface Bytes Uploaded", static_cast<int>(rows * pitch * bytes_per_pixel));
+
+        if (!surface->is_tiled) {
+            ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
+            const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first_row, surface->width, rows,
+                            tuple.format, tuple.type, texture_src_data + first_row * pitch * bytes_per_pixel);
+        } else {
+            SurfaceType type = CachedSurface::GetFormatType(surface->pixel_format);
+            if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
+                std::vector<Math::Vec4<u8>> tex_buffer(surface->width * rows);
+
+                Pica::DebugUtils::TextureInfo tex_info;
+                tex_info.width = surface->width;
+                tex_info.height = surface->height;
+                tex_info.stride = surface->width * CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+                tex_info.format = (Pica::Regs::TextureFormat)surface->pixel_format;
+                tex_info.physical_address = surface->addr;
+
+                // Tiled surfaces are flipped vertically in the rasterizer vs. 3DS memory, so the
+                // band of 3DS rows [first_row, end_row) occupies GL rows [height - end_row, ...)
+                const Pica::DebugUtils::TextureDecoder decoder(texture_src_data, tex_info);
+                for (unsigned y = 0; y < rows; ++y) {
+                    for (unsigned x = 0; x < surface->width; ++x) {
+                        tex_buffer[x + surface->width * y] = decoder.Get(x, end_row - 1 - y);
+                    }
+                }
+
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, surface->height - end_row, surface->width, rows,
+                                GL_RGBA, GL_UNSIGNED_BYTE, tex_buffer.data());
+            } else {
+                size_t tuple_idx = (size_t)surface->pixel_format - 14;
+                ASSERT(tuple_idx < depth_format_tuples.size());
+                const FormatTuple& tuple = depth_format_tuples[tuple_idx];
+
+                // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
+                bool use_4bpp = (surface->pixel_format == PixelFormat::D24);
+
+                u32 gl_bytes_per_pixel = use_4bpp ? 4 : bytes_per_pixel;
+
+                std::vector<u8> temp_fb_depth_buffer(surface->width * rows * gl_bytes_per_pixel);
+
+                u8* temp_fb_depth_buffer_ptr = use_4bpp ? temp_fb_depth_buffer.data() + 1 : temp_fb_depth_buffer.data();
+
+                MortonCopyPixels(surface->pixel_format, surface->width, rows, bytes_per_pixel, gl_bytes_per_pixel,
+                                 texture_src_data + first_row * surface->width * bytes_per_pixel, temp_fb_depth_buffer_ptr, true);
+
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, surface->height - end_row, surface->width, rows,
+                                tuple.format, tuple.type, temp_fb_depth_buffer.data());
+            }
+        }
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // The base level changed, so the GPU-generated pyramid above it is stale
+    if (surface->max_level > 1) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        surface->mips_dirty = false;
+    }
+
+    surface->ClearInvalid();
+
+    cur_state.texture_units[0].texture_2d = old_tex;
+    cur_state.Apply();
+}
+
 CachedSurface* RasterizerCacheOpenGL::GetSurfaceRect(const CachedSurface& params, bool match_res_scale, bool load_if_create, MathUtil::Rectangle<int>& out_rect) {
     if (params.addr == 0) {
         return nullptr;
@@ -460,6 +826,7 @@ CachedSurface* RasterizerCacheOpenGL::GetSurfaceRect(const CachedSurface& params
         out_rect.top = (int)(out_rect.top * best_subrect_surface->res_scale_height);
         out_rect.bottom = (int)(out_rect.bottom * best_subrect_surface->res_scale_height);
 
+        ReloadInvalidRegion(best_subrect_surface);
         return best_subrect_surface;
     }
 
@@ -482,7 +849,27 @@ CachedSurface* RasterizerCacheOpenGL::GetTextureSurface(const Pica::Regs::FullTe
     params.height = info.height;
     params.is_tiled = true;
     params.pixel_format = CachedSurface::PixelFormatFromTextureFormat(info.format);
-    return GetSurface(params, false, true);
+    params.max_level = MipLevelsForSize(info.width, info.height);
+
+    CachedSurface* surface = GetSurface(params, false, true);
+
+    // If the GPU rendered into this texture since the pyramid was last generated (e.g. a
+    // display transfer targeting it), refresh the levels above the base before sampling
+    if (surface != nullptr && surface->max_level > 1 && surface->mips_dirty) {
+        OpenGLState cur_state = OpenGLState::GetCurState();
+
+        GLuint old_tex = cur_state.texture_units[0].texture_2d;
+        cur_state.texture_units[0].texture_2d = surface->texture.handle;
+        cur_state.Apply();
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
+
+        glGenerateMipmap(GL_TEXTURE_2D);
+        surface->mips_dirty = false;
+
+        cur_state.texture_units[0].texture_2d = old_tex;
+        cur_state.Apply();
+    }
+    return surface;
 }
 
 std::tuple<CachedSurface*, CachedSurface*, MathUtil::Rectangle<int>> RasterizerCacheOpenGL::GetFramebufferSurfaces(const Pica::Regs::FramebufferConfig& config) {
@@ -511,9 +898,11 @@ std::tuple<CachedSurface*, CachedSurface*, MathUtil::Rectangle<int>> RasterizerC
     if (VideoCore::g_scaled_resolution_enabled) {
         auto layout = VideoCore::g_emu_window->GetFramebufferLayout();
 
-        // Assume same scaling factor for top and bottom screens
-        color_params.res_scale_width = depth_params.res_scale_width = (float)layout.top_screen.GetWidth() / VideoCore::kScreenTopWidth;
-        color_params.res_scale_height = depth_params.res_scale_height = (float)layout.top_screen.GetHeight() / VideoCore::kScreenTopHeight;
+        // Assume same scaling factor for top and bottom screens. The dynamic factor only
+        // affects surfaces created from here on; existing ones keep their scale until evicted.
+        float dynamic_scale = VideoCore::GetDynamicResolutionScale();
+        color_params.res_scale_width = depth_params.res_scale_width = (float)layout.top_screen.GetWidth() / VideoCore::kScreenTopWidth * dynamic_scale;
+        color_params.res_scale_height = depth_params.res_scale_height = (float)layout.top_screen.GetHeight() / VideoCore::kScreenTopHeight * dynamic_scale;
     }
 
     color_params.addr = config.GetColorBufferPhysicalAddress();
@@ -583,6 +972,7 @@ CachedSurface* RasterizerCacheOpenGL::TryGetFillSurface(const GPU::Regs::MemoryF
                 CachedSurface::GetFormatBpp(surface->pixel_format) == bits_per_value &&
                 (surface->width * surface->height * CachedSurface::GetFormatBpp(surface->pixel_format) / 8) == (config.GetEndAddress() - config.GetStartAddress()))
             {
+                ReloadInvalidRegion(surface);
                 return surface;
             }
         }
@@ -591,6 +981,57 @@ CachedSurface* RasterizerCacheOpenGL::TryGetFillSurface(const GPU::Regs::MemoryF
     return nullptr;
 }
 
+CachedSurface* RasterizerCacheOpenGL::GetTextureCopySurface(PAddr addr, u32 size, MathUtil::Rectangle<int>& out_rect) {
+    if (addr == 0 || size == 0) {
+        return nullptr;
+    }
+
+    auto surface_interval = boost::icl::interval<PAddr>::right_open(addr, addr + size);
+    auto cache_upper_bound = surface_cache.upper_bound(surface_interval);
+    for (auto it = surface_cache.lower_bound(surface_interval); it != cache_upper_bound; ++it) {
+        for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+            CachedSurface* surface = it2->get();
+
+            if (addr < surface->addr || addr + size > surface->addr + surface->size) {
+                continue;
+            }
+
+            u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+            if (bytes_per_pixel == 0) {
+                continue;
+            }
+
+            // The byte range must cover a whole number of rows (whole 8-row tile bands when
+            // tiled) to map onto a rectangle of the surface
+            u32 band_bytes = surface->width * bytes_per_pixel * (surface->is_tiled ? 8 : 1);
+            u32 offset = addr - surface->addr;
+            if (band_bytes == 0 || offset % band_bytes != 0 || size % band_bytes != 0) {
+                continue;
+            }
+
+            int y0 = static_cast<int>(offset / (surface->width * bytes_per_pixel));
+            int y1 = static_cast<int>(y0 + size / (surface->width * bytes_per_pixel));
+
+            if (!surface->is_tiled) {
+                out_rect = MathUtil::Rectangle<int>(0, y0, (int)surface->width, y1);
+            } else {
+                // Tiled surfaces are flipped vertically in the rasterizer vs. 3DS memory.
+                out_rect = MathUtil::Rectangle<int>(0, (int)surface->height - y0, (int)surface->width, (int)surface->height - y1);
+            }
+
+            out_rect.left = (int)(out_rect.left * surface->res_scale_width);
+            out_rect.right = (int)(out_rect.right * surface->res_scale_width);
+            out_rect.top = (int)(out_rect.top * surface->res_scale_height);
+            out_rect.bottom = (int)(out_rect.bottom * surface->res_scale_height);
+
+            ReloadInvalidRegion(surface);
+            return surface;
+        }
+    }
+
+    return nullptr;
+}
+
 MICROPROFILE_DEFINE(OpenGL_SurfaceDownload, "OpenGL", "Surface Download", MP_RGB(128, 192, 64));
 void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
     using PixelFormat = CachedSurface::PixelFormat;
@@ -602,8 +1043,7 @@ void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
 
     MICROPROFILE_SCOPE(OpenGL_SurfaceDownload);
 
-    u8* dst_buffer = Memory::GetPhysicalPointer(surface->addr);
-    if (dst_buffer == nullptr) {
+    if (Memory::GetPhysicalPointer(surface->addr) == nullptr) {
         return;
     }
 
@@ -615,9 +1055,7 @@ void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
 
     // If not 1x scale, blit scaled texture to a new 1x texture and use that to flush
     if (surface->res_scale_width != 1.f || surface->res_scale_height != 1.f) {
-        unscaled_tex.Create();
-
-        AllocateSurfaceTexture(unscaled_tex.handle, surface->pixel_format, surface->width, surface->height);
+        unscaled_tex.handle = AllocateTexture(surface->pixel_format, surface->width, surface->height);
         BlitTextures(surface->texture.handle, unscaled_tex.handle, CachedSurface::GetFormatType(surface->pixel_format),
             MathUtil::Rectangle<int>(0, 0, surface->GetScaledWidth(), surface->GetScaledHeight()),
             MathUtil::Rectangle<int>(0, 0, surface->width, surface->height));
@@ -625,59 +1063,218 @@ void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
         texture_to_flush = unscaled_tex.handle;
     }
 
-    cur_state.texture_units[0].texture_2d = texture_to_flush;
+    u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    u32 gl_bytes_per_pixel = (surface->pixel_format == PixelFormat::D24) ? 4 : bytes_per_pixel;
+    u32 pitch = (surface->stride != 0) ? surface->stride : surface->width;
+
+    // The readback is issued into a pixel buffer object and fenced rather than transferred
+    // synchronously; the copy out to 3DS memory happens in ResolvePendingDownloads() once
+    // the CPU actually consumes the bytes, by which point the transfer has usually retired
+    // and no stall is needed.
+    PendingDownload download;
+    download.pixel_format = surface->pixel_format;
+    download.width = surface->width;
+    download.pitch = pitch;
+    download.is_tiled = surface->is_tiled;
+    download.pbo.Create();
+
+    // When only part of the surface was modified, read back just the band of rows covering
+    // the dirty range instead of transferring the whole image
+    u32 first_row = 0;
+    u32 end_row = surface->height;
+    bool band_download = false;
+    if (GetDirtyRowSpan(surface, surface->dirty_min, surface->dirty_max, first_row, end_row) &&
+        (first_row > 0 || end_row < surface->height)) {
+        u32 rows = end_row - first_row;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download.pbo.handle);
+        glBufferData(GL_PIXEL_PACK_BUFFER, surface->width * rows * gl_bytes_per_pixel, nullptr,
+                     GL_STREAM_READ);
+
+        band_download = DownloadSurfaceBand(surface, texture_to_flush, first_row, end_row);
+        // If the band couldn't be read back (e.g. incomplete framebuffer), fall back to a
+        // whole-surface download below
+    }
+
+    if (!band_download) {
+        first_row = 0;
+        end_row = surface->height;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download.pbo.handle);
+        glBufferData(GL_PIXEL_PACK_BUFFER, surface->width * surface->height * gl_bytes_per_pixel,
+                     nullptr, GL_STREAM_READ);
+
+        cur_state.texture_units[0].texture_2d = texture_to_flush;
+        cur_state.Apply();
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
+
+        SurfaceType type = CachedSurface::GetFormatType(surface->pixel_format);
+        if (type == SurfaceType::Depth || type == SurfaceType::DepthStencil) {
+            size_t tuple_idx = (size_t)surface->pixel_format - 14;
+            ASSERT(tuple_idx < depth_format_tuples.size());
+            const FormatTuple& tuple = depth_format_tuples[tuple_idx];
+
+            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, nullptr);
+        } else {
+            // TODO: Ensure this will always be a color format, not a depth or other format
+            ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
+            const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+
+            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, nullptr);
+        }
+
+        cur_state.texture_units[0].texture_2d = old_tex;
+        cur_state.Apply();
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    download.rows = end_row - first_row;
+    u32 row_bytes = (surface->is_tiled ? surface->width : pitch) * bytes_per_pixel;
+    download.addr = surface->addr + first_row * row_bytes;
+    download.size = download.rows * row_bytes;
+    download.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    MICROPROFILE_META_CPU("Surface Bytes Downloaded", static_cast<int>(download.size));
+
+    pending_downloads.push_back(std::move(download));
+    surface->dirty = false;
+
+    // The readback from the temporary is already issued and GPU-ordered, so its storage can
+    // go straight back to the pool for the next scaled flush
+    RecycleTexture(std::move(unscaled_tex), surface->pixel_format, surface->width, surface->height, 1);
+}
+
+bool RasterizerCacheOpenGL::DownloadSurfaceBand(CachedSurface* surface, GLuint texture, u32 first_row, u32 end_row) {
+    using PixelFormat = CachedSurface::PixelFormat;
+    using SurfaceType = CachedSurface::SurfaceType;
+
+    SurfaceType type = CachedSurface::GetFormatType(surface->pixel_format);
+
+    // glGetTexImage can only transfer whole images, so sub-rectangle downloads go through a
+    // framebuffer attachment and glReadPixels instead
+    OpenGLState cur_state = OpenGLState::GetCurState();
+    OpenGLState::ResetTexture(texture);
+
+    GLuint old_fb = cur_state.draw.read_framebuffer;
+    cur_state.draw.read_framebuffer = transfer_framebuffers[0].handle;
     cur_state.Apply();
-    glActiveTexture(GL_TEXTURE0);
 
-    glPixelStorei(GL_PACK_ROW_LENGTH, (GLint)surface->stride);
+    if (type == SurfaceType::Color || type == SurfaceType::Texture) {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    } else if (type == SurfaceType::Depth) {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    } else {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+    }
+
+    if (OpenGLState::CheckFBStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cur_state.draw.read_framebuffer = old_fb;
+        cur_state.Apply();
+        return false;
+    }
+
+    u32 rows = end_row - first_row;
+
     if (!surface->is_tiled) {
         // TODO: Ensure this will always be a color format, not a depth or other format
         ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
         const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
 
-        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, dst_buffer);
+        glReadPixels(0, first_row, surface->width, rows, tuple.format, tuple.type, nullptr);
+    } else if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
+        ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
+        const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+
+        // Tiled surfaces are flipped vertically in the rasterizer vs. 3DS memory, so the band
+        // of 3DS rows [first_row, end_row) occupies GL rows [height - end_row, ...)
+        glReadPixels(0, surface->height - end_row, surface->width, rows, tuple.format, tuple.type, nullptr);
     } else {
-        SurfaceType type = CachedSurface::GetFormatType(surface->pixel_format);
-        if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
-            ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
-            const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+        size_t tuple_idx = (size_t)surface->pixel_format - 14;
+        ASSERT(tuple_idx < depth_format_tuples.size());
+        const FormatTuple& tuple = depth_format_tuples[tuple_idx];
 
-            u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+        glReadPixels(0, surface->height - end_row, surface->width, rows, tuple.format, tuple.type, nullptr);
+    }
 
-            std::vector<u8> temp_gl_buffer(surface->width * surface->height * bytes_per_pixel);
+    cur_state.draw.read_framebuffer = old_fb;
+    cur_state.Apply();
 
-            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, temp_gl_buffer.data());
+    return true;
+}
 
-            // Directly copy pixels. Internal OpenGL color formats are consistent so no conversion is necessary.
-            MortonCopyPixels(surface->pixel_format, surface->width, surface->height, bytes_per_pixel, bytes_per_pixel, dst_buffer, temp_gl_buffer.data(), false);
-        } else {
-            // Depth/Stencil formats need special treatment since they aren't sampleable using LookupTexture and can't use RGBA format
-            size_t tuple_idx = (size_t)surface->pixel_format - 14;
-            ASSERT(tuple_idx < depth_format_tuples.size());
-            const FormatTuple& tuple = depth_format_tuples[tuple_idx];
+void RasterizerCacheOpenGL::CompleteDownload(PendingDownload& download) {
+    using PixelFormat = CachedSurface::PixelFormat;
 
-            u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    if (download.fence != nullptr) {
+        while (glClientWaitSync(download.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) ==
+               GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(download.fence);
+        download.fence = nullptr;
+    }
 
-            // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
-            bool use_4bpp = (surface->pixel_format == PixelFormat::D24);
+    u8* dst_buffer = Memory::GetPhysicalPointer(download.addr);
+    if (dst_buffer == nullptr) {
+        download.pbo.Release();
+        return;
+    }
 
-            u32 gl_bytes_per_pixel = use_4bpp ? 4 : bytes_per_pixel;
+    u32 bytes_per_pixel = CachedSurface::GetFormatBpp(download.pixel_format) / 8;
 
-            std::vector<u8> temp_gl_buffer(surface->width * surface->height * gl_bytes_per_pixel);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, download.pbo.handle);
+    if (!download.is_tiled) {
+        // Rows are tightly packed in the buffer; re-space them to the surface pitch
+        if (download.pitch == download.width) {
+            glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, download.size, dst_buffer);
+        } else {
+            for (u32 row = 0; row < download.rows; ++row) {
+                glGetBufferSubData(GL_PIXEL_PACK_BUFFER, row * download.width * bytes_per_pixel,
+                                   download.width * bytes_per_pixel,
+                                   dst_buffer + row * download.pitch * bytes_per_pixel);
+            }
+        }
+    } else {
+        // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
+        bool use_4bpp = (download.pixel_format == PixelFormat::D24);
+        u32 gl_bytes_per_pixel = use_4bpp ? 4 : bytes_per_pixel;
 
-            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, temp_gl_buffer.data());
+        std::vector<u8> temp_gl_buffer(download.width * download.rows * gl_bytes_per_pixel);
+        glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, temp_gl_buffer.size(), temp_gl_buffer.data());
 
-            u8* temp_gl_buffer_ptr = use_4bpp ? temp_gl_buffer.data() + 1 : temp_gl_buffer.data();
+        u8* temp_gl_buffer_ptr = use_4bpp ? temp_gl_buffer.data() + 1 : temp_gl_buffer.data();
 
-            MortonCopyPixels(surface->pixel_format, surface->width, surface->height, bytes_per_pixel, gl_bytes_per_pixel, dst_buffer, temp_gl_buffer_ptr, false);
-        }
+        MortonCopyPixels(download.pixel_format, download.width, download.rows, bytes_per_pixel,
+                         gl_bytes_per_pixel, dst_buffer, temp_gl_buffer_ptr, false);
     }
-    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-    surface->dirty = false;
+    download.pbo.Release();
+}
 
-    cur_state.texture_units[0].texture_2d = old_tex;
-    cur_state.Apply();
+void RasterizerCacheOpenGL::ResolvePendingDownloads(PAddr addr, u32 size) {
+    if (pending_downloads.empty() || size == 0) {
+        return;
+    }
+
+    // Downloads have to land in issue order since overlapping ranges may have been read
+    // back more than once, so everything issued up to the last one touching the region is
+    // completed, not just the overlapping entries themselves.
+    size_t resolve_count = 0;
+    for (size_t i = 0; i < pending_downloads.size(); ++i) {
+        const auto& download = pending_downloads[i];
+        if (download.addr < addr + size && addr < download.addr + download.size) {
+            resolve_count = i + 1;
+        }
+    }
+
+    for (size_t i = 0; i < resolve_count; ++i) {
+        CompleteDownload(pending_downloads[i]);
+    }
+    pending_downloads.erase(pending_downloads.begin(), pending_downloads.begin() + resolve_count);
 }
 
 void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const CachedSurface* skip_surface, bool invalidate) {
@@ -699,8 +1296,26 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const CachedSurfac
     for (auto surface : touching_surfaces) {
         FlushSurface(surface.get());
         if (invalidate) {
-            Memory::RasterizerMarkRegionCached(surface->addr, surface->size, -1);
-            surface_cache.subtract(std::make_pair(boost::icl::interval<PAddr>::right_open(surface->addr, surface->addr + surface->size), std::set<std::shared_ptr<CachedSurface>>({ surface })));
+            surface->MarkInvalid(std::max(addr, surface->addr), std::min(addr + size, surface->addr + surface->size));
+
+            // Partially overwritten surfaces stay cached and reload just the touched rows on
+            // next use; whole-surface overwrites (and scaled surfaces, which can't be patched
+            // with a sub-rectangle upload) are dropped as before. "Whole" means every tracking
+            // block was hit, not just that the envelope spans the surface.
+            bool whole_surface = surface->invalid_min <= surface->addr &&
+                                 surface->invalid_max >= surface->addr + surface->size &&
+                                 std::find(surface->invalid_blocks.begin(), surface->invalid_blocks.end(), false) ==
+                                     surface->invalid_blocks.end();
+            if (whole_surface ||
+                surface->res_scale_width != 1.f || surface->res_scale_height != 1.f) {
+                // Once the pages are uncached, CPU accesses stop funneling through the
+                // flush path, so any readback still in flight for them has to land first
+                ResolvePendingDownloads(surface->addr, surface->size);
+                Memory::RasterizerMarkRegionCached(surface->addr, surface->size, -1);
+                RecycleTexture(std::move(surface->texture), surface->pixel_format, surface->GetScaledWidth(), surface->GetScaledHeight(), surface->max_level);
+                ++g_rasterizer_cache_generation;
+                surface_cache.subtract(std::make_pair(boost::icl::interval<PAddr>::right_open(surface->addr, surface->addr + surface->size), std::set<std::shared_ptr<CachedSurface>>({ surface })));
+            }
         }
     }
 }
@@ -711,4 +1326,5 @@ void RasterizerCacheOpenGL::FlushAll() {
             FlushSurface(surface.get());
         }
     }
+    ResolvePendingDownloads(0, 0xFFFFFFFF);
 }
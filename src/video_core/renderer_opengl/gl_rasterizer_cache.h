@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <deque>
 #include <memory>
 #include <set>
 #include <tuple>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/icl/interval_map.hpp>
 #include <glad/glad.h>
@@ -29,6 +33,13 @@ struct CachedSurface;
 
 using SurfaceCache = boost::icl::interval_map<PAddr, std::set<std::shared_ptr<CachedSurface>>>;
 
+/// Incremented whenever a cached surface is created or destroyed, or when a surface's contents
+/// first become dirty or invalid. The rasterizer's per-unit texture binding cache compares
+/// against this to detect that a previously returned surface may be stale without redoing the
+/// cache lookup. Bumps happen only on state transitions, so repeated draws into the same
+/// render target don't invalidate the bindings every draw.
+extern u32 g_rasterizer_cache_generation;
+
 struct CachedSurface {
     enum class PixelFormat {
         // First 5 formats are shared between textures and color buffers
@@ -163,11 +174,84 @@ struct CachedSurface {
         return (u32)(height * res_scale_height);
     }
 
+    /// Marks a range of 3DS memory as having newer data in this surface than in memory
+    void MarkDirty(PAddr start, PAddr end) {
+        if (dirty) {
+            dirty_min = std::min(dirty_min, start);
+            dirty_max = std::max(dirty_max, end);
+        } else {
+            dirty_min = start;
+            dirty_max = end;
+            dirty = true;
+            ++g_rasterizer_cache_generation;
+        }
+        if (!mips_dirty) {
+            mips_dirty = true;
+            ++g_rasterizer_cache_generation;
+        }
+    }
+
+    /// Marks the whole surface as having newer data than the copy in 3DS memory
+    void MarkDirty() {
+        MarkDirty(addr, addr + size);
+    }
+
+    /// Granularity, in bytes of 3DS memory, at which CPU overwrites are tracked. Writes set
+    /// only their blocks, so scattered small writes don't widen into one huge reload span.
+    static const u32 INVALID_BLOCK_BYTES = 4096;
+
+    u32 NumInvalidBlocks() const {
+        return (size + INVALID_BLOCK_BYTES - 1) / INVALID_BLOCK_BYTES;
+    }
+
+    /// Marks a range of 3DS memory as overwritten since this surface was last uploaded; the
+    /// affected rows are reloaded before the surface is next used
+    void MarkInvalid(PAddr start, PAddr end) {
+        start = std::max(start, addr);
+        end = std::min(end, addr + size);
+        if (start >= end)
+            return;
+
+        if (IsInvalid()) {
+            invalid_min = std::min(invalid_min, start);
+            invalid_max = std::max(invalid_max, end);
+        } else {
+            invalid_min = start;
+            invalid_max = end;
+            ++g_rasterizer_cache_generation;
+        }
+
+        if (invalid_blocks.empty())
+            invalid_blocks.assign(NumInvalidBlocks(), false);
+        const u32 first_block = (start - addr) / INVALID_BLOCK_BYTES;
+        const u32 last_block = (end - 1 - addr) / INVALID_BLOCK_BYTES;
+        for (u32 block = first_block; block <= last_block; ++block)
+            invalid_blocks[block] = true;
+    }
+
+    /// Forgets all pending invalidations; called once the stale rows have been re-uploaded
+    void ClearInvalid() {
+        invalid_min = 0;
+        invalid_max = 0;
+        invalid_blocks.clear();
+    }
+
+    bool IsInvalid() const {
+        return invalid_max > invalid_min;
+    }
+
     PAddr addr;
     u32 size;
 
-    PAddr min_valid;
-    PAddr max_valid;
+    // Range of 3DS memory this surface holds newer data for than the copy in memory
+    PAddr dirty_min = 0;
+    PAddr dirty_max = 0;
+
+    // Envelope of the 3DS memory the CPU has overwritten since the surface was last uploaded
+    PAddr invalid_min = 0;
+    PAddr invalid_max = 0;
+    // Per-block invalidation flags within [addr, addr + size); empty when nothing is invalid
+    std::vector<bool> invalid_blocks;
 
     OGLTexture texture;
     u32 width;
@@ -179,6 +263,12 @@ struct CachedSurface {
     bool is_tiled;
     PixelFormat pixel_format;
     bool dirty;
+
+    // Number of mip levels allocated for the texture. PICA exposes no mip chain configuration
+    // in this register set, so levels above the base are generated on the GPU.
+    u32 max_level = 1;
+    // Set when the base level has changed since the mip pyramid was last regenerated
+    bool mips_dirty = false;
 };
 
 class RasterizerCacheOpenGL : NonCopyable {
@@ -207,16 +297,85 @@ public:
     /// Attempt to get a surface that exactly matches the fill region and format
     CachedSurface* TryGetFillSurface(const GPU::Regs::MemoryFillConfig& config);
 
-    /// Write the surface back to memory
+    /// Attempt to find a cached surface containing the byte range as a span of whole rows
+    /// (whole 8-row tile bands when tiled), returning the rect the range maps to
+    CachedSurface* GetTextureCopySurface(PAddr addr, u32 size, MathUtil::Rectangle<int>& out_rect);
+
+    /// Initiate writing the surface back to memory; the pixel data is read into a pixel
+    /// buffer object asynchronously and only lands in 3DS memory once the transfer is
+    /// resolved (see ResolvePendingDownloads)
     void FlushSurface(CachedSurface* surface);
 
+    /// Blocks until every in-flight readback issued up to the last one overlapping the
+    /// region has landed in 3DS memory. This is the point where the CPU actually consumes
+    /// the flushed bytes; transfers initiated well before it usually retire without a stall.
+    void ResolvePendingDownloads(PAddr addr, u32 size);
+
     /// Write any cached resources overlapping the region back to memory (if dirty) and optionally invalidate them in the cache
     void FlushRegion(PAddr addr, u32 size, const CachedSurface* skip_surface, bool invalidate);
 
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /// Ages the texture recycling pool and frees entries no new surface has claimed for a
+    /// while. Called once per displayed screen, so roughly twice per frame.
+    void TickFrame();
+
+    /// Approximate host/GPU memory held by cached surface textures, in bytes
+    u64 GetMemoryUsage() const;
+
+    /// Flushes and evicts surfaces until the usage estimate drops to target_bytes
+    void ShrinkToBudget(u64 target_bytes);
+
 private:
+    /// A framebuffer readback whose pixel data is still in flight on the GPU timeline.
+    /// The surface's layout is kept by value so the download can still complete after the
+    /// surface itself has been evicted from the cache.
+    struct PendingDownload {
+        OGLBuffer pbo;
+        GLsync fence = nullptr;
+
+        PAddr addr;   ///< Range of 3DS memory the downloaded band covers
+        u32 size;
+
+        CachedSurface::PixelFormat pixel_format;
+        u32 width;
+        u32 rows;
+        u32 pitch;
+        bool is_tiled;
+    };
+
+    /// Re-uploads the rows of a surface the CPU has overwritten since the last upload
+    void ReloadInvalidRegion(CachedSurface* surface);
+
+    /// Issues a read of a horizontal band of rows into the bound pixel pack buffer;
+    /// returns false if the band can't be read back through a framebuffer attachment
+    bool DownloadSurfaceBand(CachedSurface* surface, GLuint texture, u32 first_row, u32 end_row);
+
+    /// Finishes an in-flight readback, blocking on its fence if it hasn't retired yet
+    void CompleteDownload(PendingDownload& download);
+
+    /// Returns a texture with storage for the given format and size, reusing a recycled one
+    /// from the pool when a matching bucket has an entry. The contents are undefined either
+    /// way. Ownership of the handle passes to the caller.
+    GLuint AllocateTexture(CachedSurface::PixelFormat pixel_format, u32 width, u32 height);
+
+    /// Returns a texture to the recycling pool (or frees it if its storage isn't poolable)
+    void RecycleTexture(OGLTexture&& texture, CachedSurface::PixelFormat pixel_format, u32 width, u32 height, u32 max_level);
+
+    /// A texture whose surface was evicted, kept around so an upcoming surface with the same
+    /// storage can take it over instead of asking the driver for a fresh allocation
+    struct TexturePoolEntry {
+        OGLTexture texture;
+        u32 tick_released;
+    };
+
     SurfaceCache surface_cache;
     OGLFramebuffer transfer_framebuffers[2];
+    int accounting_handle = -1;
+    std::deque<PendingDownload> pending_downloads;
+
+    /// Recycled textures bucketed by format and allocated size; see AllocateTexture
+    std::unordered_map<u64, std::vector<TexturePoolEntry>> texture_pool;
+    u32 pool_tick = 0;
 };
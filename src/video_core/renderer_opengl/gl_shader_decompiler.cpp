@@ -0,0 +1,376 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <string>
+
+#include <nihstro/shader_bytecode.h>
+
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+
+#include "video_core/pica_types.h"
+#include "video_core/renderer_opengl/gl_shader_decompiler.h"
+
+using nihstro::OpCode;
+using nihstro::Instruction;
+using nihstro::RegisterType;
+using nihstro::SourceRegister;
+using nihstro::DestRegister;
+using nihstro::SwizzlePattern;
+
+namespace GLShader {
+namespace Decompiler {
+
+/// Returns true for instructions the GLSL translation handles. Flow control and address
+/// registers are rejected wholesale: without them the program is a straight line from the entry
+/// point to END, which covers the plain transform shaders most titles use.
+static bool IsInstructionSupported(const Instruction& instr) {
+    switch (instr.opcode.Value().EffectiveOpCode()) {
+    case OpCode::Id::ADD:
+    case OpCode::Id::DP3:
+    case OpCode::Id::DP4:
+    case OpCode::Id::DPH:
+    case OpCode::Id::DPHI:
+    case OpCode::Id::EX2:
+    case OpCode::Id::LG2:
+    case OpCode::Id::MUL:
+    case OpCode::Id::SGE:
+    case OpCode::Id::SGEI:
+    case OpCode::Id::SLT:
+    case OpCode::Id::SLTI:
+    case OpCode::Id::FLR:
+    case OpCode::Id::MAX:
+    case OpCode::Id::MIN:
+    case OpCode::Id::RCP:
+    case OpCode::Id::RSQ:
+    case OpCode::Id::MOV:
+        return instr.common.address_register_index == 0;
+
+    case OpCode::Id::MAD:
+    case OpCode::Id::MADI:
+        return instr.mad.address_register_index == 0;
+
+    case OpCode::Id::NOP:
+    case OpCode::Id::END:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool IsSetupSupported(const Pica::Shader::ShaderSetup& setup, const Pica::Regs& regs) {
+    for (u32 offset = regs.vs.main_offset; offset < setup.program_code.size(); ++offset) {
+        const Instruction instr = { setup.program_code[offset] };
+
+        if (!IsInstructionSupported(instr))
+            return false;
+
+        if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::END)
+            return true;
+    }
+
+    // Ran off the end of the program without hitting END
+    return false;
+}
+
+u64 GetSetupHash(const Pica::Shader::ShaderSetup& setup, const Pica::Regs& regs) {
+    // Everything the generated source reads besides the code itself: entry point, the
+    // attribute-to-input-register mapping and the output semantic mapping
+    struct {
+        u32 main_offset;
+        u8 attribute_registers[16];
+        u32 output_mask;
+        u32 output_total;
+        u32 output_attributes[7];
+        u64 code_hashes[2];
+    } config_block = {};
+
+    config_block.main_offset = regs.vs.main_offset;
+    for (int i = 0; i < 16; ++i)
+        config_block.attribute_registers[i] = static_cast<u8>(regs.vs.input_register_map.GetRegisterForAttribute(i));
+    config_block.output_mask = regs.vs.output_mask;
+    config_block.output_total = regs.vs_output_total;
+    for (int i = 0; i < 7; ++i)
+        std::memcpy(&config_block.output_attributes[i], &regs.vs_output_attributes[i], sizeof(u32));
+    config_block.code_hashes[0] = Common::ComputeHash64(setup.program_code.data(), setup.program_code.size() * sizeof(u32));
+    config_block.code_hashes[1] = Common::ComputeHash64(setup.swizzle_data.data(), setup.swizzle_data.size() * sizeof(u32));
+
+    return Common::ComputeHash64(&config_block, sizeof(config_block));
+}
+
+/// Builds the GLSL expression for a (possibly negated and swizzled) source operand
+static std::string GetSourceExpr(const SourceRegister& reg, const SwizzlePattern& swizzle, int src_num) {
+    std::string name;
+    switch (reg.GetRegisterType()) {
+    case RegisterType::Input:
+        name = "vs_in_reg" + std::to_string(reg.GetIndex());
+        break;
+    case RegisterType::Temporary:
+        name = "reg_tmp" + std::to_string(reg.GetIndex());
+        break;
+    case RegisterType::FloatUniform:
+        name = "vs_uniform_f[" + std::to_string(reg.GetIndex()) + "]";
+        break;
+    default:
+        name = "vec4(0.0)";
+        break;
+    }
+
+    static const char selector_chars[] = "xyzw";
+    std::string selector;
+    bool negate = false;
+    for (int comp = 0; comp < 4; ++comp) {
+        switch (src_num) {
+        case 1:
+            selector += selector_chars[(int)swizzle.GetSelectorSrc1(comp)];
+            negate = (swizzle.negate_src1 != 0);
+            break;
+        case 2:
+            selector += selector_chars[(int)swizzle.GetSelectorSrc2(comp)];
+            negate = (swizzle.negate_src2 != 0);
+            break;
+        case 3:
+            selector += selector_chars[(int)swizzle.GetSelectorSrc3(comp)];
+            negate = (swizzle.negate_src3 != 0);
+            break;
+        }
+    }
+
+    std::string expr = name + "." + selector;
+    if (negate)
+        expr = "(-" + expr + ")";
+    return expr;
+}
+
+/// Builds the GLSL name of a destination register
+static std::string GetDestName(const DestRegister& reg) {
+    switch (reg.GetRegisterType()) {
+    case RegisterType::Output:
+        return "reg_out" + std::to_string(reg.GetIndex());
+    case RegisterType::Temporary:
+        return "reg_tmp" + std::to_string(reg.GetIndex());
+    default:
+        return "reg_dummy";
+    }
+}
+
+/// Appends an assignment of `expr` to `dest`, respecting the destination component mask
+static void AppendMaskedAssignment(std::string& out, const std::string& dest,
+                                   const std::string& expr, const SwizzlePattern& swizzle) {
+    static const char selector_chars[] = "xyzw";
+    std::string mask;
+    for (int comp = 0; comp < 4; ++comp) {
+        if (swizzle.DestComponentEnabled(comp))
+            mask += selector_chars[comp];
+    }
+
+    if (mask.empty())
+        return;
+
+    if (mask.length() == 4)
+        out += "    " + dest + " = " + expr + ";\n";
+    else
+        out += "    " + dest + "." + mask + " = (" + expr + ")." + mask + ";\n";
+}
+
+std::string GenerateVertexShader(const Pica::Shader::ShaderSetup& setup, const Pica::Regs& regs) {
+    std::string out = "#version 330 core\n";
+
+    // Input registers: registers fed by a vertex attribute become shader inputs at the
+    // attribute's location, everything else reads as zero (matching the zero-initialized
+    // register file of the CPU shader engines)
+    const int num_attributes = regs.vertex_attributes.GetNumTotalAttributes();
+    std::array<int, 16> register_attribute;
+    register_attribute.fill(-1);
+    for (int i = 0; i < num_attributes; ++i)
+        register_attribute[regs.vs.input_register_map.GetRegisterForAttribute(i)] = i;
+
+    for (int reg = 0; reg < 16; ++reg) {
+        if (register_attribute[reg] != -1) {
+            out += "layout(location = " + std::to_string(register_attribute[reg]) +
+                   ") in vec4 vs_in_reg" + std::to_string(reg) + ";\n";
+        } else {
+            out += "const vec4 vs_in_reg" + std::to_string(reg) + " = vec4(0.0);\n";
+        }
+    }
+
+    out += R"(
+uniform vec4 vs_uniform_f[96];
+
+out vec4 primary_color;
+out vec2 texcoord[3];
+out float texcoord0_w;
+out vec4 normquat;
+out vec3 view;
+
+void main() {
+)";
+
+    for (int i = 0; i < 16; ++i)
+        out += "    vec4 reg_tmp" + std::to_string(i) + " = vec4(0.0);\n";
+    for (int i = 0; i < 16; ++i)
+        out += "    vec4 reg_out" + std::to_string(i) + " = vec4(0.0);\n";
+    out += "    vec4 reg_dummy = vec4(0.0);\n";
+
+    for (u32 offset = regs.vs.main_offset; offset < setup.program_code.size(); ++offset) {
+        const Instruction instr = { setup.program_code[offset] };
+        const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+
+        if (opcode == OpCode::Id::END)
+            break;
+        if (opcode == OpCode::Id::NOP)
+            continue;
+
+        if (opcode == OpCode::Id::MAD || opcode == OpCode::Id::MADI) {
+            const SwizzlePattern swizzle = { setup.swizzle_data[instr.mad.operand_desc_id] };
+            const bool is_inverted = (opcode == OpCode::Id::MADI);
+
+            std::string src1 = GetSourceExpr(instr.mad.GetSrc1(is_inverted), swizzle, 1);
+            std::string src2 = GetSourceExpr(instr.mad.GetSrc2(is_inverted), swizzle, 2);
+            std::string src3 = GetSourceExpr(instr.mad.GetSrc3(is_inverted), swizzle, 3);
+
+            AppendMaskedAssignment(out, GetDestName(instr.mad.dest.Value()),
+                                   "(" + src1 + " * " + src2 + " + " + src3 + ")", swizzle);
+            continue;
+        }
+
+        const SwizzlePattern swizzle = { setup.swizzle_data[instr.common.operand_desc_id] };
+        const bool is_inverted = (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+        std::string src1 = GetSourceExpr(instr.common.GetSrc1(is_inverted), swizzle, 1);
+        std::string src2 = GetSourceExpr(instr.common.GetSrc2(is_inverted), swizzle, 2);
+        std::string dest = GetDestName(instr.common.dest.Value());
+
+        std::string expr;
+        switch (opcode) {
+        case OpCode::Id::ADD:
+            expr = "(" + src1 + " + " + src2 + ")";
+            break;
+        case OpCode::Id::MUL:
+            // NOTE: Doesn't implement the PICA's 0 * inf = 0 semantics; GLSL offers no
+            // efficient way to express them, and shaders relying on it are rejected rarely
+            // enough that this hasn't been observed to matter
+            expr = "(" + src1 + " * " + src2 + ")";
+            break;
+        case OpCode::Id::MAX:
+            expr = "max(" + src1 + ", " + src2 + ")";
+            break;
+        case OpCode::Id::MIN:
+            expr = "min(" + src1 + ", " + src2 + ")";
+            break;
+        case OpCode::Id::FLR:
+            expr = "floor(" + src1 + ")";
+            break;
+        case OpCode::Id::MOV:
+            expr = src1;
+            break;
+        case OpCode::Id::SGE:
+        case OpCode::Id::SGEI:
+            expr = "vec4(greaterThanEqual(" + src1 + ", " + src2 + "))";
+            break;
+        case OpCode::Id::SLT:
+        case OpCode::Id::SLTI:
+            expr = "vec4(lessThan(" + src1 + ", " + src2 + "))";
+            break;
+        case OpCode::Id::DP3:
+            expr = "vec4(dot(vec3(" + src1 + "), vec3(" + src2 + ")))";
+            break;
+        case OpCode::Id::DP4:
+            expr = "vec4(dot(" + src1 + ", " + src2 + "))";
+            break;
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI:
+            expr = "vec4(dot(vec4(vec3(" + src1 + "), 1.0), " + src2 + "))";
+            break;
+        case OpCode::Id::RCP:
+            expr = "vec4(1.0 / (" + src1 + ").x)";
+            break;
+        case OpCode::Id::RSQ:
+            expr = "vec4(inversesqrt((" + src1 + ").x))";
+            break;
+        default:
+            UNREACHABLE();
+            break;
+        }
+
+        AppendMaskedAssignment(out, dest, expr, swizzle);
+    }
+
+    // Map the output registers to the fixed varyings through the semantic table, mirroring
+    // OutputRegisters::ToVertex. Unmapped components stay zero, like ToVertex's zero fill.
+    out += "    vec4 vtx_pos = vec4(0.0);\n";
+    out += "    primary_color = vec4(0.0);\n";
+    out += "    texcoord[0] = vec2(0.0);\n";
+    out += "    texcoord[1] = vec2(0.0);\n";
+    out += "    texcoord[2] = vec2(0.0);\n";
+    out += "    texcoord0_w = 0.0;\n";
+    out += "    normquat = vec4(0.0);\n";
+    out += "    view = vec3(0.0);\n";
+
+    static const char selector_chars[] = "xyzw";
+    unsigned semantic_index = 0;
+    for (unsigned reg = 0; reg < 7; ++reg) {
+        if (semantic_index >= regs.vs_output_total)
+            break;
+        if ((regs.vs.output_mask & (1 << reg)) == 0)
+            continue;
+
+        const auto& output_map = regs.vs_output_attributes[semantic_index];
+        const u32 semantics[4] = {
+            output_map.map_x, output_map.map_y,
+            output_map.map_z, output_map.map_w
+        };
+
+        for (int comp = 0; comp < 4; ++comp) {
+            std::string target;
+            switch (semantics[comp]) {
+            case Pica::Regs::VSOutputAttributes::POSITION_X:   target = "vtx_pos.x"; break;
+            case Pica::Regs::VSOutputAttributes::POSITION_Y:   target = "vtx_pos.y"; break;
+            case Pica::Regs::VSOutputAttributes::POSITION_Z:   target = "vtx_pos.z"; break;
+            case Pica::Regs::VSOutputAttributes::POSITION_W:   target = "vtx_pos.w"; break;
+            case Pica::Regs::VSOutputAttributes::QUATERNION_X: target = "normquat.x"; break;
+            case Pica::Regs::VSOutputAttributes::QUATERNION_Y: target = "normquat.y"; break;
+            case Pica::Regs::VSOutputAttributes::QUATERNION_Z: target = "normquat.z"; break;
+            case Pica::Regs::VSOutputAttributes::QUATERNION_W: target = "normquat.w"; break;
+            case Pica::Regs::VSOutputAttributes::COLOR_R:      target = "primary_color.r"; break;
+            case Pica::Regs::VSOutputAttributes::COLOR_G:      target = "primary_color.g"; break;
+            case Pica::Regs::VSOutputAttributes::COLOR_B:      target = "primary_color.b"; break;
+            case Pica::Regs::VSOutputAttributes::COLOR_A:      target = "primary_color.a"; break;
+            case Pica::Regs::VSOutputAttributes::TEXCOORD0_U:  target = "texcoord[0].x"; break;
+            case Pica::Regs::VSOutputAttributes::TEXCOORD0_V:  target = "texcoord[0].y"; break;
+            case Pica::Regs::VSOutputAttributes::TEXCOORD1_U:  target = "texcoord[1].x"; break;
+            case Pica::Regs::VSOutputAttributes::TEXCOORD1_V:  target = "texcoord[1].y"; break;
+            case 16: /* TEXCOORD0_W */                         target = "texcoord0_w"; break;
+            case Pica::Regs::VSOutputAttributes::VIEW_X:       target = "view.x"; break;
+            case Pica::Regs::VSOutputAttributes::VIEW_Y:       target = "view.y"; break;
+            case Pica::Regs::VSOutputAttributes::VIEW_Z:       target = "view.z"; break;
+            case Pica::Regs::VSOutputAttributes::TEXCOORD2_U:  target = "texcoord[2].x"; break;
+            case Pica::Regs::VSOutputAttributes::TEXCOORD2_V:  target = "texcoord[2].y"; break;
+            default:
+                // Includes INVALID; the component simply isn't output
+                break;
+            }
+
+            if (!target.empty()) {
+                out += "    " + target + " = reg_out" + std::to_string(reg) + "." +
+                       selector_chars[comp] + ";\n";
+            }
+        }
+
+        semantic_index++;
+    }
+
+    // Same final position transform as the passthrough vertex shader
+    out += "    gl_Position = vec4(vtx_pos.x, vtx_pos.y, -vtx_pos.z, vtx_pos.w);\n";
+    out += "}\n";
+
+    return out;
+}
+
+} // namespace Decompiler
+} // namespace GLShader
@@ -0,0 +1,38 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "common/common_types.h"
+
+#include "video_core/pica.h"
+#include "video_core/shader/shader.h"
+
+namespace GLShader {
+namespace Decompiler {
+
+/**
+ * Returns true if the current vertex shader program only uses features that can be translated
+ * to GLSL. Programs using flow control, address registers or condition codes fall back to the
+ * CPU shader engines.
+ */
+bool IsSetupSupported(const Pica::Shader::ShaderSetup& setup, const Pica::Regs& regs);
+
+/**
+ * Computes a hash over all state the generated source depends on: the program and swizzle data,
+ * the entry point, the attribute-to-register mapping and the output semantic mapping.
+ */
+u64 GetSetupHash(const Pica::Shader::ShaderSetup& setup, const Pica::Regs& regs);
+
+/**
+ * Generates a GLSL vertex shader executing the current PICA vertex program on the GPU. Outputs
+ * the same varyings the fixed passthrough vertex shader produces, so the generated fragment
+ * shaders work unchanged. Must only be called when `IsSetupSupported` returned true.
+ */
+std::string GenerateVertexShader(const Pica::Shader::ShaderSetup& setup, const Pica::Regs& regs);
+
+} // namespace Decompiler
+} // namespace GLShader
@@ -0,0 +1,198 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/file_util.h"
+#include "common/linear_disk_cache.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+
+#include "core/hle/kernel/process.h"
+
+#include "video_core/renderer_opengl/gl_rasterizer.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace GLShader {
+namespace DiskCache {
+
+// A cached program is stored as a GLenum binary format followed by the binary data itself.
+// The shader configuration is the key; the file header (which embeds the git revision) takes
+// care of discarding caches written by other builds.
+using ProgramDiskCache = LinearDiskCache<PicaShaderConfig::State, u8>;
+
+static ProgramDiskCache disk_cache;
+static std::unordered_map<PicaShaderConfig, std::vector<u8>> loaded_entries;
+static bool cache_open = false;
+
+// The warmup list reuses the LinearDiskCache container (and its revision-stamped header) as a
+// plain set of shader configurations, with a one-byte dummy value per entry. It's kept separate
+// from the binary cache because recording and replaying configurations works on drivers without
+// program binary support, where the programs are recompiled from source during warmup.
+static LinearDiskCache<PicaShaderConfig::State, u8> warmup_list;
+static std::vector<PicaShaderConfig> warmup_configs;
+static std::unordered_set<PicaShaderConfig> known_configs;
+static bool warmup_open = false;
+
+namespace {
+
+class ProgramDiskCacheReader : public LinearDiskCacheReader<PicaShaderConfig::State, u8> {
+public:
+    void Read(const PicaShaderConfig::State& key, const u8* value, u32 value_size) override {
+        if (value_size <= sizeof(GLenum))
+            return;
+
+        PicaShaderConfig config;
+        std::memcpy(&config.state, &key, sizeof(PicaShaderConfig::State));
+        loaded_entries.emplace(config, std::vector<u8>(value, value + value_size));
+    }
+};
+
+class WarmupListReader : public LinearDiskCacheReader<PicaShaderConfig::State, u8> {
+public:
+    void Read(const PicaShaderConfig::State& key, const u8* value, u32 value_size) override {
+        PicaShaderConfig config;
+        std::memcpy(&config.state, &key, sizeof(PicaShaderConfig::State));
+        if (known_configs.insert(config).second)
+            warmup_configs.push_back(config);
+    }
+};
+
+} // namespace
+
+static bool IsSupported() {
+    // Program binary support arrived with GL 4.1 / ARB_get_program_binary, which is newer than
+    // the GL 3.3 baseline, and some drivers expose the extension with zero binary formats.
+    if (glGetProgramBinary == nullptr || glProgramBinary == nullptr)
+        return false;
+
+    GLint num_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    return num_formats > 0;
+}
+
+void Open() {
+    if (cache_open || warmup_open)
+        return;
+
+    if (Kernel::g_current_process == nullptr)
+        return;
+
+    u64 program_id = Kernel::g_current_process->codeset->program_id;
+
+    std::string cache_dir = FileUtil::GetUserPath(D_SHADERCACHE_IDX);
+    FileUtil::CreateFullPath(cache_dir);
+
+    std::string warmup_filename =
+        cache_dir + Common::StringFromFormat("%016" PRIX64 ".warmup", program_id);
+    WarmupListReader warmup_reader;
+    u32 num_warmup = warmup_list.OpenAndRead(warmup_filename.c_str(), warmup_reader);
+    LOG_INFO(Render_OpenGL, "Loaded %u shader warmup entries from %s", num_warmup,
+             warmup_filename.c_str());
+    warmup_open = true;
+
+    if (!IsSupported())
+        return;
+
+    std::string filename =
+        cache_dir + Common::StringFromFormat("%016" PRIX64 ".cache", program_id);
+
+    ProgramDiskCacheReader reader;
+    u32 num_entries = disk_cache.OpenAndRead(filename.c_str(), reader);
+    LOG_INFO(Render_OpenGL, "Loaded %u cached shader programs from %s", num_entries,
+             filename.c_str());
+
+    cache_open = true;
+}
+
+void Close() {
+    if (warmup_open) {
+        warmup_list.Sync();
+        warmup_list.Close();
+        warmup_configs.clear();
+        known_configs.clear();
+        warmup_open = false;
+    }
+
+    if (!cache_open)
+        return;
+
+    disk_cache.Sync();
+    disk_cache.Close();
+    loaded_entries.clear();
+    cache_open = false;
+}
+
+bool LoadProgram(GLuint& program, const PicaShaderConfig& config) {
+    if (!cache_open)
+        return false;
+
+    auto entry = loaded_entries.find(config);
+    if (entry == loaded_entries.end())
+        return false;
+
+    const std::vector<u8>& blob = entry->second;
+    GLenum binary_format;
+    std::memcpy(&binary_format, blob.data(), sizeof(binary_format));
+
+    GLuint handle = glCreateProgram();
+    glProgramBinary(handle, binary_format, blob.data() + sizeof(binary_format),
+                    static_cast<GLsizei>(blob.size() - sizeof(binary_format)));
+
+    GLint link_status = GL_FALSE;
+    glGetProgramiv(handle, GL_LINK_STATUS, &link_status);
+    if (link_status != GL_TRUE) {
+        // The driver rejected the binary (e.g. it was produced by a different driver version);
+        // drop the entry so the recompiled program gets appended in its place.
+        LOG_WARNING(Render_OpenGL, "Driver rejected cached shader program binary, recompiling");
+        glDeleteProgram(handle);
+        loaded_entries.erase(entry);
+        return false;
+    }
+
+    program = handle;
+    return true;
+}
+
+void SaveProgram(GLuint program, const PicaShaderConfig& config) {
+    if (!cache_open)
+        return;
+
+    GLint binary_length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0)
+        return;
+
+    std::vector<u8> blob(sizeof(GLenum) + binary_length);
+    GLenum binary_format = 0;
+    glGetProgramBinary(program, binary_length, nullptr, &binary_format,
+                       blob.data() + sizeof(GLenum));
+    std::memcpy(blob.data(), &binary_format, sizeof(binary_format));
+
+    disk_cache.Append(config.state, blob.data(), static_cast<u32>(blob.size()));
+    disk_cache.Sync();
+}
+
+void RecordConfig(const PicaShaderConfig& config) {
+    if (!warmup_open)
+        return;
+
+    if (!known_configs.insert(config).second)
+        return;
+
+    const u8 dummy = 0;
+    warmup_list.Append(config.state, &dummy, 1);
+    warmup_list.Sync();
+}
+
+const std::vector<PicaShaderConfig>& WarmupConfigs() {
+    return warmup_configs;
+}
+
+} // namespace DiskCache
+} // namespace GLShader
@@ -0,0 +1,53 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+union PicaShaderConfig;
+
+namespace GLShader {
+namespace DiskCache {
+
+/**
+ * Opens the on-disk program binary cache for the currently running title, creating it if it
+ * doesn't exist yet. Does nothing if no title is running, if the driver doesn't support program
+ * binaries, or if the cache is already open. Must be called from the render thread.
+ */
+void Open();
+
+/// Flushes any appended entries and closes the cache file.
+void Close();
+
+/**
+ * Tries to build a program from the cached binary stored for the given shader configuration.
+ * @param program Output parameter receiving the handle of the newly created program
+ * @param config Shader configuration used as the cache key
+ * @returns True if a cached binary was found and accepted by the driver, in which case the caller
+ *          must skip compilation; false otherwise (the output handle is left untouched)
+ */
+bool LoadProgram(GLuint& program, const PicaShaderConfig& config);
+
+/**
+ * Retrieves the binary of the given linked program and appends it to the cache under the given
+ * shader configuration, so later runs of this title can skip compiling it.
+ */
+void SaveProgram(GLuint program, const PicaShaderConfig& config);
+
+/**
+ * Records a shader configuration in the title's warmup list, so later runs of this title can
+ * build the program during warmup instead of stuttering when it's first drawn with. Kept
+ * separately from the binary cache because it works on drivers without program binary support.
+ * Configurations already in the list are ignored.
+ */
+void RecordConfig(const PicaShaderConfig& config);
+
+/// Returns the shader configurations recorded during earlier runs of this title.
+const std::vector<PicaShaderConfig>& WarmupConfigs();
+
+} // namespace DiskCache
+} // namespace GLShader
@@ -302,7 +302,9 @@ static void AppendAlphaTestCondition(std::string& out, Regs::CompareFunc func) {
 /// Writes the code to emulate the specified TEV stage
 static void WriteTevStage(std::string& out, const PicaShaderConfig& config, unsigned index) {
     const auto stage = static_cast<const Pica::Regs::TevStageConfig>(config.state.tev_stages[index]);
-    if (!IsPassThroughTevStage(stage)) {
+    // Generic variants don't know the scale multipliers at generation time, so no stage can
+    // be proven to be a pass-through
+    if (!IsPassThroughTevStage(stage) || config.state.tev_scales_from_uniform) {
         std::string index_name = std::to_string(index);
 
         out += "vec3 color_results_" + index_name + "[3] = vec3[3](";
@@ -329,9 +331,16 @@ static void WriteTevStage(std::string& out, const PicaShaderConfig& config, unsi
         AppendAlphaCombiner(out, stage.alpha_op, "alpha_results_" + index_name);
         out += ";\n";
 
+        std::string color_scale = std::to_string(stage.GetColorMultiplier()) + ".0";
+        std::string alpha_scale = std::to_string(stage.GetAlphaMultiplier()) + ".0";
+        if (config.state.tev_scales_from_uniform) {
+            color_scale = "tev_scale[" + index_name + "].x";
+            alpha_scale = "tev_scale[" + index_name + "].y";
+        }
+
         out += "last_tex_env_out = vec4("
-            "clamp(color_output_" + index_name + " * " + std::to_string(stage.GetColorMultiplier()) + ".0, vec3(0.0), vec3(1.0)),"
-            "clamp(alpha_output_" + index_name + " * " + std::to_string(stage.GetAlphaMultiplier()) + ".0, 0.0, 1.0));\n";
+            "clamp(color_output_" + index_name + " * " + color_scale + ", vec3(0.0), vec3(1.0)),"
+            "clamp(alpha_output_" + index_name + " * " + alpha_scale + ", 0.0, 1.0));\n";
     }
 
     out += "combiner_buffer = next_combiner_buffer;\n";
@@ -560,6 +569,7 @@ layout (std140) uniform shader_data {
     LightSrc light_src[NUM_LIGHTS];
     vec4 const_color[NUM_TEV_STAGES];
     vec4 tev_combiner_buffer_color;
+    vec4 tev_scale[NUM_TEV_STAGES];
 };
 
 uniform sampler2D tex[3];
@@ -67,6 +67,11 @@ GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
     glAttachShader(program_id, vertex_shader_id);
     glAttachShader(program_id, fragment_shader_id);
 
+    // Ask for a retrievable binary so the program can be stored in the on-disk shader cache.
+    // glProgramParameteri is core since GL 4.1 / ARB_get_program_binary, so it may be unloaded.
+    if (glProgramParameteri != nullptr)
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     glLinkProgram(program_id);
 
     // Check the program
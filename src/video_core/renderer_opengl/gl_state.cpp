@@ -10,6 +10,8 @@
 #include "video_core/renderer_opengl/gl_state.h"
 
 OpenGLState OpenGLState::cur_state;
+GLenum OpenGLState::active_texture_unit = GL_TEXTURE0;
+OpenGLState::Stats OpenGLState::stats;
 
 OpenGLState::OpenGLState() {
     // These all match default OpenGL values
@@ -69,8 +71,19 @@ OpenGLState::OpenGLState() {
 }
 
 void OpenGLState::Apply() const {
+    // Counts each state group checked against the shadow copy, so the savings from
+    // filtering redundant driver calls stay visible
+    auto changed = [](bool differs) {
+        if (differs) {
+            ++stats.calls_emitted;
+        } else {
+            ++stats.calls_filtered;
+        }
+        return differs;
+    };
+
     // Culling
-    if (cull.enabled != cur_state.cull.enabled) {
+    if (changed(cull.enabled != cur_state.cull.enabled)) {
         if (cull.enabled) {
             glEnable(GL_CULL_FACE);
         } else {
@@ -78,16 +91,16 @@ void OpenGLState::Apply() const {
         }
     }
 
-    if (cull.mode != cur_state.cull.mode) {
+    if (changed(cull.mode != cur_state.cull.mode)) {
         glCullFace(cull.mode);
     }
 
-    if (cull.front_face != cur_state.cull.front_face) {
+    if (changed(cull.front_face != cur_state.cull.front_face)) {
         glFrontFace(cull.front_face);
     }
 
     // Depth test
-    if (depth.test_enabled != cur_state.depth.test_enabled) {
+    if (changed(depth.test_enabled != cur_state.depth.test_enabled)) {
         if (depth.test_enabled) {
             glEnable(GL_DEPTH_TEST);
         } else {
@@ -95,26 +108,26 @@ void OpenGLState::Apply() const {
         }
     }
 
-    if (depth.test_func != cur_state.depth.test_func) {
+    if (changed(depth.test_func != cur_state.depth.test_func)) {
         glDepthFunc(depth.test_func);
     }
 
     // Depth mask
-    if (depth.write_mask != cur_state.depth.write_mask) {
+    if (changed(depth.write_mask != cur_state.depth.write_mask)) {
         glDepthMask(depth.write_mask);
     }
 
     // Color mask
-    if (color_mask.red_enabled != cur_state.color_mask.red_enabled ||
+    if (changed(color_mask.red_enabled != cur_state.color_mask.red_enabled ||
             color_mask.green_enabled != cur_state.color_mask.green_enabled ||
             color_mask.blue_enabled != cur_state.color_mask.blue_enabled ||
-            color_mask.alpha_enabled != cur_state.color_mask.alpha_enabled) {
+            color_mask.alpha_enabled != cur_state.color_mask.alpha_enabled)) {
         glColorMask(color_mask.red_enabled, color_mask.green_enabled,
                     color_mask.blue_enabled, color_mask.alpha_enabled);
     }
 
     // Stencil test
-    if (stencil.test_enabled != cur_state.stencil.test_enabled) {
+    if (changed(stencil.test_enabled != cur_state.stencil.test_enabled)) {
         if (stencil.test_enabled) {
             glEnable(GL_STENCIL_TEST);
         } else {
@@ -122,25 +135,25 @@ void OpenGLState::Apply() const {
         }
     }
 
-    if (stencil.test_func != cur_state.stencil.test_func ||
+    if (changed(stencil.test_func != cur_state.stencil.test_func ||
             stencil.test_ref != cur_state.stencil.test_ref ||
-            stencil.test_mask != cur_state.stencil.test_mask) {
+            stencil.test_mask != cur_state.stencil.test_mask)) {
         glStencilFunc(stencil.test_func, stencil.test_ref, stencil.test_mask);
     }
 
-    if (stencil.action_depth_fail != cur_state.stencil.action_depth_fail ||
+    if (changed(stencil.action_depth_fail != cur_state.stencil.action_depth_fail ||
             stencil.action_depth_pass != cur_state.stencil.action_depth_pass ||
-            stencil.action_stencil_fail != cur_state.stencil.action_stencil_fail) {
+            stencil.action_stencil_fail != cur_state.stencil.action_stencil_fail)) {
         glStencilOp(stencil.action_stencil_fail, stencil.action_depth_fail, stencil.action_depth_pass);
     }
 
     // Stencil mask
-    if (stencil.write_mask != cur_state.stencil.write_mask) {
+    if (changed(stencil.write_mask != cur_state.stencil.write_mask)) {
         glStencilMask(stencil.write_mask);
     }
 
     // Blending
-    if (blend.enabled != cur_state.blend.enabled) {
+    if (changed(blend.enabled != cur_state.blend.enabled)) {
         if (blend.enabled) {
             glEnable(GL_BLEND);
 
@@ -153,87 +166,104 @@ void OpenGLState::Apply() const {
         }
     }
 
-    if (blend.color.red != cur_state.blend.color.red ||
+    if (changed(blend.color.red != cur_state.blend.color.red ||
             blend.color.green != cur_state.blend.color.green ||
             blend.color.blue != cur_state.blend.color.blue ||
-            blend.color.alpha != cur_state.blend.color.alpha) {
+            blend.color.alpha != cur_state.blend.color.alpha)) {
         glBlendColor(blend.color.red, blend.color.green,
                      blend.color.blue, blend.color.alpha);
     }
 
-    if (blend.src_rgb_func != cur_state.blend.src_rgb_func ||
+    if (changed(blend.src_rgb_func != cur_state.blend.src_rgb_func ||
             blend.dst_rgb_func != cur_state.blend.dst_rgb_func ||
             blend.src_a_func != cur_state.blend.src_a_func ||
-            blend.dst_a_func != cur_state.blend.dst_a_func) {
+            blend.dst_a_func != cur_state.blend.dst_a_func)) {
         glBlendFuncSeparate(blend.src_rgb_func, blend.dst_rgb_func,
                             blend.src_a_func, blend.dst_a_func);
     }
 
-    if (blend.rgb_equation != cur_state.blend.rgb_equation ||
-            blend.a_equation != cur_state.blend.a_equation) {
+    if (changed(blend.rgb_equation != cur_state.blend.rgb_equation ||
+            blend.a_equation != cur_state.blend.a_equation)) {
         glBlendEquationSeparate(blend.rgb_equation, blend.a_equation);
     }
 
-    if (logic_op != cur_state.logic_op) {
+    if (changed(logic_op != cur_state.logic_op)) {
         glLogicOp(logic_op);
     }
 
     // Textures
     for (unsigned i = 0; i < ARRAY_SIZE(texture_units); ++i) {
-        if (texture_units[i].texture_2d != cur_state.texture_units[i].texture_2d) {
-            glActiveTexture(GL_TEXTURE0 + i);
+        if (changed(texture_units[i].texture_2d != cur_state.texture_units[i].texture_2d)) {
+            SetActiveTextureUnit(GL_TEXTURE0 + i);
             glBindTexture(GL_TEXTURE_2D, texture_units[i].texture_2d);
         }
-        if (texture_units[i].sampler != cur_state.texture_units[i].sampler) {
+        if (changed(texture_units[i].sampler != cur_state.texture_units[i].sampler)) {
             glBindSampler(i, texture_units[i].sampler);
         }
     }
 
     // Lighting LUTs
     for (unsigned i = 0; i < ARRAY_SIZE(lighting_luts); ++i) {
-        if (lighting_luts[i].texture_1d != cur_state.lighting_luts[i].texture_1d) {
-            glActiveTexture(GL_TEXTURE3 + i);
+        if (changed(lighting_luts[i].texture_1d != cur_state.lighting_luts[i].texture_1d)) {
+            SetActiveTextureUnit(GL_TEXTURE3 + i);
             glBindTexture(GL_TEXTURE_1D, lighting_luts[i].texture_1d);
         }
     }
 
     // Fog LUT
-    if (fog_lut.texture_1d != cur_state.fog_lut.texture_1d) {
-        glActiveTexture(GL_TEXTURE9);
+    if (changed(fog_lut.texture_1d != cur_state.fog_lut.texture_1d)) {
+        SetActiveTextureUnit(GL_TEXTURE9);
         glBindTexture(GL_TEXTURE_1D, fog_lut.texture_1d);
     }
 
     // Framebuffer
-    if (draw.read_framebuffer != cur_state.draw.read_framebuffer) {
+    if (changed(draw.read_framebuffer != cur_state.draw.read_framebuffer)) {
         glBindFramebuffer(GL_READ_FRAMEBUFFER, draw.read_framebuffer);
     }
-    if (draw.draw_framebuffer != cur_state.draw.draw_framebuffer) {
+    if (changed(draw.draw_framebuffer != cur_state.draw.draw_framebuffer)) {
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw.draw_framebuffer);
     }
 
     // Vertex array
-    if (draw.vertex_array != cur_state.draw.vertex_array) {
+    if (changed(draw.vertex_array != cur_state.draw.vertex_array)) {
         glBindVertexArray(draw.vertex_array);
     }
 
     // Vertex buffer
-    if (draw.vertex_buffer != cur_state.draw.vertex_buffer) {
+    if (changed(draw.vertex_buffer != cur_state.draw.vertex_buffer)) {
         glBindBuffer(GL_ARRAY_BUFFER, draw.vertex_buffer);
     }
 
     // Uniform buffer
-    if (draw.uniform_buffer != cur_state.draw.uniform_buffer) {
+    if (changed(draw.uniform_buffer != cur_state.draw.uniform_buffer)) {
         glBindBuffer(GL_UNIFORM_BUFFER, draw.uniform_buffer);
     }
 
     // Shader program
-    if (draw.shader_program != cur_state.draw.shader_program) {
+    if (changed(draw.shader_program != cur_state.draw.shader_program)) {
         glUseProgram(draw.shader_program);
     }
 
     cur_state = *this;
 }
 
+OpenGLState::Stats OpenGLState::GetAndResetStats() {
+    Stats result = stats;
+    stats = Stats();
+    return result;
+}
+
+void OpenGLState::SetActiveTextureUnit(GLenum texture_unit) {
+    if (texture_unit == active_texture_unit) {
+        ++stats.calls_filtered;
+        return;
+    }
+
+    ++stats.calls_emitted;
+    active_texture_unit = texture_unit;
+    glActiveTexture(texture_unit);
+}
+
 GLenum OpenGLState::CheckFBStatus(GLenum target) {
     GLenum fb_status = glCheckFramebufferStatus(target);
     if (fb_status != GL_FRAMEBUFFER_COMPLETE) {
@@ -6,6 +6,8 @@
 
 #include <glad/glad.h>
 
+#include "common/common_types.h"
+
 class OpenGLState {
 public:
     struct {
@@ -90,6 +92,18 @@ public:
     /// Apply this state as the current OpenGL state
     void Apply() const;
 
+    /// Counts state changes emitted to the driver and redundant ones filtered by the shadow
+    struct Stats {
+        u64 calls_emitted = 0;
+        u64 calls_filtered = 0;
+    };
+
+    /// Returns the call counters accumulated since the last query and resets them
+    static Stats GetAndResetStats();
+
+    /// Makes the given texture unit active, skipping the call if it already is
+    static void SetActiveTextureUnit(GLenum texture_unit);
+
     /// Check the status of the current OpenGL read or draw framebuffer configuration
     static GLenum CheckFBStatus(GLenum target);
 
@@ -103,4 +117,6 @@ public:
 
 private:
     static OpenGLState cur_state;
+    static GLenum active_texture_unit; // GL_ACTIVE_TEXTURE
+    static Stats stats;
 };
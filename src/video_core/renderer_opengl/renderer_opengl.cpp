@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdlib>
 #include <memory>
@@ -13,8 +14,11 @@
 #include "common/bit_field.h"
 #include "common/emu_window.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/profiler_reporting.h"
 #include "common/synchronized_wrapper.h"
+#include "common/telemetry.h"
+#include "common/thread_topology.h"
 
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
@@ -24,6 +28,7 @@
 #include "core/tracer/recorder.h"
 
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pipeline_stats.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
@@ -104,6 +109,50 @@ RendererOpenGL::RendererOpenGL() {
 
 /// RendererOpenGL destructor
 RendererOpenGL::~RendererOpenGL() {
+    if (frame_time_queries[0] != 0)
+        glDeleteQueries((GLsizei)frame_time_queries.size(), frame_time_queries.data());
+}
+
+/// Records input-to-present latency for the oldest input delivered to HID before this present
+static void RecordInputLatency(EmuWindow* window) {
+    const u64 input_timestamp_us = window->ConsumeDeliveredInputTimestamp();
+    if (input_timestamp_us == 0)
+        return;
+
+    const u64 now_us = static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    Common::Telemetry::Record(Common::Telemetry::Stage::Input,
+                              std::chrono::microseconds(now_us - input_timestamp_us));
+}
+
+void RendererOpenGL::BeginFrameTimeQuery() {
+    if (!VideoCore::g_dynamic_resolution_enabled)
+        return;
+
+    if (frame_time_queries[0] == 0)
+        glGenQueries((GLsizei)frame_time_queries.size(), frame_time_queries.data());
+
+    glBeginQuery(GL_TIME_ELAPSED, frame_time_queries[frame_time_query_index]);
+    frame_time_query_active = true;
+}
+
+void RendererOpenGL::EndFrameTimeQuery() {
+    if (!frame_time_query_active)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    frame_time_query_used[frame_time_query_index] = true;
+    frame_time_query_index = (frame_time_query_index + 1) % frame_time_queries.size();
+    frame_time_query_active = false;
+
+    // The next slot holds the oldest pending query; it has had the whole ring's worth of
+    // frames to complete, so this read rarely stalls
+    if (frame_time_query_used[frame_time_query_index]) {
+        GLuint64 elapsed_ns = 0;
+        glGetQueryObjectui64v(frame_time_queries[frame_time_query_index], GL_QUERY_RESULT, &elapsed_ns);
+        frame_time_query_used[frame_time_query_index] = false;
+        VideoCore::ReportGPUFrameTime(elapsed_ns / 1000);
+    }
 }
 
 /// Swap buffers (render frame)
@@ -112,6 +161,10 @@ void RendererOpenGL::SwapBuffers() {
     OpenGLState prev_state = OpenGLState::GetCurState();
     state.Apply();
 
+    // Close out the query started at the end of the previous SwapBuffers; it covers all GPU
+    // work submitted on this context since then
+    EndFrameTimeQuery();
+
     for (int i : {0, 1}) {
         const auto& framebuffer = GPU::g_regs.framebuffer_config[i];
 
@@ -144,7 +197,76 @@ void RendererOpenGL::SwapBuffers() {
         }
     }
 
-    DrawScreens();
+    if (use_present_thread) {
+        // Pick a handover texture that is neither queued nor currently being presented
+        int index;
+        {
+            std::lock_guard<std::mutex> lock(present_mutex);
+            index = 0;
+            while (index == pending_frame.index || index == presenting_index) {
+                ++index;
+            }
+        }
+
+        auto layout = render_window->GetFramebufferLayout();
+        if (present_texture_width[index] != layout.width ||
+            present_texture_height[index] != layout.height) {
+            state.texture_units[0].texture_2d = present_textures[index].handle;
+            state.Apply();
+            OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
+
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, layout.width, layout.height, 0,
+                         GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+
+            state.texture_units[0].texture_2d = 0;
+            state.Apply();
+
+            present_texture_width[index] = layout.width;
+            present_texture_height[index] = layout.height;
+        }
+
+        // Composite the screens into the handover texture instead of the default
+        // framebuffer; the presentation thread takes it from there
+        state.draw.draw_framebuffer = present_fbo.handle;
+        state.Apply();
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               present_textures[index].handle, 0);
+
+        {
+            Common::Telemetry::ScopedSample draw_sample(Common::Telemetry::Stage::Draw);
+            DrawScreens();
+        }
+
+        // Capture from the handover texture; its contents match what the presentation
+        // thread will put on screen
+        frame_capture.OnFrameRendered(present_fbo.handle, layout.width, layout.height);
+
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // The fence has to reach the GPU for the other context's wait to ever complete
+        glFlush();
+
+        state.draw.draw_framebuffer = 0;
+        state.Apply();
+
+        {
+            std::lock_guard<std::mutex> lock(present_mutex);
+            if (pending_frame.fence != nullptr) {
+                // The previous frame was never picked up; drop it rather than stalling
+                glDeleteSync(pending_frame.fence);
+            }
+            pending_frame = { present_textures[index].handle, fence, index,
+                              layout.width, layout.height };
+        }
+        present_cv.notify_one();
+    } else {
+        {
+            Common::Telemetry::ScopedSample draw_sample(Common::Telemetry::Stage::Draw);
+            DrawScreens();
+        }
+
+        auto layout = render_window->GetFramebufferLayout();
+        frame_capture.OnFrameRendered(0, layout.width, layout.height);
+    }
 
     auto& profiler = Common::Profiling::GetProfilingManager();
     profiler.FinishFrame();
@@ -155,10 +277,39 @@ void RendererOpenGL::SwapBuffers() {
 
     // Swap buffers
     render_window->PollEvents();
-    render_window->SwapBuffers();
+    if (!use_present_thread) {
+        {
+            Common::Telemetry::ScopedSample present_sample(Common::Telemetry::Stage::Present);
+            render_window->SwapBuffers();
+        }
+        RecordInputLatency(render_window);
+    }
 
     prev_state.Apply();
 
+    OpenGLState::Stats state_stats = OpenGLState::GetAndResetStats();
+    LOG_TRACE(Render_OpenGL, "GL state changes this frame: %llu emitted, %llu filtered as redundant",
+              (unsigned long long)state_stats.calls_emitted,
+              (unsigned long long)state_stats.calls_filtered);
+
+    VideoCore::PipelineStats pipeline_stats = VideoCore::GetAndResetPipelineStats();
+    LOG_TRACE(Render_OpenGL,
+              "Pipeline this frame: %llu verts shaded / %llu cache hits, "
+              "tris %llu in / %llu clipped / %llu rasterized, "
+              "pixels %llu shaded / %llu early-rejected",
+              (unsigned long long)pipeline_stats.vertices_shaded,
+              (unsigned long long)pipeline_stats.vertex_cache_hits,
+              (unsigned long long)pipeline_stats.triangles_submitted,
+              (unsigned long long)pipeline_stats.triangles_clipped,
+              (unsigned long long)pipeline_stats.triangles_rasterized,
+              (unsigned long long)pipeline_stats.pixels_shaded,
+              (unsigned long long)pipeline_stats.pixels_early_rejected);
+
+    // Frame boundary: no draw is in flight, so evicting cache entries here is safe
+    Common::MemoryAccounting::EnforceBudget();
+
+    BeginFrameTimeQuery();
+
     profiler.BeginFrame();
 
     RefreshRasterizerSetting();
@@ -204,7 +355,7 @@ void RendererOpenGL::LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& fram
         state.texture_units[0].texture_2d = screen_info.texture.resource.handle;
         state.Apply();
 
-        glActiveTexture(GL_TEXTURE0);
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)pixel_stride);
 
         // Update existing texture
@@ -232,7 +383,7 @@ void RendererOpenGL::LoadColorToActiveGLTexture(u8 color_r, u8 color_g, u8 color
     state.texture_units[0].texture_2d = texture.resource.handle;
     state.Apply();
 
-    glActiveTexture(GL_TEXTURE0);
+    OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
     u8 framebuffer_data[3] = { color_r, color_g, color_b };
 
     // Update existing texture
@@ -275,6 +426,21 @@ void RendererOpenGL::InitOpenGLObjects() {
     glEnableVertexAttribArray(attrib_position);
     glEnableVertexAttribArray(attrib_tex_coord);
 
+    // Framebuffer and textures used to hand composited frames to the presentation thread.
+    // Texture storage is allocated lazily once the framebuffer layout is known.
+    present_fbo.Create();
+    for (size_t i = 0; i < present_textures.size(); ++i) {
+        present_textures[i].Create();
+
+        state.texture_units[0].texture_2d = present_textures[i].handle;
+        state.Apply();
+
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    }
+
     // Allocate textures for each screen
     for (auto& screen_info : screen_infos) {
         screen_info.texture.resource.Create();
@@ -285,7 +451,7 @@ void RendererOpenGL::InitOpenGLObjects() {
         state.texture_units[0].texture_2d = screen_info.texture.resource.handle;
         state.Apply();
 
-        glActiveTexture(GL_TEXTURE0);
+        OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -350,7 +516,7 @@ void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
     state.texture_units[0].texture_2d = texture.resource.handle;
     state.Apply();
 
-    glActiveTexture(GL_TEXTURE0);
+    OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
     glTexImage2D(GL_TEXTURE_2D, 0, internal_format, texture.width, texture.height, 0,
             texture.gl_format, texture.gl_type, nullptr);
 
@@ -396,7 +562,7 @@ void RendererOpenGL::DrawScreens() {
     glUniformMatrix3x2fv(uniform_modelview_matrix, 1, GL_FALSE, ortho_matrix.data());
 
     // Bind texture in Texture Unit 0
-    glActiveTexture(GL_TEXTURE0);
+    OpenGLState::SetActiveTextureUnit(GL_TEXTURE0);
     glUniform1i(uniform_color_texture, 0);
 
     DrawSingleScreenRotated(screen_infos[0], (float)layout.top_screen.left, (float)layout.top_screen.top,
@@ -407,6 +573,68 @@ void RendererOpenGL::DrawScreens() {
     m_current_frame++;
 }
 
+/**
+ * Presentation thread entry point. Runs against the window's shared secondary context, so
+ * only raw GL calls may be made here; OpenGLState tracks the main context exclusively.
+ */
+void RendererOpenGL::PresentThreadLoop() {
+    Common::RegisterCurrentThread(Common::ThreadRole::Render, "Present");
+
+    if (!render_window->MakeSharedContextCurrent()) {
+        LOG_CRITICAL(Render_OpenGL, "Failed to make shared context current on presentation thread!");
+        Common::UnregisterCurrentThread();
+        return;
+    }
+
+    // Framebuffer objects aren't shared across contexts, so the blit source FBO has to be
+    // created here rather than reusing one of the renderer's
+    GLuint blit_fbo;
+    glGenFramebuffers(1, &blit_fbo);
+
+    while (true) {
+        PendingFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(present_mutex);
+            present_cv.wait(lock, [this] {
+                return pending_frame.fence != nullptr || present_thread_exit;
+            });
+            if (present_thread_exit)
+                break;
+
+            frame = pending_frame;
+            pending_frame = PendingFrame();
+            presenting_index = frame.index;
+        }
+
+        // Wait on the GPU timeline for the emulation context's compositing to finish; the
+        // emulation thread itself never blocks on this
+        glWaitSync(frame.fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(frame.fence);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, blit_fbo);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               frame.texture, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, frame.width, frame.height, 0, 0, frame.width, frame.height,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+        {
+            Common::Telemetry::ScopedSample present_sample(Common::Telemetry::Stage::Present);
+            render_window->SwapBuffers();
+        }
+        RecordInputLatency(render_window);
+
+        {
+            std::lock_guard<std::mutex> lock(present_mutex);
+            presenting_index = -1;
+        }
+    }
+
+    glDeleteFramebuffers(1, &blit_fbo);
+    render_window->DoneSharedContextCurrent();
+    Common::UnregisterCurrentThread();
+}
+
 /// Updates the framerate
 void RendererOpenGL::UpdateFramerate() {
 }
@@ -487,11 +715,39 @@ bool RendererOpenGL::Init() {
 
     InitOpenGLObjects();
 
+    frame_capture.Init();
+
     RefreshRasterizerSetting();
 
+    // Present on a separate thread if the frontend can provide a second context sharing
+    // objects with the main one; otherwise (e.g. the Qt frontend) present synchronously
+    if (render_window->MakeSharedContextCurrent()) {
+        render_window->DoneSharedContextCurrent();
+        render_window->MakeCurrent();
+
+        use_present_thread = true;
+        present_thread = std::thread(&RendererOpenGL::PresentThreadLoop, this);
+    }
+
     return true;
 }
 
 /// Shutdown the renderer
 void RendererOpenGL::ShutDown() {
+    frame_capture.Shutdown();
+
+    if (present_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(present_mutex);
+            present_thread_exit = true;
+        }
+        present_cv.notify_one();
+        present_thread.join();
+
+        std::lock_guard<std::mutex> lock(present_mutex);
+        if (pending_frame.fence != nullptr) {
+            glDeleteSync(pending_frame.fence);
+            pending_frame = PendingFrame();
+        }
+    }
 }
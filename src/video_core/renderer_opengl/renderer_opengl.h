@@ -5,6 +5,9 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include <glad/glad.h>
 
@@ -14,6 +17,7 @@
 #include "core/hw/gpu.h"
 
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_frame_capture.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 
@@ -57,6 +61,20 @@ public:
     /// Shutdown the renderer
     void ShutDown() override;
 
+    /// Saves the next presented frame to the given file
+    void RequestScreenshot(const std::string& path) override {
+        frame_capture.RequestScreenshot(path);
+    }
+
+    /// Starts dumping every presented frame as a numbered file under the given directory
+    bool StartVideoDump(const std::string& path) override {
+        return frame_capture.StartVideoDump(path);
+    }
+
+    void StopVideoDump() override {
+        frame_capture.StopVideoDump();
+    }
+
 private:
     void InitOpenGLObjects();
     void ConfigureFramebufferTexture(TextureInfo& texture,
@@ -65,6 +83,18 @@ private:
     void DrawSingleScreenRotated(const ScreenInfo& screen_info, float x, float y, float w, float h);
     void UpdateFramerate();
 
+    /// Starts a GL_TIME_ELAPSED query covering the frame's GPU work (no-op unless dynamic
+    /// resolution is enabled)
+    void BeginFrameTimeQuery();
+
+    /// Ends the active frame time query and reports the oldest completed result to the
+    /// dynamic resolution controller
+    void EndFrameTimeQuery();
+
+    /// Runs on the presentation thread: waits for composited frames and presents them,
+    /// so vsync and compositor stalls no longer block the emulation thread
+    void PresentThreadLoop();
+
     // Loads framebuffer from emulated memory into the display information structure
     void LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& framebuffer,
                              ScreenInfo& screen_info);
@@ -90,4 +120,40 @@ private:
     // Shader attribute input indices
     GLuint attrib_position;
     GLuint attrib_tex_coord;
+
+    /// A composited frame handed over to the presentation thread; the fence guards the
+    /// texture contents across the two contexts
+    struct PendingFrame {
+        GLuint texture = 0;
+        GLsync fence = nullptr;
+        int index = -1;
+        unsigned width = 0;
+        unsigned height = 0;
+    };
+
+    // Decoupled presentation: SwapBuffers composites the screens into one of three
+    // handover textures and queues it; the presentation thread blits it to the window
+    // on the shared secondary context. Unused when the frontend has no such context.
+    bool use_present_thread = false;
+    std::thread present_thread;
+    std::mutex present_mutex;
+    std::condition_variable present_cv;
+    bool present_thread_exit = false;
+    PendingFrame pending_frame;
+    int presenting_index = -1;
+    std::array<OGLTexture, 3> present_textures;
+    std::array<unsigned, 3> present_texture_width{};
+    std::array<unsigned, 3> present_texture_height{};
+    OGLFramebuffer present_fbo;
+
+    // GPU frame time measurement for dynamic resolution: a small ring of GL_TIME_ELAPSED
+    // queries bracketing each frame's GPU work on the main context. Results are read back
+    // a whole ring late, so the fetch almost never stalls.
+    std::array<GLuint, 4> frame_time_queries{};
+    std::array<bool, 4> frame_time_query_used{};
+    size_t frame_time_query_index = 0;
+    bool frame_time_query_active = false;
+
+    /// Asynchronous screenshot/video capture of composited frames
+    FrameCapture frame_capture;
 };
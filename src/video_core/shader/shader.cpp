@@ -5,6 +5,7 @@
 #include <atomic>
 #include <cmath>
 #include <cstring>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 
@@ -83,33 +84,72 @@ OutputVertex OutputRegisters::ToVertex(const Regs::ShaderConfig& config) {
 }
 
 #ifdef ARCHITECTURE_x86_64
-static std::unordered_map<u64, std::unique_ptr<JitShader>> shader_map;
-static const JitShader* jit_shader;
+/// A compiled program together with its position in the LRU order
+struct CachedJitShader {
+    std::shared_ptr<JitShader> shader;
+    u64 last_bound; ///< Value of shader_bind_counter when this program was last bound
+};
+
+// Compiled programs are shared process-wide, keyed by code+swizzle hash, and all live in one
+// contiguous executable arena (see shader_jit_x64.h). Once the arena's MAX_CACHED_SHADERS slots
+// are taken, the least recently bound program that nothing still references is evicted; programs
+// a setup still holds keep their slot until the last reference drops.
+static std::unordered_map<u64, CachedJitShader> shader_map;
+static u64 shader_bind_counter;
+static std::shared_ptr<JitShader> jit_shader;
+
+static void EvictLeastRecentlyBoundShader() {
+    while (shader_map.size() >= MAX_CACHED_SHADERS) {
+        auto victim = shader_map.end();
+        for (auto it = shader_map.begin(); it != shader_map.end(); ++it) {
+            if (it->second.shader.use_count() > 1)
+                continue;
+            if (victim == shader_map.end() || it->second.last_bound < victim->second.last_bound)
+                victim = it;
+        }
+        if (victim == shader_map.end()) {
+            LOG_WARNING(HW_GPU, "Every cached shader program is still referenced; cannot evict");
+            return;
+        }
+        shader_map.erase(victim);
+    }
+}
 #endif // ARCHITECTURE_x86_64
 
 void ClearCache() {
 #ifdef ARCHITECTURE_x86_64
+    jit_shader = nullptr;
     shader_map.clear();
 #endif // ARCHITECTURE_x86_64
+    ClearInterpreterCache();
 }
 
 void ShaderSetup::Setup() {
+    u64 cache_key = g_state.vs.GetProgramCodeHash() ^ g_state.vs.GetSwizzleDataHash();
+
 #ifdef ARCHITECTURE_x86_64
     if (VideoCore::g_shader_jit_enabled) {
-        u64 cache_key = (Common::ComputeHash64(&g_state.vs.program_code, sizeof(g_state.vs.program_code)) ^
-            Common::ComputeHash64(&g_state.vs.swizzle_data, sizeof(g_state.vs.swizzle_data)));
-
-        auto iter = shader_map.find(cache_key);
+        // The JIT bakes the integer uniforms driving LOOP trip counts into the generated code,
+        // so they are part of a compiled program's identity. The interpreter cache below keys
+        // on the shader code alone.
+        u64 jit_cache_key = cache_key ^ GetLoopUniformsKey(g_state.vs.GetProgramCodeHash());
+        auto iter = shader_map.find(jit_cache_key);
         if (iter != shader_map.end()) {
-            jit_shader = iter->second.get();
+            iter->second.last_bound = ++shader_bind_counter;
+            jit_shader = iter->second.shader;
         } else {
-            auto shader = std::make_unique<JitShader>();
+            EvictLeastRecentlyBoundShader();
+            auto shader = std::make_shared<JitShader>();
             shader->Compile();
-            jit_shader = shader.get();
-            shader_map[cache_key] = std::move(shader);
+            jit_shader = shader;
+            shader_map[jit_cache_key] = { std::move(shader), ++shader_bind_counter };
         }
     }
 #endif // ARCHITECTURE_x86_64
+
+    // Keep the interpreter's pre-decoded copy of the program in sync even when the JIT is
+    // active, since the shader debugger always goes through the interpreter.
+    PrepareInterpreterProgram(cache_key);
 }
 
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
@@ -143,6 +183,46 @@ void ShaderSetup::Run(UnitState<false>& state, const InputVertex& input, int num
 
 }
 
+void ShaderSetup::RunBatch(UnitState<false>& state, const InputVertex* input,
+                           OutputRegisters* output, unsigned num_vertices, int num_attributes) {
+    auto& config = g_state.regs.vs;
+    auto& setup = g_state.vs;
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    state.debug.max_offset = 0;
+    state.debug.max_opdesc_id = 0;
+
+    // Resolve the attribute-to-register mapping once for the whole batch
+    const auto& attribute_register_map = config.input_register_map;
+    Math::Vec4<float24>* input_registers[16];
+    for (int i = 0; i < num_attributes; i++)
+        input_registers[i] = &state.registers.input[attribute_register_map.GetRegisterForAttribute(i)];
+
+#ifdef ARCHITECTURE_x86_64
+    const bool use_jit = VideoCore::g_shader_jit_enabled;
+#endif // ARCHITECTURE_x86_64
+
+    for (unsigned vertex = 0; vertex < num_vertices; ++vertex) {
+        for (int i = 0; i < num_attributes; i++)
+            *input_registers[i] = input[vertex].attr[i];
+
+        state.conditional_code[0] = false;
+        state.conditional_code[1] = false;
+
+#ifdef ARCHITECTURE_x86_64
+        if (use_jit)
+            jit_shader->Run(setup, state, config.main_offset);
+        else
+            RunInterpreter(setup, state, config.main_offset);
+#else
+        RunInterpreter(setup, state, config.main_offset);
+#endif // ARCHITECTURE_x86_64
+
+        output[vertex] = state.output_registers;
+    }
+}
+
 DebugData<true> ShaderSetup::ProduceDebugInfo(const InputVertex& input, int num_attributes, const Regs::ShaderConfig& config, const ShaderSetup& setup) {
     UnitState<true> state;
 
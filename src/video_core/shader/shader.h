@@ -17,6 +17,7 @@
 #include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/vector_math.h"
 
 #include "video_core/pica.h"
@@ -353,6 +354,82 @@ struct ShaderSetup {
     std::array<u32, 1024> program_code;
     std::array<u32, 1024> swizzle_data;
 
+    /// The float uniforms are hashed in blocks of this many vectors (see GetUniformsHash)
+    static const unsigned FLOAT_UNIFORM_BLOCK_SIZE = 8;
+    static const unsigned NUM_FLOAT_UNIFORM_BLOCKS = 96 / FLOAT_UNIFORM_BLOCK_SIZE;
+
+    /// Tells the hash accessors below that the corresponding state block was written.
+    void MarkProgramCodeDirty() { program_code_dirty = true; }
+    void MarkSwizzleDataDirty() { swizzle_data_dirty = true; }
+
+    /// Marks a single float uniform vector as written, dirtying only its hash block
+    void MarkFloatUniformDirty(unsigned index) {
+        uniforms_dirty = true;
+        float_uniform_block_dirty[index / FLOAT_UNIFORM_BLOCK_SIZE] = true;
+    }
+
+    /// Marks the integer/boolean uniform block as written
+    void MarkIntBoolUniformsDirty() {
+        uniforms_dirty = true;
+        int_bool_uniforms_dirty = true;
+    }
+
+    /// Marks every uniform as written; use the ranged variants above where possible
+    void MarkUniformsDirty() {
+        uniforms_dirty = true;
+        int_bool_uniforms_dirty = true;
+        float_uniform_block_dirty.fill(true);
+    }
+
+    /// Invalidates all cached hashes; must be called after the setup is wholesale overwritten.
+    void MarkAllDirty() {
+        program_code_dirty = swizzle_data_dirty = true;
+        MarkUniformsDirty();
+    }
+
+    /// Hash over program_code, recomputed only after a write since the last call
+    u64 GetProgramCodeHash() {
+        if (program_code_dirty) {
+            program_code_hash = Common::ComputeHash64(program_code.data(), sizeof(program_code));
+            program_code_dirty = false;
+        }
+        return program_code_hash;
+    }
+
+    /// Hash over swizzle_data, recomputed only after a write since the last call
+    u64 GetSwizzleDataHash() {
+        if (swizzle_data_dirty) {
+            swizzle_data_hash = Common::ComputeHash64(swizzle_data.data(), sizeof(swizzle_data));
+            swizzle_data_dirty = false;
+        }
+        return swizzle_data_hash;
+    }
+
+    /// Hash over uniforms, combined from per-span hashes so that a draw that only
+    /// touched a few uniform vectors re-hashes those spans rather than the whole block
+    u64 GetUniformsHash() {
+        if (uniforms_dirty) {
+            for (unsigned block = 0; block < NUM_FLOAT_UNIFORM_BLOCKS; ++block) {
+                if (!float_uniform_block_dirty[block])
+                    continue;
+                float_uniform_block_hashes[block] = Common::ComputeHash64(
+                    &uniforms.f[block * FLOAT_UNIFORM_BLOCK_SIZE],
+                    FLOAT_UNIFORM_BLOCK_SIZE * sizeof(uniforms.f[0]));
+                float_uniform_block_dirty[block] = false;
+            }
+            if (int_bool_uniforms_dirty) {
+                int_bool_uniforms_hash = Common::ComputeHash64(uniforms.b.data(), sizeof(uniforms.b)) ^
+                                         Common::ComputeHash64(uniforms.i.data(), sizeof(uniforms.i));
+                int_bool_uniforms_dirty = false;
+            }
+            uniforms_hash = Common::ComputeHash64(float_uniform_block_hashes.data(),
+                                                  sizeof(float_uniform_block_hashes)) ^
+                            int_bool_uniforms_hash;
+            uniforms_dirty = false;
+        }
+        return uniforms_hash;
+    }
+
     /**
      * Performs any shader unit setup that only needs to happen once per shader (as opposed to once per
      * vertex, which would happen within the `Run` function).
@@ -367,6 +444,19 @@ struct ShaderSetup {
      */
     void Run(UnitState<false>& state, const InputVertex& input, int num_attributes);
 
+    /**
+     * Runs the currently setup shader over a batch of input vertices. The attribute-to-register
+     * mapping and the choice of execution engine are resolved once for the whole batch, so this
+     * amortizes the per-vertex dispatch overhead of `Run` across the batch.
+     * @param state Shader unit state, must be setup per shader and per shader unit
+     * @param input Array of `num_vertices` input vertices
+     * @param output Array of `num_vertices` output register sets to be filled in
+     * @param num_vertices The number of vertices in the batch
+     * @param num_attributes The number of vertex shader attributes
+     */
+    void RunBatch(UnitState<false>& state, const InputVertex* input, OutputRegisters* output,
+                  unsigned num_vertices, int num_attributes);
+
     /**
      * Produce debug information based on the given shader and input vertex
      * @param input Input vertex into the shader
@@ -377,6 +467,20 @@ struct ShaderSetup {
      */
     DebugData<true> ProduceDebugInfo(const InputVertex& input, int num_attributes, const Regs::ShaderConfig& config, const ShaderSetup& setup);
 
+    // Backing state for the cached hashes above. Kept public so the struct stays
+    // standard-layout for the offsetof-based JIT accessors; use the accessors instead
+    // of touching these directly.
+    u64 program_code_hash = 0;
+    u64 swizzle_data_hash = 0;
+    u64 uniforms_hash = 0;
+    u64 int_bool_uniforms_hash = 0;
+    std::array<u64, NUM_FLOAT_UNIFORM_BLOCKS> float_uniform_block_hashes{};
+    bool program_code_dirty = true;
+    bool swizzle_data_dirty = true;
+    bool uniforms_dirty = true;
+    bool int_bool_uniforms_dirty = true;
+    std::array<bool, NUM_FLOAT_UNIFORM_BLOCKS> float_uniform_block_dirty{{
+        true, true, true, true, true, true, true, true, true, true, true, true}};
 };
 
 } // namespace Shader
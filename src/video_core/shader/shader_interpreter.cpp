@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <memory>
 #include <numeric>
+#include <unordered_map>
 
 #include <nihstro/shader_bytecode.h>
 
@@ -40,6 +42,181 @@ struct CallStackElement {
     u32 loop_address;   // The address where we'll return to after each loop iteration
 };
 
+/**
+ * One shader instruction in unpacked form: the opcode is resolved, swizzle selectors and
+ * negation flags are expanded from the operand descriptor, and flow control fields are
+ * extracted, so none of this bitfield decoding has to be repeated per executed instruction.
+ */
+struct MicroOp {
+    OpCode::Id opcode;
+    OpCode::Type type;
+
+    // Arithmetic / multiply-add operands. The address register offset only ever applies to
+    // one source; the masks bake in which one (mirroring the is_inverted selection).
+    SourceRegister src1;
+    SourceRegister src2;
+    SourceRegister src3;
+    u8 src1_addr_mask;
+    u8 src2_addr_mask;
+    u8 src3_addr_mask;
+    u8 address_register_index;
+
+    u8 src1_selector[4];
+    u8 src2_selector[4];
+    u8 src3_selector[4];
+    bool negate_src1;
+    bool negate_src2;
+    bool negate_src3;
+    bool dest_enabled[4];
+
+    enum class DestBank : u8 {
+        Output,
+        Temporary,
+        None,
+    };
+    DestBank dest_bank;
+    u8 dest_index;
+    u32 operand_desc_id;
+
+    Instruction::Common::CompareOpType compare_op_x;
+    Instruction::Common::CompareOpType compare_op_y;
+
+    // Flow control fields
+    u32 dest_offset;
+    u32 num_instructions;
+    u8 bool_uniform_id;
+    u8 int_uniform_id;
+    bool refx;
+    bool refy;
+    Instruction::FlowControlType::Op flow_op;
+
+    u32 hex; // Raw instruction word, kept for error reporting
+};
+
+/// A full shader program pre-decoded into MicroOps, indexed by instruction offset
+struct PrecompiledProgram {
+    std::array<MicroOp, 1024> ops;
+};
+
+static std::unordered_map<u64, std::unique_ptr<PrecompiledProgram>> program_map;
+static const PrecompiledProgram* current_program = nullptr;
+
+static MicroOp DecodeInstruction(const std::array<u32, 1024>& program_code,
+                                 const std::array<u32, 1024>& swizzle_data, u32 offset) {
+    const Instruction instr = { program_code[offset] };
+
+    MicroOp op = {};
+    op.hex = instr.hex;
+    op.opcode = instr.opcode.Value().EffectiveOpCode();
+    op.type = instr.opcode.Value().GetInfo().type;
+
+    switch (op.type) {
+    case OpCode::Type::Arithmetic:
+    {
+        const SwizzlePattern swizzle = { swizzle_data[instr.common.operand_desc_id] };
+        const bool is_inverted = (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+        op.src1 = instr.common.GetSrc1(is_inverted);
+        op.src2 = instr.common.GetSrc2(is_inverted);
+        op.src1_addr_mask = !is_inverted;
+        op.src2_addr_mask = is_inverted;
+        op.address_register_index = static_cast<u8>(instr.common.address_register_index);
+
+        for (int i = 0; i < 4; ++i) {
+            op.src1_selector[i] = static_cast<u8>(swizzle.GetSelectorSrc1(i));
+            op.src2_selector[i] = static_cast<u8>(swizzle.GetSelectorSrc2(i));
+            op.dest_enabled[i] = swizzle.DestComponentEnabled(i);
+        }
+        op.negate_src1 = ((bool)swizzle.negate_src1 != false);
+        op.negate_src2 = ((bool)swizzle.negate_src2 != false);
+
+        if (instr.common.dest.Value() < 0x10) {
+            op.dest_bank = MicroOp::DestBank::Output;
+            op.dest_index = static_cast<u8>(instr.common.dest.Value().GetIndex());
+        } else if (instr.common.dest.Value() < 0x20) {
+            op.dest_bank = MicroOp::DestBank::Temporary;
+            op.dest_index = static_cast<u8>(instr.common.dest.Value().GetIndex());
+        } else {
+            op.dest_bank = MicroOp::DestBank::None;
+        }
+        op.operand_desc_id = instr.common.operand_desc_id;
+
+        op.compare_op_x = instr.common.compare_op.x.Value();
+        op.compare_op_y = instr.common.compare_op.y.Value();
+        break;
+    }
+
+    case OpCode::Type::MultiplyAdd:
+    {
+        const SwizzlePattern swizzle = { swizzle_data[instr.mad.operand_desc_id] };
+        const bool is_inverted = (op.opcode == OpCode::Id::MADI);
+
+        op.src1 = instr.mad.GetSrc1(is_inverted);
+        op.src2 = instr.mad.GetSrc2(is_inverted);
+        op.src3 = instr.mad.GetSrc3(is_inverted);
+        op.src2_addr_mask = !is_inverted;
+        op.src3_addr_mask = is_inverted;
+        op.address_register_index = static_cast<u8>(instr.mad.address_register_index);
+
+        for (int i = 0; i < 4; ++i) {
+            op.src1_selector[i] = static_cast<u8>(swizzle.GetSelectorSrc1(i));
+            op.src2_selector[i] = static_cast<u8>(swizzle.GetSelectorSrc2(i));
+            op.src3_selector[i] = static_cast<u8>(swizzle.GetSelectorSrc3(i));
+            op.dest_enabled[i] = swizzle.DestComponentEnabled(i);
+        }
+        op.negate_src1 = ((bool)swizzle.negate_src1 != false);
+        op.negate_src2 = ((bool)swizzle.negate_src2 != false);
+        op.negate_src3 = ((bool)swizzle.negate_src3 != false);
+
+        if (instr.mad.dest.Value() < 0x10) {
+            op.dest_bank = MicroOp::DestBank::Output;
+            op.dest_index = static_cast<u8>(instr.mad.dest.Value().GetIndex());
+        } else if (instr.mad.dest.Value() < 0x20) {
+            op.dest_bank = MicroOp::DestBank::Temporary;
+            op.dest_index = static_cast<u8>(instr.mad.dest.Value().GetIndex());
+        } else {
+            op.dest_bank = MicroOp::DestBank::None;
+        }
+        op.operand_desc_id = instr.mad.operand_desc_id;
+        break;
+    }
+
+    default:
+    {
+        op.dest_offset = instr.flow_control.dest_offset;
+        op.num_instructions = instr.flow_control.num_instructions;
+        op.bool_uniform_id = static_cast<u8>(instr.flow_control.bool_uniform_id);
+        op.int_uniform_id = static_cast<u8>(instr.flow_control.int_uniform_id);
+        op.refx = (instr.flow_control.refx != 0);
+        op.refy = (instr.flow_control.refy != 0);
+        op.flow_op = instr.flow_control.op;
+        break;
+    }
+    }
+
+    return op;
+}
+
+void PrepareInterpreterProgram(u64 cache_key) {
+    auto iter = program_map.find(cache_key);
+    if (iter != program_map.end()) {
+        current_program = iter->second.get();
+        return;
+    }
+
+    auto program = std::make_unique<PrecompiledProgram>();
+    for (u32 offset = 0; offset < program->ops.size(); ++offset) {
+        program->ops[offset] = DecodeInstruction(g_state.vs.program_code, g_state.vs.swizzle_data, offset);
+    }
+    current_program = program.get();
+    program_map[cache_key] = std::move(program);
+}
+
+void ClearInterpreterCache() {
+    program_map.clear();
+    current_program = nullptr;
+}
+
 template<bool Debug>
 void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned offset) {
     // TODO: Is there a maximal size for this?
@@ -47,9 +224,9 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
 
     u32 program_counter = offset;
 
+    DEBUG_ASSERT_MSG(current_program != nullptr, "Shader program was not pre-decoded before running");
+    const auto& ops = current_program->ops;
     const auto& uniforms = g_state.vs.uniforms;
-    const auto& swizzle_data = g_state.vs.swizzle_data;
-    const auto& program_code = g_state.vs.program_code;
 
     // Placeholder for invalid inputs
     static float24 dummy_vec4_float24[4];
@@ -74,8 +251,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
             }
         }
 
-        const Instruction instr = { program_code[program_counter] };
-        const SwizzlePattern swizzle = { swizzle_data[instr.common.operand_desc_id] };
+        const MicroOp& op = ops[program_counter];
 
         static auto call = [&program_counter, &call_stack](UnitState<Debug>& state, u32 offset, u32 num_instructions,
                               u32 return_offset, u8 repeat_count, u8 loop_increment) {
@@ -105,59 +281,65 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
             }
         };
 
-        switch (instr.opcode.Value().GetInfo().type) {
-        case OpCode::Type::Arithmetic:
-        {
-            const bool is_inverted = (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+        auto LookupDestRegister = [&](const MicroOp& op) -> float24* {
+            switch (op.dest_bank) {
+            case MicroOp::DestBank::Output:
+                return &state.output_registers.value[op.dest_index][0];
 
-            const int address_offset = (instr.common.address_register_index == 0)
-                                       ? 0 : state.address_registers[instr.common.address_register_index - 1];
+            case MicroOp::DestBank::Temporary:
+                return &state.registers.temporary[op.dest_index][0];
 
-            const float24* src1_ = LookupSourceRegister(instr.common.GetSrc1(is_inverted) + (!is_inverted * address_offset));
-            const float24* src2_ = LookupSourceRegister(instr.common.GetSrc2(is_inverted) + ( is_inverted * address_offset));
+            default:
+                return dummy_vec4_float24;
+            }
+        };
+
+        switch (op.type) {
+        case OpCode::Type::Arithmetic:
+        {
+            const int address_offset = (op.address_register_index == 0)
+                                       ? 0 : state.address_registers[op.address_register_index - 1];
 
-            const bool negate_src1 = ((bool)swizzle.negate_src1 != false);
-            const bool negate_src2 = ((bool)swizzle.negate_src2 != false);
+            const float24* src1_ = LookupSourceRegister(op.src1 + op.src1_addr_mask * address_offset);
+            const float24* src2_ = LookupSourceRegister(op.src2 + op.src2_addr_mask * address_offset);
 
             float24 src1[4] = {
-                src1_[(int)swizzle.GetSelectorSrc1(0)],
-                src1_[(int)swizzle.GetSelectorSrc1(1)],
-                src1_[(int)swizzle.GetSelectorSrc1(2)],
-                src1_[(int)swizzle.GetSelectorSrc1(3)],
+                src1_[op.src1_selector[0]],
+                src1_[op.src1_selector[1]],
+                src1_[op.src1_selector[2]],
+                src1_[op.src1_selector[3]],
             };
-            if (negate_src1) {
+            if (op.negate_src1) {
                 src1[0] = src1[0] * float24::FromFloat32(-1);
                 src1[1] = src1[1] * float24::FromFloat32(-1);
                 src1[2] = src1[2] * float24::FromFloat32(-1);
                 src1[3] = src1[3] * float24::FromFloat32(-1);
             }
             float24 src2[4] = {
-                src2_[(int)swizzle.GetSelectorSrc2(0)],
-                src2_[(int)swizzle.GetSelectorSrc2(1)],
-                src2_[(int)swizzle.GetSelectorSrc2(2)],
-                src2_[(int)swizzle.GetSelectorSrc2(3)],
+                src2_[op.src2_selector[0]],
+                src2_[op.src2_selector[1]],
+                src2_[op.src2_selector[2]],
+                src2_[op.src2_selector[3]],
             };
-            if (negate_src2) {
+            if (op.negate_src2) {
                 src2[0] = src2[0] * float24::FromFloat32(-1);
                 src2[1] = src2[1] * float24::FromFloat32(-1);
                 src2[2] = src2[2] * float24::FromFloat32(-1);
                 src2[3] = src2[3] * float24::FromFloat32(-1);
             }
 
-            float24* dest = (instr.common.dest.Value() < 0x10) ? &state.output_registers.value[instr.common.dest.Value().GetIndex()][0]
-                        : (instr.common.dest.Value() < 0x20) ? &state.registers.temporary[instr.common.dest.Value().GetIndex()][0]
-                        : dummy_vec4_float24;
+            float24* dest = LookupDestRegister(op);
 
-            state.debug.max_opdesc_id = std::max<u32>(state.debug.max_opdesc_id, 1+instr.common.operand_desc_id);
+            state.debug.max_opdesc_id = std::max<u32>(state.debug.max_opdesc_id, 1 + op.operand_desc_id);
 
-            switch (instr.opcode.Value().EffectiveOpCode()) {
+            switch (op.opcode) {
             case OpCode::Id::ADD:
             {
                 Record<DebugDataRecord::SRC1>(state.debug, iteration, src1);
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = src1[i] + src2[i];
@@ -172,7 +354,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = src1[i] * src2[i];
@@ -185,7 +367,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC1>(state.debug, iteration, src1);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = float24::FromFloat32(std::floor(src1[i].ToFloat32()));
@@ -198,7 +380,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     // NOTE: Exact form required to match NaN semantics to hardware:
@@ -214,7 +396,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     // NOTE: Exact form required to match NaN semantics to hardware:
@@ -234,15 +416,14 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
 
-                OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
-                if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
+                if (op.opcode == OpCode::Id::DPH || op.opcode == OpCode::Id::DPHI)
                     src1[3] = float24::FromFloat32(1.0f);
 
-                int num_components = (opcode == OpCode::Id::DP3) ? 3 : 4;
+                int num_components = (op.opcode == OpCode::Id::DP3) ? 3 : 4;
                 float24 dot = std::inner_product(src1, src1 + num_components, src2, float24::FromFloat32(0.f));
 
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = dot;
@@ -258,7 +439,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 float24 rcp_res = float24::FromFloat32(1.0f / src1[0].ToFloat32());
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = rcp_res;
@@ -274,7 +455,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 float24 rsq_res = float24::FromFloat32(1.0f / std::sqrt(src1[0].ToFloat32()));
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = rsq_res;
@@ -287,7 +468,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
             {
                 Record<DebugDataRecord::SRC1>(state.debug, iteration, src1);
                 for (int i = 0; i < 2; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     // TODO: Figure out how the rounding is done on hardware
@@ -302,7 +483,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC1>(state.debug, iteration, src1);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = src1[i];
@@ -317,7 +498,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = (src1[i] >= src2[i]) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
@@ -331,7 +512,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = (src1[i] < src2[i]) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
@@ -345,10 +526,9 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 for (int i = 0; i < 2; ++i) {
                     // TODO: Can you restrict to one compare via dest masking?
 
-                    auto compare_op = instr.common.compare_op;
-                    auto op = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+                    auto compare_op = (i == 0) ? op.compare_op_x : op.compare_op_y;
 
-                    switch (op) {
+                    switch (compare_op) {
                         case Instruction::Common::CompareOpType::Equal:
                             state.conditional_code[i] = (src1[i] == src2[i]);
                             break;
@@ -374,7 +554,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                             break;
 
                         default:
-                            LOG_ERROR(HW_GPU, "Unknown compare mode %x", static_cast<int>(op));
+                            LOG_ERROR(HW_GPU, "Unknown compare mode %x", static_cast<int>(compare_op));
                             break;
                     }
                 }
@@ -389,7 +569,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 // EX2 only takes first component exp2 and writes it to all dest components
                 float24 ex2_res = float24::FromFloat32(std::exp2(src1[0].ToFloat32()));
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = ex2_res;
@@ -407,7 +587,7 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 // LG2 only takes the first component log2 and writes it to all dest components
                 float24 lg2_res = float24::FromFloat32(std::log2(src1[0].ToFloat32()));
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = lg2_res;
@@ -418,8 +598,8 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
             }
 
             default:
-                LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x%02x (%s): 0x%08x",
-                          (int)instr.opcode.Value().EffectiveOpCode(), instr.opcode.Value().GetInfo().name, instr.hex);
+                LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x%02x: 0x%08x",
+                          (int)op.opcode, op.hex);
                 DEBUG_ASSERT(false);
                 break;
             }
@@ -429,147 +609,137 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
 
         case OpCode::Type::MultiplyAdd:
         {
-            if ((instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD) ||
-                (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI)) {
-                const SwizzlePattern& swizzle = *reinterpret_cast<const SwizzlePattern*>(&swizzle_data[instr.mad.operand_desc_id]);
-
-                bool is_inverted = (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI);
-
-                const int address_offset = (instr.mad.address_register_index == 0)
-                                           ? 0 : state.address_registers[instr.mad.address_register_index - 1];
-
-                const float24* src1_ = LookupSourceRegister(instr.mad.GetSrc1(is_inverted));
-                const float24* src2_ = LookupSourceRegister(instr.mad.GetSrc2(is_inverted) + (!is_inverted * address_offset));
-                const float24* src3_ = LookupSourceRegister(instr.mad.GetSrc3(is_inverted) + ( is_inverted * address_offset));
+            if ((op.opcode == OpCode::Id::MAD) ||
+                (op.opcode == OpCode::Id::MADI)) {
+                const int address_offset = (op.address_register_index == 0)
+                                           ? 0 : state.address_registers[op.address_register_index - 1];
 
-                const bool negate_src1 = ((bool)swizzle.negate_src1 != false);
-                const bool negate_src2 = ((bool)swizzle.negate_src2 != false);
-                const bool negate_src3 = ((bool)swizzle.negate_src3 != false);
+                const float24* src1_ = LookupSourceRegister(op.src1);
+                const float24* src2_ = LookupSourceRegister(op.src2 + op.src2_addr_mask * address_offset);
+                const float24* src3_ = LookupSourceRegister(op.src3 + op.src3_addr_mask * address_offset);
 
                 float24 src1[4] = {
-                    src1_[(int)swizzle.GetSelectorSrc1(0)],
-                    src1_[(int)swizzle.GetSelectorSrc1(1)],
-                    src1_[(int)swizzle.GetSelectorSrc1(2)],
-                    src1_[(int)swizzle.GetSelectorSrc1(3)],
+                    src1_[op.src1_selector[0]],
+                    src1_[op.src1_selector[1]],
+                    src1_[op.src1_selector[2]],
+                    src1_[op.src1_selector[3]],
                 };
-                if (negate_src1) {
+                if (op.negate_src1) {
                     src1[0] = src1[0] * float24::FromFloat32(-1);
                     src1[1] = src1[1] * float24::FromFloat32(-1);
                     src1[2] = src1[2] * float24::FromFloat32(-1);
                     src1[3] = src1[3] * float24::FromFloat32(-1);
                 }
                 float24 src2[4] = {
-                    src2_[(int)swizzle.GetSelectorSrc2(0)],
-                    src2_[(int)swizzle.GetSelectorSrc2(1)],
-                    src2_[(int)swizzle.GetSelectorSrc2(2)],
-                    src2_[(int)swizzle.GetSelectorSrc2(3)],
+                    src2_[op.src2_selector[0]],
+                    src2_[op.src2_selector[1]],
+                    src2_[op.src2_selector[2]],
+                    src2_[op.src2_selector[3]],
                 };
-                if (negate_src2) {
+                if (op.negate_src2) {
                     src2[0] = src2[0] * float24::FromFloat32(-1);
                     src2[1] = src2[1] * float24::FromFloat32(-1);
                     src2[2] = src2[2] * float24::FromFloat32(-1);
                     src2[3] = src2[3] * float24::FromFloat32(-1);
                 }
                 float24 src3[4] = {
-                    src3_[(int)swizzle.GetSelectorSrc3(0)],
-                    src3_[(int)swizzle.GetSelectorSrc3(1)],
-                    src3_[(int)swizzle.GetSelectorSrc3(2)],
-                    src3_[(int)swizzle.GetSelectorSrc3(3)],
+                    src3_[op.src3_selector[0]],
+                    src3_[op.src3_selector[1]],
+                    src3_[op.src3_selector[2]],
+                    src3_[op.src3_selector[3]],
                 };
-                if (negate_src3) {
+                if (op.negate_src3) {
                     src3[0] = src3[0] * float24::FromFloat32(-1);
                     src3[1] = src3[1] * float24::FromFloat32(-1);
                     src3[2] = src3[2] * float24::FromFloat32(-1);
                     src3[3] = src3[3] * float24::FromFloat32(-1);
                 }
 
-                float24* dest = (instr.mad.dest.Value() < 0x10) ? &state.output_registers.value[instr.mad.dest.Value().GetIndex()][0]
-                            : (instr.mad.dest.Value() < 0x20) ? &state.registers.temporary[instr.mad.dest.Value().GetIndex()][0]
-                            : dummy_vec4_float24;
+                float24* dest = LookupDestRegister(op);
 
                 Record<DebugDataRecord::SRC1>(state.debug, iteration, src1);
                 Record<DebugDataRecord::SRC2>(state.debug, iteration, src2);
                 Record<DebugDataRecord::SRC3>(state.debug, iteration, src3);
                 Record<DebugDataRecord::DEST_IN>(state.debug, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!op.dest_enabled[i])
                         continue;
 
                     dest[i] = src1[i] * src2[i] + src3[i];
                 }
                 Record<DebugDataRecord::DEST_OUT>(state.debug, iteration, dest);
             } else {
-                LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x%02x (%s): 0x%08x",
-                          (int)instr.opcode.Value().EffectiveOpCode(), instr.opcode.Value().GetInfo().name, instr.hex);
+                LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x%02x: 0x%08x",
+                          (int)op.opcode, op.hex);
             }
             break;
         }
 
         default:
         {
-            static auto evaluate_condition = [](const UnitState<Debug>& state, bool refx, bool refy, Instruction::FlowControlType flow_control) {
-                bool results[2] = { refx == state.conditional_code[0],
-                                    refy == state.conditional_code[1] };
+            static auto evaluate_condition = [](const UnitState<Debug>& state, const MicroOp& op) {
+                bool results[2] = { op.refx == state.conditional_code[0],
+                                    op.refy == state.conditional_code[1] };
 
-                switch (flow_control.op) {
-                case flow_control.Or:
+                switch (op.flow_op) {
+                case Instruction::FlowControlType::Or:
                     return results[0] || results[1];
 
-                case flow_control.And:
+                case Instruction::FlowControlType::And:
                     return results[0] && results[1];
 
-                case flow_control.JustX:
+                case Instruction::FlowControlType::JustX:
                     return results[0];
 
-                case flow_control.JustY:
+                case Instruction::FlowControlType::JustY:
                     return results[1];
                 }
             };
 
             // Handle each instruction on its own
-            switch (instr.opcode.Value()) {
+            switch (op.opcode) {
             case OpCode::Id::END:
                 exit_loop = true;
                 break;
 
             case OpCode::Id::JMPC:
                 Record<DebugDataRecord::COND_CMP_IN>(state.debug, iteration, state.conditional_code);
-                if (evaluate_condition(state, instr.flow_control.refx, instr.flow_control.refy, instr.flow_control)) {
-                    program_counter = instr.flow_control.dest_offset - 1;
+                if (evaluate_condition(state, op)) {
+                    program_counter = op.dest_offset - 1;
                 }
                 break;
 
             case OpCode::Id::JMPU:
-                Record<DebugDataRecord::COND_BOOL_IN>(state.debug, iteration, uniforms.b[instr.flow_control.bool_uniform_id]);
+                Record<DebugDataRecord::COND_BOOL_IN>(state.debug, iteration, uniforms.b[op.bool_uniform_id]);
 
-                if (uniforms.b[instr.flow_control.bool_uniform_id] == !(instr.flow_control.num_instructions & 1)) {
-                    program_counter = instr.flow_control.dest_offset - 1;
+                if (uniforms.b[op.bool_uniform_id] == !(op.num_instructions & 1)) {
+                    program_counter = op.dest_offset - 1;
                 }
                 break;
 
             case OpCode::Id::CALL:
                 call(state,
-                     instr.flow_control.dest_offset,
-                     instr.flow_control.num_instructions,
+                     op.dest_offset,
+                     op.num_instructions,
                      program_counter + 1, 0, 0);
                 break;
 
             case OpCode::Id::CALLU:
-                Record<DebugDataRecord::COND_BOOL_IN>(state.debug, iteration, uniforms.b[instr.flow_control.bool_uniform_id]);
-                if (uniforms.b[instr.flow_control.bool_uniform_id]) {
+                Record<DebugDataRecord::COND_BOOL_IN>(state.debug, iteration, uniforms.b[op.bool_uniform_id]);
+                if (uniforms.b[op.bool_uniform_id]) {
                     call(state,
-                        instr.flow_control.dest_offset,
-                        instr.flow_control.num_instructions,
+                        op.dest_offset,
+                        op.num_instructions,
                         program_counter + 1, 0, 0);
                 }
                 break;
 
             case OpCode::Id::CALLC:
                 Record<DebugDataRecord::COND_CMP_IN>(state.debug, iteration, state.conditional_code);
-                if (evaluate_condition(state, instr.flow_control.refx, instr.flow_control.refy, instr.flow_control)) {
+                if (evaluate_condition(state, op)) {
                     call(state,
-                        instr.flow_control.dest_offset,
-                        instr.flow_control.num_instructions,
+                        op.dest_offset,
+                        op.num_instructions,
                         program_counter + 1, 0, 0);
                 }
                 break;
@@ -578,17 +748,17 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 break;
 
             case OpCode::Id::IFU:
-                Record<DebugDataRecord::COND_BOOL_IN>(state.debug, iteration, uniforms.b[instr.flow_control.bool_uniform_id]);
-                if (uniforms.b[instr.flow_control.bool_uniform_id]) {
+                Record<DebugDataRecord::COND_BOOL_IN>(state.debug, iteration, uniforms.b[op.bool_uniform_id]);
+                if (uniforms.b[op.bool_uniform_id]) {
                     call(state,
                          program_counter + 1,
-                         instr.flow_control.dest_offset - program_counter - 1,
-                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0, 0);
+                         op.dest_offset - program_counter - 1,
+                         op.dest_offset + op.num_instructions, 0, 0);
                 } else {
                     call(state,
-                         instr.flow_control.dest_offset,
-                         instr.flow_control.num_instructions,
-                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0, 0);
+                         op.dest_offset,
+                         op.num_instructions,
+                         op.dest_offset + op.num_instructions, 0, 0);
                 }
 
                 break;
@@ -598,16 +768,16 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
                 // TODO: Do we need to consider swizzlers here?
 
                 Record<DebugDataRecord::COND_CMP_IN>(state.debug, iteration, state.conditional_code);
-                if (evaluate_condition(state, instr.flow_control.refx, instr.flow_control.refy, instr.flow_control)) {
+                if (evaluate_condition(state, op)) {
                     call(state,
                          program_counter + 1,
-                         instr.flow_control.dest_offset - program_counter - 1,
-                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0, 0);
+                         op.dest_offset - program_counter - 1,
+                         op.dest_offset + op.num_instructions, 0, 0);
                 } else {
                     call(state,
-                         instr.flow_control.dest_offset,
-                         instr.flow_control.num_instructions,
-                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0, 0);
+                         op.dest_offset,
+                         op.num_instructions,
+                         op.dest_offset + op.num_instructions, 0, 0);
                 }
 
                 break;
@@ -615,25 +785,25 @@ void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned
 
             case OpCode::Id::LOOP:
             {
-                Math::Vec4<u8> loop_param(uniforms.i[instr.flow_control.int_uniform_id].x,
-                                          uniforms.i[instr.flow_control.int_uniform_id].y,
-                                          uniforms.i[instr.flow_control.int_uniform_id].z,
-                                          uniforms.i[instr.flow_control.int_uniform_id].w);
+                Math::Vec4<u8> loop_param(uniforms.i[op.int_uniform_id].x,
+                                          uniforms.i[op.int_uniform_id].y,
+                                          uniforms.i[op.int_uniform_id].z,
+                                          uniforms.i[op.int_uniform_id].w);
                 state.address_registers[2] = loop_param.y;
 
                 Record<DebugDataRecord::LOOP_INT_IN>(state.debug, iteration, loop_param);
                 call(state,
                      program_counter + 1,
-                     instr.flow_control.dest_offset - program_counter + 1,
-                     instr.flow_control.dest_offset + 1,
+                     op.dest_offset - program_counter + 1,
+                     op.dest_offset + 1,
                      loop_param.x,
                      loop_param.z);
                 break;
             }
 
             default:
-                LOG_ERROR(HW_GPU, "Unhandled instruction: 0x%02x (%s): 0x%08x",
-                          (int)instr.opcode.Value().EffectiveOpCode(), instr.opcode.Value().GetInfo().name, instr.hex);
+                LOG_ERROR(HW_GPU, "Unhandled instruction: 0x%02x: 0x%08x",
+                          (int)op.opcode, op.hex);
                 break;
             }
 
@@ -4,12 +4,24 @@
 
 #pragma once
 
+#include "common/common_types.h"
+
 namespace Pica {
 
 namespace Shader {
 
 template <bool Debug> struct UnitState;
 
+/**
+ * Pre-decodes the currently loaded shader program into an unpacked op array (resolved
+ * opcodes, swizzle selectors and flow control fields), caching the result by program hash.
+ * Must be called whenever the program or swizzle data changes, before RunInterpreter.
+ */
+void PrepareInterpreterProgram(u64 cache_key);
+
+/// Clears the cache of pre-decoded shader programs
+void ClearInterpreterCache();
+
 template<bool Debug>
 void RunInterpreter(const ShaderSetup& setup, UnitState<Debug>& state, unsigned offset);
 
@@ -9,8 +9,13 @@
 
 #include <nihstro/shader_bytecode.h>
 
+#include <cstring>
+
 #include "common/assert.h"
+#include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/memory_util.h"
 #include "common/vector_math.h"
 #include "common/x64/abi.h"
 #include "common/x64/cpu_detect.h"
@@ -172,7 +177,8 @@ void JitShader::Compile_Assert(bool condition, const char* msg) {
  * @param src_reg SourceRegister object corresponding to the source register to load
  * @param dest Destination XMM register to store the loaded, swizzled source register
  */
-void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg, X64Reg dest) {
+void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg, X64Reg dest,
+                                   bool* negate_out) {
     X64Reg src_ptr;
     size_t src_offset;
 
@@ -205,41 +211,59 @@ void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRe
         address_register_index = instr.common.address_register_index;
     }
 
+    OpArg src;
     if (src_num == offset_src && address_register_index != 0) {
         switch (address_register_index) {
         case 1: // address offset 1
-            MOVAPS(dest, MComplex(src_ptr, ADDROFFS_REG_0, SCALE_1, src_offset_disp));
+            src = MComplex(src_ptr, ADDROFFS_REG_0, SCALE_1, src_offset_disp);
             break;
         case 2: // address offset 2
-            MOVAPS(dest, MComplex(src_ptr, ADDROFFS_REG_1, SCALE_1, src_offset_disp));
+            src = MComplex(src_ptr, ADDROFFS_REG_1, SCALE_1, src_offset_disp);
             break;
         case 3: // address offset 3
-            MOVAPS(dest, MComplex(src_ptr, LOOPCOUNT_REG, SCALE_1, src_offset_disp));
+            src = MComplex(src_ptr, LOOPCOUNT_REG, SCALE_1, src_offset_disp);
             break;
         default:
             UNREACHABLE();
             break;
         }
     } else {
-        // Load the source
-        MOVAPS(dest, MDisp(src_ptr, src_offset_disp));
+        src = MDisp(src_ptr, src_offset_disp);
     }
 
     SwizzlePattern swiz = { g_state.vs.swizzle_data[operand_desc_id] };
 
     // Generate instructions for source register swizzling as needed
     u8 sel = swiz.GetRawSelector(src_num);
-    if (sel != NO_SRC_REG_SWIZZLE) {
+    if (sel == NO_SRC_REG_SWIZZLE) {
+        // Identity swizzle; the plain load is all that's needed
+        MOVAPS(dest, src);
+    } else {
         // Selector component order needs to be reversed for the SHUFPS instruction
         sel = ((sel & 0xc0) >> 6) | ((sel & 3) << 6) | ((sel & 0xc) << 2) | ((sel & 0x30) >> 2);
 
-        // Shuffle inputs for swizzle
-        SHUFPS(dest, R(dest), sel);
+        // The duplication patterns xxzz, yyww and xyxy have dedicated SSE3 instructions which
+        // fold the shuffle into the load itself. Every other pattern, including the common
+        // xxxx/yyyy broadcasts, is a single SHUFPS on the loaded value.
+        const bool sse3 = Common::GetCPUCaps().sse3;
+        if (sse3 && sel == 0xA0) {
+            MOVSLDUP(dest, src);
+        } else if (sse3 && sel == 0xF5) {
+            MOVSHDUP(dest, src);
+        } else if (sse3 && sel == 0x44) {
+            MOVDDUP(dest, src);
+        } else {
+            MOVAPS(dest, src);
+            SHUFPS(dest, R(dest), sel);
+        }
     }
 
-    // If the source register should be negated, flip the negative bit using XOR
+    // If the source register should be negated, flip the negative bit using XOR. Callers that
+    // pass `negate_out` fuse the negation into their own arithmetic instead, saving the XORPS.
     const bool negate[] = { swiz.negate_src1, swiz.negate_src2, swiz.negate_src3 };
-    if (negate[src_num - 1]) {
+    if (negate_out != nullptr) {
+        *negate_out = negate[src_num - 1];
+    } else if (negate[src_num - 1]) {
         XORPS(dest, R(NEGBIT));
     }
 }
@@ -292,6 +316,18 @@ void JitShader::Compile_DestEnable(Instruction instr,X64Reg src) {
 }
 
 void JitShader::Compile_SanitizedMul(Gen::X64Reg src1, Gen::X64Reg src2, Gen::X64Reg scratch) {
+    if (Common::GetCPUCaps().avx) {
+        // The non-destructive three-operand forms save the register copies of the SSE path.
+        // Note: an FMA contraction cannot be used to fold the multiply into a following add,
+        // since the PICA requires 0 * inf to produce 0 and the product must be sanitized first.
+        VCMPPS(scratch, src1, R(src2), CMP_ORD);
+        MULPS(src1, R(src2));
+        VCMPPS(src2, src1, R(src1), CMP_UNORD);
+        XORPS(scratch, R(src2));
+        ANDPS(src1, R(scratch));
+        return;
+    }
+
     MOVAPS(scratch, R(src1));
     CMPPS(scratch, R(src2), CMP_ORD);
 
@@ -346,8 +382,13 @@ BitSet32 JitShader::PersistentCallerSavedRegs() {
 
 void JitShader::Compile_ADD(Instruction instr) {
     Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
-    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
-    ADDPS(SRC1, R(SRC2));
+    bool negate_src2;
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, &negate_src2);
+    // a + (-b) is exactly a - b, so a negated second operand folds into the addition
+    if (negate_src2)
+        SUBPS(SRC1, R(SRC2));
+    else
+        ADDPS(SRC1, R(SRC2));
     Compile_DestEnable(instr, SRC1);
 }
 
@@ -357,11 +398,16 @@ void JitShader::Compile_DP3(Instruction instr) {
 
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
 
-    MOVAPS(SRC2, R(SRC1));
-    SHUFPS(SRC2, R(SRC2), _MM_SHUFFLE(1, 1, 1, 1));
+    if (Common::GetCPUCaps().avx) {
+        VSHUFPS(SRC2, SRC1, R(SRC1), _MM_SHUFFLE(1, 1, 1, 1));
+        VSHUFPS(SRC3, SRC1, R(SRC1), _MM_SHUFFLE(2, 2, 2, 2));
+    } else {
+        MOVAPS(SRC2, R(SRC1));
+        SHUFPS(SRC2, R(SRC2), _MM_SHUFFLE(1, 1, 1, 1));
 
-    MOVAPS(SRC3, R(SRC1));
-    SHUFPS(SRC3, R(SRC3), _MM_SHUFFLE(2, 2, 2, 2));
+        MOVAPS(SRC3, R(SRC1));
+        SHUFPS(SRC3, R(SRC3), _MM_SHUFFLE(2, 2, 2, 2));
+    }
 
     SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(0, 0, 0, 0));
     ADDPS(SRC1, R(SRC2));
@@ -376,13 +422,21 @@ void JitShader::Compile_DP4(Instruction instr) {
 
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
 
-    MOVAPS(SRC2, R(SRC1));
-    SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(2, 3, 0, 1)); // XYZW -> ZWXY
-    ADDPS(SRC1, R(SRC2));
+    if (Common::GetCPUCaps().avx) {
+        VSHUFPS(SRC2, SRC1, R(SRC1), _MM_SHUFFLE(2, 3, 0, 1)); // XYZW -> ZWXY
+        ADDPS(SRC1, R(SRC2));
 
-    MOVAPS(SRC2, R(SRC1));
-    SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(0, 1, 2, 3)); // XYZW -> WZYX
-    ADDPS(SRC1, R(SRC2));
+        VSHUFPS(SRC2, SRC1, R(SRC1), _MM_SHUFFLE(0, 1, 2, 3)); // XYZW -> WZYX
+        ADDPS(SRC1, R(SRC2));
+    } else {
+        MOVAPS(SRC2, R(SRC1));
+        SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(2, 3, 0, 1)); // XYZW -> ZWXY
+        ADDPS(SRC1, R(SRC2));
+
+        MOVAPS(SRC2, R(SRC1));
+        SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(0, 1, 2, 3)); // XYZW -> WZYX
+        ADDPS(SRC1, R(SRC2));
+    }
 
     Compile_DestEnable(instr, SRC1);
 }
@@ -408,13 +462,21 @@ void JitShader::Compile_DPH(Instruction instr) {
 
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
 
-    MOVAPS(SRC2, R(SRC1));
-    SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(2, 3, 0, 1)); // XYZW -> ZWXY
-    ADDPS(SRC1, R(SRC2));
+    if (Common::GetCPUCaps().avx) {
+        VSHUFPS(SRC2, SRC1, R(SRC1), _MM_SHUFFLE(2, 3, 0, 1)); // XYZW -> ZWXY
+        ADDPS(SRC1, R(SRC2));
 
-    MOVAPS(SRC2, R(SRC1));
-    SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(0, 1, 2, 3)); // XYZW -> WZYX
-    ADDPS(SRC1, R(SRC2));
+        VSHUFPS(SRC2, SRC1, R(SRC1), _MM_SHUFFLE(0, 1, 2, 3)); // XYZW -> WZYX
+        ADDPS(SRC1, R(SRC2));
+    } else {
+        MOVAPS(SRC2, R(SRC1));
+        SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(2, 3, 0, 1)); // XYZW -> ZWXY
+        ADDPS(SRC1, R(SRC2));
+
+        MOVAPS(SRC2, R(SRC1));
+        SHUFPS(SRC1, R(SRC1), _MM_SHUFFLE(0, 1, 2, 3)); // XYZW -> WZYX
+        ADDPS(SRC1, R(SRC2));
+    }
 
     Compile_DestEnable(instr, SRC1);
 }
@@ -708,12 +770,65 @@ void JitShader::Compile_IF(Instruction instr) {
     SetJumpTarget(b2);
 }
 
+/// Maximum trip count for which Compile_LOOP unrolls the loop body
+static const unsigned MAX_LOOP_UNROLL_ITERATIONS = 4;
+/// Maximum total (trip count * body length) Pica instructions an unrolled loop may expand to
+static const unsigned MAX_LOOP_UNROLL_INSTRUCTIONS = 64;
+
 void JitShader::Compile_LOOP(Instruction instr) {
     Compile_Assert(instr.flow_control.dest_offset >= program_counter, "Backwards loops not supported");
     Compile_Assert(!looping, "Nested loops not supported");
 
     looping = true;
 
+    // The loop parameters come from an integer uniform whose value is baked into the compiled
+    // program (loop uniforms take part in the shader cache key, see GetLoopUniformsKey), so the
+    // trip count is a compile-time constant. The small constant loops skinning shaders use for
+    // their 2-4 bone iterations are unrolled outright, removing the counter updates and the
+    // backward branch. Unrolling duplicates the body, so only straight-line arithmetic bodies
+    // are eligible; control flow inside the body would rebind its branch targets to the last
+    // copy, and subroutine returns inside it would be emitted once per copy.
+    const auto& loop_param = g_state.vs.uniforms.i[instr.flow_control.int_uniform_id];
+    const unsigned iterations = loop_param.x + 1;
+    const unsigned loop_begin = program_counter;
+    const unsigned loop_end = instr.flow_control.dest_offset + 1;
+
+    bool unrollable = iterations <= MAX_LOOP_UNROLL_ITERATIONS &&
+                      iterations * (loop_end - loop_begin) <= MAX_LOOP_UNROLL_INSTRUCTIONS;
+    for (unsigned off = loop_begin; unrollable && off < loop_end; ++off) {
+        Instruction body_instr = GetVertexShaderInstruction(off);
+        OpCode::Id body_opcode = body_instr.opcode.Value();
+        OpCode::Type type = body_instr.opcode.Value().GetInfo().type;
+        if ((type != OpCode::Type::Arithmetic && type != OpCode::Type::MultiplyAdd) ||
+            instr_table[static_cast<unsigned>(body_opcode)] == nullptr ||
+            std::binary_search(return_offsets.begin(), return_offsets.end(), off)) {
+            unrollable = false;
+        }
+    }
+
+    if (unrollable) {
+        u32 aux_value = loop_param.y;
+        for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+            // LOOPCOUNT_REG feeds relative addressing inside the body, so it still needs the
+            // per-iteration aux value, now as an immediate
+            MOV(32, R(LOOPCOUNT_REG), Imm32(aux_value));
+            for (unsigned off = loop_begin; off < loop_end; ++off) {
+                Instruction body_instr = GetVertexShaderInstruction(off);
+                OpCode::Id body_opcode = body_instr.opcode.Value();
+                if (iteration == 0)
+                    code_ptr[off] = GetCodePtr();
+                ((*this).*instr_table[static_cast<unsigned>(body_opcode)])(body_instr);
+            }
+            aux_value += loop_param.z;
+        }
+        // Leave LOOPCOUNT_REG with the same final value the runtime loop would
+        MOV(32, R(LOOPCOUNT_REG), Imm32(aux_value));
+
+        program_counter = loop_end;
+        looping = false;
+        return;
+    }
+
     int offset = ShaderSetup::UniformOffset(RegisterType::IntUniform, instr.flow_control.int_uniform_id);
     MOV(32, R(LOOPCOUNT), MDisp(SETUP, offset));
     MOV(32, R(LOOPCOUNT_REG), R(LOOPCOUNT));
@@ -867,8 +982,96 @@ void JitShader::Compile() {
     LOG_DEBUG(HW_GPU, "Compiled shader size=%lu", size);
 }
 
+/**
+ * Executable memory shared by all compiled shaders. Titles cycle through dozens of shader
+ * programs, and giving each one its own 64Kb mapping both fragments executable memory and
+ * burns a pair of syscalls per compile. Instead one contiguous arena is mapped on first use
+ * and carved into MAX_SHADER_SIZE slots; since every program reserves the same slot size, a
+ * freed slot can be handed to the next compile directly, with no compaction of live code.
+ *
+ * The arena is trivially destructible on purpose: JitShader destructors may run from static
+ * cache teardown in another translation unit, so slot returns must stay valid at any point
+ * during shutdown. The mapping itself is reclaimed by the OS on process exit.
+ */
+class ShaderCodeArena : NonCopyable {
+public:
+    /// Hands out a free slot, mapping the arena on first use. Asserts if no slot is free.
+    void Allocate(u8** executable, u8** writable) {
+        if (region == nullptr) {
+            void* writable_view;
+            void* executable_view;
+            if (AllocateDualMappedCodeSpace(SHADER_CODE_ARENA_SIZE, &writable_view, &executable_view)) {
+                region = (u8*)executable_view;
+                writable_region = (u8*)writable_view;
+            } else {
+                region = (u8*)AllocateExecutableMemory(SHADER_CODE_ARENA_SIZE);
+                writable_region = region;
+            }
+            // Hand out low addresses first
+            for (size_t i = MAX_CACHED_SHADERS; i > 0; --i)
+                free_slots[num_free_slots++] = region + (i - 1) * MAX_SHADER_SIZE;
+        }
+
+        ASSERT_MSG(num_free_slots > 0, "Shader code arena exhausted; eviction should have freed a slot");
+        u8* slot = free_slots[--num_free_slots];
+        *executable = slot;
+        *writable = writable_region + (slot - region);
+    }
+
+    /// Returns a slot previously handed out by Allocate for reuse
+    void Free(u8* executable) {
+        free_slots[num_free_slots++] = executable;
+    }
+
+private:
+    u8* region = nullptr;
+    u8* writable_region = nullptr;
+    u8* free_slots[MAX_CACHED_SHADERS] = {};
+    size_t num_free_slots = 0;
+};
+
+static ShaderCodeArena code_arena;
+
 JitShader::JitShader() {
-    AllocCodeSpace(MAX_SHADER_SIZE);
+    u8* executable;
+    u8* writable;
+    code_arena.Allocate(&executable, &writable);
+    SetCodeSpace(executable, writable, MAX_SHADER_SIZE);
+}
+
+JitShader::~JitShader() {
+    code_arena.Free(GetBasePtr());
+}
+
+u64 GetLoopUniformsKey(u64 program_code_hash) {
+    // Which integer uniforms the current program's LOOP instructions read; the scan is cached
+    // per program since programs change far less often than uniform values
+    static u64 scanned_program_hash;
+    static bool scanned = false;
+    static u32 loop_uniform_mask;
+
+    if (!scanned || scanned_program_hash != program_code_hash) {
+        loop_uniform_mask = 0;
+        for (size_t offset = 0; offset < g_state.vs.program_code.size(); ++offset) {
+            Instruction instr = GetVertexShaderInstruction(offset);
+            if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::LOOP)
+                loop_uniform_mask |= 1 << instr.flow_control.int_uniform_id;
+        }
+        scanned_program_hash = program_code_hash;
+        scanned = true;
+    }
+
+    if (loop_uniform_mask == 0)
+        return 0;
+
+    // Hash the referenced uniform values in their register positions, so the same value in a
+    // different loop register yields a different key
+    u32 loop_values[4] = {};
+    for (unsigned i = 0; i < 4; ++i) {
+        if (loop_uniform_mask & (1 << i))
+            std::memcpy(&loop_values[i], &g_state.vs.uniforms.i[i], sizeof(loop_values[i]));
+    }
+    return Common::ComputeHash64(loop_values, sizeof(loop_values));
 }
 
 } // namespace Shader
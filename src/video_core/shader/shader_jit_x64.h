@@ -28,6 +28,20 @@ namespace Shader {
 /// Memory allocated for each compiled shader (64Kb)
 constexpr size_t MAX_SHADER_SIZE = 1024 * 64;
 
+/// Size of the contiguous executable memory arena shared by all compiled shaders (4Mb)
+constexpr size_t SHADER_CODE_ARENA_SIZE = 1024 * 1024 * 4;
+
+/// Number of programs the arena can hold; the shader cache evicts beyond this
+constexpr size_t MAX_CACHED_SHADERS = SHADER_CODE_ARENA_SIZE / MAX_SHADER_SIZE;
+
+/**
+ * Computes the contribution of the integer uniforms referenced by the current program's LOOP
+ * instructions to its cache key. Compile_LOOP bakes these values into the generated code (small
+ * constant loops are unrolled), so programs differing only in their loop uniforms must not share
+ * compiled code. The program scan is cached per program_code_hash.
+ */
+u64 GetLoopUniformsKey(u64 program_code_hash);
+
 /**
  * This class implements the shader JIT compiler. It recompiles a Pica shader program into x86_64
  * code that can be executed on the host machine directly.
@@ -35,6 +49,7 @@ constexpr size_t MAX_SHADER_SIZE = 1024 * 64;
 class JitShader : public Gen::XCodeBlock {
 public:
     JitShader();
+    ~JitShader() override;
 
     void Run(const ShaderSetup& setup, UnitState<false>& state, unsigned offset) const {
         program(&setup, &state, code_ptr[offset]);
@@ -74,7 +89,13 @@ private:
     void Compile_Block(unsigned end);
     void Compile_NextInstr();
 
-    void Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg, Gen::X64Reg dest);
+    /**
+     * Loads and swizzles a source register into `dest`. Trivial swizzles are folded into the
+     * load. If `negate_out` is non-null, a negated source is not negated here; instead the flag
+     * is reported so the caller can fuse the negation into its arithmetic (e.g. ADD -> SUBPS).
+     */
+    void Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg, Gen::X64Reg dest,
+                            bool* negate_out = nullptr);
     void Compile_DestEnable(Instruction instr, Gen::X64Reg dest);
 
     /**
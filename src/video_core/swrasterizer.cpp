@@ -2,15 +2,124 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "common/thread_topology.h"
+
 #include "video_core/clipper.h"
+#include "video_core/pica.h"
+#include "video_core/rasterizer.h"
+#include "video_core/shader/shader.h"
 #include "video_core/swrasterizer.h"
 
 namespace VideoCore {
 
+// Clipping and triangle setup run on a worker thread fed through this SPSC ring, so vertex
+// shading of the next batch overlaps clipping/rasterization of the previous one. Pica register
+// state is stable while triangles are in flight because the queue is drained before the draw
+// command returns, and again before any flush that hands framebuffer memory back to the CPU.
+
+struct ClipperTriangle {
+    Pica::Shader::OutputVertex v0, v1, v2;
+};
+
+// Power-of-two slot count so the wrap computation stays a mask
+static const size_t TRIANGLE_QUEUE_SIZE = 1024;
+
+static std::array<ClipperTriangle, TRIANGLE_QUEUE_SIZE> triangle_queue;
+static std::atomic<size_t> queue_head(0); ///< Next slot the worker reads
+static std::atomic<size_t> queue_tail(0); ///< Next slot the producer writes
+static std::atomic<bool> worker_should_exit(false);
+static std::thread worker_thread;
+
+static void ClipperWorkerLoop() {
+    Common::RegisterCurrentThread(Common::ThreadRole::Worker, "SW clipper");
+    while (true) {
+        size_t head = queue_head.load(std::memory_order_relaxed);
+        if (head == queue_tail.load(std::memory_order_acquire)) {
+            if (worker_should_exit.load(std::memory_order_relaxed)) {
+                Common::UnregisterCurrentThread();
+                return;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        ClipperTriangle& triangle = triangle_queue[head % TRIANGLE_QUEUE_SIZE];
+        Pica::Clipper::ProcessTriangle(triangle.v0, triangle.v1, triangle.v2);
+        queue_head.store(head + 1, std::memory_order_release);
+    }
+}
+
+/// Blocks until the worker has retired every queued triangle
+static void DrainTriangleQueue() {
+    while (queue_head.load(std::memory_order_acquire) != queue_tail.load(std::memory_order_relaxed))
+        std::this_thread::yield();
+}
+
+SWRasterizer::SWRasterizer() {
+    worker_should_exit.store(false, std::memory_order_relaxed);
+    queue_head.store(0, std::memory_order_relaxed);
+    queue_tail.store(0, std::memory_order_relaxed);
+    worker_thread = std::thread(ClipperWorkerLoop);
+}
+
+SWRasterizer::~SWRasterizer() {
+    DrainTriangleQueue();
+    worker_should_exit.store(true, std::memory_order_relaxed);
+    worker_thread.join();
+}
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
         const Pica::Shader::OutputVertex& v1,
         const Pica::Shader::OutputVertex& v2) {
-    Pica::Clipper::ProcessTriangle(v0, v1, v2);
+    // Wait while the ring is full; in that case the clipper is the bottleneck and the
+    // producer gains nothing from running ahead
+    size_t tail = queue_tail.load(std::memory_order_relaxed);
+    while (tail - queue_head.load(std::memory_order_acquire) >= TRIANGLE_QUEUE_SIZE)
+        std::this_thread::yield();
+
+    ClipperTriangle& triangle = triangle_queue[tail % TRIANGLE_QUEUE_SIZE];
+    triangle.v0 = v0;
+    triangle.v1 = v1;
+    triangle.v2 = v2;
+    queue_tail.store(tail + 1, std::memory_order_release);
+}
+
+void SWRasterizer::DrawTriangles() {
+    DrainTriangleQueue();
+}
+
+void SWRasterizer::NotifyPicaRegisterChanged(u32 id) {
+    switch (id) {
+    // Fog LUT
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[1], 0xe9):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[2], 0xea):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[3], 0xeb):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[4], 0xec):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[5], 0xed):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[6], 0xee):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[7], 0xef):
+        Pica::Rasterizer::InvalidateFogLutCache();
+        break;
+    }
+}
+
+void SWRasterizer::FlushAll() {
+    DrainTriangleQueue();
+    Pica::Rasterizer::ClearTextureCache();
+}
+
+void SWRasterizer::FlushRegion(PAddr addr, u32 size) {
+    DrainTriangleQueue();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    DrainTriangleQueue();
+    Pica::Rasterizer::InvalidateTextureCacheRegion(addr, size);
 }
 
 }
@@ -17,14 +17,21 @@ struct OutputVertex;
 namespace VideoCore {
 
 class SWRasterizer : public RasterizerInterface {
+public:
+    SWRasterizer();
+    ~SWRasterizer() override;
+
+private:
     void AddTriangle(const Pica::Shader::OutputVertex& v0,
             const Pica::Shader::OutputVertex& v1,
             const Pica::Shader::OutputVertex& v2) override;
-    void DrawTriangles() override {}
-    void NotifyPicaRegisterChanged(u32 id) override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+    void DrawTriangles() override;
+    void NotifyPicaRegisterChanged(u32 id) override;
+    void FlushAll() override;
+    // Guest memory is only authoritative once the clipper worker has retired every queued
+    // triangle, so flushing for a read drains the pipeline before returning.
+    void FlushRegion(PAddr addr, u32 size) override;
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
 };
 
 }
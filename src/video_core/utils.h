@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstring>
+
 #include "common/common_types.h"
 
 namespace VideoCore {
@@ -55,4 +58,74 @@ static inline u32 GetMortonOffset(u32 x, u32 y, u32 bytes_per_pixel) {
     return (i + offset) * bytes_per_pixel;
 }
 
+/**
+ * Copies one 8x8 tile between its Morton-order layout and a row-linear buffer. Morton
+ * bit 0 is x&1, so horizontally adjacent pixel pairs are contiguous in the tiled
+ * layout: a tile row is four constant-size two-pixel copies, which the compiler turns
+ * into straight (vector) loads and stores once the loops are unrolled.
+ */
+template <std::size_t bytes_per_pixel, bool morton_to_linear>
+static inline void MortonCopyTile(u8* tiled, u8* linear, std::ptrdiff_t linear_row_stride) {
+    for (unsigned y = 0; y < 8; ++y) {
+        u8* linear_pixel = linear + static_cast<std::ptrdiff_t>(y) * linear_row_stride;
+        for (unsigned x = 0; x < 8; x += 2) {
+            u8* tiled_pixel = tiled + MortonInterleave(x, y) * bytes_per_pixel;
+            if (morton_to_linear)
+                std::memcpy(linear_pixel, tiled_pixel, bytes_per_pixel * 2);
+            else
+                std::memcpy(tiled_pixel, linear_pixel, bytes_per_pixel * 2);
+            linear_pixel += bytes_per_pixel * 2;
+        }
+    }
+}
+
+template <std::size_t bytes_per_pixel, bool morton_to_linear>
+static inline void MortonCopyTilesImpl(u32 width, u32 height, u8* tiled, u8* linear,
+                                       std::ptrdiff_t linear_row_stride) {
+    for (u32 y = 0; y < height; y += 8) {
+        u8* linear_row = linear + static_cast<std::ptrdiff_t>(y) * linear_row_stride;
+        for (u32 x = 0; x < width; x += 8) {
+            // An 8x8 tile starts at the Morton offset of its top-left pixel
+            u8* tiled_tile = tiled + (y * width + x * 8) * bytes_per_pixel;
+            MortonCopyTile<bytes_per_pixel, morton_to_linear>(
+                tiled_tile, linear_row + x * bytes_per_pixel, linear_row_stride);
+        }
+    }
+}
+
+/**
+ * Converts a whole 8x8-tiled (Morton order) image to or from a row-linear layout, one
+ * tile at a time. `linear` points at the linear row corresponding to tiled row 0 and
+ * `linear_row_stride` may be negative to walk the linear image bottom-up. Returns
+ * false when the dimensions are not tile-aligned or the pixel size is unsupported, in
+ * which case the caller must keep its per-pixel path.
+ */
+static inline bool MortonCopyTiles(u32 width, u32 height, u32 bytes_per_pixel, u8* tiled,
+                                   u8* linear, std::ptrdiff_t linear_row_stride,
+                                   bool morton_to_linear) {
+    if (width == 0 || height == 0 || (width % 8) != 0 || (height % 8) != 0)
+        return false;
+
+    switch (bytes_per_pixel) {
+    case 1:
+        morton_to_linear ? MortonCopyTilesImpl<1, true>(width, height, tiled, linear, linear_row_stride)
+                         : MortonCopyTilesImpl<1, false>(width, height, tiled, linear, linear_row_stride);
+        return true;
+    case 2:
+        morton_to_linear ? MortonCopyTilesImpl<2, true>(width, height, tiled, linear, linear_row_stride)
+                         : MortonCopyTilesImpl<2, false>(width, height, tiled, linear, linear_row_stride);
+        return true;
+    case 3:
+        morton_to_linear ? MortonCopyTilesImpl<3, true>(width, height, tiled, linear, linear_row_stride)
+                         : MortonCopyTilesImpl<3, false>(width, height, tiled, linear, linear_row_stride);
+        return true;
+    case 4:
+        morton_to_linear ? MortonCopyTilesImpl<4, true>(width, height, tiled, linear, linear_row_stride)
+                         : MortonCopyTilesImpl<4, false>(width, height, tiled, linear, linear_row_stride);
+        return true;
+    default:
+        return false;
+    }
+}
+
 } // namespace
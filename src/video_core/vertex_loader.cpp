@@ -1,5 +1,9 @@
 #include <memory>
 
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#endif
+
 #include <boost/range/algorithm/fill.hpp>
 
 #include "common/alignment.h"
@@ -20,6 +24,40 @@
 
 namespace Pica {
 
+/**
+ * Decodes `elements` components of type `T` into `attr`, filling the remaining components with
+ * the fixed (0, 0, 0, 1) defaults. With both parameters known at compile time the loops unroll
+ * into a straight-line sequence of converted copies, replacing the per-vertex format dispatch
+ * the old interpreting loader performed.
+ */
+template <typename T, unsigned int elements>
+static void LoadAttribute(const u8* src, Math::Vec4<float24>& attr) {
+    const T* srcdata = reinterpret_cast<const T*>(src);
+    for (unsigned int comp = 0; comp < elements; ++comp) {
+        attr[comp] = float24::FromFloat32(srcdata[comp]);
+    }
+
+    // Default attribute values set if array elements have < 4 components. This
+    // is *not* carried over from the default attribute settings even if they're
+    // enabled for this attribute.
+    for (unsigned int comp = elements; comp < 4; ++comp) {
+        attr[comp] = comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+    }
+}
+
+/// Selects the loader specialization for an attribute's element count
+template <typename T>
+static VertexLoader::AttributeLoader GetAttributeLoader(u32 elements) {
+    switch (elements) {
+    case 1: return LoadAttribute<T, 1>;
+    case 2: return LoadAttribute<T, 2>;
+    case 3: return LoadAttribute<T, 3>;
+    case 4: return LoadAttribute<T, 4>;
+    }
+    UNREACHABLE();
+    return nullptr;
+}
+
 void VertexLoader::Setup(const Pica::Regs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
@@ -53,6 +91,30 @@ void VertexLoader::Setup(const Pica::Regs& regs) {
                 vertex_attribute_formats[attribute_index] = attribute_config.GetFormat(attribute_index);
                 vertex_attribute_elements[attribute_index] = attribute_config.GetNumElements(attribute_index);
                 offset += attribute_config.GetStride(attribute_index);
+
+                // Select the specialized loader here so LoadVertex runs without any
+                // per-vertex format or element-count dispatch
+                if (vertex_attribute_elements[attribute_index] != 0) {
+                    u32 elements = vertex_attribute_elements[attribute_index];
+                    switch (vertex_attribute_formats[attribute_index]) {
+                    case Regs::VertexAttributeFormat::BYTE:
+                        attribute_loaders[attribute_index] = GetAttributeLoader<s8>(elements);
+                        vertex_attribute_element_sizes[attribute_index] = 1;
+                        break;
+                    case Regs::VertexAttributeFormat::UBYTE:
+                        attribute_loaders[attribute_index] = GetAttributeLoader<u8>(elements);
+                        vertex_attribute_element_sizes[attribute_index] = 1;
+                        break;
+                    case Regs::VertexAttributeFormat::SHORT:
+                        attribute_loaders[attribute_index] = GetAttributeLoader<s16>(elements);
+                        vertex_attribute_element_sizes[attribute_index] = 2;
+                        break;
+                    case Regs::VertexAttributeFormat::FLOAT:
+                        attribute_loaders[attribute_index] = GetAttributeLoader<float>(elements);
+                        vertex_attribute_element_sizes[attribute_index] = 4;
+                        break;
+                    }
+                }
             } else if (attribute_index < 16) {
                 // Attribute ids 12, 13, 14 and 15 signify 4, 8, 12 and 16-byte paddings, respectively
                 offset = Common::AlignUp(offset, 4);
@@ -66,61 +128,26 @@ void VertexLoader::Setup(const Pica::Regs& regs) {
     is_setup = true;
 }
 
+template <bool track_accesses>
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex, Shader::InputVertex& input, DebugUtils::MemoryAccessTracker& memory_accesses) {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
+    // One region classification for the whole vertex; the streams all hang off base_address
+    const Memory::PhysicalRegion region = Memory::GetPhysicalRegion(base_address);
+
     for (int i = 0; i < num_total_attributes; ++i) {
         if (vertex_attribute_elements[i] != 0) {
             // Load per-vertex data from the loader arrays
             u32 source_addr = base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
 
-            if (g_debug_context && Pica::g_debug_context->recorder) {
-                memory_accesses.AddAccess(source_addr, vertex_attribute_elements[i] * (
-                    (vertex_attribute_formats[i] == Regs::VertexAttributeFormat::FLOAT) ? 4
-                    : (vertex_attribute_formats[i] == Regs::VertexAttributeFormat::SHORT) ? 2 : 1));
+            if (track_accesses) {
+                memory_accesses.AddAccess(source_addr, vertex_attribute_elements[i] * vertex_attribute_element_sizes[i]);
             }
 
-            switch (vertex_attribute_formats[i]) {
-            case Regs::VertexAttributeFormat::BYTE:
-            {
-                const s8* srcdata = reinterpret_cast<const s8*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
-            }
-            case Regs::VertexAttributeFormat::UBYTE:
-            {
-                const u8* srcdata = reinterpret_cast<const u8*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
-            }
-            case Regs::VertexAttributeFormat::SHORT:
-            {
-                const s16* srcdata = reinterpret_cast<const s16*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
-            }
-            case Regs::VertexAttributeFormat::FLOAT:
-            {
-                const float* srcdata = reinterpret_cast<const float*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
-            }
-            }
-
-            // Default attribute values set if array elements have < 4 components. This
-            // is *not* carried over from the default attribute settings even if they're
-            // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
-                input.attr[i][comp] = comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
-            }
+            const u8* src = region.GetPointer(source_addr);
+            if (src == nullptr)
+                src = Memory::GetPhysicalPointer(source_addr);
+            attribute_loaders[i](src, input.attr[i]);
 
             LOG_TRACE(HW_GPU, "Loaded %d components of attribute %x for vertex %x (index %x) from 0x%08x + 0x%08x + 0x%04x: %f %f %f %f",
                 vertex_attribute_elements[i], i, vertex, index,
@@ -143,4 +170,64 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex, Shader::I
     }
 }
 
+template void VertexLoader::LoadVertex<true>(u32 base_address, int index, int vertex, Shader::InputVertex& input, DebugUtils::MemoryAccessTracker& memory_accesses);
+template void VertexLoader::LoadVertex<false>(u32 base_address, int index, int vertex, Shader::InputVertex& input, DebugUtils::MemoryAccessTracker& memory_accesses);
+
+/// Requests a cache line a few stream elements ahead of the current one
+static void PrefetchRead(const u8* ptr) {
+#ifdef _MSC_VER
+    _mm_prefetch(reinterpret_cast<const char*>(ptr), _MM_HINT_T0);
+#else
+    __builtin_prefetch(ptr, 0);
+#endif
+}
+
+template <bool track_accesses>
+void VertexLoader::LoadVertices(u32 base_address, const u32* vertices, int count, Shader::InputVertex* out, DebugUtils::MemoryAccessTracker& memory_accesses) {
+    ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
+
+    // How many vertices ahead of the current one each stream is prefetched. The streams are
+    // walked front to back, so by the time a vertex's turn comes its lines have had the rest
+    // of the stream pass to arrive.
+    const int PREFETCH_DISTANCE = 4;
+
+    // One region classification for the whole batch; the streams all hang off base_address
+    const Memory::PhysicalRegion region = Memory::GetPhysicalRegion(base_address);
+
+    for (int i = 0; i < num_total_attributes; ++i) {
+        if (vertex_attribute_elements[i] != 0) {
+            const u32 attribute_offset = vertex_attribute_sources[i];
+            const u32 stride = vertex_attribute_strides[i];
+            const AttributeLoader load = attribute_loaders[i];
+
+            for (int n = 0; n < count; ++n) {
+                u32 source_addr = base_address + attribute_offset + stride * vertices[n];
+
+                if (track_accesses) {
+                    memory_accesses.AddAccess(source_addr, vertex_attribute_elements[i] * vertex_attribute_element_sizes[i]);
+                }
+
+                const u8* src = region.GetPointer(source_addr);
+                if (src == nullptr)
+                    src = Memory::GetPhysicalPointer(source_addr);
+                // Sequential draws make the stream walk linear, so prefetching a fixed
+                // distance down the stream lands on (or near) the upcoming elements even
+                // for mildly shuffled index buffers
+                PrefetchRead(src + stride * PREFETCH_DISTANCE);
+
+                load(src, out[n].attr[i]);
+            }
+        } else if (vertex_attribute_is_default[i]) {
+            for (int n = 0; n < count; ++n) {
+                out[n].attr[i] = g_state.vs_default_attributes[i];
+            }
+        } else {
+            // See the note in LoadVertex: no data gets loaded for this attribute
+        }
+    }
+}
+
+template void VertexLoader::LoadVertices<true>(u32 base_address, const u32* vertices, int count, Shader::InputVertex* out, DebugUtils::MemoryAccessTracker& memory_accesses);
+template void VertexLoader::LoadVertices<false>(u32 base_address, const u32* vertices, int count, Shader::InputVertex* out, DebugUtils::MemoryAccessTracker& memory_accesses);
+
 }  // namespace Pica
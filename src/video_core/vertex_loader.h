@@ -3,7 +3,10 @@
 #include <array>
 
 #include "common/common_types.h"
+#include "common/vector_math.h"
+
 #include "video_core/pica.h"
+#include "video_core/pica_types.h"
 
 namespace Pica {
 
@@ -23,15 +26,33 @@ public:
     }
 
     void Setup(const Pica::Regs& regs);
+
+    /// Loads one vertex's input attributes. When `track_accesses` is false the debugger
+    /// bookkeeping compiles away entirely and `memory_accesses` is never touched.
+    template <bool track_accesses>
     void LoadVertex(u32 base_address, int index, int vertex, Shader::InputVertex& input, DebugUtils::MemoryAccessTracker& memory_accesses);
 
+    /// Loads a batch of vertices, walking each attribute stream in an inner loop over the
+    /// vertices rather than gathering all attributes of one vertex at a time. With the
+    /// interleaved layouts titles use, this turns the strided per-vertex gather into one
+    /// near-linear walk per stream, and upcoming stream elements are software-prefetched.
+    /// `vertices` holds the resolved vertex index for each of the `count` output slots.
+    template <bool track_accesses>
+    void LoadVertices(u32 base_address, const u32* vertices, int count, Shader::InputVertex* out, DebugUtils::MemoryAccessTracker& memory_accesses);
+
     int GetNumTotalAttributes() const { return num_total_attributes; }
 
+    /// Decodes and converts one attribute, specialized over format and element count so the
+    /// per-vertex work is a straight-line run of converted copies
+    using AttributeLoader = void (*)(const u8* src, Math::Vec4<float24>& attr);
+
 private:
     std::array<u32, 16> vertex_attribute_sources;
     std::array<u32, 16> vertex_attribute_strides{};
     std::array<Regs::VertexAttributeFormat, 16> vertex_attribute_formats;
     std::array<u32, 16> vertex_attribute_elements{};
+    std::array<u32, 16> vertex_attribute_element_sizes{};
+    std::array<AttributeLoader, 16> attribute_loaders{};
     std::array<bool, 16> vertex_attribute_is_default;
     int num_total_attributes = 0;
     bool is_setup = false;
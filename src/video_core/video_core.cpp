@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
 
 #include "common/logging/log.h"
@@ -22,11 +23,66 @@ std::unique_ptr<RendererBase> g_renderer;             ///< Renderer plugin
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
 std::atomic<bool> g_scaled_resolution_enabled;
+std::atomic<bool> g_hw_vertex_shaders_enabled;
+std::atomic<bool> g_dynamic_resolution_enabled;
+
+// Dynamic resolution controller state. The scale is read by the rasterizer cache when
+// framebuffer surfaces are created; the rest is only touched by ReportGPUFrameTime, which
+// runs on the render thread.
+static std::atomic<float> dynamic_resolution_scale{1.0f};
+static float frame_time_avg_us;
+static int frames_until_adjust;
+
+// 3DS titles pace against the 60Hz LCD vsync; leave a little headroom for composition
+static const float FRAME_BUDGET_US = 15000.0f;
+// Raising the scale back requires sustained time well under the budget, so the controller
+// doesn't oscillate around it after a drop
+static const float RECOVER_BUDGET_US = 10000.0f;
+static const float MIN_DYNAMIC_SCALE = 0.25f;
+static const float DYNAMIC_SCALE_STEP = 0.75f;
+// Frames to wait after an adjustment before considering another, letting the average settle
+// on surfaces created at the new scale
+static const int ADJUST_COOLDOWN_FRAMES = 60;
+
+float GetDynamicResolutionScale() {
+    if (!g_dynamic_resolution_enabled)
+        return 1.0f;
+    return dynamic_resolution_scale;
+}
+
+void ReportGPUFrameTime(u64 frame_time_us) {
+    if (!g_dynamic_resolution_enabled)
+        return;
+
+    frame_time_avg_us = 0.9f * frame_time_avg_us + 0.1f * static_cast<float>(frame_time_us);
+
+    if (frames_until_adjust > 0) {
+        --frames_until_adjust;
+        return;
+    }
+
+    float scale = dynamic_resolution_scale;
+    if (frame_time_avg_us > FRAME_BUDGET_US && scale > MIN_DYNAMIC_SCALE) {
+        dynamic_resolution_scale = std::max(MIN_DYNAMIC_SCALE, scale * DYNAMIC_SCALE_STEP);
+        frames_until_adjust = ADJUST_COOLDOWN_FRAMES;
+        LOG_DEBUG(Render, "GPU frame time %.1fms over budget, lowering resolution scale to %.2f",
+                  frame_time_avg_us / 1000.f, dynamic_resolution_scale.load());
+    } else if (frame_time_avg_us < RECOVER_BUDGET_US && scale < 1.0f) {
+        dynamic_resolution_scale = std::min(1.0f, scale / DYNAMIC_SCALE_STEP);
+        frames_until_adjust = ADJUST_COOLDOWN_FRAMES;
+        LOG_DEBUG(Render, "GPU frame time %.1fms recovered, raising resolution scale to %.2f",
+                  frame_time_avg_us / 1000.f, dynamic_resolution_scale.load());
+    }
+}
 
 /// Initialize the video core
 bool Init(EmuWindow* emu_window) {
     Pica::Init();
 
+    dynamic_resolution_scale = 1.0f;
+    frame_time_avg_us = 0.0f;
+    frames_until_adjust = 0;
+
     g_emu_window = emu_window;
     g_renderer = std::make_unique<RendererOpenGL>();
     g_renderer->SetWindow(g_emu_window);
@@ -7,6 +7,8 @@
 #include <atomic>
 #include <memory>
 
+#include "common/common_types.h"
+
 class EmuWindow;
 class RendererBase;
 
@@ -37,6 +39,26 @@ extern EmuWindow*                    g_emu_window; ///< Emu window
 extern std::atomic<bool> g_hw_renderer_enabled;
 extern std::atomic<bool> g_shader_jit_enabled;
 extern std::atomic<bool> g_scaled_resolution_enabled;
+extern std::atomic<bool> g_hw_vertex_shaders_enabled;
+extern std::atomic<bool> g_dynamic_resolution_enabled;
+
+// Dynamic resolution scaling
+// --------------------------
+
+/**
+ * Returns the current dynamic resolution factor in (0, 1]. It is applied on top of the
+ * window-derived scale when framebuffer surfaces are created, so lowering it only affects
+ * newly created render targets; presentation upscales them back to the window size.
+ * Always 1.0 while dynamic resolution is disabled.
+ */
+float GetDynamicResolutionScale();
+
+/**
+ * Feeds one frame's GPU render time to the dynamic resolution controller, which lowers the
+ * scale factor when the frame budget is exceeded and raises it back once there has been
+ * sustained headroom (hysteresis keeps it from oscillating at the boundary).
+ */
+void ReportGPUFrameTime(u64 frame_time_us);
 
 /// Start the video core
 void Start();